@@ -13,27 +13,186 @@
  *                Basic I/O primitives                                  *
  ************************************************************************/
 
+/* Read-only mirrors that have this much unsent data skip frames until
+   they catch up */
+#define MAX_MIRROR_PENDING (4 * 1024 * 1024)
+
 struct BroadwayOutput {
   GOutputStream *out;
   GString *buf;
   int error;
   guint32 serial;
+
+  /* Outputs that get a copy of everything we send */
+  GPtrArray *mirrors;
+
+  /* Non-blocking outputs queue what can't be written right away */
+  gboolean nonblocking;
+  GByteArray *pending;
+  GSource *pending_source;
+  gboolean lagging;
+  BroadwayOutputDrainedFunc drained_func;
+  gpointer drained_data;
+
+  /* Set when the client negotiated permessage-deflate */
+  GConverter *deflate;
+  gboolean deflate_reset;
+  GByteArray *deflate_buf;
 };
 
+/* Node ids are unique for the whole process, so that nodes keep their
+   ids when sent to a new client */
+static guint32 next_node_id = 1;
+
+static gboolean broadway_output_write_pending (BroadwayOutput *output);
+
+static gboolean
+pending_writable_cb (GObject        *stream,
+                     BroadwayOutput *output)
+{
+  if (!broadway_output_write_pending (output))
+    return G_SOURCE_CONTINUE;
+
+  output->pending_source = NULL;
+
+  if (output->lagging && output->drained_func)
+    output->drained_func (output, output->drained_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Returns TRUE if everything was written */
+static gboolean
+broadway_output_write_pending (BroadwayOutput *output)
+{
+  GError *error = NULL;
+  gssize res;
+
+  while (output->pending->len > 0)
+    {
+      res = g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM (output->out),
+                                                        output->pending->data,
+                                                        output->pending->len,
+                                                        NULL, &error);
+      if (res < 0)
+        {
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            {
+              g_error_free (error);
+              return FALSE;
+            }
+
+          g_error_free (error);
+          output->error = TRUE;
+          g_byte_array_set_size (output->pending, 0);
+          break;
+        }
+
+      g_byte_array_remove_range (output->pending, 0, res);
+    }
+
+  return TRUE;
+}
+
+/* Runs all of data through converter and appends the result. With
+   G_CONVERTER_FLUSH, all of the output for data is produced; without
+   it, decompressors produce as much as they can */
+gboolean
+broadway_convert (GConverter      *converter,
+                  const void      *data,
+                  gsize            len,
+                  GConverterFlags  flags,
+                  GByteArray      *result)
+{
+  const guchar *in = data;
+  gsize space = MAX (2 * len, 4096);
+
+  while (TRUE)
+    {
+      GConverterResult res;
+      GError *error = NULL;
+      gsize bytes_read, bytes_written;
+      gsize old_len = result->len;
+
+      g_byte_array_set_size (result, old_len + space);
+      res = g_converter_convert (converter, in, len,
+                                 result->data + old_len, space,
+                                 flags, &bytes_read, &bytes_written, &error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          g_byte_array_set_size (result, old_len);
+
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+            {
+              g_error_free (error);
+              space *= 2;
+              continue;
+            }
+
+          /* Nothing left to produce from the input we have */
+          if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT) && len == 0)
+            {
+              g_error_free (error);
+              return TRUE;
+            }
+
+          g_error_free (error);
+          return FALSE;
+        }
+
+      g_byte_array_set_size (result, old_len + bytes_written);
+      in += bytes_read;
+      len -= bytes_read;
+
+      /* zlib is done when it consumed everything and didn't fill the output */
+      if (len == 0 &&
+          (bytes_written < space || res == G_CONVERTER_FLUSHED || res == G_CONVERTER_FINISHED))
+        return TRUE;
+    }
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
                           gboolean fin, BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
+  gboolean compressed = FALSE;
   guchar header[16];
   size_t p;
+  gboolean mid_header, long_header;
 
-  gboolean mid_header = count > 125 && count <= 65535;
-  gboolean long_header = count > 65535;
+  if (output->deflate && count > 0 &&
+      (code == BROADWAY_WS_BINARY || code == BROADWAY_WS_TEXT))
+    {
+      GByteArray *deflated = output->deflate_buf;
+
+      g_byte_array_set_size (deflated, 0);
+      if (!broadway_convert (output->deflate, buf, count, G_CONVERTER_FLUSH, deflated))
+        {
+          output->error = TRUE;
+          return;
+        }
+
+      /* The empty block that ends the sync flush is left out, see
+         RFC 7692, section 7.2.1 */
+      if (deflated->len >= 4 &&
+          memcmp (deflated->data + deflated->len - 4, "\x00\x00\xff\xff", 4) == 0)
+        g_byte_array_set_size (deflated, deflated->len - 4);
+
+      if (output->deflate_reset)
+        g_converter_reset (output->deflate);
+
+      buf = deflated->data;
+      count = deflated->len;
+      compressed = TRUE;
+    }
+
+  mid_header = count > 125 && count <= 65535;
+  long_header = count > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
                 (mid_header ? 126 : long_header ? 127 : count) );
   p = 2;
@@ -48,6 +207,28 @@ broadway_output_send_cmd (BroadwayOutput *output,
       p += 8;
     }
   // FIXME: if we are paranoid we should 'mask' the data
+
+  if (output->nonblocking)
+    {
+      if (output->error)
+        return;
+
+      g_byte_array_append (output->pending, header, p);
+      g_byte_array_append (output->pending, buf, count);
+
+      if (output->pending_source == NULL &&
+          !broadway_output_write_pending (output))
+        {
+          output->pending_source =
+            g_pollable_output_stream_create_source (G_POLLABLE_OUTPUT_STREAM (output->out), NULL);
+          g_source_set_callback (output->pending_source,
+                                 (GSourceFunc)pending_writable_cb, output, NULL);
+          g_source_attach (output->pending_source, NULL);
+          g_source_unref (output->pending_source);
+        }
+      return;
+    }
+
   // FIXME: we should really emit these as a single write
   g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
   g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
@@ -58,15 +239,42 @@ void broadway_output_pong (BroadwayOutput *output)
   broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PONG, NULL, 0);
 }
 
+void broadway_output_ping (BroadwayOutput *output)
+{
+  broadway_output_send_cmd (output, TRUE, BROADWAY_WS_CNX_PING, NULL, 0);
+}
+
 int
 broadway_output_flush (BroadwayOutput *output)
 {
+  guint i;
+
   if (output->buf->len == 0)
     return TRUE;
 
   broadway_output_send_cmd (output, TRUE, BROADWAY_WS_BINARY,
                             output->buf->str, output->buf->len);
 
+  if (output->mirrors)
+    {
+      for (i = 0; i < output->mirrors->len; i++)
+        {
+          BroadwayOutput *mirror = g_ptr_array_index (output->mirrors, i);
+
+          /* Once a mirror misses a frame its state differs from ours,
+             so it has to be reset before it can get frames again */
+          if (mirror->lagging ||
+              mirror->pending->len > MAX_MIRROR_PENDING)
+            {
+              mirror->lagging = TRUE;
+              continue;
+            }
+
+          broadway_output_send_cmd (mirror, TRUE, BROADWAY_WS_BINARY,
+                                    output->buf->str, output->buf->len);
+        }
+    }
+
   g_string_set_size (output->buf, 0);
 
   return !output->error;
@@ -87,13 +295,95 @@ broadway_output_new (GOutputStream *out, guint32 serial)
   return output;
 }
 
+/* Compresses all further messages with permessage-deflate. With
+   no_context_takeover, every message is compressed on its own */
+void
+broadway_output_set_deflate (BroadwayOutput *output,
+                             int             level,
+                             gboolean        no_context_takeover)
+{
+  g_return_if_fail (output->deflate == NULL);
+
+  output->deflate = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, level));
+  output->deflate_reset = no_context_takeover;
+  output->deflate_buf = g_byte_array_new ();
+}
+
+/* Creates an output that never blocks, for read-only clients */
+BroadwayOutput *
+broadway_output_new_nonblocking (GOutputStream *out, guint32 serial)
+{
+  BroadwayOutput *output;
+
+  g_return_val_if_fail (G_IS_POLLABLE_OUTPUT_STREAM (out), NULL);
+
+  output = broadway_output_new (out, serial);
+  output->nonblocking = TRUE;
+  output->pending = g_byte_array_new ();
+
+  return output;
+}
+
 void
 broadway_output_free (BroadwayOutput *output)
 {
+  if (output->pending_source)
+    g_source_destroy (output->pending_source);
+  if (output->pending)
+    g_byte_array_free (output->pending, TRUE);
+  if (output->mirrors)
+    g_ptr_array_free (output->mirrors, TRUE);
+  if (output->deflate)
+    {
+      g_object_unref (output->deflate);
+      g_byte_array_free (output->deflate_buf, TRUE);
+    }
   g_object_unref (output->out);
   free (output);
 }
 
+void
+broadway_output_add_mirror (BroadwayOutput *output,
+                            BroadwayOutput *mirror)
+{
+  guint i;
+
+  g_return_if_fail (mirror->nonblocking);
+
+  if (output->mirrors == NULL)
+    output->mirrors = g_ptr_array_new ();
+
+  for (i = 0; i < output->mirrors->len; i++)
+    if (g_ptr_array_index (output->mirrors, i) == mirror)
+      return;
+
+  g_ptr_array_add (output->mirrors, mirror);
+}
+
+void
+broadway_output_remove_mirror (BroadwayOutput *output,
+                               BroadwayOutput *mirror)
+{
+  if (output->mirrors)
+    g_ptr_array_remove (output->mirrors, mirror);
+}
+
+gboolean
+broadway_output_is_lagging (BroadwayOutput *output)
+{
+  return output->lagging;
+}
+
+/* Called when a lagging output has sent everything it had queued */
+void
+broadway_output_set_drained_func (BroadwayOutput            *output,
+                                  BroadwayOutputDrainedFunc  func,
+                                  gpointer                   user_data)
+{
+  output->drained_func = func;
+  output->drained_data = user_data;
+}
+
 guint32
 broadway_output_get_next_serial (BroadwayOutput *output)
 {
@@ -176,6 +466,14 @@ write_header(BroadwayOutput *output, char op)
   append_uint32 (output, output->serial++);
 }
 
+/* Makes the client forget all its state, so that it can be resynced */
+void
+broadway_output_reset (BroadwayOutput *output)
+{
+  write_header (output, BROADWAY_OP_RESET);
+  output->lagging = FALSE;
+}
+
 void
 broadway_output_grab_pointer (BroadwayOutput *output,
                               int id,
@@ -332,57 +630,178 @@ append_type (BroadwayOutput *output, guint32 type, BroadwayNode *node)
  * against the old tree.  This allows us to avoid sending certain
  * parts.
  *
+ * Every node sent to the client gets an id, which the client uses
+ * to look up the dom node it created for it.  Nodes that are reused
+ * from the old tree inherit the id of the old node, so ids are
+ * stable for as long as the client keeps the dom node.
+ *
  * Reusing existing dom nodes are problematic because doing so
  * automatically inherits all their children.  There are two cases
  * where we do this:
  *
- * If the entire sub tree is identical we emit a KEEP_ALL node which
- * just reuses the entire old dom subtree.
+ * If the entire sub tree is identical to some subtree of the old
+ * tree we emit a KEEP_ALL node with the id of the old node, which
+ * just reuses (and if needed moves) the entire old dom subtree.  We
+ * prefer the old node at the same position, but look up any
+ * identical one so that inserting or removing siblings doesn't make
+ * us resend everything after them.
  *
  * If a the node is unchanged (but some descendant may have changed),
- * and all parents are also unchanged, then we can just avoid
- * changing the dom node at all, and we emit a KEEP_THIS node.
+ * we emit a KEEP_THIS node with the id of the old node, which keeps
+ * the dom node and its attributes but updates its children.
+ *
+ * Each old dom node can only be reused once, and after the tree we
+ * send the ids of the old nodes that were not reused so that the
+ * client can forget about them.
  *
  ***********************************/
+
+static guint
+node_hash (gconstpointer key)
+{
+  const BroadwayNode *node = key;
+
+  return node->hash;
+}
+
+static gboolean
+node_deep_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  return broadway_node_deep_equal ((BroadwayNode *)a, (BroadwayNode *)b);
+}
+
+static void
+add_old_nodes (GHashTable   *old_nodes,
+               BroadwayNode *node)
+{
+  guint32 i;
+
+  node->reused = FALSE;
+
+  /* If there are several identical subtrees we only remember the
+     first, the others can still be reused by position */
+  if (!g_hash_table_contains (old_nodes, node))
+    g_hash_table_add (old_nodes, node);
+
+  for (i = 0; i < node->n_children; i++)
+    add_old_nodes (old_nodes, node->children[i]);
+}
+
+static gboolean
+old_subtree_is_unused (BroadwayNode *old_node)
+{
+  guint32 i;
+
+  if (old_node->reused)
+    return FALSE;
+
+  for (i = 0; i < old_node->n_children; i++)
+    if (!old_subtree_is_unused (old_node->children[i]))
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Gives node the ids of the old identical subtree */
+static void
+reuse_old_subtree (BroadwayNode *node,
+                   BroadwayNode *old_node)
+{
+  guint32 i;
+
+  node->id = old_node->id;
+  old_node->reused = TRUE;
+
+  for (i = 0; i < node->n_children; i++)
+    reuse_old_subtree (node->children[i], old_node->children[i]);
+}
+
+static guint32
+count_unused_old_nodes (BroadwayNode *old_node)
+{
+  guint32 i, n;
+
+  n = old_node->reused ? 0 : 1;
+  for (i = 0; i < old_node->n_children; i++)
+    n += count_unused_old_nodes (old_node->children[i]);
+
+  return n;
+}
+
+static void
+append_unused_old_nodes (BroadwayOutput *output,
+                         BroadwayNode   *old_node)
+{
+  guint32 i;
+
+  if (!old_node->reused)
+    append_uint32 (output, old_node->id);
+  for (i = 0; i < old_node->n_children; i++)
+    append_unused_old_nodes (output, old_node->children[i]);
+}
+
 static void
 append_node (BroadwayOutput *output,
              BroadwayNode   *node,
              BroadwayNode   *old_node,
-             gboolean        all_parents_are_kept)
+             GHashTable     *old_nodes)
 {
+  BroadwayNode *reused;
   guint32 i;
 
   append_node_depth++;
 
-  if (old_node != NULL && broadway_node_equal (node, old_node))
+  reused = NULL;
+  if (old_node != NULL &&
+      broadway_node_deep_equal (node, old_node) &&
+      old_subtree_is_unused (old_node))
+    reused = old_node;
+  else if (old_nodes != NULL)
     {
-      if (broadway_node_deep_equal (node, old_node))
-        {
-          append_type (output, BROADWAY_NODE_KEEP_ALL, node);
-          goto out;
-        }
+      reused = g_hash_table_lookup (old_nodes, node);
+      if (reused != NULL && !old_subtree_is_unused (reused))
+        reused = NULL;
+    }
 
-      if (all_parents_are_kept)
-        {
-          append_type (output, BROADWAY_NODE_KEEP_THIS, node);
-          append_uint32 (output, node->n_children);
-          for (i = 0; i < node->n_children; i++)
-            append_node (output, node->children[i],
-                         i < old_node->n_children ? old_node->children[i] : NULL,
-                         TRUE);
-
-          goto out;
-        }
+  if (reused != NULL)
+    {
+      reuse_old_subtree (node, reused);
+      append_type (output, BROADWAY_NODE_KEEP_ALL, node);
+      append_uint32 (output, node->id);
+      goto out;
     }
 
+  if (old_node != NULL &&
+      !old_node->reused &&
+      broadway_node_equal (node, old_node))
+    {
+      node->id = old_node->id;
+      old_node->reused = TRUE;
+
+      append_type (output, BROADWAY_NODE_KEEP_THIS, node);
+      append_uint32 (output, node->id);
+      append_uint32 (output, node->n_children);
+      for (i = 0; i < node->n_children; i++)
+        append_node (output, node->children[i],
+                     i < old_node->n_children ? old_node->children[i] : NULL,
+                     old_nodes);
+
+      goto out;
+    }
+
+  if (old_nodes != NULL || node->id == 0)
+    node->id = next_node_id++;
+
   append_type (output, node->type, node);
+  append_uint32 (output, node->id);
   for (i = 0; i < node->n_data; i++)
     append_uint32 (output, node->data[i]);
   for (i = 0; i < node->n_children; i++)
     append_node (output,
                  node->children[i],
                  (old_node != NULL && i < old_node->n_children) ? old_node->children[i] : NULL,
-                 FALSE);
+                 old_nodes);
 
  out:
   append_node_depth--;
@@ -394,12 +813,24 @@ broadway_output_surface_set_nodes (BroadwayOutput *output,
                                    BroadwayNode   *root,
                                    BroadwayNode   *old_root)
 {
+  GHashTable *old_nodes;
   gsize size_pos, start, end;
 
-  /* Early return if nothing changed */
+  /* Early return if nothing changed, the client keeps the old dom
+     nodes so we just need to keep their ids */
   if (old_root != NULL &&
       broadway_node_deep_equal (root, old_root))
-    return;
+    {
+      reuse_old_subtree (root, old_root);
+      return;
+    }
+
+  old_nodes = NULL;
+  if (old_root != NULL)
+    {
+      old_nodes = g_hash_table_new (node_hash, node_deep_equal);
+      add_old_nodes (old_nodes, old_root);
+    }
 
   write_header (output, BROADWAY_OP_SET_NODES);
 
@@ -412,7 +843,17 @@ broadway_output_surface_set_nodes (BroadwayOutput *output,
 #ifdef DEBUG_NODE_SENDING
   g_print ("====== node tree for %d =======\n", id);
 #endif
-  append_node (output, root, old_root, TRUE);
+  append_node (output, root, old_root, old_nodes);
+
+  if (old_root != NULL)
+    {
+      append_uint32 (output, count_unused_old_nodes (old_root));
+      append_unused_old_nodes (output, old_root);
+      g_hash_table_destroy (old_nodes);
+    }
+  else
+    append_uint32 (output, 0);
+
   end = output->buf->len;
   patch_uint32 (output, (end - start) / 4, size_pos);
 }
@@ -17,9 +17,31 @@ typedef enum {
   BROADWAY_WS_CNX_PONG = 0xa
 } BroadwayWSOpCode;
 
+typedef void (*BroadwayOutputDrainedFunc) (BroadwayOutput *output,
+                                           gpointer        user_data);
+
 BroadwayOutput *broadway_output_new                 (GOutputStream  *out,
                                                      guint32         serial);
+BroadwayOutput *broadway_output_new_nonblocking     (GOutputStream  *out,
+                                                     guint32         serial);
 void            broadway_output_free                (BroadwayOutput *output);
+void            broadway_output_set_deflate         (BroadwayOutput *output,
+                                                     int             level,
+                                                     gboolean        no_context_takeover);
+gboolean        broadway_convert                    (GConverter     *converter,
+                                                     const void     *data,
+                                                     gsize           len,
+                                                     GConverterFlags flags,
+                                                     GByteArray     *result);
+void            broadway_output_add_mirror          (BroadwayOutput *output,
+                                                     BroadwayOutput *mirror);
+void            broadway_output_remove_mirror       (BroadwayOutput *output,
+                                                     BroadwayOutput *mirror);
+gboolean        broadway_output_is_lagging          (BroadwayOutput *output);
+void            broadway_output_set_drained_func    (BroadwayOutput *output,
+                                                     BroadwayOutputDrainedFunc func,
+                                                     gpointer        user_data);
+void            broadway_output_reset               (BroadwayOutput *output);
 int             broadway_output_flush               (BroadwayOutput *output);
 int             broadway_output_has_error           (BroadwayOutput *output);
 void            broadway_output_set_next_serial     (BroadwayOutput *output,
@@ -71,6 +93,7 @@ void            broadway_output_grab_pointer        (BroadwayOutput *output,
                                                      gboolean        owner_event);
 guint32         broadway_output_ungrab_pointer      (BroadwayOutput *output);
 void            broadway_output_pong                (BroadwayOutput *output);
+void            broadway_output_ping                (BroadwayOutput *output);
 void            broadway_output_set_show_keyboard   (BroadwayOutput *output,
                                                      gboolean        show);
 
@@ -79,6 +79,7 @@ typedef enum {
   BROADWAY_OP_RELEASE_TEXTURE = 'T',
   BROADWAY_OP_SET_NODES = 'n',
   BROADWAY_OP_ROUNDTRIP = 'F',
+  BROADWAY_OP_RESET = 'x',
 } BroadwayOpType;
 
 typedef struct {
@@ -41,6 +41,13 @@ typedef struct {
   guint32 tag;
 } BroadwayOutstandingRoundtrip;
 
+/* In microseconds */
+#define MOTION_DELAY_MIN_RTT (40 * 1000)
+#define MOTION_DELAY_MAX (32 * 1000)
+
+/* In seconds */
+#define PING_INTERVAL 2
+
 typedef struct BroadwayInput BroadwayInput;
 typedef struct BroadwaySurface BroadwaySurface;
 struct _BroadwayServer {
@@ -56,8 +63,12 @@ struct _BroadwayServer {
   guint32 saved_serial;
   guint64 last_seen_time;
   BroadwayInput *input;
+  GList *viewers; /* Read-only clients, mirroring output */
   GList *input_messages;
   guint process_input_idle;
+  guint motion_timeout;
+  int compression_level;
+  gint64 motion_hold_time;
 
   GHashTable *surface_id_hash;
   GList *surfaces;
@@ -113,6 +124,16 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  gboolean viewer;
+
+  /* Measured with websocket pings, in microseconds */
+  guint ping_timeout;
+  gint64 ping_time;
+  gint64 round_trip_time;
+
+  /* Set when the client negotiated permessage-deflate */
+  GConverter *inflate;
+  GByteArray *inflate_buf;
 };
 
 struct BroadwaySurface {
@@ -129,6 +150,7 @@ struct BroadwaySurface {
 };
 
 static void broadway_server_resync_surfaces (BroadwayServer *server);
+static void process_input_messages (BroadwayServer *server);
 static void send_outstanding_roundtrips (BroadwayServer *server);
 
 static GType broadway_server_get_type (void);
@@ -201,6 +223,7 @@ broadway_server_init (BroadwayServer *server)
   server->pointer_grab_surface_id = -1;
   server->saved_serial = 1;
   server->last_seen_time = 1;
+  server->compression_level = -1;
   server->surface_id_hash = g_hash_table_new (NULL, NULL);
   server->id_counter = 0;
   server->textures = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
@@ -257,6 +280,9 @@ broadway_server_lookup_surface (BroadwayServer   *server,
 }
 
 static void start (BroadwayInput *input);
+static void start_viewer (BroadwayInput *input);
+static void broadway_server_write_state (BroadwayServer *server,
+                                         BroadwayOutput *output);
 
 static void
 http_request_free (HttpRequest *request)
@@ -271,8 +297,15 @@ http_request_free (HttpRequest *request)
 static void
 broadway_input_free (BroadwayInput *input)
 {
+  if (input->ping_timeout)
+    g_source_remove (input->ping_timeout);
   g_object_unref (input->connection);
   g_byte_array_free (input->buffer, FALSE);
+  if (input->inflate)
+    {
+      g_object_unref (input->inflate);
+      g_byte_array_free (input->inflate_buf, TRUE);
+    }
   g_source_destroy (input->source);
   g_free (input);
 }
@@ -420,14 +453,91 @@ process_input_message (BroadwayServer *server,
   broadway_events_got_input (message, client);
 }
 
+/* Motion that is followed by more motion of the same kind is dropped,
+ * as the client would only compress it anyway after queueing it.
+ */
+static gboolean
+is_replaced_by (BroadwayInputMsg *message,
+                BroadwayInputMsg *next)
+{
+  return
+    message->base.type == BROADWAY_EVENT_POINTER_MOVE &&
+    next->base.type == BROADWAY_EVENT_POINTER_MOVE &&
+    message->pointer.mouse_surface_id == next->pointer.mouse_surface_id &&
+    message->pointer.event_surface_id == next->pointer.event_surface_id &&
+    message->pointer.state == next->pointer.state;
+}
+
+static gboolean
+motion_timeout_cb (gpointer user_data)
+{
+  BroadwayServer *server = user_data;
+
+  server->motion_timeout = 0;
+  process_input_messages (server);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* How long to hold back the last motion event, waiting for more
+ * motion that replaces it. Clients on slow connections deliver
+ * motion in bursts that are spread over a frame or more, and every
+ * event sent to the applications may cause a relayout of their hover
+ * state. For them, a few more milliseconds of latency don't matter.
+ */
+static gint64
+get_motion_delay (BroadwayServer *server)
+{
+  gint64 rtt;
+
+  rtt = broadway_server_get_round_trip_time (server);
+  if (rtt < MOTION_DELAY_MIN_RTT)
+    return 0;
+
+  return MIN (rtt / 8, MOTION_DELAY_MAX);
+}
+
 static void
 process_input_messages (BroadwayServer *server)
 {
   BroadwayInputMsg *message;
+  gint64 now, delay;
 
   while (server->input_messages)
     {
       message = server->input_messages->data;
+
+      if (server->input_messages->next != NULL &&
+          is_replaced_by (message, server->input_messages->next->data))
+        {
+          server->input_messages =
+            g_list_delete_link (server->input_messages,
+                                server->input_messages);
+          g_free (message);
+          continue;
+        }
+
+      if (server->input_messages->next == NULL &&
+          message->base.type == BROADWAY_EVENT_POINTER_MOVE &&
+          (delay = get_motion_delay (server)) > 0)
+        {
+          now = g_get_monotonic_time ();
+          if (server->motion_hold_time == 0)
+            server->motion_hold_time = now;
+
+          if (now - server->motion_hold_time < delay)
+            {
+              if (server->motion_timeout == 0)
+                server->motion_timeout =
+                  g_timeout_add (MAX ((server->motion_hold_time + delay - now) / 1000, 1),
+                                 motion_timeout_cb, server);
+              break;
+            }
+        }
+
+      if (message->base.type == BROADWAY_EVENT_POINTER_MOVE)
+        server->motion_hold_time = 0;
+
       server->input_messages =
         g_list_delete_link (server->input_messages,
                             server->input_messages);
@@ -666,7 +776,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -677,6 +787,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = buf[0] & 0x40;
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -726,16 +837,39 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed)
+          {
+            g_byte_array_set_size (input->inflate_buf, 0);
+            if (input->inflate == NULL ||
+                !broadway_convert (input->inflate, data, payload_len, 0, input->inflate_buf) ||
+                !broadway_convert (input->inflate, "\x00\x00\xff\xff", 4, 0, input->inflate_buf))
+              g_warning ("invalid compressed input");
+            else if (!input->viewer)
+              parse_input_message (input, input->inflate_buf->data);
+          }
         else
           {
-            parse_input_message (input, data);
+            /* Viewers are read-only */
+            if (!input->viewer)
+              parse_input_message (input, data);
           }
         break;
       case BROADWAY_WS_CNX_PING:
         broadway_output_pong (input->output);
         break;
       case BROADWAY_WS_CNX_PONG:
-        break; /* we never send pings, but tolerate pongs */
+        if (input->ping_time != 0)
+          {
+            gint64 rtt = g_get_monotonic_time () - input->ping_time;
+
+            /* Smoothed like TCP does it */
+            if (input->round_trip_time == 0)
+              input->round_trip_time = rtt;
+            else
+              input->round_trip_time = (7 * input->round_trip_time + rtt) / 8;
+            input->ping_time = 0;
+          }
+        break;
       case BROADWAY_WS_TEXT:
       case BROADWAY_WS_CONTINUATION:
       default:
@@ -797,6 +931,13 @@ broadway_server_read_all_input_nonblocking (BroadwayInput *input)
 
           input->server->input = NULL;
         }
+      if (input->viewer)
+        {
+          input->server->viewers = g_list_remove (input->server->viewers, input);
+          if (input->server->output)
+            broadway_output_remove_mirror (input->server->output, input->output);
+          broadway_output_free (input->output);
+        }
       broadway_input_free (input);
       if (res < 0)
         {
@@ -839,6 +980,18 @@ input_data_cb (GObject  *stream,
   return TRUE;
 }
 
+/* Returns the round trip time to the main client in microseconds,
+ * or 0 if it is not known.
+ */
+gint64
+broadway_server_get_round_trip_time (BroadwayServer *server)
+{
+  if (server->input)
+    return server->input->round_trip_time;
+
+  return 0;
+}
+
 guint32
 broadway_server_get_next_serial (BroadwayServer *server)
 {
@@ -971,8 +1124,52 @@ generate_handshake_response_wsietf_v7 (const gchar *key)
   return g_base64_encode (digest, digest_len);
 }
 
+/* Returns TRUE if one of the offers in the Sec-WebSocket-Extensions
+ * header is permessage-deflate with parameters we can satisfy, see
+ * RFC 7692. GZlibCompressor always uses a window of 15 bits, so offers
+ * that limit the server window are declined.
+ */
+static gboolean
+parse_deflate_offers (const char *extensions,
+                      gboolean   *server_no_context_takeover)
+{
+  char **offers;
+  gboolean found = FALSE;
+  int i, j;
+
+  offers = g_strsplit (extensions, ",", 0);
+  for (i = 0; offers[i] != NULL && !found; i++)
+    {
+      char **params = g_strsplit (offers[i], ";", 0);
+      gboolean ok;
+
+      ok = strcmp (g_strstrip (params[0]), "permessage-deflate") == 0;
+      *server_no_context_takeover = FALSE;
+
+      for (j = 1; ok && params[j] != NULL; j++)
+        {
+          const char *param = g_strstrip (params[j]);
+
+          if (strcmp (param, "server_no_context_takeover") == 0)
+            *server_no_context_takeover = TRUE;
+          else if (strcmp (param, "client_no_context_takeover") == 0 ||
+                   g_str_has_prefix (param, "client_max_window_bits"))
+            ; /* Only affects how the client compresses */
+          else if (strcmp (param, "server_max_window_bits=15") != 0)
+            ok = FALSE;
+        }
+
+      found = ok;
+      g_strfreev (params);
+    }
+  g_strfreev (offers);
+
+  return found;
+}
+
 static void
-start_input (HttpRequest *request)
+start_input (HttpRequest *request,
+             gboolean     viewer)
 {
   char **lines;
   const char *p;
@@ -984,6 +1181,8 @@ start_input (HttpRequest *request)
   gsize data_buffer_size;
   GInputStream *in;
   const char *key;
+  const char *extensions;
+  gboolean deflate, no_context_takeover;
   GSocket *socket;
   int flag = 1;
 
@@ -995,10 +1194,13 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  extensions = NULL;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
         key = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        extensions = p;
       else if ((p = parse_line (lines[i], "Origin")))
         origin = p;
       else if ((p = parse_line (lines[i], "Host")))
@@ -1014,6 +1216,11 @@ start_input (HttpRequest *request)
       return;
     }
 
+  no_context_takeover = FALSE;
+  deflate = request->server->compression_level != 0 &&
+            extensions != NULL &&
+            parse_deflate_offers (extensions, &no_context_takeover);
+
   if (key != NULL)
     {
       char* accept = generate_handshake_response_wsietf_v7 (key);
@@ -1022,11 +1229,15 @@ start_input (HttpRequest *request)
                              "Connection: Upgrade\r\n"
                              "Sec-WebSocket-Accept: %s\r\n"
                              "%s%s%s"
-                             "Sec-WebSocket-Location: ws://%s/socket\r\n"
+                             "%s"
+                             "Sec-WebSocket-Location: ws://%s/%s\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
-                             host);
+                             !deflate ? "" :
+                             no_context_takeover ? "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover\r\n" :
+                                                   "Sec-WebSocket-Extensions: permessage-deflate\r\n",
+                             host, viewer ? "socket-view" : "socket");
       g_free (accept);
 
 #ifdef DEBUG_WEBSOCKETS
@@ -1056,8 +1267,23 @@ start_input (HttpRequest *request)
   input->buffer = g_byte_array_sized_new (data_buffer_size);
   g_byte_array_append (input->buffer, data_buffer, data_buffer_size);
 
-  input->output =
-    broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
+  input->viewer = viewer;
+  /* A slow viewer must not block the application */
+  if (viewer)
+    input->output =
+      broadway_output_new_nonblocking (g_io_stream_get_output_stream (request->connection), 0);
+  else
+    input->output =
+      broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
+
+  if (deflate)
+    {
+      broadway_output_set_deflate (input->output,
+                                   request->server->compression_level,
+                                   no_context_takeover);
+      input->inflate = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+      input->inflate_buf = g_byte_array_new ();
+    }
 
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
@@ -1068,7 +1294,10 @@ start_input (HttpRequest *request)
   g_source_set_callback (input->source, (GSourceFunc)input_data_cb, input, NULL);
   g_source_attach (input->source, NULL);
 
-  start (input);
+  if (viewer)
+    start_viewer (input);
+  else
+    start (input);
 
   /* Process any data in the pipe already */
   parse_input (input);
@@ -1091,17 +1320,81 @@ send_outstanding_roundtrips (BroadwayServer *server)
   server->outstanding_roundtrips = NULL;
 }
 
+/* Resyncs a viewer from scratch, either when it starts, when it
+ * fell behind, or when there is a new main client to mirror.
+ */
+static void
+resync_viewer (BroadwayServer *server,
+               BroadwayInput  *viewer)
+{
+  /* Anything queued for the main client already happened in the
+     state we send now, so the viewer must not get it again */
+  broadway_server_flush (server);
+
+  broadway_output_reset (viewer->output);
+  broadway_server_write_state (server, viewer->output);
+  broadway_output_flush (viewer->output);
+
+  if (server->output)
+    broadway_output_add_mirror (server->output, viewer->output);
+}
+
+static void
+viewer_drained_cb (BroadwayOutput *output,
+                   gpointer        user_data)
+{
+  BroadwayInput *viewer = user_data;
+
+  resync_viewer (viewer->server, viewer);
+}
+
+/* Viewers get the same data as the main client, encoded only once,
+ * and their input is ignored.
+ */
+static void
+start_viewer (BroadwayInput *input)
+{
+  BroadwayServer *server = input->server;
+
+  server->viewers = g_list_prepend (server->viewers, input);
+  broadway_output_set_drained_func (input->output, viewer_drained_cb, input);
+
+  resync_viewer (server, input);
+}
+
+static gboolean
+send_ping_cb (gpointer user_data)
+{
+  BroadwayInput *input = user_data;
+
+  /* Browsers answer websocket pings by themselves */
+  if (input->ping_time == 0)
+    {
+      input->ping_time = g_get_monotonic_time ();
+      broadway_output_ping (input->output);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
 static void
 start (BroadwayInput *input)
 {
   BroadwayServer *server;
+  GList *l;
 
   input->active = TRUE;
+  input->ping_timeout = g_timeout_add_seconds (PING_INTERVAL, send_ping_cb, input);
 
   server = BROADWAY_SERVER (input->server);
 
   if (server->output)
     {
+      /* Viewers must not see the disconnect */
+      for (l = server->viewers; l != NULL; l = l->next)
+        broadway_output_remove_mirror (server->output,
+                                       ((BroadwayInput *)l->data)->output);
+
       send_outstanding_roundtrips (server);
       broadway_output_disconnected (server->output);
       broadway_output_flush (server->output);
@@ -1133,6 +1426,10 @@ start (BroadwayInput *input)
                                   server->pointer_grab_surface_id,
                                   server->pointer_grab_owner_events);
 
+  /* The main client gets new surfaces, so viewers need a resync */
+  for (l = server->viewers; l != NULL; l = l->next)
+    resync_viewer (server, l->data);
+
   process_input_messages (server);
 }
 
@@ -1200,7 +1497,9 @@ got_request (HttpRequest *request)
   else if (strcmp (escaped, "/broadway.js") == 0)
     send_data (request, "text/javascript", broadway_js, G_N_ELEMENTS(broadway_js) - 1);
   else if (strcmp (escaped, "/socket") == 0)
-    start_input (request);
+    start_input (request, FALSE);
+  else if (strcmp (escaped, "/socket-view") == 0)
+    start_input (request, TRUE);
   else
     send_error (request, 404, "File not found");
 
@@ -1365,6 +1664,20 @@ broadway_server_new (char        *address,
   return server;
 }
 
+/* Sets the zlib compression level for clients that support
+ * permessage-deflate, from 1 (fastest) to 9 (best), or -1 for the
+ * zlib default. 0 turns compression off. This applies to clients
+ * that connect afterwards.
+ */
+void
+broadway_server_set_compression_level (BroadwayServer *server,
+                                       int             level)
+{
+  g_return_if_fail (level >= -1 && level <= 9);
+
+  server->compression_level = level;
+}
+
 BroadwayServer *
 broadway_server_on_unix_socket_new (char *address, GError **error)
 {
@@ -1822,20 +2135,19 @@ broadway_server_new_surface (BroadwayServer *server,
   return surface->id;
 }
 
+/* Sends everything a new client needs to know */
 static void
-broadway_server_resync_surfaces (BroadwayServer *server)
+broadway_server_write_state (BroadwayServer *server,
+                             BroadwayOutput *output)
 {
   GHashTableIter iter;
   gpointer key, value;
   GList *l;
 
-  if (server->output == NULL)
-    return;
-
   /* First upload all textures */
   g_hash_table_iter_init (&iter, server->textures);
   while (g_hash_table_iter_next (&iter, &key, &value))
-    broadway_output_upload_texture (server->output,
+    broadway_output_upload_texture (output,
                                     GPOINTER_TO_INT (key),
                                     (GBytes *)value);
 
@@ -1847,7 +2159,7 @@ broadway_server_resync_surfaces (BroadwayServer *server)
       if (surface->id == 0)
         continue; /* Skip root */
 
-      broadway_output_new_surface (server->output,
+      broadway_output_new_surface (output,
                                    surface->id,
                                    surface->x,
                                    surface->y,
@@ -1865,19 +2177,28 @@ broadway_server_resync_surfaces (BroadwayServer *server)
         continue; /* Skip root */
 
       if (surface->transient_for != -1)
-        broadway_output_set_transient_for (server->output, surface->id,
+        broadway_output_set_transient_for (output, surface->id,
                                            surface->transient_for);
 
       if (surface->nodes)
-        broadway_output_surface_set_nodes (server->output, surface->id,
+        broadway_output_surface_set_nodes (output, surface->id,
                                            surface->nodes, NULL);
 
       if (surface->visible)
-        broadway_output_show_surface (server->output, surface->id);
+        broadway_output_show_surface (output, surface->id);
     }
 
   if (server->show_keyboard)
-    broadway_output_set_show_keyboard (server->output, TRUE);
+    broadway_output_set_show_keyboard (output, TRUE);
+}
+
+static void
+broadway_server_resync_surfaces (BroadwayServer *server)
+{
+  if (server->output == NULL)
+    return;
+
+  broadway_server_write_state (server, server->output);
 
   broadway_server_flush (server);
 }
@@ -22,7 +22,9 @@ typedef struct _BroadwayNode BroadwayNode;
 
 struct _BroadwayNode {
   guint32 type;
+  guint32 id; /* client side id, assigned when sent */
   guint32 hash; /* deep hash */
+  gboolean reused; /* set while diffing a new tree against this one */
   guint32 n_children;
   BroadwayNode **children;
   guint32 n_data;
@@ -40,6 +42,8 @@ BroadwayServer     *broadway_server_new                       (char            *
                                                                GError         **error);
 BroadwayServer     *broadway_server_on_unix_socket_new        (char            *address,
                                                                GError         **error);
+void                broadway_server_set_compression_level     (BroadwayServer  *server,
+                                                               int              level);
 gboolean            broadway_server_has_client                (BroadwayServer  *server);
 void                broadway_server_flush                     (BroadwayServer  *server);
 void                broadway_server_sync                      (BroadwayServer  *server);
@@ -51,6 +55,7 @@ void                broadway_server_get_screen_size           (BroadwayServer  *
                                                                guint32         *height);
 guint32             broadway_server_get_next_serial           (BroadwayServer  *server);
 guint32             broadway_server_get_last_seen_time        (BroadwayServer  *server);
+gint64              broadway_server_get_round_trip_time       (BroadwayServer  *server);
 gboolean            broadway_server_lookahead_event           (BroadwayServer  *server,
                                                                const char      *types);
 void                broadway_server_query_mouse               (BroadwayServer  *server,
@@ -137,6 +137,7 @@ var positionIndex = 0;
 function cmdCreateSurface(id, x, y, width, height, isTemp)
 {
     var surface = { id: id, x: x, y:y, width: width, height: height, isTemp: isTemp };
+    surface.nodes = {};
     surface.positioned = isTemp;
     surface.transientParent = 0;
     surface.visible = false;
@@ -246,6 +247,14 @@ function cmdDeleteSurface(id)
     delete surfaces[id];
 }
 
+function cmdReset()
+{
+    for (var id in surfaces)
+        cmdDeleteSurface(id);
+    for (var id in textures)
+        cmdReleaseTexture(id);
+}
+
 function cmdRoundtrip(id, tag)
 {
     sendInput("F", [id, tag]);
@@ -297,12 +306,11 @@ function cmdLowerSurface(id)
     restackSurfaces();
 }
 
-function SwapNodes(node_data, div) {
+function SwapNodes(node_data, nodes) {
     this.node_data = node_data;
     this.node_data_signed = new Int32Array(node_data);
     this.data_pos = 0;
-    this.div = div;
-    this.outstanding = 1;
+    this.nodes = nodes;
 }
 
 SwapNodes.prototype.decode_uint32 = function() {
@@ -415,18 +423,28 @@ function set_rrect_style (div, rrect) {
     div.style["border-bottom-left-radius"] = args(px(rrect.sizes[3].width), px(rrect.sizes[3].height));
 }
 
-SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
+/* Decodes len nodes and makes them the children of div, in order.
+ * The children may be old dom nodes that are moved here from
+ * somewhere else in the tree. */
+SwapNodes.prototype.decodeChildren = function(div, len)
+{
+    for (var i = 0; i < len; i++) {
+        var child = this.decodeNode();
+        if (div.children[i] != child)
+            div.insertBefore(child, div.children[i] || null);
+    }
+
+    /* Remove old children that are after the new length */
+    while (div.children.length > len)
+        div.removeChild(div.lastChild);
+}
+
+SwapNodes.prototype.decodeNode = function()
 {
     var type = this.decode_uint32();
+    var id = this.decode_uint32();
     var newNode = null;
 
-    // We need to dup this because as we reuse children the original order is lost
-    var oldChildren = [];
-    if (oldNode) {
-        for (var i = 0; i < oldNode.children.length; i++)
-            oldChildren[i] = oldNode.children[i];
-    }
-
     switch (type)
     {
         /* Leaf nodes */
@@ -576,7 +594,7 @@ SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
             div.style["position"] = "absolute";
             set_rect_style(div, rect);
             div.style["overflow"] = "hidden";
-            this.insertNode(div, -1, oldChildren[0]);
+            this.decodeChildren(div, 1);
             newNode = div;
         }
         break;
@@ -588,7 +606,7 @@ SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
             div.style["position"] = "absolute";
             set_rrect_style(div, rrect);
             div.style["overflow"] = "hidden";
-            this.insertNode(div, -1, oldChildren[0]);
+            this.decodeChildren(div, 1);
             newNode = div;
         }
         break;
@@ -602,7 +620,7 @@ SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
             div.style["top"] = px(0);
             div.style["opacity"] = opacity;
 
-            this.insertNode(div, -1, oldChildren[0]);
+            this.decodeChildren(div, 1);
             newNode = div;
         }
         break;
@@ -624,7 +642,7 @@ SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
             div.style["top"] = px(0);
             div.style["filter"] = filters;
 
-            this.insertNode(div, -1, oldChildren[0]);
+            this.decodeChildren(div, 1);
             newNode = div;
         }
         break;
@@ -635,61 +653,37 @@ SwapNodes.prototype.insertNode = function(parent, posInParent, oldNode)
         {
             var div = document.createElement('div');
             var len = this.decode_uint32();
-            for (var i = 0; i < len; i++) {
-                this.insertNode(div, -1, oldChildren[i]);
-            }
+            this.decodeChildren(div, len);
             newNode = div;
         }
         break;
 
     case 11:  // KEEP_ALL
         {
-            if (!oldNode)
-                alert("KEEP_ALL with no oldNode");
-
-            if (oldNode.parentNode != parent)
-                newNode = oldNode;
-            else
-                newNode = null;
+            newNode = this.nodes[id];
+            if (!newNode)
+                alert("KEEP_ALL with unknown node " + id);
+            return newNode;
         }
-        break;
 
     case 12:  // KEEP_THIS
         {
-            if (!oldNode)
-                alert("KEEP_THIS with no oldNode ");
-
-            /* We only get keep-this if all parents were kept, check this */
-            if (oldNode.parentNode != parent)
-                alert("Got KEEP_THIS for non-kept parent");
+            newNode = this.nodes[id];
+            if (!newNode)
+                alert("KEEP_THIS with unknown node " + id);
 
+            /* Keep the dom node as is, but update its children */
             var len = this.decode_uint32();
-            var i;
-
-            for (i = 0; i < len; i++) {
-                this.insertNode(oldNode, i,
-                                oldChildren[i]);
-            }
-
-            /* Remove children that are after the new length */
-            for (i = oldChildren.length - 1; i > len - 1; i--)
-                oldNode.removeChild(oldChildren[i]);
-
-            /* NOTE: No need to modify the parent, we're keeping this node as is */
-            newNode = null;
+            this.decodeChildren(newNode, len);
+            return newNode;
         }
-        break;
 
     default:
         alert("Unexpected node type " + type);
     }
 
-    if (newNode) {
-        if (posInParent >= 0 && parent.children[posInParent])
-            parent.replaceChild(newNode, parent.children[posInParent]);
-        else
-            parent.appendChild(newNode);
-    }
+    this.nodes[id] = newNode;
+    return newNode;
 }
 
 function cmdSurfaceSetNodes(id, node_data)
@@ -701,8 +695,19 @@ function cmdSurfaceSetNodes(id, node_data)
 
     /* We use a secondary div so that we can remove all previous children in one go */
 
-    var swap = new SwapNodes (node_data, div);
-    swap.insertNode(div, 0, div.firstChild);
+    var swap = new SwapNodes (node_data, surface.nodes);
+    var root = swap.decodeNode();
+    if (div.firstChild != root) {
+        while (div.firstChild)
+            div.removeChild(div.firstChild);
+        div.appendChild(root);
+    }
+
+    /* Forget the old nodes that were not reused */
+    var n_removed = swap.decode_uint32();
+    for (var i = 0; i < n_removed; i++)
+        delete surface.nodes[swap.decode_uint32()];
+
     if (swap.data_pos != node_data.length)
         alert ("Did not consume entire array (len " + node_data.length + " end " + end + ")");
 }
@@ -752,6 +757,10 @@ function handleCommands(cmd)
             inputSocket = null;
             break;
 
+        case 'x': // Reset
+            cmdReset();
+            break;
+
         case 's': // create new surface
             id = cmd.get_16();
             x = cmd.get_16s();
@@ -2818,6 +2827,7 @@ function connect()
 {
     var url = window.location.toString();
     var query_string = url.split("?");
+    var socket = "/socket";
     if (query_string.length > 1) {
         var params = query_string[1].split("&");
 
@@ -2825,11 +2835,13 @@ function connect()
             var pair = params[i].split("=");
             if (pair[0] == "debug" && pair[1] == "decoding")
                 debugDecoding = true;
+            if (pair[0] == "view")
+                socket = "/socket-view";
         }
     }
 
     var loc = window.location.toString().replace("http:", "ws:").replace("https:", "wss:");
-    loc = loc.substr(0, loc.lastIndexOf('/')) + "/socket";
+    loc = loc.substr(0, loc.lastIndexOf('/')) + socket;
     ws = new WebSocket(loc, "broadway");
     ws.binaryType = "arraybuffer";
 
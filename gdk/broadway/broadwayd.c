@@ -298,6 +298,8 @@ decode_nodes (BroadwayClient *client,
 
   node = g_malloc (sizeof(BroadwayNode) + (size - 1) * sizeof(guint32) + n_children * sizeof (BroadwayNode *));
   node->type = type;
+  node->id = 0;
+  node->reused = FALSE;
   node->n_children = n_children;
   node->children = (BroadwayNode **)((char *)node + sizeof(BroadwayNode) + (size - 1) * sizeof(guint32));
   node->n_data = size;
@@ -648,6 +650,7 @@ main (int argc, char *argv[])
   int http_port = 0;
   char *ssl_cert = NULL;
   char *ssl_key = NULL;
+  int compression_level = -1;
   const char *display;
   int port = 0;
   const GOptionEntry entries[] = {
@@ -658,6 +661,7 @@ main (int argc, char *argv[])
 #endif
     { "cert", 'c', 0, G_OPTION_ARG_STRING, &ssl_cert, "SSL certificate path", "PATH" },
     { "key", 'k', 0, G_OPTION_ARG_STRING, &ssl_key, "SSL key path", "PATH" },
+    { "compression-level", 0, 0, G_OPTION_ARG_INT, &compression_level, "Websocket compression level, 0 to disable", "LEVEL" },
     { NULL }
   };
 
@@ -671,6 +675,12 @@ main (int argc, char *argv[])
       exit (1);
     }
 
+  if (compression_level < -1 || compression_level > 9)
+    {
+      g_printerr ("Compression level must be between 0 and 9\n");
+      exit (1);
+    }
+
   display = NULL;
   if (argc > 1)
     {
@@ -724,6 +734,7 @@ main (int argc, char *argv[])
       g_printerr ("%s\n", error->message);
       return 1;
     }
+  broadway_server_set_compression_level (server, compression_level);
 
   listener = g_socket_service_new ();
   if (!g_socket_listener_add_address (G_SOCKET_LISTENER (listener),
@@ -14,6 +14,7 @@
 
 #include "gdkprivate-broadway.h"
 #include <gdk/gdktextureprivate.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -35,6 +36,7 @@
 #include "gdkintl.h"
 
 typedef struct BroadwayInput BroadwayInput;
+typedef struct PendingUpload PendingUpload;
 
 struct _GdkBroadwayServer {
   GObject parent_instance;
@@ -48,6 +50,21 @@ struct _GdkBroadwayServer {
 
   guint process_input_idle;
   GList *incomming;
+
+  /* Textures are encoded in worker threads, and sent in order
+     before any other message */
+  GThreadPool *upload_pool;
+  GMutex upload_lock;
+  GCond upload_cond;
+  GQueue pending_uploads;
+};
+
+struct PendingUpload {
+  guint32 id;
+  cairo_surface_t *surface;
+  int fd;
+  gsize size;
+  gboolean done;
 };
 
 struct _GdkBroadwayServerClass
@@ -66,11 +83,30 @@ gdk_broadway_server_init (GdkBroadwayServer *server)
 {
   server->next_serial = 1;
   server->next_texture_id = 1;
+  g_mutex_init (&server->upload_lock);
+  g_cond_init (&server->upload_cond);
+  g_queue_init (&server->pending_uploads);
+}
+
+static void
+pending_upload_free (PendingUpload *upload)
+{
+  if (upload->fd != -1)
+    close (upload->fd);
+  g_slice_free (PendingUpload, upload);
 }
 
 static void
 gdk_broadway_server_finalize (GObject *object)
 {
+  GdkBroadwayServer *server = GDK_BROADWAY_SERVER (object);
+
+  if (server->upload_pool)
+    g_thread_pool_free (server->upload_pool, FALSE, TRUE);
+  g_queue_clear_full (&server->pending_uploads, (GDestroyNotify)pending_upload_free);
+  g_mutex_clear (&server->upload_lock);
+  g_cond_clear (&server->upload_cond);
+
   G_OBJECT_CLASS (gdk_broadway_server_parent_class)->finalize (object);
 }
 
@@ -162,6 +198,8 @@ _gdk_broadway_server_get_last_seen_time (GdkBroadwayServer *server)
   return 0;
 }
 
+static void gdk_broadway_server_flush_uploads (GdkBroadwayServer *server);
+
 static guint32
 gdk_broadway_server_send_message_with_size (GdkBroadwayServer *server, BroadwayRequestBase *base,
                                             gsize size, guint32 type, int fd)
@@ -170,6 +208,10 @@ gdk_broadway_server_send_message_with_size (GdkBroadwayServer *server, BroadwayR
   gsize written;
   guchar *buf;
 
+  /* Later messages may refer to the uploaded textures */
+  if (type != BROADWAY_REQUEST_UPLOAD_TEXTURE)
+    gdk_broadway_server_flush_uploads (server);
+
   base->size = size;
   base->type = type;
   base->serial = server->next_serial++;
@@ -611,58 +653,105 @@ open_shared_memory (void)
   return ret;
 }
 
-typedef struct {
-  int fd;
-  gsize size;
-} PngData;
-
-static cairo_status_t
-write_png_cb (void         *closure,
-              const guchar *data,
-              unsigned int  length)
+static gboolean
+write_png_cb (const gchar  *data,
+              gsize         length,
+              GError      **error,
+              gpointer      user_data)
 {
-  PngData *png_data = closure;
-  int fd = png_data->fd;
+  PendingUpload *upload = user_data;
 
   while (length)
     {
-      gssize ret = write (fd, data, length);
+      gssize ret = write (upload->fd, data, length);
 
       if (ret <= 0)
-        return CAIRO_STATUS_WRITE_ERROR;
+        return FALSE;
 
-      png_data->size += ret;
+      upload->size += ret;
       length -= ret;
       data += ret;
     }
 
-  return CAIRO_STATUS_SUCCESS;
+  return TRUE;
+}
+
+/* Runs in a worker thread */
+static void
+encode_texture (gpointer data,
+                gpointer user_data)
+{
+  PendingUpload *upload = data;
+  GdkBroadwayServer *server = user_data;
+  GdkPixbuf *pixbuf;
+
+  /* The browser has to decode what we send every time, so this
+     is about speed, not size. A low compression level is many
+     times faster to encode than the default one. */
+  pixbuf = gdk_pixbuf_get_from_surface (upload->surface, 0, 0,
+                                        cairo_image_surface_get_width (upload->surface),
+                                        cairo_image_surface_get_height (upload->surface));
+  gdk_pixbuf_save_to_callback (pixbuf, write_png_cb, upload, "png", NULL,
+                               "compression", "1",
+                               NULL);
+  g_object_unref (pixbuf);
+
+  g_mutex_lock (&server->upload_lock);
+  upload->done = TRUE;
+  g_cond_broadcast (&server->upload_cond);
+  g_mutex_unlock (&server->upload_lock);
+}
+
+static void
+gdk_broadway_server_flush_uploads (GdkBroadwayServer *server)
+{
+  PendingUpload *upload;
+
+  while ((upload = g_queue_pop_head (&server->pending_uploads)) != NULL)
+    {
+      BroadwayRequestUploadTexture msg;
+
+      g_mutex_lock (&server->upload_lock);
+      while (!upload->done)
+        g_cond_wait (&server->upload_cond, &server->upload_lock);
+      g_mutex_unlock (&server->upload_lock);
+
+      cairo_surface_destroy (upload->surface);
+
+      msg.id = upload->id;
+      msg.offset = 0;
+      msg.size = upload->size;
+
+      /* This passes ownership of fd */
+      gdk_broadway_server_send_fd_message (server, msg,
+                                           BROADWAY_REQUEST_UPLOAD_TEXTURE, upload->fd);
+      upload->fd = -1;
+      pending_upload_free (upload);
+    }
 }
 
 guint32
 gdk_broadway_server_upload_texture (GdkBroadwayServer *server,
                                     GdkTexture        *texture)
 {
-  guint32 id;
-  cairo_surface_t *surface = gdk_texture_download_surface (texture);
-  BroadwayRequestUploadTexture msg;
-  PngData data;
+  PendingUpload *upload;
 
-  id = server->next_texture_id++;
+  if (server->upload_pool == NULL)
+    server->upload_pool = g_thread_pool_new (encode_texture, server,
+                                             g_get_num_processors (),
+                                             FALSE, NULL);
 
-  data.fd = open_shared_memory ();
-  data.size = 0;
-  cairo_surface_write_to_png_stream (surface, write_png_cb, &data);
+  upload = g_slice_new0 (PendingUpload);
+  upload->id = server->next_texture_id++;
+  upload->surface = gdk_texture_download_surface (texture);
+  upload->fd = open_shared_memory ();
 
-  msg.id = id;
-  msg.offset = 0;
-  msg.size = data.size;
+  /* The texture is sent with the next message, which is
+     usually the node tree that uses it */
+  g_queue_push_tail (&server->pending_uploads, upload);
+  g_thread_pool_push (server->upload_pool, upload, NULL);
 
-  /* This passes ownership of fd */
-  gdk_broadway_server_send_fd_message (server, msg,
-                                       BROADWAY_REQUEST_UPLOAD_TEXTURE, data.fd);
-
-  return id;
+  return upload->id;
 }
 
 
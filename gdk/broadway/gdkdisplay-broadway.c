@@ -96,6 +96,11 @@ gdk_texture_equal (GdkTexture *a,
   return res;
 }
 
+/* This hashes all of the contents, so that textures that only
+ * differ in some pixels (like icons with the same background)
+ * don't all end up in the same bucket and get compared in full.
+ * Computing it needs a download, so we keep it around.
+ */
 static guint
 gdk_texture_hash (GdkTexture *self)
 {
@@ -103,30 +108,33 @@ gdk_texture_hash (GdkTexture *self)
   unsigned char *data;
   int stride;
   guint32 *row;
-  guint64 sum;
-  int x, y, width, height;
+  int x, y;
   guint h;
 
+  h = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (self), "broadway-hash"));
+  if (h != 0)
+    return h;
+
   surface = gdk_texture_download_surface (self);
   data = cairo_image_surface_get_data (surface);
   stride = cairo_image_surface_get_stride (surface);
 
-  width = MIN (self->width, 4);
-  height = MIN (self->height, 4);
-
-  sum = 0;
-  for (y = 0; y < height; y++, data += stride)
+  h = self->width ^ (self->height << 16);
+  for (y = 0; y < self->height; y++, data += stride)
     {
       row = (guint32 *)data;
-      for (x = 0; x < width; x++)
-        sum += row[x];
+      for (x = 0; x < self->width; x++)
+        h = (h << 5) + h + row[x];
     }
 
   cairo_surface_destroy (surface);
 
-  h = sum / (width * height);
+  if (h == 0)
+    h = 1;
+
+  g_object_set_data (G_OBJECT (self), "broadway-hash", GUINT_TO_POINTER (h));
 
-  return h ^ self->width ^ (self->height << 16);
+  return h;
 }
 
 static void   gdk_broadway_display_dispose            (GObject            *object);
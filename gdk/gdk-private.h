@@ -3,6 +3,7 @@
 
 #include <gdk/gdk.h>
 #include "gdk/gdkinternals.h"
+#include "gdk/gdkmemorystatsprivate.h"
 
 /* Private API for use in GTK+ */
 
@@ -42,4 +43,10 @@ void gdk_display_set_cursor_theme          (GdkDisplay   *display,
                                             const char   *theme,
                                             int           size);
 
+void            gdk_frame_timings_add_render_times (GdkFrameTimings *timings,
+                                                    gint64           snapshot_time,
+                                                    gint64           render_time);
+gint64          gdk_frame_timings_get_snapshot_time (GdkFrameTimings *timings);
+gint64          gdk_frame_timings_get_render_time   (GdkFrameTimings *timings);
+
 #endif /* __GDK__PRIVATE_H__ */
@@ -27,6 +27,7 @@
 #include "gdkversionmacros.h"
 
 #include "gdkinternals.h"
+#include "gdkprofilerprivate.h"
 #include "gdkintl.h"
 
 #include "gdkresources.h"
@@ -179,8 +180,14 @@ gdk_ensure_resources (void)
 void
 gdk_pre_parse (void)
 {
+  const char *trace_file;
+
   gdk_initialized = TRUE;
 
+  trace_file = g_getenv ("GDK_TRACE");
+  if (trace_file != NULL)
+    gdk_profiler_start (trace_file);
+
   gdk_ensure_resources ();
 
 #ifdef G_ENABLE_DEBUG
@@ -52,6 +52,9 @@ struct _Serializer
 
 GQueue serializers = G_QUEUE_INIT;
 
+/* GType => GdkContentFormats with the mime types it can be serialized to */
+static GHashTable *mime_types_for_gtype = NULL;
+
 static void init (void);
 
 #define GDK_CONTENT_SERIALIZER_CLASS(klass)      (G_TYPE_CHECK_CLASS_CAST ((klass), GDK_TYPE_CONTENT_SERIALIZER, GdkContentSerializerClass))
@@ -398,6 +401,9 @@ gdk_content_register_serializer (GType                    type,
 
   serializer->mime_type = g_intern_string (mime_type);
   serializer->type = type;
+
+  if (mime_types_for_gtype)
+    g_hash_table_remove_all (mime_types_for_gtype);
   serializer->serialize = serialize;
   serializer->data = data;
   serializer->notify = notify;
@@ -473,26 +479,57 @@ gdk_content_formats_union_serialize_gtypes (GdkContentFormats *formats)
  *
  * Return: a new #GdkContentFormats
  */
-GdkContentFormats *
-gdk_content_formats_union_serialize_mime_types (GdkContentFormats *formats)
+static GdkContentFormats *
+lookup_mime_types_for_gtype (GType type)
 {
+  GdkContentFormats *result;
   GdkContentFormatsBuilder *builder;
   GList *l;
 
-  g_return_val_if_fail (formats != NULL, NULL);
+  if (mime_types_for_gtype == NULL)
+    mime_types_for_gtype = g_hash_table_new_full (NULL, NULL,
+                                                  NULL, (GDestroyNotify) gdk_content_formats_unref);
 
-  init ();
+  result = g_hash_table_lookup (mime_types_for_gtype, GSIZE_TO_POINTER (type));
+  if (result)
+    return result;
 
   builder = gdk_content_formats_builder_new ();
-  gdk_content_formats_builder_add_formats (builder, formats);
-
   for (l = g_queue_peek_head_link (&serializers); l; l = l->next)
     {
       Serializer *serializer = l->data;
 
-      if (gdk_content_formats_contain_gtype (formats, serializer->type))
+      if (serializer->type == type)
         gdk_content_formats_builder_add_mime_type (builder, serializer->mime_type);
     }
+  result = gdk_content_formats_builder_free (builder);
+
+  g_hash_table_insert (mime_types_for_gtype, GSIZE_TO_POINTER (type), result);
+
+  return result;
+}
+
+GdkContentFormats *
+gdk_content_formats_union_serialize_mime_types (GdkContentFormats *formats)
+{
+  GdkContentFormatsBuilder *builder;
+  const GType *gtypes;
+  gsize i, n_gtypes;
+
+  g_return_val_if_fail (formats != NULL, NULL);
+
+  init ();
+
+  builder = gdk_content_formats_builder_new ();
+  gdk_content_formats_builder_add_formats (builder, formats);
+
+  /* This runs every time a clipboard is claimed or a drag is started,
+   * so remember the mime types for each type instead of going through
+   * all serializers, which are many for images.
+   */
+  gtypes = gdk_content_formats_get_gtypes (formats, &n_gtypes);
+  for (i = 0; i < n_gtypes; i++)
+    gdk_content_formats_builder_add_formats (builder, lookup_mime_types_for_gtype (gtypes[i]));
 
   gdk_content_formats_unref (formats);
 
@@ -658,10 +695,30 @@ string_serializer (GdkContentSerializer *serializer)
   GCharsetConverter *converter;
   GError *error = NULL;
   const char *text;
+  const char *charset;
+
+  text = g_value_get_string (gdk_content_serializer_get_value (serializer));
+  if (text == NULL)
+    text = "";
 
-  converter = g_charset_converter_new (gdk_content_serializer_get_user_data (serializer),
-                                       "utf-8",
-                                       &error);
+  charset = gdk_content_serializer_get_user_data (serializer);
+
+  /* Strings are UTF-8 already, so don't run big texts through
+   * a converter that copies them into its own buffers.
+   */
+  if (g_ascii_strcasecmp (charset, "utf-8") == 0)
+    {
+      g_output_stream_write_all_async (gdk_content_serializer_get_output_stream (serializer),
+                                       text,
+                                       strlen (text) + 1,
+                                       gdk_content_serializer_get_priority (serializer),
+                                       gdk_content_serializer_get_cancellable (serializer),
+                                       string_serializer_finish,
+                                       serializer);
+      return;
+    }
+
+  converter = g_charset_converter_new (charset, "utf-8", &error);
   if (converter == NULL)
     {
       gdk_content_serializer_return_error (serializer, error);
@@ -673,10 +730,6 @@ string_serializer (GdkContentSerializer *serializer)
                                           G_CONVERTER (converter));
   g_object_unref (converter);
 
-  text = g_value_get_string (gdk_content_serializer_get_value (serializer));
-  if (text == NULL)
-    text = "";
-
   g_output_stream_write_all_async (filter,
                                    text,
                                    strlen (text) + 1,
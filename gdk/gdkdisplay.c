@@ -395,6 +395,9 @@ gdk_display_dispose (GObject *object)
   g_list_free_full (display->queued_events, (GDestroyNotify) gdk_event_free);
   display->queued_events = NULL;
   display->queued_tail = NULL;
+  g_list_free (display->free_queue_links);
+  display->free_queue_links = NULL;
+  display->n_free_queue_links = 0;
 
   G_OBJECT_CLASS (gdk_display_parent_class)->dispose (object);
 }
@@ -516,6 +519,8 @@ gdk_display_put_event_nocopy (GdkDisplay *display,
                               GdkEvent   *event)
 {
   _gdk_event_queue_append (display, event);
+  /* Backends put drag events here, fold them like other motion */
+  _gdk_event_queue_handle_motion_compression (display);
   /* If the main loop is blocking in a different thread, wake it up */
   g_main_context_wakeup (NULL);
 }
@@ -76,6 +76,8 @@ struct _GdkDisplay
 
   GList *queued_events;
   GList *queued_tail;
+  GList *free_queue_links;       /* Recycled nodes for queued_events */
+  guint n_free_queue_links;
 
   guint event_pause_count;       /* How many times events are blocked */
 
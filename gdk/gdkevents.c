@@ -82,6 +82,7 @@ static GQuark quark_event_user_data = 0;
 
 static void gdk_event_constructed (GObject *object);
 static void gdk_event_finalize (GObject *object);
+static gboolean gdk_event_is_compressible (const GdkEvent *event);
 
 G_DEFINE_TYPE (GdkEvent, gdk_event, G_TYPE_OBJECT)
 
@@ -192,7 +193,7 @@ GList*
 _gdk_event_queue_find_first (GdkDisplay *display)
 {
   GList *tmp_list;
-  GList *pending_motion = NULL;
+  GList *pending_event = NULL;
 
   gboolean paused = display->event_pause_count > 0;
 
@@ -204,11 +205,11 @@ _gdk_event_queue_find_first (GdkDisplay *display)
       if ((event->any.flags & GDK_EVENT_PENDING) == 0 &&
 	  (!paused || (event->any.flags & GDK_EVENT_FLUSHED) != 0))
         {
-          if (pending_motion)
-            return pending_motion;
+          if (pending_event)
+            return pending_event;
 
-          if (event->any.type == GDK_MOTION_NOTIFY && (event->any.flags & GDK_EVENT_FLUSHED) == 0)
-            pending_motion = tmp_list;
+          if (gdk_event_is_compressible (event) && (event->any.flags & GDK_EVENT_FLUSHED) == 0)
+            pending_event = tmp_list;
           else
             return tmp_list;
         }
@@ -219,6 +220,59 @@ _gdk_event_queue_find_first (GdkDisplay *display)
   return NULL;
 }
 
+/* High-frequency input (1000Hz mice, tablets) pushes every single
+ * event through the queue, so we keep a few unlinked nodes around
+ * instead of going back to the allocator for each of them.
+ */
+#define MAX_FREE_QUEUE_LINKS 64
+
+static GList *
+gdk_event_queue_new_link (GdkDisplay *display,
+                          GdkEvent   *event)
+{
+  GList *link;
+
+  link = display->free_queue_links;
+  if (link)
+    {
+      display->free_queue_links = link->next;
+      display->n_free_queue_links--;
+      link->next = NULL;
+    }
+  else
+    link = g_list_alloc ();
+
+  link->data = event;
+
+  return link;
+}
+
+/**
+ * _gdk_event_queue_free_link:
+ * @display: a #GdkDisplay
+ * @node: a node that was removed from the event queue
+ *
+ * Releases a list node previously unlinked with
+ * _gdk_event_queue_remove_link(). The event it points to
+ * is not freed.
+ **/
+void
+_gdk_event_queue_free_link (GdkDisplay *display,
+                            GList      *node)
+{
+  if (display->n_free_queue_links >= MAX_FREE_QUEUE_LINKS)
+    {
+      g_list_free_1 (node);
+      return;
+    }
+
+  node->data = NULL;
+  node->prev = NULL;
+  node->next = display->free_queue_links;
+  display->free_queue_links = node;
+  display->n_free_queue_links++;
+}
+
 /**
  * _gdk_event_queue_append:
  * @display: a #GdkDisplay
@@ -232,14 +286,40 @@ GList *
 _gdk_event_queue_append (GdkDisplay *display,
 			 GdkEvent   *event)
 {
-  display->queued_tail = g_list_append (display->queued_tail, event);
-  
-  if (!display->queued_events)
-    display->queued_events = display->queued_tail;
+  GList *link;
+
+  link = gdk_event_queue_new_link (display, event);
+  link->prev = display->queued_tail;
+
+  if (display->queued_tail)
+    display->queued_tail->next = link;
   else
-    display->queued_tail = display->queued_tail->next;
+    display->queued_events = link;
 
-  return display->queued_tail;
+  display->queued_tail = link;
+
+  return link;
+}
+
+static GList *
+gdk_event_queue_link_before (GdkDisplay *display,
+                             GList      *sibling,
+                             GdkEvent   *event)
+{
+  GList *link;
+
+  link = gdk_event_queue_new_link (display, event);
+  link->prev = sibling->prev;
+  link->next = sibling;
+
+  if (sibling->prev)
+    sibling->prev->next = link;
+  else
+    display->queued_events = link;
+
+  sibling->prev = link;
+
+  return link;
 }
 
 /**
@@ -262,10 +342,7 @@ _gdk_event_queue_insert_after (GdkDisplay *display,
 {
   GList *prev = g_list_find (display->queued_events, sibling);
   if (prev && prev->next)
-    {
-      display->queued_events = g_list_insert_before (display->queued_events, prev->next, event);
-      return prev->next;
-    }
+    return gdk_event_queue_link_before (display, prev->next, event);
   else
     return _gdk_event_queue_append (display, event);
 }
@@ -290,10 +367,7 @@ _gdk_event_queue_insert_before (GdkDisplay *display,
 {
   GList *next = g_list_find (display->queued_events, sibling);
   if (next)
-    {
-      display->queued_events = g_list_insert_before (display->queued_events, next, event);
-      return next->prev;
-    }
+    return gdk_event_queue_link_before (display, next, event);
   else
     return _gdk_event_queue_append (display, event);
 }
@@ -343,24 +417,42 @@ _gdk_event_unqueue (GdkDisplay *display)
     {
       event = tmp_list->data;
       _gdk_event_queue_remove_link (display, tmp_list);
-      g_list_free_1 (tmp_list);
+      _gdk_event_queue_free_link (display, tmp_list);
     }
 
   return event;
 }
 
+static GList **
+gdk_event_history_location (GdkEvent *event)
+{
+  switch ((guint) event->any.type)
+    {
+    case GDK_MOTION_NOTIFY:
+      return &event->motion.history;
+    case GDK_TOUCH_UPDATE:
+      return &event->touch.history;
+    default:
+      return NULL;
+    }
+}
+
 static void
 gdk_event_push_history (GdkEvent       *event,
                         const GdkEvent *history_event)
 {
   GdkTimeCoord *hist;
   GdkDevice *device;
+  GList **history;
   gint i, n_axes;
 
-  g_assert (event->any.type == GDK_MOTION_NOTIFY);
-  g_assert (history_event->any.type == GDK_MOTION_NOTIFY);
+  g_assert (event->any.type == history_event->any.type);
+
+  history = gdk_event_history_location (event);
+  g_assert (history != NULL);
 
   hist = g_new0 (GdkTimeCoord, 1);
+  hist->time = gdk_event_get_time (history_event);
 
   device = gdk_event_get_device (history_event);
   n_axes = gdk_device_get_n_axes (device);
@@ -368,72 +460,149 @@ gdk_event_push_history (GdkEvent       *event,
   for (i = 0; i <= MIN (n_axes, GDK_MAX_TIMECOORD_AXES); i++)
     gdk_event_get_axis (history_event, i, &hist->axes[i]);
 
-  event->motion.history = g_list_prepend (event->motion.history, hist);
+  *history = g_list_prepend (*history, hist);
+}
+
+/* Events that only report a new state of something that is still
+ * ongoing, so that all but the last one of a kind can be dropped
+ * without losing information.
+ */
+static gboolean
+gdk_event_is_compressible (const GdkEvent *event)
+{
+  switch ((guint) event->any.type)
+    {
+    case GDK_MOTION_NOTIFY:
+    case GDK_TOUCH_UPDATE:
+    case GDK_DRAG_MOTION:
+      return TRUE;
+    case GDK_SCROLL:
+      return event->scroll.direction == GDK_SCROLL_SMOOTH &&
+             !event->scroll.is_stop;
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+gdk_event_can_compress_into (const GdkEvent *event,
+                             const GdkEvent *later)
+{
+  if (event->any.type != later->any.type ||
+      event->any.window != later->any.window ||
+      event->any.device != later->any.device)
+    return FALSE;
+
+  switch ((guint) event->any.type)
+    {
+    case GDK_TOUCH_UPDATE:
+      return event->touch.sequence == later->touch.sequence;
+    case GDK_DRAG_MOTION:
+      return event->dnd.context == later->dnd.context;
+    case GDK_SCROLL:
+      /* Modifiers change what scrolling means, e.g. zooming */
+      return event->scroll.state == later->scroll.state;
+    default:
+      return TRUE;
+    }
+}
+
+static void
+gdk_event_compress_into (GdkEvent *event,
+                         GdkEvent *later)
+{
+  GList **history;
+
+  switch ((guint) event->any.type)
+    {
+    case GDK_SCROLL:
+      later->scroll.delta_x += event->scroll.delta_x;
+      later->scroll.delta_y += event->scroll.delta_y;
+      return;
+
+    case GDK_DRAG_MOTION:
+      /* Only the latest position matters to drop sites */
+      return;
+
+    case GDK_MOTION_NOTIFY:
+      if ((later->motion.state &
+           (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
+            GDK_BUTTON4_MASK | GDK_BUTTON5_MASK)) == 0)
+        return;
+      break;
+
+    default:
+      break;
+    }
+
+  /* An earlier compression may have left history on this
+   * event, hand it over rather than freeing it.
+   */
+  history = gdk_event_history_location (later);
+  *history = g_list_concat (*gdk_event_history_location (event), *history);
+  *gdk_event_history_location (event) = NULL;
+
+  gdk_event_push_history (later, event);
 }
 
 void
 _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
 {
   GList *tmp_list;
-  GList *pending_motions = NULL;
-  GdkWindow *pending_motion_window = NULL;
-  GdkDevice *pending_motion_device = NULL;
-  GdkEvent *last_motion = NULL;
+  GList *pending_events = NULL;
 
-  /* If the last N events in the event queue are motion notify
-   * events for the same window, drop all but the last */
-
-  tmp_list = display->queued_tail;
-
-  while (tmp_list)
+  /* Look for the trailing run of compressible events in the event
+   * queue, and fold each of them into the last one of the run with
+   * the same window, device and (for touch) sequence.
+   */
+  for (tmp_list = display->queued_tail; tmp_list; tmp_list = tmp_list->prev)
     {
       GdkEvent *event = tmp_list->data;
 
       if (event->any.flags & GDK_EVENT_PENDING)
         break;
 
-      if (event->any.type != GDK_MOTION_NOTIFY)
-        break;
-
-      if (pending_motion_window != NULL &&
-          pending_motion_window != event->any.window)
-        break;
-
-      if (pending_motion_device != NULL &&
-          pending_motion_device != event->any.device)
+      if (!gdk_event_is_compressible (event))
         break;
 
-      if (!last_motion)
-        last_motion = event;
-
-      pending_motion_window = event->any.window;
-      pending_motion_device = event->any.device;
-      pending_motions = tmp_list;
-
-      tmp_list = tmp_list->prev;
+      pending_events = tmp_list;
     }
 
-  while (pending_motions && pending_motions->next != NULL)
+  while (pending_events && pending_events->next != NULL)
     {
-      GList *next = pending_motions->next;
+      GList *next = pending_events->next;
+      GdkEvent *event = pending_events->data;
 
-      if (last_motion &&
-          (last_motion->motion.state &
-           (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
-            GDK_BUTTON4_MASK | GDK_BUTTON5_MASK)))
-        gdk_event_push_history (last_motion, pending_motions->data);
+      for (tmp_list = display->queued_tail; tmp_list != pending_events; tmp_list = tmp_list->prev)
+        {
+          GdkEvent *later = tmp_list->data;
+
+          if (gdk_event_can_compress_into (event, later))
+            {
+              gdk_event_compress_into (event, later);
+              gdk_event_free (event);
+              _gdk_event_queue_remove_link (display, pending_events);
+              _gdk_event_queue_free_link (display, pending_events);
+              break;
+            }
+        }
 
-      gdk_event_free (pending_motions->data);
-      display->queued_events = g_list_delete_link (display->queued_events,
-                                                   pending_motions);
-      pending_motions = next;
+      pending_events = next;
     }
 
-  if (pending_motions &&
-      pending_motions == display->queued_events &&
-      pending_motions == display->queued_tail)
+  /* The last event of a run is held back until the frame clock flushes
+   * events, or until something else comes in after it. If it is all
+   * that is left, make sure the flush happens.
+   */
+  tmp_list = display->queued_events;
+  if (tmp_list &&
+      tmp_list == display->queued_tail &&
+      gdk_event_is_compressible (tmp_list->data) &&
+      (((GdkEvent *) tmp_list->data)->any.flags & (GDK_EVENT_PENDING | GDK_EVENT_FLUSHED)) == 0)
     {
-      GdkFrameClock *clock = gdk_window_get_frame_clock (pending_motion_window);
+      GdkWindow *window = ((GdkEvent *) tmp_list->data)->any.window;
+      GdkFrameClock *clock = window ? gdk_window_get_frame_clock (window) : NULL;
+
       if (clock) /* might be NULL if window was destroyed */
 	gdk_frame_clock_request_phase (clock, GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS);
     }
@@ -676,6 +845,9 @@ gdk_event_copy (const GdkEvent *event)
       if (event->touch.axes)
         new_event->touch.axes = g_memdup (event->touch.axes,
                                            sizeof (gdouble) * gdk_device_get_n_axes (event->any.device));
+      if (event->touch.history)
+        new_event->touch.history = g_list_copy_deep (event->touch.history,
+                                                     (GCopyFunc) copy_time_coord, NULL);
       break;
 
     case GDK_MOTION_NOTIFY:
@@ -752,6 +924,7 @@ gdk_event_finalize (GObject *object)
     case GDK_TOUCH_END:
     case GDK_TOUCH_CANCEL:
       g_free (event->touch.axes);
+      g_list_free_full (event->touch.history, g_free);
       break;
 
     case GDK_EXPOSE:
@@ -1919,6 +2092,33 @@ gdk_event_get_event_sequence (const GdkEvent *event)
   return NULL;
 }
 
+/**
+ * gdk_event_get_history:
+ * @event: a #GdkEvent of type %GDK_MOTION_NOTIFY or %GDK_TOUCH_UPDATE
+ *
+ * Retrieves the events that were compressed into @event because they
+ * arrived within the same frame. Each #GdkTimeCoord holds the time and
+ * the axes of one of them, indexed by #GdkAxisUse.
+ *
+ * Motion events only keep a history while a button is pressed.
+ *
+ * Returns: (transfer container) (element-type GdkTimeCoord) (nullable):
+ *   the compressed events, oldest first. Free the list with g_list_free().
+ */
+GList *
+gdk_event_get_history (const GdkEvent *event)
+{
+  GList **history;
+
+  g_return_val_if_fail (event != NULL, NULL);
+
+  history = gdk_event_history_location ((GdkEvent *) event);
+  if (history == NULL)
+    return NULL;
+
+  return g_list_reverse (g_list_copy (*history));
+}
+
 /**
  * gdk_set_show_events:
  * @show_events:  %TRUE to output event debugging information.
@@ -2565,21 +2765,3 @@ gdk_event_get_axes (GdkEvent  *event,
 
   return FALSE;
 }
-
-/**
- * gdk_event_get_history:
- * @event: a #GdkEvent of type %GDK_MOTION_NOTIFY
- *
- * Retrieves the history of the @event motion, as a list of time and
- * coordinates.
- *
- * Returns: (transfer container) (element-type GdkTimeCoord) (nullable): a list
- *   of time and coordinates
- */
-GList *
-gdk_event_get_history (const GdkEvent *event)
-{
-  if (event->any.type != GDK_MOTION_NOTIFY)
-    return NULL;
-  return g_list_reverse (g_list_copy (event->motion.history));
-}
@@ -532,6 +532,8 @@ GdkDisplay *gdk_event_get_display       (const GdkEvent  *event);
 
 GDK_AVAILABLE_IN_3_4
 GdkEventSequence *gdk_event_get_event_sequence (const GdkEvent *event);
+GDK_AVAILABLE_IN_ALL
+GList    *gdk_event_get_history         (const GdkEvent *event);
 
 GDK_AVAILABLE_IN_3_10
 GdkEventType gdk_event_get_event_type   (const GdkEvent *event);
@@ -615,7 +617,6 @@ GDK_AVAILABLE_IN_3_92
 gboolean       gdk_event_get_axes      (GdkEvent  *event,
                                         gdouble  **axes,
                                         guint     *n_axes);
-GList        * gdk_event_get_history   (const GdkEvent  *event);
 
 G_END_DECLS
 
@@ -107,6 +107,8 @@ struct _GdkEventExpose
  *   screen.
  * @y_root: the y coordinate of the pointer relative to the root of the
  *   screen.
+ * @history: the events that were compressed into this one, most recent
+ *   first. See gdk_event_get_history().
  *
  * Generated when the pointer moves.
  */
@@ -187,6 +189,8 @@ struct _GdkEventButton
  *   screen
  * @y_root: the y coordinate of the pointer relative to the root of the
  *   screen
+ * @history: the updates that were compressed into this one, most recent
+ *   first. See gdk_event_get_history().
  *
  * Used for touch events.
  * @type field will be one of %GDK_TOUCH_BEGIN, %GDK_TOUCH_UPDATE,
@@ -210,6 +214,7 @@ struct _GdkEventTouch
   GdkEventSequence *sequence;
   gboolean emulating_pointer;
   gdouble x_root, y_root;
+  GList *history;
 };
 
 /*
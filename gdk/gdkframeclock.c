@@ -82,6 +82,7 @@ enum {
   PAINT,
   AFTER_PAINT,
   RESUME_EVENTS,
+  TIMINGS_COMPLETE,
   LAST_SIGNAL
 };
 
@@ -95,6 +96,8 @@ struct _GdkFrameClockPrivate
   gint n_timings;
   gint current;
   GdkFrameTimings *timings[FRAME_HISTORY_MAX_LENGTH];
+
+  gint64 refresh_interval;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GdkFrameClock, gdk_frame_clock, G_TYPE_OBJECT)
@@ -241,6 +244,36 @@ gdk_frame_clock_class_init (GdkFrameClockClass *klass)
                   NULL, NULL,
                   g_cclosure_marshal_VOID__VOID,
                   G_TYPE_NONE, 0);
+
+  /**
+   * GdkFrameClock::timings-complete:
+   * @clock: the frame clock emitting the signal
+   * @timings: the #GdkFrameTimings of the frame
+   *
+   * This signal is emitted when all the timing information of a
+   * frame is known, which is usually some time after the frame has
+   * been drawn, once it has been presented.
+   *
+   * It is meant for collecting statistics about frame drops in
+   * production: gdk_frame_timings_get_frame_duration(),
+   * gdk_frame_timings_get_over_budget_phase() and
+   * gdk_frame_timings_get_missed_frames() give a summary of the
+   * frame. The timings are only valid during the emission; use
+   * gdk_frame_timings_ref() to keep them.
+   *
+   * Nothing is computed for this signal if it has no handlers.
+   *
+   * Since: 3.94
+   */
+  signals[TIMINGS_COMPLETE] =
+    g_signal_new (g_intern_static_string ("timings-complete"),
+                  GDK_TYPE_FRAME_CLOCK,
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL,
+                  g_cclosure_marshal_VOID__BOXED,
+                  G_TYPE_NONE, 1,
+                  gdk_frame_timings_get_type () | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 static void
@@ -359,6 +392,38 @@ _gdk_frame_clock_thaw (GdkFrameClock *clock)
   GDK_FRAME_CLOCK_GET_CLASS (clock)->thaw (clock);
 }
 
+#define DEFAULT_REFRESH_INTERVAL 16667 /* 16.7ms (1/60th second) */
+
+/*
+ * _gdk_frame_clock_set_refresh_interval:
+ * @clock: a #GdkFrameClock
+ * @refresh_interval: the refresh interval of the monitor the window
+ *   is on, in microseconds, or 0 if it is not known
+ *
+ * Sets the refresh interval that is assumed when the frame history
+ * does not tell. Backends update it when a window moves to a monitor
+ * with a different refresh rate.
+ */
+void
+_gdk_frame_clock_set_refresh_interval (GdkFrameClock *clock,
+                                       gint64         refresh_interval)
+{
+  g_return_if_fail (GDK_IS_FRAME_CLOCK (clock));
+
+  clock->priv->refresh_interval = refresh_interval;
+}
+
+gint64
+_gdk_frame_clock_get_refresh_interval (GdkFrameClock *clock)
+{
+  GdkFrameClockPrivate *priv = clock->priv;
+
+  if (priv->refresh_interval != 0)
+    return priv->refresh_interval;
+
+  return DEFAULT_REFRESH_INTERVAL;
+}
+
 /**
  * gdk_frame_clock_get_frame_counter:
  * @frame_clock: a #GdkFrameClock
@@ -500,6 +565,37 @@ gdk_frame_clock_get_current_timings (GdkFrameClock *frame_clock)
   return gdk_frame_clock_get_timings (frame_clock, priv->frame_counter);
 }
 
+/* Called by the backends when no more information about the frame
+ * of @timings is going to arrive.
+ */
+void
+_gdk_frame_clock_complete_timings (GdkFrameClock   *clock,
+                                   GdkFrameTimings *timings)
+{
+  GdkFrameTimings *previous;
+
+  timings->complete = TRUE;
+
+  if (!g_signal_has_handler_pending (clock, signals[TIMINGS_COMPLETE], 0, FALSE))
+    return;
+
+  /* If the clock slept before the frame, there was nothing to
+   * draw in the refresh cycles since the previous frame */
+  previous = gdk_frame_clock_get_timings (clock, timings->frame_counter - 1);
+  if (previous != NULL &&
+      !timings->slept_before &&
+      timings->refresh_interval > 0 &&
+      timings->presentation_time != 0 &&
+      previous->presentation_time != 0)
+    {
+      gint64 interval = timings->presentation_time - previous->presentation_time;
+      gint64 n_frames = (interval + timings->refresh_interval / 2) / timings->refresh_interval;
+
+      timings->missed_frames = MAX (n_frames - 1, 0);
+    }
+
+  g_signal_emit (clock, signals[TIMINGS_COMPLETE], 0, timings);
+}
 
 #ifdef G_ENABLE_DEBUG
 void
@@ -541,7 +637,6 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
 }
 #endif /* G_ENABLE_DEBUG */
 
-#define DEFAULT_REFRESH_INTERVAL 16667 /* 16.7ms (1/60th second) */
 #define MAX_HISTORY_AGE 150000         /* 150ms */
 
 /**
@@ -549,8 +644,8 @@ _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
  * @frame_clock: a #GdkFrameClock
  * @base_time: base time for determining a presentaton time
  * @refresh_interval_return: a location to store the determined refresh
- *  interval, or %NULL. A default refresh interval of 1/60th of
- *  a second will be stored if no history is present.
+ *  interval, or %NULL. The refresh interval of the monitor, or 1/60th
+ *  of a second if that is unknown, will be stored if no history is present.
  * @presentation_time_return: a location to store the next
  *  candidate presentation time after the given base time.
  *  0 will be will be stored if no history is present.
@@ -578,7 +673,7 @@ gdk_frame_clock_get_refresh_info (GdkFrameClock *frame_clock,
   if (presentation_time_return)
     *presentation_time_return = 0;
   if (refresh_interval_return)
-    *refresh_interval_return = DEFAULT_REFRESH_INTERVAL;
+    *refresh_interval_return = _gdk_frame_clock_get_refresh_interval (frame_clock);
 
   while (TRUE)
     {
@@ -598,7 +693,7 @@ gdk_frame_clock_get_refresh_info (GdkFrameClock *frame_clock,
               presentation_time_return)
             {
               if (refresh_interval == 0)
-                refresh_interval = DEFAULT_REFRESH_INTERVAL;
+                refresh_interval = _gdk_frame_clock_get_refresh_interval (frame_clock);
 
               if (refresh_interval_return)
                 *refresh_interval_return = refresh_interval;
@@ -105,6 +105,12 @@ void gdk_frame_clock_get_refresh_info (GdkFrameClock *frame_clock,
                                        gint64        *refresh_interval_return,
                                        gint64        *presentation_time_return);
 
+GDK_AVAILABLE_IN_3_94
+gint64 gdk_frame_timings_get_phase_duration (GdkFrameTimings    *timings,
+                                             GdkFrameClockPhase  phase);
+GDK_AVAILABLE_IN_3_94
+GdkFrameClockPhase gdk_frame_timings_get_over_budget_phase (GdkFrameTimings *timings);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_CLOCK_H__ */
@@ -27,13 +27,17 @@
 #include "gdkinternals.h"
 #include "gdkframeclockprivate.h"
 #include "gdkframeclockidle.h"
+#include "gdkprofilerprivate.h"
 #include "gdk.h"
 
 #ifdef G_OS_WIN32
 #include <windows.h>
 #endif
 
-#define FRAME_INTERVAL 16667 /* microseconds */
+/* The longest of the last FRAME_DURATION_HISTORY frames is used as
+ * the estimate for how long the next one will take
+ */
+#define FRAME_DURATION_HISTORY 8
 
 struct _GdkFrameClockIdlePrivate
 {
@@ -44,6 +48,10 @@ struct _GdkFrameClockIdlePrivate
   gint64 min_next_frame_time;
   gint64 sleep_serial;
 
+  gint64 frame_start_time;
+  gint64 frame_durations[FRAME_DURATION_HISTORY];
+  guint frame_duration_index;
+
   guint flush_idle_id;
   guint paint_idle_id;
   guint freeze_count;
@@ -194,12 +202,12 @@ gdk_frame_clock_idle_get_frame_time (GdkFrameClock *clock)
   /* Outside a paint, pick something close to "now" */
   computed_frame_time = compute_frame_time (GDK_FRAME_CLOCK_IDLE (clock));
 
-  /* 16ms is 60fps. We only update frame time that often because we'd
+  /* We only update frame time once per refresh cycle because we'd
    * like to try to keep animations on the same start times.
    * get_frame_time() would normally be used outside of a paint to
    * record an animation start time for example.
    */
-  if ((computed_frame_time - priv->frame_time) > FRAME_INTERVAL)
+  if ((computed_frame_time - priv->frame_time) > _gdk_frame_clock_get_refresh_interval (clock))
     priv->frame_time = computed_frame_time;
 
   return priv->frame_time;
@@ -276,12 +284,59 @@ maybe_stop_idle (GdkFrameClockIdle *clock_idle)
     }
 }
 
+static void
+record_frame_duration (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+
+  priv->frame_durations[priv->frame_duration_index] = g_get_monotonic_time () - priv->frame_start_time;
+  priv->frame_duration_index = (priv->frame_duration_index + 1) % FRAME_DURATION_HISTORY;
+}
+
+static gint64
+estimate_frame_duration (GdkFrameClockIdle *clock_idle)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 duration = 0;
+  int i;
+
+  for (i = 0; i < FRAME_DURATION_HISTORY; i++)
+    {
+      /* Not enough history yet */
+      if (priv->frame_durations[i] == 0)
+        return 0;
+
+      duration = MAX (duration, priv->frame_durations[i]);
+    }
+
+  return duration;
+}
+
+/* Returns the latest time at which a frame can start and, judging by
+ * how long recent frames took, still be done before @presentation_time.
+ * A quarter of a refresh cycle is left for the compositor and for
+ * variations in frame duration. Returns 0 if that can't be known. */
+static gint64
+compute_latest_frame_start (GdkFrameClockIdle *clock_idle,
+                            gint64             presentation_time,
+                            gint64             refresh_interval)
+{
+  gint64 duration;
+
+  duration = estimate_frame_duration (clock_idle);
+  if (duration == 0 || presentation_time == 0)
+    return 0;
+
+  return presentation_time - duration - refresh_interval / 4;
+}
+
 static gint64
 compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
                              gint64             last_frame_time)
 {
   gint64 presentation_time;
   gint64 refresh_interval;
+  gint64 latest_start;
 
   gdk_frame_clock_get_refresh_info (GDK_FRAME_CLOCK (clock_idle),
                                     last_frame_time,
@@ -289,8 +344,38 @@ compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
 
   if (presentation_time == 0)
     return last_frame_time + refresh_interval;
-  else
-    return presentation_time + refresh_interval / 2;
+
+  /* Start as late as we can and still make the vblank after the next
+   * one, so the frame reflects the newest input */
+  latest_start = compute_latest_frame_start (clock_idle,
+                                             presentation_time + refresh_interval,
+                                             refresh_interval);
+  if (latest_start != 0)
+    return MAX (latest_start, presentation_time);
+
+  return presentation_time + refresh_interval / 2;
+}
+
+/* When the backend unthrottles us, it is usually right after a vblank,
+ * and many frames can be done well before the next one. Delay them,
+ * as long as they can still make it. */
+static gint64
+compute_thawed_frame_time (GdkFrameClockIdle *clock_idle)
+{
+  gint64 now = compute_frame_time (clock_idle);
+  gint64 presentation_time;
+  gint64 refresh_interval;
+  gint64 latest_start;
+
+  gdk_frame_clock_get_refresh_info (GDK_FRAME_CLOCK (clock_idle),
+                                    now,
+                                    &refresh_interval, &presentation_time);
+
+  latest_start = compute_latest_frame_start (clock_idle, presentation_time, refresh_interval);
+  if (latest_start <= now)
+    return 0;
+
+  return latest_start;
 }
 
 static gboolean
@@ -351,7 +436,7 @@ gdk_frame_clock_paint_idle (void *data)
         case GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT:
           if (priv->freeze_count == 0)
             {
-              gint64 frame_interval = FRAME_INTERVAL;
+              gint64 frame_interval = _gdk_frame_clock_get_refresh_interval (clock);
               gint64 reset_frame_time;
               gint64 smoothest_frame_time;
               gint64 frame_time_error;
@@ -387,6 +472,8 @@ gdk_frame_clock_paint_idle (void *data)
               timings->frame_time = priv->frame_time;
               timings->slept_before = priv->sleep_serial != get_sleep_serial ();
 
+              priv->frame_start_time = g_get_monotonic_time ();
+
               priv->phase = GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
 
               /* We always emit ::before-paint and ::after-paint if
@@ -396,6 +483,8 @@ gdk_frame_clock_paint_idle (void *data)
                */
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT;
               _gdk_frame_clock_emit_before_paint (clock);
+              _gdk_frame_timings_add_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT,
+                                                     g_get_monotonic_time () - priv->frame_start_time);
               priv->phase = GDK_FRAME_CLOCK_PHASE_UPDATE;
             }
           /* fallthrough */
@@ -405,8 +494,14 @@ gdk_frame_clock_paint_idle (void *data)
               if ((priv->requested & GDK_FRAME_CLOCK_PHASE_UPDATE) != 0 ||
                   priv->updating_count > 0)
                 {
+                  gint64 update_start = g_get_monotonic_time ();
+
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_UPDATE;
                   _gdk_frame_clock_emit_update (clock);
+
+                  if (timings)
+                    _gdk_frame_timings_add_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_UPDATE,
+                                                           g_get_monotonic_time () - update_start);
                 }
             }
           /* fallthrough */
@@ -433,8 +528,16 @@ gdk_frame_clock_paint_idle (void *data)
               while ((priv->requested & GDK_FRAME_CLOCK_PHASE_LAYOUT) &&
 		     priv->freeze_count == 0 && iter++ < 4)
                 {
+                  gint64 layout_start = g_get_monotonic_time ();
+                  gint64 layout_duration;
+
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_LAYOUT;
                   _gdk_frame_clock_emit_layout (clock);
+
+                  layout_duration = g_get_monotonic_time () - layout_start;
+                  if (timings)
+                    _gdk_frame_timings_add_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_LAYOUT, layout_duration);
+                  gdk_profiler_add_mark (layout_start, layout_duration, "layout", NULL);
                 }
 	      if (iter == 5)
 		g_warning ("gdk-frame-clock: layout continuously requested, giving up after 4 tries");
@@ -455,20 +558,49 @@ gdk_frame_clock_paint_idle (void *data)
               priv->phase = GDK_FRAME_CLOCK_PHASE_PAINT;
               if (priv->requested & GDK_FRAME_CLOCK_PHASE_PAINT)
                 {
+                  gint64 paint_start = g_get_monotonic_time ();
+                  gint64 paint_duration;
+
                   priv->requested &= ~GDK_FRAME_CLOCK_PHASE_PAINT;
                   _gdk_frame_clock_emit_paint (clock);
+
+                  paint_duration = g_get_monotonic_time () - paint_start;
+                  if (timings)
+                    _gdk_frame_timings_add_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_PAINT, paint_duration);
+                  gdk_profiler_add_mark (paint_start, paint_duration, "paint", NULL);
                 }
             }
           /* fallthrough */
         case GDK_FRAME_CLOCK_PHASE_AFTER_PAINT:
           if (priv->freeze_count == 0)
             {
+              gint64 after_paint_start = g_get_monotonic_time ();
+
               priv->requested &= ~GDK_FRAME_CLOCK_PHASE_AFTER_PAINT;
               _gdk_frame_clock_emit_after_paint (clock);
+              if (timings)
+                _gdk_frame_timings_add_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT,
+                                                       g_get_monotonic_time () - after_paint_start);
               /* the ::after-paint phase doesn't get repeated on freeze/thaw,
                */
               priv->phase = GDK_FRAME_CLOCK_PHASE_NONE;
 
+              if (priv->frame_start_time != 0)
+                {
+                  if (gdk_profiler_is_running ())
+                    {
+                      char *message = g_strdup_printf ("frame %" G_GINT64_FORMAT,
+                                                       gdk_frame_clock_get_frame_counter (clock));
+                      gdk_profiler_add_mark (priv->frame_start_time,
+                                             g_get_monotonic_time () - priv->frame_start_time,
+                                             "frame clock", message);
+                      g_free (message);
+                    }
+
+                  record_frame_duration (clock_idle);
+                  priv->frame_start_time = 0;
+                }
+
 #ifdef G_ENABLE_DEBUG
               if (GDK_DEBUG_CHECK (FRAMES))
                 timings->frame_end_time = g_get_monotonic_time ();
@@ -588,6 +720,9 @@ gdk_frame_clock_idle_thaw (GdkFrameClock *clock)
   priv->freeze_count--;
   if (priv->freeze_count == 0)
     {
+      if (priv->phase == GDK_FRAME_CLOCK_PHASE_NONE && !priv->in_paint_idle)
+        priv->min_next_frame_time = compute_thawed_frame_time (clock_idle);
+
       maybe_start_idle (clock_idle);
       /* If nothing is requested so we didn't start an idle, we need
        * to skip to the end of the state chain, since the idle won't
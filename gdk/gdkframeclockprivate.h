@@ -94,6 +94,12 @@ struct _GdkFrameTimings
   gint64 refresh_interval;
   gint64 predicted_presentation_time;
 
+  /* indexed by the bit number of the GdkFrameClockPhase */
+  gint64 phase_durations[7];
+  gint64 snapshot_time;
+  gint64 render_time;
+  guint missed_frames;
+
 #ifdef G_ENABLE_DEBUG
   gint64 layout_start_time;
   gint64 paint_start_time;
@@ -107,13 +113,22 @@ struct _GdkFrameTimings
 void _gdk_frame_clock_freeze (GdkFrameClock *clock);
 void _gdk_frame_clock_thaw   (GdkFrameClock *clock);
 
+void   _gdk_frame_clock_set_refresh_interval (GdkFrameClock *clock,
+                                              gint64         refresh_interval);
+gint64 _gdk_frame_clock_get_refresh_interval (GdkFrameClock *clock);
+
 void _gdk_frame_clock_begin_frame         (GdkFrameClock   *clock);
+void _gdk_frame_clock_complete_timings    (GdkFrameClock   *clock,
+                                           GdkFrameTimings *timings);
 void _gdk_frame_clock_debug_print_timings (GdkFrameClock   *clock,
                                            GdkFrameTimings *timings);
 
 GdkFrameTimings *_gdk_frame_timings_new   (gint64           frame_counter);
 gboolean         _gdk_frame_timings_steal (GdkFrameTimings *timings,
                                            gint64           frame_counter);
+void             _gdk_frame_timings_add_phase_duration (GdkFrameTimings    *timings,
+                                                        GdkFrameClockPhase  phase,
+                                                        gint64              duration);
 
 void _gdk_frame_clock_emit_flush_events  (GdkFrameClock *frame_clock);
 void _gdk_frame_clock_emit_before_paint  (GdkFrameClock *frame_clock);
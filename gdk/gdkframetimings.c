@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "gdkframeclockprivate.h"
+#include "gdk-private.h"
 
 /**
  * SECTION:gdkframetimings
@@ -241,3 +242,162 @@ gdk_frame_timings_get_refresh_interval (GdkFrameTimings *timings)
 
   return timings->refresh_interval;
 }
+
+void
+_gdk_frame_timings_add_phase_duration (GdkFrameTimings    *timings,
+                                       GdkFrameClockPhase  phase,
+                                       gint64              duration)
+{
+  int i = g_bit_nth_lsf (phase, -1);
+
+  g_assert (i >= 0 && i < G_N_ELEMENTS (timings->phase_durations));
+
+  timings->phase_durations[i] += duration;
+}
+
+/**
+ * gdk_frame_timings_get_phase_duration:
+ * @timings: a #GdkFrameTimings
+ * @phase: a single #GdkFrameClockPhase
+ *
+ * Gets how long the handlers of @phase took to run for this
+ * frame. This can be used to find out which phase is to blame
+ * for a frame taking too long.
+ *
+ * Only the phases from %GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT to
+ * %GDK_FRAME_CLOCK_PHASE_AFTER_PAINT are measured; for the others,
+ * this returns 0.
+ *
+ * Returns: the time spent in @phase, in microseconds
+ *
+ * Since: 3.94
+ */
+gint64
+gdk_frame_timings_get_phase_duration (GdkFrameTimings    *timings,
+                                      GdkFrameClockPhase  phase)
+{
+  int i;
+
+  g_return_val_if_fail (timings != NULL, 0);
+
+  i = g_bit_nth_lsf (phase, -1);
+  g_return_val_if_fail (i >= 0 && i < G_N_ELEMENTS (timings->phase_durations), 0);
+
+  return timings->phase_durations[i];
+}
+
+/**
+ * gdk_frame_timings_get_frame_duration:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets how long it took to produce the frame, that is the sum of
+ * the durations of the phases, see gdk_frame_timings_get_phase_duration().
+ * If this is longer than the refresh interval, the frame was late.
+ *
+ * Returns: the time spent on the frame, in microseconds
+ *
+ * Since: 3.94
+ */
+gint64
+gdk_frame_timings_get_frame_duration (GdkFrameTimings *timings)
+{
+  gint64 duration = 0;
+  int i;
+
+  g_return_val_if_fail (timings != NULL, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (timings->phase_durations); i++)
+    duration += timings->phase_durations[i];
+
+  return duration;
+}
+
+/**
+ * gdk_frame_timings_get_over_budget_phase:
+ * @timings: a #GdkFrameTimings
+ *
+ * Finds the phase during which producing the frame took longer
+ * than the refresh interval of the display. That phase is not
+ * necessarily the slowest one, but it is the one that made the
+ * frame late.
+ *
+ * Returns: the phase in which the frame went over its time
+ *   budget, or %GDK_FRAME_CLOCK_PHASE_NONE if it didn't, or if
+ *   the refresh interval is not known
+ *
+ * Since: 3.94
+ */
+GdkFrameClockPhase
+gdk_frame_timings_get_over_budget_phase (GdkFrameTimings *timings)
+{
+  gint64 elapsed = 0;
+  int i;
+
+  g_return_val_if_fail (timings != NULL, GDK_FRAME_CLOCK_PHASE_NONE);
+
+  if (timings->refresh_interval <= 0)
+    return GDK_FRAME_CLOCK_PHASE_NONE;
+
+  for (i = 0; i < G_N_ELEMENTS (timings->phase_durations); i++)
+    {
+      elapsed += timings->phase_durations[i];
+      if (elapsed > timings->refresh_interval)
+        return 1 << i;
+    }
+
+  return GDK_FRAME_CLOCK_PHASE_NONE;
+}
+
+/**
+ * gdk_frame_timings_get_missed_frames:
+ * @timings: a #GdkFrameTimings
+ *
+ * Gets the number of refresh cycles of the display that passed
+ * without a new frame between the previous frame and this one,
+ * while an update was pending. Frames after the frame clock was
+ * idle don't count as missed frames.
+ *
+ * This is only known in the #GdkFrameClock::timings-complete
+ * signal, and only if the backend knows when frames were presented.
+ *
+ * Returns: the number of missed frames
+ *
+ * Since: 3.94
+ */
+guint
+gdk_frame_timings_get_missed_frames (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->missed_frames;
+}
+
+/* Lets GTK+ account for the parts of the paint phase that
+ * GDK can't see: creating the render nodes and rendering them.
+ */
+void
+gdk_frame_timings_add_render_times (GdkFrameTimings *timings,
+                                    gint64           snapshot_time,
+                                    gint64           render_time)
+{
+  g_return_if_fail (timings != NULL);
+
+  timings->snapshot_time += snapshot_time;
+  timings->render_time += render_time;
+}
+
+gint64
+gdk_frame_timings_get_snapshot_time (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->snapshot_time;
+}
+
+gint64
+gdk_frame_timings_get_render_time (GdkFrameTimings *timings)
+{
+  g_return_val_if_fail (timings != NULL, 0);
+
+  return timings->render_time;
+}
@@ -51,6 +51,11 @@ gint64           gdk_frame_timings_get_refresh_interval  (GdkFrameTimings *timin
 GDK_AVAILABLE_IN_3_8
 gint64           gdk_frame_timings_get_predicted_presentation_time (GdkFrameTimings *timings);
 
+GDK_AVAILABLE_IN_3_94
+gint64           gdk_frame_timings_get_frame_duration    (GdkFrameTimings *timings);
+GDK_AVAILABLE_IN_3_94
+guint            gdk_frame_timings_get_missed_frames     (GdkFrameTimings *timings);
+
 G_END_DECLS
 
 #endif /* __GDK_FRAME_TIMINGS_H__ */
@@ -280,6 +280,8 @@ void   _gdk_event_emit               (GdkEvent   *event);
 GList* _gdk_event_queue_find_first   (GdkDisplay *display);
 void   _gdk_event_queue_remove_link  (GdkDisplay *display,
                                       GList      *node);
+void   _gdk_event_queue_free_link    (GdkDisplay *display,
+                                      GList      *node);
 GList* _gdk_event_queue_append       (GdkDisplay *display,
                                       GdkEvent   *event);
 GList* _gdk_event_queue_insert_after (GdkDisplay *display,
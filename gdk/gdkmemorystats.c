@@ -0,0 +1,79 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * gdkmemorystats.c: Accounting of the memory used by caches
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkmemorystatsprivate.h"
+
+/* GDK, GSK and GTK+ account the objects that tend to pile up in long
+ * running applications here: how many are alive and how many bytes they
+ * take. The sizes are what the objects themselves allocate, not what
+ * the allocator really uses for them, and some, like the size of a
+ * texture, are estimates.
+ *
+ * Textures are finalized from other threads, so the counters are
+ * updated atomically.
+ */
+
+static gssize live[GDK_MEMORY_N_KINDS];
+static gssize live_bytes[GDK_MEMORY_N_KINDS];
+
+static const char *kind_names[GDK_MEMORY_N_KINDS] = {
+  "Render nodes",
+  "Textures",
+  "Glyph atlases",
+  "CSS styles",
+  "Text line displays",
+};
+
+void
+gdk_memory_stats_alloc (GdkMemoryKind kind,
+                        gsize         size)
+{
+  g_atomic_pointer_add (&live[kind], 1);
+  g_atomic_pointer_add (&live_bytes[kind], size);
+}
+
+void
+gdk_memory_stats_free (GdkMemoryKind kind,
+                       gsize         size)
+{
+  g_atomic_pointer_add (&live[kind], -1);
+  g_atomic_pointer_add (&live_bytes[kind], - (gssize) size);
+}
+
+void
+gdk_memory_stats_get (GdkMemoryKind  kind,
+                      gsize         *n_live,
+                      gsize         *n_bytes)
+{
+  g_return_if_fail (kind < GDK_MEMORY_N_KINDS);
+
+  if (n_live)
+    *n_live = (gsize) g_atomic_pointer_get (&live[kind]);
+  if (n_bytes)
+    *n_bytes = (gsize) g_atomic_pointer_get (&live_bytes[kind]);
+}
+
+const char *
+gdk_memory_kind_get_name (GdkMemoryKind kind)
+{
+  g_return_val_if_fail (kind < GDK_MEMORY_N_KINDS, NULL);
+
+  return kind_names[kind];
+}
@@ -0,0 +1,47 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * gdkmemorystatsprivate.h: Accounting of the memory used by caches
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_MEMORY_STATS_PRIVATE_H__
+#define __GDK_MEMORY_STATS_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GDK_MEMORY_RENDER_NODES,
+  GDK_MEMORY_TEXTURES,
+  GDK_MEMORY_GLYPH_ATLASES,
+  GDK_MEMORY_CSS_STYLES,
+  GDK_MEMORY_TEXT_LINE_DISPLAYS,
+
+  GDK_MEMORY_N_KINDS
+} GdkMemoryKind;
+
+void            gdk_memory_stats_alloc          (GdkMemoryKind  kind,
+                                                 gsize          size);
+void            gdk_memory_stats_free           (GdkMemoryKind  kind,
+                                                 gsize          size);
+void            gdk_memory_stats_get            (GdkMemoryKind  kind,
+                                                 gsize         *n_live,
+                                                 gsize         *n_bytes);
+const char *    gdk_memory_kind_get_name        (GdkMemoryKind  kind);
+
+G_END_DECLS
+
+#endif /* __GDK_MEMORY_STATS_PRIVATE_H__ */
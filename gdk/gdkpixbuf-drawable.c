@@ -28,6 +28,7 @@
 #include "gdkinternals.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <string.h>
 
 /**
  * SECTION:pixbufs
@@ -80,6 +81,31 @@ gdk_cairo_surface_coerce_to_image (cairo_surface_t *surface,
   return copy;
 }
 
+/* unpremultiply_table[alpha][color] is the unpremultiplied value of a
+ * premultiplied color channel, so that the conversion doesn't need three
+ * divisions for every pixel.
+ */
+static const guchar *
+get_unpremultiply_table (void)
+{
+  static guchar *table = NULL;
+
+  if (g_once_init_enter (&table))
+    {
+      guchar *t = g_malloc (256 * 256);
+      guint alpha, color;
+
+      memset (t, 0, 256);
+      for (alpha = 1; alpha < 256; alpha++)
+        for (color = 0; color < 256; color++)
+          t[alpha * 256 + color] = MIN ((color * 255 + alpha / 2) / alpha, 255);
+
+      g_once_init_leave (&table, t);
+    }
+
+  return table;
+}
+
 static void
 convert_alpha (guchar *dest_data,
                int     dest_stride,
@@ -90,6 +116,7 @@ convert_alpha (guchar *dest_data,
                int     width,
                int     height)
 {
+  const guchar *table = get_unpremultiply_table ();
   int x, y;
 
   src_data += src_stride * src_y + src_x * 4;
@@ -100,17 +127,19 @@ convert_alpha (guchar *dest_data,
     for (x = 0; x < width; x++) {
       guint alpha = src[x] >> 24;
 
-      if (alpha == 0)
+      if (alpha == 0xff)
         {
-          dest_data[x * 4 + 0] = 0;
-          dest_data[x * 4 + 1] = 0;
-          dest_data[x * 4 + 2] = 0;
+          dest_data[x * 4 + 0] = src[x] >> 16;
+          dest_data[x * 4 + 1] = src[x] >>  8;
+          dest_data[x * 4 + 2] = src[x];
         }
       else
         {
-          dest_data[x * 4 + 0] = (((src[x] & 0xff0000) >> 16) * 255 + alpha / 2) / alpha;
-          dest_data[x * 4 + 1] = (((src[x] & 0x00ff00) >>  8) * 255 + alpha / 2) / alpha;
-          dest_data[x * 4 + 2] = (((src[x] & 0x0000ff) >>  0) * 255 + alpha / 2) / alpha;
+          const guchar *row = table + alpha * 256;
+
+          dest_data[x * 4 + 0] = row[(src[x] >> 16) & 0xff];
+          dest_data[x * 4 + 1] = row[(src[x] >>  8) & 0xff];
+          dest_data[x * 4 + 2] = row[src[x] & 0xff];
         }
       dest_data[x * 4 + 3] = alpha;
     }
@@ -0,0 +1,219 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * gdkprofiler.c: A simple tracing facility
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gdkprofilerprivate.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
+
+/**
+ * SECTION:gdkprofiler
+ * @Short_description: Recording traces
+ * @Title: Profiler
+ *
+ * If the `GDK_TRACE` environment variable is set to a filename when
+ * GDK is initialized, GTK+ records timestamped marks for things like
+ * the stages of gtk_init(), theme loading and frame clock phases to
+ * that file. The file uses the Chrome trace event format, so it can be
+ * loaded into chrome://tracing or Perfetto.
+ *
+ * Applications can add their own marks with gdk_profiler_add_mark(),
+ * and record values that change over time, such as the counters of
+ * GSK renderers, with gdk_profiler_set_counter().
+ */
+
+static FILE *trace_file = NULL;
+static GMutex trace_lock;
+static int trace_pid = 0;
+
+static void
+append_escaped (GString    *s,
+                const char *str)
+{
+  const char *p;
+
+  for (p = str; *p; p++)
+    {
+      switch (*p)
+        {
+        case '"':
+          g_string_append (s, "\\\"");
+          break;
+        case '\\':
+          g_string_append (s, "\\\\");
+          break;
+        case '\n':
+          g_string_append (s, "\\n");
+          break;
+        case '\t':
+          g_string_append (s, "\\t");
+          break;
+        default:
+          if ((guchar) *p < 0x20)
+            g_string_append_printf (s, "\\u%04x", (guint) *p);
+          else
+            g_string_append_c (s, *p);
+          break;
+        }
+    }
+}
+
+/*< private >
+ * gdk_profiler_start:
+ * @filename: the file to write the trace to
+ *
+ * Starts recording marks to @filename. The file is written as
+ * a JSON array of trace events that is never closed; trace viewers
+ * accept that, and it keeps the trace usable no matter how the
+ * process exits.
+ */
+void
+gdk_profiler_start (const char *filename)
+{
+  if (trace_file != NULL)
+    return;
+
+  trace_file = g_fopen (filename, "w");
+  if (trace_file == NULL)
+    {
+      g_warning ("Failed to open trace file “%s”: %s", filename, g_strerror (errno));
+      return;
+    }
+
+#ifdef G_OS_UNIX
+  trace_pid = getpid ();
+#endif
+
+  fputs ("[\n", trace_file);
+  fflush (trace_file);
+}
+
+/**
+ * gdk_profiler_is_running:
+ *
+ * Returns whether marks are being recorded. This can be used to avoid
+ * computing expensive mark messages when nobody is going to see them.
+ *
+ * Returns: %TRUE if a trace is being recorded
+ *
+ * Since: 3.94
+ */
+gboolean
+gdk_profiler_is_running (void)
+{
+  return trace_file != NULL;
+}
+
+/**
+ * gdk_profiler_add_mark:
+ * @start: the start of the mark in monotonic time, see g_get_monotonic_time()
+ * @duration: the duration of the mark in microseconds
+ * @name: the name of the mark
+ * @message: (nullable): additional information about the mark, or %NULL
+ *
+ * Adds a mark to the trace, if one is being recorded. Marks with a
+ * duration of 0 are recorded as instant events.
+ *
+ * Since: 3.94
+ */
+void
+gdk_profiler_add_mark (gint64      start,
+                       guint64     duration,
+                       const char *name,
+                       const char *message)
+{
+  GString *s;
+
+  g_return_if_fail (name != NULL);
+
+  if (trace_file == NULL)
+    return;
+
+  s = g_string_new ("{\"name\":\"");
+  append_escaped (s, name);
+  g_string_append_printf (s,
+                          "\",\"cat\":\"gtk\",\"ph\":\"%s\",\"ts\":%" G_GINT64_FORMAT,
+                          duration > 0 ? "X" : "i",
+                          start);
+  if (duration > 0)
+    g_string_append_printf (s, ",\"dur\":%" G_GUINT64_FORMAT, duration);
+  else
+    g_string_append (s, ",\"s\":\"p\"");
+  g_string_append_printf (s, ",\"pid\":%d,\"tid\":%d", trace_pid, trace_pid);
+  if (message)
+    {
+      g_string_append (s, ",\"args\":{\"message\":\"");
+      append_escaped (s, message);
+      g_string_append (s, "\"}");
+    }
+  g_string_append (s, "},\n");
+
+  g_mutex_lock (&trace_lock);
+  fputs (s->str, trace_file);
+  fflush (trace_file);
+  g_mutex_unlock (&trace_lock);
+
+  g_string_free (s, TRUE);
+}
+
+/**
+ * gdk_profiler_set_counter:
+ * @time: the time of the sample in monotonic time, see g_get_monotonic_time()
+ * @name: the name of the counter
+ * @value: the value of the counter at @time
+ *
+ * Adds a sample for the counter @name to the trace, if one is being
+ * recorded. Trace viewers show the samples of a counter as a graph.
+ *
+ * Since: 3.94
+ */
+void
+gdk_profiler_set_counter (gint64      time,
+                          const char *name,
+                          double      value)
+{
+  GString *s;
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_return_if_fail (name != NULL);
+
+  if (trace_file == NULL)
+    return;
+
+  s = g_string_new ("{\"name\":\"");
+  append_escaped (s, name);
+  g_string_append_printf (s,
+                          "\",\"cat\":\"gtk\",\"ph\":\"C\",\"ts\":%" G_GINT64_FORMAT
+                          ",\"pid\":%d,\"tid\":%d,\"args\":{\"value\":%s}},\n",
+                          time, trace_pid, trace_pid,
+                          g_ascii_dtostr (buf, sizeof (buf), value));
+
+  g_mutex_lock (&trace_lock);
+  fputs (s->str, trace_file);
+  fflush (trace_file);
+  g_mutex_unlock (&trace_lock);
+
+  g_string_free (s, TRUE);
+}
@@ -0,0 +1,47 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * gdkprofiler.h: A simple tracing facility
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_PROFILER_H__
+#define __GDK_PROFILER_H__
+
+#if !defined (__GDK_H_INSIDE__) && !defined (GDK_COMPILATION)
+#error "Only <gdk/gdk.h> can be included directly."
+#endif
+
+#include <gdk/gdktypes.h>
+#include <gdk/gdkversionmacros.h>
+
+G_BEGIN_DECLS
+
+GDK_AVAILABLE_IN_3_94
+gboolean gdk_profiler_is_running (void);
+
+GDK_AVAILABLE_IN_3_94
+void     gdk_profiler_add_mark   (gint64      start,
+                                  guint64     duration,
+                                  const char *name,
+                                  const char *message);
+
+GDK_AVAILABLE_IN_3_94
+void     gdk_profiler_set_counter (gint64      time,
+                                   const char *name,
+                                   double      value);
+
+G_END_DECLS
+
+#endif /* __GDK_PROFILER_H__ */
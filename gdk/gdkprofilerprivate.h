@@ -0,0 +1,30 @@
+/* GDK - The GIMP Drawing Kit
+ *
+ * gdkprofilerprivate.h: A simple tracing facility
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_PROFILER_PRIVATE_H__
+#define __GDK_PROFILER_PRIVATE_H__
+
+#include "gdk/gdkprofiler.h"
+
+G_BEGIN_DECLS
+
+void     gdk_profiler_start      (const char *filename);
+
+G_END_DECLS
+
+#endif /* __GDK_PROFILER_PRIVATE_H__ */
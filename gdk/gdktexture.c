@@ -38,8 +38,10 @@
 
 #include "gdkinternals.h"
 #include "gdkcairo.h"
+#include "gdkmemorystatsprivate.h"
 
 #include <epoxy/gl.h>
+#include <string.h>
 
 /**
  * SECTION:gdktexture
@@ -151,6 +153,28 @@ gdk_texture_get_property (GObject    *gobject,
     }
 }
 
+/* Textures are accounted with the size of their pixel data,
+ * that's what they hold on to, somewhere, and what matters */
+static void
+gdk_texture_constructed (GObject *object)
+{
+  GdkTexture *self = GDK_TEXTURE (object);
+
+  G_OBJECT_CLASS (gdk_texture_parent_class)->constructed (object);
+
+  gdk_memory_stats_alloc (GDK_MEMORY_TEXTURES, (gsize) self->width * self->height * 4);
+}
+
+static void
+gdk_texture_finalize (GObject *object)
+{
+  GdkTexture *self = GDK_TEXTURE (object);
+
+  gdk_memory_stats_free (GDK_MEMORY_TEXTURES, (gsize) self->width * self->height * 4);
+
+  G_OBJECT_CLASS (gdk_texture_parent_class)->finalize (object);
+}
+
 static void
 gdk_texture_dispose (GObject *object)
 {
@@ -171,7 +195,9 @@ gdk_texture_class_init (GdkTextureClass *klass)
 
   gobject_class->set_property = gdk_texture_set_property;
   gobject_class->get_property = gdk_texture_get_property;
+  gobject_class->constructed = gdk_texture_constructed;
   gobject_class->dispose = gdk_texture_dispose;
+  gobject_class->finalize = gdk_texture_finalize;
 
   /**
    * GdkTexture:width:
@@ -439,6 +465,136 @@ gdk_pixbuf_texture_init (GdkPixbufTexture *self)
 {
 }
 
+/* GdkBytesTexture */
+
+#define GDK_TYPE_BYTES_TEXTURE (gdk_bytes_texture_get_type ())
+
+G_DECLARE_FINAL_TYPE (GdkBytesTexture, gdk_bytes_texture, GDK, BYTES_TEXTURE, GdkTexture)
+
+struct _GdkBytesTexture {
+  GdkTexture parent_instance;
+
+  GBytes *bytes;
+  gsize stride;
+};
+
+struct _GdkBytesTextureClass {
+  GdkTextureClass parent_class;
+};
+
+G_DEFINE_TYPE (GdkBytesTexture, gdk_bytes_texture, GDK_TYPE_TEXTURE)
+
+static cairo_user_data_key_t bytes_key;
+
+static void
+gdk_bytes_texture_finalize (GObject *object)
+{
+  GdkBytesTexture *self = GDK_BYTES_TEXTURE (object);
+
+  g_bytes_unref (self->bytes);
+
+  G_OBJECT_CLASS (gdk_bytes_texture_parent_class)->finalize (object);
+}
+
+static void
+gdk_bytes_texture_download (GdkTexture *texture,
+                            guchar     *data,
+                            gsize       stride)
+{
+  GdkBytesTexture *self = GDK_BYTES_TEXTURE (texture);
+  const guchar *src;
+  gsize y;
+
+  src = g_bytes_get_data (self->bytes, NULL);
+
+  for (y = 0; y < texture->height; y++)
+    memcpy (data + y * stride, src + y * self->stride, texture->width * 4);
+}
+
+static cairo_surface_t *
+gdk_bytes_texture_download_surface (GdkTexture *texture)
+{
+  GdkBytesTexture *self = GDK_BYTES_TEXTURE (texture);
+  cairo_surface_t *surface;
+
+  /* The surface uses the memory of the bytes directly, so that
+   * uploading it to the GPU does not need another copy. Nothing
+   * draws to it.
+   */
+  surface = cairo_image_surface_create_for_data ((guchar *) g_bytes_get_data (self->bytes, NULL),
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 texture->width, texture->height,
+                                                 self->stride);
+  cairo_surface_set_user_data (surface, &bytes_key,
+                               g_bytes_ref (self->bytes),
+                               (cairo_destroy_func_t) g_bytes_unref);
+
+  return surface;
+}
+
+static void
+gdk_bytes_texture_class_init (GdkBytesTextureClass *klass)
+{
+  GdkTextureClass *texture_class = GDK_TEXTURE_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  texture_class->download = gdk_bytes_texture_download;
+  texture_class->download_surface = gdk_bytes_texture_download_surface;
+
+  gobject_class->finalize = gdk_bytes_texture_finalize;
+}
+
+static void
+gdk_bytes_texture_init (GdkBytesTexture *self)
+{
+}
+
+/**
+ * gdk_texture_new_for_bytes:
+ * @bytes: the pixel data
+ * @width: the number of pixels in each row
+ * @height: the number of rows
+ * @stride: the distance from the beginning of one row to the next, in bytes
+ *
+ * Creates a new texture object for the pixel data in @bytes.
+ * The data is assumed to be in CAIRO_FORMAT_ARGB32 format.
+ *
+ * Unlike gdk_texture_new_for_data(), the data is not copied; the
+ * texture keeps a reference on @bytes and uses its memory directly
+ * when the texture is uploaded. The data must not change while the
+ * texture exists. To wrap memory that is owned elsewhere, like a
+ * mapped file or shared memory, create @bytes with
+ * g_bytes_new_with_free_func().
+ *
+ * Returns: a new #GdkTexture
+ *
+ * Since: 3.94
+ */
+GdkTexture *
+gdk_texture_new_for_bytes (GBytes *bytes,
+                           int     width,
+                           int     height,
+                           gsize   stride)
+{
+  GdkBytesTexture *self;
+
+  g_return_val_if_fail (bytes != NULL, NULL);
+  g_return_val_if_fail (width > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+  g_return_val_if_fail (stride >= width * 4 && stride % 4 == 0, NULL);
+  g_return_val_if_fail (g_bytes_get_size (bytes) >= stride * (height - 1) + width * 4, NULL);
+
+  self = g_object_new (GDK_TYPE_BYTES_TEXTURE,
+                       "width", width,
+                       "height", height,
+                       NULL);
+
+  self->bytes = g_bytes_ref (bytes);
+  self->stride = stride;
+
+  return GDK_TEXTURE (self);
+}
+
 /* GdkGLTexture */
 
 
@@ -484,6 +640,55 @@ gdk_gl_texture_dispose (GObject *object)
   G_OBJECT_CLASS (gdk_gl_texture_parent_class)->dispose (object);
 }
 
+/* Reads the texture straight into @data. gdk_cairo_draw_from_gl() reads
+ * the pixels into a temporary image through a framebuffer of the paint
+ * context and then paints that image flipped, which costs an extra
+ * allocation and copy for every frame a GL area shows with the cairo or
+ * Vulkan renderers. That needs glGetTexImage(), so not on GLES.
+ */
+static gboolean
+gdk_gl_texture_read_pixels (GdkGLTexture *self,
+                            guchar       *data,
+                            gsize         stride)
+{
+  GdkTexture *texture = GDK_TEXTURE (self);
+  GdkGLContext *previous;
+  guchar *row;
+  int y;
+
+  if (gdk_gl_context_get_use_es (self->context))
+    return FALSE;
+
+  previous = gdk_gl_context_get_current ();
+  gdk_gl_context_make_current (self->context);
+
+  glBindTexture (GL_TEXTURE_2D, self->id);
+  glPixelStorei (GL_PACK_ALIGNMENT, 4);
+  glPixelStorei (GL_PACK_ROW_LENGTH, stride / 4);
+  glGetTexImage (GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, data);
+  glPixelStorei (GL_PACK_ROW_LENGTH, 0);
+
+  if (previous)
+    gdk_gl_context_make_current (previous);
+  else
+    gdk_gl_context_clear_current ();
+
+  /* GL has the origin at the bottom */
+  row = g_malloc (texture->width * 4);
+  for (y = 0; y < texture->height / 2; y++)
+    {
+      guchar *top = data + y * stride;
+      guchar *bottom = data + (texture->height - 1 - y) * stride;
+
+      memcpy (row, top, texture->width * 4);
+      memcpy (top, bottom, texture->width * 4);
+      memcpy (bottom, row, texture->width * 4);
+    }
+  g_free (row);
+
+  return TRUE;
+}
+
 static void
 gdk_gl_texture_download (GdkTexture *texture,
                          guchar     *data,
@@ -493,6 +698,10 @@ gdk_gl_texture_download (GdkTexture *texture,
   cairo_surface_t *surface;
   cairo_t *cr;
 
+  if (self->saved == NULL &&
+      gdk_gl_texture_read_pixels (self, data, stride))
+    return;
+
   surface = cairo_image_surface_create_for_data (data,
                                                  CAIRO_FORMAT_ARGB32,
                                                  texture->width, texture->height,
@@ -575,13 +784,22 @@ gdk_texture_release_gl (GdkTexture *texture)
   self->saved = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                             texture->width, texture->height);
 
-  cr = cairo_create (self->saved);
+  if (gdk_gl_texture_read_pixels (self,
+                                  cairo_image_surface_get_data (self->saved),
+                                  cairo_image_surface_get_stride (self->saved)))
+    {
+      cairo_surface_mark_dirty (self->saved);
+    }
+  else
+    {
+      cr = cairo_create (self->saved);
 
-  window = gdk_gl_context_get_window (self->context);
-  gdk_cairo_draw_from_gl (cr, window, self->id, GL_TEXTURE, 1, 0, 0,
-                          texture->width, texture->height);
+      window = gdk_gl_context_get_window (self->context);
+      gdk_cairo_draw_from_gl (cr, window, self->id, GL_TEXTURE, 1, 0, 0,
+                              texture->width, texture->height);
 
-  cairo_destroy (cr);
+      cairo_destroy (cr);
+    }
 
   if (self->destroy)
     {
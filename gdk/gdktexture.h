@@ -49,6 +49,11 @@ GdkTexture *            gdk_texture_new_for_data               (const guchar
                                                                 int              height,
                                                                 int              stride);
 GDK_AVAILABLE_IN_3_94
+GdkTexture *            gdk_texture_new_for_bytes              (GBytes          *bytes,
+                                                                int              width,
+                                                                int              height,
+                                                                gsize            stride);
+GDK_AVAILABLE_IN_3_94
 GdkTexture *            gdk_texture_new_for_pixbuf             (GdkPixbuf       *pixbuf);
 GDK_AVAILABLE_IN_3_94
 GdkTexture *            gdk_texture_new_from_resource          (const char      *resource_path);
@@ -2710,6 +2710,43 @@ gdk_window_invalidate_rect (GdkWindow          *window,
   gdk_window_invalidate_rect_full (window, rect, invalidate_children);
 }
 
+/* Many small invalidations can fragment the update area into so many
+ * rectangles that clipping to them costs more than redrawing their
+ * bounding box. Past this many rectangles, or once the rectangles
+ * cover most of their extents anyway, fall back to the extents.
+ */
+#define MAX_UPDATE_AREA_RECTANGLES 32
+#define UPDATE_AREA_COVERAGE 0.75
+
+static void
+gdk_window_coalesce_update_area (cairo_region_t *region)
+{
+  cairo_rectangle_int_t extents, rect;
+  double area;
+  int i, n_rects;
+
+  n_rects = cairo_region_num_rectangles (region);
+  if (n_rects <= 1)
+    return;
+
+  cairo_region_get_extents (region, &extents);
+
+  if (n_rects <= MAX_UPDATE_AREA_RECTANGLES)
+    {
+      area = 0;
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_region_get_rectangle (region, i, &rect);
+          area += (double) rect.width * rect.height;
+        }
+
+      if (area < UPDATE_AREA_COVERAGE * extents.width * extents.height)
+        return;
+    }
+
+  cairo_region_union_rectangle (region, &extents);
+}
+
 static void
 impl_window_add_update_area (GdkWindow *impl_window,
 			     cairo_region_t *region)
@@ -2722,6 +2759,8 @@ impl_window_add_update_area (GdkWindow *impl_window,
       impl_window->update_area = cairo_region_copy (region);
       gdk_window_schedule_update (impl_window);
     }
+
+  gdk_window_coalesce_update_area (impl_window->update_area);
 }
 
 static void
@@ -5716,7 +5755,7 @@ _gdk_windowing_got_event (GdkDisplay *display,
   if (unlink_event)
     {
       _gdk_event_queue_remove_link (display, event_link);
-      g_list_free_1 (event_link);
+      _gdk_event_queue_free_link (display, event_link);
       gdk_event_free (event);
     }
 
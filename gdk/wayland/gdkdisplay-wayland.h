@@ -34,6 +34,7 @@
 #include <gdk/wayland/xdg-foreign-unstable-v1-client-protocol.h>
 #include <gdk/wayland/keyboard-shortcuts-inhibit-unstable-v1-client-protocol.h>
 #include <gdk/wayland/server-decoration-client-protocol.h>
+#include <gdk/wayland/presentation-time-client-protocol.h>
 
 #include <glib.h>
 #include <gdk/gdkkeys.h>
@@ -96,6 +97,8 @@ struct _GdkWaylandDisplay
   struct zxdg_importer_v1 *xdg_importer;
   struct zwp_keyboard_shortcuts_inhibit_manager_v1 *keyboard_shortcuts_inhibit;
   struct org_kde_kwin_server_decoration_manager *server_decoration_manager;
+  struct wp_presentation *presentation;
+  guint32 presentation_clock_id;
 
   GList *async_roundtrips;
 
@@ -143,6 +146,8 @@ struct _GdkWaylandDisplay
   guint have_egl_buffer_age : 1;
   guint have_egl_swap_buffers_with_damage : 1;
   guint have_egl_surfaceless_context : 1;
+  guint have_egl_image_dma_buf_import : 1;
+  guint have_egl_image_dma_buf_import_modifiers : 1;
 };
 
 struct _GdkWaylandDisplayClass
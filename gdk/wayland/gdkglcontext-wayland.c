@@ -33,6 +33,8 @@
 
 #include "gdkintl.h"
 
+#include <epoxy/gl.h>
+
 G_DEFINE_TYPE (GdkWaylandGLContext, gdk_wayland_gl_context, GDK_TYPE_GL_CONTEXT)
 
 static void gdk_wayland_gl_context_dispose (GObject *gobject);
@@ -182,7 +184,12 @@ gdk_wayland_gl_context_get_damage (GdkGLContext *context)
       eglQuerySurface (display_wayland->egl_display, egl_surface,
                        EGL_BUFFER_AGE_EXT, &buffer_age);
 
-      if (buffer_age == 2)
+      if (buffer_age == 1)
+        {
+          /* The back buffer holds the previous frame */
+          return cairo_region_create ();
+        }
+      else if (buffer_age == 2)
         {
           if (window->old_updated_area[0])
             return cairo_region_copy (window->old_updated_area[0]);
@@ -340,6 +347,13 @@ gdk_wayland_display_init_gl (GdkDisplay *display)
   display_wayland->have_egl_surfaceless_context =
     epoxy_has_egl_extension (dpy, "EGL_KHR_surfaceless_context");
 
+  display_wayland->have_egl_image_dma_buf_import =
+    epoxy_has_egl_extension (dpy, "EGL_KHR_image_base") &&
+    epoxy_has_egl_extension (dpy, "EGL_EXT_image_dma_buf_import");
+
+  display_wayland->have_egl_image_dma_buf_import_modifiers =
+    epoxy_has_egl_extension (dpy, "EGL_EXT_image_dma_buf_import_modifiers");
+
   GDK_DISPLAY_NOTE (display, OPENGL,
             g_message ("EGL API version %d.%d found\n"
                        " - Vendor: %s\n"
@@ -523,3 +537,174 @@ gdk_wayland_display_make_gl_context_current (GdkDisplay   *display,
 
   return TRUE;
 }
+
+#ifndef DRM_FORMAT_MOD_INVALID
+#define DRM_FORMAT_MOD_INVALID ((1ULL << 56) - 1)
+#endif
+
+#define MAX_DMABUF_PLANES 4
+
+typedef struct {
+  GdkGLContext *context;
+  EGLImageKHR image;
+  guint texture_id;
+} DmabufTexture;
+
+static void
+dmabuf_texture_free (gpointer data)
+{
+  DmabufTexture *texture = data;
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_gl_context_get_display (texture->context));
+
+  gdk_gl_context_make_current (texture->context);
+  glDeleteTextures (1, &texture->texture_id);
+  eglDestroyImageKHR (display_wayland->egl_display, texture->image);
+
+  g_object_unref (texture->context);
+  g_slice_free (DmabufTexture, texture);
+}
+
+/**
+ * gdk_wayland_gl_context_import_dmabuf:
+ * @context: a #GdkGLContext created for a Wayland window
+ * @width: the width of the buffer
+ * @height: the height of the buffer
+ * @fourcc: the DRM fourcc code of the buffer format
+ * @modifier: the DRM format modifier, or DRM_FORMAT_MOD_INVALID
+ * @n_planes: the number of planes, between 1 and 4
+ * @fds: (array length=n_planes): the dmabuf file descriptors of the planes
+ * @offsets: (array length=n_planes): the offsets of the planes, in bytes
+ * @strides: (array length=n_planes): the strides of the planes, in bytes
+ * @error: return location for a #GError, or %NULL
+ *
+ * Imports a dmabuf into @context and creates a texture for it,
+ * without copying the buffer contents. The texture can be used
+ * in render nodes like any other texture, and the GL renderer
+ * samples directly from the imported buffer.
+ *
+ * The file descriptors are not taken over by this function;
+ * the caller can close them once it returns.
+ *
+ * The buffer must not be modified while the texture is in use.
+ *
+ * Returns: (transfer full) (nullable): a new #GdkTexture, or %NULL
+ *   if the buffer could not be imported
+ *
+ * Since: 3.94
+ */
+GdkTexture *
+gdk_wayland_gl_context_import_dmabuf (GdkGLContext   *context,
+                                      int             width,
+                                      int             height,
+                                      guint32         fourcc,
+                                      guint64         modifier,
+                                      int             n_planes,
+                                      const int      *fds,
+                                      const guint32  *offsets,
+                                      const guint32  *strides,
+                                      GError        **error)
+{
+  static const EGLint plane_attrs[MAX_DMABUF_PLANES][5] = {
+    { EGL_DMA_BUF_PLANE0_FD_EXT, EGL_DMA_BUF_PLANE0_OFFSET_EXT, EGL_DMA_BUF_PLANE0_PITCH_EXT,
+      EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE1_FD_EXT, EGL_DMA_BUF_PLANE1_OFFSET_EXT, EGL_DMA_BUF_PLANE1_PITCH_EXT,
+      EGL_DMA_BUF_PLANE1_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE1_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE2_FD_EXT, EGL_DMA_BUF_PLANE2_OFFSET_EXT, EGL_DMA_BUF_PLANE2_PITCH_EXT,
+      EGL_DMA_BUF_PLANE2_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE2_MODIFIER_HI_EXT },
+    { EGL_DMA_BUF_PLANE3_FD_EXT, EGL_DMA_BUF_PLANE3_OFFSET_EXT, EGL_DMA_BUF_PLANE3_PITCH_EXT,
+      EGL_DMA_BUF_PLANE3_MODIFIER_LO_EXT, EGL_DMA_BUF_PLANE3_MODIFIER_HI_EXT },
+  };
+  GdkWaylandDisplay *display_wayland;
+  EGLint attrs[7 + MAX_DMABUF_PLANES * 10];
+  DmabufTexture *texture;
+  EGLImageKHR image;
+  guint texture_id;
+  int i, n;
+
+  g_return_val_if_fail (GDK_WAYLAND_IS_GL_CONTEXT (context), NULL);
+  g_return_val_if_fail (width > 0 && height > 0, NULL);
+  g_return_val_if_fail (n_planes > 0 && n_planes <= MAX_DMABUF_PLANES, NULL);
+  g_return_val_if_fail (fds != NULL && offsets != NULL && strides != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  display_wayland = GDK_WAYLAND_DISPLAY (gdk_gl_context_get_display (context));
+
+  if (!display_wayland->have_egl_image_dma_buf_import ||
+      (modifier != DRM_FORMAT_MOD_INVALID && !display_wayland->have_egl_image_dma_buf_import_modifiers))
+    {
+      g_set_error_literal (error, GDK_GL_ERROR,
+                           GDK_GL_ERROR_NOT_AVAILABLE,
+                           _("Importing dmabufs is not supported"));
+      return NULL;
+    }
+
+  n = 0;
+  attrs[n++] = EGL_WIDTH;
+  attrs[n++] = width;
+  attrs[n++] = EGL_HEIGHT;
+  attrs[n++] = height;
+  attrs[n++] = EGL_LINUX_DRM_FOURCC_EXT;
+  attrs[n++] = fourcc;
+
+  for (i = 0; i < n_planes; i++)
+    {
+      attrs[n++] = plane_attrs[i][0];
+      attrs[n++] = fds[i];
+      attrs[n++] = plane_attrs[i][1];
+      attrs[n++] = offsets[i];
+      attrs[n++] = plane_attrs[i][2];
+      attrs[n++] = strides[i];
+
+      if (modifier != DRM_FORMAT_MOD_INVALID)
+        {
+          attrs[n++] = plane_attrs[i][3];
+          attrs[n++] = modifier & 0xffffffff;
+          attrs[n++] = plane_attrs[i][4];
+          attrs[n++] = modifier >> 32;
+        }
+    }
+
+  attrs[n++] = EGL_NONE;
+
+  image = eglCreateImageKHR (display_wayland->egl_display,
+                             EGL_NO_CONTEXT,
+                             EGL_LINUX_DMA_BUF_EXT,
+                             (EGLClientBuffer) NULL,
+                             attrs);
+  if (image == EGL_NO_IMAGE_KHR)
+    {
+      g_set_error (error, GDK_GL_ERROR,
+                   GDK_GL_ERROR_UNSUPPORTED_FORMAT,
+                   _("Could not import dmabuf (EGL error 0x%x)"),
+                   eglGetError ());
+      return NULL;
+    }
+
+  gdk_gl_context_make_current (context);
+
+  if (!epoxy_has_gl_extension ("GL_OES_EGL_image"))
+    {
+      eglDestroyImageKHR (display_wayland->egl_display, image);
+      g_set_error_literal (error, GDK_GL_ERROR,
+                           GDK_GL_ERROR_NOT_AVAILABLE,
+                           _("Importing dmabufs is not supported"));
+      return NULL;
+    }
+
+  glGenTextures (1, &texture_id);
+  glBindTexture (GL_TEXTURE_2D, texture_id);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glEGLImageTargetTexture2DOES (GL_TEXTURE_2D, image);
+  glBindTexture (GL_TEXTURE_2D, 0);
+
+  texture = g_slice_new (DmabufTexture);
+  texture->context = g_object_ref (context);
+  texture->image = image;
+  texture->texture_id = texture_id;
+
+  return gdk_texture_new_for_gl (context, texture_id, width, height,
+                                 dmabuf_texture_free, texture);
+}
@@ -41,6 +41,7 @@
 #include "wayland/gtk-primary-selection-client-protocol.h"
 
 #define WL_SURFACE_HAS_BUFFER_SCALE 3
+#define WL_SURFACE_HAS_DAMAGE_BUFFER 4
 #define WL_POINTER_HAS_FRAME 5
 
 #define GDK_WINDOW_IS_WAYLAND(win)    (GDK_IS_WINDOW_IMPL_WAYLAND (((GdkWindow *)win)->impl))
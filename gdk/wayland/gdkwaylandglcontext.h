@@ -40,6 +40,18 @@ typedef struct _GdkWaylandGLContextClass	GdkWaylandGLContextClass;
 GDK_AVAILABLE_IN_3_16
 GType gdk_wayland_gl_context_get_type (void) G_GNUC_CONST;
 
+GDK_AVAILABLE_IN_3_94
+GdkTexture *    gdk_wayland_gl_context_import_dmabuf    (GdkGLContext   *context,
+                                                         int             width,
+                                                         int             height,
+                                                         guint32         fourcc,
+                                                         guint64         modifier,
+                                                         int             n_planes,
+                                                         const int      *fds,
+                                                         const guint32  *offsets,
+                                                         const guint32  *strides,
+                                                         GError        **error);
+
 G_END_DECLS
 
 #endif /* __GDK_WAYLAND_GL_CONTEXT_H__ */
@@ -39,6 +39,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 
 enum {
   COMMITTED,
@@ -53,6 +54,12 @@ static guint signals[LAST_SIGNAL];
 
 #define MAX_WL_BUFFER_SIZE (4083) /* 4096 minus header, string argument length and NUL byte */
 
+/* At most this many released buffers are kept per window for reuse */
+#define MAX_SPARE_BUFFERS 2
+/* Damage is remembered for this many commits, older buffers are
+ * backfilled completely when they are reused */
+#define MAX_BUFFER_AGE (MAX_SPARE_BUFFERS + 1)
+
 typedef struct _GdkWaylandWindow GdkWaylandWindow;
 typedef struct _GdkWaylandWindowClass GdkWaylandWindowClass;
 
@@ -135,6 +142,13 @@ struct _GdkWindowImplWayland
   cairo_surface_t *committed_cairo_surface;
   cairo_surface_t *backfill_cairo_surface;
 
+  /* Buffers the compositor released, kept around to be drawn again */
+  GPtrArray *spare_cairo_surfaces;
+  /* The regions damaged by the last commits, most recent first */
+  cairo_region_t *damage_history[MAX_BUFFER_AGE];
+  cairo_region_t *pending_damage_region;
+  guint commit_serial;
+
   int pending_buffer_offset_x;
   int pending_buffer_offset_y;
 
@@ -266,9 +280,15 @@ static void
 drop_cairo_surfaces (GdkWindow *window)
 {
   GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  int i;
 
   g_clear_pointer (&impl->staging_cairo_surface, cairo_surface_destroy);
   g_clear_pointer (&impl->backfill_cairo_surface, cairo_surface_destroy);
+  g_clear_pointer (&impl->spare_cairo_surfaces, g_ptr_array_unref);
+  g_clear_pointer (&impl->pending_damage_region, cairo_region_destroy);
+
+  for (i = 0; i < MAX_BUFFER_AGE; i++)
+    g_clear_pointer (&impl->damage_history[i], cairo_region_destroy);
 
   /* We nullify this so if a buffer release comes in later, we won't
    * try to reuse that buffer since it's no longer suitable
@@ -401,6 +421,41 @@ fill_presentation_time_from_frame_time (GdkFrameTimings *timings,
     }
 }
 
+static const cairo_user_data_key_t gdk_wayland_window_serial_key;
+
+/* Returns the region of @surface that is older than the last committed
+ * buffer, or %NULL if all of it may be.
+ */
+static cairo_region_t *
+get_stale_region (GdkWindowImplWayland *impl,
+                  cairo_surface_t      *surface)
+{
+  cairo_region_t *region;
+  guint serial, age, i;
+
+  serial = GPOINTER_TO_UINT (cairo_surface_get_user_data (surface, &gdk_wayland_window_serial_key));
+  if (serial == 0)
+    return NULL;
+
+  age = impl->commit_serial - serial;
+  if (age > MAX_BUFFER_AGE)
+    return NULL;
+
+  region = cairo_region_create ();
+  for (i = 0; i < age; i++)
+    {
+      if (impl->damage_history[i] == NULL)
+        {
+          cairo_region_destroy (region);
+          return NULL;
+        }
+
+      cairo_region_union (region, impl->damage_history[i]);
+    }
+
+  return region;
+}
+
 static void
 read_back_cairo_surface (GdkWindow *window)
 {
@@ -411,7 +466,12 @@ read_back_cairo_surface (GdkWindow *window)
   if (!impl->backfill_cairo_surface)
     goto out;
 
-  paint_region = cairo_region_copy (window->clip_region);
+  /* A reused buffer only lacks what changed since it was last shown */
+  paint_region = get_stale_region (impl, impl->staging_cairo_surface);
+  if (paint_region)
+    cairo_region_intersect (paint_region, window->clip_region);
+  else
+    paint_region = cairo_region_copy (window->clip_region);
   cairo_region_subtract (paint_region, impl->staged_updates_region);
 
   if (cairo_region_is_empty (paint_region))
@@ -432,6 +492,14 @@ out:
   g_clear_pointer (&impl->backfill_cairo_surface, cairo_surface_destroy);
 }
 
+static gboolean
+gdk_wayland_display_has_presentation_feedback (GdkWaylandDisplay *display_wayland)
+{
+  /* Frame timings are in g_get_monotonic_time() units */
+  return display_wayland->presentation != NULL &&
+         display_wayland->presentation_clock_id == CLOCK_MONOTONIC;
+}
+
 static void
 frame_callback (void               *data,
                 struct wl_callback *callback,
@@ -463,21 +531,20 @@ frame_callback (void               *data,
   if (timings == NULL)
     return;
 
-  timings->refresh_interval = 16667; /* default to 1/60th of a second */
-  if (impl->display_server.outputs)
-    {
-      /* We pick a random output out of the outputs that the window touches
-       * The rate here is in milli-hertz */
-      int refresh_rate =
-        gdk_wayland_display_get_output_refresh_rate (display_wayland,
-                                                     impl->display_server.outputs->data);
-      if (refresh_rate != 0)
-        timings->refresh_interval = G_GINT64_CONSTANT(1000000000) / refresh_rate;
-    }
+  /* Presentation feedback may have arrived first */
+  if (timings->complete)
+    return;
+
+  timings->refresh_interval = _gdk_frame_clock_get_refresh_interval (clock);
+
+  /* With presentation feedback, the timings get completed once we
+   * know when the frame was actually shown */
+  if (gdk_wayland_display_has_presentation_feedback (display_wayland))
+    return;
 
   fill_presentation_time_from_frame_time (timings, time);
 
-  timings->complete = TRUE;
+  _gdk_frame_clock_complete_timings (clock, timings);
 
 #ifdef G_ENABLE_DEBUG
   if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
@@ -489,6 +556,126 @@ static const struct wl_callback_listener frame_listener = {
   frame_callback
 };
 
+typedef struct {
+  GdkWindow *window;
+  gint64 frame_counter;
+} PresentationFeedback;
+
+static void
+presentation_feedback_free (PresentationFeedback *data,
+                            struct wp_presentation_feedback *feedback)
+{
+  wp_presentation_feedback_destroy (feedback);
+  g_object_unref (data->window);
+  g_slice_free (PresentationFeedback, data);
+}
+
+static GdkFrameTimings *
+presentation_feedback_get_timings (PresentationFeedback *data)
+{
+  GdkFrameClock *clock;
+
+  if (GDK_WINDOW_DESTROYED (data->window))
+    return NULL;
+
+  clock = gdk_window_get_frame_clock (data->window);
+  if (clock == NULL)
+    return NULL;
+
+  return gdk_frame_clock_get_timings (clock, data->frame_counter);
+}
+
+static void
+presentation_feedback_complete (PresentationFeedback *data,
+                                GdkFrameTimings      *timings)
+{
+  GdkFrameClock *clock = gdk_window_get_frame_clock (data->window);
+
+  _gdk_frame_clock_complete_timings (clock, timings);
+
+#ifdef G_ENABLE_DEBUG
+  if ((_gdk_debug_flags & GDK_DEBUG_FRAMES) != 0)
+    _gdk_frame_clock_debug_print_timings (clock, timings);
+#endif
+}
+
+static void
+presentation_feedback_sync_output (void                            *_data,
+                                   struct wp_presentation_feedback *feedback,
+                                   struct wl_output                *output)
+{
+}
+
+static void
+presentation_feedback_presented (void                            *_data,
+                                 struct wp_presentation_feedback *feedback,
+                                 uint32_t                         tv_sec_hi,
+                                 uint32_t                         tv_sec_lo,
+                                 uint32_t                         tv_nsec,
+                                 uint32_t                         refresh,
+                                 uint32_t                         seq_hi,
+                                 uint32_t                         seq_lo,
+                                 uint32_t                         flags)
+{
+  PresentationFeedback *data = _data;
+  GdkFrameTimings *timings;
+
+  timings = presentation_feedback_get_timings (data);
+  if (timings != NULL)
+    {
+      timings->presentation_time = (((gint64) tv_sec_hi << 32) + tv_sec_lo) * G_USEC_PER_SEC + tv_nsec / 1000;
+      if (refresh != 0)
+        timings->refresh_interval = refresh / 1000;
+
+      presentation_feedback_complete (data, timings);
+    }
+
+  presentation_feedback_free (data, feedback);
+}
+
+static void
+presentation_feedback_discarded (void                            *_data,
+                                 struct wp_presentation_feedback *feedback)
+{
+  PresentationFeedback *data = _data;
+  GdkFrameTimings *timings;
+
+  /* The frame was never shown, so there is no presentation time */
+  timings = presentation_feedback_get_timings (data);
+  if (timings != NULL)
+    presentation_feedback_complete (data, timings);
+
+  presentation_feedback_free (data, feedback);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+  presentation_feedback_sync_output,
+  presentation_feedback_presented,
+  presentation_feedback_discarded
+};
+
+static void
+gdk_wayland_window_request_presentation_feedback (GdkWindow *window,
+                                                  gint64     frame_counter)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
+  struct wp_presentation_feedback *feedback;
+  PresentationFeedback *data;
+
+  if (!gdk_wayland_display_has_presentation_feedback (display_wayland))
+    return;
+
+  data = g_slice_new (PresentationFeedback);
+  data->window = g_object_ref (window);
+  data->frame_counter = frame_counter;
+
+  feedback = wp_presentation_feedback (display_wayland->presentation,
+                                       impl->display_server.wl_surface);
+  wp_presentation_feedback_add_listener (feedback, &presentation_feedback_listener, data);
+}
+
 static void
 on_frame_clock_before_paint (GdkFrameClock *clock,
                              GdkWindow     *window)
@@ -553,10 +740,29 @@ on_frame_clock_after_paint (GdkFrameClock *clock,
    * before we need to stage any changes, then we can take it back and
    * use it again.
    */
+  gdk_wayland_window_request_presentation_feedback (window,
+                                                    gdk_frame_clock_get_frame_counter (clock));
   wl_surface_commit (impl->display_server.wl_surface);
 
   if (impl->pending_buffer_attached)
-    impl->committed_cairo_surface = g_steal_pointer (&impl->staging_cairo_surface);
+    {
+      int i;
+
+      impl->committed_cairo_surface = g_steal_pointer (&impl->staging_cairo_surface);
+
+      g_clear_pointer (&impl->damage_history[MAX_BUFFER_AGE - 1], cairo_region_destroy);
+      for (i = MAX_BUFFER_AGE - 1; i > 0; i--)
+        impl->damage_history[i] = impl->damage_history[i - 1];
+      impl->damage_history[0] = g_steal_pointer (&impl->pending_damage_region);
+
+      impl->commit_serial++;
+      if (impl->commit_serial == 0)
+        impl->commit_serial++;
+      cairo_surface_set_user_data (impl->committed_cairo_surface,
+                                   &gdk_wayland_window_serial_key,
+                                   GUINT_TO_POINTER (impl->commit_serial),
+                                   NULL);
+    }
 
   impl->pending_buffer_attached = FALSE;
   impl->pending_commit = FALSE;
@@ -699,8 +905,10 @@ buffer_release_callback (void             *_data,
 
   g_return_if_fail (GDK_IS_WINDOW_IMPL_WAYLAND (impl));
 
-  /* The released buffer isn't the latest committed one, we have no further
-   * use for it, so clean it up.
+  /* The released buffer isn't the latest committed one. Keep it for
+   * drawing the next frames into if it still fits the window, so we
+   * don't need to create new buffers, and so that only the parts that
+   * changed since it was last shown need to be copied into it.
    */
   if (impl->committed_cairo_surface != cairo_surface)
     {
@@ -709,7 +917,17 @@ buffer_release_callback (void             *_data,
        */
       g_warn_if_fail (impl->staging_cairo_surface != cairo_surface);
 
-      cairo_surface_destroy (cairo_surface);
+      if (impl->committed_cairo_surface != NULL &&
+          cairo_image_surface_get_width (cairo_surface) == cairo_image_surface_get_width (impl->committed_cairo_surface) &&
+          cairo_image_surface_get_height (cairo_surface) == cairo_image_surface_get_height (impl->committed_cairo_surface) &&
+          (impl->spare_cairo_surfaces == NULL || impl->spare_cairo_surfaces->len < MAX_SPARE_BUFFERS))
+        {
+          if (impl->spare_cairo_surfaces == NULL)
+            impl->spare_cairo_surfaces = g_ptr_array_new_with_free_func ((GDestroyNotify) cairo_surface_destroy);
+          g_ptr_array_add (impl->spare_cairo_surfaces, cairo_surface);
+        }
+      else
+        cairo_surface_destroy (cairo_surface);
       return;
     }
 
@@ -772,6 +990,18 @@ gdk_wayland_window_ensure_cairo_surface (GdkWindow *window)
                                           impl->scale, impl->scale);
         }
     }
+  else if (!impl->staging_cairo_surface &&
+           impl->spare_cairo_surfaces != NULL &&
+           impl->spare_cairo_surfaces->len > 0)
+    {
+      GPtrArray *spares = impl->spare_cairo_surfaces;
+
+      /* Take the buffer that was shown most recently, it needs the
+       * least copying from the committed one */
+      impl->staging_cairo_surface = g_ptr_array_index (spares, spares->len - 1);
+      spares->pdata[spares->len - 1] = NULL;
+      g_ptr_array_set_size (spares, spares->len - 1);
+    }
   else if (!impl->staging_cairo_surface)
     {
       GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_window_get_display (impl->wrapper));
@@ -834,6 +1064,7 @@ static void
 gdk_window_impl_wayland_end_paint (GdkWindow *window)
 {
   GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *display_wayland = GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
   cairo_rectangle_int_t rect;
   int i, n;
 
@@ -861,11 +1092,21 @@ gdk_window_impl_wayland_end_paint (GdkWindow *window)
             }
         }
 
+      if (impl->pending_damage_region == NULL)
+        impl->pending_damage_region = cairo_region_copy (window->current_paint.region);
+      else
+        cairo_region_union (impl->pending_damage_region, window->current_paint.region);
+
       n = cairo_region_num_rectangles (window->current_paint.region);
       for (i = 0; i < n; i++)
         {
           cairo_region_get_rectangle (window->current_paint.region, i, &rect);
-          wl_surface_damage (impl->display_server.wl_surface, rect.x, rect.y, rect.width, rect.height);
+          if (display_wayland->compositor_version >= WL_SURFACE_HAS_DAMAGE_BUFFER)
+            wl_surface_damage_buffer (impl->display_server.wl_surface,
+                                      rect.x * impl->scale, rect.y * impl->scale,
+                                      rect.width * impl->scale, rect.height * impl->scale);
+          else
+            wl_surface_damage (impl->display_server.wl_surface, rect.x, rect.y, rect.width, rect.height);
         }
 
       impl->pending_commit = TRUE;
@@ -1203,6 +1444,29 @@ gdk_wayland_set_input_region_if_empty (GdkWindow *window)
   impl->input_region_dirty = FALSE;
 }
 
+/* Windows on several outputs get frame callbacks at the rate of
+ * the fastest one. The rate here is in milli-hertz */
+static void
+gdk_wayland_window_update_refresh_interval (GdkWindow *window)
+{
+  GdkWindowImplWayland *impl = GDK_WINDOW_IMPL_WAYLAND (window->impl);
+  GdkWaylandDisplay *display_wayland =
+    GDK_WAYLAND_DISPLAY (gdk_window_get_display (window));
+  GdkFrameClock *clock = gdk_window_get_frame_clock (window);
+  int refresh_rate = 0;
+  GSList *l;
+
+  if (clock == NULL)
+    return;
+
+  for (l = impl->display_server.outputs; l != NULL; l = l->next)
+    refresh_rate = MAX (refresh_rate,
+                        gdk_wayland_display_get_output_refresh_rate (display_wayland, l->data));
+
+  if (refresh_rate != 0)
+    _gdk_frame_clock_set_refresh_interval (clock, G_GINT64_CONSTANT (1000000000) / refresh_rate);
+}
+
 static void
 surface_enter (void              *data,
                struct wl_surface *wl_surface,
@@ -1217,6 +1481,7 @@ surface_enter (void              *data,
   impl->display_server.outputs = g_slist_prepend (impl->display_server.outputs, output);
 
   gdk_wayland_window_update_scale (window);
+  gdk_wayland_window_update_refresh_interval (window);
 }
 
 static void
@@ -1233,7 +1498,10 @@ surface_leave (void              *data,
   impl->display_server.outputs = g_slist_remove (impl->display_server.outputs, output);
 
   if (impl->display_server.outputs)
-    gdk_wayland_window_update_scale (window);
+    {
+      gdk_wayland_window_update_scale (window);
+      gdk_wayland_window_update_refresh_interval (window);
+    }
 }
 
 static const struct wl_surface_listener surface_listener = {
@@ -628,6 +628,31 @@ get_event_xwindow (const XEvent *xevent)
   return xwindow;
 }
 
+/* Makes the frame clock of @window assume the refresh rate of the
+ * monitor that the window is mostly on */
+static void
+update_refresh_interval (GdkDisplay *display,
+                         GdkWindow  *window)
+{
+  GdkFrameClock *clock = gdk_window_get_frame_clock (window);
+  GdkMonitor *monitor;
+  int refresh_rate;
+
+  if (clock == NULL)
+    return;
+
+  monitor = gdk_display_get_monitor_at_point (display,
+                                              window->x + window->width / 2,
+                                              window->y + window->height / 2);
+  if (monitor == NULL)
+    return;
+
+  /* The rate here is in milli-hertz */
+  refresh_rate = gdk_monitor_get_refresh_rate (monitor);
+  if (refresh_rate != 0)
+    _gdk_frame_clock_set_refresh_interval (clock, G_GINT64_CONSTANT (1000000000) / refresh_rate);
+}
+
 static gboolean
 gdk_x11_display_translate_event (GdkEventTranslator *translator,
                                  GdkDisplay         *display,
@@ -1007,6 +1032,8 @@ gdk_x11_display_translate_event (GdkEventTranslator *translator,
                   _gdk_x11_window_update_size (window_impl);
                 }
 
+	      update_refresh_interval (display, window);
+
 	      if (window->resize_count >= 1)
 		{
 		  window->resize_count -= 1;
@@ -1281,7 +1308,7 @@ _gdk_wm_protocols_filter (GdkXEvent *xev,
               if (refresh_interval)
                 timings->refresh_interval = refresh_interval;
 
-              timings->complete = TRUE;
+              _gdk_frame_clock_complete_timings (clock, timings);
 #ifdef G_ENABLE_DEBUG
               if (GDK_DISPLAY_DEBUG_CHECK (display, FRAMES))
                 _gdk_frame_clock_debug_print_timings (clock, timings);
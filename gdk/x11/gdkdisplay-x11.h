@@ -103,6 +103,10 @@ struct _GdkX11Display
 
   /* X ID hashtable */
   GHashTable *xid_ht;
+  /* The last successful lookup in xid_ht; most events in a
+   * row are for the same window */
+  XID last_xid;
+  GdkWindow *last_xid_window;
 
   /* translation queue */
   GQueue *translate_queue;
@@ -129,6 +133,8 @@ struct _GdkX11Display
   guint base_dnd_atoms_precached : 1;
   guint xdnd_atoms_precached : 1;
   guint motif_atoms_precached : 1;
+  /* Atoms used when setting up toplevels */
+  guint window_atoms_precached : 1;
   guint use_sync : 1;
 
   guint have_shapes : 1;
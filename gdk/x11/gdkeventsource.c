@@ -399,7 +399,14 @@ gdk_event_source_xevent (GdkX11Display  *x11_display,
 static gboolean
 gdk_check_xpending (GdkDisplay *display)
 {
-  return XPending (GDK_DISPLAY_XDISPLAY (display));
+  Display *xdisplay = GDK_DISPLAY_XDISPLAY (display);
+
+  /* Only go to the connection once Xlib's buffer has been drained,
+   * so a burst of events costs one read rather than a flush and a
+   * poll per event.
+   */
+  return XEventsQueued (xdisplay, QueuedAlready) > 0 ||
+         XPending (xdisplay) > 0;
 }
 
 static gboolean
@@ -452,7 +459,7 @@ _gdk_x11_display_queue_events (GdkDisplay *display)
   XEvent xevent;
   gboolean unused;
 
-  while (!_gdk_event_queue_find_first (display) && XPending (xdisplay))
+  while (!_gdk_event_queue_find_first (display) && gdk_check_xpending (display))
     {
       XNextEvent (xdisplay, &xevent);
 
@@ -52,6 +52,7 @@ typedef struct {
   GLXWindow dummy_glx;
 
   guint32 last_frame_counter;
+  gint64 last_swap_msc;
 } DrawableInfo;
 
 static void
@@ -118,6 +119,36 @@ maybe_wait_for_vblank (GdkDisplay  *display,
     }
 }
 
+/* With GLX_OML_sync_control, the swap can be scheduled for the next
+ * vertical refresh without waiting for it, so we keep processing
+ * events while the frame is displayed. We only need to make sure not
+ * to swap twice during the same refresh, otherwise we'd tear.
+ */
+static gboolean
+maybe_schedule_swap (GdkDisplay   *display,
+                     DrawableInfo *info,
+                     GLXDrawable   drawable)
+{
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+  Display *dpy = gdk_x11_display_get_xdisplay (display);
+  gint64 ust, msc, sbc, target_msc;
+
+  if (!display_x11->has_glx_sync_control || info == NULL)
+    return FALSE;
+
+  if (!glXGetSyncValuesOML (dpy, drawable, &ust, &msc, &sbc))
+    return FALSE;
+
+  target_msc = MAX (msc, info->last_swap_msc + 1);
+  if (glXSwapBuffersMscOML (dpy, drawable, target_msc, 0, 0) == -1)
+    return FALSE;
+
+  /* A target in the past swaps at the next refresh */
+  info->last_swap_msc = MAX (target_msc, msc + 1);
+
+  return TRUE;
+}
+
 static void
 gdk_x11_gl_context_end_frame (GdkDrawContext *draw_context,
                               cairo_region_t *painted,
@@ -149,6 +180,10 @@ gdk_x11_gl_context_end_frame (GdkDrawContext *draw_context,
                        (unsigned long) gdk_x11_window_get_xid (window),
                        context_x11->do_frame_sync ? "yes" : "no"));
 
+  if (context_x11->do_frame_sync && !display_x11->has_glx_swap_interval &&
+      maybe_schedule_swap (display, info, drawable))
+    return;
+
   /* if we are going to wait for the vertical refresh manually
    * we need to flush pending redraws, and we also need to wait
    * for that to finish, otherwise we are going to tear.
@@ -211,7 +246,12 @@ gdk_x11_gl_context_get_damage (GdkGLContext *context)
       glXQueryDrawable(dpy, shared_x11->attached_drawable,
 		       GLX_BACK_BUFFER_AGE_EXT, &buffer_age);
 
-      if (buffer_age == 2)
+      if (buffer_age == 1)
+        {
+          /* The back buffer holds the previous frame */
+          return cairo_region_create ();
+        }
+      else if (buffer_age == 2)
         {
           if (window->old_updated_area[0])
             return cairo_region_copy (window->old_updated_area[0]);
@@ -326,6 +326,11 @@ gdk_x11_selection_output_stream_write (GOutputStream  *output_stream,
   GdkX11SelectionOutputStream *stream = GDK_X11_SELECTION_OUTPUT_STREAM (output_stream);
   GdkX11SelectionOutputStreamPrivate *priv = gdk_x11_selection_output_stream_get_instance_private (stream);
 
+  /* Take at most one request worth of data at a time, so that big
+   * transfers are not copied into our buffer all at once.
+   */
+  count = MIN (count, gdk_x11_display_get_max_request_size (priv->display));
+
   g_mutex_lock (&priv->mutex);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: wrote %zu bytes, %u total now\n",
@@ -359,6 +364,8 @@ gdk_x11_selection_output_stream_write_async (GOutputStream        *output_stream
   g_task_set_source_tag (task, gdk_x11_selection_output_stream_write_async);
   g_task_set_priority (task, io_priority);
 
+  count = MIN (count, gdk_x11_display_get_max_request_size (priv->display));
+
   g_mutex_lock (&priv->mutex);
   g_byte_array_append (priv->data, buffer, count);
   GDK_NOTE (SELECTION, g_printerr ("%s:%s: async wrote %zu bytes, %u total now\n",
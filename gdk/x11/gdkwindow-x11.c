@@ -456,7 +456,7 @@ gdk_x11_window_end_frame (GdkWindow *window)
     }
 
   if (!impl->toplevel->frame_pending)
-    timings->complete = TRUE;
+    _gdk_frame_clock_complete_timings (gdk_window_get_frame_clock (window), timings);
 }
 
 /*****************************************************
@@ -742,6 +742,55 @@ ensure_sync_counter (GdkWindow *window)
 #endif
 }
 
+/* Setting up and mapping a toplevel touches all of these; interning
+ * them one by one costs a round trip each the first time around.
+ */
+static void
+precache_window_atoms (GdkDisplay *display)
+{
+  GdkX11Display *display_x11 = GDK_X11_DISPLAY (display);
+
+  if (!display_x11->window_atoms_precached)
+    {
+      static const char *const precache_atoms[] = {
+        "UTF8_STRING",
+        "WM_CLIENT_LEADER",
+        "WM_DELETE_WINDOW",
+        "WM_TAKE_FOCUS",
+        "_GTK_FRAME_EXTENTS",
+        "_GTK_THEME_VARIANT",
+        "_NET_WM_DESKTOP",
+        "_NET_WM_ICON_NAME",
+        "_NET_WM_NAME",
+        "_NET_WM_OPAQUE_REGION",
+        "_NET_WM_PID",
+        "_NET_WM_PING",
+        "_NET_WM_STATE",
+        "_NET_WM_STATE_ABOVE",
+        "_NET_WM_STATE_BELOW",
+        "_NET_WM_STATE_FULLSCREEN",
+        "_NET_WM_STATE_HIDDEN",
+        "_NET_WM_STATE_MAXIMIZED_HORZ",
+        "_NET_WM_STATE_MAXIMIZED_VERT",
+        "_NET_WM_STATE_MODAL",
+        "_NET_WM_STATE_SKIP_PAGER",
+        "_NET_WM_STATE_SKIP_TASKBAR",
+        "_NET_WM_STATE_STICKY",
+        "_NET_WM_SYNC_REQUEST",
+        "_NET_WM_SYNC_REQUEST_COUNTER",
+        "_NET_WM_USER_TIME",
+        "_NET_WM_USER_TIME_WINDOW",
+        "_NET_WM_WINDOW_TYPE",
+        "_NET_WM_WINDOW_TYPE_NORMAL"
+      };
+
+      _gdk_x11_precache_atoms (display,
+                               precache_atoms, G_N_ELEMENTS (precache_atoms));
+
+      display_x11->window_atoms_precached = TRUE;
+    }
+}
+
 static void
 setup_toplevel_window (GdkWindow    *window,
 		       GdkX11Screen *x11_screen)
@@ -994,6 +1043,7 @@ _gdk_x11_display_create_window_impl (GdkDisplay    *display,
     {
     case GDK_WINDOW_TOPLEVEL:
     case GDK_WINDOW_TEMP:
+      precache_window_atoms (display);
       gdk_window_set_title (window, get_default_title ());
 
       class_hint = XAllocClassHint ();
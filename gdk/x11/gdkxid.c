@@ -85,6 +85,12 @@ _gdk_x11_display_remove_window (GdkDisplay *display,
     display_x11->toplevels = g_list_remove (display_x11->toplevels, window);
 
   g_hash_table_remove (display_x11->xid_ht, &xid);
+
+  if (display_x11->last_xid == xid)
+    {
+      display_x11->last_xid = None;
+      display_x11->last_xid_window = NULL;
+    }
 }
 
 /**
@@ -111,8 +117,17 @@ gdk_x11_window_lookup_for_display (GdkDisplay *display,
 
   display_x11 = GDK_X11_DISPLAY (display);
 
+  if (window != None && window == display_x11->last_xid)
+    return display_x11->last_xid_window;
+
   if (display_x11->xid_ht)
     data = g_hash_table_lookup (display_x11->xid_ht, &window);
 
+  if (data)
+    {
+      display_x11->last_xid = window;
+      display_x11->last_xid_window = data;
+    }
+
   return data;
 }
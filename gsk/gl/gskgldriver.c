@@ -8,6 +8,8 @@
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
+#include <stdlib.h>
+#include <string.h>
 
  typedef struct {
   GLuint fbo_id;
@@ -20,12 +22,44 @@ typedef struct {
   int height;
   GLuint min_filter;
   GLuint mag_filter;
+  int level;
   Fbo fbo;
   GdkTexture *user;
+  guint64 last_used;
   guint in_use : 1;
   guint permanent : 1;
+  guint uploading : 1;
 } Texture;
 
+/* Cached textures that are not used for this many frames get evicted */
+#define MAX_CACHED_TEXTURE_AGE 3
+#define MAX_CACHED_TEXTURES    128
+
+/* Uploaded textures and cached offscreens get evicted, least recently
+ * used first, while all textures together take more memory than this.
+ * GSK_GL_TEXTURE_BUDGET overrides it, in megabytes. */
+#define DEFAULT_TEXTURE_BUDGET (256 * 1024 * 1024)
+
+/* Textures with at least this many pixels are uploaded through a pixel
+ * buffer object, so that the copy happens asynchronously. Until the fence
+ * after the upload has signaled, the texture is reported as not ready,
+ * and renderers can show a placeholder without waiting for it. */
+#define MIN_ASYNC_UPLOAD_PIXELS (256 * 256)
+#define MAX_PENDING_UPLOADS     8
+
+typedef struct {
+  GLuint pbo_id;
+  GLsync fence;
+  int texture_id;
+} PendingUpload;
+
+typedef struct {
+  GskTextureKey key;
+  GDestroyNotify key_destroy;
+  int texture_id;
+  guint64 last_used;
+} CachedTexture;
+
 struct _GskGLDriver
 {
   GObject parent_instance;
@@ -36,22 +70,43 @@ struct _GskGLDriver
     GQuark created_textures;
     GQuark reused_textures;
     GQuark surface_uploads;
+    GQuark async_uploads;
+    GQuark cached_textures;
+    GQuark evicted_textures;
+    GQuark reuploaded_textures;
+    GQuark resident_bytes;
+    GQuark upload_bytes;
   } counters;
 
   Fbo default_fbo;
 
   GHashTable *textures;
+  GHashTable *texture_cache;
+
+  GArray *pending_uploads;
+  GArray *free_pbos;
 
   const Texture *bound_source_texture;
   const Fbo *bound_fbo;
 
   int max_texture_size;
+  gsize texture_budget;
+
+  guint64 current_frame;
 
   gboolean in_frame : 1;
+  gboolean checked_async_uploads : 1;
+  gboolean has_async_uploads : 1;
 };
 
 G_DEFINE_TYPE (GskGLDriver, gsk_gl_driver, G_TYPE_OBJECT)
 
+static Texture * gsk_gl_driver_get_texture            (GskGLDriver *driver,
+                                                       int          texture_id);
+static void      gsk_gl_driver_set_texture_parameters (GskGLDriver *driver,
+                                                       int          min_filter,
+                                                       int          mag_filter);
+
 static Texture *
 texture_new (void)
 {
@@ -82,14 +137,70 @@ texture_free (gpointer data)
   g_slice_free (Texture, t);
 }
 
+static guint
+texture_key_hash (gconstpointer data)
+{
+  const GskTextureKey *k = data;
+  guint h;
+
+  h = g_direct_hash (k->pointer);
+  h = (h << 5) - h + (guint) k->bounds.origin.x;
+  h = (h << 5) - h + (guint) k->bounds.origin.y;
+  h = (h << 5) - h + (guint) k->bounds.size.width;
+  h = (h << 5) - h + (guint) k->bounds.size.height;
+  h = (h << 5) - h + (guint) (k->scale * 100);
+
+  return h;
+}
+
+static gboolean
+texture_key_equal (gconstpointer v1,
+                   gconstpointer v2)
+{
+  const GskTextureKey *k1 = v1;
+  const GskTextureKey *k2 = v2;
+
+  return k1->pointer == k2->pointer &&
+         k1->scale == k2->scale &&
+         k1->opacity == k2->opacity &&
+         graphene_point_equal (&k1->offset, &k2->offset) &&
+         graphene_rect_equal (&k1->bounds, &k2->bounds);
+}
+
+static void
+cached_texture_free (gpointer data)
+{
+  CachedTexture *c = data;
+
+  if (c->key_destroy)
+    c->key_destroy (c->key.pointer);
+
+  g_slice_free (CachedTexture, c);
+}
+
 
 static void
 gsk_gl_driver_finalize (GObject *gobject)
 {
   GskGLDriver *self = GSK_GL_DRIVER (gobject);
+  guint i;
 
   gdk_gl_context_make_current (self->gl_context);
 
+  for (i = 0; i < self->pending_uploads->len; i++)
+    {
+      PendingUpload *upload = &g_array_index (self->pending_uploads, PendingUpload, i);
+
+      glDeleteSync (upload->fence);
+      glDeleteBuffers (1, &upload->pbo_id);
+    }
+  g_array_unref (self->pending_uploads);
+
+  if (self->free_pbos->len > 0)
+    glDeleteBuffers (self->free_pbos->len, (GLuint *) self->free_pbos->data);
+  g_array_unref (self->free_pbos);
+
+  g_clear_pointer (&self->texture_cache, g_hash_table_unref);
   g_clear_pointer (&self->textures, g_hash_table_unref);
   g_clear_object (&self->profiler);
 
@@ -110,12 +221,36 @@ gsk_gl_driver_class_init (GskGLDriverClass *klass)
 static void
 gsk_gl_driver_init (GskGLDriver *self)
 {
+  const char *env;
+
   self->textures = g_hash_table_new_full (NULL, NULL, NULL, texture_free);
+  self->texture_cache = g_hash_table_new_full (texture_key_hash, texture_key_equal,
+                                               NULL, cached_texture_free);
+  self->pending_uploads = g_array_new (FALSE, FALSE, sizeof (PendingUpload));
+  self->free_pbos = g_array_new (FALSE, FALSE, sizeof (GLuint));
 
   self->max_texture_size = -1;
 
+  self->texture_budget = DEFAULT_TEXTURE_BUDGET;
+  env = g_getenv ("GSK_GL_TEXTURE_BUDGET");
+  if (env != NULL && atoi (env) > 0)
+    self->texture_budget = (gsize) atoi (env) * 1024 * 1024;
+}
+
+GskGLDriver *
+gsk_gl_driver_new (GdkGLContext *context,
+                   GskProfiler  *profiler)
+{
+  GskGLDriver *self;
+  g_return_val_if_fail (GDK_IS_GL_CONTEXT (context), NULL);
+
+  self = (GskGLDriver *) g_object_new (GSK_TYPE_GL_DRIVER, NULL);
+  self->gl_context = context;
+  /* The counters go to the profiler of the renderer, so that they
+   * show up next to its own */
+  self->profiler = g_object_ref (profiler);
+
 #ifdef G_ENABLE_DEBUG
-  self->profiler = gsk_profiler_new ();
   self->counters.created_textures = gsk_profiler_add_counter (self->profiler,
                                                               "created_textures",
                                                               "Textures created this frame",
@@ -128,19 +263,62 @@ gsk_gl_driver_init (GskGLDriver *self)
                                                              "surface_uploads",
                                                              "Texture uploads from surfaces this frame",
                                                              TRUE);
+  self->counters.async_uploads = gsk_profiler_add_counter (self->profiler,
+                                                           "async_uploads",
+                                                           "Asynchronous texture uploads started this frame",
+                                                           TRUE);
+  self->counters.cached_textures = gsk_profiler_add_counter (self->profiler,
+                                                             "cached_textures",
+                                                             "Cached textures reused this frame",
+                                                             TRUE);
+  self->counters.evicted_textures = gsk_profiler_add_counter (self->profiler,
+                                                              "evicted_textures",
+                                                              "Textures evicted to stay within the memory budget",
+                                                              TRUE);
+  self->counters.reuploaded_textures = gsk_profiler_add_counter (self->profiler,
+                                                                 "reuploaded_textures",
+                                                                 "Evicted textures uploaded again this frame",
+                                                                 TRUE);
+  self->counters.resident_bytes = gsk_profiler_add_counter (self->profiler,
+                                                            "resident_bytes",
+                                                            "Memory used by textures",
+                                                            FALSE);
+  self->counters.upload_bytes = gsk_profiler_add_counter (self->profiler,
+                                                          "upload_bytes",
+                                                          "Bytes uploaded to textures this frame",
+                                                          TRUE);
 #endif
+
+  return self;
 }
 
-GskGLDriver *
-gsk_gl_driver_new (GdkGLContext *context)
+/* Marks the textures whose uploads have finished as ready */
+static void
+gsk_gl_driver_collect_uploads (GskGLDriver *self)
 {
-  GskGLDriver *self;
-  g_return_val_if_fail (GDK_IS_GL_CONTEXT (context), NULL);
+  guint i;
 
-  self = (GskGLDriver *) g_object_new (GSK_TYPE_GL_DRIVER, NULL);
-  self->gl_context = context;
+  for (i = 0; i < self->pending_uploads->len; )
+    {
+      PendingUpload *upload = &g_array_index (self->pending_uploads, PendingUpload, i);
+      Texture *t;
+      GLenum status;
 
-  return self;
+      status = glClientWaitSync (upload->fence, 0, 0);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+          i++;
+          continue;
+        }
+
+      t = gsk_gl_driver_get_texture (self, upload->texture_id);
+      if (t != NULL)
+        t->uploading = FALSE;
+
+      glDeleteSync (upload->fence);
+      g_array_append_val (self->free_pbos, upload->pbo_id);
+      g_array_remove_index_fast (self->pending_uploads, i);
+    }
 }
 
 void
@@ -150,6 +328,7 @@ gsk_gl_driver_begin_frame (GskGLDriver *self)
   g_return_if_fail (!self->in_frame);
 
   self->in_frame = TRUE;
+  self->current_frame ++;
 
   if (self->max_texture_size < 0)
     {
@@ -157,6 +336,18 @@ gsk_gl_driver_begin_frame (GskGLDriver *self)
       GSK_NOTE (OPENGL, g_message ("GL max texture size: %d", self->max_texture_size));
     }
 
+  if (!self->checked_async_uploads)
+    {
+      /* We rely on GL_BGRA uploads and sync objects */
+      self->has_async_uploads = !gdk_gl_context_get_use_es (self->gl_context) &&
+                                (epoxy_gl_version () >= 32 || epoxy_has_gl_extension ("GL_ARB_sync"));
+      self->checked_async_uploads = TRUE;
+      GSK_NOTE (OPENGL, g_message ("Asynchronous texture uploads: %s",
+                                   self->has_async_uploads ? "yes" : "no"));
+    }
+
+  gsk_gl_driver_collect_uploads (self);
+
   glBindFramebuffer (GL_FRAMEBUFFER, 0);
   self->bound_fbo = &self->default_fbo;
 
@@ -204,6 +395,133 @@ gsk_gl_driver_end_frame (GskGLDriver *self)
   self->in_frame = FALSE;
 }
 
+static void
+gsk_gl_driver_evict_cached_texture (GskGLDriver   *driver,
+                                    CachedTexture *c)
+{
+  Texture *t = g_hash_table_lookup (driver->textures, GINT_TO_POINTER (c->texture_id));
+
+  /* Give the texture back to the pool so it can be reused by size */
+  if (t != NULL)
+    t->permanent = FALSE;
+}
+
+static void
+gsk_gl_driver_collect_cached_textures (GskGLDriver *driver)
+{
+  GHashTableIter iter;
+  gpointer value_p = NULL;
+
+  g_hash_table_iter_init (&iter, driver->texture_cache);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    {
+      CachedTexture *c = value_p;
+
+      if (driver->current_frame - c->last_used >= MAX_CACHED_TEXTURE_AGE)
+        {
+          gsk_gl_driver_evict_cached_texture (driver, c);
+          g_hash_table_iter_remove (&iter);
+        }
+    }
+}
+
+#ifdef G_ENABLE_DEBUG
+G_DEFINE_QUARK (gsk-gl-driver-evicted, gsk_gl_driver_evicted)
+#endif
+
+static gsize
+texture_get_size (const Texture *t)
+{
+  return (gsize) t->width * t->height * 4;
+}
+
+/* Frees uploaded textures and cached offscreens, oldest first, until
+ * the textures fit into the budget again. Textures that were used in
+ * the last frame are kept, so a frame that needs more memory than the
+ * budget does not re-upload everything every frame. Returns the number
+ * of evicted textures. */
+static int
+gsk_gl_driver_enforce_texture_budget (GskGLDriver *driver)
+{
+  GHashTableIter iter;
+  gpointer value_p = NULL;
+  gsize resident = 0;
+  int n_evicted = 0;
+
+  g_hash_table_iter_init (&iter, driver->textures);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    resident += texture_get_size (value_p);
+
+  while (resident > driver->texture_budget)
+    {
+      Texture *oldest_texture = NULL;
+      CachedTexture *oldest_cached = NULL;
+      guint64 oldest = driver->current_frame;
+      Texture *t;
+      int texture_id;
+
+      g_hash_table_iter_init (&iter, driver->textures);
+      while (g_hash_table_iter_next (&iter, NULL, &value_p))
+        {
+          t = value_p;
+
+          if (t->user != NULL && !t->uploading && t->last_used < oldest)
+            {
+              oldest_texture = t;
+              oldest = t->last_used;
+            }
+        }
+
+      g_hash_table_iter_init (&iter, driver->texture_cache);
+      while (g_hash_table_iter_next (&iter, NULL, &value_p))
+        {
+          CachedTexture *c = value_p;
+
+          if (c->last_used < oldest)
+            {
+              oldest_cached = c;
+              oldest_texture = NULL;
+              oldest = c->last_used;
+            }
+        }
+
+      if (oldest_cached != NULL)
+        {
+          texture_id = oldest_cached->texture_id;
+          g_hash_table_remove (driver->texture_cache, &oldest_cached->key);
+        }
+      else if (oldest_texture != NULL)
+        {
+          texture_id = oldest_texture->texture_id;
+#ifdef G_ENABLE_DEBUG
+          g_object_set_qdata (G_OBJECT (oldest_texture->user), gsk_gl_driver_evicted_quark (), driver);
+#endif
+        }
+      else
+        break;
+
+      t = g_hash_table_lookup (driver->textures, GINT_TO_POINTER (texture_id));
+      if (t != NULL)
+        {
+          resident -= texture_get_size (t);
+          g_hash_table_remove (driver->textures, GINT_TO_POINTER (texture_id));
+        }
+
+      n_evicted++;
+    }
+
+  GSK_NOTE (OPENGL, if (n_evicted > 0)
+                      g_message ("Evicted %d textures, %" G_GSIZE_FORMAT " bytes resident",
+                                 n_evicted, resident));
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_add (driver->profiler, driver->counters.evicted_textures, n_evicted);
+  gsk_profiler_counter_set (driver->profiler, driver->counters.resident_bytes, resident);
+#endif
+
+  return n_evicted;
+}
+
 int
 gsk_gl_driver_collect_textures (GskGLDriver *driver)
 {
@@ -214,6 +532,8 @@ gsk_gl_driver_collect_textures (GskGLDriver *driver)
   g_return_val_if_fail (GSK_IS_GL_DRIVER (driver), 0);
   g_return_val_if_fail (!driver->in_frame, 0);
 
+  gsk_gl_driver_collect_cached_textures (driver);
+
   old_size = g_hash_table_size (driver->textures);
 
   g_hash_table_iter_init (&iter, driver->textures);
@@ -238,6 +558,8 @@ gsk_gl_driver_collect_textures (GskGLDriver *driver)
         g_hash_table_iter_remove (&iter);
     }
 
+  gsk_gl_driver_enforce_texture_budget (driver);
+
   return old_size - g_hash_table_size (driver->textures);
 }
 
@@ -361,14 +683,132 @@ gsk_gl_driver_release_texture (gpointer data)
   t->user = NULL;
 }
 
+/* Copies @surface into a pixel buffer object and lets the GL copy it to
+ * @t from there, without waiting for the upload to finish. Returns
+ * %FALSE if @surface should be uploaded synchronously. */
+static gboolean
+gsk_gl_driver_upload_texture_async (GskGLDriver     *self,
+                                    Texture         *t,
+                                    cairo_surface_t *surface,
+                                    int              min_filter,
+                                    int              mag_filter)
+{
+  PendingUpload upload;
+  int width, height, stride;
+  const guchar *data;
+  guchar *mapped;
+  int y;
+
+  if (!self->has_async_uploads ||
+      self->pending_uploads->len >= MAX_PENDING_UPLOADS)
+    return FALSE;
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  if (width * height < MIN_ASYNC_UPLOAD_PIXELS ||
+      width != t->width || height != t->height ||
+      cairo_image_surface_get_format (surface) != CAIRO_FORMAT_ARGB32)
+    return FALSE;
+
+  if (self->free_pbos->len > 0)
+    {
+      upload.pbo_id = g_array_index (self->free_pbos, GLuint, self->free_pbos->len - 1);
+      g_array_set_size (self->free_pbos, self->free_pbos->len - 1);
+    }
+  else
+    glGenBuffers (1, &upload.pbo_id);
+
+  /* Reallocating the storage lets the driver hand out fresh memory
+   * while the previous upload from this buffer may still be in flight */
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, upload.pbo_id);
+  glBufferData (GL_PIXEL_UNPACK_BUFFER, width * height * 4, NULL, GL_STREAM_DRAW);
+  mapped = glMapBufferRange (GL_PIXEL_UNPACK_BUFFER, 0, width * height * 4,
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (mapped == NULL)
+    {
+      glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+      g_array_append_val (self->free_pbos, upload.pbo_id);
+      return FALSE;
+    }
+
+  cairo_surface_flush (surface);
+  data = cairo_image_surface_get_data (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  for (y = 0; y < height; y++)
+    memcpy (mapped + y * width * 4, data + y * stride, width * 4);
+
+  glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+
+  gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
+  glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+                GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+  glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+
+  t->min_filter = min_filter;
+  t->mag_filter = mag_filter;
+
+  if (t->min_filter != GL_NEAREST)
+    glGenerateMipmap (GL_TEXTURE_2D);
+
+  upload.fence = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  upload.texture_id = t->texture_id;
+  g_array_append_val (self->pending_uploads, upload);
+
+  t->uploading = TRUE;
+
+  GSK_NOTE (OPENGL, g_message ("Uploading Texture(%d) of size %dx%d asynchronously",
+                               t->texture_id, width, height));
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (self->profiler, self->counters.async_uploads);
+  gsk_profiler_counter_add (self->profiler, self->counters.upload_bytes, width * height * 4);
+#endif
+
+  return TRUE;
+}
+
+static cairo_surface_t *
+downscale_surface (cairo_surface_t *surface,
+                   int              width,
+                   int              height)
+{
+  cairo_surface_t *scaled;
+  cairo_t *cr;
+
+  scaled = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cairo_surface_set_device_scale (scaled, 1, 1);
+
+  cr = cairo_create (scaled);
+  cairo_scale (cr,
+               (double) width / cairo_image_surface_get_width (surface),
+               (double) height / cairo_image_surface_get_height (surface));
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_pattern_set_filter (cairo_get_source (cr), CAIRO_FILTER_GOOD);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  return scaled;
+}
+
+/* Returns a GL texture for @texture. If @level is larger than 0, the
+ * texture is only drawn at a fraction of its size, and the GL texture
+ * may be downscaled by up to 2^@level in each direction to save memory
+ * and bandwidth. Texture coordinates are the same for all levels.
+ *
+ * A texture that was uploaded at a coarse level is uploaded again when
+ * it is drawn larger, but never the other way around, so textures that
+ * are drawn at different sizes don't get uploaded over and over. */
 int
 gsk_gl_driver_get_texture_for_texture (GskGLDriver *driver,
                                        GdkTexture  *texture,
+                                       int          level,
                                        int          min_filter,
                                        int          mag_filter)
 {
   Texture *t;
   cairo_surface_t *surface;
+  int width, height;
 
   if (GDK_IS_GL_TEXTURE (texture))
     return gdk_gl_texture_get_id (GDK_GL_TEXTURE (texture));
@@ -377,27 +817,154 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *driver,
 
   if (t)
     {
-      if (t->min_filter == min_filter && t->mag_filter == mag_filter)
-        return t->texture_id;
+      if (t->min_filter == min_filter && t->mag_filter == mag_filter &&
+          t->level <= level)
+        {
+          t->last_used = driver->current_frame;
+          return t->texture_id;
+        }
+
+      /* Ops recorded for this frame may still use the old texture, but
+       * it stays in use until the end of the frame */
+      if (t->level > level)
+        gdk_texture_clear_render_data (texture);
     }
 
-  t = create_texture (driver, gdk_texture_get_width (texture), gdk_texture_get_height (texture));
+  width = MAX (1, gdk_texture_get_width (texture) >> level);
+  height = MAX (1, gdk_texture_get_height (texture) >> level);
+
+  t = create_texture (driver, width, height);
+  t->level = level;
+  t->last_used = driver->current_frame;
+
+#ifdef G_ENABLE_DEBUG
+  if (g_object_steal_qdata (G_OBJECT (texture), gsk_gl_driver_evicted_quark ()) == driver)
+    gsk_profiler_counter_inc (driver->profiler, driver->counters.reuploaded_textures);
+#endif
 
   if (gdk_texture_set_render_data (texture, driver, t, gsk_gl_driver_release_texture))
     t->user = texture;
 
   surface = gdk_texture_download_surface (texture);
+  if (level > 0)
+    {
+      cairo_surface_t *scaled = downscale_surface (surface, t->width, t->height);
+
+      GSK_NOTE (OPENGL, g_message ("Downscaling Texture(%d) from %dx%d to %dx%d",
+                                   t->texture_id,
+                                   gdk_texture_get_width (texture), gdk_texture_get_height (texture),
+                                   t->width, t->height));
+
+      cairo_surface_destroy (surface);
+      surface = scaled;
+    }
+
   gsk_gl_driver_bind_source_texture (driver, t->texture_id);
-  gsk_gl_driver_init_texture_with_surface (driver,
-                                           t->texture_id,
-                                           surface,
-                                           min_filter,
-                                           mag_filter);
+  if (!gsk_gl_driver_upload_texture_async (driver, t, surface, min_filter, mag_filter))
+    gsk_gl_driver_init_texture_with_surface (driver,
+                                             t->texture_id,
+                                             surface,
+                                             min_filter,
+                                             mag_filter);
   cairo_surface_destroy (surface);
 
   return t->texture_id;
 }
 
+/* Returns whether the upload of @texture_id has finished. Textures that
+ * are not ready can still be used, but drawing them may stall the GPU. */
+gboolean
+gsk_gl_driver_is_texture_ready (GskGLDriver *driver,
+                                int          texture_id)
+{
+  Texture *t;
+
+  g_return_val_if_fail (GSK_IS_GL_DRIVER (driver), TRUE);
+
+  t = gsk_gl_driver_get_texture (driver, texture_id);
+
+  return t == NULL || !t->uploading;
+}
+
+int
+gsk_gl_driver_get_texture_for_key (GskGLDriver         *driver,
+                                   const GskTextureKey *key)
+{
+  CachedTexture *c;
+
+  g_return_val_if_fail (GSK_IS_GL_DRIVER (driver), 0);
+
+  c = g_hash_table_lookup (driver->texture_cache, key);
+  if (c == NULL)
+    return 0;
+
+  c->last_used = driver->current_frame;
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (driver->profiler, driver->counters.cached_textures);
+#endif
+
+  return c->texture_id;
+}
+
+/* Keeps @texture_id alive across frames, until it has not been looked up
+ * for MAX_CACHED_TEXTURE_AGE frames or the cache needs room for newer
+ * textures. @key_destroy is called on the key's pointer on eviction. */
+void
+gsk_gl_driver_set_texture_for_key (GskGLDriver         *driver,
+                                   const GskTextureKey *key,
+                                   int                  texture_id,
+                                   GDestroyNotify       key_destroy)
+{
+  CachedTexture *c;
+  Texture *t;
+
+  g_return_if_fail (GSK_IS_GL_DRIVER (driver));
+
+  t = gsk_gl_driver_get_texture (driver, texture_id);
+  if (t == NULL)
+    {
+      g_critical ("No texture %d found.", texture_id);
+      return;
+    }
+
+  c = g_hash_table_lookup (driver->texture_cache, key);
+  if (c != NULL)
+    {
+      gsk_gl_driver_evict_cached_texture (driver, c);
+      g_hash_table_remove (driver->texture_cache, key);
+    }
+
+  if (g_hash_table_size (driver->texture_cache) >= MAX_CACHED_TEXTURES)
+    {
+      GHashTableIter iter;
+      gpointer value_p = NULL;
+      CachedTexture *oldest = NULL;
+
+      g_hash_table_iter_init (&iter, driver->texture_cache);
+      while (g_hash_table_iter_next (&iter, NULL, &value_p))
+        {
+          CachedTexture *old = value_p;
+
+          if (oldest == NULL || old->last_used < oldest->last_used)
+            oldest = old;
+        }
+
+      gsk_gl_driver_evict_cached_texture (driver, oldest);
+      g_hash_table_remove (driver->texture_cache, &oldest->key);
+    }
+
+  t->permanent = TRUE;
+
+  c = g_slice_new (CachedTexture);
+  c->key = *key;
+  c->key_destroy = key_destroy;
+  c->texture_id = texture_id;
+  c->last_used = driver->current_frame;
+
+  g_hash_table_replace (driver->texture_cache, &c->key, c);
+}
+
 int
 gsk_gl_driver_create_permanent_texture (GskGLDriver *self,
                                         float        width,
@@ -626,6 +1193,7 @@ gsk_gl_driver_init_texture_with_surface (GskGLDriver     *self,
 
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
+  gsk_profiler_counter_add (self->profiler, self->counters.upload_bytes, (gint64) t->width * t->height * 4);
 #endif
 
   t->min_filter = min_filter;
@@ -5,6 +5,8 @@
 #include <gdk/gdk.h>
 #include <graphene.h>
 
+#include "gskprofilerprivate.h"
+
 G_BEGIN_DECLS
 
 #define GSK_TYPE_GL_DRIVER (gsk_gl_driver_get_type ())
@@ -16,7 +18,16 @@ typedef struct {
   float uv[2];
 } GskQuadVertex;
 
-GskGLDriver *   gsk_gl_driver_new                       (GdkGLContext    *context);
+typedef struct {
+  gpointer pointer;
+  float scale;
+  float opacity;
+  graphene_point_t offset;
+  graphene_rect_t bounds;
+} GskTextureKey;
+
+GskGLDriver *   gsk_gl_driver_new                       (GdkGLContext    *context,
+                                                         GskProfiler     *profiler);
 
 int             gsk_gl_driver_get_max_texture_size      (GskGLDriver     *driver);
 
@@ -25,8 +36,17 @@ void            gsk_gl_driver_end_frame                 (GskGLDriver     *driver
 
 int             gsk_gl_driver_get_texture_for_texture   (GskGLDriver     *driver,
                                                          GdkTexture      *texture,
+                                                         int              level,
                                                          int              min_filter,
                                                          int              mag_filter);
+gboolean        gsk_gl_driver_is_texture_ready          (GskGLDriver     *driver,
+                                                         int              texture_id);
+int             gsk_gl_driver_get_texture_for_key       (GskGLDriver     *driver,
+                                                         const GskTextureKey *key);
+void            gsk_gl_driver_set_texture_for_key       (GskGLDriver     *driver,
+                                                         const GskTextureKey *key,
+                                                         int              texture_id,
+                                                         GDestroyNotify   key_destroy);
 int             gsk_gl_driver_create_permanent_texture  (GskGLDriver     *driver,
                                                          float            width,
                                                          float            height);
@@ -0,0 +1,298 @@
+#include "config.h"
+
+#include "gskgliconcacheprivate.h"
+#include "gskgldriverprivate.h"
+#include "gskdebugprivate.h"
+#include "gskprivate.h"
+
+#include <cairo/cairo.h>
+#include <epoxy/gl.h>
+
+/* Small textures, like icons, are packed into shared atlas textures, so
+ * that drawing many of them does not need a texture switch for each one,
+ * and the draws can be merged.
+ *
+ * Each atlas is a grid of cells that fit the largest icon we cache, plus
+ * a pixel of transparent padding on each side, so that linear filtering
+ * does not pick up neighbouring icons. Icons that have not been used for
+ * MAX_AGE frames are dropped every CHECK_INTERVAL frames, and atlases that
+ * end up empty are dropped.
+ */
+
+#define MAX_ICON_SIZE 64
+#define CELL_SIZE (MAX_ICON_SIZE + 2)
+#define ATLAS_SIZE 1024
+#define MAX_ATLASES 4
+
+#define MAX_AGE 60
+#define CHECK_INTERVAL 10
+
+typedef struct
+{
+  GskGLImage image;
+  guint cells_per_row;
+  guint n_cells;
+  guint n_used;
+  gboolean *used;
+} IconAtlas;
+
+typedef struct
+{
+  GskGLCachedIcon icon;
+
+  GdkTexture *texture;
+  IconAtlas *atlas;
+  guint cell;
+  guint64 timestamp;
+} CachedIcon;
+
+static void
+free_atlas (gpointer v)
+{
+  IconAtlas *atlas = v;
+
+  g_assert (atlas->image.texture_id == 0);
+  g_free (atlas->used);
+  g_free (atlas);
+}
+
+static void
+free_icon (gpointer v)
+{
+  CachedIcon *icon = v;
+
+  icon->atlas->used[icon->cell] = FALSE;
+  icon->atlas->n_used--;
+
+  g_object_unref (icon->texture);
+  g_free (icon);
+}
+
+static IconAtlas *
+create_atlas (GskGLIconCache *self)
+{
+  IconAtlas *atlas;
+  int size;
+
+  size = MIN (ATLAS_SIZE, gsk_gl_driver_get_max_texture_size (self->gl_driver));
+
+  atlas = g_new0 (IconAtlas, 1);
+  gsk_gl_image_create (&atlas->image, self->gl_driver, size, size);
+  atlas->cells_per_row = size / CELL_SIZE;
+  atlas->n_cells = atlas->cells_per_row * atlas->cells_per_row;
+  atlas->used = g_new0 (gboolean, atlas->n_cells);
+
+  /* Icons can be drawn scaled */
+  gsk_gl_driver_bind_source_texture (self->gl_driver, atlas->image.texture_id);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  return atlas;
+}
+
+static void
+destroy_atlas (GskGLIconCache *self,
+               IconAtlas      *atlas)
+{
+  gsk_gl_image_destroy (&atlas->image, self->gl_driver);
+  atlas->image.texture_id = 0;
+}
+
+void
+gsk_gl_icon_cache_init (GskGLIconCache *self,
+                        GskRenderer    *renderer,
+                        GskGLDriver    *gl_driver)
+{
+  self->atlases = g_ptr_array_new_with_free_func (free_atlas);
+  self->icons = g_hash_table_new_full (NULL, NULL, NULL, free_icon);
+
+  self->renderer = renderer;
+  self->gl_driver = gl_driver;
+}
+
+void
+gsk_gl_icon_cache_free (GskGLIconCache *self)
+{
+  guint i;
+
+  g_hash_table_unref (self->icons);
+
+  for (i = 0; i < self->atlases->len; i++)
+    destroy_atlas (self, g_ptr_array_index (self->atlases, i));
+
+  g_ptr_array_unref (self->atlases);
+}
+
+static gboolean
+atlas_alloc (IconAtlas *atlas,
+             guint     *cell)
+{
+  guint i;
+
+  if (atlas->n_used == atlas->n_cells)
+    return FALSE;
+
+  for (i = 0; i < atlas->n_cells; i++)
+    {
+      if (!atlas->used[i])
+        {
+          atlas->used[i] = TRUE;
+          atlas->n_used++;
+          *cell = i;
+          return TRUE;
+        }
+    }
+
+  g_assert_not_reached ();
+  return FALSE;
+}
+
+static void
+upload_icon (GskGLIconCache *self,
+             CachedIcon     *icon,
+             int             x,
+             int             y)
+{
+  cairo_surface_t *surface, *padded;
+  GskImageRegion region;
+  cairo_t *cr;
+  int width, height;
+
+  width = gdk_texture_get_width (icon->texture);
+  height = gdk_texture_get_height (icon->texture);
+
+  /* Upload the padding too, so no leftovers of dropped icons remain */
+  surface = gdk_texture_download_surface (icon->texture);
+  padded = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width + 2, height + 2);
+  cr = cairo_create (padded);
+  cairo_set_source_surface (cr, surface, 1, 1);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (padded);
+
+  region.data = cairo_image_surface_get_data (padded);
+  region.width = width + 2;
+  region.height = height + 2;
+  region.stride = cairo_image_surface_get_stride (padded);
+  region.x = x;
+  region.y = y;
+
+  gsk_gl_image_upload_regions (&icon->atlas->image, self->gl_driver, 1, &region);
+
+  cairo_surface_destroy (padded);
+  cairo_surface_destroy (surface);
+}
+
+/* Returns where @texture is in the icon atlases, adding it if needed,
+ * or %NULL if it should be drawn on its own. */
+const GskGLCachedIcon *
+gsk_gl_icon_cache_lookup_or_add (GskGLIconCache *self,
+                                 GdkTexture     *texture)
+{
+  CachedIcon *icon;
+  IconAtlas *atlas = NULL;
+  int width, height;
+  guint cell;
+  int x, y;
+  guint i;
+
+  icon = g_hash_table_lookup (self->icons, texture);
+  if (icon)
+    {
+      icon->timestamp = self->timestamp;
+      return &icon->icon;
+    }
+
+  width = gdk_texture_get_width (texture);
+  height = gdk_texture_get_height (texture);
+  if (width > MAX_ICON_SIZE || height > MAX_ICON_SIZE)
+    return NULL;
+
+  for (i = 0; i < self->atlases->len; i++)
+    {
+      atlas = g_ptr_array_index (self->atlases, i);
+
+      if (atlas_alloc (atlas, &cell))
+        break;
+    }
+
+  if (i == self->atlases->len)
+    {
+      if (self->atlases->len == MAX_ATLASES)
+        return NULL;
+
+      atlas = create_atlas (self);
+      g_ptr_array_add (self->atlases, atlas);
+
+      GSK_RENDERER_NOTE (self->renderer, OPENGL,
+                g_message ("Created icon atlas %d (%dx%d)", i,
+                           atlas->image.width, atlas->image.height));
+
+      if (!atlas_alloc (atlas, &cell))
+        return NULL;
+    }
+
+  x = (cell % atlas->cells_per_row) * CELL_SIZE;
+  y = (cell / atlas->cells_per_row) * CELL_SIZE;
+
+  icon = g_new0 (CachedIcon, 1);
+  icon->texture = g_object_ref (texture);
+  icon->atlas = atlas;
+  icon->cell = cell;
+  icon->timestamp = self->timestamp;
+  icon->icon.texture_id = atlas->image.texture_id;
+  graphene_rect_init (&icon->icon.texture_rect,
+                      (float)(x + 1) / atlas->image.width,
+                      (float)(y + 1) / atlas->image.height,
+                      (float)width / atlas->image.width,
+                      (float)height / atlas->image.height);
+
+  upload_icon (self, icon, x, y);
+
+  g_hash_table_insert (self->icons, texture, icon);
+
+  return &icon->icon;
+}
+
+void
+gsk_gl_icon_cache_begin_frame (GskGLIconCache *self)
+{
+  GHashTableIter iter;
+  CachedIcon *icon;
+  guint dropped = 0;
+  int i;
+
+  self->timestamp++;
+
+  if (self->timestamp % CHECK_INTERVAL != 0)
+    return;
+
+  /* look for icons that have grown old and drop them */
+  g_hash_table_iter_init (&iter, self->icons);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&icon))
+    {
+      if (self->timestamp - icon->timestamp < MAX_AGE)
+        continue;
+
+      g_hash_table_iter_remove (&iter);
+      dropped++;
+    }
+
+  /* look for atlases that are now empty */
+  for (i = self->atlases->len - 1; i >= 0; i--)
+    {
+      IconAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+      if (atlas->n_used == 0)
+        {
+          GSK_RENDERER_NOTE (self->renderer, OPENGL,
+                    g_message ("Dropping icon atlas %d", i));
+
+          destroy_atlas (self, atlas);
+          g_ptr_array_remove_index (self->atlases, i);
+        }
+    }
+
+  if (dropped > 0)
+    GSK_RENDERER_NOTE (self->renderer, OPENGL, g_message ("Dropped %d icons", dropped));
+}
@@ -0,0 +1,35 @@
+#ifndef __GSK_GL_ICON_CACHE_PRIVATE_H__
+#define __GSK_GL_ICON_CACHE_PRIVATE_H__
+
+#include "gskgldriverprivate.h"
+#include "gskglimageprivate.h"
+#include "gskrendererprivate.h"
+#include <gdk/gdk.h>
+#include <graphene.h>
+
+typedef struct
+{
+  GskGLDriver *gl_driver;
+  GskRenderer *renderer;
+
+  GPtrArray *atlases;
+  GHashTable *icons; /* GdkTexture -> GskGLCachedIcon */
+
+  guint64 timestamp;
+} GskGLIconCache;
+
+typedef struct
+{
+  int texture_id;
+  graphene_rect_t texture_rect; /* in texture coordinates */
+} GskGLCachedIcon;
+
+void                    gsk_gl_icon_cache_init            (GskGLIconCache *self,
+                                                           GskRenderer    *renderer,
+                                                           GskGLDriver    *gl_driver);
+void                    gsk_gl_icon_cache_free            (GskGLIconCache *self);
+void                    gsk_gl_icon_cache_begin_frame     (GskGLIconCache *self);
+const GskGLCachedIcon * gsk_gl_icon_cache_lookup_or_add   (GskGLIconCache *self,
+                                                           GdkTexture     *texture);
+
+#endif
@@ -1,6 +1,7 @@
 
 #include "gskglimageprivate.h"
 #include <epoxy/gl.h>
+#include <string.h>
 
 void
 gsk_gl_image_create (GskGLImage  *self,
@@ -47,19 +48,50 @@ gsk_gl_image_upload_regions (GskGLImage           *self,
                              guint                 n_regions,
                              const GskImageRegion *regions)
 {
+  gboolean use_row_length;
+  guchar *copy = NULL;
   guint i;
 
+  use_row_length = !gdk_gl_context_get_use_es (gdk_gl_context_get_current ());
+
+  gsk_gl_driver_bind_source_texture (gl_driver, self->texture_id);
+  glBindTexture (GL_TEXTURE_2D, self->texture_id);
+
   for (i = 0; i < n_regions; i ++)
     {
       const GskImageRegion *region = &regions[i];
+      const guchar *data = region->data;
+
+      /* Regions can point into a larger image */
+      if (region->stride != region->width * 4)
+        {
+          if (use_row_length)
+            {
+              glPixelStorei (GL_UNPACK_ROW_LENGTH, region->stride / 4);
+            }
+          else
+            {
+              gsize r;
 
-      gsk_gl_driver_bind_source_texture (gl_driver, self->texture_id);
-      glBindTexture (GL_TEXTURE_2D, self->texture_id);
+              copy = g_realloc (copy, region->width * 4 * region->height);
+              for (r = 0; r < region->height; r++)
+                memcpy (copy + r * region->width * 4,
+                        region->data + r * region->stride,
+                        region->width * 4);
+
+              data = copy;
+            }
+        }
 
       glTexSubImage2D (GL_TEXTURE_2D, 0, region->x, region->y, region->width, region->height,
-                       GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, region->data);
+                       GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, data);
+
+      if (use_row_length)
+        glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
     }
 
+  g_free (copy);
+
 #ifdef G_ENABLE_DEBUG
   /*gsk_gl_driver_bind_source_texture (gl_driver, self->texture_id);*/
   /*gsk_gl_image_dump (self, gl_driver, "/home/baedert/atlases/test_dump.png");*/
@@ -2,6 +2,7 @@
 #define __GSK_GL_IMAGE_H__
 
 #include "gskgldriverprivate.h"
+#include "gskglyphcacheprivate.h"
 #include <cairo/cairo.h>
 
 typedef struct
@@ -11,16 +12,6 @@ typedef struct
   int height;
 } GskGLImage;
 
-typedef struct
-{
-  guchar *data;
-  gsize width;
-  gsize height;
-  gsize stride;
-  gsize x;
-  gsize y;
-} GskImageRegion;
-
 void gsk_gl_image_create         (GskGLImage           *self,
                                   GskGLDriver          *gl_driver,
                                   int                   width,
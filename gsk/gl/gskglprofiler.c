@@ -3,9 +3,16 @@
 #include "gskglprofilerprivate.h"
 
 #include <epoxy/gl.h>
+#include <string.h>
 
 #define N_QUERIES       4
 
+typedef struct {
+  GArray *queries;      /* GLuint, grown as needed and reused */
+  GArray *buckets;      /* int, the bucket of the time after each timestamp */
+  guint n_timestamps;
+} TimestampFrame;
+
 struct _GskGLProfiler
 {
   GObject parent_instance;
@@ -18,6 +25,12 @@ struct _GskGLProfiler
   GLuint gl_queries[N_QUERIES];
   GLuint active_query;
 
+  /* Timestamps of the current and the previous frame; the results
+   * of a frame are read one frame later, so that we don't stall
+   */
+  TimestampFrame timestamps[2];
+  guint current_timestamps;
+
   gboolean has_timer : 1;
   gboolean first_frame : 1;
 };
@@ -36,9 +49,20 @@ static void
 gsk_gl_profiler_finalize (GObject *gobject)
 {
   GskGLProfiler *self = GSK_GL_PROFILER (gobject);
+  int i;
 
   glDeleteQueries (N_QUERIES, self->gl_queries);
 
+  for (i = 0; i < G_N_ELEMENTS (self->timestamps); i++)
+    {
+      TimestampFrame *frame = &self->timestamps[i];
+
+      if (frame->queries->len > 0)
+        glDeleteQueries (frame->queries->len, (GLuint *) frame->queries->data);
+      g_array_free (frame->queries, TRUE);
+      g_array_free (frame->buckets, TRUE);
+    }
+
   g_clear_object (&self->gl_context);
 
   G_OBJECT_CLASS (gsk_gl_profiler_parent_class)->finalize (gobject);
@@ -106,8 +130,16 @@ gsk_gl_profiler_class_init (GskGLProfilerClass *klass)
 static void
 gsk_gl_profiler_init (GskGLProfiler *self)
 {
+  int i;
+
   glGenQueries (N_QUERIES, self->gl_queries);
 
+  for (i = 0; i < G_N_ELEMENTS (self->timestamps); i++)
+    {
+      self->timestamps[i].queries = g_array_new (FALSE, FALSE, sizeof (GLuint));
+      self->timestamps[i].buckets = g_array_new (FALSE, FALSE, sizeof (int));
+    }
+
   self->first_frame = TRUE;
   self->has_timer = epoxy_has_gl_extension ("GL_ARB_timer_query");
 }
@@ -173,3 +205,98 @@ gsk_gl_profiler_end_gpu_region (GskGLProfiler *profiler)
 
   return elapsed;
 }
+
+/* Starts a new set of timestamps. Together with
+ * gsk_gl_profiler_add_timestamp() and gsk_gl_profiler_end_timestamps(),
+ * this splits the GPU time of a frame into buckets chosen by the caller,
+ * e.g. one for each program.
+ */
+void
+gsk_gl_profiler_begin_timestamps (GskGLProfiler *profiler)
+{
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+
+  profiler->current_timestamps = 1 - profiler->current_timestamps;
+  profiler->timestamps[profiler->current_timestamps].n_timestamps = 0;
+}
+
+/* Records the GPU time at this point of the command stream. The time
+ * until the next timestamp is accounted to @bucket; a @bucket of -1
+ * means the time is not accounted at all.
+ */
+void
+gsk_gl_profiler_add_timestamp (GskGLProfiler *profiler,
+                               int            bucket)
+{
+  TimestampFrame *frame;
+  GLuint query_id;
+
+  g_return_if_fail (GSK_IS_GL_PROFILER (profiler));
+
+  if (!profiler->has_timer)
+    return;
+
+  frame = &profiler->timestamps[profiler->current_timestamps];
+
+  if (frame->n_timestamps == frame->queries->len)
+    {
+      glGenQueries (1, &query_id);
+      g_array_append_val (frame->queries, query_id);
+      g_array_append_val (frame->buckets, bucket);
+    }
+  else
+    {
+      query_id = g_array_index (frame->queries, GLuint, frame->n_timestamps);
+      g_array_index (frame->buckets, int, frame->n_timestamps) = bucket;
+    }
+
+  glQueryCounter (query_id, GL_TIMESTAMP);
+  frame->n_timestamps++;
+}
+
+/* Ends the current set of timestamps and fills @bucket_times with the
+ * GPU time, in nanoseconds, spent in each of the @n_buckets buckets in
+ * the previous set. If the GPU is not done with it yet, its results are
+ * dropped and %FALSE is returned.
+ */
+gboolean
+gsk_gl_profiler_end_timestamps (GskGLProfiler *profiler,
+                                guint64       *bucket_times,
+                                int            n_buckets)
+{
+  TimestampFrame *frame;
+  GLuint64 last_time, time;
+  GLint res;
+  guint i;
+
+  g_return_val_if_fail (GSK_IS_GL_PROFILER (profiler), FALSE);
+
+  memset (bucket_times, 0, sizeof (guint64) * n_buckets);
+
+  if (!profiler->has_timer)
+    return FALSE;
+
+  gsk_gl_profiler_add_timestamp (profiler, -1);
+
+  frame = &profiler->timestamps[1 - profiler->current_timestamps];
+  if (frame->n_timestamps < 2)
+    return FALSE;
+
+  glGetQueryObjectiv (g_array_index (frame->queries, GLuint, frame->n_timestamps - 1),
+                      GL_QUERY_RESULT_AVAILABLE, &res);
+  if (res != 1)
+    return FALSE;
+
+  glGetQueryObjectui64v (g_array_index (frame->queries, GLuint, 0), GL_QUERY_RESULT, &last_time);
+  for (i = 1; i < frame->n_timestamps; i++)
+    {
+      int bucket = g_array_index (frame->buckets, int, i - 1);
+
+      glGetQueryObjectui64v (g_array_index (frame->queries, GLuint, i), GL_QUERY_RESULT, &time);
+      if (bucket >= 0 && bucket < n_buckets)
+        bucket_times[bucket] += time - last_time;
+      last_time = time;
+    }
+
+  return TRUE;
+}
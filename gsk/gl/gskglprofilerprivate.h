@@ -13,6 +13,13 @@ GskGLProfiler * gsk_gl_profiler_new                     (GdkGLContext  *context)
 void            gsk_gl_profiler_begin_gpu_region        (GskGLProfiler *profiler);
 guint64         gsk_gl_profiler_end_gpu_region          (GskGLProfiler *profiler);
 
+void            gsk_gl_profiler_begin_timestamps        (GskGLProfiler *profiler);
+void            gsk_gl_profiler_add_timestamp           (GskGLProfiler *profiler,
+                                                         int            bucket);
+gboolean        gsk_gl_profiler_end_timestamps          (GskGLProfiler *profiler,
+                                                         guint64       *bucket_times,
+                                                         int            n_buckets);
+
 G_END_DECLS
 
 #endif /* __GSK_GL_PROFILER_PRIVATE_H__ */
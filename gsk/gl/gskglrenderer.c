@@ -11,6 +11,8 @@
 #include "gskrendernodeprivate.h"
 #include "gskshaderbuilderprivate.h"
 #include "gskglglyphcacheprivate.h"
+#include "gskgliconcacheprivate.h"
+#include "gskglshadowcacheprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gskglrenderopsprivate.h"
 #include "gskcairoblurprivate.h"
@@ -19,6 +21,7 @@
 
 #include <epoxy/gl.h>
 #include <cairo-ft.h>
+#include <math.h>
 
 #define SHADER_VERSION_GLES             100
 #define SHADER_VERSION_GL2_LEGACY       110
@@ -93,6 +96,35 @@ get_gl_scaling_filters (GskRenderNode *node,
   *mag_filter_r = GL_LINEAR;
 }
 
+/* Textures are downscaled by at most 2^MAX_TEXTURE_LEVEL */
+#define MAX_TEXTURE_LEVEL 6
+
+/* Returns how many times @texture can be halved in size and still have
+ * at least as many pixels as it covers on screen when drawn at @bounds. */
+static int
+get_texture_level (RenderOpBuilder       *builder,
+                   GdkTexture            *texture,
+                   const graphene_rect_t *bounds)
+{
+  graphene_rect_t device_bounds;
+  float scale;
+  int level;
+
+  graphene_matrix_transform_bounds (&builder->current_modelview, bounds, &device_bounds);
+
+  scale = MAX (device_bounds.size.width / gdk_texture_get_width (texture),
+               device_bounds.size.height / gdk_texture_get_height (texture));
+
+  level = 0;
+  while (level < MAX_TEXTURE_LEVEL && scale * 2 <= 1)
+    {
+      scale *= 2;
+      level++;
+    }
+
+  return level;
+}
+
 static inline void
 rgba_to_float (const GdkRGBA *c,
                float         *f)
@@ -213,25 +245,49 @@ struct _GskGLRenderer
       Program shadow_program;
       Program border_program;
       Program cross_fade_program;
+      Program radial_gradient_program;
     };
   };
 
   GArray *render_ops;
 
+  /* The vertex data of all frames is streamed through this buffer */
+  guint vao_id;
+  guint vertex_buffer_id;
+  gsize vertex_buffer_size;
+
+  /* kept around to compile the programs that are not used right away */
+  GskShaderBuilder *shader_builder;
+  guint warmup_id;
+
   GskGLGlyphCache glyph_cache;
+  GskGLIconCache icon_cache;
+  GskGLShadowCache shadow_cache;
 
 #ifdef G_ENABLE_DEBUG
   struct {
     GQuark frames;
     GQuark draw_calls;
+    GQuark program_changes;
+    GQuark offscreens;
+    GQuark fallback_nodes;
+    GQuark fallback_pixels;
   } profile_counters;
   struct {
     GQuark cpu_time;
     GQuark gpu_time;
+    /* Only with GSK_DEBUG=gpu-times */
+    GQuark program_gpu_times[GL_N_PROGRAMS];
+    GQuark offscreen_gpu_time;
   } profile_timers;
+  gboolean gpu_times;
 #endif
 
   RenderMode render_mode;
+  cairo_region_t *buffer_damage;
+  cairo_region_t *render_region;
+  /* where placeholders for textures that are still uploading were drawn */
+  cairo_region_t *pending_region;
 
   gboolean has_buffers : 1;
 };
@@ -243,26 +299,115 @@ struct _GskGLRendererClass
 
 G_DEFINE_TYPE (GskGLRenderer, gsk_gl_renderer, GSK_TYPE_RENDERER)
 
-static inline void
-rounded_rect_intersect (GskGLRenderer        *self,
+static void
+transform_rounded_rect (GskGLRenderer        *self,
                         RenderOpBuilder      *builder,
                         const GskRoundedRect *rect,
-                        GskRoundedRect       *dest)
+                        GskRoundedRect       *result)
 {
-  graphene_rect_t transformed_rect;
-  graphene_rect_t intersection;
   int i;
 
-  graphene_matrix_transform_bounds (&builder->current_modelview, &rect->bounds, &transformed_rect);
-  graphene_rect_intersection (&transformed_rect, &builder->current_clip.bounds,
-                              &intersection);
-
-  dest->bounds = intersection;
+  graphene_matrix_transform_bounds (&builder->current_modelview, &rect->bounds, &result->bounds);
   for (i = 0; i < 4; i ++)
     {
-      dest->corner[i].width = rect->corner[i].width * self->scale_factor;
-      dest->corner[i].height = rect->corner[i].height * self->scale_factor;
+      result->corner[i].width = rect->corner[i].width * self->scale_factor;
+      result->corner[i].height = rect->corner[i].height * self->scale_factor;
+    }
+}
+
+/* Intersects the current clip with @rect, in the coordinates of the
+ * current node. The result is exact if it is a rounded rectangle, or
+ * if the extra clip is still free to hold @rect. Only after that, the
+ * rounded corners of one of the clips get lost.
+ */
+static void
+push_clip (GskGLRenderer        *self,
+           RenderOpBuilder      *builder,
+           const GskRoundedRect *rect,
+           GskRoundedRect       *prev_clip,
+           GskRoundedRect       *prev_extra_clip)
+{
+  GskRoundedRect transformed, intersection;
+
+  transform_rounded_rect (self, builder, rect, &transformed);
+
+  *prev_extra_clip = builder->current_extra_clip;
+
+  if (gsk_rounded_rect_intersection (&builder->current_clip, &transformed, &intersection))
+    {
+      *prev_clip = ops_set_clip (builder, &intersection);
+      return;
+    }
+
+  if (builder->current_extra_clip.bounds.size.width <= 0)
+    {
+      /* The shader multiplies the coverage of both clips */
+      *prev_clip = builder->current_clip;
+      ops_set_extra_clip (builder, &transformed);
+      return;
+    }
+
+  if (gsk_rounded_rect_intersection (&builder->current_extra_clip, &transformed, &intersection))
+    {
+      *prev_clip = builder->current_clip;
+      ops_set_extra_clip (builder, &intersection);
+      return;
+    }
+
+  /* Out of clips. Keep the corners of the new clip, like we used to do
+   * before there was an extra clip. */
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), FALLBACK,
+                     g_message ("Approximating nested rounded clips"));
+  graphene_rect_intersection (&transformed.bounds, &builder->current_clip.bounds, &transformed.bounds);
+  *prev_clip = ops_set_clip (builder, &transformed);
+}
+
+/* The border program uses the clip as the outline of the border, so
+ * that has to be exact. The current clip is moved to the extra clip
+ * instead, as long as there is room for it.
+ */
+static void
+push_border_clip (GskGLRenderer        *self,
+                  RenderOpBuilder      *builder,
+                  const GskRoundedRect *outline,
+                  GskRoundedRect       *prev_clip,
+                  GskRoundedRect       *prev_extra_clip)
+{
+  GskRoundedRect transformed, intersection;
+
+  transform_rounded_rect (self, builder, outline, &transformed);
+
+  *prev_extra_clip = builder->current_extra_clip;
+
+  if (gsk_rounded_rect_contains_rect (&builder->current_clip, &transformed.bounds))
+    {
+      /* Nothing to move */
+    }
+  else if (builder->current_extra_clip.bounds.size.width <= 0)
+    {
+      ops_set_extra_clip (builder, &builder->current_clip);
+    }
+  else if (gsk_rounded_rect_intersection (&builder->current_extra_clip,
+                                          &builder->current_clip,
+                                          &intersection))
+    {
+      ops_set_extra_clip (builder, &intersection);
+    }
+  else
+    {
+      graphene_rect_intersection (&transformed.bounds, &builder->current_clip.bounds, &transformed.bounds);
     }
+
+  *prev_clip = ops_set_clip (builder, &transformed);
+}
+
+static void
+pop_clip (RenderOpBuilder      *builder,
+          const GskRoundedRect *prev_clip,
+          const GskRoundedRect *prev_extra_clip)
+{
+  ops_set_clip (builder, prev_clip);
+  ops_set_extra_clip (builder, prev_extra_clip);
 }
 
 static inline void
@@ -303,6 +448,16 @@ render_fallback_node (GskGLRenderer       *self,
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
                                         ceilf (node->bounds.size.width) * self->scale_factor,
                                         ceilf (node->bounds.size.height) * self->scale_factor);
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
+
+    gsk_profiler_counter_inc (profiler, self->profile_counters.fallback_nodes);
+    gsk_profiler_counter_add (profiler, self->profile_counters.fallback_pixels,
+                              cairo_image_surface_get_width (surface) *
+                              cairo_image_surface_get_height (surface));
+  }
+#endif
   cairo_surface_set_device_scale (surface, self->scale_factor, self->scale_factor);
   cr = cairo_create (surface);
 
@@ -349,8 +504,8 @@ render_text_node (GskGLRenderer   *self,
   guint num_glyphs = gsk_text_node_get_num_glyphs (node);
   int i;
   int x_position = 0;
-  int x = gsk_text_node_get_x (node) + builder->dx;
-  int y = gsk_text_node_get_y (node) + builder->dy;
+  float x = gsk_text_node_get_x (node) + builder->dx;
+  float y = gsk_text_node_get_y (node) + builder->dy;
 
   /* If the font has color glyphs, we don't need to recolor anything */
   if (!force_color && font_has_color_glyphs (font))
@@ -368,27 +523,38 @@ render_text_node (GskGLRenderer   *self,
   for (i = 0; i < num_glyphs; i++)
     {
       const PangoGlyphInfo *gi = &glyphs[i];
-      const GskGLCachedGlyph *glyph;
-      int glyph_x, glyph_y, glyph_w, glyph_h;
+      const GskCachedGlyph *glyph;
+      float glyph_x, glyph_y, glyph_w, glyph_h;
       float tx, ty, tx2, ty2;
       double cx;
       double cy;
+      guint phase;
 
       if (gi->glyph == PANGO_GLYPH_EMPTY)
         continue;
 
+      cx = (double)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
+      cy = (double)(gi->geometry.y_offset) / PANGO_SCALE;
+
+      /* Glyphs are positioned on device pixels horizontally, using a
+       * variant that is rendered with the remaining subpixel offset */
+      cx = gsk_glyph_cache_snap_x (x + cx, self->scale_factor, &phase) - x;
+      cy = roundf ((y + cy) * self->scale_factor) / self->scale_factor - y;
+
       glyph = gsk_gl_glyph_cache_lookup (&self->glyph_cache,
                                          TRUE,
                                          (PangoFont *)font,
                                          gi->glyph,
+                                         phase,
                                          self->scale_factor);
 
       /* e.g. whitespace */
       if (glyph->draw_width <= 0 || glyph->draw_height <= 0)
         goto next;
 
-      cx = (double)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
-      cy = (double)(gi->geometry.y_offset) / PANGO_SCALE;
+      /* too big for the glyph cache */
+      if (glyph->atlas == NULL)
+        goto next;
 
       ops_set_texture (builder, gsk_gl_glyph_cache_get_glyph_image (&self->glyph_cache,
                                                                    glyph)->texture_id);
@@ -433,7 +599,7 @@ render_border_node (GskGLRenderer   *self,
   float widths[4];
   const gboolean needs_clip = TRUE;/*!gsk_rounded_rect_is_rectilinear (rounded_outline);*/
   int i;
-  GskRoundedRect prev_clip;
+  GskRoundedRect prev_clip, prev_extra_clip;
   struct {
     float w;
     float h;
@@ -493,12 +659,9 @@ render_border_node (GskGLRenderer   *self,
 
   if (needs_clip)
     {
-      GskRoundedRect child_clip;
-
       ops_set_program (builder, &self->border_program);
 
-      rounded_rect_intersect (self, builder, rounded_outline, &child_clip);
-      prev_clip = ops_set_clip (builder, &child_clip);
+      push_border_clip (self, builder, rounded_outline, &prev_clip, &prev_extra_clip);
 
       ops_set_border (builder, widths);
     }
@@ -567,7 +730,7 @@ render_border_node (GskGLRenderer   *self,
   }
 
   if (needs_clip)
-    ops_set_clip (builder, &prev_clip);
+    pop_clip (builder, &prev_clip, &prev_extra_clip);
 }
 
 static inline void
@@ -596,10 +759,70 @@ render_texture_node (GskGLRenderer       *self,
 
   get_gl_scaling_filters (node, &gl_min_filter, &gl_mag_filter);
 
+  /* Small textures are drawn from an atlas, so they can be batched */
+  if (!GDK_IS_GL_TEXTURE (texture))
+    {
+      const GskGLCachedIcon *icon = gsk_gl_icon_cache_lookup_or_add (&self->icon_cache, texture);
+
+      if (icon != NULL)
+        {
+          const graphene_rect_t *r = &icon->texture_rect;
+
+          ops_set_program (builder, &self->blit_program);
+          ops_set_texture (builder, icon->texture_id);
+          ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+            { { min_x, min_y }, { r->origin.x,                 r->origin.y                  }, },
+            { { min_x, max_y }, { r->origin.x,                 r->origin.y + r->size.height }, },
+            { { max_x, min_y }, { r->origin.x + r->size.width, r->origin.y                  }, },
+
+            { { max_x, max_y }, { r->origin.x + r->size.width, r->origin.y + r->size.height }, },
+            { { min_x, max_y }, { r->origin.x,                 r->origin.y + r->size.height }, },
+            { { max_x, min_y }, { r->origin.x + r->size.width, r->origin.y                  }, },
+          });
+          return;
+        }
+    }
+
   texture_id = gsk_gl_driver_get_texture_for_texture (self->gl_driver,
                                                       texture,
+                                                      get_texture_level (builder, texture, &node->bounds),
                                                       gl_min_filter,
                                                       gl_mag_filter);
+
+  /* Don't wait for large uploads when drawing to the window, the
+   * texture gets drawn in the next frame once it is ready */
+  if (self->texture_id == 0 && builder->current_render_target == 0 &&
+      !gsk_gl_driver_is_texture_ready (self->gl_driver, texture_id))
+    {
+      const GdkRGBA placeholder = { 0.5, 0.5, 0.5, 0.2 };
+      graphene_rect_t bounds;
+      cairo_rectangle_int_t rect;
+
+      graphene_rect_init (&bounds, min_x, min_y, max_x - min_x, max_y - min_y);
+      graphene_matrix_transform_bounds (&builder->current_modelview, &bounds, &bounds);
+      rect.x = floorf (bounds.origin.x / self->scale_factor);
+      rect.y = floorf (bounds.origin.y / self->scale_factor);
+      rect.width = ceilf ((bounds.origin.x + bounds.size.width) / self->scale_factor) - rect.x;
+      rect.height = ceilf ((bounds.origin.y + bounds.size.height) / self->scale_factor) - rect.y;
+
+      if (self->pending_region == NULL)
+        self->pending_region = cairo_region_create ();
+      cairo_region_union_rectangle (self->pending_region, &rect);
+
+      ops_set_program (builder, &self->color_program);
+      ops_set_color (builder, &placeholder);
+      ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+        { { min_x, min_y }, { 0, 0 }, },
+        { { min_x, max_y }, { 0, 1 }, },
+        { { max_x, min_y }, { 1, 0 }, },
+
+        { { max_x, max_y }, { 1, 1 }, },
+        { { min_x, max_y }, { 0, 1 }, },
+        { { max_x, min_y }, { 1, 0 }, },
+      });
+      return;
+    }
+
   ops_set_program (builder, &self->blit_program);
   ops_set_texture (builder, texture_id);
 
@@ -639,23 +862,42 @@ render_cairo_node (GskGLRenderer       *self,
   int gl_min_filter = GL_NEAREST, gl_mag_filter = GL_NEAREST;
   int texture_id;
   double scale_x, scale_y;
+  GskTextureKey key;
 
   if (surface == NULL)
     return;
 
   get_gl_scaling_filters (node, &gl_min_filter, &gl_mag_filter);
 
-
   cairo_surface_get_device_scale ((cairo_surface_t *)surface, &scale_x, &scale_y);
-  texture_id = gsk_gl_driver_create_texture (self->gl_driver,
-                                             node->bounds.size.width * scale_x,
-                                             node->bounds.size.height * scale_y);
-  gsk_gl_driver_bind_source_texture (self->gl_driver, texture_id);
-  gsk_gl_driver_init_texture_with_surface (self->gl_driver,
-                                           texture_id,
-                                           (cairo_surface_t *)surface,
-                                           gl_min_filter,
-                                           gl_mag_filter);
+
+  /* Cairo nodes don't change the pixels of their surface once they have
+   * been drawn, so the upload can be reused for as long as the surface
+   * is around, like for the same nodes in the cached snapshots of widgets. */
+  key.pointer = (gpointer) surface;
+  key.scale = scale_x;
+  key.opacity = 1.0;
+  key.offset = GRAPHENE_POINT_INIT (0, 0);
+  key.bounds = node->bounds;
+
+  texture_id = gsk_gl_driver_get_texture_for_key (self->gl_driver, &key);
+  if (texture_id == 0)
+    {
+      texture_id = gsk_gl_driver_create_texture (self->gl_driver,
+                                                 node->bounds.size.width * scale_x,
+                                                 node->bounds.size.height * scale_y);
+      gsk_gl_driver_bind_source_texture (self->gl_driver, texture_id);
+      gsk_gl_driver_init_texture_with_surface (self->gl_driver,
+                                               texture_id,
+                                               (cairo_surface_t *)surface,
+                                               gl_min_filter,
+                                               gl_mag_filter);
+
+      cairo_surface_reference ((cairo_surface_t *)surface);
+      gsk_gl_driver_set_texture_for_key (self->gl_driver, &key, texture_id,
+                                         (GDestroyNotify) cairo_surface_destroy);
+    }
+
   ops_set_program (builder, &self->blit_program);
   ops_set_texture (builder, texture_id);
   ops_draw (builder, vertex_data);
@@ -728,29 +970,57 @@ render_linear_gradient_node (GskGLRenderer       *self,
   ops_draw (builder, vertex_data);
 }
 
+static inline void
+render_radial_gradient_node (GskGLRenderer       *self,
+                             GskRenderNode       *node,
+                             RenderOpBuilder     *builder,
+                             const GskQuadVertex *vertex_data)
+{
+  RenderOp op;
+  int n_color_stops = MIN (8, gsk_radial_gradient_node_get_n_color_stops (node));
+  const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+  const graphene_point_t *center = gsk_radial_gradient_node_peek_center (node);
+  int i;
+
+  for (i = 0; i < n_color_stops; i ++)
+    {
+      const GskColorStop *stop = stops + i;
+
+      op.radial_gradient.color_stops[(i * 4) + 0] = stop->color.red;
+      op.radial_gradient.color_stops[(i * 4) + 1] = stop->color.green;
+      op.radial_gradient.color_stops[(i * 4) + 2] = stop->color.blue;
+      op.radial_gradient.color_stops[(i * 4) + 3] = stop->color.alpha;
+      op.radial_gradient.color_offsets[i] = stop->offset;
+    }
+
+  ops_set_program (builder, &self->radial_gradient_program);
+  op.op = OP_CHANGE_RADIAL_GRADIENT;
+  op.radial_gradient.n_color_stops = n_color_stops;
+  op.radial_gradient.center = *center;
+  op.radial_gradient.radius[0] = gsk_radial_gradient_node_get_hradius (node);
+  op.radial_gradient.radius[1] = gsk_radial_gradient_node_get_vradius (node);
+  op.radial_gradient.start = gsk_radial_gradient_node_get_start (node);
+  op.radial_gradient.end = gsk_radial_gradient_node_get_end (node);
+  op.radial_gradient.repeat = gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE;
+  ops_add (builder, &op);
+
+  ops_draw (builder, vertex_data);
+}
+
 static inline void
 render_clip_node (GskGLRenderer   *self,
                   GskRenderNode   *node,
                   RenderOpBuilder *builder)
 {
-  GskRoundedRect prev_clip;
+  GskRoundedRect prev_clip, prev_extra_clip;
   GskRenderNode *child = gsk_clip_node_get_child (node);
-  graphene_rect_t transformed_clip;
-  graphene_rect_t intersection;
-  GskRoundedRect child_clip;
-
-  transformed_clip = *gsk_clip_node_peek_clip (node);
-  graphene_matrix_transform_bounds (&builder->current_modelview, &transformed_clip, &transformed_clip);
+  GskRoundedRect clip;
 
-  graphene_rect_intersection (&transformed_clip,
-                              &builder->current_clip.bounds,
-                              &intersection);
+  gsk_rounded_rect_init_from_rect (&clip, gsk_clip_node_peek_clip (node), 0.0f);
 
-  gsk_rounded_rect_init_from_rect (&child_clip, &intersection, 0.0f);
-
-  prev_clip = ops_set_clip (builder, &child_clip);
+  push_clip (self, builder, &clip, &prev_clip, &prev_extra_clip);
   gsk_gl_renderer_add_render_ops (self, child, builder);
-  ops_set_clip (builder, &prev_clip);
+  pop_clip (builder, &prev_clip, &prev_extra_clip);
 }
 
 static inline void
@@ -758,16 +1028,85 @@ render_rounded_clip_node (GskGLRenderer   *self,
                           GskRenderNode   *node,
                           RenderOpBuilder *builder)
 {
-  GskRoundedRect prev_clip;
+  GskRoundedRect prev_clip, prev_extra_clip;
   GskRenderNode *child = gsk_rounded_clip_node_get_child (node);
   const GskRoundedRect *rounded_clip = gsk_rounded_clip_node_peek_clip (node);
-  GskRoundedRect child_clip;
-
-  rounded_rect_intersect (self, builder, rounded_clip, &child_clip);
 
-  prev_clip = ops_set_clip (builder, &child_clip);
+  push_clip (self, builder, rounded_clip, &prev_clip, &prev_extra_clip);
   gsk_gl_renderer_add_render_ops (self, child, builder);
-  ops_set_clip (builder, &prev_clip);
+  pop_clip (builder, &prev_clip, &prev_extra_clip);
+}
+
+/* Whether applying @matrix and @offset to a color can be folded into the
+ * color matrix that is applied after it, without changing the result.
+ * That is the case if no clamping is needed in between, and if the
+ * result is transparent black exactly when the color is, since colors
+ * are stored premultiplied in between.
+ */
+static gboolean
+color_matrix_can_be_folded (const graphene_matrix_t *matrix,
+                            const graphene_vec4_t   *offset)
+{
+  graphene_vec4_t zero;
+  int i, j;
+
+  graphene_vec4_init (&zero, 0, 0, 0, 0);
+  if (!graphene_vec4_equal (offset, &zero))
+    return FALSE;
+
+  /* The alpha may only depend on the alpha, and must not vanish */
+  for (i = 0; i < 3; i++)
+    {
+      if (graphene_matrix_get_value (matrix, i, 3) != 0)
+        return FALSE;
+    }
+  if (graphene_matrix_get_value (matrix, 3, 3) <= 0)
+    return FALSE;
+
+  for (j = 0; j < 4; j++)
+    {
+      float min = 0, max = 0;
+
+      for (i = 0; i < 4; i++)
+        {
+          float value = graphene_matrix_get_value (matrix, i, j);
+
+          if (value > 0)
+            max += value;
+          else
+            min += value;
+        }
+
+      if (min < 0 || max > 1)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+transform_color (const graphene_matrix_t *matrix,
+                 const graphene_vec4_t   *offset,
+                 const GdkRGBA           *color,
+                 GdkRGBA                 *result)
+{
+  graphene_vec4_t v;
+
+  /* Like the shader, this works on unpremultiplied colors */
+  if (color->alpha > 0)
+    {
+      graphene_vec4_init (&v, color->red, color->green, color->blue, color->alpha);
+      graphene_matrix_transform_vec4 (matrix, &v, &v);
+    }
+  else
+    graphene_vec4_init (&v, 0, 0, 0, 0);
+
+  graphene_vec4_add (&v, offset, &v);
+
+  result->red = CLAMP (graphene_vec4_get_x (&v), 0, 1);
+  result->green = CLAMP (graphene_vec4_get_y (&v), 0, 1);
+  result->blue = CLAMP (graphene_vec4_get_z (&v), 0, 1);
+  result->alpha = CLAMP (graphene_vec4_get_w (&v), 0, 1);
 }
 
 static inline void
@@ -780,17 +1119,85 @@ render_color_matrix_node (GskGLRenderer       *self,
   const float min_y = node->bounds.origin.y;
   const float max_x = min_x + node->bounds.size.width;
   const float max_y = min_y + node->bounds.size.height;
+  GskRenderNode *child = gsk_color_matrix_node_get_child (node);
+  graphene_matrix_t matrix = *gsk_color_matrix_node_peek_color_matrix (node);
+  graphene_vec4_t offset = *gsk_color_matrix_node_peek_color_offset (node);
   int texture_id;
   gboolean is_offscreen;
 
+  /* Fold nested color matrix and opacity nodes into this one, so that
+   * they don't need an offscreen each. Their bounds all match, since
+   * both kinds of nodes take the bounds of their child.
+   */
+  for (;;)
+    {
+      graphene_matrix_t inner, folded;
+
+      if (gsk_render_node_get_node_type (child) == GSK_COLOR_MATRIX_NODE)
+        {
+          if (!color_matrix_can_be_folded (gsk_color_matrix_node_peek_color_matrix (child),
+                                           gsk_color_matrix_node_peek_color_offset (child)))
+            break;
+
+          inner = *gsk_color_matrix_node_peek_color_matrix (child);
+          child = gsk_color_matrix_node_get_child (child);
+        }
+      else if (gsk_render_node_get_node_type (child) == GSK_OPACITY_NODE &&
+               gsk_opacity_node_get_opacity (child) > 0)
+        {
+          const float opacity[16] = {
+            1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, 1, 0,
+            0, 0, 0, gsk_opacity_node_get_opacity (child)
+          };
+
+          graphene_matrix_init_from_float (&inner, opacity);
+          child = gsk_opacity_node_get_child (child);
+        }
+      else
+        break;
+
+      /* The inner matrix is applied first, and has no offset */
+      graphene_matrix_multiply (&inner, &matrix, &folded);
+      matrix = folded;
+    }
+
+  /* For single-colored children, we can apply the matrix to the color */
+  if (gsk_render_node_get_node_type (child) == GSK_COLOR_NODE)
+    {
+      GdkRGBA color;
+
+      transform_color (&matrix, &offset, gsk_color_node_peek_color (child), &color);
+
+      ops_set_program (builder, &self->color_program);
+      ops_set_color (builder, &color);
+      ops_draw (builder, vertex_data);
+      return;
+    }
+  else if (gsk_render_node_get_node_type (child) == GSK_TEXT_NODE &&
+           !font_has_color_glyphs (gsk_text_node_peek_font (child)) &&
+           color_matrix_can_be_folded (&matrix, &offset) &&
+           graphene_matrix_get_value (&matrix, 3, 0) == 0 &&
+           graphene_matrix_get_value (&matrix, 3, 1) == 0 &&
+           graphene_matrix_get_value (&matrix, 3, 2) == 0)
+    {
+      GdkRGBA color;
+
+      /* The colors of the glyphs don't depend on their coverage here,
+       * and transparent pixels around them stay transparent.
+       */
+      transform_color (&matrix, &offset, gsk_text_node_peek_color (child), &color);
+      render_text_node (self, child, builder, &color, TRUE);
+      return;
+    }
+
   add_offscreen_ops (self, builder, min_x, max_x, min_y, max_y,
-                     gsk_color_matrix_node_get_child (node),
+                     child,
                      &texture_id, &is_offscreen, FALSE);
 
   ops_set_program (builder, &self->color_matrix_program);
-  ops_set_color_matrix (builder,
-                        gsk_color_matrix_node_peek_color_matrix (node),
-                        gsk_color_matrix_node_peek_color_offset (node));
+  ops_set_color_matrix (builder, &matrix, &offset);
 
   ops_set_texture (builder, texture_id);
 
@@ -933,6 +1340,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
   const float spread = gsk_outset_shadow_node_get_spread (node);
   const float dx = gsk_outset_shadow_node_get_dx (node);
   const float dy = gsk_outset_shadow_node_get_dy (node);
+  const GdkRGBA *color = gsk_outset_shadow_node_peek_color (node);
   const float min_x = outline->bounds.origin.x - spread - blur_extra / 2.0;
   const float min_y = outline->bounds.origin.y - spread - blur_extra / 2.0;
   const float max_x = min_x + outline->bounds.size.width  + (spread + blur_extra/2.0) * 2;
@@ -944,10 +1352,11 @@ render_outset_shadow_node (GskGLRenderer       *self,
   graphene_matrix_t prev_modelview;
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
-  GskRoundedRect prev_clip, blit_clip;
+  GskRoundedRect prev_clip, prev_extra_clip, blit_clip;
   int prev_render_target;
   int texture_id, render_target;
   int blurred_texture_id, blurred_render_target;
+  int cached_texture_id;
 
   /* offset_outline is the minimal outline we need to draw the given drop shadow,
    * enlarged by the spread and offset by the blur radius. */
@@ -969,6 +1378,18 @@ render_outset_shadow_node (GskGLRenderer       *self,
   texture_width = offset_outline.bounds.size.width   + blur_extra;
   texture_height = offset_outline.bounds.size.height + blur_extra;
 
+  /* The texture only depends on offset_outline, so shadows of all sizes and
+   * positions with the same corners, spread, blur and color can share it. */
+  cached_texture_id = gsk_gl_shadow_cache_get_texture_id (&self->shadow_cache,
+                                                          &offset_outline,
+                                                          blur_radius,
+                                                          color);
+  if (cached_texture_id != 0)
+    {
+      blurred_texture_id = cached_texture_id;
+      goto draw;
+    }
+
   texture_id = gsk_gl_driver_create_texture (self->gl_driver, texture_width, texture_height);
   gsk_gl_driver_bind_source_texture (self->gl_driver, texture_id);
   gsk_gl_driver_init_texture_empty (self->gl_driver, texture_id);
@@ -991,7 +1412,8 @@ render_outset_shadow_node (GskGLRenderer       *self,
   /* Draw outline */
   ops_set_program (builder, &self->color_program);
   prev_clip = ops_set_clip (builder, &offset_outline);
-  ops_set_color (builder, gsk_outset_shadow_node_peek_color (node));
+  prev_extra_clip = ops_set_extra_clip (builder, &GSK_ROUNDED_RECT_INIT (0, 0, 0, 0));
+  ops_set_color (builder, color);
   ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
     { { 0,                            }, { 0, 1 }, },
     { { 0,             texture_height }, { 0, 0 }, },
@@ -1002,7 +1424,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
     { { texture_width,                }, { 1, 1 }, },
   });
 
-  blurred_texture_id = gsk_gl_driver_create_texture (self->gl_driver, texture_width, texture_height);
+  blurred_texture_id = gsk_gl_driver_create_permanent_texture (self->gl_driver, texture_width, texture_height);
   gsk_gl_driver_bind_source_texture (self->gl_driver, blurred_texture_id);
   gsk_gl_driver_init_texture_empty (self->gl_driver, blurred_texture_id);
   blurred_render_target = gsk_gl_driver_create_render_target (self->gl_driver, blurred_texture_id, TRUE, TRUE);
@@ -1034,6 +1456,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
   });
 
 
+  ops_set_extra_clip (builder, &prev_extra_clip);
   ops_set_clip (builder, &prev_clip);
 
   ops_set_viewport (builder, &prev_viewport);
@@ -1041,6 +1464,13 @@ render_outset_shadow_node (GskGLRenderer       *self,
   ops_set_projection (builder, &prev_projection);
   ops_set_render_target (builder, prev_render_target);
 
+  gsk_gl_shadow_cache_commit (&self->shadow_cache,
+                              &offset_outline,
+                              blur_radius,
+                              color,
+                              blurred_texture_id);
+
+draw:
   ops_set_program (builder, &self->outset_shadow_program);
   ops_set_texture (builder, blurred_texture_id);
   op.op = OP_CHANGE_OUTSET_SHADOW;
@@ -1110,7 +1540,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
       }
 
     /* Bottom right */
-    if (bottom_height > 0 && left_width > 0)
+    if (bottom_height > 0 && right_width > 0)
       {
         x1 = max_x + dx - right_width;
         x2 = max_x + dx;
@@ -1264,8 +1694,6 @@ render_outset_shadow_node (GskGLRenderer       *self,
       }
 
   }
-
-  ops_set_clip (builder, &prev_clip);
 }
 
 static inline void
@@ -1553,6 +1981,29 @@ apply_clip_op (const Program  *program,
                op->clip.corner[3].height);
 }
 
+static inline void
+apply_extra_clip_op (const Program  *program,
+                     const RenderOp *op)
+{
+  OP_PRINT (" -> Extra clip (%f, %f, %f, %f)",
+            op->clip.bounds.origin.x, op->clip.bounds.origin.y,
+            op->clip.bounds.size.width, op->clip.bounds.size.height);
+  glUniform4f (program->extra_clip_location,
+               op->clip.bounds.origin.x, op->clip.bounds.origin.y,
+               op->clip.bounds.size.width, op->clip.bounds.size.height);
+
+  glUniform4f (program->extra_clip_corner_widths_location,
+               op->clip.corner[0].width,
+               op->clip.corner[1].width,
+               op->clip.corner[2].width,
+               op->clip.corner[3].width);
+  glUniform4f (program->extra_clip_corner_heights_location,
+               op->clip.corner[0].height,
+               op->clip.corner[1].height,
+               op->clip.corner[2].height,
+               op->clip.corner[3].height);
+}
+
 static inline void
 apply_inset_shadow_op (const Program  *program,
                        const RenderOp *op)
@@ -1629,6 +2080,27 @@ apply_linear_gradient_op (const Program  *program,
                op->linear_gradient.end_point.x, op->linear_gradient.end_point.y);
 }
 
+static inline void
+apply_radial_gradient_op (const Program  *program,
+                          const RenderOp *op)
+{
+  OP_PRINT (" -> Radial gradient");
+  glUniform1i (program->radial_gradient.num_color_stops_location,
+               op->radial_gradient.n_color_stops);
+  glUniform4fv (program->radial_gradient.color_stops_location,
+                op->radial_gradient.n_color_stops,
+                op->radial_gradient.color_stops);
+  glUniform1fv (program->radial_gradient.color_offsets_location,
+                op->radial_gradient.n_color_stops,
+                op->radial_gradient.color_offsets);
+  glUniform2f (program->radial_gradient.center_location,
+               op->radial_gradient.center.x, op->radial_gradient.center.y);
+  glUniform2fv (program->radial_gradient.radius_location, 1, op->radial_gradient.radius);
+  glUniform1f (program->radial_gradient.start_location, op->radial_gradient.start);
+  glUniform1f (program->radial_gradient.end_location, op->radial_gradient.end);
+  glUniform1i (program->radial_gradient.repeat_location, op->radial_gradient.repeat);
+}
+
 static inline void
 apply_border_op (const Program  *program,
                  const RenderOp *op)
@@ -1727,32 +2199,199 @@ gsk_gl_renderer_destroy_buffers (GskGLRenderer *self)
   self->has_buffers = FALSE;
 }
 
+/* Only the programs that almost every frame needs are compiled when the
+ * renderer is realized, the others when the first op uses them.
+ */
+static const struct {
+  const char *name;
+  const char *vs;
+  const char *fs;
+  gboolean lazy;
+} program_definitions[] = {
+  { "blend",           "blend.vs.glsl", "blend.fs.glsl",           TRUE },
+  { "blit",            "blit.vs.glsl",  "blit.fs.glsl",            FALSE },
+  { "color",           "blit.vs.glsl",  "color.fs.glsl",           FALSE },
+  { "coloring",        "blit.vs.glsl",  "coloring.fs.glsl",        FALSE },
+  { "color matrix",    "blit.vs.glsl",  "color_matrix.fs.glsl",    TRUE },
+  { "linear gradient", "blit.vs.glsl",  "linear_gradient.fs.glsl", TRUE },
+  { "blur",            "blit.vs.glsl",  "blur.fs.glsl",            TRUE },
+  { "inset shadow",    "blit.vs.glsl",  "inset_shadow.fs.glsl",    TRUE },
+  { "outset shadow",   "blit.vs.glsl",  "outset_shadow.fs.glsl",   TRUE },
+  { "unblurred outset shadow",   "blit.vs.glsl",  "unblurred_outset_shadow.fs.glsl", TRUE },
+  { "shadow",          "blit.vs.glsl",  "shadow.fs.glsl",          TRUE },
+  { "border",          "blit.vs.glsl",  "border.fs.glsl",          TRUE },
+  { "cross fade",      "blit.vs.glsl",  "cross_fade.fs.glsl",      TRUE },
+  { "radial gradient", "blit.vs.glsl",  "radial_gradient.fs.glsl", TRUE },
+};
+
+static gboolean
+gsk_gl_renderer_compile_program (GskGLRenderer  *self,
+                                 Program        *prog,
+                                 GError        **error)
+{
+  GError *shader_error = NULL;
+  int i = prog->index;
+
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), SHADERS,
+                     g_message ("Compiling '%s' program", program_definitions[i].name));
+
+  prog->id = gsk_shader_builder_create_program (self->shader_builder,
+                                                program_definitions[i].vs,
+                                                program_definitions[i].fs,
+                                                &shader_error);
+
+  if (shader_error != NULL)
+    {
+      g_propagate_prefixed_error (error, shader_error,
+                                  "Unable to create '%s' program (from %s and %s):\n",
+                                  program_definitions[i].name,
+                                  program_definitions[i].vs,
+                                  program_definitions[i].fs);
+      prog->id = -1;
+      return FALSE;
+    }
+
+  INIT_COMMON_UNIFORM_LOCATION (prog, alpha);
+  INIT_COMMON_UNIFORM_LOCATION (prog, source);
+  INIT_COMMON_UNIFORM_LOCATION (prog, mask);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_widths);
+  INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_heights);
+  INIT_COMMON_UNIFORM_LOCATION (prog, extra_clip);
+  INIT_COMMON_UNIFORM_LOCATION (prog, extra_clip_corner_widths);
+  INIT_COMMON_UNIFORM_LOCATION (prog, extra_clip_corner_heights);
+  INIT_COMMON_UNIFORM_LOCATION (prog, viewport);
+  INIT_COMMON_UNIFORM_LOCATION (prog, projection);
+  INIT_COMMON_UNIFORM_LOCATION (prog, modelview);
+
+  if (prog == &self->color_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (color, color);
+    }
+  else if (prog == &self->coloring_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (coloring, color);
+    }
+  else if (prog == &self->color_matrix_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
+      INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
+    }
+  else if (prog == &self->linear_gradient_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_offsets);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, num_color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, start_point);
+      INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, end_point);
+    }
+  else if (prog == &self->radial_gradient_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, color_offsets);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, num_color_stops);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, center);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, radius);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, start);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, end);
+      INIT_PROGRAM_UNIFORM_LOCATION (radial_gradient, repeat);
+    }
+  else if (prog == &self->blur_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_radius);
+      INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_size);
+      /*INIT_PROGRAM_UNIFORM_LOCATION (blur, dir);*/
+    }
+  else if (prog == &self->inset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, spread);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, offset);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_heights);
+    }
+  else if (prog == &self->outset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_heights);
+    }
+  else if (prog == &self->unblurred_outset_shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, spread);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, offset);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, outline);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_widths);
+      INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_heights);
+    }
+  else if (prog == &self->shadow_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (shadow, color);
+    }
+  else if (prog == &self->border_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (border, color);
+      INIT_PROGRAM_UNIFORM_LOCATION (border, widths);
+    }
+  else if (prog == &self->cross_fade_program)
+    {
+      INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, progress);
+      INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, source2);
+    }
+
+  return TRUE;
+}
+
+/* Returns FALSE if the program can not be used */
+static gboolean
+gsk_gl_renderer_ensure_program (GskGLRenderer *self,
+                                Program       *prog)
+{
+  GError *error = NULL;
+
+  if (prog->id != 0)
+    return prog->id > 0;
+
+  if (!gsk_gl_renderer_compile_program (self, prog, &error))
+    {
+      g_critical ("%s", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gsk_gl_renderer_warmup_programs (gpointer data)
+{
+  GskGLRenderer *self = data;
+  int i;
+
+  gdk_gl_context_make_current (self->gl_context);
+
+  /* One program per iteration, to not block the main loop for long */
+  for (i = 0; i < GL_N_PROGRAMS; i ++)
+    {
+      if (self->programs[i].id == 0)
+        {
+          gsk_gl_renderer_ensure_program (self, &self->programs[i]);
+          return G_SOURCE_CONTINUE;
+        }
+    }
+
+  self->warmup_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
 static gboolean
 gsk_gl_renderer_create_programs (GskGLRenderer  *self,
                                  GError        **error)
 {
   GskShaderBuilder *builder;
-  GError *shader_error = NULL;
   int i;
-  static const struct {
-    const char *name;
-    const char *vs;
-    const char *fs;
-  } program_definitions[] = {
-    { "blend",           "blend.vs.glsl", "blend.fs.glsl" },
-    { "blit",            "blit.vs.glsl",  "blit.fs.glsl" },
-    { "color",           "blit.vs.glsl",  "color.fs.glsl" },
-    { "coloring",        "blit.vs.glsl",  "coloring.fs.glsl" },
-    { "color matrix",    "blit.vs.glsl",  "color_matrix.fs.glsl" },
-    { "linear gradient", "blit.vs.glsl",  "linear_gradient.fs.glsl" },
-    { "blur",            "blit.vs.glsl",  "blur.fs.glsl" },
-    { "inset shadow",    "blit.vs.glsl",  "inset_shadow.fs.glsl" },
-    { "outset shadow",   "blit.vs.glsl",  "outset_shadow.fs.glsl" },
-    { "unblurred outset shadow",   "blit.vs.glsl",  "unblurred_outset_shadow.fs.glsl" },
-    { "shadow",          "blit.vs.glsl",  "shadow.fs.glsl" },
-    { "border",          "blit.vs.glsl",  "border.fs.glsl" },
-    { "cross fade",      "blit.vs.glsl",  "cross_fade.fs.glsl" },
-  };
 
   builder = gsk_shader_builder_new ();
 
@@ -1792,94 +2431,25 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
     gsk_shader_builder_add_define (builder, "GSK_DEBUG", "1");
 #endif
 
+  self->shader_builder = builder;
+
   for (i = 0; i < GL_N_PROGRAMS; i ++)
     {
       Program *prog = &self->programs[i];
 
       prog->index = i;
-      prog->id = gsk_shader_builder_create_program (builder,
-                                                    program_definitions[i].vs,
-                                                    program_definitions[i].fs,
-                                                    &shader_error);
+      prog->id = 0;
 
-      if (shader_error != NULL)
-        {
-          g_propagate_prefixed_error (error, shader_error,
-                                      "Unable to create '%s' program (from %s and %s):\n",
-                                      program_definitions[i].name,
-                                      program_definitions[i].vs,
-                                      program_definitions[i].fs);
+      if (program_definitions[i].lazy)
+        continue;
 
-          g_object_unref (builder);
+      if (!gsk_gl_renderer_compile_program (self, prog, error))
+        {
+          g_clear_object (&self->shader_builder);
           return FALSE;
         }
+    }
 
-      INIT_COMMON_UNIFORM_LOCATION (prog, alpha);
-      INIT_COMMON_UNIFORM_LOCATION (prog, source);
-      INIT_COMMON_UNIFORM_LOCATION (prog, mask);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_widths);
-      INIT_COMMON_UNIFORM_LOCATION (prog, clip_corner_heights);
-      INIT_COMMON_UNIFORM_LOCATION (prog, viewport);
-      INIT_COMMON_UNIFORM_LOCATION (prog, projection);
-      INIT_COMMON_UNIFORM_LOCATION (prog, modelview);
-    }
-
-  /* color */
-  INIT_PROGRAM_UNIFORM_LOCATION (color, color);
-
-  /* coloring */
-  INIT_PROGRAM_UNIFORM_LOCATION (coloring, color);
-
-  /* color matrix */
-  INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
-  INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
-
-  /* linear gradient */
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_stops);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, color_offsets);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, num_color_stops);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, start_point);
-  INIT_PROGRAM_UNIFORM_LOCATION (linear_gradient, end_point);
-
-  /* blur */
-  INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_radius);
-  INIT_PROGRAM_UNIFORM_LOCATION (blur, blur_size);
-  /*INIT_PROGRAM_UNIFORM_LOCATION (blur, dir);*/
-
-  /* inset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, spread);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, offset);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (inset_shadow, corner_heights);
-
-  /* outset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (outset_shadow, corner_heights);
-
-  /* unblurred outset shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, spread);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, offset);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, outline);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_widths);
-  INIT_PROGRAM_UNIFORM_LOCATION (unblurred_outset_shadow, corner_heights);
-
-  /* shadow */
-  INIT_PROGRAM_UNIFORM_LOCATION (shadow, color);
-
-  /* border */
-  INIT_PROGRAM_UNIFORM_LOCATION (border, color);
-  INIT_PROGRAM_UNIFORM_LOCATION (border, widths);
-
-  /* cross fade */
-  INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, progress);
-  INIT_PROGRAM_UNIFORM_LOCATION (cross_fade, source2);
-
-  g_object_unref (builder);
   return TRUE;
 }
 
@@ -1909,13 +2479,35 @@ gsk_gl_renderer_realize (GskRenderer  *renderer,
 
   g_assert (self->gl_driver == NULL);
   self->gl_profiler = gsk_gl_profiler_new (self->gl_context);
-  self->gl_driver = gsk_gl_driver_new (self->gl_context);
+  self->gl_driver = gsk_gl_driver_new (self->gl_context,
+                                       gsk_renderer_get_profiler (GSK_RENDERER (self)));
 
   GSK_RENDERER_NOTE (renderer, OPENGL, g_message ("Creating buffers and programs"));
   if (!gsk_gl_renderer_create_programs (self, error))
     return FALSE;
 
   gsk_gl_glyph_cache_init (&self->glyph_cache, renderer, self->gl_driver);
+  gsk_gl_icon_cache_init (&self->icon_cache, renderer, self->gl_driver);
+  gsk_gl_shadow_cache_init (&self->shadow_cache, renderer, self->gl_driver);
+
+  /* The vertex array keeps pointing to the buffer when its storage
+   * gets replaced, so the layout only needs to be described once */
+  glGenVertexArrays (1, &self->vao_id);
+  glBindVertexArray (self->vao_id);
+  glGenBuffers (1, &self->vertex_buffer_id);
+  glBindBuffer (GL_ARRAY_BUFFER, self->vertex_buffer_id);
+  self->vertex_buffer_size = 0;
+
+  /* 0 = position location */
+  glEnableVertexAttribArray (0);
+  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
+                         sizeof (GskQuadVertex),
+                         (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
+  /* 1 = texture coord location */
+  glEnableVertexAttribArray (1);
+  glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
+                         sizeof (GskQuadVertex),
+                         (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
 
   return TRUE;
 }
@@ -1936,12 +2528,39 @@ gsk_gl_renderer_unrealize (GskRenderer *renderer)
    */
   g_array_set_size (self->render_ops, 0);
 
+  if (self->warmup_id != 0)
+    {
+      g_source_remove (self->warmup_id);
+      self->warmup_id = 0;
+    }
+
   for (i = 0; i < GL_N_PROGRAMS; i ++)
-    glDeleteProgram (self->programs[i].id);
+    {
+      if (self->programs[i].id > 0)
+        glDeleteProgram (self->programs[i].id);
+      self->programs[i].id = 0;
+    }
+
+  g_clear_object (&self->shader_builder);
 
   gsk_gl_renderer_destroy_buffers (self);
 
+  if (self->vao_id != 0)
+    {
+      glDeleteVertexArrays (1, &self->vao_id);
+      glDeleteBuffers (1, &self->vertex_buffer_id);
+      self->vao_id = 0;
+      self->vertex_buffer_id = 0;
+      self->vertex_buffer_size = 0;
+    }
+
+  g_clear_pointer (&self->buffer_damage, cairo_region_destroy);
+  g_clear_pointer (&self->render_region, cairo_region_destroy);
+  g_clear_pointer (&self->pending_region, cairo_region_destroy);
+
   gsk_gl_glyph_cache_free (&self->glyph_cache);
+  gsk_gl_icon_cache_free (&self->icon_cache);
+  gsk_gl_shadow_cache_free (&self->shadow_cache);
 
   g_clear_object (&self->gl_profiler);
   g_clear_object (&self->gl_driver);
@@ -1969,6 +2588,13 @@ gsk_gl_renderer_begin_draw_frame (GskRenderer          *renderer,
                      gdk_window_get_height (window) * self->scale_factor
                  };
   damage = gdk_gl_context_get_damage (self->gl_context);
+
+  /* Remember what is outdated in the back buffer, so we can limit
+   * rendering to that and the area that changed in the node tree.
+   */
+  g_clear_pointer (&self->buffer_damage, cairo_region_destroy);
+  self->buffer_damage = cairo_region_copy (damage);
+
   cairo_region_union (damage, update_area);
 
   if (cairo_region_contains_rectangle (damage, &whole_window) == CAIRO_REGION_OVERLAP_IN)
@@ -2052,10 +2678,15 @@ gsk_gl_renderer_setup_render_mode (GskGLRenderer *self)
       {
         GdkDrawingContext *context = gsk_renderer_get_drawing_context (GSK_RENDERER (self));
         GdkWindow *window = gsk_renderer_get_window (GSK_RENDERER (self));
-        cairo_region_t *clip = gdk_drawing_context_get_clip (context);
+        cairo_region_t *clip;
         cairo_rectangle_int_t extents;
         int window_height;
 
+        if (self->render_region != NULL)
+          clip = cairo_region_reference (self->render_region);
+        else
+          clip = gdk_drawing_context_get_clip (context);
+
         /* Fall back to RENDER_FULL */
         if (clip == NULL)
           {
@@ -2063,12 +2694,9 @@ gsk_gl_renderer_setup_render_mode (GskGLRenderer *self)
             return;
           }
 
-        g_assert (cairo_region_num_rectangles (clip) == 1);
-
         window_height = gdk_window_get_height (window) * self->scale_factor;
 
-        /*cairo_region_get_extents (clip, &extents);*/
-        cairo_region_get_rectangle (clip, 0, &extents);
+        cairo_region_get_extents (clip, &extents);
 
         glEnable (GL_SCISSOR_TEST);
         glScissor (extents.x * self->scale_factor,
@@ -2156,6 +2784,11 @@ gsk_gl_renderer_add_render_ops (GskGLRenderer   *self,
       render_linear_gradient_node (self, node, builder, vertex_data);
     break;
 
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      render_radial_gradient_node (self, node, builder, vertex_data);
+    break;
+
     case GSK_CLIP_NODE:
       render_clip_node (self, node, builder);
     break;
@@ -2232,7 +2865,9 @@ add_offscreen_ops (GskGLRenderer   *self,
   graphene_matrix_t prev_modelview;
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
-  GskRoundedRect prev_clip;
+  GskRoundedRect prev_clip, prev_extra_clip;
+  GskTextureKey key;
+  int cached_id;
 
   /* We need the child node as a texture. If it already is one, we don't need to draw
    * it on a framebuffer of course. */
@@ -2245,12 +2880,34 @@ add_offscreen_ops (GskGLRenderer   *self,
 
       *texture_id = gsk_gl_driver_get_texture_for_texture (self->gl_driver,
                                                            texture,
+                                                           get_texture_level (builder, texture, &child_node->bounds),
                                                            gl_min_filter,
                                                            gl_mag_filter);
       *is_offscreen = FALSE;
       return;
     }
 
+  /* Render nodes are immutable, so if we rendered the same node into the same
+   * region before, the result is still valid. */
+  key.pointer = child_node;
+  key.scale = self->scale_factor;
+  key.opacity = builder->current_opacity;
+  key.offset = GRAPHENE_POINT_INIT (builder->dx, builder->dy);
+  key.bounds = GRAPHENE_RECT_INIT (min_x, min_y, width, height);
+
+  cached_id = gsk_gl_driver_get_texture_for_key (self->gl_driver, &key);
+  if (cached_id != 0)
+    {
+      *texture_id = cached_id;
+      *is_offscreen = TRUE;
+      return;
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (gsk_renderer_get_profiler (GSK_RENDERER (self)),
+                            self->profile_counters.offscreens);
+#endif
+
   *texture_id = gsk_gl_driver_create_texture (self->gl_driver, width, height);
   gsk_gl_driver_bind_source_texture (self->gl_driver, *texture_id);
   gsk_gl_driver_init_texture_empty (self->gl_driver, *texture_id);
@@ -2273,15 +2930,21 @@ add_offscreen_ops (GskGLRenderer   *self,
                                                                   width, height));
   prev_clip = ops_set_clip (builder,
                             &GSK_ROUNDED_RECT_INIT (min_x, min_y, width, height));
+  prev_extra_clip = ops_set_extra_clip (builder, &GSK_ROUNDED_RECT_INIT (0, 0, 0, 0));
 
   gsk_gl_renderer_add_render_ops (self, child_node, builder);
 
+  ops_set_extra_clip (builder, &prev_extra_clip);
   ops_set_clip (builder, &prev_clip);
   ops_set_viewport (builder, &prev_viewport);
   ops_set_modelview (builder, &prev_modelview);
   ops_set_projection (builder, &prev_projection);
   ops_set_render_target (builder, prev_render_target);
 
+  gsk_render_node_ref (child_node);
+  gsk_gl_driver_set_texture_for_key (self->gl_driver, &key, *texture_id,
+                                     (GDestroyNotify) gsk_render_node_unref);
+
   *is_offscreen = TRUE;
 }
 
@@ -2292,19 +2955,39 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
   guint i;
   guint n_ops = self->render_ops->len;
   const Program *program = NULL;
+  gboolean mapped = FALSE;
   gsize buffer_index = 0;
-  float *vertex_data = g_malloc (vertex_data_size);
+  float *vertex_data = NULL;
+#ifdef G_ENABLE_DEBUG
+  GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
+  gboolean offscreen = FALSE;
+#endif
 
   /*g_message ("%s: Buffer size: %ld", __FUNCTION__, vertex_data_size);*/
 
+  glBindVertexArray (self->vao_id);
+  glBindBuffer (GL_ARRAY_BUFFER, self->vertex_buffer_id);
 
-  GLuint buffer_id, vao_id;
-  glGenVertexArrays (1, &vao_id);
-  glBindVertexArray (vao_id);
-
-  glGenBuffers (1, &buffer_id);
-  glBindBuffer (GL_ARRAY_BUFFER, buffer_id);
+  if (vertex_data_size > 0)
+    {
+      if (vertex_data_size > self->vertex_buffer_size)
+        {
+          self->vertex_buffer_size = MAX (self->vertex_buffer_size, 64 * 1024);
+          while (self->vertex_buffer_size < vertex_data_size)
+            self->vertex_buffer_size *= 2;
+        }
 
+      /* Replacing the storage lets the driver hand out fresh memory
+       * while the GPU may still be reading the previous frame's data,
+       * instead of allocating a new buffer object every frame */
+      glBufferData (GL_ARRAY_BUFFER, self->vertex_buffer_size, NULL, GL_STREAM_DRAW);
+      vertex_data = glMapBufferRange (GL_ARRAY_BUFFER, 0, vertex_data_size,
+                                      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      if (vertex_data == NULL)
+        vertex_data = g_malloc (vertex_data_size);
+      else
+        mapped = TRUE;
+    }
 
   // Fill buffer data
   for (i = 0; i < n_ops; i ++)
@@ -2318,21 +3001,18 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
         }
     }
 
-  // Set buffer data
-  glBufferData (GL_ARRAY_BUFFER, vertex_data_size, vertex_data, GL_STATIC_DRAW);
-
-  // Describe buffer contents
+  if (mapped)
+    glUnmapBuffer (GL_ARRAY_BUFFER);
+  else if (vertex_data != NULL)
+    {
+      glBufferSubData (GL_ARRAY_BUFFER, 0, vertex_data_size, vertex_data);
+      g_free (vertex_data);
+    }
 
-  /* 0 = position location */
-  glEnableVertexAttribArray (0);
-  glVertexAttribPointer (0, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, position));
-  /* 1 = texture coord location */
-  glEnableVertexAttribArray (1);
-  glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
-                         sizeof (GskQuadVertex),
-                         (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
+#ifdef G_ENABLE_DEBUG
+  if (self->gpu_times)
+    gsk_gl_profiler_begin_timestamps (self->gl_profiler);
+#endif
 
   for (i = 0; i < n_ops; i ++)
     {
@@ -2361,12 +3041,29 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           break;
 
         case OP_CHANGE_PROGRAM:
+          if (!gsk_gl_renderer_ensure_program (self, (Program *) op->program))
+            {
+              program = NULL;
+              break;
+            }
           apply_program_op (program, op);
           program = op->program;
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (profiler, self->profile_counters.program_changes);
+          if (self->gpu_times)
+            gsk_gl_profiler_add_timestamp (self->gl_profiler,
+                                           program->index + (offscreen ? GL_N_PROGRAMS : 0));
+#endif
           break;
 
         case OP_CHANGE_RENDER_TARGET:
           apply_render_target_op (self, program, op);
+#ifdef G_ENABLE_DEBUG
+          offscreen = op->render_target_id != 0 && op->render_target_id != self->texture_id;
+          if (self->gpu_times && program != NULL)
+            gsk_gl_profiler_add_timestamp (self->gl_profiler,
+                                           program->index + (offscreen ? GL_N_PROGRAMS : 0));
+#endif
           break;
 
         case OP_CLEAR:
@@ -2400,6 +3097,10 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           apply_clip_op (program, op);
           break;
 
+        case OP_CHANGE_EXTRA_CLIP:
+          apply_extra_clip_op (program, op);
+          break;
+
         case OP_CHANGE_SOURCE_TEXTURE:
           apply_source_texture_op (program, op);
           break;
@@ -2413,6 +3114,10 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           apply_linear_gradient_op (program, op);
           break;
 
+        case OP_CHANGE_RADIAL_GRADIENT:
+          apply_radial_gradient_op (program, op);
+          break;
+
         case OP_CHANGE_BLUR:
           apply_blur_op (program, op);
           break;
@@ -2437,6 +3142,9 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           OP_PRINT (" -> draw %ld, size %ld and program %d\n",
                     op->draw.vao_offset, op->draw.vao_size, program->index);
           glDrawArrays (GL_TRIANGLES, op->draw.vao_offset, op->draw.vao_size);
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (profiler, self->profile_counters.draw_calls);
+#endif
           break;
 
         default:
@@ -2446,11 +3154,26 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
       OP_PRINT ("\n");
     }
 
-  /* Done drawing, destroy the buffer again.
-   * TODO: Can we reuse the memory, though? */
-  g_free (vertex_data);
-  glDeleteVertexArrays (1, &vao_id);
-  glDeleteBuffers (1, &buffer_id);
+#ifdef G_ENABLE_DEBUG
+  if (self->gpu_times)
+    {
+      guint64 times[GL_N_PROGRAMS * 2];
+
+      /* These are the times of the previous frame */
+      if (gsk_gl_profiler_end_timestamps (self->gl_profiler, times, G_N_ELEMENTS (times)))
+        {
+          guint64 offscreen_time = 0;
+
+          for (i = 0; i < GL_N_PROGRAMS; i++)
+            {
+              gsk_profiler_timer_set (profiler, self->profile_timers.program_gpu_times[i],
+                                      times[i] + times[GL_N_PROGRAMS + i]);
+              offscreen_time += times[GL_N_PROGRAMS + i];
+            }
+          gsk_profiler_timer_set (profiler, self->profile_timers.offscreen_gpu_time, offscreen_time);
+        }
+    }
+#endif
 }
 
 static void
@@ -2492,6 +3215,8 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
 
   gsk_gl_driver_begin_frame (self->gl_driver);
   gsk_gl_glyph_cache_begin_frame (&self->glyph_cache);
+  gsk_gl_icon_cache_begin_frame (&self->icon_cache);
+  gsk_gl_shadow_cache_begin_frame (&self->shadow_cache);
 
   memset (&render_op_builder, 0, sizeof (render_op_builder));
   render_op_builder.renderer = self;
@@ -2506,6 +3231,7 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
     ops_set_render_target (&render_op_builder, self->texture_id);
 
   gsk_gl_renderer_add_render_ops (self, root, &render_op_builder);
+  ops_merge_draws (&render_op_builder);
 
   /*g_message ("Ops: %u", self->render_ops->len);*/
 
@@ -2597,6 +3323,151 @@ gsk_gl_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+/* Limits rendering to the part of the drawing context clip that is
+ * either outdated in the back buffer or has changed since the last frame.
+ */
+static void
+gsk_gl_renderer_update_render_region (GskGLRenderer *self)
+{
+  GskRenderer *renderer = GSK_RENDERER (self);
+  cairo_region_t *damage = gsk_renderer_get_damage (renderer);
+  GdkWindow *window = gsk_renderer_get_window (renderer);
+  cairo_rectangle_int_t extents;
+  cairo_region_t *clip;
+
+  g_clear_pointer (&self->render_region, cairo_region_destroy);
+
+  if (damage == NULL || self->buffer_damage == NULL)
+    return;
+
+  clip = gdk_drawing_context_get_clip (gsk_renderer_get_drawing_context (renderer));
+  if (clip == NULL)
+    return;
+
+  self->render_region = cairo_region_copy (damage);
+  cairo_region_union (self->render_region, self->buffer_damage);
+  if (self->pending_region != NULL)
+    cairo_region_union (self->render_region, self->pending_region);
+  cairo_region_intersect (self->render_region, clip);
+  cairo_region_destroy (clip);
+
+  cairo_region_get_extents (self->render_region, &extents);
+  if (extents.x == 0 && extents.y == 0 &&
+      extents.width == gdk_window_get_width (window) &&
+      extents.height == gdk_window_get_height (window))
+    self->render_mode = RENDER_FULL;
+  else
+    self->render_mode = RENDER_SCISSOR;
+}
+
+/* Returns the texture node that makes up all of @node when drawn
+ * into @bounds, looking through single-child containers and clips
+ * that do not cut anything off.
+ */
+static GskRenderNode *
+find_covering_texture_node (GskRenderNode         *node,
+                            const graphene_rect_t *bounds)
+{
+  while (node != NULL)
+    {
+      switch (gsk_render_node_get_node_type (node))
+        {
+        case GSK_CONTAINER_NODE:
+          if (gsk_container_node_get_n_children (node) != 1)
+            return NULL;
+          node = gsk_container_node_get_child (node, 0);
+          break;
+
+        case GSK_CLIP_NODE:
+          if (!graphene_rect_contains_rect (gsk_clip_node_peek_clip (node), bounds))
+            return NULL;
+          node = gsk_clip_node_get_child (node);
+          break;
+
+        case GSK_TEXTURE_NODE:
+          if (!graphene_rect_equal (&node->bounds, bounds))
+            return NULL;
+          return node;
+
+        default:
+          return NULL;
+        }
+    }
+
+  return NULL;
+}
+
+/* A GL texture that exactly covers the window, as with a fullscreen
+ * GtkGLArea or video, would be drawn with a single unscaled blit over
+ * the cleared framebuffer. Copy it with glBlitFramebuffer() instead of
+ * going through the shaders and all the per-frame setup.
+ */
+static gboolean
+gsk_gl_renderer_try_blit_root (GskGLRenderer         *self,
+                               GskRenderNode         *root,
+                               const graphene_rect_t *viewport)
+{
+  GdkWindow *window = gsk_renderer_get_window (GSK_RENDERER (self));
+  graphene_rect_t bounds;
+  GskRenderNode *node;
+  GdkTexture *texture;
+  int width, height;
+  int framebuffer;
+  guint fbo;
+
+  if (self->texture_id != 0 || epoxy_gl_version () < 30)
+    return FALSE;
+
+  graphene_rect_init (&bounds, 0, 0,
+                      gdk_window_get_width (window),
+                      gdk_window_get_height (window));
+
+  node = find_covering_texture_node (root, &bounds);
+  if (node == NULL)
+    return FALSE;
+
+  texture = gsk_texture_node_get_texture (node);
+  width = viewport->size.width;
+  height = viewport->size.height;
+
+  if (!GDK_IS_GL_TEXTURE (texture) ||
+      gdk_texture_get_width (texture) != width ||
+      gdk_texture_get_height (texture) != height)
+    return FALSE;
+
+  glGetIntegerv (GL_FRAMEBUFFER_BINDING, &framebuffer);
+
+  glGenFramebuffers (1, &fbo);
+  glBindFramebuffer (GL_READ_FRAMEBUFFER, fbo);
+  glFramebufferTexture2D (GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                          gdk_gl_texture_get_id (GDK_GL_TEXTURE (texture)), 0);
+
+  if (glCheckFramebufferStatus (GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+      glBindFramebuffer (GL_FRAMEBUFFER, framebuffer);
+      glDeleteFramebuffers (1, &fbo);
+      return FALSE;
+    }
+
+  GSK_RENDERER_NOTE (GSK_RENDERER (self), OPENGL, g_message ("Blitting fullscreen texture"));
+
+  glBindFramebuffer (GL_DRAW_FRAMEBUFFER, framebuffer);
+  glDisable (GL_SCISSOR_TEST);
+  glBlitFramebuffer (0, 0, width, height,
+                     0, 0, width, height,
+                     GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  glBindFramebuffer (GL_FRAMEBUFFER, framebuffer);
+  glDeleteFramebuffers (1, &fbo);
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (gsk_renderer_get_profiler (GSK_RENDERER (self)),
+                            self->profile_counters.frames);
+#endif
+
+  return TRUE;
+}
+
 static void
 gsk_gl_renderer_render (GskRenderer   *renderer,
                         GskRenderNode *root)
@@ -2604,22 +3475,56 @@ gsk_gl_renderer_render (GskRenderer   *renderer,
   GskGLRenderer *self = GSK_GL_RENDERER (renderer);
   GdkWindow *window = gsk_renderer_get_window (renderer);
   graphene_rect_t viewport;
+  int i;
 
   if (self->gl_context == NULL)
     return;
 
   gdk_gl_context_make_current (self->gl_context);
 
+  gsk_gl_renderer_update_render_region (self);
+  if (self->render_region != NULL && cairo_region_is_empty (self->render_region))
+    {
+      GSK_RENDERER_NOTE (renderer, OPENGL, g_message ("Nothing changed, skipping frame"));
+      g_clear_pointer (&self->render_region, cairo_region_destroy);
+      return;
+    }
+
   viewport.origin.x = 0;
   viewport.origin.y = 0;
   viewport.size.width = gdk_window_get_width (window) * self->scale_factor;
   viewport.size.height = gdk_window_get_height (window) * self->scale_factor;
 
-  gsk_gl_renderer_do_render (renderer, root, &viewport, self->scale_factor);
+  g_clear_pointer (&self->pending_region, cairo_region_destroy);
+
+  if (!gsk_gl_renderer_try_blit_root (self, root, &viewport))
+    gsk_gl_renderer_do_render (renderer, root, &viewport, self->scale_factor);
 
   gdk_gl_context_make_current (self->gl_context);
   gsk_gl_renderer_clear_tree (self);
   gsk_gl_renderer_destroy_buffers (self);
+
+  g_clear_pointer (&self->render_region, cairo_region_destroy);
+
+  /* Compile the remaining programs once we are on screen */
+  if (self->warmup_id == 0 && self->shader_builder != NULL)
+    {
+      for (i = 0; i < GL_N_PROGRAMS; i ++)
+        if (self->programs[i].id == 0)
+          break;
+
+      if (i < GL_N_PROGRAMS)
+        {
+          self->warmup_id = g_idle_add_full (G_PRIORITY_LOW,
+                                             gsk_gl_renderer_warmup_programs,
+                                             self, NULL);
+          g_source_set_name_by_id (self->warmup_id, "[gtk+] gsk_gl_renderer_warmup_programs");
+        }
+    }
+
+  /* Draw the textures we showed placeholders for once they are uploaded */
+  if (self->pending_region != NULL)
+    gdk_window_invalidate_region (window, self->pending_region, FALSE);
 }
 
 static void
@@ -2652,9 +3557,34 @@ gsk_gl_renderer_init (GskGLRenderer *self)
 
     self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
     self->profile_counters.draw_calls = gsk_profiler_add_counter (profiler, "draws", "glDrawArrays", TRUE);
+    self->profile_counters.program_changes = gsk_profiler_add_counter (profiler, "program-changes", "Program changes", TRUE);
+    self->profile_counters.offscreens = gsk_profiler_add_counter (profiler, "offscreens", "Offscreen renders", TRUE);
+    self->profile_counters.fallback_nodes = gsk_profiler_add_counter (profiler, "fallback-nodes", "Cairo fallback nodes", TRUE);
+    self->profile_counters.fallback_pixels = gsk_profiler_add_counter (profiler, "fallback-pixels", "Cairo fallback pixels", TRUE);
 
     self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
     self->profile_timers.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU time", FALSE, TRUE);
+
+    /* GPU times per program, which is about as fine as the node
+     * types can be told apart once the ops have been built */
+    if (GSK_DEBUG_CHECK (GPU_TIMES))
+      {
+        int i;
+
+        for (i = 0; i < GL_N_PROGRAMS; i++)
+          {
+            char *name = g_strdup_printf ("gpu-time-%s", program_definitions[i].name);
+            char *description = g_strdup_printf ("GPU time (%s)", program_definitions[i].name);
+
+            g_strdelimit (name, " ", '-');
+            self->profile_timers.program_gpu_times[i] = gsk_profiler_add_timer (profiler, name, description, FALSE, TRUE);
+
+            g_free (name);
+            g_free (description);
+          }
+        self->profile_timers.offscreen_gpu_time = gsk_profiler_add_timer (profiler, "gpu-time-offscreen", "GPU time (offscreens)", FALSE, TRUE);
+        self->gpu_times = TRUE;
+      }
   }
 #endif
 }
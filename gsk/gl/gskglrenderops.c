@@ -66,6 +66,16 @@ ops_set_program (RenderOpBuilder *builder,
       builder->program_state[program->index].clip = builder->current_clip;
     }
 
+  if (!builder->program_state[program->index].extra_clip_set ||
+      memcmp (&builder->current_extra_clip, &builder->program_state[program->index].extra_clip, sizeof (GskRoundedRect)) != 0)
+    {
+      op.op = OP_CHANGE_EXTRA_CLIP;
+      op.clip = builder->current_extra_clip;
+      g_array_append_val (builder->render_ops, op);
+      builder->program_state[program->index].extra_clip = builder->current_extra_clip;
+      builder->program_state[program->index].extra_clip_set = TRUE;
+    }
+
   if (builder->program_state[program->index].opacity != builder->current_opacity)
     {
       op.op = OP_CHANGE_OPACITY;
@@ -109,6 +119,34 @@ ops_set_clip (RenderOpBuilder      *builder,
   return prev_clip;
 }
 
+GskRoundedRect
+ops_set_extra_clip (RenderOpBuilder      *builder,
+                    const GskRoundedRect *clip)
+{
+  GskRoundedRect prev_clip;
+
+  prev_clip = builder->current_extra_clip;
+
+  if (memcmp (clip, &prev_clip, sizeof (GskRoundedRect)) == 0)
+    return prev_clip;
+
+  if (builder->current_program != NULL)
+    {
+      RenderOp op;
+
+      op.op = OP_CHANGE_EXTRA_CLIP;
+      op.clip = *clip;
+      g_array_append_val (builder->render_ops, op);
+
+      builder->program_state[builder->current_program->index].extra_clip = *clip;
+      builder->program_state[builder->current_program->index].extra_clip_set = TRUE;
+    }
+
+  builder->current_extra_clip = *clip;
+
+  return prev_clip;
+}
+
 graphene_matrix_t
 ops_set_modelview (RenderOpBuilder         *builder,
                    const graphene_matrix_t *modelview)
@@ -406,3 +444,152 @@ ops_add (RenderOpBuilder *builder,
 {
   g_array_append_val (builder->render_ops, *op);
 }
+
+/* Walks the finished op stream and turns state changes that don't change
+ * anything at the time they get applied into OP_NONE. Draws that were only
+ * separated by such ops then refer to adjacent ranges of the vertex buffer
+ * and get merged into a single draw call. */
+void
+ops_merge_draws (RenderOpBuilder *builder)
+{
+  struct {
+    guint has_clip : 1;
+    guint has_color : 1;
+    guint has_opacity : 1;
+    guint has_extra_clip : 1;
+    GskRoundedRect clip;
+    GskRoundedRect extra_clip;
+    GdkRGBA color;
+    float opacity;
+  } state[GL_N_PROGRAMS];
+  GArray *render_ops = builder->render_ops;
+  const Program *program = NULL;
+  int render_target = -1;
+  int texture = 0;
+  RenderOp *last_draw = NULL;
+  guint i;
+
+  memset (state, 0, sizeof (state));
+
+  for (i = 0; i < render_ops->len; i ++)
+    {
+      RenderOp *op = &g_array_index (render_ops, RenderOp, i);
+
+      switch (op->op)
+        {
+        case OP_NONE:
+        case OP_CHANGE_VAO:
+          /* Neither of these influences the draw calls around them */
+          break;
+
+        case OP_CHANGE_PROGRAM:
+          if (op->program == program)
+            {
+              op->op = OP_NONE;
+              break;
+            }
+          program = op->program;
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_RENDER_TARGET:
+          if (op->render_target_id == render_target)
+            {
+              op->op = OP_NONE;
+              break;
+            }
+          render_target = op->render_target_id;
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_SOURCE_TEXTURE:
+          /* The texture binding is not per-program state */
+          if (op->texture_id == texture)
+            {
+              op->op = OP_NONE;
+              break;
+            }
+          texture = op->texture_id;
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_CLIP:
+          if (program != NULL)
+            {
+              if (state[program->index].has_clip &&
+                  memcmp (&state[program->index].clip, &op->clip, sizeof (GskRoundedRect)) == 0)
+                {
+                  op->op = OP_NONE;
+                  break;
+                }
+              state[program->index].has_clip = TRUE;
+              state[program->index].clip = op->clip;
+            }
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_EXTRA_CLIP:
+          if (program != NULL)
+            {
+              if (state[program->index].has_extra_clip &&
+                  memcmp (&state[program->index].extra_clip, &op->clip, sizeof (GskRoundedRect)) == 0)
+                {
+                  op->op = OP_NONE;
+                  break;
+                }
+              state[program->index].has_extra_clip = TRUE;
+              state[program->index].extra_clip = op->clip;
+            }
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_COLOR:
+          if (program != NULL)
+            {
+              if (state[program->index].has_color &&
+                  gdk_rgba_equal (&state[program->index].color, &op->color))
+                {
+                  op->op = OP_NONE;
+                  break;
+                }
+              state[program->index].has_color = TRUE;
+              state[program->index].color = op->color;
+            }
+          last_draw = NULL;
+          break;
+
+        case OP_CHANGE_OPACITY:
+          if (program != NULL)
+            {
+              if (state[program->index].has_opacity &&
+                  state[program->index].opacity == op->opacity)
+                {
+                  op->op = OP_NONE;
+                  break;
+                }
+              state[program->index].has_opacity = TRUE;
+              state[program->index].opacity = op->opacity;
+            }
+          last_draw = NULL;
+          break;
+
+        case OP_DRAW:
+          if (last_draw != NULL &&
+              last_draw->draw.vao_offset + last_draw->draw.vao_size == op->draw.vao_offset)
+            {
+              last_draw->draw.vao_size += op->draw.vao_size;
+              op->op = OP_NONE;
+            }
+          else
+            {
+              last_draw = op;
+            }
+          break;
+
+        default:
+          /* Everything else is treated as a barrier between draws */
+          last_draw = NULL;
+          break;
+        }
+    }
+}
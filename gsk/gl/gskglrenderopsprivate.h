@@ -10,7 +10,7 @@
 #include "gskglrendererprivate.h"
 
 #define GL_N_VERTICES 6
-#define GL_N_PROGRAMS 13
+#define GL_N_PROGRAMS 14
 
 enum {
   OP_NONE,
@@ -33,8 +33,10 @@ enum {
   OP_CHANGE_BORDER_COLOR    =  17,
   OP_CHANGE_CROSS_FADE      =  18,
   OP_CHANGE_UNBLURRED_OUTSET_SHADOW = 19,
-  OP_CLEAR                  =  20,
-  OP_DRAW                   =  21,
+  OP_CHANGE_RADIAL_GRADIENT =  20,
+  OP_CHANGE_EXTRA_CLIP      =  21,
+  OP_CLEAR                  =  22,
+  OP_DRAW                   =  23,
 };
 
 typedef struct
@@ -55,6 +57,9 @@ typedef struct
   int clip_location;
   int clip_corner_widths_location;
   int clip_corner_heights_location;
+  int extra_clip_location;
+  int extra_clip_corner_widths_location;
+  int extra_clip_corner_heights_location;
 
   union {
     struct {
@@ -77,6 +82,16 @@ typedef struct
       int start_point_location;
       int end_point_location;
     } linear_gradient;
+    struct {
+      int num_color_stops_location;
+      int color_stops_location;
+      int color_offsets_location;
+      int center_location;
+      int radius_location;
+      int start_location;
+      int end_location;
+      int repeat_location;
+    } radial_gradient;
     struct {
       int blur_radius_location;
       int blur_size_location;
@@ -137,6 +152,16 @@ typedef struct
       graphene_point_t start_point;
       graphene_point_t end_point;
     } linear_gradient;
+    struct {
+      int n_color_stops;
+      float color_offsets[8];
+      float color_stops[4 * 8];
+      graphene_point_t center;
+      float radius[2];
+      float start;
+      float end;
+      gboolean repeat;
+    } radial_gradient;
     struct {
       gsize vao_offset;
       gsize vao_size;
@@ -196,6 +221,8 @@ typedef struct
   /* Per-Program State */
   struct {
     GskRoundedRect clip;
+    GskRoundedRect extra_clip;
+    gboolean extra_clip_set;
     graphene_matrix_t modelview;
     graphene_matrix_t projection;
     int source_texture;
@@ -220,6 +247,10 @@ typedef struct
   int current_render_target;
   int current_texture;
   GskRoundedRect current_clip;
+  /* A second clip that is applied in addition to current_clip, for
+   * nested clips whose intersection is not a rounded rectangle.
+   * It is unused if it is empty. */
+  GskRoundedRect current_extra_clip;
   graphene_matrix_t current_modelview;
   graphene_matrix_t current_projection;
   graphene_rect_t current_viewport;
@@ -240,6 +271,9 @@ void              ops_set_program        (RenderOpBuilder         *builder,
 GskRoundedRect    ops_set_clip           (RenderOpBuilder         *builder,
                                           const GskRoundedRect    *clip);
 
+GskRoundedRect    ops_set_extra_clip     (RenderOpBuilder         *builder,
+                                          const GskRoundedRect    *clip);
+
 graphene_matrix_t ops_set_modelview      (RenderOpBuilder         *builder,
                                           const graphene_matrix_t *modelview);
 
@@ -280,4 +314,6 @@ void              ops_offset             (RenderOpBuilder        *builder,
 void              ops_add                (RenderOpBuilder        *builder,
                                           const RenderOp         *op);
 
+void              ops_merge_draws        (RenderOpBuilder        *builder);
+
 #endif
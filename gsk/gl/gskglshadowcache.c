@@ -0,0 +1,178 @@
+#include "config.h"
+
+#include "gskglshadowcacheprivate.h"
+#include "gskdebugprivate.h"
+
+/* Blurred outset shadows are drawn as a nine-slice from a texture that only
+ * holds the corners and a few pixels of the sides. That texture does not
+ * depend on the size or position of the shadow, only on the shrunk outline
+ * (which includes the spread), the blur radius and the color, so we keep
+ * it around and let resizing and moving windows reuse it without blurring
+ * again. Shadows that have not been used for MAX_AGE frames are dropped
+ * every CHECK_INTERVAL frames.
+ */
+
+#define MAX_AGE 60
+#define CHECK_INTERVAL 10
+
+typedef struct
+{
+  GskRoundedRect outline;
+  float blur_radius;
+  GdkRGBA color;
+} ShadowKey;
+
+typedef struct
+{
+  ShadowKey key;
+
+  int texture_id;
+  guint64 timestamp;
+} CachedShadow;
+
+static guint
+shadow_key_hash (gconstpointer data)
+{
+  const ShadowKey *k = data;
+  guint h;
+  int i;
+
+  h = (guint) k->outline.bounds.size.width;
+  h = (h << 5) - h + (guint) k->outline.bounds.size.height;
+  for (i = 0; i < 4; i++)
+    {
+      h = (h << 5) - h + (guint) k->outline.corner[i].width;
+      h = (h << 5) - h + (guint) k->outline.corner[i].height;
+    }
+  h = (h << 5) - h + (guint) (k->blur_radius * 100);
+  h = (h << 5) - h + gdk_rgba_hash (&k->color);
+
+  return h;
+}
+
+static gboolean
+shadow_key_equal (gconstpointer v1,
+                  gconstpointer v2)
+{
+  const ShadowKey *k1 = v1;
+  const ShadowKey *k2 = v2;
+  int i;
+
+  if (!graphene_rect_equal (&k1->outline.bounds, &k2->outline.bounds))
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (!graphene_size_equal (&k1->outline.corner[i], &k2->outline.corner[i]))
+        return FALSE;
+    }
+
+  return k1->blur_radius == k2->blur_radius &&
+         gdk_rgba_equal (&k1->color, &k2->color);
+}
+
+static void
+shadow_key_init (ShadowKey            *key,
+                 const GskRoundedRect *shadow_rect,
+                 float                 blur_radius,
+                 const GdkRGBA        *color)
+{
+  key->outline = *shadow_rect;
+  key->blur_radius = blur_radius;
+  key->color = *color;
+}
+
+void
+gsk_gl_shadow_cache_init (GskGLShadowCache *self,
+                          GskRenderer      *renderer,
+                          GskGLDriver      *gl_driver)
+{
+  /* The textures are owned by the driver and go away with it */
+  self->shadows = g_hash_table_new_full (shadow_key_hash, shadow_key_equal, NULL, g_free);
+
+  self->renderer = renderer;
+  self->gl_driver = gl_driver;
+}
+
+void
+gsk_gl_shadow_cache_free (GskGLShadowCache *self)
+{
+  GHashTableIter iter;
+  CachedShadow *shadow;
+
+  g_hash_table_iter_init (&iter, self->shadows);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&shadow))
+    gsk_gl_driver_destroy_texture (self->gl_driver, shadow->texture_id);
+
+  g_clear_pointer (&self->shadows, g_hash_table_unref);
+}
+
+void
+gsk_gl_shadow_cache_begin_frame (GskGLShadowCache *self)
+{
+  GHashTableIter iter;
+  CachedShadow *shadow;
+  guint dropped = 0;
+
+  self->timestamp++;
+
+  if (self->timestamp % CHECK_INTERVAL != 0)
+    return;
+
+  /* look for shadows that have grown old and drop them */
+  g_hash_table_iter_init (&iter, self->shadows);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&shadow))
+    {
+      if (self->timestamp - shadow->timestamp < MAX_AGE)
+        continue;
+
+      gsk_gl_driver_destroy_texture (self->gl_driver, shadow->texture_id);
+      g_hash_table_iter_remove (&iter);
+      dropped++;
+    }
+
+  if (dropped > 0)
+    GSK_RENDERER_NOTE (self->renderer, OPENGL, g_message ("Dropped %d shadows", dropped));
+}
+
+/* Returns the blurred texture for the given shadow, or 0 if it has
+ * to be drawn and passed to gsk_gl_shadow_cache_commit(). */
+int
+gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache     *self,
+                                    const GskRoundedRect *shadow_rect,
+                                    float                 blur_radius,
+                                    const GdkRGBA        *color)
+{
+  ShadowKey key;
+  CachedShadow *shadow;
+
+  shadow_key_init (&key, shadow_rect, blur_radius, color);
+
+  shadow = g_hash_table_lookup (self->shadows, &key);
+  if (shadow == NULL)
+    return 0;
+
+  shadow->timestamp = self->timestamp;
+
+  return shadow->texture_id;
+}
+
+/* @texture_id must be a permanent texture; the cache owns it from now on */
+void
+gsk_gl_shadow_cache_commit (GskGLShadowCache     *self,
+                            const GskRoundedRect *shadow_rect,
+                            float                 blur_radius,
+                            const GdkRGBA        *color,
+                            int                   texture_id)
+{
+  CachedShadow *shadow;
+
+  g_assert (texture_id > 0);
+
+  shadow = g_new0 (CachedShadow, 1);
+  shadow_key_init (&shadow->key, shadow_rect, blur_radius, color);
+  shadow->texture_id = texture_id;
+  shadow->timestamp = self->timestamp;
+
+  g_hash_table_insert (self->shadows, &shadow->key, shadow);
+}
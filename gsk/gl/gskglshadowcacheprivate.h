@@ -0,0 +1,34 @@
+#ifndef __GSK_GL_SHADOW_CACHE_PRIVATE_H__
+#define __GSK_GL_SHADOW_CACHE_PRIVATE_H__
+
+#include "gskgldriverprivate.h"
+#include "gskrendererprivate.h"
+#include "gskroundedrectprivate.h"
+#include <gdk/gdk.h>
+
+typedef struct
+{
+  GskGLDriver *gl_driver;
+  GskRenderer *renderer;
+
+  GHashTable *shadows; /* ShadowKey -> CachedShadow */
+
+  guint64 timestamp;
+} GskGLShadowCache;
+
+void     gsk_gl_shadow_cache_init           (GskGLShadowCache     *self,
+                                             GskRenderer          *renderer,
+                                             GskGLDriver          *gl_driver);
+void     gsk_gl_shadow_cache_free           (GskGLShadowCache     *self);
+void     gsk_gl_shadow_cache_begin_frame    (GskGLShadowCache     *self);
+int      gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache     *self,
+                                             const GskRoundedRect *shadow_rect,
+                                             float                 blur_radius,
+                                             const GdkRGBA        *color);
+void     gsk_gl_shadow_cache_commit         (GskGLShadowCache     *self,
+                                             const GskRoundedRect *shadow_rect,
+                                             float                 blur_radius,
+                                             const GdkRGBA        *color,
+                                             int                   texture_id);
+
+#endif
@@ -650,6 +650,8 @@ gsk_broadway_renderer_add_node (GskRenderer *self,
     case GSK_BLEND_NODE:
     case GSK_CROSS_FADE_NODE:
     case GSK_BLUR_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     default:
       break; /* Fallback */
     }
@@ -38,18 +38,33 @@
 
 #define get_box_filter_size(radius) ((int)(GAUSSIAN_SCALE_FACTOR * (radius)))
 
-/* Sadly, clang is picky about get_box_filter_size(2) not being a
- * constant expression, thus we have to use precomputed values.
+/* Divisions by the filter width are done by multiplying with a
+ * fixed-point reciprocal with 48 fractional bits. The sums the box
+ * blur divides are below 256 * d, and for those the result is the
+ * same as the one of the rounding integer division, as long as
+ * d < 2^20.
  */
-#define BOX_FILTER_SIZE_2 3
-#define BOX_FILTER_SIZE_3 5
-#define BOX_FILTER_SIZE_4 7
-#define BOX_FILTER_SIZE_5 9
-#define BOX_FILTER_SIZE_6 11
-#define BOX_FILTER_SIZE_7 13
-#define BOX_FILTER_SIZE_8 15
-#define BOX_FILTER_SIZE_9 16
-#define BOX_FILTER_SIZE_10 18
+#define BLUR_DIVISOR_SHIFT 48
+
+typedef struct {
+  guint32 half;
+  guint64 multiplier;
+} BlurDivisor;
+
+static void
+blur_divisor_init (BlurDivisor *divisor,
+                   int          d)
+{
+  divisor->half = d / 2;
+  divisor->multiplier = ((G_GUINT64_CONSTANT (1) << BLUR_DIVISOR_SHIFT) + d - 1) / d;
+}
+
+static inline guchar
+blur_divide (guint32            sum,
+             const BlurDivisor *divisor)
+{
+  return ((sum + divisor->half) * divisor->multiplier) >> BLUR_DIVISOR_SHIFT;
+}
 
 /* This applies a single box blur pass to a horizontal range of pixels;
  * since the box blur has the same weight for all pixels, we can
@@ -65,61 +80,58 @@ static void
 blur_xspan (guchar *row,
             guchar *tmp_buffer,
             int     row_width,
+            int     n_channels,
             int     d,
             int     shift)
 {
+  BlurDivisor divisor;
+  guint32 sum[4] = { 0, };
   int offset;
-  int sum = 0;
-  int i;
+  int i, c;
 
   if (d % 2 == 1)
     offset = d / 2;
   else
     offset = (d - shift) / 2;
 
+  blur_divisor_init (&divisor, d);
+
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win.
    */
 
-#define BLUR_ROW_KERNEL(D)                                      \
-  for (i = -(D) + offset; i < row_width + offset; i++)		\
-    {                                                           \
-      if (i >= 0 && i < row_width)                              \
-        sum += row[i];                                          \
-                                                                \
-      if (i >= offset)						\
-	{							\
-	  if (i >= (D))						\
-	    sum -= row[i - (D)];				\
-                                                                \
-	  tmp_buffer[i - offset] = (sum + (D) / 2) / (D);	\
-	}							\
-    }								\
+#define BLUR_ROW_KERNEL(N)                                              \
+  for (i = -d + offset; i < row_width + offset; i++)                    \
+    {                                                                   \
+      if (i >= 0 && i < row_width)                                      \
+        for (c = 0; c < (N); c++)                                       \
+          sum[c] += row[i * (N) + c];                                   \
+                                                                        \
+      if (i >= offset)                                                  \
+        {                                                               \
+          if (i >= d)                                                   \
+            for (c = 0; c < (N); c++)                                   \
+              sum[c] -= row[(i - d) * (N) + c];                         \
+                                                                        \
+          for (c = 0; c < (N); c++)                                     \
+            tmp_buffer[(i - offset) * (N) + c] = blur_divide (sum[c], &divisor); \
+        }                                                               \
+    }                                                                   \
   break;
 
-  /* We unroll the values for d for radius 2-10 to avoid a generic
-   * divide operation (not radius 1, because its a no-op) */
-  switch (d)
+  /* Unroll the channel loop for A8 and ARGB32 */
+  switch (n_channels)
     {
-    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2);
-    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3);
-    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4);
-    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5);
-    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6);
-    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7);
-    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8);
-    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9);
-    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10);
-    default: BLUR_ROW_KERNEL (d);
+    case 1: BLUR_ROW_KERNEL (1);
+    case 4: BLUR_ROW_KERNEL (4);
+    default: g_assert_not_reached ();
     }
 
-  memcpy (row, tmp_buffer, row_width);
+#undef BLUR_ROW_KERNEL
+
+  memcpy (row, tmp_buffer, row_width * n_channels);
 }
 
 static void
@@ -127,13 +139,14 @@ blur_rows (guchar *dst_buffer,
            guchar *tmp_buffer,
            int     buffer_width,
            int     buffer_height,
+           int     n_channels,
            int     d)
 {
   int i;
 
   for (i = 0; i < buffer_height; i++)
     {
-      guchar *row = dst_buffer + i * buffer_width;
+      guchar *row = dst_buffer + i * buffer_width * n_channels;
 
       /* We want to produce a symmetric blur that spreads a pixel
        * equally far to the left and right. If d is odd that happens
@@ -143,79 +156,279 @@ blur_rows (guchar *dst_buffer,
        */
       if (d % 2 == 1)
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
         }
       else
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 1);
-          blur_xspan (row, tmp_buffer, buffer_width, d, -1);
-          blur_xspan (row, tmp_buffer, buffer_width, d + 1, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 1);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, -1);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d + 1, 0);
         }
     }
 }
 
-/* Swaps width and height.
+/* This is the vertical version of blur_xspan(). Instead of a single
+ * sum, it keeps one sum per byte of a row and slides the window over
+ * whole rows. That way all memory is accessed a row at a time, and the
+ * inner loops have no dependencies between iterations, so the compiler
+ * can vectorize them.
  */
 static void
-flip_buffer (guchar *dst_buffer,
-             guchar *src_buffer,
-             int     width,
-             int     height)
+blur_yspan (guchar       *dst_buffer,
+            const guchar *src_buffer,
+            guint32      *sums,
+            int           stride,
+            int           row_length,
+            int           n_rows,
+            int           d,
+            int           shift)
 {
-  /* Working in blocks increases cache efficiency, compared to reading
-   * or writing an entire column at once
-   */
-#define BLOCK_SIZE 16
-
-  int i0, j0;
-
-  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
-    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
-      {
-        int max_j = MIN(j0 + BLOCK_SIZE, height);
-        int max_i = MIN(i0 + BLOCK_SIZE, width);
-        int i, j;
-
-        for (i = i0; i < max_i; i++)
-          for (j = j0; j < max_j; j++)
-            dst_buffer[i * height + j] = src_buffer[j * width + i];
-      }
-#undef BLOCK_SIZE
+  BlurDivisor divisor;
+  int offset;
+  int i, x;
+
+  if (d % 2 == 1)
+    offset = d / 2;
+  else
+    offset = (d - shift) / 2;
+
+  blur_divisor_init (&divisor, d);
+  memset (sums, 0, row_length * sizeof (guint32));
+
+  for (i = 0; i < n_rows + offset; i++)
+    {
+      if (i < n_rows)
+        {
+          const guchar *in = src_buffer + i * stride;
+
+          for (x = 0; x < row_length; x++)
+            sums[x] += in[x];
+        }
+
+      if (i >= offset)
+        {
+          guchar *out = dst_buffer + (i - offset) * stride;
+
+          if (i >= d)
+            {
+              const guchar *in = src_buffer + (i - d) * stride;
+
+              for (x = 0; x < row_length; x++)
+                sums[x] -= in[x];
+            }
+
+          for (x = 0; x < row_length; x++)
+            out[x] = blur_divide (sums[x], &divisor);
+        }
+    }
+}
+
+static void
+blur_columns (guchar *buffer,
+              guchar *tmp_buffer,
+              int     stride,
+              int     row_length,
+              int     n_rows,
+              int     d)
+{
+  guint32 *sums;
+  int i;
+
+  sums = g_new (guint32, row_length);
+
+  /* See blur_rows() */
+  if (d % 2 == 1)
+    {
+      blur_yspan (tmp_buffer, buffer, sums, stride, row_length, n_rows, d, 0);
+      blur_yspan (buffer, tmp_buffer, sums, stride, row_length, n_rows, d, 0);
+      blur_yspan (tmp_buffer, buffer, sums, stride, row_length, n_rows, d, 0);
+    }
+  else
+    {
+      blur_yspan (tmp_buffer, buffer, sums, stride, row_length, n_rows, d, 1);
+      blur_yspan (buffer, tmp_buffer, sums, stride, row_length, n_rows, d, -1);
+      blur_yspan (tmp_buffer, buffer, sums, stride, row_length, n_rows, d + 1, 0);
+    }
+
+  for (i = 0; i < n_rows; i++)
+    memcpy (buffer + i * stride, tmp_buffer + i * stride, row_length);
+
+  g_free (sums);
+}
+
+/* Surfaces with at least this many bytes are blurred by several
+ * threads. Below that, the cost of waking up the threads is about
+ * as big as what they save.
+ */
+#define BLUR_THREAD_THRESHOLD (512 * 512)
+#define MAX_BLUR_JOBS 8
+
+/* A pass over a surface, split into n_jobs jobs. The horizontal pass
+ * is split into ranges of rows, the vertical one into ranges of
+ * columns, so that the jobs never touch the same pixels.
+ */
+typedef struct {
+  guchar *buffer;
+  guchar *tmp_buffer;
+  int stride;
+  int height;
+  int n_channels;
+  int d;
+  GskBlurFlags direction;
+  guint n_jobs;
+
+  guint n_pending;
+  GMutex lock;
+  GCond cond;
+} BlurTask;
+
+typedef struct {
+  BlurTask *task;
+  guint index;
+} BlurJob;
+
+static void
+blur_task_run_job (BlurTask *task,
+                   guint     index)
+{
+  if (task->direction == GSK_BLUR_X)
+    {
+      int start = (gint64) task->height * index / task->n_jobs;
+      int end = (gint64) task->height * (index + 1) / task->n_jobs;
+      guchar *tmp_buffer;
+
+      tmp_buffer = g_malloc (task->stride);
+      blur_rows (task->buffer + start * task->stride, tmp_buffer,
+                 task->stride / task->n_channels, end - start,
+                 task->n_channels, task->d);
+      g_free (tmp_buffer);
+    }
+  else
+    {
+      /* Split on cache lines, so that the jobs never write to the same ones */
+      int n_lines = (task->stride + 63) / 64;
+      int start = MIN (task->stride, n_lines * index / task->n_jobs * 64);
+      int end = MIN (task->stride, n_lines * (index + 1) / task->n_jobs * 64);
+
+      /* Channels don't matter here, every byte is blurred with the
+       * bytes above and below it */
+      blur_columns (task->buffer + start, task->tmp_buffer + start,
+                    task->stride, end - start, task->height, task->d);
+    }
+}
+
+static void
+blur_thread_func (gpointer data,
+                  gpointer unused)
+{
+  BlurJob *job = data;
+  BlurTask *task = job->task;
+
+  blur_task_run_job (task, job->index);
+
+  g_mutex_lock (&task->lock);
+  task->n_pending--;
+  if (task->n_pending == 0)
+    g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->lock);
+}
+
+static GThreadPool *
+get_blur_thread_pool (void)
+{
+  static gsize initialized = 0;
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&initialized))
+    {
+      if (g_get_num_processors () > 1)
+        pool = g_thread_pool_new (blur_thread_func,
+                                  NULL,
+                                  MIN (g_get_num_processors (), MAX_BLUR_JOBS) - 1,
+                                  FALSE,
+                                  NULL);
+      g_once_init_leave (&initialized, 1);
+    }
+
+  return pool;
+}
+
+static void
+blur_task_run (BlurTask *task)
+{
+  GThreadPool *pool;
+  BlurJob *jobs;
+  guint i;
+
+  pool = task->n_jobs > 1 ? get_blur_thread_pool () : NULL;
+  if (pool == NULL)
+    {
+      for (i = 0; i < task->n_jobs; i++)
+        blur_task_run_job (task, i);
+      return;
+    }
+
+  jobs = g_newa (BlurJob, task->n_jobs);
+  task->n_pending = task->n_jobs - 1;
+
+  /* The calling thread does the first job itself */
+  for (i = 1; i < task->n_jobs; i++)
+    {
+      jobs[i].task = task;
+      jobs[i].index = i;
+      g_thread_pool_push (pool, &jobs[i], NULL);
+    }
+
+  blur_task_run_job (task, 0);
+
+  g_mutex_lock (&task->lock);
+  while (task->n_pending > 0)
+    g_cond_wait (&task->cond, &task->lock);
+  g_mutex_unlock (&task->lock);
 }
 
 static void
 _boxblur (guchar      *buffer,
-          int          width,
+          int          stride,
           int          height,
+          int          n_channels,
           int          radius,
           GskBlurFlags flags)
 {
-  guchar *flipped_buffer;
-  int d = get_box_filter_size (radius);
+  BlurTask task = { 0, };
 
-  flipped_buffer = g_malloc (width * height);
+  task.buffer = buffer;
+  task.stride = stride;
+  task.height = height;
+  task.n_channels = n_channels;
+  task.d = get_box_filter_size (radius);
 
-  if (flags & GSK_BLUR_Y)
-    {
-      /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
+  if ((gint64) stride * height >= BLUR_THREAD_THRESHOLD)
+    task.n_jobs = CLAMP (g_get_num_processors (), 1, MIN (height, MAX_BLUR_JOBS));
+  else
+    task.n_jobs = 1;
 
-      /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
+  g_mutex_init (&task.lock);
+  g_cond_init (&task.cond);
 
-      /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+  if (flags & GSK_BLUR_Y)
+    {
+      task.tmp_buffer = g_malloc (stride * height);
+      task.direction = GSK_BLUR_Y;
+      blur_task_run (&task);
+      g_clear_pointer (&task.tmp_buffer, g_free);
     }
 
   if (flags & GSK_BLUR_X)
     {
-      /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
+      task.direction = GSK_BLUR_X;
+      blur_task_run (&task);
     }
 
-  g_free (flipped_buffer);
+  g_mutex_clear (&task.lock);
+  g_cond_clear (&task.cond);
 }
 
 /*
@@ -223,7 +436,9 @@ _boxblur (guchar      *buffer,
  * @surface: a cairo image surface.
  * @radius: the blur radius.
  *
- * Blurs the cairo image surface at the given radius.
+ * Blurs the cairo image surface at the given radius. The surface
+ * must be in %CAIRO_FORMAT_A8 or %CAIRO_FORMAT_ARGB32; the channels
+ * of ARGB32 surfaces are blurred separately.
  */
 void
 gsk_cairo_blur_surface (cairo_surface_t* surface,
@@ -231,10 +446,13 @@ gsk_cairo_blur_surface (cairo_surface_t* surface,
                         GskBlurFlags     flags)
 {
   int radius = radius_d;
+  cairo_format_t format;
 
   g_return_if_fail (surface != NULL);
   g_return_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
-  g_return_if_fail (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8);
+
+  format = cairo_image_surface_get_format (surface);
+  g_return_if_fail (format == CAIRO_FORMAT_A8 || format == CAIRO_FORMAT_ARGB32);
 
   /* The code doesn't actually do any blurring for radius 1, as it
    * ends up with box filter size 1 */
@@ -250,6 +468,7 @@ gsk_cairo_blur_surface (cairo_surface_t* surface,
   _boxblur (cairo_image_surface_get_data (surface),
             cairo_image_surface_get_stride (surface),
             cairo_image_surface_get_height (surface),
+            format == CAIRO_FORMAT_A8 ? 1 : 4,
             radius, flags);
 
   /* Inform cairo we altered the surface contents. */
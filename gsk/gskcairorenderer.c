@@ -7,6 +7,12 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <stdlib.h>
+
+/* in units of the cairo context we draw to */
+#define TILE_SIZE 256
+#define MAX_THREADS 16
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark cpu_time;
@@ -14,10 +20,29 @@ typedef struct {
 } ProfileTimers;
 #endif
 
+typedef struct {
+  GskRenderNode *root;
+  cairo_rectangle_int_t area;
+  double x_scale, y_scale;
+  cairo_surface_t *surface;
+} Tile;
+
 struct _GskCairoRenderer
 {
   GskRenderer parent_instance;
 
+  /* if set, the frame is split into tiles that are drawn in parallel */
+  GThreadPool *tile_threads;
+  GMutex tile_lock;
+  GCond tile_cond;
+  guint n_pending_tiles;
+
+  /* A copy of what we drew last, and the part of it that is still
+   * up to date, so we only need to draw what changed.
+   */
+  cairo_surface_t *frame;
+  cairo_region_t *frame_valid;
+
 #ifdef G_ENABLE_DEBUG
   ProfileTimers profile_timers;
 #endif
@@ -30,27 +55,166 @@ struct _GskCairoRendererClass
 
 G_DEFINE_TYPE (GskCairoRenderer, gsk_cairo_renderer, GSK_TYPE_RENDERER)
 
+static void
+gsk_cairo_renderer_draw_tile (gpointer data,
+                              gpointer user_data)
+{
+  GskCairoRenderer *self = user_data;
+  Tile *tile = data;
+  cairo_t *cr;
+
+  tile->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                              ceil (tile->area.width * tile->x_scale),
+                                              ceil (tile->area.height * tile->y_scale));
+  cairo_surface_set_device_scale (tile->surface, tile->x_scale, tile->y_scale);
+
+  cr = cairo_create (tile->surface);
+  cairo_translate (cr, - tile->area.x, - tile->area.y);
+  cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+  cairo_clip (cr);
+
+  gsk_render_node_draw (tile->root, cr);
+
+  cairo_destroy (cr);
+
+  g_mutex_lock (&self->tile_lock);
+  self->n_pending_tiles--;
+  if (self->n_pending_tiles == 0)
+    g_cond_signal (&self->tile_cond);
+  g_mutex_unlock (&self->tile_lock);
+}
+
+/* Draws @root in tiles of @area on the tile threads, then composites
+ * the tiles onto @cr. As tiles start out transparent and nodes are
+ * composited OVER what is below them, this gives the same result as
+ * drawing to @cr directly.
+ */
+static void
+gsk_cairo_renderer_draw_tiled (GskCairoRenderer      *self,
+                               cairo_t               *cr,
+                               GskRenderNode         *root,
+                               const cairo_region_t  *region)
+{
+  cairo_rectangle_int_t extents, rect;
+  cairo_region_t *tile_region;
+  double x_scale, y_scale;
+  GArray *tiles;
+  int x, y, i;
+
+  cairo_surface_get_device_scale (cairo_get_target (cr), &x_scale, &y_scale);
+  cairo_region_get_extents (region, &extents);
+
+  tiles = g_array_new (FALSE, FALSE, sizeof (Tile));
+
+  for (y = extents.y; y < extents.y + extents.height; y += TILE_SIZE)
+    for (x = extents.x; x < extents.x + extents.width; x += TILE_SIZE)
+      {
+        Tile tile;
+
+        rect.x = x;
+        rect.y = y;
+        rect.width = MIN (TILE_SIZE, extents.x + extents.width - x);
+        rect.height = MIN (TILE_SIZE, extents.y + extents.height - y);
+
+        /* only draw the part of the tile that needs it */
+        tile_region = cairo_region_create_rectangle (&rect);
+        cairo_region_intersect (tile_region, region);
+        if (cairo_region_is_empty (tile_region))
+          {
+            cairo_region_destroy (tile_region);
+            continue;
+          }
+        cairo_region_get_extents (tile_region, &tile.area);
+        cairo_region_destroy (tile_region);
+
+        tile.root = root;
+        tile.x_scale = x_scale;
+        tile.y_scale = y_scale;
+        tile.surface = NULL;
+        g_array_append_val (tiles, tile);
+      }
+
+  self->n_pending_tiles = tiles->len;
+  for (i = 0; i < tiles->len; i++)
+    g_thread_pool_push (self->tile_threads, &g_array_index (tiles, Tile, i), NULL);
+
+  g_mutex_lock (&self->tile_lock);
+  while (self->n_pending_tiles > 0)
+    g_cond_wait (&self->tile_cond, &self->tile_lock);
+  g_mutex_unlock (&self->tile_lock);
+
+  for (i = 0; i < tiles->len; i++)
+    {
+      Tile *tile = &g_array_index (tiles, Tile, i);
+
+      cairo_save (cr);
+      cairo_rectangle (cr, tile->area.x, tile->area.y, tile->area.width, tile->area.height);
+      cairo_clip (cr);
+      cairo_set_source_surface (cr, tile->surface, tile->area.x, tile->area.y);
+      cairo_paint (cr);
+      cairo_restore (cr);
+
+      cairo_surface_destroy (tile->surface);
+    }
+
+  g_array_unref (tiles);
+}
+
 static gboolean
 gsk_cairo_renderer_realize (GskRenderer  *renderer,
                             GdkWindow    *window,
                             GError      **error)
 {
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+  const char *env;
+  int n_threads = 1;
+
+  env = g_getenv ("GSK_CAIRO_THREADS");
+  if (env != NULL)
+    {
+      n_threads = atoi (env);
+      if (n_threads <= 0)
+        n_threads = g_get_num_processors ();
+      n_threads = MIN (n_threads, MAX_THREADS);
+    }
+
+  if (n_threads > 1)
+    {
+      GSK_RENDERER_NOTE (renderer, CAIRO, g_message ("Drawing tiles with %d threads", n_threads));
+
+      self->tile_threads = g_thread_pool_new (gsk_cairo_renderer_draw_tile,
+                                              self,
+                                              n_threads,
+                                              FALSE,
+                                              NULL);
+    }
+
   return TRUE;
 }
 
 static void
 gsk_cairo_renderer_unrealize (GskRenderer *renderer)
 {
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+
+  if (self->tile_threads)
+    {
+      g_thread_pool_free (self->tile_threads, FALSE, TRUE);
+      self->tile_threads = NULL;
+    }
 
+  g_clear_pointer (&self->frame, cairo_surface_destroy);
+  g_clear_pointer (&self->frame_valid, cairo_region_destroy);
 }
 
 static void
-gsk_cairo_renderer_do_render (GskRenderer   *renderer,
-                              cairo_t       *cr,
-                              GskRenderNode *root)
+gsk_cairo_renderer_do_render (GskRenderer          *renderer,
+                              cairo_t              *cr,
+                              GskRenderNode        *root,
+                              const cairo_region_t *region)
 {
-#ifdef G_ENABLE_DEBUG
   GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
+#ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
 #endif
@@ -60,7 +224,10 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (self->tile_threads && region)
+    gsk_cairo_renderer_draw_tiled (self, cr, root, region);
+  else
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -77,6 +244,7 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
 {
   GdkTexture *texture;
   cairo_surface_t *surface;
+  cairo_region_t *region;
   cairo_t *cr;
 
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, ceil (viewport->size.width), ceil (viewport->size.height));
@@ -84,7 +252,14 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
 
   cairo_translate (cr, - viewport->origin.x, - viewport->origin.y);
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  region = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                              floor (viewport->origin.x),
+                                              floor (viewport->origin.y),
+                                              ceil (viewport->size.width),
+                                              ceil (viewport->size.height)
+                                          });
+  gsk_cairo_renderer_do_render (renderer, cr, root, region);
+  cairo_region_destroy (region);
 
   cairo_destroy (cr);
 
@@ -94,13 +269,82 @@ gsk_cairo_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+/* The drawing context starts out cleared every frame, so we draw into
+ * our own copy of the window and only redraw the parts of it that were
+ * damaged since we drew them.
+ */
+static void
+gsk_cairo_renderer_update_frame (GskCairoRenderer     *self,
+                                 cairo_t              *cr,
+                                 GskRenderNode        *root,
+                                 const cairo_region_t *region)
+{
+  GskRenderer *renderer = GSK_RENDERER (self);
+  GdkWindow *window = gsk_renderer_get_window (renderer);
+  cairo_region_t *damage = gsk_renderer_get_damage (renderer);
+  cairo_region_t *redraw;
+  int width, height;
+  double x_scale, y_scale, frame_x_scale = 1, frame_y_scale = 1;
+  cairo_t *frame_cr;
+
+  width = gdk_window_get_width (window);
+  height = gdk_window_get_height (window);
+  cairo_surface_get_device_scale (cairo_get_target (cr), &x_scale, &y_scale);
+
+  if (self->frame)
+    cairo_surface_get_device_scale (self->frame, &frame_x_scale, &frame_y_scale);
+
+  if (self->frame == NULL ||
+      cairo_image_surface_get_width (self->frame) != ceil (width * x_scale) ||
+      cairo_image_surface_get_height (self->frame) != ceil (height * y_scale) ||
+      frame_x_scale != x_scale || frame_y_scale != y_scale)
+    {
+      g_clear_pointer (&self->frame, cairo_surface_destroy);
+      self->frame = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                ceil (width * x_scale),
+                                                ceil (height * y_scale));
+      cairo_surface_set_device_scale (self->frame, x_scale, y_scale);
+      g_clear_pointer (&self->frame_valid, cairo_region_destroy);
+    }
+
+  if (self->frame_valid == NULL)
+    self->frame_valid = cairo_region_create ();
+  else if (damage == NULL)
+    cairo_region_subtract (self->frame_valid, self->frame_valid);
+  else
+    cairo_region_subtract (self->frame_valid, damage);
+
+  redraw = cairo_region_copy (region);
+  cairo_region_subtract (redraw, self->frame_valid);
+
+  if (!cairo_region_is_empty (redraw))
+    {
+      frame_cr = cairo_create (self->frame);
+      gdk_cairo_region (frame_cr, redraw);
+      cairo_clip (frame_cr);
+      cairo_set_operator (frame_cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (frame_cr);
+      cairo_set_operator (frame_cr, CAIRO_OPERATOR_OVER);
+
+      gsk_cairo_renderer_do_render (renderer, frame_cr, root, redraw);
+
+      cairo_destroy (frame_cr);
+
+      cairo_region_union (self->frame_valid, redraw);
+    }
+
+  cairo_region_destroy (redraw);
+}
+
 static void
 gsk_cairo_renderer_render (GskRenderer   *renderer,
                            GskRenderNode *root)
 {
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (renderer);
   GdkDrawingContext *context = gsk_renderer_get_drawing_context (renderer);
   GdkWindow *window = gsk_renderer_get_window (renderer);
 
+  cairo_region_t *region;
   cairo_t *cr;
 
   cr = gdk_drawing_context_get_cairo_context (context);
@@ -121,13 +365,43 @@ gsk_cairo_renderer_render (GskRenderer   *renderer,
     }
 #endif
 
-  gsk_cairo_renderer_do_render (renderer, cr, root);
+  region = gdk_drawing_context_get_clip (context);
+  if (region == NULL)
+    {
+      gsk_cairo_renderer_do_render (renderer, cr, root, NULL);
+      return;
+    }
+
+  gsk_cairo_renderer_update_frame (self, cr, root, region);
+
+  cairo_save (cr);
+  gdk_cairo_region (cr, region);
+  cairo_clip (cr);
+  cairo_set_source_surface (cr, self->frame, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  cairo_region_destroy (region);
+}
+
+static void
+gsk_cairo_renderer_finalize (GObject *gobject)
+{
+  GskCairoRenderer *self = GSK_CAIRO_RENDERER (gobject);
+
+  g_mutex_clear (&self->tile_lock);
+  g_cond_clear (&self->tile_cond);
+
+  G_OBJECT_CLASS (gsk_cairo_renderer_parent_class)->finalize (gobject);
 }
 
 static void
 gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 {
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gsk_cairo_renderer_finalize;
 
   renderer_class->realize = gsk_cairo_renderer_realize;
   renderer_class->unrealize = gsk_cairo_renderer_unrealize;
@@ -138,6 +412,9 @@ gsk_cairo_renderer_class_init (GskCairoRendererClass *klass)
 static void
 gsk_cairo_renderer_init (GskCairoRenderer *self)
 {
+  g_mutex_init (&self->tile_lock);
+  g_cond_init (&self->tile_cond);
+
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
 
@@ -14,7 +14,9 @@ static const GDebugKey gsk_debug_keys[] = {
   { "full-redraw", GSK_DEBUG_FULL_REDRAW},
   { "sync", GSK_DEBUG_SYNC },
   { "vulkan-staging-image", GSK_DEBUG_VULKAN_STAGING_IMAGE },
-  { "vulkan-staging-buffer", GSK_DEBUG_VULKAN_STAGING_BUFFER }
+  { "vulkan-staging-buffer", GSK_DEBUG_VULKAN_STAGING_BUFFER },
+  { "gpu-times", GSK_DEBUG_GPU_TIMES },
+  { "no-optimize", GSK_DEBUG_NO_OPTIMIZE }
 };
 #endif
 
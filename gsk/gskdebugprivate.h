@@ -19,10 +19,12 @@ typedef enum {
   GSK_DEBUG_FULL_REDRAW           = 1 <<  9,
   GSK_DEBUG_SYNC                  = 1 << 10,
   GSK_DEBUG_VULKAN_STAGING_IMAGE  = 1 << 11,
-  GSK_DEBUG_VULKAN_STAGING_BUFFER = 1 << 12
+  GSK_DEBUG_VULKAN_STAGING_BUFFER = 1 << 12,
+  GSK_DEBUG_GPU_TIMES             = 1 << 13,
+  GSK_DEBUG_NO_OPTIMIZE           = 1 << 14
 } GskDebugFlags;
 
-#define GSK_DEBUG_ANY ((1 << 13) - 1)
+#define GSK_DEBUG_ANY ((1 << 15) - 1)
 
 GskDebugFlags gsk_get_debug_flags (void);
 void          gsk_set_debug_flags (GskDebugFlags flags);
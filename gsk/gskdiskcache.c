@@ -0,0 +1,117 @@
+#include "config.h"
+
+#include "gskdiskcacheprivate.h"
+
+#include "gskdebugprivate.h"
+
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <string.h>
+
+/* A per-user cache for compiled shader programs and pipelines.
+ *
+ * Entries are stored in $XDG_CACHE_HOME/gtk-4.0/gsk/<kind>/<key>, where
+ * the key is a hash of everything that influences the cached data, like
+ * the driver and the shader sources. Failing to read or write entries
+ * is not an error; we just compile from source again.
+ */
+
+static char *
+get_cache_path (const char *kind,
+                const char *key)
+{
+  return g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "gsk", kind, key, NULL);
+}
+
+/*< private >
+ * gsk_disk_cache_compute_key:
+ * @first_string: the first string to include in the key
+ * @...: more strings, followed by %NULL
+ *
+ * Computes a key for the cache from a list of strings.
+ *
+ * Returns: (transfer full): the key
+ */
+char *
+gsk_disk_cache_compute_key (const char *first_string,
+                            ...)
+{
+  GChecksum *checksum;
+  const char *s;
+  char *key;
+  va_list args;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  va_start (args, first_string);
+  for (s = first_string; s != NULL; s = va_arg (args, const char *))
+    {
+      /* include the nul, so that the strings can't run into each other */
+      g_checksum_update (checksum, (const guchar *) s, strlen (s) + 1);
+    }
+  va_end (args);
+
+  key = g_strdup (g_checksum_get_string (checksum));
+  g_checksum_free (checksum);
+
+  return key;
+}
+
+GBytes *
+gsk_disk_cache_load (const char *kind,
+                     const char *key)
+{
+  GError *error = NULL;
+  char *path;
+  char *data;
+  gsize size;
+
+  path = get_cache_path (kind, key);
+
+  if (!g_file_get_contents (path, &data, &size, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        GSK_NOTE (SHADERS, g_message ("Failed to load %s: %s", path, error->message));
+
+      g_error_free (error);
+      g_free (path);
+      return NULL;
+    }
+
+  GSK_NOTE (SHADERS, g_message ("Loaded %lu bytes from %s", (gulong) size, path));
+  g_free (path);
+
+  return g_bytes_new_take (data, size);
+}
+
+void
+gsk_disk_cache_save (const char    *kind,
+                     const char    *key,
+                     gconstpointer  data,
+                     gsize          size)
+{
+  GError *error = NULL;
+  char *path, *dir;
+
+  path = get_cache_path (kind, key);
+  dir = g_path_get_dirname (path);
+
+  if (g_mkdir_with_parents (dir, 0700) != 0)
+    {
+      GSK_NOTE (SHADERS, g_message ("Failed to create %s: %s", dir, g_strerror (errno)));
+      goto out;
+    }
+
+  if (!g_file_set_contents (path, data, size, &error))
+    {
+      GSK_NOTE (SHADERS, g_message ("Failed to save %s: %s", path, error->message));
+      g_error_free (error);
+      goto out;
+    }
+
+  GSK_NOTE (SHADERS, g_message ("Saved %lu bytes to %s", (gulong) size, path));
+
+out:
+  g_free (dir);
+  g_free (path);
+}
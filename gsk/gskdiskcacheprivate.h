@@ -0,0 +1,20 @@
+#ifndef __GSK_DISK_CACHE_PRIVATE_H__
+#define __GSK_DISK_CACHE_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+char *          gsk_disk_cache_compute_key      (const char    *first_string,
+                                                 ...) G_GNUC_NULL_TERMINATED;
+
+GBytes *        gsk_disk_cache_load             (const char    *kind,
+                                                 const char    *key);
+void            gsk_disk_cache_save             (const char    *kind,
+                                                 const char    *key,
+                                                 gconstpointer  data,
+                                                 gsize          size);
+
+G_END_DECLS
+
+#endif /* __GSK_DISK_CACHE_PRIVATE_H__ */
@@ -0,0 +1,802 @@
+#include "config.h"
+
+#include "gskglyphcacheprivate.h"
+
+#include "gskdebugprivate.h"
+#include "gskprivate.h"
+
+#include "gdk/gdkmemorystatsprivate.h"
+
+#include <graphene.h>
+#include <cairo/cairo.h>
+#include <math.h>
+
+/* The glyph cache is shared between all renderers of a display. It takes
+ * care of rasterizing glyphs and packing them into atlases, and keeps a
+ * list of the areas of every atlas that changed, so that each renderer
+ * can bring its own copy of an atlas up to date before using it.
+ */
+
+/* Parameters for our cache eviction strategy.
+ *
+ * Each cached glyph has an age that gets reset every time a cached glyph gets used.
+ * Every CHECK_INTERVAL frames, glyphs that have not been used for MAX_AGE frames
+ * are dropped from the cache, and the space they took up in their atlas is given
+ * back, so it can be reused for other glyphs. Atlases that end up empty are dropped.
+ */
+
+#define MAX_AGE 60
+#define CHECK_INTERVAL 10
+
+/* The renderers of all windows call gsk_glyph_cache_begin_frame() for each
+ * of their frames, and windows tend to draw during the same frame clock
+ * tick. Frames that begin less than FRAME_INTERVAL apart only count once,
+ * so glyphs don't age faster the more windows are drawing.
+ */
+#define FRAME_INTERVAL (G_USEC_PER_SEC / 120)
+
+/* Glyphs are packed into shelves, which are rows of glyphs whose height
+ * rounds up to the same multiple of SHELF_HEIGHT_ALIGN. The first atlas is
+ * INITIAL_ATLAS_SIZE pixels wide, and every further one doubles in size,
+ * up to the maximum texture size or MAX_ATLAS_SIZE.
+ */
+
+#define SHELF_HEIGHT_ALIGN 8
+#define INITIAL_ATLAS_SIZE 512
+#define MAX_ATLAS_SIZE 4096
+
+/* Renderers that fall behind by more than this many changes upload
+ * the whole atlas.
+ */
+#define MAX_DIRTY_REGIONS 128
+
+typedef struct
+{
+  PangoFont *font;
+  PangoGlyph glyph;
+  guint phase; /* horizontal offset, in 1/GSK_GLYPH_SUBPIXEL_PHASES of a device pixel */
+  guint scale; /* times 1024 */
+} GlyphCacheKey;
+
+typedef struct
+{
+  int x;
+  int width;
+} FreeSpan;
+
+typedef struct
+{
+  int y;
+  int height;
+  int x; /* start of the unused area at the end of the shelf */
+  GArray *free_spans; /* spans given back by dropped glyphs, sorted by x */
+} GlyphShelf;
+
+typedef struct
+{
+  cairo_rectangle_int_t rect;
+  guint serial;
+} DirtyRegion;
+
+struct _GskGlyphCache
+{
+  GObject parent_instance;
+
+  GdkDisplay *display;
+
+  GHashTable *hash_table;
+  GPtrArray *atlases;
+  guint last_atlas_id;
+  int max_atlas_size;
+
+  guint64 timestamp;
+  gint64 last_frame_time;
+};
+
+struct _GskGlyphCacheClass
+{
+  GObjectClass parent_class;
+};
+
+G_DEFINE_TYPE (GskGlyphCache, gsk_glyph_cache, G_TYPE_OBJECT)
+
+static guint    glyph_cache_hash       (gconstpointer v);
+static gboolean glyph_cache_equal      (gconstpointer v1,
+                                        gconstpointer v2);
+static void     glyph_cache_key_free   (gpointer      v);
+static void     glyph_cache_value_free (gpointer      v);
+
+static void
+clear_shelf (gpointer v)
+{
+  GlyphShelf *shelf = v;
+
+  g_array_unref (shelf->free_spans);
+}
+
+static GskGlyphAtlas *
+create_atlas (GskGlyphCache *cache,
+              int            size)
+{
+  GskGlyphAtlas *atlas;
+
+  atlas = g_new0 (GskGlyphAtlas, 1);
+  atlas->id = ++cache->last_atlas_id;
+  atlas->width = size;
+  atlas->height = size;
+  atlas->y = 1;
+  atlas->shelves = g_array_new (FALSE, FALSE, sizeof (GlyphShelf));
+  g_array_set_clear_func (atlas->shelves, clear_shelf);
+  atlas->num_glyphs = 0;
+  atlas->surface = NULL;
+  atlas->dirty_regions = g_array_new (FALSE, FALSE, sizeof (DirtyRegion));
+
+  /* The surface isn't created until the first glyph is added,
+   * but that happens right away */
+  gdk_memory_stats_alloc (GDK_MEMORY_GLYPH_ATLASES, (gsize) atlas->width * atlas->height * 4);
+
+  return atlas;
+}
+
+static void
+free_atlas (gpointer v)
+{
+  GskGlyphAtlas *atlas = v;
+
+  gdk_memory_stats_free (GDK_MEMORY_GLYPH_ATLASES, (gsize) atlas->width * atlas->height * 4);
+
+  g_clear_pointer (&atlas->surface, cairo_surface_destroy);
+  g_array_unref (atlas->dirty_regions);
+  g_array_unref (atlas->shelves);
+  g_free (atlas);
+}
+
+/* Finds room for a width x height area in a shelf of the given height */
+static gboolean
+atlas_alloc (GskGlyphAtlas *atlas,
+             int            width,
+             int            height,
+             guint         *shelf_index,
+             int           *x)
+{
+  GlyphShelf new_shelf;
+  guint i, j;
+
+  for (i = 0; i < atlas->shelves->len; i++)
+    {
+      GlyphShelf *shelf = &g_array_index (atlas->shelves, GlyphShelf, i);
+
+      if (shelf->height != height)
+        continue;
+
+      for (j = 0; j < shelf->free_spans->len; j++)
+        {
+          FreeSpan *span = &g_array_index (shelf->free_spans, FreeSpan, j);
+
+          if (span->width >= width)
+            {
+              *shelf_index = i;
+              *x = span->x;
+
+              span->x += width;
+              span->width -= width;
+              if (span->width == 0)
+                g_array_remove_index (shelf->free_spans, j);
+
+              return TRUE;
+            }
+        }
+
+      if (shelf->x + width <= atlas->width)
+        {
+          *shelf_index = i;
+          *x = shelf->x;
+
+          shelf->x += width;
+
+          return TRUE;
+        }
+    }
+
+  /* start a new shelf */
+  if (atlas->y + height > atlas->height || 1 + width > atlas->width)
+    return FALSE;
+
+  new_shelf.y = atlas->y;
+  new_shelf.height = height;
+  new_shelf.x = 1 + width;
+  new_shelf.free_spans = g_array_new (FALSE, FALSE, sizeof (FreeSpan));
+  g_array_append_val (atlas->shelves, new_shelf);
+
+  atlas->y += height;
+
+  *shelf_index = atlas->shelves->len - 1;
+  *x = 1;
+
+  return TRUE;
+}
+
+static void
+atlas_free (GskGlyphAtlas *atlas,
+            guint          shelf_index,
+            int            x,
+            int            width)
+{
+  GlyphShelf *shelf = &g_array_index (atlas->shelves, GlyphShelf, shelf_index);
+  FreeSpan span = { x, width };
+  guint i;
+
+  for (i = 0; i < shelf->free_spans->len; i++)
+    {
+      if (g_array_index (shelf->free_spans, FreeSpan, i).x > x)
+        break;
+    }
+
+  /* Merge with the neighbouring spans */
+  if (i < shelf->free_spans->len)
+    {
+      const FreeSpan *next = &g_array_index (shelf->free_spans, FreeSpan, i);
+
+      if (span.x + span.width == next->x)
+        {
+          span.width += next->width;
+          g_array_remove_index (shelf->free_spans, i);
+        }
+    }
+
+  if (i > 0)
+    {
+      const FreeSpan *prev = &g_array_index (shelf->free_spans, FreeSpan, i - 1);
+
+      if (prev->x + prev->width == span.x)
+        {
+          span.x = prev->x;
+          span.width += prev->width;
+          g_array_remove_index (shelf->free_spans, i - 1);
+          i--;
+        }
+    }
+
+  if (span.x + span.width == shelf->x)
+    shelf->x = span.x;
+  else
+    g_array_insert_val (shelf->free_spans, i, span);
+
+  /* Give empty shelves at the bottom back, so that the space
+   * can be used for shelves of a different height.
+   */
+  while (atlas->shelves->len > 0)
+    {
+      shelf = &g_array_index (atlas->shelves, GlyphShelf, atlas->shelves->len - 1);
+
+      if (shelf->x != 1)
+        break;
+
+      atlas->y = shelf->y;
+      g_array_remove_index (atlas->shelves, atlas->shelves->len - 1);
+    }
+}
+
+static void
+atlas_add_dirty_region (GskGlyphAtlas               *atlas,
+                        const cairo_rectangle_int_t *rect)
+{
+  DirtyRegion region;
+
+  atlas->serial++;
+
+  /* Glyphs that get packed next to each other are uploaded together */
+  if (atlas->dirty_regions->len > 0)
+    {
+      DirtyRegion *last = &g_array_index (atlas->dirty_regions, DirtyRegion, atlas->dirty_regions->len - 1);
+
+      if (last->rect.y == rect->y &&
+          last->rect.height == rect->height &&
+          last->rect.x + last->rect.width == rect->x)
+        {
+          last->rect.width += rect->width;
+          last->serial = atlas->serial;
+          return;
+        }
+    }
+
+  if (atlas->dirty_regions->len == MAX_DIRTY_REGIONS)
+    {
+      guint n_dropped = MAX_DIRTY_REGIONS / 2;
+
+      atlas->dropped_serial = g_array_index (atlas->dirty_regions, DirtyRegion, n_dropped - 1).serial;
+      g_array_remove_range (atlas->dirty_regions, 0, n_dropped);
+    }
+
+  region.rect = *rect;
+  region.serial = atlas->serial;
+  g_array_append_val (atlas->dirty_regions, region);
+}
+
+static int
+get_atlas_size (GskGlyphCache *cache,
+                int            min_size)
+{
+  int size;
+  guint i;
+
+  size = INITIAL_ATLAS_SIZE;
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      GskGlyphAtlas *atlas = g_ptr_array_index (cache->atlases, i);
+
+      size = MAX (size, atlas->width * 2);
+    }
+
+  while (size < min_size)
+    size *= 2;
+
+  return MIN (size, cache->max_atlas_size);
+}
+
+static void
+gsk_glyph_cache_init (GskGlyphCache *cache)
+{
+  cache->hash_table = g_hash_table_new_full (glyph_cache_hash, glyph_cache_equal,
+                                             glyph_cache_key_free, glyph_cache_value_free);
+  cache->atlases = g_ptr_array_new_with_free_func (free_atlas);
+  cache->max_atlas_size = MAX_ATLAS_SIZE;
+}
+
+static void
+gsk_glyph_cache_finalize (GObject *object)
+{
+  GskGlyphCache *cache = GSK_GLYPH_CACHE (object);
+
+  g_object_set_data (G_OBJECT (cache->display), "gsk-glyph-cache", NULL);
+
+  g_hash_table_unref (cache->hash_table);
+  g_ptr_array_unref (cache->atlases);
+
+  G_OBJECT_CLASS (gsk_glyph_cache_parent_class)->finalize (object);
+}
+
+static void
+gsk_glyph_cache_class_init (GskGlyphCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gsk_glyph_cache_finalize;
+}
+
+static gboolean
+glyph_cache_equal (gconstpointer v1, gconstpointer v2)
+{
+  const GlyphCacheKey *key1 = v1;
+  const GlyphCacheKey *key2 = v2;
+
+  return key1->font == key2->font &&
+         key1->glyph == key2->glyph &&
+         key1->phase == key2->phase &&
+         key1->scale == key2->scale;
+}
+
+static guint
+glyph_cache_hash (gconstpointer v)
+{
+  const GlyphCacheKey *key = v;
+
+  return GPOINTER_TO_UINT (key->font) ^ key->glyph ^ (key->phase << 24) ^ key->scale;
+}
+
+static void
+glyph_cache_key_free (gpointer v)
+{
+  GlyphCacheKey *f = v;
+
+  g_object_unref (f->font);
+  g_free (f);
+}
+
+static void
+glyph_cache_value_free (gpointer v)
+{
+  g_free (v);
+}
+
+static void
+render_glyph (GskGlyphAtlas  *atlas,
+              GlyphCacheKey  *key,
+              GskCachedGlyph *value,
+              int             shelf_y,
+              int             shelf_height)
+{
+  cairo_scaled_font_t *scaled_font;
+  cairo_rectangle_int_t rect;
+  PangoGlyphString glyph_string;
+  PangoGlyphInfo glyph_info;
+  cairo_t *cr;
+  double scale;
+
+  if (atlas->surface == NULL)
+    atlas->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, atlas->width, atlas->height);
+
+  /* Include the padding, so no leftovers of dropped glyphs remain around the new one */
+  rect.x = value->atlas_x;
+  rect.y = shelf_y;
+  rect.width = value->atlas_width;
+  rect.height = shelf_height;
+
+  cr = cairo_create (atlas->surface);
+
+  cairo_rectangle (cr, rect.x, rect.y, rect.width, rect.height);
+  cairo_clip (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+
+  scaled_font = pango_cairo_font_get_scaled_font ((PangoCairoFont *)key->font);
+  if (G_LIKELY (scaled_font && cairo_scaled_font_status (scaled_font) == CAIRO_STATUS_SUCCESS))
+    {
+      scale = key->scale / 1024.0;
+
+      cairo_reset_clip (cr);
+      cairo_rectangle (cr,
+                       value->atlas_x, shelf_y,
+                       value->atlas_width - 1,
+                       value->draw_height * key->scale / 1024);
+      cairo_clip (cr);
+
+      cairo_translate (cr, value->atlas_x, shelf_y);
+      cairo_scale (cr, scale, scale);
+
+      cairo_set_scaled_font (cr, scaled_font);
+      cairo_set_source_rgba (cr, 1, 1, 1, 1);
+
+      glyph_info.glyph = key->glyph;
+      glyph_info.geometry.width = value->draw_width * 1024;
+      if (key->glyph & PANGO_GLYPH_UNKNOWN_FLAG)
+        glyph_info.geometry.x_offset = 0;
+      else
+        glyph_info.geometry.x_offset = - value->draw_x * 1024;
+      glyph_info.geometry.x_offset += key->phase * 1024 / (GSK_GLYPH_SUBPIXEL_PHASES * scale);
+      glyph_info.geometry.y_offset = - value->draw_y * 1024;
+
+      glyph_string.num_glyphs = 1;
+      glyph_string.glyphs = &glyph_info;
+
+      pango_cairo_show_glyph_string (cr, key->font, &glyph_string);
+    }
+
+  cairo_destroy (cr);
+
+  atlas_add_dirty_region (atlas, &rect);
+}
+
+static void
+add_to_cache (GskGlyphCache  *cache,
+              GlyphCacheKey  *key,
+              GskCachedGlyph *value)
+{
+  GskGlyphAtlas *atlas = NULL;
+  const GlyphShelf *shelf;
+  int width = value->draw_width * key->scale / 1024;
+  int height = value->draw_height * key->scale / 1024;
+  int slot_width, shelf_height;
+  guint shelf_index;
+  int x;
+  guint i;
+
+  /* Keep a pixel of padding to the right of and below each glyph */
+  slot_width = width + 1;
+  shelf_height = (height + SHELF_HEIGHT_ALIGN) / SHELF_HEIGHT_ALIGN * SHELF_HEIGHT_ALIGN;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      atlas = g_ptr_array_index (cache->atlases, i);
+
+      if (atlas_alloc (atlas, slot_width, shelf_height, &shelf_index, &x))
+        break;
+    }
+
+  if (i == cache->atlases->len)
+    {
+      atlas = create_atlas (cache, get_atlas_size (cache, MAX (slot_width, shelf_height) + 1));
+
+      if (!atlas_alloc (atlas, slot_width, shelf_height, &shelf_index, &x))
+        {
+          GSK_NOTE (GLYPH_CACHE, g_message ("Glyph of size %dx%d does not fit into an atlas", width, height));
+          free_atlas (atlas);
+          return;
+        }
+
+      g_ptr_array_add (cache->atlases, atlas);
+    }
+
+  shelf = &g_array_index (atlas->shelves, GlyphShelf, shelf_index);
+
+  value->tx = (float)x / atlas->width;
+  value->ty = (float)shelf->y / atlas->height;
+  value->tw = (float)width / atlas->width;
+  value->th = (float)height / atlas->height;
+
+  value->atlas = atlas;
+  value->shelf = shelf_index;
+  value->atlas_x = x;
+  value->atlas_width = slot_width;
+
+  render_glyph (atlas, key, value, shelf->y, shelf->height);
+
+  atlas->num_glyphs++;
+
+#ifdef G_ENABLE_DEBUG
+  if (GSK_DEBUG_CHECK (GLYPH_CACHE))
+    {
+      g_print ("Glyph cache:\n");
+      for (i = 0; i < cache->atlases->len; i++)
+        {
+          atlas = g_ptr_array_index (cache->atlases, i);
+          g_print ("\tGskGlyphAtlas %d (%dx%d): %d glyphs, %d shelves, filled to %d\n",
+                   atlas->id, atlas->width, atlas->height,
+                   atlas->num_glyphs, atlas->shelves->len, atlas->y);
+        }
+    }
+#endif
+}
+
+/*< private >
+ * gsk_glyph_cache_ref_for_display:
+ * @display: a #GdkDisplay
+ * @max_atlas_size: the maximum size of atlases the caller can use
+ *
+ * Returns the glyph cache that is shared by all renderers of @display,
+ * creating it if needed.
+ *
+ * Returns: (transfer full): the glyph cache for @display
+ */
+GskGlyphCache *
+gsk_glyph_cache_ref_for_display (GdkDisplay *display,
+                                 int         max_atlas_size)
+{
+  GskGlyphCache *cache;
+
+  cache = g_object_get_data (G_OBJECT (display), "gsk-glyph-cache");
+  if (cache)
+    g_object_ref (cache);
+  else
+    {
+      cache = g_object_new (GSK_TYPE_GLYPH_CACHE, NULL);
+      cache->display = display;
+      g_object_set_data (G_OBJECT (display), "gsk-glyph-cache", cache);
+    }
+
+  cache->max_atlas_size = MIN (cache->max_atlas_size, max_atlas_size);
+
+  return cache;
+}
+
+/*< private >
+ * gsk_glyph_cache_snap_x:
+ * @x: the horizontal position of a glyph origin
+ * @scale: the scale factor
+ * @phase: (out): return location for the subpixel phase
+ *
+ * Snaps @x to the device pixel to its left and returns the position of that
+ * pixel. The remaining offset is quantized to one of %GSK_GLYPH_SUBPIXEL_PHASES
+ * phases, which selects the variant of the glyph to draw at the snapped position.
+ *
+ * Returns: the snapped position
+ */
+float
+gsk_glyph_cache_snap_x (float  x,
+                        float  scale,
+                        guint *phase)
+{
+  float device_x = x * scale;
+  float pixel = floorf (device_x);
+
+  *phase = (guint) roundf ((device_x - pixel) * GSK_GLYPH_SUBPIXEL_PHASES);
+  if (*phase == GSK_GLYPH_SUBPIXEL_PHASES)
+    {
+      pixel += 1;
+      *phase = 0;
+    }
+
+  return pixel / scale;
+}
+
+GskCachedGlyph *
+gsk_glyph_cache_lookup (GskGlyphCache *cache,
+                        gboolean       create,
+                        PangoFont     *font,
+                        PangoGlyph     glyph,
+                        guint          phase,
+                        float          scale)
+{
+  GlyphCacheKey lookup_key;
+  GskCachedGlyph *value;
+
+  g_assert (phase < GSK_GLYPH_SUBPIXEL_PHASES);
+
+  lookup_key.font = font;
+  lookup_key.glyph = glyph;
+  lookup_key.phase = phase;
+  lookup_key.scale = (guint)(scale * 1024);
+
+  value = g_hash_table_lookup (cache->hash_table, &lookup_key);
+
+  if (value)
+    value->timestamp = cache->timestamp;
+
+  if (create && value == NULL)
+    {
+      GlyphCacheKey *key;
+      PangoRectangle ink_rect;
+
+      key = g_new0 (GlyphCacheKey, 1);
+      value = g_new0 (GskCachedGlyph, 1);
+
+      pango_font_get_glyph_extents (font, glyph, &ink_rect, NULL);
+      pango_extents_to_pixels (&ink_rect, NULL);
+
+      value->draw_x = ink_rect.x;
+      value->draw_y = ink_rect.y;
+      value->draw_width = ink_rect.width;
+      value->draw_height = ink_rect.height;
+      /* shifted glyphs can spill into the next pixel */
+      if (phase != 0 && ink_rect.width > 0)
+        value->draw_width += 1;
+      value->timestamp = cache->timestamp;
+      value->atlas = NULL; /* For now */
+
+      key->font = g_object_ref (font);
+      key->glyph = glyph;
+      key->phase = phase;
+      key->scale = (guint)(scale * 1024);
+
+      if (ink_rect.width > 0 && ink_rect.height > 0)
+        add_to_cache (cache, key, value);
+
+      g_hash_table_insert (cache->hash_table, key, value);
+    }
+
+  return value;
+}
+
+GskGlyphAtlas *
+gsk_glyph_cache_get_atlas (GskGlyphCache *cache,
+                           guint          atlas_id)
+{
+  guint i;
+
+  for (i = 0; i < cache->atlases->len; i++)
+    {
+      GskGlyphAtlas *atlas = g_ptr_array_index (cache->atlases, i);
+
+      if (atlas->id == atlas_id)
+        return atlas;
+    }
+
+  return NULL;
+}
+
+/*< private >
+ * gsk_glyph_atlas_get_dirty_regions:
+ * @atlas: a #GskGlyphAtlas
+ * @serial: (inout): the serial of the last change that the caller uploaded,
+ *   or 0 for a new copy of the atlas
+ * @n_regions: (out): return location for the number of regions
+ *
+ * Returns the regions of @atlas that changed after @serial, pointing into
+ * the rendered glyphs, and updates @serial.
+ *
+ * Returns: (transfer container) (nullable): the regions to upload
+ */
+GskImageRegion *
+gsk_glyph_atlas_get_dirty_regions (GskGlyphAtlas *atlas,
+                                   guint         *serial,
+                                   guint         *n_regions)
+{
+  GskImageRegion *regions;
+  guchar *data;
+  gsize stride;
+  guint i, n;
+
+  *n_regions = 0;
+
+  if (*serial == atlas->serial || atlas->surface == NULL)
+    return NULL;
+
+  cairo_surface_flush (atlas->surface);
+  data = cairo_image_surface_get_data (atlas->surface);
+  stride = cairo_image_surface_get_stride (atlas->surface);
+
+  if (*serial < atlas->dropped_serial)
+    {
+      regions = g_new (GskImageRegion, 1);
+      regions[0].data = data;
+      regions[0].width = atlas->width;
+      regions[0].height = atlas->height;
+      regions[0].stride = stride;
+      regions[0].x = 0;
+      regions[0].y = 0;
+
+      *n_regions = 1;
+      *serial = atlas->serial;
+
+      return regions;
+    }
+
+  regions = g_new (GskImageRegion, atlas->dirty_regions->len);
+
+  for (i = 0, n = 0; i < atlas->dirty_regions->len; i++)
+    {
+      const DirtyRegion *dirty = &g_array_index (atlas->dirty_regions, DirtyRegion, i);
+
+      if (dirty->serial <= *serial)
+        continue;
+
+      regions[n].data = data + dirty->rect.y * stride + dirty->rect.x * 4;
+      regions[n].width = dirty->rect.width;
+      regions[n].height = dirty->rect.height;
+      regions[n].stride = stride;
+      regions[n].x = dirty->rect.x;
+      regions[n].y = dirty->rect.y;
+      n++;
+    }
+
+  *n_regions = n;
+  *serial = atlas->serial;
+
+  return regions;
+}
+
+void
+gsk_glyph_cache_begin_frame (GskGlyphCache *cache)
+{
+  int i;
+  GHashTableIter iter;
+  GlyphCacheKey *key;
+  GskCachedGlyph *value;
+  guint dropped = 0;
+  gint64 now;
+
+  now = g_get_monotonic_time ();
+  if (now - cache->last_frame_time < FRAME_INTERVAL)
+    return;
+
+  cache->last_frame_time = now;
+  cache->timestamp++;
+
+  if (cache->timestamp % CHECK_INTERVAL != 0)
+    return;
+
+  /* look for glyphs that have grown old and drop them */
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+    {
+      GskGlyphAtlas *atlas = value->atlas;
+
+      if (cache->timestamp - value->timestamp < MAX_AGE)
+        continue;
+
+      if (atlas)
+        {
+          atlas_free (atlas, value->shelf, value->atlas_x, value->atlas_width);
+          atlas->num_glyphs--;
+        }
+
+      g_hash_table_iter_remove (&iter);
+      dropped++;
+    }
+
+  /* look for atlases that are now empty */
+  for (i = cache->atlases->len - 1; i >= 0; i--)
+    {
+      GskGlyphAtlas *atlas = g_ptr_array_index (cache->atlases, i);
+
+      if (atlas->num_glyphs == 0)
+        {
+          GSK_NOTE (GLYPH_CACHE, g_message ("Dropping atlas %d (%dx%d)", atlas->id, atlas->width, atlas->height));
+
+          g_ptr_array_remove_index (cache->atlases, i);
+        }
+    }
+
+  GSK_NOTE (GLYPH_CACHE, g_message ("Dropped %d glyphs", dropped));
+}
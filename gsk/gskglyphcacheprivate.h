@@ -0,0 +1,85 @@
+#ifndef __GSK_GLYPH_CACHE_PRIVATE_H__
+#define __GSK_GLYPH_CACHE_PRIVATE_H__
+
+#include <pango/pango.h>
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+typedef struct
+{
+  guchar *data;
+  gsize width;
+  gsize height;
+  gsize stride;
+  gsize x;
+  gsize y;
+} GskImageRegion;
+
+/* Glyphs are rendered at this many horizontal offsets within a device pixel */
+#define GSK_GLYPH_SUBPIXEL_PHASES 4
+
+#define GSK_TYPE_GLYPH_CACHE (gsk_glyph_cache_get_type ())
+
+G_DECLARE_FINAL_TYPE (GskGlyphCache, gsk_glyph_cache, GSK, GLYPH_CACHE, GObject)
+
+typedef struct
+{
+  guint id;
+  int width, height;
+  int y; /* top of the area below the last shelf */
+  GArray *shelves;
+  int num_glyphs;
+
+  /* the rendered glyphs, and a list of the areas that changed */
+  cairo_surface_t *surface;
+  GArray *dirty_regions;
+  guint serial;
+  guint dropped_serial;
+} GskGlyphAtlas;
+
+typedef struct
+{
+  GskGlyphAtlas *atlas;
+
+  float tx;
+  float ty;
+  float tw;
+  float th;
+
+  int draw_x;
+  int draw_y;
+  int draw_width;
+  int draw_height;
+
+  /* location of the glyph in the atlas */
+  guint shelf;
+  int atlas_x;
+  int atlas_width;
+
+  guint64 timestamp;
+} GskCachedGlyph;
+
+GskGlyphCache *         gsk_glyph_cache_ref_for_display   (GdkDisplay     *display,
+                                                           int             max_atlas_size);
+
+void                    gsk_glyph_cache_begin_frame       (GskGlyphCache  *cache);
+float                   gsk_glyph_cache_snap_x            (float           x,
+                                                           float           scale,
+                                                           guint          *phase);
+GskCachedGlyph *        gsk_glyph_cache_lookup            (GskGlyphCache  *cache,
+                                                           gboolean        create,
+                                                           PangoFont      *font,
+                                                           PangoGlyph      glyph,
+                                                           guint           phase,
+                                                           float           scale);
+GskGlyphAtlas *         gsk_glyph_cache_get_atlas         (GskGlyphCache  *cache,
+                                                           guint           atlas_id);
+
+GskImageRegion *        gsk_glyph_atlas_get_dirty_regions (GskGlyphAtlas  *atlas,
+                                                           guint          *serial,
+                                                           guint          *n_regions);
+
+G_END_DECLS
+
+#endif /* __GSK_GLYPH_CACHE_PRIVATE_H__ */
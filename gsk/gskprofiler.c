@@ -2,6 +2,8 @@
 
 #include "gskprofilerprivate.h"
 
+#include <gdk/gdk.h>
+
 #define MAX_SAMPLES     32
 
 typedef struct {
@@ -140,7 +142,11 @@ gsk_profiler_add_counter (GskProfiler *profiler,
   counter = gsk_profiler_get_counter (profiler, id);
   if (counter != NULL)
     {
-      g_critical ("Cannot add a counter '%s' as one already exists.", counter_name);
+      /* Registering the same counter again is fine, that happens when
+       * the GL driver of a renderer is recreated on realize */
+      if (counter->can_reset != can_reset ||
+          g_strcmp0 (counter->description, description) != 0)
+        g_critical ("Cannot add a counter '%s' as one already exists.", counter_name);
       return counter->id;
     }
 
@@ -400,6 +406,50 @@ gsk_profiler_reset (GskProfiler *profiler)
   profiler->last_sample = 0;
 }
 
+/* Sends the values of this frame to the GDK trace. Timers that were
+ * measured with gsk_profiler_timer_begin() become spans on the timeline,
+ * the others (e.g. GPU times, which are only known once the GPU is done)
+ * and all counters become counter samples.
+ */
+static void
+gsk_profiler_trace_samples (GskProfiler *profiler)
+{
+  GHashTableIter iter;
+  gpointer value_p = NULL;
+  gint64 now = g_get_monotonic_time ();
+
+  g_hash_table_iter_init (&iter, profiler->counters);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    {
+      NamedCounter *counter = value_p;
+
+      gdk_profiler_set_counter (now, counter->description, counter->value);
+    }
+
+  g_hash_table_iter_init (&iter, profiler->timers);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    {
+      NamedTimer *timer = value_p;
+
+      if (timer->invert)
+        {
+          if (timer->value > 0)
+            gdk_profiler_set_counter (now, timer->description,
+                                      1000000000.0 / (double) timer->value);
+        }
+      else if (timer->start_time != 0)
+        {
+          gdk_profiler_add_mark (timer->start_time / 1000, timer->value / 1000,
+                                 timer->description, NULL);
+          timer->start_time = 0;
+        }
+      else
+        {
+          gdk_profiler_set_counter (now, timer->description, timer->value / 1000.0);
+        }
+    }
+}
+
 void
 gsk_profiler_push_samples (GskProfiler *profiler)
 {
@@ -428,6 +478,9 @@ gsk_profiler_push_samples (GskProfiler *profiler)
       else
         s->value = timer->value;
     }
+
+  if (gdk_profiler_is_running ())
+    gsk_profiler_trace_samples (profiler);
 }
 
 void
@@ -513,3 +566,48 @@ gsk_profiler_append_timers (GskProfiler *profiler,
       g_string_append (buffer, "\n");
     }
 }
+
+/* Calls @func for the current value of every counter */
+void
+gsk_profiler_foreach_counter (GskProfiler     *profiler,
+                              GskProfilerFunc  func,
+                              gpointer         user_data)
+{
+  GHashTableIter iter;
+  gpointer value_p = NULL;
+
+  g_return_if_fail (GSK_IS_PROFILER (profiler));
+  g_return_if_fail (func != NULL);
+
+  g_hash_table_iter_init (&iter, profiler->counters);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    {
+      NamedCounter *counter = value_p;
+
+      func (g_quark_to_string (counter->id), counter->description, counter->value, user_data);
+    }
+}
+
+/* Calls @func for the current value of every timer, in the units of
+ * gsk_profiler_timer_get()
+ */
+void
+gsk_profiler_foreach_timer (GskProfiler     *profiler,
+                            GskProfilerFunc  func,
+                            gpointer         user_data)
+{
+  GHashTableIter iter;
+  gpointer value_p = NULL;
+
+  g_return_if_fail (GSK_IS_PROFILER (profiler));
+  g_return_if_fail (func != NULL);
+
+  g_hash_table_iter_init (&iter, profiler->timers);
+  while (g_hash_table_iter_next (&iter, NULL, &value_p))
+    {
+      NamedTimer *timer = value_p;
+
+      func (g_quark_to_string (timer->id), timer->description,
+            gsk_profiler_timer_get (profiler, timer->id), user_data);
+    }
+}
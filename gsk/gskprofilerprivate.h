@@ -8,6 +8,11 @@ G_BEGIN_DECLS
 #define GSK_TYPE_PROFILER (gsk_profiler_get_type ())
 G_DECLARE_FINAL_TYPE (GskProfiler, gsk_profiler, GSK, PROFILER, GObject)
 
+typedef void (* GskProfilerFunc) (const char *name,
+                                  const char *description,
+                                  gint64      value,
+                                  gpointer    user_data);
+
 GskProfiler *   gsk_profiler_new                (void);
 
 GQuark          gsk_profiler_add_counter        (GskProfiler *profiler,
@@ -49,6 +54,13 @@ void            gsk_profiler_append_counters    (GskProfiler *profiler,
 void            gsk_profiler_append_timers      (GskProfiler *profiler,
                                                  GString     *buffer);
 
+void            gsk_profiler_foreach_counter    (GskProfiler     *profiler,
+                                                 GskProfilerFunc  func,
+                                                 gpointer         user_data);
+void            gsk_profiler_foreach_timer      (GskProfiler     *profiler,
+                                                 GskProfilerFunc  func,
+                                                 gpointer         user_data);
+
 G_END_DECLS
 
 #endif /* __GSK_PROFILER_PRIVATE_H__ */
@@ -72,6 +72,8 @@ typedef struct
   GdkWindow *window;
   GdkDrawingContext *drawing_context;
   GskRenderNode *root_node;
+  GskRenderNode *prev_node;
+  cairo_region_t *damage;
   GdkDisplay *display;
 
   GskProfiler *profiler;
@@ -471,9 +473,32 @@ gsk_renderer_unrealize (GskRenderer *renderer)
 
   GSK_RENDERER_GET_CLASS (renderer)->unrealize (renderer);
 
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+
   priv->is_realized = FALSE;
 }
 
+/* Returns the node that is given to the renderer implementations
+ * for rendering @root. The original node is kept as the root node,
+ * for diffing it with the next frame.
+ */
+static GskRenderNode *
+gsk_renderer_optimize_node (GskRenderer           *renderer,
+                            GskRenderNode         *root,
+                            const graphene_rect_t *viewport)
+{
+  GskRenderNode *optimized;
+
+  if (GSK_RENDERER_DEBUG_CHECK (renderer, NO_OPTIMIZE))
+    return gsk_render_node_ref (root);
+
+  optimized = gsk_render_node_optimize (root, viewport);
+  if (optimized == NULL)
+    optimized = gsk_container_node_new (NULL, 0);
+
+  return optimized;
+}
+
 /**
  * gsk_renderer_render_texture:
  * @renderer: a realized #GdkRenderer
@@ -500,6 +525,7 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
   graphene_rect_t real_viewport;
+  GskRenderNode *optimized;
   GdkTexture *texture;
 
   g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
@@ -515,7 +541,9 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
       viewport = &real_viewport;
     }
 
-  texture = GSK_RENDERER_GET_CLASS (renderer)->render_texture (renderer, root, viewport);
+  optimized = gsk_renderer_optimize_node (renderer, root, viewport);
+  texture = GSK_RENDERER_GET_CLASS (renderer)->render_texture (renderer, optimized, viewport);
+  gsk_render_node_unref (optimized);
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
@@ -549,7 +577,8 @@ gsk_renderer_render_texture (GskRenderer           *renderer,
  * using the given #GdkDrawingContext.
  *
  * The @renderer will acquire a reference on the #GskRenderNode tree while
- * the rendering is in progress.
+ * the rendering is in progress, and keeps it until the next frame, so that
+ * it only needs to redraw the parts of the tree that changed.
  *
  * Since: 3.90
  */
@@ -559,6 +588,8 @@ gsk_renderer_render (GskRenderer       *renderer,
                      GdkDrawingContext *context)
 {
   GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  graphene_rect_t viewport;
+  GskRenderNode *optimized;
 
   g_return_if_fail (GSK_IS_RENDERER (renderer));
   g_return_if_fail (priv->is_realized);
@@ -569,7 +600,21 @@ gsk_renderer_render (GskRenderer       *renderer,
 
   priv->root_node = gsk_render_node_ref (root);
 
-  GSK_RENDERER_GET_CLASS (renderer)->render (renderer, root);
+  if (priv->prev_node != NULL && !GSK_RENDERER_DEBUG_CHECK (renderer, FULL_REDRAW))
+    {
+      priv->damage = cairo_region_create ();
+      gsk_render_node_diff (priv->prev_node, root, priv->damage);
+    }
+
+  graphene_rect_init (&viewport,
+                      0, 0,
+                      gdk_window_get_width (priv->window),
+                      gdk_window_get_height (priv->window));
+  optimized = gsk_renderer_optimize_node (renderer, root, &viewport);
+
+  GSK_RENDERER_GET_CLASS (renderer)->render (renderer, optimized);
+
+  gsk_render_node_unref (optimized);
 
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
@@ -588,7 +633,35 @@ gsk_renderer_render (GskRenderer       *renderer,
     }
 #endif
 
-  g_clear_pointer (&priv->root_node, gsk_render_node_unref);
+  g_clear_pointer (&priv->damage, cairo_region_destroy);
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+  priv->prev_node = priv->root_node;
+  priv->root_node = NULL;
+}
+
+/*< private >
+ * gsk_renderer_get_damage:
+ * @renderer: a #GskRenderer
+ *
+ * Retrieves the area that changed between the render node tree that
+ * is being rendered and the one that was rendered in the previous frame.
+ *
+ * This is only valid while gsk_renderer_render() is running. Renderers
+ * can use it to limit drawing to the parts of the window that actually
+ * changed, as long as they also redraw any area that is outdated in the
+ * buffer they are drawing to.
+ *
+ * Returns: (transfer none) (nullable): the damaged region, or %NULL if
+ *   the whole drawing context clip needs to be redrawn
+ */
+cairo_region_t *
+gsk_renderer_get_damage (GskRenderer *renderer)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+
+  g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
+
+  return priv->damage;
 }
 
 /*< private >
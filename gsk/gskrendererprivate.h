@@ -63,6 +63,7 @@ gboolean gsk_renderer_is_realized (GskRenderer *renderer);
 
 GskRenderNode *         gsk_renderer_get_root_node              (GskRenderer    *renderer);
 GdkDrawingContext *     gsk_renderer_get_drawing_context        (GskRenderer    *renderer);
+cairo_region_t *        gsk_renderer_get_damage                 (GskRenderer    *renderer);
 cairo_surface_t *       gsk_renderer_create_cairo_surface       (GskRenderer    *renderer,
                                                                  cairo_format_t  format,
                                                                  int             width,
@@ -42,10 +42,15 @@
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodebinaryprivate.h"
+#include "gskroundedrectprivate.h"
+
+#include "gdk/gdkmemorystatsprivate.h"
 
 #include <graphene-gobject.h>
 
 #include <math.h>
+#include <string.h>
 
 #include <gobject/gvaluecollector.h>
 
@@ -70,7 +75,8 @@ gsk_render_node_finalize (GskRenderNode *self)
 
   g_clear_pointer (&self->name, g_free);
 
-  g_free (self);
+  gdk_memory_stats_free (GDK_MEMORY_RENDER_NODES, self->alloc_size);
+  g_slice_free1 (self->alloc_size, self);
 }
 
 /*< private >
@@ -87,15 +93,90 @@ gsk_render_node_new (const GskRenderNodeClass *node_class, gsize extra_size)
   g_return_val_if_fail (node_class != NULL, NULL);
   g_return_val_if_fail (node_class->node_type != GSK_NOT_A_RENDER_NODE, NULL);
 
-  self = g_malloc0 (node_class->struct_size + extra_size);
+  /* Snapshots create lots of small nodes each frame, and the slice
+   * allocator keeps the memory around for the next frame */
+  self = g_slice_alloc0 (node_class->struct_size + extra_size);
 
   self->node_class = node_class;
+  self->alloc_size = node_class->struct_size + extra_size;
+  gdk_memory_stats_alloc (GDK_MEMORY_RENDER_NODES, self->alloc_size);
 
   self->ref_count = 1;
 
   return self;
 }
 
+/*< private >
+ * gsk_render_node_init_hash:
+ * @node: a newly created #GskRenderNode
+ *
+ * Computes the hash of @node. Node constructors call this once all
+ * fields, including the bounds, are set up. The hashes of the children
+ * are already known at that point, so this doesn't recurse.
+ */
+void
+gsk_render_node_init_hash (GskRenderNode *node)
+{
+  guint hash;
+
+  hash = gsk_hash_combine (node->node_class->node_type, node->node_class->hash (node));
+  hash = gsk_hash_floats (hash,
+                          (float[4]) { node->bounds.origin.x, node->bounds.origin.y,
+                                       node->bounds.size.width, node->bounds.size.height },
+                          4);
+
+  node->hash = hash;
+}
+
+/*< private >
+ * gsk_render_node_hash:
+ * @node: a #GskRenderNode
+ *
+ * Gets a hash value for @node that is the same for all nodes that are
+ * equal according to gsk_render_node_equal().
+ *
+ * Returns: the hash of @node
+ */
+guint
+gsk_render_node_hash (GskRenderNode *node)
+{
+  return node->hash;
+}
+
+/*< private >
+ * gsk_render_node_equal:
+ * @node1: a #GskRenderNode
+ * @node2: another #GskRenderNode
+ *
+ * Checks whether @node1 and @node2 are structurally equal, that is
+ * whether they are of the same type, have the same properties and
+ * equal children. Textures and fonts are compared by identity.
+ *
+ * Nodes with different hashes are never equal, so this is cheap for
+ * nodes that differ.
+ *
+ * Returns: %TRUE if the nodes are equal
+ */
+gboolean
+gsk_render_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  if (node1 == node2)
+    return TRUE;
+
+  if (node1->hash != node2->hash ||
+      node1->node_class != node2->node_class)
+    return FALSE;
+
+  if (node1->bounds.origin.x != node2->bounds.origin.x ||
+      node1->bounds.origin.y != node2->bounds.origin.y ||
+      node1->bounds.size.width != node2->bounds.size.width ||
+      node1->bounds.size.height != node2->bounds.size.height)
+    return FALSE;
+
+  return node1->node_class->equal (node1, node2);
+}
+
 /**
  * gsk_render_node_ref:
  * @node: a #GskRenderNode
@@ -215,6 +296,20 @@ gsk_render_node_get_name (GskRenderNode *node)
   return node->name;
 }
 
+static gboolean
+gsk_render_node_intersects_clip (GskRenderNode *node,
+                                 cairo_t       *cr)
+{
+  double x1, y1, x2, y2;
+
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+  return node->bounds.origin.x < x2 &&
+         node->bounds.origin.y < y2 &&
+         node->bounds.origin.x + node->bounds.size.width > x1 &&
+         node->bounds.origin.y + node->bounds.size.height > y1;
+}
+
 /**
  * gsk_render_node_draw:
  * @node: a #GskRenderNode
@@ -237,6 +332,10 @@ gsk_render_node_draw (GskRenderNode *node,
   g_return_if_fail (cr != NULL);
   g_return_if_fail (cairo_status (cr) == CAIRO_STATUS_SUCCESS);
 
+  /* Skip nodes that are entirely clipped away */
+  if (!gsk_render_node_intersects_clip (node, cr))
+    return;
+
   cairo_save (cr);
 
 #ifdef G_ENABLE_DEBUG
@@ -280,6 +379,628 @@ gsk_render_node_draw (GskRenderNode *node,
     }
 }
 
+static void
+rectangle_init_from_graphene (cairo_rectangle_int_t *cairo,
+                              const graphene_rect_t *graphene)
+{
+  cairo->x = floorf (graphene->origin.x);
+  cairo->y = floorf (graphene->origin.y);
+  cairo->width = ceilf (graphene->origin.x + graphene->size.width) - cairo->x;
+  cairo->height = ceilf (graphene->origin.y + graphene->size.height) - cairo->y;
+}
+
+static void
+region_union_node_bounds (cairo_region_t *region,
+                          GskRenderNode  *node)
+{
+  cairo_rectangle_int_t r;
+
+  rectangle_init_from_graphene (&r, &node->bounds);
+  cairo_region_union_rectangle (region, &r);
+}
+
+/* Adds the area covered by @sub after transforming it with @transform */
+static void
+region_union_transformed (cairo_region_t          *region,
+                          const cairo_region_t    *sub,
+                          const graphene_matrix_t *transform)
+{
+  cairo_rectangle_int_t r;
+  graphene_rect_t bounds;
+  int i, n;
+
+  n = cairo_region_num_rectangles (sub);
+  for (i = 0; i < n; i++)
+    {
+      cairo_region_get_rectangle (sub, i, &r);
+      graphene_rect_init (&bounds, r.x, r.y, r.width, r.height);
+      graphene_matrix_transform_bounds (transform, &bounds, &bounds);
+      rectangle_init_from_graphene (&r, &bounds);
+      cairo_region_union_rectangle (region, &r);
+    }
+}
+
+/* Diffs @child1 and @child2, and adds the part of the result that
+ * is inside @clip to @region.
+ */
+static void
+gsk_render_node_diff_clipped (GskRenderNode         *child1,
+                              GskRenderNode         *child2,
+                              const graphene_rect_t *clip,
+                              cairo_region_t        *region)
+{
+  cairo_rectangle_int_t r;
+  cairo_region_t *sub;
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (child1, child2, sub);
+
+  rectangle_init_from_graphene (&r, clip);
+  cairo_region_intersect_rectangle (sub, &r);
+
+  cairo_region_union (region, sub);
+  cairo_region_destroy (sub);
+}
+
+/* Children that are equal at the start and the end are skipped. If the
+ * same number of children remains, they are diffed pairwise. Otherwise
+ * children were added or removed, and the remaining old children are
+ * matched to the new ones by their hashes, in order, so that only the
+ * ones that really changed add damage.
+ */
+static void
+gsk_container_node_diff (GskRenderNode  *node1,
+                         GskRenderNode  *node2,
+                         cairo_region_t *region)
+{
+  guint n1, n2, start, end1, end2, i, j, next;
+  GHashTable *old_children;
+  gboolean *matched;
+
+  n1 = gsk_container_node_get_n_children (node1);
+  n2 = gsk_container_node_get_n_children (node2);
+
+  for (start = 0; start < n1 && start < n2; start++)
+    {
+      if (!gsk_render_node_equal (gsk_container_node_get_child (node1, start),
+                                  gsk_container_node_get_child (node2, start)))
+        break;
+    }
+
+  end1 = n1;
+  end2 = n2;
+  while (end1 > start && end2 > start &&
+         gsk_render_node_equal (gsk_container_node_get_child (node1, end1 - 1),
+                                gsk_container_node_get_child (node2, end2 - 1)))
+    {
+      end1--;
+      end2--;
+    }
+
+  if (end1 - start == end2 - start)
+    {
+      for (i = start; i < end1; i++)
+        gsk_render_node_diff (gsk_container_node_get_child (node1, i),
+                              gsk_container_node_get_child (node2, i),
+                              region);
+      return;
+    }
+
+  /* hash => list of old child indexes, in order */
+  old_children = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_slist_free);
+  for (i = end1; i-- > start; )
+    {
+      guint hash = gsk_render_node_hash (gsk_container_node_get_child (node1, i));
+      GSList *list = g_hash_table_lookup (old_children, GUINT_TO_POINTER (hash));
+
+      g_hash_table_steal (old_children, GUINT_TO_POINTER (hash));
+      g_hash_table_insert (old_children, GUINT_TO_POINTER (hash),
+                           g_slist_prepend (list, GUINT_TO_POINTER (i)));
+    }
+
+  matched = g_new0 (gboolean, end1 - start);
+  next = start;
+
+  for (j = start; j < end2; j++)
+    {
+      GskRenderNode *child = gsk_container_node_get_child (node2, j);
+      GSList *l;
+
+      l = g_hash_table_lookup (old_children, GUINT_TO_POINTER (gsk_render_node_hash (child)));
+      for (; l; l = l->next)
+        {
+          i = GPOINTER_TO_UINT (l->data);
+          if (i >= next &&
+              gsk_render_node_equal (gsk_container_node_get_child (node1, i), child))
+            break;
+        }
+
+      if (l)
+        {
+          matched[i - start] = TRUE;
+          next = i + 1;
+        }
+      else
+        {
+          region_union_node_bounds (region, child);
+        }
+    }
+
+  for (i = start; i < end1; i++)
+    {
+      if (!matched[i - start])
+        region_union_node_bounds (region, gsk_container_node_get_child (node1, i));
+    }
+
+  g_free (matched);
+  g_hash_table_unref (old_children);
+}
+
+/*< private >
+ * gsk_render_node_diff:
+ * @node1: a #GskRenderNode
+ * @node2: the #GskRenderNode to compare with
+ * @region: a #cairo_region_t to add the differences to
+ *
+ * Compares @node1 and @node2 and adds the area where rendering them
+ * would produce different results to @region.
+ *
+ * Nodes are considered equal if gsk_render_node_equal() says so. The
+ * children of containers are aligned by their hashes, so inserting or
+ * removing a child only damages that child. Transform, clip, opacity
+ * and other nodes that only change the rendering of their children
+ * locally are compared child by child if their own properties are the
+ * same, and the damage of the children is transformed or clipped
+ * accordingly. Everything else adds the bounds of both nodes.
+ */
+void
+gsk_render_node_diff (GskRenderNode  *node1,
+                      GskRenderNode  *node2,
+                      cairo_region_t *region)
+{
+  if (gsk_render_node_equal (node1, node2))
+    return;
+
+  if (node1->node_class->node_type == node2->node_class->node_type)
+    {
+      switch (node1->node_class->node_type)
+        {
+        case GSK_CONTAINER_NODE:
+          gsk_container_node_diff (node1, node2, region);
+          return;
+
+        case GSK_CLIP_NODE:
+          {
+            const graphene_rect_t *clip = gsk_clip_node_peek_clip (node1);
+
+            if (!graphene_rect_equal (clip, gsk_clip_node_peek_clip (node2)))
+              break;
+
+            gsk_render_node_diff_clipped (gsk_clip_node_get_child (node1),
+                                          gsk_clip_node_get_child (node2),
+                                          clip,
+                                          region);
+          }
+          return;
+
+        case GSK_ROUNDED_CLIP_NODE:
+          {
+            const GskRoundedRect *clip = gsk_rounded_clip_node_peek_clip (node1);
+            const GskRoundedRect *clip2 = gsk_rounded_clip_node_peek_clip (node2);
+            float v1[12], v2[12];
+
+            gsk_rounded_rect_to_float (clip, v1);
+            gsk_rounded_rect_to_float (clip2, v2);
+            if (memcmp (v1, v2, sizeof (v1)) != 0)
+              break;
+
+            gsk_render_node_diff_clipped (gsk_rounded_clip_node_get_child (node1),
+                                          gsk_rounded_clip_node_get_child (node2),
+                                          &clip->bounds,
+                                          region);
+          }
+          return;
+
+        case GSK_TRANSFORM_NODE:
+          {
+            const graphene_matrix_t *transform = gsk_transform_node_peek_transform (node1);
+            float m1[16], m2[16];
+            cairo_region_t *sub;
+
+            graphene_matrix_to_float (transform, m1);
+            graphene_matrix_to_float (gsk_transform_node_peek_transform (node2), m2);
+            if (memcmp (m1, m2, sizeof (m1)) != 0)
+              break;
+
+            sub = cairo_region_create ();
+            gsk_render_node_diff (gsk_transform_node_get_child (node1),
+                                  gsk_transform_node_get_child (node2),
+                                  sub);
+            region_union_transformed (region, sub, transform);
+            cairo_region_destroy (sub);
+          }
+          return;
+
+        case GSK_OPACITY_NODE:
+          if (gsk_opacity_node_get_opacity (node1) != gsk_opacity_node_get_opacity (node2))
+            break;
+
+          gsk_render_node_diff (gsk_opacity_node_get_child (node1),
+                                gsk_opacity_node_get_child (node2),
+                                region);
+          return;
+
+        case GSK_COLOR_MATRIX_NODE:
+          {
+            float m1[16], m2[16], o1[4], o2[4];
+
+            graphene_matrix_to_float (gsk_color_matrix_node_peek_color_matrix (node1), m1);
+            graphene_matrix_to_float (gsk_color_matrix_node_peek_color_matrix (node2), m2);
+            graphene_vec4_to_float (gsk_color_matrix_node_peek_color_offset (node1), o1);
+            graphene_vec4_to_float (gsk_color_matrix_node_peek_color_offset (node2), o2);
+            if (memcmp (m1, m2, sizeof (m1)) != 0 ||
+                memcmp (o1, o2, sizeof (o1)) != 0)
+              break;
+
+            gsk_render_node_diff (gsk_color_matrix_node_get_child (node1),
+                                  gsk_color_matrix_node_get_child (node2),
+                                  region);
+          }
+          return;
+
+        case GSK_CROSS_FADE_NODE:
+          if (gsk_cross_fade_node_get_progress (node1) != gsk_cross_fade_node_get_progress (node2))
+            break;
+
+          gsk_render_node_diff (gsk_cross_fade_node_get_start_child (node1),
+                                gsk_cross_fade_node_get_start_child (node2),
+                                region);
+          gsk_render_node_diff (gsk_cross_fade_node_get_end_child (node1),
+                                gsk_cross_fade_node_get_end_child (node2),
+                                region);
+          return;
+
+        case GSK_BLEND_NODE:
+          if (gsk_blend_node_get_blend_mode (node1) != gsk_blend_node_get_blend_mode (node2))
+            break;
+
+          gsk_render_node_diff (gsk_blend_node_get_bottom_child (node1),
+                                gsk_blend_node_get_bottom_child (node2),
+                                region);
+          gsk_render_node_diff (gsk_blend_node_get_top_child (node1),
+                                gsk_blend_node_get_top_child (node2),
+                                region);
+          return;
+
+        default:
+          break;
+        }
+    }
+
+  region_union_node_bounds (region, node1);
+  region_union_node_bounds (region, node2);
+}
+
+static gboolean
+matrix_is_translation (const graphene_matrix_t *matrix,
+                       float                   *dx,
+                       float                   *dy)
+{
+  if (!graphene_matrix_is_2d (matrix) ||
+      graphene_matrix_get_value (matrix, 0, 0) != 1 ||
+      graphene_matrix_get_value (matrix, 0, 1) != 0 ||
+      graphene_matrix_get_value (matrix, 1, 0) != 0 ||
+      graphene_matrix_get_value (matrix, 1, 1) != 1)
+    return FALSE;
+
+  *dx = graphene_matrix_get_x_translation (matrix);
+  *dy = graphene_matrix_get_y_translation (matrix);
+
+  return TRUE;
+}
+
+/* Finds a rectangle that @node covers with opaque pixels. This only
+ * looks @depth levels deep into containers, so that calling it for
+ * every child of a container doesn't take quadratic time.
+ */
+static gboolean
+gsk_render_node_get_opaque_rect (GskRenderNode   *node,
+                                 int              depth,
+                                 graphene_rect_t *opaque)
+{
+  switch (node->node_class->node_type)
+    {
+    case GSK_COLOR_NODE:
+      if (gsk_color_node_peek_color (node)->alpha < 1)
+        return FALSE;
+
+      *opaque = node->bounds;
+      return TRUE;
+
+    case GSK_CLIP_NODE:
+      if (!gsk_render_node_get_opaque_rect (gsk_clip_node_get_child (node), depth, opaque))
+        return FALSE;
+
+      return graphene_rect_intersection (opaque, gsk_clip_node_peek_clip (node), opaque);
+
+    case GSK_TRANSFORM_NODE:
+      {
+        float dx, dy;
+
+        if (!matrix_is_translation (gsk_transform_node_peek_transform (node), &dx, &dy) ||
+            !gsk_render_node_get_opaque_rect (gsk_transform_node_get_child (node), depth, opaque))
+          return FALSE;
+
+        graphene_rect_offset (opaque, dx, dy);
+      }
+      return TRUE;
+
+    case GSK_CONTAINER_NODE:
+      {
+        gboolean result = FALSE;
+        guint i;
+
+        if (depth <= 0)
+          return FALSE;
+
+        for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+          {
+            graphene_rect_t child_opaque;
+
+            if (!gsk_render_node_get_opaque_rect (gsk_container_node_get_child (node, i),
+                                                  depth - 1,
+                                                  &child_opaque))
+              continue;
+
+            if (!result ||
+                child_opaque.size.width * child_opaque.size.height >
+                opaque->size.width * opaque->size.height)
+              *opaque = child_opaque;
+            result = TRUE;
+          }
+
+        return result;
+      }
+
+    default:
+      return FALSE;
+    }
+}
+
+static GskRenderNode *
+gsk_container_node_optimize (GskRenderNode         *node,
+                             const graphene_rect_t *clip)
+{
+  guint n_children = gsk_container_node_get_n_children (node);
+  GskRenderNode **children;
+  graphene_rect_t opaque;
+  gboolean has_opaque = FALSE;
+  gboolean changed = FALSE;
+  GskRenderNode *result;
+  guint i, n;
+
+  children = g_new (GskRenderNode *, n_children);
+  n = n_children;
+
+  /* Go from the top, so that we know what covers the lower children */
+  for (i = n_children; i-- > 0; )
+    {
+      GskRenderNode *child = gsk_container_node_get_child (node, i);
+      GskRenderNode *optimized;
+      graphene_rect_t child_opaque;
+
+      if (has_opaque && graphene_rect_contains_rect (&opaque, &child->bounds))
+        optimized = NULL;
+      else
+        optimized = gsk_render_node_optimize (child, clip);
+
+      if (optimized != child)
+        changed = TRUE;
+      if (optimized == NULL)
+        continue;
+
+      children[--n] = optimized;
+
+      if (gsk_render_node_get_opaque_rect (optimized, 1, &child_opaque) &&
+          (!has_opaque ||
+           child_opaque.size.width * child_opaque.size.height >
+           opaque.size.width * opaque.size.height))
+        {
+          opaque = child_opaque;
+          has_opaque = TRUE;
+        }
+    }
+
+  if (n == n_children)
+    result = NULL;
+  else if (n == n_children - 1)
+    result = gsk_render_node_ref (children[n]);
+  else if (!changed)
+    result = gsk_render_node_ref (node);
+  else
+    result = gsk_container_node_new (children + n, n_children - n);
+
+  for (i = n; i < n_children; i++)
+    gsk_render_node_unref (children[i]);
+  g_free (children);
+
+  return result;
+}
+
+/*< private >
+ * gsk_render_node_optimize:
+ * @node: a #GskRenderNode
+ * @clip: (nullable): the area that will be visible, in the
+ *     coordinates of @node, or %NULL
+ *
+ * Creates a render node that renders the same as @node inside of @clip,
+ * but with less work for the renderers: Subtrees that are outside of
+ * @clip, transparent or covered by opaque siblings are removed, clip
+ * nodes inside of clip nodes are merged, clip nodes that don't clip
+ * anything and identity transforms are dropped, nested transforms are
+ * combined and containers with a single child are replaced by it.
+ *
+ * Parts of the tree that don't change are reused, so that renderers
+ * can still recognize them in their caches.
+ *
+ * Returns: (transfer full) (nullable): the optimized node, or %NULL
+ *     if @node doesn't draw anything inside of @clip
+ */
+GskRenderNode *
+gsk_render_node_optimize (GskRenderNode         *node,
+                          const graphene_rect_t *clip)
+{
+  if (node->bounds.size.width <= 0 || node->bounds.size.height <= 0)
+    return NULL;
+
+  if (clip != NULL && !graphene_rect_intersection (&node->bounds, clip, NULL))
+    return NULL;
+
+  switch (node->node_class->node_type)
+    {
+    case GSK_CONTAINER_NODE:
+      return gsk_container_node_optimize (node, clip);
+
+    case GSK_COLOR_NODE:
+      if (gsk_color_node_peek_color (node)->alpha <= 0)
+        return NULL;
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        GskRenderNode *child = gsk_opacity_node_get_child (node);
+        double opacity = gsk_opacity_node_get_opacity (node);
+        GskRenderNode *optimized, *result;
+
+        if (opacity <= 0)
+          return NULL;
+
+        optimized = gsk_render_node_optimize (child, clip);
+        if (optimized == NULL || opacity >= 1)
+          return optimized;
+
+        if (optimized == child)
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_opacity_node_new (optimized, opacity);
+
+        gsk_render_node_unref (optimized);
+
+        return result;
+      }
+
+    case GSK_CLIP_NODE:
+      {
+        GskRenderNode *child = gsk_clip_node_get_child (node);
+        const graphene_rect_t *node_clip = gsk_clip_node_peek_clip (node);
+        GskRenderNode *optimized, *result;
+        graphene_rect_t child_clip;
+
+        if (graphene_rect_contains_rect (node_clip, &child->bounds))
+          return gsk_render_node_optimize (child, clip);
+
+        if (clip != NULL)
+          graphene_rect_intersection (node_clip, clip, &child_clip);
+        else
+          child_clip = *node_clip;
+
+        optimized = gsk_render_node_optimize (child, &child_clip);
+        if (optimized == NULL)
+          return NULL;
+
+        if (gsk_render_node_get_node_type (optimized) == GSK_CLIP_NODE)
+          {
+            graphene_rect_t merged;
+
+            graphene_rect_intersection (node_clip, gsk_clip_node_peek_clip (optimized), &merged);
+            result = gsk_clip_node_new (gsk_clip_node_get_child (optimized), &merged);
+          }
+        else if (optimized == child)
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_clip_node_new (optimized, node_clip);
+
+        gsk_render_node_unref (optimized);
+
+        return result;
+      }
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRenderNode *child = gsk_rounded_clip_node_get_child (node);
+        const GskRoundedRect *node_clip = gsk_rounded_clip_node_peek_clip (node);
+        GskRenderNode *optimized, *result;
+        graphene_rect_t child_clip;
+
+        if (clip != NULL)
+          graphene_rect_intersection (&node_clip->bounds, clip, &child_clip);
+        else
+          child_clip = node_clip->bounds;
+
+        optimized = gsk_render_node_optimize (child, &child_clip);
+        if (optimized == NULL)
+          return NULL;
+
+        if (optimized == child)
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_rounded_clip_node_new (optimized, node_clip);
+
+        gsk_render_node_unref (optimized);
+
+        return result;
+      }
+
+    case GSK_TRANSFORM_NODE:
+      {
+        GskRenderNode *child = gsk_transform_node_get_child (node);
+        const graphene_matrix_t *transform = gsk_transform_node_peek_transform (node);
+        GskRenderNode *optimized, *result;
+        graphene_rect_t child_clip;
+        float dx, dy;
+
+        if (clip != NULL && matrix_is_translation (transform, &dx, &dy))
+          {
+            child_clip = *clip;
+            graphene_rect_offset (&child_clip, -dx, -dy);
+            optimized = gsk_render_node_optimize (child, &child_clip);
+          }
+        else
+          {
+            /* We don't bother to transform the clip back */
+            optimized = gsk_render_node_optimize (child, NULL);
+          }
+
+        if (optimized == NULL || graphene_matrix_is_identity (transform))
+          return optimized;
+
+        if (gsk_render_node_get_node_type (optimized) == GSK_TRANSFORM_NODE)
+          {
+            graphene_matrix_t combined;
+
+            /* The inner transform is applied first */
+            graphene_matrix_multiply (gsk_transform_node_peek_transform (optimized),
+                                      transform,
+                                      &combined);
+            result = gsk_transform_node_new (gsk_transform_node_get_child (optimized), &combined);
+          }
+        else if (optimized == child)
+          result = gsk_render_node_ref (node);
+        else
+          result = gsk_transform_node_new (optimized, transform);
+
+        gsk_render_node_unref (optimized);
+
+        return result;
+      }
+
+    default:
+      break;
+    }
+
+  return gsk_render_node_ref (node);
+}
+
 #define GSK_RENDER_NODE_SERIALIZATION_VERSION 0
 #define GSK_RENDER_NODE_SERIALIZATION_ID "GskRenderNode"
 
@@ -302,21 +1023,7 @@ gsk_render_node_draw (GskRenderNode *node,
 GBytes *
 gsk_render_node_serialize (GskRenderNode *node)
 {
-  GVariant *node_variant, *variant;
-  GBytes *result;
-
-  node_variant = gsk_render_node_serialize_node (node);
-
-  variant = g_variant_new ("(suuv)",
-                           GSK_RENDER_NODE_SERIALIZATION_ID,
-                           (guint32) GSK_RENDER_NODE_SERIALIZATION_VERSION,
-                           (guint32) gsk_render_node_get_node_type (node),
-                           node_variant);
-
-  result = g_variant_get_data_as_bytes (variant);
-  g_variant_unref (variant);
-
-  return result;
+  return gsk_render_node_serialize_binary (node, GSK_SERIALIZE_DEFAULT);
 }
 
 /**
@@ -364,6 +1071,10 @@ gsk_render_node_write_to_file (GskRenderNode *node,
  * Loads data previously created via gsk_render_node_serialize(). For a
  * discussion of the supported format, see that function.
  *
+ * Image data in @bytes is used without copying it where possible, so
+ * passing the bytes of a #GMappedFile avoids reading large files into
+ * memory.
+ *
  * Returns: (nullable) (transfer full): a new #GskRenderNode or %NULL on
  *     error.
  **/
@@ -376,6 +1087,10 @@ gsk_render_node_deserialize (GBytes  *bytes,
   GVariant *variant, *node_variant;
   GskRenderNode *node = NULL;
 
+  if (gsk_render_node_binary_check_header (bytes))
+    return gsk_render_node_deserialize_binary (bytes, error);
+
+  /* Files written by older versions use GVariant */
   variant = g_variant_new_from_bytes (G_VARIANT_TYPE ("(suuv)"), bytes, FALSE);
 
   g_variant_get (variant, "(suuv)", &id_string, &version, &node_type, &node_variant);
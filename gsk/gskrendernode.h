@@ -123,6 +123,39 @@ GskRenderNode *         gsk_repeating_linear_gradient_node_new      (const graph
                                                                      const GskColorStop       *color_stops,
                                                                      gsize                     n_color_stops);
 
+GDK_AVAILABLE_IN_3_94
+GskRenderNode *         gsk_radial_gradient_node_new                (const graphene_rect_t    *bounds,
+                                                                     const graphene_point_t   *center,
+                                                                     float                     hradius,
+                                                                     float                     vradius,
+                                                                     float                     start,
+                                                                     float                     end,
+                                                                     const GskColorStop       *color_stops,
+                                                                     gsize                     n_color_stops);
+GDK_AVAILABLE_IN_3_94
+GskRenderNode *         gsk_repeating_radial_gradient_node_new      (const graphene_rect_t    *bounds,
+                                                                     const graphene_point_t   *center,
+                                                                     float                     hradius,
+                                                                     float                     vradius,
+                                                                     float                     start,
+                                                                     float                     end,
+                                                                     const GskColorStop       *color_stops,
+                                                                     gsize                     n_color_stops);
+GDK_AVAILABLE_IN_3_94
+const graphene_point_t * gsk_radial_gradient_node_peek_center       (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+float                    gsk_radial_gradient_node_get_hradius       (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+float                    gsk_radial_gradient_node_get_vradius       (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+float                    gsk_radial_gradient_node_get_start         (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+float                    gsk_radial_gradient_node_get_end           (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+gsize                    gsk_radial_gradient_node_get_n_color_stops (GskRenderNode            *node);
+GDK_AVAILABLE_IN_3_94
+const GskColorStop *     gsk_radial_gradient_node_peek_color_stops  (GskRenderNode            *node);
+
 GDK_AVAILABLE_IN_3_90
 GskRenderNode *         gsk_border_node_new                     (const GskRoundedRect     *outline,
                                                                  const float               border_width[4],
@@ -0,0 +1,1536 @@
+#include "config.h"
+
+#include "gskrendernodebinaryprivate.h"
+
+#include "gskrendernodeprivate.h"
+
+#include "gdk/gdktextureprivate.h"
+
+#include <gio/gio.h>
+#include <pango/pangocairo.h>
+#include <string.h>
+
+/* A compact binary format for render nodes.
+ *
+ * Everything is stored in host byte order, and every table is aligned,
+ * so that a file can be loaded straight from a mapping without
+ * converting any fields:
+ *
+ *   header
+ *   image table    GskBinaryImage[n_images]
+ *   string table   GskBinaryString[n_strings]
+ *   strings        nul-terminated
+ *   nodes          a depth-first stream of 32bit values
+ *   images         ARGB32 pixels, optionally compressed with deflate
+ *
+ * Textures and cairo surfaces that are shared between nodes are only
+ * stored once, as are font descriptions. Uncompressed pixel data is
+ * used in place when loading, so the bytes are kept alive as long as
+ * nodes reference them.
+ */
+
+#define GSK_BINARY_MAGIC "GSKNODE"
+#define GSK_BINARY_BYTE_ORDER 0x01020304
+#define GSK_BINARY_VERSION 1
+
+/* Compressing small images is not worth the time */
+#define GSK_BINARY_MIN_COMPRESS_SIZE 4096
+
+#define GSK_BINARY_ALIGN(n, a) (((n) + (a) - 1) & ~((gsize) (a) - 1))
+
+typedef struct {
+  char magic[8];
+  guint32 byte_order;
+  guint32 version;
+  guint32 n_images;
+  guint32 n_strings;
+  guint64 images_offset;
+  guint64 strings_offset;
+  guint64 nodes_offset;
+  guint64 nodes_size;
+} GskBinaryHeader;
+
+enum {
+  GSK_BINARY_IMAGE_DEFLATED = 1 << 0
+};
+
+typedef struct {
+  guint32 width;
+  guint32 height;
+  guint32 flags;
+  guint32 padding;
+  guint64 offset;
+  guint64 size;
+} GskBinaryImage;
+
+typedef struct {
+  guint64 offset;
+  guint32 length;
+  guint32 padding;
+} GskBinaryString;
+
+static GBytes *
+convert_data (GConverter    *converter,
+              const guchar  *data,
+              gsize          size,
+              gsize          size_hint,
+              GError       **error)
+{
+  GByteArray *array;
+  GConverterResult res;
+  gsize written = 0;
+
+  array = g_byte_array_sized_new (MAX (size_hint, 64));
+  g_byte_array_set_size (array, MAX (size_hint, 64));
+
+  do
+    {
+      GError *local_error = NULL;
+      gsize bytes_read, bytes_written;
+
+      res = g_converter_convert (converter,
+                                 data, size,
+                                 array->data + written, array->len - written,
+                                 G_CONVERTER_INPUT_AT_END,
+                                 &bytes_read, &bytes_written,
+                                 &local_error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+            {
+              g_clear_error (&local_error);
+              g_byte_array_set_size (array, array->len * 2);
+              continue;
+            }
+
+          g_propagate_error (error, local_error);
+          g_byte_array_unref (array);
+          return NULL;
+        }
+
+      data += bytes_read;
+      size -= bytes_read;
+      written += bytes_written;
+    }
+  while (res != G_CONVERTER_FINISHED);
+
+  g_byte_array_set_size (array, written);
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+/*** Writing ***/
+
+typedef struct
+{
+  GByteArray *nodes;
+
+  GHashTable *image_ids;     /* object => index + 1 */
+  GPtrArray *images;         /* cairo_surface_t */
+
+  GHashTable *string_ids;    /* string => index + 1 */
+  GPtrArray *strings;        /* owned by string_ids */
+} GskBinaryWriter;
+
+static void
+write_uint32 (GskBinaryWriter *writer,
+              guint32          value)
+{
+  g_byte_array_append (writer->nodes, (const guint8 *) &value, sizeof (guint32));
+}
+
+static void
+write_floats (GskBinaryWriter *writer,
+              const float     *values,
+              gsize            n_values)
+{
+  g_byte_array_append (writer->nodes, (const guint8 *) values, n_values * sizeof (float));
+}
+
+static void
+write_float (GskBinaryWriter *writer,
+             float            value)
+{
+  write_floats (writer, &value, 1);
+}
+
+static void
+write_rect (GskBinaryWriter       *writer,
+            const graphene_rect_t *rect)
+{
+  write_floats (writer,
+                (float[4]) { rect->origin.x, rect->origin.y,
+                             rect->size.width, rect->size.height },
+                4);
+}
+
+static void
+write_point (GskBinaryWriter        *writer,
+             const graphene_point_t *point)
+{
+  write_floats (writer, (float[2]) { point->x, point->y }, 2);
+}
+
+static void
+write_rgba (GskBinaryWriter *writer,
+            const GdkRGBA   *rgba)
+{
+  write_floats (writer,
+                (float[4]) { rgba->red, rgba->green, rgba->blue, rgba->alpha },
+                4);
+}
+
+static void
+write_rounded_rect (GskBinaryWriter      *writer,
+                    const GskRoundedRect *rect)
+{
+  guint i;
+
+  write_rect (writer, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    write_floats (writer, (float[2]) { rect->corner[i].width, rect->corner[i].height }, 2);
+}
+
+static void
+write_matrix (GskBinaryWriter         *writer,
+              const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+  write_floats (writer, values, 16);
+}
+
+static guint32
+writer_add_string (GskBinaryWriter *writer,
+                   const char      *string)
+{
+  gpointer id;
+  char *copy;
+
+  id = g_hash_table_lookup (writer->string_ids, string);
+  if (id)
+    return GPOINTER_TO_UINT (id) - 1;
+
+  copy = g_strdup (string);
+  g_ptr_array_add (writer->strings, copy);
+  g_hash_table_insert (writer->string_ids, copy, GUINT_TO_POINTER (writer->strings->len));
+
+  return writer->strings->len - 1;
+}
+
+static gboolean
+writer_lookup_image (GskBinaryWriter *writer,
+                     gconstpointer    key,
+                     guint32         *id)
+{
+  gpointer value;
+
+  value = g_hash_table_lookup (writer->image_ids, key);
+  if (value == NULL)
+    return FALSE;
+
+  *id = GPOINTER_TO_UINT (value) - 1;
+  return TRUE;
+}
+
+/* Takes ownership of @surface */
+static guint32
+writer_add_image (GskBinaryWriter *writer,
+                  gconstpointer    key,
+                  cairo_surface_t *surface)
+{
+  g_ptr_array_add (writer->images, surface);
+  g_hash_table_insert (writer->image_ids, (gpointer) key, GUINT_TO_POINTER (writer->images->len));
+
+  return writer->images->len - 1;
+}
+
+static cairo_surface_t *
+get_image_surface (cairo_surface_t *surface)
+{
+  cairo_surface_t *mapped, *image;
+  cairo_t *cr;
+
+  if (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE &&
+      cairo_image_surface_get_format (surface) == CAIRO_FORMAT_ARGB32)
+    return cairo_surface_reference (surface);
+
+  mapped = cairo_surface_map_to_image (surface, NULL);
+  image = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                      cairo_image_surface_get_width (mapped),
+                                      cairo_image_surface_get_height (mapped));
+  cr = cairo_create (image);
+  cairo_set_source_surface (cr, mapped, 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+  cairo_surface_unmap_image (surface, mapped);
+
+  return image;
+}
+
+static void
+write_node (GskBinaryWriter *writer,
+            GskRenderNode   *node)
+{
+  GskRenderNodeType type = gsk_render_node_get_node_type (node);
+  guint i;
+
+  write_uint32 (writer, type);
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      write_uint32 (writer, gsk_container_node_get_n_children (node));
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        write_node (writer, gsk_container_node_get_child (node, i));
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = (cairo_surface_t *) gsk_cairo_node_peek_surface (node);
+        guint32 id;
+
+        write_rect (writer, &node->bounds);
+
+        if (surface == NULL)
+          {
+            write_uint32 (writer, G_MAXUINT32);
+            break;
+          }
+
+        if (!writer_lookup_image (writer, surface, &id))
+          id = writer_add_image (writer, surface, get_image_surface (surface));
+        write_uint32 (writer, id);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      write_rect (writer, &node->bounds);
+      write_rgba (writer, gsk_color_node_peek_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        const GskColorStop *stops = gsk_linear_gradient_node_peek_color_stops (node);
+        gsize n_stops = gsk_linear_gradient_node_get_n_color_stops (node);
+
+        write_rect (writer, &node->bounds);
+        write_point (writer, gsk_linear_gradient_node_peek_start (node));
+        write_point (writer, gsk_linear_gradient_node_peek_end (node));
+        write_uint32 (writer, n_stops);
+        for (i = 0; i < n_stops; i++)
+          {
+            write_float (writer, stops[i].offset);
+            write_rgba (writer, &stops[i].color);
+          }
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      write_rounded_rect (writer, gsk_border_node_peek_outline (node));
+      write_floats (writer, gsk_border_node_peek_widths (node), 4);
+      for (i = 0; i < 4; i++)
+        write_rgba (writer, &gsk_border_node_peek_colors (node)[i]);
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = gsk_texture_node_get_texture (node);
+        guint32 id;
+
+        if (!writer_lookup_image (writer, texture, &id))
+          id = writer_add_image (writer, texture, gdk_texture_download_surface (texture));
+
+        write_rect (writer, &node->bounds);
+        write_uint32 (writer, id);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      write_rounded_rect (writer, gsk_inset_shadow_node_peek_outline (node));
+      write_rgba (writer, gsk_inset_shadow_node_peek_color (node));
+      write_float (writer, gsk_inset_shadow_node_get_dx (node));
+      write_float (writer, gsk_inset_shadow_node_get_dy (node));
+      write_float (writer, gsk_inset_shadow_node_get_spread (node));
+      write_float (writer, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      write_rounded_rect (writer, gsk_outset_shadow_node_peek_outline (node));
+      write_rgba (writer, gsk_outset_shadow_node_peek_color (node));
+      write_float (writer, gsk_outset_shadow_node_get_dx (node));
+      write_float (writer, gsk_outset_shadow_node_get_dy (node));
+      write_float (writer, gsk_outset_shadow_node_get_spread (node));
+      write_float (writer, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      write_matrix (writer, gsk_transform_node_peek_transform (node));
+      write_node (writer, gsk_transform_node_get_child (node));
+      break;
+
+    case GSK_OPACITY_NODE:
+      write_float (writer, gsk_opacity_node_get_opacity (node));
+      write_node (writer, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        float offset[4];
+
+        graphene_vec4_to_float (gsk_color_matrix_node_peek_color_offset (node), offset);
+        write_matrix (writer, gsk_color_matrix_node_peek_color_matrix (node));
+        write_floats (writer, offset, 4);
+        write_node (writer, gsk_color_matrix_node_get_child (node));
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      write_rect (writer, &node->bounds);
+      write_rect (writer, gsk_repeat_node_peek_child_bounds (node));
+      write_node (writer, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      write_rect (writer, gsk_clip_node_peek_clip (node));
+      write_node (writer, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      write_rounded_rect (writer, gsk_rounded_clip_node_peek_clip (node));
+      write_node (writer, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      write_uint32 (writer, gsk_shadow_node_get_n_shadows (node));
+      for (i = 0; i < gsk_shadow_node_get_n_shadows (node); i++)
+        {
+          const GskShadow *shadow = gsk_shadow_node_peek_shadow (node, i);
+
+          write_rgba (writer, &shadow->color);
+          write_float (writer, shadow->dx);
+          write_float (writer, shadow->dy);
+          write_float (writer, shadow->radius);
+        }
+      write_node (writer, gsk_shadow_node_get_child (node));
+      break;
+
+    case GSK_BLEND_NODE:
+      write_uint32 (writer, gsk_blend_node_get_blend_mode (node));
+      write_node (writer, gsk_blend_node_get_bottom_child (node));
+      write_node (writer, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      write_float (writer, gsk_cross_fade_node_get_progress (node));
+      write_node (writer, gsk_cross_fade_node_get_start_child (node));
+      write_node (writer, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        const PangoGlyphInfo *glyphs = gsk_text_node_peek_glyphs (node);
+        PangoFontDescription *desc;
+        char *s;
+
+        desc = pango_font_describe ((PangoFont *) gsk_text_node_peek_font (node));
+        s = pango_font_description_to_string (desc);
+        write_uint32 (writer, writer_add_string (writer, s));
+        g_free (s);
+        pango_font_description_free (desc);
+
+        write_rgba (writer, gsk_text_node_peek_color (node));
+        write_float (writer, gsk_text_node_get_x (node));
+        write_float (writer, gsk_text_node_get_y (node));
+        write_uint32 (writer, gsk_text_node_get_num_glyphs (node));
+        for (i = 0; i < gsk_text_node_get_num_glyphs (node); i++)
+          {
+            write_uint32 (writer, glyphs[i].glyph);
+            write_uint32 (writer, glyphs[i].geometry.width);
+            write_uint32 (writer, glyphs[i].geometry.x_offset);
+            write_uint32 (writer, glyphs[i].geometry.y_offset);
+            write_uint32 (writer, glyphs[i].attr.is_cluster_start);
+          }
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      write_float (writer, gsk_blur_node_get_radius (node));
+      write_node (writer, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+        gsize n_stops = gsk_radial_gradient_node_get_n_color_stops (node);
+
+        write_rect (writer, &node->bounds);
+        write_point (writer, gsk_radial_gradient_node_peek_center (node));
+        write_float (writer, gsk_radial_gradient_node_get_hradius (node));
+        write_float (writer, gsk_radial_gradient_node_get_vradius (node));
+        write_float (writer, gsk_radial_gradient_node_get_start (node));
+        write_float (writer, gsk_radial_gradient_node_get_end (node));
+        write_uint32 (writer, n_stops);
+        for (i = 0; i < n_stops; i++)
+          {
+            write_float (writer, stops[i].offset);
+            write_rgba (writer, &stops[i].color);
+          }
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+append_padding (GByteArray *array,
+                gsize       alignment)
+{
+  static const guint8 zeroes[16] = { 0, };
+
+  g_assert (alignment <= sizeof (zeroes));
+
+  g_byte_array_append (array, zeroes, GSK_BINARY_ALIGN (array->len, alignment) - array->len);
+}
+
+static void
+append_image (GByteArray      *array,
+              GskBinaryImage  *image,
+              cairo_surface_t *surface,
+              gboolean         compress)
+{
+  const guchar *data;
+  guchar *packed = NULL;
+  gsize stride, size;
+  int width, height, y;
+
+  cairo_surface_flush (surface);
+
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+  stride = cairo_image_surface_get_stride (surface);
+  data = cairo_image_surface_get_data (surface);
+  size = (gsize) width * height * 4;
+
+  if (stride != width * 4)
+    {
+      packed = g_malloc (size);
+      for (y = 0; y < height; y++)
+        memcpy (packed + y * width * 4, data + y * stride, width * 4);
+      data = packed;
+    }
+
+  image->width = width;
+  image->height = height;
+  image->flags = 0;
+
+  append_padding (array, 16);
+  image->offset = array->len;
+
+  if (compress && size >= GSK_BINARY_MIN_COMPRESS_SIZE)
+    {
+      GZlibCompressor *compressor;
+      GBytes *deflated;
+
+      compressor = g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, 1);
+      deflated = convert_data (G_CONVERTER (compressor), data, size, size / 4, NULL);
+      g_object_unref (compressor);
+
+      if (deflated && g_bytes_get_size (deflated) < size)
+        {
+          image->flags |= GSK_BINARY_IMAGE_DEFLATED;
+          image->size = g_bytes_get_size (deflated);
+          g_byte_array_append (array, g_bytes_get_data (deflated, NULL), image->size);
+          g_bytes_unref (deflated);
+          g_free (packed);
+          return;
+        }
+
+      g_clear_pointer (&deflated, g_bytes_unref);
+    }
+
+  image->size = size;
+  g_byte_array_append (array, data, size);
+  g_free (packed);
+}
+
+/*< private >
+ * gsk_render_node_serialize_binary:
+ * @node: a #GskRenderNode
+ * @flags: flags influencing the output
+ *
+ * Serializes @node into the binary format that is loaded by
+ * gsk_render_node_deserialize_binary().
+ *
+ * Returns: a #GBytes with the serialized node
+ */
+GBytes *
+gsk_render_node_serialize_binary (GskRenderNode     *node,
+                                  GskSerializeFlags  flags)
+{
+  GskBinaryWriter writer;
+  GskBinaryHeader header = { GSK_BINARY_MAGIC, };
+  GskBinaryImage *images;
+  GskBinaryString *strings;
+  GByteArray *result;
+  guint i;
+
+  writer.nodes = g_byte_array_new ();
+  writer.image_ids = g_hash_table_new (NULL, NULL);
+  writer.images = g_ptr_array_new_with_free_func ((GDestroyNotify) cairo_surface_destroy);
+  writer.string_ids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  writer.strings = g_ptr_array_new ();
+
+  write_node (&writer, node);
+
+  header.byte_order = GSK_BINARY_BYTE_ORDER;
+  header.version = GSK_BINARY_VERSION;
+  header.n_images = writer.images->len;
+  header.n_strings = writer.strings->len;
+
+  result = g_byte_array_new ();
+  g_byte_array_set_size (result, sizeof (GskBinaryHeader));
+
+  header.images_offset = result->len;
+  g_byte_array_set_size (result, result->len + header.n_images * sizeof (GskBinaryImage));
+
+  header.strings_offset = result->len;
+  g_byte_array_set_size (result, result->len + header.n_strings * sizeof (GskBinaryString));
+
+  strings = g_new (GskBinaryString, header.n_strings);
+  for (i = 0; i < header.n_strings; i++)
+    {
+      const char *s = g_ptr_array_index (writer.strings, i);
+
+      strings[i].offset = result->len;
+      strings[i].length = strlen (s);
+      strings[i].padding = 0;
+      g_byte_array_append (result, (const guint8 *) s, strings[i].length + 1);
+    }
+
+  append_padding (result, 8);
+  header.nodes_offset = result->len;
+  header.nodes_size = writer.nodes->len;
+  g_byte_array_append (result, writer.nodes->data, writer.nodes->len);
+
+  images = g_new0 (GskBinaryImage, header.n_images);
+  for (i = 0; i < header.n_images; i++)
+    append_image (result, &images[i],
+                  g_ptr_array_index (writer.images, i),
+                  (flags & GSK_SERIALIZE_COMPRESS) != 0);
+
+  memcpy (result->data, &header, sizeof (GskBinaryHeader));
+  memcpy (result->data + header.images_offset, images, header.n_images * sizeof (GskBinaryImage));
+  memcpy (result->data + header.strings_offset, strings, header.n_strings * sizeof (GskBinaryString));
+
+  g_free (images);
+  g_free (strings);
+  g_byte_array_unref (writer.nodes);
+  g_hash_table_unref (writer.image_ids);
+  g_ptr_array_unref (writer.images);
+  g_ptr_array_unref (writer.strings);
+  g_hash_table_unref (writer.string_ids);
+
+  return g_byte_array_free_to_bytes (result);
+}
+
+/*** Reading ***/
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+
+  const guchar *pos;
+  const guchar *end;
+
+  const GskBinaryImage *images;
+  guint n_images;
+  cairo_surface_t **surfaces;
+  GdkTexture **textures;
+
+  const GskBinaryString *strings;
+  guint n_strings;
+  PangoFont **fonts;
+  PangoFontMap *fontmap;
+  PangoContext *context;
+
+  GError *error;
+} GskBinaryReader;
+
+static void
+reader_error (GskBinaryReader *reader,
+              const char      *message)
+{
+  if (reader->error == NULL)
+    g_set_error_literal (&reader->error,
+                         GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA,
+                         message);
+}
+
+static gboolean
+reader_failed (GskBinaryReader *reader)
+{
+  return reader->error != NULL;
+}
+
+/* On errors, the read functions return zeroes, and the caller checks
+ * reader_failed() before using the values.
+ */
+static guint32
+read_uint32 (GskBinaryReader *reader)
+{
+  guint32 value;
+
+  if ((gsize) (reader->end - reader->pos) < sizeof (guint32))
+    {
+      reader_error (reader, "Unexpected end of node data");
+      return 0;
+    }
+
+  memcpy (&value, reader->pos, sizeof (guint32));
+  reader->pos += sizeof (guint32);
+
+  return value;
+}
+
+static void
+read_floats (GskBinaryReader *reader,
+             float           *values,
+             gsize            n_values)
+{
+  if ((gsize) (reader->end - reader->pos) < n_values * sizeof (float))
+    {
+      reader_error (reader, "Unexpected end of node data");
+      memset (values, 0, n_values * sizeof (float));
+      return;
+    }
+
+  memcpy (values, reader->pos, n_values * sizeof (float));
+  reader->pos += n_values * sizeof (float);
+}
+
+static float
+read_float (GskBinaryReader *reader)
+{
+  float value;
+
+  read_floats (reader, &value, 1);
+
+  return value;
+}
+
+static void
+read_rect (GskBinaryReader *reader,
+           graphene_rect_t *rect)
+{
+  float v[4];
+
+  read_floats (reader, v, 4);
+  graphene_rect_init (rect, v[0], v[1], v[2], v[3]);
+}
+
+static void
+read_point (GskBinaryReader  *reader,
+            graphene_point_t *point)
+{
+  float v[2];
+
+  read_floats (reader, v, 2);
+  graphene_point_init (point, v[0], v[1]);
+}
+
+static void
+read_rgba (GskBinaryReader *reader,
+           GdkRGBA         *rgba)
+{
+  float v[4];
+
+  read_floats (reader, v, 4);
+  *rgba = (GdkRGBA) { v[0], v[1], v[2], v[3] };
+}
+
+static void
+read_rounded_rect (GskBinaryReader *reader,
+                   GskRoundedRect  *rect)
+{
+  guint i;
+
+  read_rect (reader, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      float v[2];
+
+      read_floats (reader, v, 2);
+      graphene_size_init (&rect->corner[i], v[0], v[1]);
+    }
+}
+
+static void
+read_matrix (GskBinaryReader   *reader,
+             graphene_matrix_t *matrix)
+{
+  float v[16];
+
+  read_floats (reader, v, 16);
+  graphene_matrix_init_from_float (matrix, v);
+}
+
+/* Reads a count of items that are at least @item_size bytes each, making
+ * sure we don't allocate more than the remaining data could describe.
+ */
+static guint32
+read_count (GskBinaryReader *reader,
+            gsize            item_size)
+{
+  guint32 count = read_uint32 (reader);
+
+  if (count > (gsize) (reader->end - reader->pos) / item_size)
+    {
+      reader_error (reader, "Invalid item count");
+      return 0;
+    }
+
+  return count;
+}
+
+static const cairo_user_data_key_t gsk_binary_bytes_key;
+
+static cairo_surface_t *
+reader_get_surface (GskBinaryReader *reader,
+                    guint32          id)
+{
+  const GskBinaryImage *image;
+  cairo_surface_t *surface;
+  GBytes *pixels;
+  gsize size;
+
+  if (id >= reader->n_images)
+    {
+      reader_error (reader, "Invalid image reference");
+      return NULL;
+    }
+
+  if (reader->surfaces[id])
+    return reader->surfaces[id];
+
+  image = &reader->images[id];
+  size = (gsize) image->width * image->height * 4;
+
+  if (image->width == 0 || image->height == 0 ||
+      image->width > G_MAXINT / 4 || image->height > G_MAXINT ||
+      image->offset > reader->size ||
+      image->size > reader->size - image->offset)
+    {
+      reader_error (reader, "Invalid image");
+      return NULL;
+    }
+
+  if (image->flags & GSK_BINARY_IMAGE_DEFLATED)
+    {
+      GZlibDecompressor *decompressor;
+
+      decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW);
+      pixels = convert_data (G_CONVERTER (decompressor),
+                             reader->data + image->offset, image->size,
+                             size, NULL);
+      g_object_unref (decompressor);
+    }
+  else if ((GPOINTER_TO_SIZE (reader->data + image->offset) & 3) == 0)
+    {
+      /* Use the pixels in place */
+      pixels = g_bytes_new_from_bytes (reader->bytes, image->offset, image->size);
+    }
+  else
+    {
+      pixels = g_bytes_new (reader->data + image->offset, image->size);
+    }
+
+  if (pixels == NULL || g_bytes_get_size (pixels) != size)
+    {
+      g_clear_pointer (&pixels, g_bytes_unref);
+      reader_error (reader, "Invalid image data");
+      return NULL;
+    }
+
+  surface = cairo_image_surface_create_for_data ((guchar *) g_bytes_get_data (pixels, NULL),
+                                                 CAIRO_FORMAT_ARGB32,
+                                                 image->width, image->height,
+                                                 image->width * 4);
+  cairo_surface_set_user_data (surface,
+                               &gsk_binary_bytes_key,
+                               pixels,
+                               (cairo_destroy_func_t) g_bytes_unref);
+
+  reader->surfaces[id] = surface;
+
+  return surface;
+}
+
+static GdkTexture *
+reader_get_texture (GskBinaryReader *reader,
+                    guint32          id)
+{
+  cairo_surface_t *surface;
+
+  surface = reader_get_surface (reader, id);
+  if (surface == NULL)
+    return NULL;
+
+  if (reader->textures[id] == NULL)
+    reader->textures[id] = gdk_texture_new_for_surface (surface);
+
+  return reader->textures[id];
+}
+
+static PangoFont *
+reader_get_font (GskBinaryReader *reader,
+                 guint32          id)
+{
+  const GskBinaryString *string;
+  PangoFontDescription *desc;
+
+  if (id >= reader->n_strings)
+    {
+      reader_error (reader, "Invalid font reference");
+      return NULL;
+    }
+
+  if (reader->fonts[id])
+    return reader->fonts[id];
+
+  string = &reader->strings[id];
+  if (string->offset > reader->size ||
+      string->length >= reader->size - string->offset ||
+      reader->data[string->offset + string->length] != '\0')
+    {
+      reader_error (reader, "Invalid string");
+      return NULL;
+    }
+
+  if (reader->fontmap == NULL)
+    {
+      reader->fontmap = pango_cairo_font_map_get_default ();
+      reader->context = pango_font_map_create_context (reader->fontmap);
+    }
+
+  desc = pango_font_description_from_string ((const char *) reader->data + string->offset);
+  reader->fonts[id] = pango_font_map_load_font (reader->fontmap, reader->context, desc);
+  pango_font_description_free (desc);
+
+  if (reader->fonts[id] == NULL)
+    reader_error (reader, "Could not load font");
+
+  return reader->fonts[id];
+}
+
+static GskRenderNode *
+read_node (GskBinaryReader *reader)
+{
+  GskRenderNode *result = NULL;
+  GskRenderNode *child, *other;
+  GskRenderNodeType type;
+  guint32 i;
+
+  type = read_uint32 (reader);
+  if (reader_failed (reader))
+    return NULL;
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+        guint32 n_children;
+
+        n_children = read_count (reader, sizeof (guint32));
+        if (reader_failed (reader))
+          return NULL;
+
+        children = g_new (GskRenderNode *, n_children);
+        for (i = 0; i < n_children; i++)
+          {
+            children[i] = read_node (reader);
+            if (children[i] == NULL)
+              break;
+          }
+
+        if (i == n_children)
+          result = gsk_container_node_new (children, n_children);
+
+        while (i-- > 0)
+          gsk_render_node_unref (children[i]);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        graphene_rect_t bounds;
+        cairo_surface_t *surface;
+        guint32 id;
+
+        read_rect (reader, &bounds);
+        id = read_uint32 (reader);
+        if (reader_failed (reader))
+          return NULL;
+
+        if (id == G_MAXUINT32)
+          return gsk_cairo_node_new (&bounds);
+
+        surface = reader_get_surface (reader, id);
+        if (surface == NULL)
+          return NULL;
+
+        result = gsk_cairo_node_new_for_surface (&bounds, surface);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkRGBA color;
+
+        read_rect (reader, &bounds);
+        read_rgba (reader, &color);
+        if (reader_failed (reader))
+          return NULL;
+
+        result = gsk_color_node_new (&color, &bounds);
+      }
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t start, end;
+        GskColorStop *stops;
+        guint32 n_stops;
+
+        read_rect (reader, &bounds);
+        read_point (reader, &start);
+        read_point (reader, &end);
+        n_stops = read_count (reader, 5 * sizeof (float));
+        if (reader_failed (reader))
+          return NULL;
+
+        if (n_stops < 2)
+          {
+            reader_error (reader, "Not enough color stops");
+            return NULL;
+          }
+
+        stops = g_new (GskColorStop, n_stops);
+        for (i = 0; i < n_stops; i++)
+          {
+            stops[i].offset = read_float (reader);
+            read_rgba (reader, &stops[i].color);
+
+            if (stops[i].offset < (i > 0 ? stops[i - 1].offset : 0) ||
+                stops[i].offset > 1)
+              reader_error (reader, "Invalid color stop");
+          }
+
+        if (!reader_failed (reader))
+          {
+            if (type == GSK_LINEAR_GRADIENT_NODE)
+              result = gsk_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+            else
+              result = gsk_repeating_linear_gradient_node_new (&bounds, &start, &end, stops, n_stops);
+          }
+
+        g_free (stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+
+        read_rounded_rect (reader, &outline);
+        read_floats (reader, widths, 4);
+        for (i = 0; i < 4; i++)
+          read_rgba (reader, &colors[i]);
+        if (reader_failed (reader))
+          return NULL;
+
+        result = gsk_border_node_new (&outline, widths, colors);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        graphene_rect_t bounds;
+        GdkTexture *texture;
+        guint32 id;
+
+        read_rect (reader, &bounds);
+        id = read_uint32 (reader);
+        if (reader_failed (reader))
+          return NULL;
+
+        texture = reader_get_texture (reader, id);
+        if (texture == NULL)
+          return NULL;
+
+        result = gsk_texture_node_new (texture, &bounds);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float v[4];
+
+        read_rounded_rect (reader, &outline);
+        read_rgba (reader, &color);
+        read_floats (reader, v, 4);
+        if (reader_failed (reader))
+          return NULL;
+
+        if (type == GSK_INSET_SHADOW_NODE)
+          result = gsk_inset_shadow_node_new (&outline, &color, v[0], v[1], v[2], v[3]);
+        else
+          result = gsk_outset_shadow_node_new (&outline, &color, v[0], v[1], v[2], v[3]);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        graphene_matrix_t transform;
+
+        read_matrix (reader, &transform);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_transform_node_new (child, &transform);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        float opacity;
+
+        opacity = read_float (reader);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_opacity_node_new (child, opacity);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        float v[4];
+
+        read_matrix (reader, &matrix);
+        read_floats (reader, v, 4);
+        graphene_vec4_init_from_float (&offset, v);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_color_matrix_node_new (child, &matrix, &offset);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        graphene_rect_t bounds, child_bounds;
+
+        read_rect (reader, &bounds);
+        read_rect (reader, &child_bounds);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_repeat_node_new (&bounds, child, &child_bounds);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        graphene_rect_t clip;
+
+        read_rect (reader, &clip);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_clip_node_new (child, &clip);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRoundedRect clip;
+
+        read_rounded_rect (reader, &clip);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_rounded_clip_node_new (child, &clip);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        GskShadow *shadows;
+        guint32 n_shadows;
+
+        n_shadows = read_count (reader, 7 * sizeof (float));
+        if (reader_failed (reader))
+          return NULL;
+
+        if (n_shadows == 0)
+          {
+            reader_error (reader, "Shadow node without shadows");
+            return NULL;
+          }
+
+        shadows = g_new (GskShadow, n_shadows);
+        for (i = 0; i < n_shadows; i++)
+          {
+            read_rgba (reader, &shadows[i].color);
+            shadows[i].dx = read_float (reader);
+            shadows[i].dy = read_float (reader);
+            shadows[i].radius = read_float (reader);
+          }
+
+        child = read_node (reader);
+        if (child != NULL)
+          {
+            result = gsk_shadow_node_new (child, shadows, n_shadows);
+            gsk_render_node_unref (child);
+          }
+
+        g_free (shadows);
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        guint32 blend_mode;
+
+        blend_mode = read_uint32 (reader);
+        if (reader_failed (reader))
+          return NULL;
+
+        if (blend_mode > GSK_BLEND_MODE_LUMINOSITY)
+          {
+            reader_error (reader, "Invalid blend mode");
+            return NULL;
+          }
+
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+        other = read_node (reader);
+        if (other == NULL)
+          {
+            gsk_render_node_unref (child);
+            return NULL;
+          }
+
+        result = gsk_blend_node_new (child, other, blend_mode);
+        gsk_render_node_unref (child);
+        gsk_render_node_unref (other);
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        float progress;
+
+        progress = read_float (reader);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+        other = read_node (reader);
+        if (other == NULL)
+          {
+            gsk_render_node_unref (child);
+            return NULL;
+          }
+
+        result = gsk_cross_fade_node_new (child, other, progress);
+        gsk_render_node_unref (child);
+        gsk_render_node_unref (other);
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font;
+        PangoGlyphString *glyphs;
+        GdkRGBA color;
+        float x, y;
+        guint32 n_glyphs;
+
+        font = reader_get_font (reader, read_uint32 (reader));
+        read_rgba (reader, &color);
+        x = read_float (reader);
+        y = read_float (reader);
+        n_glyphs = read_count (reader, 5 * sizeof (guint32));
+        if (reader_failed (reader))
+          return NULL;
+
+        glyphs = pango_glyph_string_new ();
+        pango_glyph_string_set_size (glyphs, n_glyphs);
+        for (i = 0; i < n_glyphs; i++)
+          {
+            PangoGlyphInfo *glyph = &glyphs->glyphs[i];
+
+            glyph->glyph = read_uint32 (reader);
+            glyph->geometry.width = (gint32) read_uint32 (reader);
+            glyph->geometry.x_offset = (gint32) read_uint32 (reader);
+            glyph->geometry.y_offset = (gint32) read_uint32 (reader);
+            glyph->attr.is_cluster_start = read_uint32 (reader) ? 1 : 0;
+          }
+
+        result = gsk_text_node_new (font, glyphs, &color, x, y);
+        pango_glyph_string_free (glyphs);
+
+        /* Text nodes with empty bounds are not created, but the
+         * parent still needs a node in their place.
+         */
+        if (result == NULL)
+          result = gsk_container_node_new (NULL, 0);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        float radius;
+
+        radius = read_float (reader);
+        child = read_node (reader);
+        if (child == NULL)
+          return NULL;
+
+        result = gsk_blur_node_new (child, radius);
+        gsk_render_node_unref (child);
+      }
+      break;
+
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        graphene_rect_t bounds;
+        graphene_point_t center;
+        float hradius, vradius, start, end;
+        GskColorStop *stops;
+        guint32 n_stops;
+
+        read_rect (reader, &bounds);
+        read_point (reader, &center);
+        hradius = read_float (reader);
+        vradius = read_float (reader);
+        start = read_float (reader);
+        end = read_float (reader);
+        n_stops = read_count (reader, 5 * sizeof (float));
+        if (reader_failed (reader))
+          return NULL;
+
+        if (!(hradius > 0 && vradius > 0 && start >= 0 && end > start))
+          {
+            reader_error (reader, "Invalid gradient geometry");
+            return NULL;
+          }
+
+        if (n_stops < 2)
+          {
+            reader_error (reader, "Not enough color stops");
+            return NULL;
+          }
+
+        stops = g_new (GskColorStop, n_stops);
+        for (i = 0; i < n_stops; i++)
+          {
+            stops[i].offset = read_float (reader);
+            read_rgba (reader, &stops[i].color);
+
+            if (stops[i].offset < (i > 0 ? stops[i - 1].offset : 0) ||
+                stops[i].offset > 1)
+              reader_error (reader, "Invalid color stop");
+          }
+
+        if (!reader_failed (reader))
+          {
+            if (type == GSK_RADIAL_GRADIENT_NODE)
+              result = gsk_radial_gradient_node_new (&bounds, &center, hradius, vradius,
+                                                     start, end, stops, n_stops);
+            else
+              result = gsk_repeating_radial_gradient_node_new (&bounds, &center, hradius, vradius,
+                                                               start, end, stops, n_stops);
+          }
+
+        g_free (stops);
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      reader_error (reader, "Invalid node type");
+      return NULL;
+    }
+
+  return result;
+}
+
+/*< private >
+ * gsk_render_node_binary_check_header:
+ * @bytes: serialized data
+ *
+ * Checks whether @bytes looks like it was created by
+ * gsk_render_node_serialize_binary().
+ *
+ * Returns: %TRUE if @bytes is in the binary format
+ */
+gboolean
+gsk_render_node_binary_check_header (GBytes *bytes)
+{
+  gsize size;
+  const guchar *data;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  return size >= sizeof (GskBinaryHeader) &&
+         memcmp (data, GSK_BINARY_MAGIC, sizeof (GSK_BINARY_MAGIC)) == 0;
+}
+
+/*< private >
+ * gsk_render_node_deserialize_binary:
+ * @bytes: data created by gsk_render_node_serialize_binary()
+ * @error: return location for an error
+ *
+ * Loads a node from the binary format. Uncompressed images reference
+ * @bytes directly, so it is a good idea to pass in a mapped file.
+ *
+ * Returns: (nullable) (transfer full): the loaded node
+ */
+GskRenderNode *
+gsk_render_node_deserialize_binary (GBytes  *bytes,
+                                    GError **error)
+{
+  GskBinaryReader reader = { NULL, };
+  GskBinaryHeader header;
+  GskRenderNode *node = NULL;
+  gpointer aligned_tables = NULL;
+  gsize tables_size;
+  guint i;
+
+  if (!gsk_render_node_binary_check_header (bytes))
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                   "Data not in GskRenderNode serialization format.");
+      return NULL;
+    }
+
+  reader.bytes = bytes;
+  reader.data = g_bytes_get_data (bytes, &reader.size);
+
+  memcpy (&header, reader.data, sizeof (GskBinaryHeader));
+
+  if (header.byte_order != GSK_BINARY_BYTE_ORDER)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                   "Data was created on a machine with different byte order.");
+      return NULL;
+    }
+
+  if (header.version != GSK_BINARY_VERSION)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                   "Format version %u not supported.", header.version);
+      return NULL;
+    }
+
+  if (header.images_offset > reader.size ||
+      header.n_images > (reader.size - header.images_offset) / sizeof (GskBinaryImage) ||
+      header.strings_offset > reader.size ||
+      header.n_strings > (reader.size - header.strings_offset) / sizeof (GskBinaryString) ||
+      header.nodes_offset > reader.size ||
+      header.nodes_size > reader.size - header.nodes_offset)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA,
+                   "Invalid header.");
+      return NULL;
+    }
+
+  /* The tables are read as structs, so make sure they are aligned */
+  if ((GPOINTER_TO_SIZE (reader.data) & 7) == 0)
+    {
+      reader.images = (const GskBinaryImage *) (reader.data + header.images_offset);
+      reader.strings = (const GskBinaryString *) (reader.data + header.strings_offset);
+    }
+  else
+    {
+      tables_size = header.n_images * sizeof (GskBinaryImage) + header.n_strings * sizeof (GskBinaryString);
+      aligned_tables = g_malloc (tables_size);
+      memcpy (aligned_tables,
+              reader.data + header.images_offset,
+              header.n_images * sizeof (GskBinaryImage));
+      memcpy ((guchar *) aligned_tables + header.n_images * sizeof (GskBinaryImage),
+              reader.data + header.strings_offset,
+              header.n_strings * sizeof (GskBinaryString));
+      reader.images = aligned_tables;
+      reader.strings = (const GskBinaryString *) ((guchar *) aligned_tables + header.n_images * sizeof (GskBinaryImage));
+    }
+
+  reader.n_images = header.n_images;
+  reader.surfaces = g_new0 (cairo_surface_t *, header.n_images);
+  reader.textures = g_new0 (GdkTexture *, header.n_images);
+  reader.n_strings = header.n_strings;
+  reader.fonts = g_new0 (PangoFont *, header.n_strings);
+
+  reader.pos = reader.data + header.nodes_offset;
+  reader.end = reader.pos + header.nodes_size;
+
+  node = read_node (&reader);
+
+  if (reader_failed (&reader))
+    {
+      g_clear_pointer (&node, gsk_render_node_unref);
+      g_propagate_error (error, reader.error);
+    }
+
+  for (i = 0; i < reader.n_images; i++)
+    {
+      g_clear_object (&reader.textures[i]);
+      g_clear_pointer (&reader.surfaces[i], cairo_surface_destroy);
+    }
+  for (i = 0; i < reader.n_strings; i++)
+    g_clear_object (&reader.fonts[i]);
+  g_clear_object (&reader.context);
+
+  g_free (reader.surfaces);
+  g_free (reader.textures);
+  g_free (reader.fonts);
+  g_free (aligned_tables);
+
+  return node;
+}
@@ -0,0 +1,22 @@
+#ifndef __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+#define __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+
+#include "gskrendernode.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GSK_SERIALIZE_DEFAULT  = 0,
+  GSK_SERIALIZE_COMPRESS = 1 << 0
+} GskSerializeFlags;
+
+gboolean        gsk_render_node_binary_check_header     (GBytes            *bytes);
+
+GBytes *        gsk_render_node_serialize_binary        (GskRenderNode     *node,
+                                                         GskSerializeFlags  flags);
+GskRenderNode * gsk_render_node_deserialize_binary      (GBytes            *bytes,
+                                                         GError           **error);
+
+G_END_DECLS
+
+#endif /* __GSK_RENDER_NODE_BINARY_PRIVATE_H__ */
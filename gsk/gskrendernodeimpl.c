@@ -42,6 +42,96 @@ check_variant_type (GVariant *variant,
   return TRUE;
 }
 
+/* Helpers for the hash and equal vfuncs. Values are compared exactly,
+ * so nodes that only differ by rounding errors are not equal.
+ */
+static guint
+hash_rgba (guint          seed,
+           const GdkRGBA *rgba)
+{
+  return gsk_hash_floats (seed, (float[4]) { rgba->red, rgba->green, rgba->blue, rgba->alpha }, 4);
+}
+
+static guint
+hash_rect (guint                  seed,
+           const graphene_rect_t *rect)
+{
+  return gsk_hash_floats (seed, (float[4]) { rect->origin.x, rect->origin.y,
+                                             rect->size.width, rect->size.height }, 4);
+}
+
+static guint
+hash_rounded_rect (guint                 seed,
+                   const GskRoundedRect *rect)
+{
+  float values[12];
+
+  gsk_rounded_rect_to_float (rect, values);
+
+  return gsk_hash_floats (seed, values, 12);
+}
+
+static guint
+hash_matrix (guint                    seed,
+             const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+
+  return gsk_hash_floats (seed, values, 16);
+}
+
+static gboolean
+floats_equal (const float *values1,
+              const float *values2,
+              gsize        n_values)
+{
+  gsize i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      if (values1[i] != values2[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+rect_equal (const graphene_rect_t *rect1,
+            const graphene_rect_t *rect2)
+{
+  return rect1->origin.x == rect2->origin.x &&
+         rect1->origin.y == rect2->origin.y &&
+         rect1->size.width == rect2->size.width &&
+         rect1->size.height == rect2->size.height;
+}
+
+static gboolean
+rounded_rect_equal (const GskRoundedRect *rect1,
+                    const GskRoundedRect *rect2)
+{
+  float values1[12], values2[12];
+
+  gsk_rounded_rect_to_float (rect1, values1);
+  gsk_rounded_rect_to_float (rect2, values2);
+
+  return floats_equal (values1, values2, 12);
+}
+
+static gboolean
+matrix_equal (const graphene_matrix_t *matrix1,
+              const graphene_matrix_t *matrix2)
+{
+  float values1[16], values2[16];
+
+  graphene_matrix_to_float (matrix1, values1);
+  graphene_matrix_to_float (matrix2, values2);
+
+  return floats_equal (values1, values2, 16);
+}
+
 /*** GSK_COLOR_NODE ***/
 
 typedef struct _GskColorNode GskColorNode;
@@ -103,6 +193,24 @@ gsk_color_node_deserialize (GVariant  *variant,
   return gsk_color_node_new (&color, &GRAPHENE_RECT_INIT (x, y, w, h));
 }
 
+static guint
+gsk_color_node_hash (GskRenderNode *node)
+{
+  GskColorNode *self = (GskColorNode *) node;
+
+  return hash_rgba (0, &self->color);
+}
+
+static gboolean
+gsk_color_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskColorNode *self1 = (GskColorNode *) node1;
+  GskColorNode *self2 = (GskColorNode *) node2;
+
+  return gdk_rgba_equal (&self1->color, &self2->color);
+}
+
 static const GskRenderNodeClass GSK_COLOR_NODE_CLASS = {
   GSK_COLOR_NODE,
   sizeof (GskColorNode),
@@ -111,6 +219,8 @@ static const GskRenderNodeClass GSK_COLOR_NODE_CLASS = {
   gsk_color_node_draw,
   gsk_color_node_serialize,
   gsk_color_node_deserialize,
+  gsk_color_node_hash,
+  gsk_color_node_equal
 };
 
 const GdkRGBA *
@@ -147,6 +257,8 @@ gsk_color_node_new (const GdkRGBA         *rgba,
   self->color = *rgba;
   graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -281,6 +393,49 @@ gsk_repeating_linear_gradient_node_deserialize (GVariant  *variant,
   return gsk_linear_gradient_node_real_deserialize (variant, TRUE, error);
 }
 
+static guint
+gsk_linear_gradient_node_hash (GskRenderNode *node)
+{
+  GskLinearGradientNode *self = (GskLinearGradientNode *) node;
+  guint hash;
+  gsize i;
+
+  hash = gsk_hash_floats (self->n_stops, (float[4]) { self->start.x, self->start.y,
+                                                      self->end.x, self->end.y }, 4);
+  for (i = 0; i < self->n_stops; i++)
+    {
+      hash = gsk_hash_floats (hash, (float[1]) { self->stops[i].offset }, 1);
+      hash = hash_rgba (hash, &self->stops[i].color);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_linear_gradient_node_equal (GskRenderNode *node1,
+                                GskRenderNode *node2)
+{
+  GskLinearGradientNode *self1 = (GskLinearGradientNode *) node1;
+  GskLinearGradientNode *self2 = (GskLinearGradientNode *) node2;
+  gsize i;
+
+  if (self1->n_stops != self2->n_stops ||
+      self1->start.x != self2->start.x ||
+      self1->start.y != self2->start.y ||
+      self1->end.x != self2->end.x ||
+      self1->end.y != self2->end.y)
+    return FALSE;
+
+  for (i = 0; i < self1->n_stops; i++)
+    {
+      if (self1->stops[i].offset != self2->stops[i].offset ||
+          !gdk_rgba_equal (&self1->stops[i].color, &self2->stops[i].color))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GskRenderNodeClass GSK_LINEAR_GRADIENT_NODE_CLASS = {
   GSK_LINEAR_GRADIENT_NODE,
   sizeof (GskLinearGradientNode),
@@ -289,6 +444,8 @@ static const GskRenderNodeClass GSK_LINEAR_GRADIENT_NODE_CLASS = {
   gsk_linear_gradient_node_draw,
   gsk_linear_gradient_node_serialize,
   gsk_linear_gradient_node_deserialize,
+  gsk_linear_gradient_node_hash,
+  gsk_linear_gradient_node_equal
 };
 
 static const GskRenderNodeClass GSK_REPEATING_LINEAR_GRADIENT_NODE_CLASS = {
@@ -299,6 +456,8 @@ static const GskRenderNodeClass GSK_REPEATING_LINEAR_GRADIENT_NODE_CLASS = {
   gsk_linear_gradient_node_draw,
   gsk_linear_gradient_node_serialize,
   gsk_repeating_linear_gradient_node_deserialize,
+  gsk_linear_gradient_node_hash,
+  gsk_linear_gradient_node_equal
 };
 
 /**
@@ -345,6 +504,8 @@ gsk_linear_gradient_node_new (const graphene_rect_t  *bounds,
   memcpy (&self->stops, color_stops, sizeof (GskColorStop) * n_color_stops);
   self->n_stops = n_color_stops;
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -393,6 +554,8 @@ gsk_repeating_linear_gradient_node_new (const graphene_rect_t  *bounds,
   memcpy (&self->stops, color_stops, sizeof (GskColorStop) * n_color_stops);
   self->n_stops = n_color_stops;
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -428,6 +591,455 @@ gsk_linear_gradient_node_peek_color_stops (GskRenderNode *node)
   return self->stops;
 }
 
+/*** GSK_RADIAL_GRADIENT_NODE ***/
+
+typedef struct _GskRadialGradientNode GskRadialGradientNode;
+
+struct _GskRadialGradientNode
+{
+  GskRenderNode render_node;
+
+  graphene_point_t center;
+  float hradius;
+  float vradius;
+  float start;
+  float end;
+
+  gsize n_stops;
+  GskColorStop stops[];
+};
+
+static void
+gsk_radial_gradient_node_finalize (GskRenderNode *node)
+{
+}
+
+static void
+gsk_radial_gradient_node_draw (GskRenderNode *node,
+                               cairo_t       *cr)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+  cairo_pattern_t *pattern;
+  gsize i;
+
+  pattern = cairo_pattern_create_radial (0, 0, self->hradius * self->start,
+                                         0, 0, self->hradius * self->end);
+
+  if (self->hradius != self->vradius)
+    {
+      cairo_matrix_t matrix;
+
+      cairo_matrix_init_scale (&matrix, 1.0, self->hradius / self->vradius);
+      cairo_pattern_set_matrix (pattern, &matrix);
+    }
+
+  if (gsk_render_node_get_node_type (node) == GSK_REPEATING_RADIAL_GRADIENT_NODE)
+    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_REPEAT);
+  else
+    cairo_pattern_set_extend (pattern, CAIRO_EXTEND_PAD);
+
+  for (i = 0; i < self->n_stops; i++)
+    {
+      cairo_pattern_add_color_stop_rgba (pattern,
+                                         self->stops[i].offset,
+                                         self->stops[i].color.red,
+                                         self->stops[i].color.green,
+                                         self->stops[i].color.blue,
+                                         self->stops[i].color.alpha);
+    }
+
+  cairo_save (cr);
+
+  cairo_rectangle (cr,
+                   node->bounds.origin.x, node->bounds.origin.y,
+                   node->bounds.size.width, node->bounds.size.height);
+  cairo_translate (cr, self->center.x, self->center.y);
+  cairo_set_source (cr, pattern);
+  cairo_fill (cr);
+
+  cairo_restore (cr);
+
+  cairo_pattern_destroy (pattern);
+}
+
+#define GSK_RADIAL_GRADIENT_NODE_VARIANT_TYPE "(dddddddddda(ddddd))"
+
+static GVariant *
+gsk_radial_gradient_node_serialize (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+  GVariantBuilder builder;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ddddd)"));
+  for (i = 0; i < self->n_stops; i++)
+    {
+      g_variant_builder_add  (&builder, "(ddddd)",
+                              (double) self->stops[i].offset,
+                              self->stops[i].color.red, self->stops[i].color.green,
+                              self->stops[i].color.blue, self->stops[i].color.alpha);
+    }
+
+  return g_variant_new (GSK_RADIAL_GRADIENT_NODE_VARIANT_TYPE,
+                        (double) node->bounds.origin.x, (double) node->bounds.origin.y,
+                        (double) node->bounds.size.width, (double) node->bounds.size.height,
+                        (double) self->center.x, (double) self->center.y,
+                        (double) self->hradius, (double) self->vradius,
+                        (double) self->start, (double) self->end,
+                        &builder);
+}
+
+static GskRenderNode *
+gsk_radial_gradient_node_real_deserialize (GVariant  *variant,
+                                           gboolean   repeating,
+                                           GError   **error)
+{
+  GVariantIter *iter;
+  double x, y, w, h, center_x, center_y, hradius, vradius, start, end;
+  gsize i, n_stops;
+
+  if (!check_variant_type (variant, GSK_RADIAL_GRADIENT_NODE_VARIANT_TYPE, error))
+    return NULL;
+
+  g_variant_get (variant, GSK_RADIAL_GRADIENT_NODE_VARIANT_TYPE,
+                 &x, &y, &w, &h,
+                 &center_x, &center_y,
+                 &hradius, &vradius,
+                 &start, &end,
+                 &iter);
+
+  n_stops = g_variant_iter_n_children (iter);
+  GskColorStop *stops = g_newa (GskColorStop, n_stops);
+  for (i = 0; i < n_stops; i++)
+    {
+      double offset;
+      g_variant_iter_next (iter, "(ddddd)",
+                           &offset,
+                           &stops[i].color.red, &stops[i].color.green,
+                           &stops[i].color.blue, &stops[i].color.alpha);
+      stops[i].offset = offset;
+    }
+  g_variant_iter_free (iter);
+
+  return (repeating ? gsk_repeating_radial_gradient_node_new : gsk_radial_gradient_node_new)
+                      (&GRAPHENE_RECT_INIT (x, y, w, h),
+                       &GRAPHENE_POINT_INIT (center_x, center_y),
+                       hradius, vradius,
+                       start, end,
+                       stops,
+                       n_stops);
+}
+
+static GskRenderNode *
+gsk_radial_gradient_node_deserialize (GVariant  *variant,
+                                      GError   **error)
+{
+  return gsk_radial_gradient_node_real_deserialize (variant, FALSE, error);
+}
+
+static GskRenderNode *
+gsk_repeating_radial_gradient_node_deserialize (GVariant  *variant,
+                                                GError   **error)
+{
+  return gsk_radial_gradient_node_real_deserialize (variant, TRUE, error);
+}
+
+static guint
+gsk_radial_gradient_node_hash (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+  guint hash;
+  gsize i;
+
+  hash = gsk_hash_floats (self->n_stops, (float[6]) { self->center.x, self->center.y,
+                                                      self->hradius, self->vradius,
+                                                      self->start, self->end }, 6);
+  for (i = 0; i < self->n_stops; i++)
+    {
+      hash = gsk_hash_floats (hash, (float[1]) { self->stops[i].offset }, 1);
+      hash = hash_rgba (hash, &self->stops[i].color);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_radial_gradient_node_equal (GskRenderNode *node1,
+                                GskRenderNode *node2)
+{
+  GskRadialGradientNode *self1 = (GskRadialGradientNode *) node1;
+  GskRadialGradientNode *self2 = (GskRadialGradientNode *) node2;
+  gsize i;
+
+  if (self1->n_stops != self2->n_stops ||
+      self1->center.x != self2->center.x ||
+      self1->center.y != self2->center.y ||
+      self1->hradius != self2->hradius ||
+      self1->vradius != self2->vradius ||
+      self1->start != self2->start ||
+      self1->end != self2->end)
+    return FALSE;
+
+  for (i = 0; i < self1->n_stops; i++)
+    {
+      if (self1->stops[i].offset != self2->stops[i].offset ||
+          !gdk_rgba_equal (&self1->stops[i].color, &self2->stops[i].color))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static const GskRenderNodeClass GSK_RADIAL_GRADIENT_NODE_CLASS = {
+  GSK_RADIAL_GRADIENT_NODE,
+  sizeof (GskRadialGradientNode),
+  "GskRadialGradientNode",
+  gsk_radial_gradient_node_finalize,
+  gsk_radial_gradient_node_draw,
+  gsk_radial_gradient_node_serialize,
+  gsk_radial_gradient_node_deserialize,
+  gsk_radial_gradient_node_hash,
+  gsk_radial_gradient_node_equal
+};
+
+static const GskRenderNodeClass GSK_REPEATING_RADIAL_GRADIENT_NODE_CLASS = {
+  GSK_REPEATING_RADIAL_GRADIENT_NODE,
+  sizeof (GskRadialGradientNode),
+  "GskRepeatingRadialGradientNode",
+  gsk_radial_gradient_node_finalize,
+  gsk_radial_gradient_node_draw,
+  gsk_radial_gradient_node_serialize,
+  gsk_repeating_radial_gradient_node_deserialize,
+  gsk_radial_gradient_node_hash,
+  gsk_radial_gradient_node_equal
+};
+
+static GskRenderNode *
+gsk_radial_gradient_node_new_of_class (const GskRenderNodeClass *klass,
+                                       const graphene_rect_t    *bounds,
+                                       const graphene_point_t   *center,
+                                       float                     hradius,
+                                       float                     vradius,
+                                       float                     start,
+                                       float                     end,
+                                       const GskColorStop       *color_stops,
+                                       gsize                     n_color_stops)
+{
+  GskRadialGradientNode *self;
+  gsize i;
+
+  g_return_val_if_fail (bounds != NULL, NULL);
+  g_return_val_if_fail (center != NULL, NULL);
+  g_return_val_if_fail (hradius > 0., NULL);
+  g_return_val_if_fail (vradius > 0., NULL);
+  g_return_val_if_fail (start >= 0., NULL);
+  g_return_val_if_fail (end > start, NULL);
+  g_return_val_if_fail (color_stops != NULL, NULL);
+  g_return_val_if_fail (n_color_stops >= 2, NULL);
+  g_return_val_if_fail (color_stops[0].offset >= 0, NULL);
+  for (i = 1; i < n_color_stops; i++)
+    g_return_val_if_fail (color_stops[i].offset >= color_stops[i-1].offset, NULL);
+  g_return_val_if_fail (color_stops[n_color_stops - 1].offset <= 1, NULL);
+
+  self = (GskRadialGradientNode *) gsk_render_node_new (klass, sizeof (GskColorStop) * n_color_stops);
+
+  graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
+  graphene_point_init_from_point (&self->center, center);
+  self->hradius = hradius;
+  self->vradius = vradius;
+  self->start = start;
+  self->end = end;
+
+  memcpy (&self->stops, color_stops, sizeof (GskColorStop) * n_color_stops);
+  self->n_stops = n_color_stops;
+
+  gsk_render_node_init_hash (&self->render_node);
+
+  return &self->render_node;
+}
+
+/**
+ * gsk_radial_gradient_node_new:
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius of the gradient
+ * @vradius: the vertical radius of the gradient
+ * @start: the position of the first color stop, as a multiple of the radii
+ * @end: the position of the last color stop, as a multiple of the radii
+ * @color_stops: (array length=n_color_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_color_stops: the number of elements in @color_stops
+ *
+ * Creates a #GskRenderNode that draws a radial gradient into the area
+ * given by @bounds. The gradient is made of ellipses around @center
+ * with the given radii; a color stop with offset 0 lies on the
+ * ellipse scaled by @start, one with offset 1 on the ellipse scaled
+ * by @end. Outside of that range, the color of the closest stop
+ * is used.
+ *
+ * Returns: A new #GskRenderNode
+ *
+ * Since: 3.94
+ */
+GskRenderNode *
+gsk_radial_gradient_node_new (const graphene_rect_t  *bounds,
+                              const graphene_point_t *center,
+                              float                   hradius,
+                              float                   vradius,
+                              float                   start,
+                              float                   end,
+                              const GskColorStop     *color_stops,
+                              gsize                   n_color_stops)
+{
+  return gsk_radial_gradient_node_new_of_class (&GSK_RADIAL_GRADIENT_NODE_CLASS,
+                                                bounds, center,
+                                                hradius, vradius,
+                                                start, end,
+                                                color_stops, n_color_stops);
+}
+
+/**
+ * gsk_repeating_radial_gradient_node_new:
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius of the gradient
+ * @vradius: the vertical radius of the gradient
+ * @start: the position of the first color stop, as a multiple of the radii
+ * @end: the position of the last color stop, as a multiple of the radii
+ * @color_stops: (array length=n_color_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_color_stops: the number of elements in @color_stops
+ *
+ * Creates a #GskRenderNode that draws a repeating radial gradient into
+ * the area given by @bounds. This is like gsk_radial_gradient_node_new(),
+ * but the color stops are repeated outside of the range from @start
+ * to @end.
+ *
+ * Returns: A new #GskRenderNode
+ *
+ * Since: 3.94
+ */
+GskRenderNode *
+gsk_repeating_radial_gradient_node_new (const graphene_rect_t  *bounds,
+                                        const graphene_point_t *center,
+                                        float                   hradius,
+                                        float                   vradius,
+                                        float                   start,
+                                        float                   end,
+                                        const GskColorStop     *color_stops,
+                                        gsize                   n_color_stops)
+{
+  return gsk_radial_gradient_node_new_of_class (&GSK_REPEATING_RADIAL_GRADIENT_NODE_CLASS,
+                                                bounds, center,
+                                                hradius, vradius,
+                                                start, end,
+                                                color_stops, n_color_stops);
+}
+
+/**
+ * gsk_radial_gradient_node_peek_center:
+ * @node: a radial gradient #GskRenderNode
+ *
+ * Retrieves the center of the gradient.
+ *
+ * Returns: (transfer none): the center point
+ *
+ * Since: 3.94
+ */
+const graphene_point_t *
+gsk_radial_gradient_node_peek_center (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return &self->center;
+}
+
+/**
+ * gsk_radial_gradient_node_get_hradius:
+ * @node: a radial gradient #GskRenderNode
+ *
+ * Retrieves the horizontal radius of the gradient.
+ *
+ * Returns: the horizontal radius
+ *
+ * Since: 3.94
+ */
+float
+gsk_radial_gradient_node_get_hradius (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->hradius;
+}
+
+/**
+ * gsk_radial_gradient_node_get_vradius:
+ * @node: a radial gradient #GskRenderNode
+ *
+ * Retrieves the vertical radius of the gradient.
+ *
+ * Returns: the vertical radius
+ *
+ * Since: 3.94
+ */
+float
+gsk_radial_gradient_node_get_vradius (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->vradius;
+}
+
+/**
+ * gsk_radial_gradient_node_get_start:
+ * @node: a radial gradient #GskRenderNode
+ *
+ * Retrieves the position of the first color stop.
+ *
+ * Returns: the start, as a multiple of the radii
+ *
+ * Since: 3.94
+ */
+float
+gsk_radial_gradient_node_get_start (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->start;
+}
+
+/**
+ * gsk_radial_gradient_node_get_end:
+ * @node: a radial gradient #GskRenderNode
+ *
+ * Retrieves the position of the last color stop.
+ *
+ * Returns: the end, as a multiple of the radii
+ *
+ * Since: 3.94
+ */
+float
+gsk_radial_gradient_node_get_end (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->end;
+}
+
+gsize
+gsk_radial_gradient_node_get_n_color_stops (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->n_stops;
+}
+
+const GskColorStop *
+gsk_radial_gradient_node_peek_color_stops (GskRenderNode *node)
+{
+  GskRadialGradientNode *self = (GskRadialGradientNode *) node;
+
+  return self->stops;
+}
+
 /*** GSK_BORDER_NODE ***/
 
 typedef struct _GskBorderNode GskBorderNode;
@@ -571,17 +1183,53 @@ gsk_border_node_deserialize (GVariant  *variant,
                  &colors[2].red, &colors[2].green, &colors[2].blue, &colors[2].alpha,
                  &colors[3].red, &colors[3].green, &colors[3].blue, &colors[3].alpha);
 
-  return gsk_border_node_new (&(GskRoundedRect) {
-                                  .bounds = GRAPHENE_RECT_INIT(doutline[0], doutline[1], doutline[2], doutline[3]),
-                                  .corner = {
-                                      GRAPHENE_SIZE_INIT (doutline[4], doutline[5]),
-                                      GRAPHENE_SIZE_INIT (doutline[6], doutline[7]),
-                                      GRAPHENE_SIZE_INIT (doutline[8], doutline[9]),
-                                      GRAPHENE_SIZE_INIT (doutline[10], doutline[11])
-                                  }
-                              },
-                              (float[4]) { dwidths[0], dwidths[1], dwidths[2], dwidths[3] },
-                              colors);
+  return gsk_border_node_new (&(GskRoundedRect) {
+                                  .bounds = GRAPHENE_RECT_INIT(doutline[0], doutline[1], doutline[2], doutline[3]),
+                                  .corner = {
+                                      GRAPHENE_SIZE_INIT (doutline[4], doutline[5]),
+                                      GRAPHENE_SIZE_INIT (doutline[6], doutline[7]),
+                                      GRAPHENE_SIZE_INIT (doutline[8], doutline[9]),
+                                      GRAPHENE_SIZE_INIT (doutline[10], doutline[11])
+                                  }
+                              },
+                              (float[4]) { dwidths[0], dwidths[1], dwidths[2], dwidths[3] },
+                              colors);
+}
+
+static guint
+gsk_border_node_hash (GskRenderNode *node)
+{
+  GskBorderNode *self = (GskBorderNode *) node;
+  guint hash;
+  guint i;
+
+  hash = hash_rounded_rect (0, &self->outline);
+  hash = gsk_hash_floats (hash, self->border_width, 4);
+  for (i = 0; i < 4; i++)
+    hash = hash_rgba (hash, &self->border_color[i]);
+
+  return hash;
+}
+
+static gboolean
+gsk_border_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskBorderNode *self1 = (GskBorderNode *) node1;
+  GskBorderNode *self2 = (GskBorderNode *) node2;
+  guint i;
+
+  if (!rounded_rect_equal (&self1->outline, &self2->outline) ||
+      !floats_equal (self1->border_width, self2->border_width, 4))
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (!gdk_rgba_equal (&self1->border_color[i], &self2->border_color[i]))
+        return FALSE;
+    }
+
+  return TRUE;
 }
 
 static const GskRenderNodeClass GSK_BORDER_NODE_CLASS = {
@@ -591,7 +1239,9 @@ static const GskRenderNodeClass GSK_BORDER_NODE_CLASS = {
   gsk_border_node_finalize,
   gsk_border_node_draw,
   gsk_border_node_serialize,
-  gsk_border_node_deserialize
+  gsk_border_node_deserialize,
+  gsk_border_node_hash,
+  gsk_border_node_equal
 };
 
 const GskRoundedRect *
@@ -652,6 +1302,8 @@ gsk_border_node_new (const GskRoundedRect     *outline,
 
   graphene_rect_init_from_rect (&self->render_node.bounds, &self->outline.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -757,6 +1409,24 @@ gsk_texture_node_deserialize (GVariant  *variant,
   return node;
 }
 
+static guint
+gsk_texture_node_hash (GskRenderNode *node)
+{
+  GskTextureNode *self = (GskTextureNode *) node;
+
+  return g_direct_hash (self->texture);
+}
+
+static gboolean
+gsk_texture_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskTextureNode *self1 = (GskTextureNode *) node1;
+  GskTextureNode *self2 = (GskTextureNode *) node2;
+
+  return self1->texture == self2->texture;
+}
+
 static const GskRenderNodeClass GSK_TEXTURE_NODE_CLASS = {
   GSK_TEXTURE_NODE,
   sizeof (GskTextureNode),
@@ -764,7 +1434,9 @@ static const GskRenderNodeClass GSK_TEXTURE_NODE_CLASS = {
   gsk_texture_node_finalize,
   gsk_texture_node_draw,
   gsk_texture_node_serialize,
-  gsk_texture_node_deserialize
+  gsk_texture_node_deserialize,
+  gsk_texture_node_hash,
+  gsk_texture_node_equal
 };
 
 /**
@@ -811,6 +1483,8 @@ gsk_texture_node_new (GdkTexture            *texture,
   self->texture = g_object_ref (texture);
   graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -928,6 +1602,7 @@ draw_shadow_corner (cairo_t               *cr,
   cairo_matrix_t matrix;
   float sx, sy;
   static GHashTable *corner_mask_cache = NULL;
+  G_LOCK_DEFINE_STATIC (corner_mask_cache);
   float max_other;
   CornerMask key;
   gboolean overlapped;
@@ -1015,6 +1690,9 @@ draw_shadow_corner (cairo_t               *cr,
    * mask, so we cache rendered masks based on the blur radius and the
    * corner radius.
    */
+  /* The cairo renderer may draw tiles from several threads */
+  G_LOCK (corner_mask_cache);
+
   if (corner_mask_cache == NULL)
     corner_mask_cache = g_hash_table_new_full ((GHashFunc)corner_mask_hash,
                                                (GEqualFunc)corner_mask_equal,
@@ -1039,6 +1717,8 @@ draw_shadow_corner (cairo_t               *cr,
       g_hash_table_insert (corner_mask_cache, g_memdup (&key, sizeof (key)), mask);
     }
 
+  G_UNLOCK (corner_mask_cache);
+
   gdk_cairo_set_source_rgba (cr, color);
   pattern = cairo_pattern_create_for_surface (mask);
   cairo_matrix_init_identity (&matrix);
@@ -1267,6 +1947,33 @@ gsk_inset_shadow_node_deserialize (GVariant  *variant,
                                     &color, dx, dy, spread, radius);
 }
 
+static guint
+gsk_inset_shadow_node_hash (GskRenderNode *node)
+{
+  GskInsetShadowNode *self = (GskInsetShadowNode *) node;
+  guint hash;
+
+  hash = hash_rounded_rect (0, &self->outline);
+  hash = hash_rgba (hash, &self->color);
+
+  return gsk_hash_floats (hash, (float[4]) { self->dx, self->dy, self->spread, self->blur_radius }, 4);
+}
+
+static gboolean
+gsk_inset_shadow_node_equal (GskRenderNode *node1,
+                            GskRenderNode *node2)
+{
+  GskInsetShadowNode *self1 = (GskInsetShadowNode *) node1;
+  GskInsetShadowNode *self2 = (GskInsetShadowNode *) node2;
+
+  return rounded_rect_equal (&self1->outline, &self2->outline) &&
+         gdk_rgba_equal (&self1->color, &self2->color) &&
+         self1->dx == self2->dx &&
+         self1->dy == self2->dy &&
+         self1->spread == self2->spread &&
+         self1->blur_radius == self2->blur_radius;
+}
+
 static const GskRenderNodeClass GSK_INSET_SHADOW_NODE_CLASS = {
   GSK_INSET_SHADOW_NODE,
   sizeof (GskInsetShadowNode),
@@ -1274,7 +1981,9 @@ static const GskRenderNodeClass GSK_INSET_SHADOW_NODE_CLASS = {
   gsk_inset_shadow_node_finalize,
   gsk_inset_shadow_node_draw,
   gsk_inset_shadow_node_serialize,
-  gsk_inset_shadow_node_deserialize
+  gsk_inset_shadow_node_deserialize,
+  gsk_inset_shadow_node_hash,
+  gsk_inset_shadow_node_equal
 };
 
 /**
@@ -1317,6 +2026,8 @@ gsk_inset_shadow_node_new (const GskRoundedRect *outline,
 
   graphene_rect_init_from_rect (&self->render_node.bounds, &self->outline.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -1570,6 +2281,33 @@ gsk_outset_shadow_node_deserialize (GVariant  *variant,
                                      &color, dx, dy, spread, radius);
 }
 
+static guint
+gsk_outset_shadow_node_hash (GskRenderNode *node)
+{
+  GskOutsetShadowNode *self = (GskOutsetShadowNode *) node;
+  guint hash;
+
+  hash = hash_rounded_rect (0, &self->outline);
+  hash = hash_rgba (hash, &self->color);
+
+  return gsk_hash_floats (hash, (float[4]) { self->dx, self->dy, self->spread, self->blur_radius }, 4);
+}
+
+static gboolean
+gsk_outset_shadow_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskOutsetShadowNode *self1 = (GskOutsetShadowNode *) node1;
+  GskOutsetShadowNode *self2 = (GskOutsetShadowNode *) node2;
+
+  return rounded_rect_equal (&self1->outline, &self2->outline) &&
+         gdk_rgba_equal (&self1->color, &self2->color) &&
+         self1->dx == self2->dx &&
+         self1->dy == self2->dy &&
+         self1->spread == self2->spread &&
+         self1->blur_radius == self2->blur_radius;
+}
+
 static const GskRenderNodeClass GSK_OUTSET_SHADOW_NODE_CLASS = {
   GSK_OUTSET_SHADOW_NODE,
   sizeof (GskOutsetShadowNode),
@@ -1577,7 +2315,9 @@ static const GskRenderNodeClass GSK_OUTSET_SHADOW_NODE_CLASS = {
   gsk_outset_shadow_node_finalize,
   gsk_outset_shadow_node_draw,
   gsk_outset_shadow_node_serialize,
-  gsk_outset_shadow_node_deserialize
+  gsk_outset_shadow_node_deserialize,
+  gsk_outset_shadow_node_hash,
+  gsk_outset_shadow_node_equal
 };
 
 /**
@@ -1628,6 +2368,8 @@ gsk_outset_shadow_node_new (const GskRoundedRect *outline,
   self->render_node.bounds.size.width += left + right;
   self->render_node.bounds.size.height += top + bottom;
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -1827,6 +2569,25 @@ gsk_cairo_node_deserialize (GVariant  *variant,
   return result;
 }
 
+/* The surface is usually drawn to after the node was created,
+ * so it can't be part of the hash.
+ */
+static guint
+gsk_cairo_node_hash (GskRenderNode *node)
+{
+  return 0;
+}
+
+static gboolean
+gsk_cairo_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskCairoNode *self1 = (GskCairoNode *) node1;
+  GskCairoNode *self2 = (GskCairoNode *) node2;
+
+  return self1->surface == self2->surface;
+}
+
 static const GskRenderNodeClass GSK_CAIRO_NODE_CLASS = {
   GSK_CAIRO_NODE,
   sizeof (GskCairoNode),
@@ -1834,7 +2595,9 @@ static const GskRenderNodeClass GSK_CAIRO_NODE_CLASS = {
   gsk_cairo_node_finalize,
   gsk_cairo_node_draw,
   gsk_cairo_node_serialize,
-  gsk_cairo_node_deserialize
+  gsk_cairo_node_deserialize,
+  gsk_cairo_node_hash,
+  gsk_cairo_node_equal
 };
 
 const cairo_surface_t *
@@ -1860,6 +2623,8 @@ gsk_cairo_node_new_for_surface (const graphene_rect_t *bounds,
   graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
   self->surface = cairo_surface_reference (surface);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -1886,6 +2651,8 @@ gsk_cairo_node_new (const graphene_rect_t *bounds)
 
   graphene_rect_init_from_rect (&self->render_node.bounds, bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -1943,7 +2710,22 @@ gsk_cairo_node_get_draw_context (GskRenderNode *node,
     }
   else
     {
-      res = cairo_create (self->surface);
+      cairo_surface_t *surface;
+
+      /* Renderers keep the uploads of the surface around, so drawing
+       * to it again needs a new one */
+      surface = cairo_surface_create_similar (self->surface,
+                                              CAIRO_CONTENT_COLOR_ALPHA,
+                                              width, height);
+      res = cairo_create (surface);
+      cairo_set_source_surface (res, self->surface, 0, 0);
+      cairo_set_operator (res, CAIRO_OPERATOR_SOURCE);
+      cairo_paint (res);
+      cairo_set_operator (res, CAIRO_OPERATOR_OVER);
+      cairo_set_source_rgb (res, 0, 0, 0);
+
+      cairo_surface_destroy (self->surface);
+      self->surface = surface;
     }
 
   cairo_translate (res, -node->bounds.origin.x, -node->bounds.origin.y);
@@ -2085,6 +2867,39 @@ gsk_container_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_container_node_hash (GskRenderNode *node)
+{
+  GskContainerNode *self = (GskContainerNode *) node;
+  guint hash = self->n_children;
+  guint i;
+
+  for (i = 0; i < self->n_children; i++)
+    hash = gsk_hash_combine (hash, self->children[i]->hash);
+
+  return hash;
+}
+
+static gboolean
+gsk_container_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskContainerNode *self1 = (GskContainerNode *) node1;
+  GskContainerNode *self2 = (GskContainerNode *) node2;
+  guint i;
+
+  if (self1->n_children != self2->n_children)
+    return FALSE;
+
+  for (i = 0; i < self1->n_children; i++)
+    {
+      if (!gsk_render_node_equal (self1->children[i], self2->children[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GskRenderNodeClass GSK_CONTAINER_NODE_CLASS = {
   GSK_CONTAINER_NODE,
   sizeof (GskContainerNode),
@@ -2092,7 +2907,9 @@ static const GskRenderNodeClass GSK_CONTAINER_NODE_CLASS = {
   gsk_container_node_finalize,
   gsk_container_node_draw,
   gsk_container_node_serialize,
-  gsk_container_node_deserialize
+  gsk_container_node_deserialize,
+  gsk_container_node_hash,
+  gsk_container_node_equal
 };
 
 /**
@@ -2123,6 +2940,8 @@ gsk_container_node_new (GskRenderNode **children,
 
   gsk_container_node_get_bounds (container, &container->render_node.bounds);
 
+  gsk_render_node_init_hash (&container->render_node);
+
   return &container->render_node;
 }
 
@@ -2274,6 +3093,25 @@ gsk_transform_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_transform_node_hash (GskRenderNode *node)
+{
+  GskTransformNode *self = (GskTransformNode *) node;
+
+  return hash_matrix (self->child->hash, &self->transform);
+}
+
+static gboolean
+gsk_transform_node_equal (GskRenderNode *node1,
+                          GskRenderNode *node2)
+{
+  GskTransformNode *self1 = (GskTransformNode *) node1;
+  GskTransformNode *self2 = (GskTransformNode *) node2;
+
+  return matrix_equal (&self1->transform, &self2->transform) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_TRANSFORM_NODE_CLASS = {
   GSK_TRANSFORM_NODE,
   sizeof (GskTransformNode),
@@ -2281,7 +3119,9 @@ static const GskRenderNodeClass GSK_TRANSFORM_NODE_CLASS = {
   gsk_transform_node_finalize,
   gsk_transform_node_draw,
   gsk_transform_node_serialize,
-  gsk_transform_node_deserialize
+  gsk_transform_node_deserialize,
+  gsk_transform_node_hash,
+  gsk_transform_node_equal
 };
 
 /**
@@ -2313,6 +3153,8 @@ gsk_transform_node_new (GskRenderNode           *child,
   graphene_matrix_transform_bounds (&self->transform,
                                     &child->bounds,
                                     &self->render_node.bounds);
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -2429,6 +3271,25 @@ gsk_opacity_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_opacity_node_hash (GskRenderNode *node)
+{
+  GskOpacityNode *self = (GskOpacityNode *) node;
+
+  return gsk_hash_floats (self->child->hash, (float[1]) { self->opacity }, 1);
+}
+
+static gboolean
+gsk_opacity_node_equal (GskRenderNode *node1,
+                        GskRenderNode *node2)
+{
+  GskOpacityNode *self1 = (GskOpacityNode *) node1;
+  GskOpacityNode *self2 = (GskOpacityNode *) node2;
+
+  return self1->opacity == self2->opacity &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_OPACITY_NODE_CLASS = {
   GSK_OPACITY_NODE,
   sizeof (GskOpacityNode),
@@ -2436,7 +3297,9 @@ static const GskRenderNodeClass GSK_OPACITY_NODE_CLASS = {
   gsk_opacity_node_finalize,
   gsk_opacity_node_draw,
   gsk_opacity_node_serialize,
-  gsk_opacity_node_deserialize
+  gsk_opacity_node_deserialize,
+  gsk_opacity_node_hash,
+  gsk_opacity_node_equal
 };
 
 /**
@@ -2466,6 +3329,8 @@ gsk_opacity_node_new (GskRenderNode *child,
 
   graphene_rect_init_from_rect (&self->render_node.bounds, &child->bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -2666,6 +3531,33 @@ gsk_color_matrix_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_color_matrix_node_hash (GskRenderNode *node)
+{
+  GskColorMatrixNode *self = (GskColorMatrixNode *) node;
+  float offset[4];
+
+  graphene_vec4_to_float (&self->color_offset, offset);
+
+  return gsk_hash_floats (hash_matrix (self->child->hash, &self->color_matrix), offset, 4);
+}
+
+static gboolean
+gsk_color_matrix_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskColorMatrixNode *self1 = (GskColorMatrixNode *) node1;
+  GskColorMatrixNode *self2 = (GskColorMatrixNode *) node2;
+  float offset1[4], offset2[4];
+
+  graphene_vec4_to_float (&self1->color_offset, offset1);
+  graphene_vec4_to_float (&self2->color_offset, offset2);
+
+  return matrix_equal (&self1->color_matrix, &self2->color_matrix) &&
+         floats_equal (offset1, offset2, 4) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_COLOR_MATRIX_NODE_CLASS = {
   GSK_COLOR_MATRIX_NODE,
   sizeof (GskColorMatrixNode),
@@ -2673,7 +3565,9 @@ static const GskRenderNodeClass GSK_COLOR_MATRIX_NODE_CLASS = {
   gsk_color_matrix_node_finalize,
   gsk_color_matrix_node_draw,
   gsk_color_matrix_node_serialize,
-  gsk_color_matrix_node_deserialize
+  gsk_color_matrix_node_deserialize,
+  gsk_color_matrix_node_hash,
+  gsk_color_matrix_node_equal
 };
 
 /**
@@ -2710,6 +3604,8 @@ gsk_color_matrix_node_new (GskRenderNode           *child,
 
   graphene_rect_init_from_rect (&self->render_node.bounds, &child->bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -2856,6 +3752,25 @@ gsk_repeat_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_repeat_node_hash (GskRenderNode *node)
+{
+  GskRepeatNode *self = (GskRepeatNode *) node;
+
+  return hash_rect (self->child->hash, &self->child_bounds);
+}
+
+static gboolean
+gsk_repeat_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskRepeatNode *self1 = (GskRepeatNode *) node1;
+  GskRepeatNode *self2 = (GskRepeatNode *) node2;
+
+  return rect_equal (&self1->child_bounds, &self2->child_bounds) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_REPEAT_NODE_CLASS = {
   GSK_REPEAT_NODE,
   sizeof (GskRepeatNode),
@@ -2863,7 +3778,9 @@ static const GskRenderNodeClass GSK_REPEAT_NODE_CLASS = {
   gsk_repeat_node_finalize,
   gsk_repeat_node_draw,
   gsk_repeat_node_serialize,
-  gsk_repeat_node_deserialize
+  gsk_repeat_node_deserialize,
+  gsk_repeat_node_hash,
+  gsk_repeat_node_equal
 };
 
 /**
@@ -2899,6 +3816,8 @@ gsk_repeat_node_new (const graphene_rect_t *bounds,
   else
     graphene_rect_init_from_rect (&self->child_bounds, &child->bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -3003,6 +3922,25 @@ gsk_clip_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_clip_node_hash (GskRenderNode *node)
+{
+  GskClipNode *self = (GskClipNode *) node;
+
+  return hash_rect (self->child->hash, &self->clip);
+}
+
+static gboolean
+gsk_clip_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskClipNode *self1 = (GskClipNode *) node1;
+  GskClipNode *self2 = (GskClipNode *) node2;
+
+  return rect_equal (&self1->clip, &self2->clip) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_CLIP_NODE_CLASS = {
   GSK_CLIP_NODE,
   sizeof (GskClipNode),
@@ -3010,7 +3948,9 @@ static const GskRenderNodeClass GSK_CLIP_NODE_CLASS = {
   gsk_clip_node_finalize,
   gsk_clip_node_draw,
   gsk_clip_node_serialize,
-  gsk_clip_node_deserialize
+  gsk_clip_node_deserialize,
+  gsk_clip_node_hash,
+  gsk_clip_node_equal
 };
 
 /**
@@ -3041,6 +3981,8 @@ gsk_clip_node_new (GskRenderNode         *child,
 
   graphene_rect_intersection (&self->clip, &child->bounds, &self->render_node.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -3166,6 +4108,25 @@ gsk_rounded_clip_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_rounded_clip_node_hash (GskRenderNode *node)
+{
+  GskRoundedClipNode *self = (GskRoundedClipNode *) node;
+
+  return hash_rounded_rect (self->child->hash, &self->clip);
+}
+
+static gboolean
+gsk_rounded_clip_node_equal (GskRenderNode *node1,
+                             GskRenderNode *node2)
+{
+  GskRoundedClipNode *self1 = (GskRoundedClipNode *) node1;
+  GskRoundedClipNode *self2 = (GskRoundedClipNode *) node2;
+
+  return rounded_rect_equal (&self1->clip, &self2->clip) &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_ROUNDED_CLIP_NODE_CLASS = {
   GSK_ROUNDED_CLIP_NODE,
   sizeof (GskRoundedClipNode),
@@ -3173,7 +4134,9 @@ static const GskRenderNodeClass GSK_ROUNDED_CLIP_NODE_CLASS = {
   gsk_rounded_clip_node_finalize,
   gsk_rounded_clip_node_draw,
   gsk_rounded_clip_node_serialize,
-  gsk_rounded_clip_node_deserialize
+  gsk_rounded_clip_node_deserialize,
+  gsk_rounded_clip_node_hash,
+  gsk_rounded_clip_node_equal
 };
 
 /**
@@ -3204,6 +4167,8 @@ gsk_rounded_clip_node_new (GskRenderNode         *child,
 
   graphene_rect_intersection (&self->clip.bounds, &child->bounds, &self->render_node.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -3391,6 +4356,50 @@ gsk_shadow_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_shadow_node_hash (GskRenderNode *node)
+{
+  GskShadowNode *self = (GskShadowNode *) node;
+  guint hash = self->child->hash;
+  gsize i;
+
+  for (i = 0; i < self->n_shadows; i++)
+    {
+      const GskShadow *shadow = &self->shadows[i];
+
+      hash = hash_rgba (hash, &shadow->color);
+      hash = gsk_hash_floats (hash, (float[3]) { shadow->dx, shadow->dy, shadow->radius }, 3);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_shadow_node_equal (GskRenderNode *node1,
+                       GskRenderNode *node2)
+{
+  GskShadowNode *self1 = (GskShadowNode *) node1;
+  GskShadowNode *self2 = (GskShadowNode *) node2;
+  gsize i;
+
+  if (self1->n_shadows != self2->n_shadows)
+    return FALSE;
+
+  for (i = 0; i < self1->n_shadows; i++)
+    {
+      const GskShadow *shadow1 = &self1->shadows[i];
+      const GskShadow *shadow2 = &self2->shadows[i];
+
+      if (!gdk_rgba_equal (&shadow1->color, &shadow2->color) ||
+          shadow1->dx != shadow2->dx ||
+          shadow1->dy != shadow2->dy ||
+          shadow1->radius != shadow2->radius)
+        return FALSE;
+    }
+
+  return gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_SHADOW_NODE_CLASS = {
   GSK_SHADOW_NODE,
   sizeof (GskShadowNode),
@@ -3398,7 +4407,9 @@ static const GskRenderNodeClass GSK_SHADOW_NODE_CLASS = {
   gsk_shadow_node_finalize,
   gsk_shadow_node_draw,
   gsk_shadow_node_serialize,
-  gsk_shadow_node_deserialize
+  gsk_shadow_node_deserialize,
+  gsk_shadow_node_hash,
+  gsk_shadow_node_equal
 };
 
 /**
@@ -3433,6 +4444,8 @@ gsk_shadow_node_new (GskRenderNode         *child,
 
   gsk_shadow_node_get_bounds (self, &self->render_node.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -3607,6 +4620,29 @@ gsk_blend_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_blend_node_hash (GskRenderNode *node)
+{
+  GskBlendNode *self = (GskBlendNode *) node;
+  guint hash;
+
+  hash = gsk_hash_combine (self->blend_mode, self->bottom->hash);
+
+  return gsk_hash_combine (hash, self->top->hash);
+}
+
+static gboolean
+gsk_blend_node_equal (GskRenderNode *node1,
+                      GskRenderNode *node2)
+{
+  GskBlendNode *self1 = (GskBlendNode *) node1;
+  GskBlendNode *self2 = (GskBlendNode *) node2;
+
+  return self1->blend_mode == self2->blend_mode &&
+         gsk_render_node_equal (self1->bottom, self2->bottom) &&
+         gsk_render_node_equal (self1->top, self2->top);
+}
+
 static const GskRenderNodeClass GSK_BLEND_NODE_CLASS = {
   GSK_BLEND_NODE,
   sizeof (GskBlendNode),
@@ -3614,7 +4650,9 @@ static const GskRenderNodeClass GSK_BLEND_NODE_CLASS = {
   gsk_blend_node_finalize,
   gsk_blend_node_draw,
   gsk_blend_node_serialize,
-  gsk_blend_node_deserialize
+  gsk_blend_node_deserialize,
+  gsk_blend_node_hash,
+  gsk_blend_node_equal
 };
 
 /**
@@ -3648,6 +4686,8 @@ gsk_blend_node_new (GskRenderNode *bottom,
 
   graphene_rect_union (&bottom->bounds, &top->bounds, &self->render_node.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -3779,6 +4819,29 @@ gsk_cross_fade_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_cross_fade_node_hash (GskRenderNode *node)
+{
+  GskCrossFadeNode *self = (GskCrossFadeNode *) node;
+  guint hash;
+
+  hash = gsk_hash_floats (self->start->hash, (float[1]) { self->progress }, 1);
+
+  return gsk_hash_combine (hash, self->end->hash);
+}
+
+static gboolean
+gsk_cross_fade_node_equal (GskRenderNode *node1,
+                           GskRenderNode *node2)
+{
+  GskCrossFadeNode *self1 = (GskCrossFadeNode *) node1;
+  GskCrossFadeNode *self2 = (GskCrossFadeNode *) node2;
+
+  return self1->progress == self2->progress &&
+         gsk_render_node_equal (self1->start, self2->start) &&
+         gsk_render_node_equal (self1->end, self2->end);
+}
+
 static const GskRenderNodeClass GSK_CROSS_FADE_NODE_CLASS = {
   GSK_CROSS_FADE_NODE,
   sizeof (GskCrossFadeNode),
@@ -3786,7 +4849,9 @@ static const GskRenderNodeClass GSK_CROSS_FADE_NODE_CLASS = {
   gsk_cross_fade_node_finalize,
   gsk_cross_fade_node_draw,
   gsk_cross_fade_node_serialize,
-  gsk_cross_fade_node_deserialize
+  gsk_cross_fade_node_deserialize,
+  gsk_cross_fade_node_hash,
+  gsk_cross_fade_node_equal
 };
 
 /**
@@ -3820,6 +4885,8 @@ gsk_cross_fade_node_new (GskRenderNode *start,
 
   graphene_rect_union (&start->bounds, &end->bounds, &self->render_node.bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -4002,6 +5069,57 @@ gsk_text_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_text_node_hash (GskRenderNode *node)
+{
+  GskTextNode *self = (GskTextNode *) node;
+  guint hash;
+  guint i;
+
+  hash = gsk_hash_combine (g_direct_hash (self->font), self->num_glyphs);
+  hash = hash_rgba (hash, &self->color);
+  hash = gsk_hash_floats (hash, (float[2]) { self->x, self->y }, 2);
+  for (i = 0; i < self->num_glyphs; i++)
+    {
+      hash = gsk_hash_combine (hash, self->glyphs[i].glyph);
+      hash = gsk_hash_combine (hash, self->glyphs[i].geometry.width);
+    }
+
+  return hash;
+}
+
+static gboolean
+gsk_text_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskTextNode *self1 = (GskTextNode *) node1;
+  GskTextNode *self2 = (GskTextNode *) node2;
+  guint i;
+
+  /* Fonts are cached by the fontmap, so equal fonts are the same object */
+  if (self1->font != self2->font ||
+      self1->num_glyphs != self2->num_glyphs ||
+      self1->x != self2->x ||
+      self1->y != self2->y ||
+      !gdk_rgba_equal (&self1->color, &self2->color))
+    return FALSE;
+
+  for (i = 0; i < self1->num_glyphs; i++)
+    {
+      const PangoGlyphInfo *glyph1 = &self1->glyphs[i];
+      const PangoGlyphInfo *glyph2 = &self2->glyphs[i];
+
+      if (glyph1->glyph != glyph2->glyph ||
+          glyph1->geometry.width != glyph2->geometry.width ||
+          glyph1->geometry.x_offset != glyph2->geometry.x_offset ||
+          glyph1->geometry.y_offset != glyph2->geometry.y_offset ||
+          glyph1->attr.is_cluster_start != glyph2->attr.is_cluster_start)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static const GskRenderNodeClass GSK_TEXT_NODE_CLASS = {
   GSK_TEXT_NODE,
   sizeof (GskTextNode),
@@ -4009,7 +5127,9 @@ static const GskRenderNodeClass GSK_TEXT_NODE_CLASS = {
   gsk_text_node_finalize,
   gsk_text_node_draw,
   gsk_text_node_serialize,
-  gsk_text_node_deserialize
+  gsk_text_node_deserialize,
+  gsk_text_node_hash,
+  gsk_text_node_equal
 };
 
 /**
@@ -4060,6 +5180,8 @@ gsk_text_node_new (PangoFont        *font,
                       ink_rect.x + ink_rect.width,
                       ink_rect.height);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -4357,6 +5479,25 @@ gsk_blur_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static guint
+gsk_blur_node_hash (GskRenderNode *node)
+{
+  GskBlurNode *self = (GskBlurNode *) node;
+
+  return gsk_hash_floats (self->child->hash, (float[1]) { self->radius }, 1);
+}
+
+static gboolean
+gsk_blur_node_equal (GskRenderNode *node1,
+                     GskRenderNode *node2)
+{
+  GskBlurNode *self1 = (GskBlurNode *) node1;
+  GskBlurNode *self2 = (GskBlurNode *) node2;
+
+  return self1->radius == self2->radius &&
+         gsk_render_node_equal (self1->child, self2->child);
+}
+
 static const GskRenderNodeClass GSK_BLUR_NODE_CLASS = {
   GSK_BLUR_NODE,
   sizeof (GskBlurNode),
@@ -4364,7 +5505,9 @@ static const GskRenderNodeClass GSK_BLUR_NODE_CLASS = {
   gsk_blur_node_finalize,
   gsk_blur_node_draw,
   gsk_blur_node_serialize,
-  gsk_blur_node_deserialize
+  gsk_blur_node_deserialize,
+  gsk_blur_node_hash,
+  gsk_blur_node_equal
 };
 
 /**
@@ -4391,6 +5534,8 @@ gsk_blur_node_new (GskRenderNode *child,
 
   graphene_rect_init_from_rect (&self->render_node.bounds, &child->bounds);
 
+  gsk_render_node_init_hash (&self->render_node);
+
   return &self->render_node;
 }
 
@@ -4434,7 +5579,9 @@ static const GskRenderNodeClass *klasses[] = {
   [GSK_BLEND_NODE] = &GSK_BLEND_NODE_CLASS,
   [GSK_CROSS_FADE_NODE] = &GSK_CROSS_FADE_NODE_CLASS,
   [GSK_TEXT_NODE] = &GSK_TEXT_NODE_CLASS,
-  [GSK_BLUR_NODE] = &GSK_BLUR_NODE_CLASS
+  [GSK_BLUR_NODE] = &GSK_BLUR_NODE_CLASS,
+  [GSK_RADIAL_GRADIENT_NODE] = &GSK_RADIAL_GRADIENT_NODE_CLASS,
+  [GSK_REPEATING_RADIAL_GRADIENT_NODE] = &GSK_REPEATING_RADIAL_GRADIENT_NODE_CLASS
 };
 
 GskRenderNode *
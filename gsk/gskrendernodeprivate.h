@@ -16,6 +16,14 @@ struct _GskRenderNode
 
   volatile int ref_count;
 
+  /* The size of the allocation, for g_slice_free1() */
+  gsize alloc_size;
+
+  /* A structural hash of the node and its children, computed when
+   * the node is created. See gsk_render_node_equal().
+   */
+  guint hash;
+
   /* Use for debugging */
   char *name;
 
@@ -34,10 +42,44 @@ struct _GskRenderNodeClass
   GVariant *      (* serialize)   (GskRenderNode  *node);
   GskRenderNode * (* deserialize) (GVariant       *variant,
                                    GError        **error);
+  guint           (* hash)        (GskRenderNode  *node);
+  gboolean        (* equal)       (GskRenderNode  *node1,
+                                   GskRenderNode  *node2);
 };
 
+static inline guint
+gsk_hash_combine (guint seed,
+                  guint value)
+{
+  return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+static inline guint
+gsk_hash_floats (guint        seed,
+                 const float *values,
+                 gsize        n_values)
+{
+  gsize i;
+
+  for (i = 0; i < n_values; i++)
+    {
+      union { float f; guint32 u; } v;
+
+      /* 0.0 and -0.0 compare equal, so they must hash the same */
+      v.f = values[i] == 0.0f ? 0.0f : values[i];
+      seed = gsk_hash_combine (seed, v.u);
+    }
+
+  return seed;
+}
+
 GskRenderNode * gsk_render_node_new              (const GskRenderNodeClass  *node_class,
                                                   gsize                      extra_size);
+void            gsk_render_node_init_hash        (GskRenderNode             *node);
+
+guint           gsk_render_node_hash             (GskRenderNode             *node);
+gboolean        gsk_render_node_equal            (GskRenderNode             *node1,
+                                                  GskRenderNode             *node2);
 
 GVariant *      gsk_render_node_serialize_node   (GskRenderNode             *node);
 GskRenderNode * gsk_render_node_deserialize_node (GskRenderNodeType          type,
@@ -47,6 +89,13 @@ GskRenderNode * gsk_render_node_deserialize_node (GskRenderNodeType          typ
 GskRenderNode * gsk_cairo_node_new_for_surface   (const graphene_rect_t    *bounds,
                                                   cairo_surface_t          *surface);
 
+void            gsk_render_node_diff             (GskRenderNode            *node1,
+                                                  GskRenderNode            *node2,
+                                                  cairo_region_t           *region);
+
+GskRenderNode * gsk_render_node_optimize         (GskRenderNode            *node,
+                                                  const graphene_rect_t    *clip);
+
 G_END_DECLS
 
 #endif /* __GSK_RENDER_NODE_PRIVATE_H__ */
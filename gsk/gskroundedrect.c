@@ -530,3 +530,144 @@ gsk_rounded_rect_to_float (const GskRoundedRect *self,
     }
 }
 
+
+/* Whether the rounded corner @corner of @self reaches into @rect,
+ * assuming @rect is inside the bounds of @self.
+ */
+static gboolean
+gsk_rounded_rect_corner_intersects_rect (const GskRoundedRect  *self,
+                                         GskCorner              corner,
+                                         const graphene_rect_t *rect)
+{
+  const graphene_size_t *size = &self->corner[corner];
+
+  if (size->width <= 0 || size->height <= 0)
+    return FALSE;
+
+  switch (corner)
+    {
+    case GSK_CORNER_TOP_LEFT:
+      return rect->origin.x < self->bounds.origin.x + size->width &&
+             rect->origin.y < self->bounds.origin.y + size->height;
+    case GSK_CORNER_TOP_RIGHT:
+      return rect->origin.x + rect->size.width > self->bounds.origin.x + self->bounds.size.width - size->width &&
+             rect->origin.y < self->bounds.origin.y + size->height;
+    case GSK_CORNER_BOTTOM_RIGHT:
+      return rect->origin.x + rect->size.width > self->bounds.origin.x + self->bounds.size.width - size->width &&
+             rect->origin.y + rect->size.height > self->bounds.origin.y + self->bounds.size.height - size->height;
+    case GSK_CORNER_BOTTOM_LEFT:
+      return rect->origin.x < self->bounds.origin.x + size->width &&
+             rect->origin.y + rect->size.height > self->bounds.origin.y + self->bounds.size.height - size->height;
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+/* Whether the corner @corner of @self and of @rect are at the same place */
+static gboolean
+gsk_rounded_rect_corner_matches_rect (const GskRoundedRect  *self,
+                                      GskCorner              corner,
+                                      const graphene_rect_t *rect)
+{
+  gboolean left = corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_BOTTOM_LEFT;
+  gboolean top = corner == GSK_CORNER_TOP_LEFT || corner == GSK_CORNER_TOP_RIGHT;
+
+  if (left ? rect->origin.x != self->bounds.origin.x
+           : rect->origin.x + rect->size.width != self->bounds.origin.x + self->bounds.size.width)
+    return FALSE;
+
+  if (top ? rect->origin.y != self->bounds.origin.y
+          : rect->origin.y + rect->size.height != self->bounds.origin.y + self->bounds.size.height)
+    return FALSE;
+
+  return TRUE;
+}
+
+/*< private >
+ * gsk_rounded_rect_intersection:
+ * @a: a #GskRoundedRect
+ * @b: another #GskRoundedRect
+ * @result: (out caller-allocates): return location for the intersection
+ *
+ * Computes the intersection of @a and @b, if it can be expressed as
+ * a rounded rectangle. That is the case if every corner of the
+ * intersection is a corner of @a or @b, or is not rounded at all.
+ *
+ * If @a and @b don't intersect, @result is set to an empty rectangle.
+ *
+ * Returns: %FALSE if the intersection is not a rounded rectangle
+ */
+gboolean
+gsk_rounded_rect_intersection (const GskRoundedRect *a,
+                               const GskRoundedRect *b,
+                               GskRoundedRect       *result)
+{
+  graphene_rect_t bounds;
+  guint i;
+
+  if (gsk_rounded_rect_contains_rect (a, &b->bounds))
+    {
+      gsk_rounded_rect_init_copy (result, b);
+      return TRUE;
+    }
+  if (gsk_rounded_rect_contains_rect (b, &a->bounds))
+    {
+      gsk_rounded_rect_init_copy (result, a);
+      return TRUE;
+    }
+
+  if (!graphene_rect_intersection (&a->bounds, &b->bounds, &bounds))
+    {
+      gsk_rounded_rect_init_from_rect (result, graphene_rect_zero (), 0);
+      return TRUE;
+    }
+
+  result->bounds = bounds;
+
+  for (i = 0; i < 4; i++)
+    {
+      gboolean in_a = gsk_rounded_rect_corner_intersects_rect (a, i, &bounds);
+      gboolean in_b = gsk_rounded_rect_corner_intersects_rect (b, i, &bounds);
+
+      /* A rounded corner that reaches into the intersection must
+       * become its corner, and there can only be one of them.
+       */
+      if (in_a && in_b)
+        {
+          if (!gsk_rounded_rect_corner_matches_rect (a, i, &bounds) ||
+              !gsk_rounded_rect_corner_matches_rect (b, i, &bounds) ||
+              !graphene_size_equal (&a->corner[i], &b->corner[i]))
+            return FALSE;
+
+          result->corner[i] = a->corner[i];
+        }
+      else if (in_a)
+        {
+          if (!gsk_rounded_rect_corner_matches_rect (a, i, &bounds))
+            return FALSE;
+
+          result->corner[i] = a->corner[i];
+        }
+      else if (in_b)
+        {
+          if (!gsk_rounded_rect_corner_matches_rect (b, i, &bounds))
+            return FALSE;
+
+          result->corner[i] = b->corner[i];
+        }
+      else
+        {
+          result->corner[i] = GRAPHENE_SIZE_INIT (0, 0);
+        }
+    }
+
+  /* The corners must still fit, or the other rectangle cuts into them */
+  if (result->corner[GSK_CORNER_TOP_LEFT].width + result->corner[GSK_CORNER_TOP_RIGHT].width > bounds.size.width ||
+      result->corner[GSK_CORNER_BOTTOM_LEFT].width + result->corner[GSK_CORNER_BOTTOM_RIGHT].width > bounds.size.width ||
+      result->corner[GSK_CORNER_TOP_LEFT].height + result->corner[GSK_CORNER_BOTTOM_LEFT].height > bounds.size.height ||
+      result->corner[GSK_CORNER_TOP_RIGHT].height + result->corner[GSK_CORNER_BOTTOM_RIGHT].height > bounds.size.height)
+    return FALSE;
+
+  return TRUE;
+}
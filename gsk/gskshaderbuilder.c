@@ -3,6 +3,7 @@
 #include "gskshaderbuilderprivate.h"
 
 #include "gskdebugprivate.h"
+#include "gskdiskcacheprivate.h"
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
@@ -202,17 +203,13 @@ lookup_shader_code (GString *code,
   return TRUE;
 }
 
-static int
-gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
-                                   int               shader_type,
-                                   const char       *shader_preamble,
-                                   const char       *shader_source,
-                                   GError          **error)
+static char *
+gsk_shader_builder_get_shader_code (GskShaderBuilder *builder,
+                                    const char       *shader_preamble,
+                                    const char       *shader_source,
+                                    GError          **error)
 {
   GString *code;
-  char *source;
-  int shader_id;
-  int status;
   int i;
 
   code = g_string_new (NULL);
@@ -242,7 +239,7 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
   if (!lookup_shader_code (code, builder->resource_base_path, shader_preamble, error))
     {
       g_string_free (code, TRUE);
-      return -1;
+      return NULL;
     }
 
   g_string_append_c (code, '\n');
@@ -250,10 +247,22 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
   if (!lookup_shader_code (code, builder->resource_base_path, shader_source, error))
     {
       g_string_free (code, TRUE);
-      return -1;
+      return NULL;
     }
 
-  source = g_string_free (code, FALSE);
+  return g_string_free (code, FALSE);
+}
+
+static int
+gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
+                                   int               shader_type,
+                                   const char       *shader_preamble,
+                                   const char       *shader_source,
+                                   const char       *source,
+                                   GError          **error)
+{
+  int shader_id;
+  int status;
 
   shader_id = glCreateShader (shader_type);
   glShaderSource (shader_id, 1, (const GLchar **) &source, NULL);
@@ -270,8 +279,6 @@ gsk_shader_builder_compile_shader (GskShaderBuilder *builder,
     }
 #endif
 
-  g_free (source);
-
   glGetShaderiv (shader_id, GL_COMPILE_STATUS, &status);
   if (status == GL_FALSE)
     {
@@ -331,24 +338,107 @@ gsk_shader_builder_cache_attributes (GskShaderBuilder *builder,
     }
 }
 
-int
-gsk_shader_builder_create_program (GskShaderBuilder *builder,
-                                   const char       *vertex_shader,
-                                   const char       *fragment_shader,
-                                   GError          **error)
+static gboolean
+has_program_binaries (void)
 {
-  ShaderProgram *program;
-  int vertex_id, fragment_id;
+  int n_formats = 0;
+
+  if (epoxy_is_desktop_gl ())
+    {
+      if (epoxy_gl_version () < 41 && !epoxy_has_gl_extension ("GL_ARB_get_program_binary"))
+        return FALSE;
+    }
+  else
+    {
+      if (epoxy_gl_version () < 30 && !epoxy_has_gl_extension ("GL_OES_get_program_binary"))
+        return FALSE;
+    }
+
+  glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+
+  return n_formats > 0;
+}
+
+/* Cached programs start with the binary format */
+typedef struct {
+  guint32 format;
+  guint8 data[];
+} ProgramBinary;
+
+static int
+gsk_shader_builder_load_program (const char *cache_key)
+{
+  const ProgramBinary *binary;
+  GBytes *bytes;
+  gsize size;
   int program_id;
   int status;
 
-  g_return_val_if_fail (GSK_IS_SHADER_BUILDER (builder), -1);
-  g_return_val_if_fail (vertex_shader != NULL, -1);
-  g_return_val_if_fail (fragment_shader != NULL, -1);
+  bytes = gsk_disk_cache_load ("gl-programs", cache_key);
+  if (bytes == NULL)
+    return -1;
+
+  binary = g_bytes_get_data (bytes, &size);
+  if (size <= sizeof (ProgramBinary))
+    {
+      g_bytes_unref (bytes);
+      return -1;
+    }
+
+  program_id = glCreateProgram ();
+  glProgramBinary (program_id, binary->format, binary->data, size - sizeof (ProgramBinary));
+  g_bytes_unref (bytes);
+
+  /* This fails if the driver changed in a way that invalidates binaries */
+  glGetProgramiv (program_id, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE)
+    {
+      GSK_NOTE (SHADERS, g_message ("Cached program %s is not valid anymore", cache_key));
+      glDeleteProgram (program_id);
+      return -1;
+    }
+
+  return program_id;
+}
+
+static void
+gsk_shader_builder_save_program (const char *cache_key,
+                                 int         program_id)
+{
+  ProgramBinary *binary;
+  int length = 0;
+  GLenum format;
+
+  glGetProgramiv (program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  binary = g_malloc (sizeof (ProgramBinary) + length);
+  glGetProgramBinary (program_id, length, &length, &format, binary->data);
+  binary->format = format;
+
+  gsk_disk_cache_save ("gl-programs", cache_key, binary, sizeof (ProgramBinary) + length);
+
+  g_free (binary);
+}
+
+static int
+gsk_shader_builder_link_program (GskShaderBuilder *builder,
+                                 const char       *vertex_shader,
+                                 const char       *fragment_shader,
+                                 const char       *vertex_source,
+                                 const char       *fragment_source,
+                                 gboolean          retrievable,
+                                 GError          **error)
+{
+  int vertex_id, fragment_id;
+  int program_id;
+  int status;
 
   vertex_id = gsk_shader_builder_compile_shader (builder, GL_VERTEX_SHADER,
                                                  builder->vertex_preamble,
                                                  vertex_shader,
+                                                 vertex_source,
                                                  error);
   if (vertex_id < 0)
     return -1;
@@ -356,6 +446,7 @@ gsk_shader_builder_create_program (GskShaderBuilder *builder,
   fragment_id = gsk_shader_builder_compile_shader (builder, GL_FRAGMENT_SHADER,
                                                    builder->fragment_preamble,
                                                    fragment_shader,
+                                                   fragment_source,
                                                    error);
   if (fragment_id < 0)
     {
@@ -366,6 +457,8 @@ gsk_shader_builder_create_program (GskShaderBuilder *builder,
   program_id = glCreateProgram ();
   glAttachShader (program_id, vertex_id);
   glAttachShader (program_id, fragment_id);
+  if (retrievable)
+    glProgramParameteri (program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &status);
@@ -385,10 +478,82 @@ gsk_shader_builder_create_program (GskShaderBuilder *builder,
 
       glDeleteProgram (program_id);
       program_id = -1;
+    }
+
+  if (program_id > 0)
+    glDetachShader (program_id, vertex_id);
+  glDeleteShader (vertex_id);
+
+  if (program_id > 0)
+    glDetachShader (program_id, fragment_id);
+  glDeleteShader (fragment_id);
+
+  return program_id;
+}
+
+int
+gsk_shader_builder_create_program (GskShaderBuilder *builder,
+                                   const char       *vertex_shader,
+                                   const char       *fragment_shader,
+                                   GError          **error)
+{
+  ShaderProgram *program;
+  char *vertex_source, *fragment_source;
+  char *cache_key = NULL;
+  int program_id = -1;
 
-      goto out;
+  g_return_val_if_fail (GSK_IS_SHADER_BUILDER (builder), -1);
+  g_return_val_if_fail (vertex_shader != NULL, -1);
+  g_return_val_if_fail (fragment_shader != NULL, -1);
+
+  vertex_source = gsk_shader_builder_get_shader_code (builder,
+                                                      builder->vertex_preamble,
+                                                      vertex_shader,
+                                                      error);
+  if (vertex_source == NULL)
+    return -1;
+
+  fragment_source = gsk_shader_builder_get_shader_code (builder,
+                                                        builder->fragment_preamble,
+                                                        fragment_shader,
+                                                        error);
+  if (fragment_source == NULL)
+    {
+      g_free (vertex_source);
+      return -1;
     }
 
+  /* Programs are cached on disk, unless we want to see them being compiled */
+  if (!GSK_DEBUG_CHECK (SHADERS) && has_program_binaries ())
+    {
+      cache_key = gsk_disk_cache_compute_key ((const char *) glGetString (GL_VENDOR),
+                                              (const char *) glGetString (GL_RENDERER),
+                                              (const char *) glGetString (GL_VERSION),
+                                              vertex_source,
+                                              fragment_source,
+                                              NULL);
+      program_id = gsk_shader_builder_load_program (cache_key);
+    }
+
+  if (program_id < 0)
+    {
+      program_id = gsk_shader_builder_link_program (builder,
+                                                    vertex_shader, fragment_shader,
+                                                    vertex_source, fragment_source,
+                                                    cache_key != NULL,
+                                                    error);
+
+      if (program_id > 0 && cache_key != NULL)
+        gsk_shader_builder_save_program (cache_key, program_id);
+    }
+
+  g_free (cache_key);
+  g_free (vertex_source);
+  g_free (fragment_source);
+
+  if (program_id < 0)
+    return -1;
+
   program = shader_program_new (program_id);
   gsk_shader_builder_cache_uniforms (builder, program);
   gsk_shader_builder_cache_attributes (builder, program);
@@ -419,19 +584,6 @@ gsk_shader_builder_create_program (GskShaderBuilder *builder,
     }
 #endif
 
-out:
-  if (vertex_id > 0)
-    {
-      glDetachShader (program_id, vertex_id);
-      glDeleteShader (vertex_id);
-    }
-
-  if (fragment_id > 0)
-    {
-      glDetachShader (program_id, fragment_id);
-      glDeleteShader (fragment_id);
-    }
-
   return program_id;
 }
 
@@ -13,6 +13,11 @@ uniform vec4 u_clip;
 uniform vec4 u_clip_corner_widths;
 uniform vec4 u_clip_corner_heights;
 
+// A second clip for nested clips, unused if it is empty
+uniform vec4 u_extra_clip;
+uniform vec4 u_extra_clip_corner_widths;
+uniform vec4 u_extra_clip_corner_heights;
+
 varying vec2 vUv;
 
 
@@ -99,7 +104,16 @@ void setOutputColor(vec4 color) {
   clipBounds.w = clipBounds.y + clipBounds.w;
 
   RoundedRect r = RoundedRect(clipBounds, u_clip_corner_widths, u_clip_corner_heights);
+  float coverage = rounded_rect_coverage(r, f.xy);
+
+  if (u_extra_clip.z > 0.0)
+    {
+      vec4 extraBounds = vec4(u_extra_clip.xy, u_extra_clip.xy + u_extra_clip.zw);
+      RoundedRect e = RoundedRect(extraBounds, u_extra_clip_corner_widths, u_extra_clip_corner_heights);
+
+      coverage *= rounded_rect_coverage(e, f.xy);
+    }
 
-  gl_FragColor = color * rounded_rect_coverage(r, f.xy);
+  gl_FragColor = color * coverage;
   /*gl_FragColor = color;*/
 }
@@ -0,0 +1,42 @@
+uniform vec4 u_color_stops[8];
+uniform float u_color_offsets[8];
+uniform int u_num_color_stops;
+uniform vec2 u_center;
+uniform vec2 u_radius;
+uniform float u_start;
+uniform float u_end;
+uniform bool u_repeat;
+
+vec4 fragCoord() {
+  vec4 f = gl_FragCoord;
+  f.x += u_viewport.x;
+  f.y = (u_viewport.y + u_viewport.w) - f.y;
+  return f;
+}
+
+void main() {
+  vec2 center = (u_modelview * vec4(u_center, 0, 1)).xy;
+  vec2 radius = abs((u_modelview * vec4(u_radius, 0, 0)).xy);
+
+  // Position relative to the center, in units of the radii
+  vec2 pos = (fragCoord().xy - center) / radius;
+
+  // Offset of the current pixel between the start and end ellipses
+  float offset = (length(pos) - u_start) / (u_end - u_start);
+
+  if (u_repeat)
+    offset = fract(offset);
+
+  vec4 color = u_color_stops[0];
+  for (int i = 1; i < u_num_color_stops; i ++) {
+    if (offset >= u_color_offsets[i - 1])  {
+      float o = (offset - u_color_offsets[i - 1]) / (u_color_offsets[i] - u_color_offsets[i - 1]);
+      color = mix(u_color_stops[i - 1], u_color_stops[i], clamp(o, 0.0, 1.0));
+    }
+  }
+
+  /* Pre-multiply */
+  color.rgb *= color.a;
+
+  setOutputColor(color * u_alpha);
+}
@@ -155,7 +155,7 @@ gsk_vulkan_box_shadow_pipeline_draw (GskVulkanBoxShadowPipeline *pipeline,
                                      gsize                   n_commands)
 {
   vkCmdDraw (command_buffer,
-             6 * 8, n_commands,
+             6, n_commands,
              0, offset);
 
   return n_commands;
@@ -20,6 +20,78 @@ gsk_vulkan_clip_init_copy (GskVulkanClip *self,
   gsk_rounded_rect_init_copy (&self->rect, &src->rect);
 }
 
+static void
+gsk_vulkan_clip_init_rounded (GskVulkanClip        *self,
+                              const GskRoundedRect *rounded)
+{
+  gsk_rounded_rect_init_copy (&self->rect, rounded);
+
+  if (gsk_rounded_rect_is_rectilinear (rounded))
+    self->type = GSK_VULKAN_CLIP_RECT;
+  else if (gsk_rounded_rect_is_circular (rounded))
+    self->type = GSK_VULKAN_CLIP_ROUNDED_CIRCULAR;
+  else
+    self->type = GSK_VULKAN_CLIP_ROUNDED;
+}
+
+/* Intersecting a rounded rect with a rectangle can be expressed as a
+ * rounded rect if every corner is either kept as is or cut away
+ * completely. */
+static gboolean
+gsk_vulkan_clip_intersect_rounded_with_rect (GskRoundedRect        *dest,
+                                             const GskRoundedRect  *rounded,
+                                             const graphene_rect_t *rect)
+{
+  graphene_rect_t bounds;
+  float left, top, right, bottom;
+  float new_left, new_top, new_right, new_bottom;
+  gboolean keep[4];
+  guint i;
+
+  if (!graphene_rect_intersection (&rounded->bounds, rect, &bounds))
+    return FALSE;
+
+  left = rounded->bounds.origin.x;
+  top = rounded->bounds.origin.y;
+  right = left + rounded->bounds.size.width;
+  bottom = top + rounded->bounds.size.height;
+  new_left = bounds.origin.x;
+  new_top = bounds.origin.y;
+  new_right = new_left + bounds.size.width;
+  new_bottom = new_top + bounds.size.height;
+
+  keep[GSK_CORNER_TOP_LEFT] = new_left == left && new_top == top;
+  keep[GSK_CORNER_TOP_RIGHT] = new_right == right && new_top == top;
+  keep[GSK_CORNER_BOTTOM_RIGHT] = new_right == right && new_bottom == bottom;
+  keep[GSK_CORNER_BOTTOM_LEFT] = new_left == left && new_bottom == bottom;
+
+  /* corners that are not kept must be outside of the new bounds */
+  if ((!keep[GSK_CORNER_TOP_LEFT] &&
+       new_left < left + rounded->corner[GSK_CORNER_TOP_LEFT].width &&
+       new_top < top + rounded->corner[GSK_CORNER_TOP_LEFT].height) ||
+      (!keep[GSK_CORNER_TOP_RIGHT] &&
+       new_right > right - rounded->corner[GSK_CORNER_TOP_RIGHT].width &&
+       new_top < top + rounded->corner[GSK_CORNER_TOP_RIGHT].height) ||
+      (!keep[GSK_CORNER_BOTTOM_RIGHT] &&
+       new_right > right - rounded->corner[GSK_CORNER_BOTTOM_RIGHT].width &&
+       new_bottom > bottom - rounded->corner[GSK_CORNER_BOTTOM_RIGHT].height) ||
+      (!keep[GSK_CORNER_BOTTOM_LEFT] &&
+       new_left < left + rounded->corner[GSK_CORNER_BOTTOM_LEFT].width &&
+       new_bottom > bottom - rounded->corner[GSK_CORNER_BOTTOM_LEFT].height))
+    return FALSE;
+
+  dest->bounds = bounds;
+  for (i = 0; i < 4; i++)
+    {
+      if (keep[i])
+        dest->corner[i] = rounded->corner[i];
+      else
+        dest->corner[i] = GRAPHENE_SIZE_INIT (0, 0);
+    }
+
+  return TRUE;
+}
+
 gboolean
 gsk_vulkan_clip_intersect_rect (GskVulkanClip         *dest,
                                 const GskVulkanClip   *src,
@@ -65,13 +137,16 @@ gsk_vulkan_clip_intersect_rect (GskVulkanClip         *dest,
         }
       else
         {
+          GskRoundedRect rounded;
+
           /* some points of rect are inside src's rounded rect,
            * some are outside. */
-          /* XXX: If the 2 rects don't intersect on rounded corners,
-           * we could actually compute a new clip here.
-           */
-          return FALSE;
+          if (!gsk_vulkan_clip_intersect_rounded_with_rect (&rounded, &src->rect, rect))
+            return FALSE;
+
+          gsk_vulkan_clip_init_rounded (dest, &rounded);
         }
+      break;
 
     default:
       g_assert_not_reached ();
@@ -104,23 +179,27 @@ gsk_vulkan_clip_intersect_rounded_rect (GskVulkanClip        *dest,
       break;
 
     case GSK_VULKAN_CLIP_NONE:
-      dest->type = gsk_rounded_rect_is_circular (&dest->rect) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
-      gsk_rounded_rect_init_copy (&dest->rect, rounded);
+      gsk_vulkan_clip_init_rounded (dest, rounded);
       break;
 
     case GSK_VULKAN_CLIP_RECT:
       if (graphene_rect_contains_rect (&src->rect.bounds, &rounded->bounds))
         {
-          dest->type = gsk_rounded_rect_is_circular (&dest->rect) ? GSK_VULKAN_CLIP_ROUNDED_CIRCULAR : GSK_VULKAN_CLIP_ROUNDED;
-          gsk_rounded_rect_init_copy (&dest->rect, rounded);
+          gsk_vulkan_clip_init_rounded (dest, rounded);
           return TRUE;
         }
-      /* some points of rect are inside src's rounded rect,
-       * some are outside. */
-      /* XXX: If the 2 rects don't intersect on rounded corners,
-       * we could actually compute a new clip here.
-       */
-      return FALSE;
+      else
+        {
+          GskRoundedRect intersection;
+
+          /* some points of rect are inside src's rounded rect,
+           * some are outside. */
+          if (!gsk_vulkan_clip_intersect_rounded_with_rect (&intersection, rounded, &src->rect.bounds))
+            return FALSE;
+
+          gsk_vulkan_clip_init_rounded (dest, &intersection);
+        }
+      break;
 
     case GSK_VULKAN_CLIP_ROUNDED_CIRCULAR:
     case GSK_VULKAN_CLIP_ROUNDED:
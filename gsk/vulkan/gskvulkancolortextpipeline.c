@@ -2,6 +2,8 @@
 
 #include "gskvulkancolortextpipelineprivate.h"
 
+#include <math.h>
+
 struct _GskVulkanColorTextPipeline
 {
   GObject parent_instance;
@@ -122,10 +124,15 @@ gsk_vulkan_color_text_pipeline_collect_vertex_data (GskVulkanColorTextPipeline *
         {
           double cx = (double)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
           double cy = (double)(gi->geometry.y_offset) / PANGO_SCALE;
+          guint phase;
           GskVulkanColorTextInstance *instance = &instances[count];
-          GskVulkanCachedGlyph *glyph;
+          GskCachedGlyph *glyph;
+
+          /* same as in gsk_vulkan_render_pass_add_node() */
+          cx = gsk_glyph_cache_snap_x (x + cx, scale, &phase) - x;
+          cy = roundf ((y + cy) * scale) / scale - y;
 
-          glyph = gsk_vulkan_renderer_get_cached_glyph (renderer, font, gi->glyph, scale);
+          glyph = gsk_vulkan_renderer_get_cached_glyph (renderer, font, gi->glyph, phase, scale);
 
           instance->tex_rect[0] = glyph->tx;
           instance->tex_rect[1] = glyph->ty;
@@ -80,10 +80,29 @@ gsk_vulkan_command_pool_submit_buffer (GskVulkanCommandPool *self,
                                        gsize                 signal_semaphore_count,
                                        VkSemaphore          *signal_semaphores,
                                        VkFence               fence)
+{
+  gsk_vulkan_command_pool_submit_buffers (self,
+                                          1, &command_buffer,
+                                          wait_semaphore_count, wait_semaphores,
+                                          signal_semaphore_count, signal_semaphores,
+                                          fence);
+}
+
+/* Ends and submits all @buffers in order with a single vkQueueSubmit() */
+void
+gsk_vulkan_command_pool_submit_buffers (GskVulkanCommandPool *self,
+                                        gsize                 n_buffers,
+                                        VkCommandBuffer      *buffers,
+                                        gsize                 wait_semaphore_count,
+                                        VkSemaphore          *wait_semaphores,
+                                        gsize                 signal_semaphore_count,
+                                        VkSemaphore          *signal_semaphores,
+                                        VkFence               fence)
 {
   VkPipelineStageFlags *wait_semaphore_flags = NULL;
 
-  GSK_VK_CHECK (vkEndCommandBuffer, command_buffer);
+  for (gsize i = 0; i < n_buffers; i++)
+    GSK_VK_CHECK (vkEndCommandBuffer, buffers[i]);
 
   if (wait_semaphore_count > 0)
     {
@@ -99,13 +118,10 @@ gsk_vulkan_command_pool_submit_buffer (GskVulkanCommandPool *self,
                                   .waitSemaphoreCount = wait_semaphore_count,
                                   .pWaitSemaphores = wait_semaphores,
                                   .pWaitDstStageMask = wait_semaphore_flags,
-                                  .commandBufferCount = 1,
-                                  .pCommandBuffers = (VkCommandBuffer[1]) {
-                                      command_buffer
-                                  },
+                                  .commandBufferCount = n_buffers,
+                                  .pCommandBuffers = buffers,
                                   .signalSemaphoreCount = signal_semaphore_count,
                                   .pSignalSemaphores = signal_semaphores,
                                },
                                fence);
 }
-
@@ -20,6 +20,14 @@ void                    gsk_vulkan_command_pool_submit_buffer           (GskVulk
                                                                          gsize                   signal_semaphores_count,
                                                                          VkSemaphore            *signal_semaphores,
                                                                          VkFence                 fence);
+void                    gsk_vulkan_command_pool_submit_buffers          (GskVulkanCommandPool   *self,
+                                                                         gsize                   n_buffers,
+                                                                         VkCommandBuffer        *buffers,
+                                                                         gsize                   wait_semaphore_count,
+                                                                         VkSemaphore            *wait_semaphores,
+                                                                         gsize                   signal_semaphores_count,
+                                                                         VkSemaphore            *signal_semaphores,
+                                                                         VkFence                 fence);
 
 G_END_DECLS
 
@@ -4,6 +4,7 @@
 #include <pango/pango.h>
 #include "gskvulkanrendererprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskglyphcacheprivate.h"
 
 G_BEGIN_DECLS
 
@@ -16,12 +17,13 @@ GskVulkanGlyphCache  *gsk_vulkan_glyph_cache_new            (GskRenderer
 
 GskVulkanImage *     gsk_vulkan_glyph_cache_get_glyph_image (GskVulkanGlyphCache *cache,
                                                              GskVulkanUploader   *uploader,
-                                                             guint                index);
+                                                             guint                atlas_id);
 
-GskVulkanCachedGlyph *gsk_vulkan_glyph_cache_lookup         (GskVulkanGlyphCache *cache,
+GskCachedGlyph *     gsk_vulkan_glyph_cache_lookup          (GskVulkanGlyphCache *cache,
                                                              gboolean             create,
                                                              PangoFont           *font,
                                                              PangoGlyph           glyph,
+                                                             guint                phase,
                                                              float                scale);
 
 void                  gsk_vulkan_glyph_cache_begin_frame    (GskVulkanGlyphCache *cache);
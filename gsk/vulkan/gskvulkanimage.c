@@ -8,6 +8,9 @@
 
 #include <string.h>
 
+#define STAGING_BUFFER_MIN_SIZE (256 * 1024)
+#define STAGING_DATA_ALIGNMENT 16
+
 struct _GskVulkanUploader
 {
   GdkVulkanContext *vulkan;
@@ -20,6 +23,15 @@ struct _GskVulkanUploader
   GArray *after_buffer_barriers;
   GArray *after_image_barriers;
 
+  /* All staging data of a frame goes into this buffer. When it is too
+   * small, a larger one replaces it and the old one is kept around
+   * until the uploads are done. */
+  GskVulkanBuffer *staging_buffer;
+  gsize staging_buffer_size;
+  gsize staging_buffer_used;
+  /* the part of it that barriers have been added for */
+  gsize staging_buffer_flushed;
+
   GSList *staging_image_free_list;
   GSList *staging_buffer_free_list;
 };
@@ -68,6 +80,8 @@ gsk_vulkan_uploader_free (GskVulkanUploader *self)
 {
   gsk_vulkan_uploader_reset (self);
 
+  g_clear_pointer (&self->staging_buffer, gsk_vulkan_buffer_free);
+
   g_array_unref (self->after_buffer_barriers);
   g_array_unref (self->before_buffer_barriers);
   g_array_unref (self->after_image_barriers);
@@ -139,9 +153,79 @@ gsk_vulkan_uploader_get_copy_buffer (GskVulkanUploader *self)
   return self->copy_buffer;
 }
 
+static void
+gsk_vulkan_uploader_add_staging_barrier (GskVulkanUploader *self)
+{
+  if (self->staging_buffer_used == self->staging_buffer_flushed)
+    return;
+
+  gsk_vulkan_uploader_add_buffer_barrier (self,
+                                          FALSE,
+                                          &(VkBufferMemoryBarrier) {
+                                             .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                                             .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
+                                             .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+                                             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                                             .buffer = gsk_vulkan_buffer_get_buffer (self->staging_buffer),
+                                             .offset = self->staging_buffer_flushed,
+                                             .size = self->staging_buffer_used - self->staging_buffer_flushed,
+                                         });
+
+  self->staging_buffer_flushed = self->staging_buffer_used;
+}
+
+/* Returns the mapped memory for @n_bytes of staging data, to be copied
+ * from @buffer at @offset. Call gsk_vulkan_uploader_end_staging() once
+ * the data is written.
+ */
+static guchar *
+gsk_vulkan_uploader_begin_staging (GskVulkanUploader  *self,
+                                   gsize               n_bytes,
+                                   GskVulkanBuffer   **buffer,
+                                   gsize              *offset)
+{
+  *offset = (self->staging_buffer_used + STAGING_DATA_ALIGNMENT - 1) & ~(STAGING_DATA_ALIGNMENT - 1);
+
+  if (self->staging_buffer == NULL || *offset + n_bytes > self->staging_buffer_size)
+    {
+      gsize size = MAX (STAGING_BUFFER_MIN_SIZE, self->staging_buffer_size * 2);
+
+      while (size < n_bytes)
+        size *= 2;
+
+      if (self->staging_buffer)
+        {
+          gsk_vulkan_uploader_add_staging_barrier (self);
+          self->staging_buffer_free_list = g_slist_prepend (self->staging_buffer_free_list, self->staging_buffer);
+        }
+
+      self->staging_buffer = gsk_vulkan_buffer_new_staging (self->vulkan, size);
+      self->staging_buffer_size = size;
+      self->staging_buffer_flushed = 0;
+      *offset = 0;
+    }
+
+  self->staging_buffer_used = *offset + n_bytes;
+  *buffer = self->staging_buffer;
+
+  return gsk_vulkan_buffer_map (self->staging_buffer) + *offset;
+}
+
+static void
+gsk_vulkan_uploader_end_staging (GskVulkanUploader *self)
+{
+  gsk_vulkan_buffer_unmap (self->staging_buffer);
+}
+
 void
 gsk_vulkan_uploader_upload (GskVulkanUploader *self)
 {
+  VkCommandBuffer command_buffers[2];
+  guint n_command_buffers = 0;
+
+  gsk_vulkan_uploader_add_staging_barrier (self);
+
   if (self->before_buffer_barriers->len > 0 || self->before_image_barriers->len > 0)
     {
       VkCommandBuffer command_buffer;
@@ -154,7 +238,7 @@ gsk_vulkan_uploader_upload (GskVulkanUploader *self)
                             0, NULL,
                             self->before_buffer_barriers->len, (VkBufferMemoryBarrier *) self->before_buffer_barriers->data,
                             self->before_image_barriers->len, (VkImageMemoryBarrier *) self->before_image_barriers->data);
-      gsk_vulkan_command_pool_submit_buffer (self->command_pool, command_buffer, 0, NULL, 0, NULL, VK_NULL_HANDLE);
+      command_buffers[n_command_buffers++] = command_buffer;
       g_array_set_size (self->before_buffer_barriers, 0);
       g_array_set_size (self->before_image_barriers, 0);
     }
@@ -176,9 +260,14 @@ gsk_vulkan_uploader_upload (GskVulkanUploader *self)
 
   if (self->copy_buffer != VK_NULL_HANDLE)
     {
-      gsk_vulkan_command_pool_submit_buffer (self->command_pool, self->copy_buffer, 0, NULL, 0, NULL, VK_NULL_HANDLE);
+      command_buffers[n_command_buffers++] = self->copy_buffer;
       self->copy_buffer = VK_NULL_HANDLE;
     }
+
+  if (n_command_buffers > 0)
+    gsk_vulkan_command_pool_submit_buffers (self->command_pool,
+                                            n_command_buffers, command_buffers,
+                                            0, NULL, 0, NULL, VK_NULL_HANDLE);
 }
 
 void
@@ -192,6 +281,8 @@ gsk_vulkan_uploader_reset (GskVulkanUploader *self)
   self->staging_image_free_list = NULL;
   g_slist_free_full (self->staging_buffer_free_list, (GDestroyNotify) gsk_vulkan_buffer_free);
   self->staging_buffer_free_list = NULL;
+  self->staging_buffer_used = 0;
+  self->staging_buffer_flushed = 0;
 }
 
 static GskVulkanImage *
@@ -239,14 +330,14 @@ gsk_vulkan_image_new (GdkVulkanContext      *context,
                                 &requirements);
 
   self->memory = gsk_vulkan_memory_new (context,
-                                        requirements.memoryTypeBits,
-                                        memory,
-                                        requirements.size);
+                                        GSK_VULKAN_MEMORY_IMAGE,
+                                        &requirements,
+                                        memory);
 
   GSK_VK_CHECK (vkBindImageMemory, gdk_vulkan_context_get_device (context),
                                    self->vk_image,
                                    gsk_vulkan_memory_get_device_memory (self->memory),
-                                   0);
+                                   gsk_vulkan_memory_get_offset (self->memory));
   return self;
 }
 
@@ -325,11 +416,10 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
 {
   GskVulkanImage *self;
   GskVulkanBuffer *staging;
-  gsize buffer_size = width * height * 4;
+  gsize offset;
   guchar *mem;
 
-  staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, buffer_size);
-  mem = gsk_vulkan_buffer_map (staging);
+  mem = gsk_vulkan_uploader_begin_staging (uploader, width * height * 4, &staging, &offset);
 
   if (stride == width * 4)
     {
@@ -343,20 +433,7 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
         }
     }
 
-  gsk_vulkan_buffer_unmap (staging);
-
-  gsk_vulkan_uploader_add_buffer_barrier (uploader,
-                                          FALSE,
-                                          &(VkBufferMemoryBarrier) {
-                                             .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-                                             .srcAccessMask = VK_ACCESS_HOST_WRITE_BIT,
-                                             .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
-                                             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                                             .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                                             .buffer = gsk_vulkan_buffer_get_buffer(staging),
-                                             .offset = 0,
-                                             .size = buffer_size,
-                                         });
+  gsk_vulkan_uploader_end_staging (uploader);
 
   self = gsk_vulkan_image_new (uploader->vulkan,
                                width,
@@ -381,7 +458,7 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
                           1,
                           (VkBufferImageCopy[1]) {
                                {
-                                   .bufferOffset = 0,
+                                   .bufferOffset = offset,
                                    .imageSubresource = {
                                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                                        .mipLevel = 0,
@@ -403,8 +480,6 @@ gsk_vulkan_image_new_from_data_via_staging_buffer (GskVulkanUploader *uploader,
                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                          VK_ACCESS_SHADER_READ_BIT);
 
-  uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
-
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 
   return self;
@@ -688,15 +763,14 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
   guchar *mem;
   guchar *m;
   gsize size;
-  gsize offset;
+  gsize offset, staging_offset;
   VkBufferImageCopy *bufferImageCopy;
 
   size = 0;
   for (int i = 0; i < num_regions; i++)
     size += regions[i].width * regions[i].height * 4;
 
-  staging = gsk_vulkan_buffer_new_staging (uploader->vulkan, size);
-  mem = gsk_vulkan_buffer_map (staging);
+  mem = gsk_vulkan_uploader_begin_staging (uploader, size, &staging, &staging_offset);
 
   bufferImageCopy = alloca (sizeof (VkBufferImageCopy) * num_regions);
   memset (bufferImageCopy, 0, sizeof (VkBufferImageCopy) * num_regions);
@@ -711,11 +785,11 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
         }
       else
         {
-          for (gsize r = 0; r < regions[i].height; i++)
+          for (gsize r = 0; r < regions[i].height; r++)
             memcpy (m + r * regions[i].width * 4, regions[i].data + r * regions[i].stride, regions[i].width * 4);
         }
 
-      bufferImageCopy[i].bufferOffset = offset;
+      bufferImageCopy[i].bufferOffset = staging_offset + offset;
       bufferImageCopy[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
       bufferImageCopy[i].imageSubresource.mipLevel = 0;
       bufferImageCopy[i].imageSubresource.baseArrayLayer = 0;
@@ -730,7 +804,7 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
       offset += regions[i].width * regions[i].height * 4;
     }
 
-  gsk_vulkan_buffer_unmap (staging);
+  gsk_vulkan_uploader_end_staging (uploader);
 
   gsk_vulkan_uploader_add_image_barrier (uploader,
                                          FALSE,
@@ -751,8 +825,6 @@ gsk_vulkan_image_upload_regions (GskVulkanImage    *self,
                                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                          VK_ACCESS_SHADER_READ_BIT);
 
-  uploader->staging_buffer_free_list = g_slist_prepend (uploader->staging_buffer_free_list, staging);
-
   gsk_vulkan_image_ensure_view (self, VK_FORMAT_B8G8R8A8_UNORM);
 }
 
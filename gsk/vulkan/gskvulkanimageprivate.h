@@ -4,6 +4,7 @@
 #include <gdk/gdk.h>
 
 #include "gskvulkancommandpoolprivate.h"
+#include "gskglyphcacheprivate.h"
 
 G_BEGIN_DECLS
 
@@ -31,15 +32,6 @@ GskVulkanImage *        gsk_vulkan_image_new_from_data                  (GskVulk
                                                                          gsize                   height,
                                                                          gsize                   stride);
 
-typedef struct {
-  guchar *data;
-  gsize width;
-  gsize height;
-  gsize stride;
-  gsize x;
-  gsize y;
-} GskImageRegion;
-
 void                    gsk_vulkan_image_upload_regions                 (GskVulkanImage         *image,
                                                                          GskVulkanUploader      *uploader,
                                                                          guint                   num_regions,
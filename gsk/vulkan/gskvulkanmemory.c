@@ -3,52 +3,359 @@
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanmemoryprivate.h"
 
-struct _GskVulkanMemory
-{
-  GdkVulkanContext *vulkan;
+/* Memory is allocated from the device in large blocks, and handed out in
+ * pieces from those. Every pool keeps its own blocks for each memory type,
+ * so that buffers and images never share a block, and short-lived staging
+ * memory does not fragment the blocks of long-lived images.
+ */
+
+#define BLOCK_SIZE (16 * 1024 * 1024)
+
+/* Allocations larger than this get a block of their own */
+#define MAX_SUBALLOCATION_SIZE (BLOCK_SIZE / 2)
 
+/* Vulkan alignments are always powers of two */
+#define ALIGN(x, a) (((x) + (a) - 1) & ~((gsize) (a) - 1))
+
+typedef struct _GskVulkanAllocator GskVulkanAllocator;
+typedef struct _GskVulkanMemoryBlock GskVulkanMemoryBlock;
+
+typedef struct
+{
+  gsize offset;
   gsize size;
+} GskVulkanMemoryRange;
+
+struct _GskVulkanMemoryBlock
+{
+  GskVulkanAllocator *allocator;
+  GskVulkanMemoryPool pool;
+  uint32_t type_index;
 
   VkDeviceMemory vk_memory;
+  gsize size;
+  gsize used;
+
+  /* mapped once for the lifetime of the block, if it is host visible */
+  guchar *map;
+
+  /* sorted by offset, adjacent ranges are merged */
+  GArray *free_ranges;
 };
 
-GskVulkanMemory *
-gsk_vulkan_memory_new (GdkVulkanContext      *context,
-                       uint32_t               allowed_types,
-                       VkMemoryPropertyFlags  flags,
-                       gsize                  size)
+struct _GskVulkanAllocator
 {
+  GdkVulkanContext *vulkan;
+
   VkPhysicalDeviceMemoryProperties properties;
-  GskVulkanMemory *self;
-  uint32_t i;
+  gsize buffer_image_granularity;
 
-  self = g_slice_new0 (GskVulkanMemory);
+  GPtrArray *blocks[GSK_VULKAN_N_MEMORY_POOLS];
 
-  self->vulkan = g_object_ref (context);
-  self->size = size;
+  GskVulkanMemoryStats stats[GSK_VULKAN_N_MEMORY_POOLS];
+
+  /* set once the renderer is done with the context */
+  guint released : 1;
+};
+
+struct _GskVulkanMemory
+{
+  GdkVulkanContext *vulkan;
+
+  GskVulkanMemoryBlock *block;
+  gsize offset;
+  gsize size;
+};
+
+static void
+gsk_vulkan_memory_block_free (GskVulkanMemoryBlock *block)
+{
+  GskVulkanAllocator *allocator = block->allocator;
+
+  g_assert (block->used == 0);
+
+  if (block->map)
+    vkUnmapMemory (gdk_vulkan_context_get_device (allocator->vulkan), block->vk_memory);
+
+  vkFreeMemory (gdk_vulkan_context_get_device (allocator->vulkan),
+                block->vk_memory,
+                NULL);
+
+  allocator->stats[block->pool].n_blocks--;
+  allocator->stats[block->pool].allocated -= block->size;
+
+  g_array_unref (block->free_ranges);
+  g_slice_free (GskVulkanMemoryBlock, block);
+}
+
+static void
+gsk_vulkan_allocator_free (gpointer data)
+{
+  GskVulkanAllocator *allocator = data;
+  guint i;
+
+  /* Allocations keep a reference on the context, so at this point
+   * all blocks must be empty */
+  for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+    g_ptr_array_unref (allocator->blocks[i]);
+
+  g_slice_free (GskVulkanAllocator, allocator);
+}
+
+static GskVulkanAllocator *
+gsk_vulkan_allocator_get (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *allocator;
+  VkPhysicalDeviceProperties device_properties;
+  guint i;
+
+  allocator = g_object_get_data (G_OBJECT (context), "gsk-vulkan-allocator");
+  if (allocator)
+    return allocator;
+
+  allocator = g_slice_new0 (GskVulkanAllocator);
+  allocator->vulkan = context;
 
   vkGetPhysicalDeviceMemoryProperties (gdk_vulkan_context_get_physical_device (context),
-                                       &properties);
+                                       &allocator->properties);
+  vkGetPhysicalDeviceProperties (gdk_vulkan_context_get_physical_device (context),
+                                 &device_properties);
+  allocator->buffer_image_granularity = device_properties.limits.bufferImageGranularity;
 
-  for (i = 0; i < properties.memoryTypeCount; i++)
-    {
-      if (!(allowed_types & (1 << i)))
-        continue;
+  for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+    allocator->blocks[i] = g_ptr_array_new_with_free_func ((GDestroyNotify) gsk_vulkan_memory_block_free);
 
-      if ((properties.memoryTypes[i].propertyFlags & flags) == flags)
-        break;
-  }
+  g_object_set_data_full (G_OBJECT (context), "gsk-vulkan-allocator",
+                          allocator, gsk_vulkan_allocator_free);
+
+  return allocator;
+}
+
+static GskVulkanMemoryBlock *
+gsk_vulkan_memory_block_new (GskVulkanAllocator  *allocator,
+                             GskVulkanMemoryPool  pool,
+                             uint32_t             type_index,
+                             gsize                size)
+{
+  GskVulkanMemoryBlock *block;
+  GskVulkanMemoryRange range;
 
-  g_assert (i < properties.memoryTypeCount);
+  block = g_slice_new0 (GskVulkanMemoryBlock);
+  block->allocator = allocator;
+  block->pool = pool;
+  block->type_index = type_index;
+  block->size = size;
+  block->free_ranges = g_array_new (FALSE, FALSE, sizeof (GskVulkanMemoryRange));
 
-  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
+  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (allocator->vulkan),
                                   &(VkMemoryAllocateInfo) {
                                       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
                                       .allocationSize = size,
-                                      .memoryTypeIndex = i
+                                      .memoryTypeIndex = type_index
                                   },
                                   NULL,
-                                  &self->vk_memory);
+                                  &block->vk_memory);
+
+  if (allocator->properties.memoryTypes[type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+      void *data;
+
+      GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (allocator->vulkan),
+                                 block->vk_memory,
+                                 0,
+                                 VK_WHOLE_SIZE,
+                                 0,
+                                 &data);
+      block->map = data;
+    }
+
+  range.offset = 0;
+  range.size = size;
+  g_array_append_val (block->free_ranges, range);
+
+  allocator->stats[pool].n_blocks++;
+  allocator->stats[pool].allocated += size;
+
+  GSK_NOTE (VULKAN, g_message ("Allocated %" G_GSIZE_FORMAT " bytes of memory type %u for pool %u",
+                               size, type_index, pool));
+
+  return block;
+}
+
+/* First fit. Returns FALSE if the block has no room */
+static gboolean
+gsk_vulkan_memory_block_alloc (GskVulkanMemoryBlock *block,
+                               gsize                 size,
+                               gsize                 alignment,
+                               gsize                *offset)
+{
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      GskVulkanMemoryRange *range = &g_array_index (block->free_ranges, GskVulkanMemoryRange, i);
+      gsize start = ALIGN (range->offset, alignment);
+      gsize end = range->offset + range->size;
+
+      if (start + size > end)
+        continue;
+
+      *offset = start;
+
+      if (start + size < end)
+        {
+          GskVulkanMemoryRange tail = { start + size, end - (start + size) };
+
+          if (start > range->offset)
+            {
+              range->size = start - range->offset;
+              g_array_insert_val (block->free_ranges, i + 1, tail);
+            }
+          else
+            *range = tail;
+        }
+      else if (start > range->offset)
+        range->size = start - range->offset;
+      else
+        g_array_remove_index (block->free_ranges, i);
+
+      block->used += size;
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gsk_vulkan_memory_block_release (GskVulkanMemoryBlock *block,
+                                 gsize                 offset,
+                                 gsize                 size)
+{
+  GskVulkanMemoryRange *prev, *next;
+  GskVulkanMemoryRange range = { offset, size };
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      if (g_array_index (block->free_ranges, GskVulkanMemoryRange, i).offset > offset)
+        break;
+    }
+
+  g_array_insert_val (block->free_ranges, i, range);
+
+  /* merge with the neighbours */
+  if (i + 1 < block->free_ranges->len)
+    {
+      prev = &g_array_index (block->free_ranges, GskVulkanMemoryRange, i);
+      next = &g_array_index (block->free_ranges, GskVulkanMemoryRange, i + 1);
+      if (prev->offset + prev->size == next->offset)
+        {
+          prev->size += next->size;
+          g_array_remove_index (block->free_ranges, i + 1);
+        }
+    }
+  if (i > 0)
+    {
+      prev = &g_array_index (block->free_ranges, GskVulkanMemoryRange, i - 1);
+      next = &g_array_index (block->free_ranges, GskVulkanMemoryRange, i);
+      if (prev->offset + prev->size == next->offset)
+        {
+          prev->size += next->size;
+          g_array_remove_index (block->free_ranges, i);
+        }
+    }
+
+  block->used -= size;
+}
+
+static uint32_t
+find_memory_type (GskVulkanAllocator    *allocator,
+                  uint32_t               allowed_types,
+                  VkMemoryPropertyFlags  flags)
+{
+  uint32_t i;
+
+  for (i = 0; i < allocator->properties.memoryTypeCount; i++)
+    {
+      if (!(allowed_types & (1 << i)))
+        continue;
+
+      if ((allocator->properties.memoryTypes[i].propertyFlags & flags) == flags)
+        break;
+  }
+
+  g_assert (i < allocator->properties.memoryTypeCount);
+
+  return i;
+}
+
+GskVulkanMemory *
+gsk_vulkan_memory_new (GdkVulkanContext           *context,
+                       GskVulkanMemoryPool         pool,
+                       const VkMemoryRequirements *requirements,
+                       VkMemoryPropertyFlags       flags)
+{
+  GskVulkanAllocator *allocator;
+  GskVulkanMemoryBlock *block;
+  GskVulkanMemory *self;
+  GPtrArray *blocks;
+  uint32_t type_index;
+  gsize size, alignment;
+  guint i;
+
+  g_return_val_if_fail (pool < GSK_VULKAN_N_MEMORY_POOLS, NULL);
+
+  allocator = gsk_vulkan_allocator_get (context);
+  blocks = allocator->blocks[pool];
+  type_index = find_memory_type (allocator, requirements->memoryTypeBits, flags);
+
+  /* Linear and optimal images may share an image block, keep them far enough apart */
+  alignment = requirements->alignment;
+  size = requirements->size;
+  if (pool == GSK_VULKAN_MEMORY_IMAGE)
+    {
+      alignment = MAX (alignment, allocator->buffer_image_granularity);
+      size = ALIGN (size, allocator->buffer_image_granularity);
+    }
+
+  self = g_slice_new0 (GskVulkanMemory);
+  self->vulkan = g_object_ref (context);
+  self->size = size;
+
+  if (size > MAX_SUBALLOCATION_SIZE)
+    {
+      block = gsk_vulkan_memory_block_new (allocator, pool, type_index, size);
+      gsk_vulkan_memory_block_alloc (block, size, alignment, &self->offset);
+      g_ptr_array_add (blocks, block);
+    }
+  else
+    {
+      block = NULL;
+      for (i = 0; i < blocks->len; i++)
+        {
+          GskVulkanMemoryBlock *b = g_ptr_array_index (blocks, i);
+
+          if (b->type_index == type_index &&
+              gsk_vulkan_memory_block_alloc (b, size, alignment, &self->offset))
+            {
+              block = b;
+              break;
+            }
+        }
+
+      if (block == NULL)
+        {
+          block = gsk_vulkan_memory_block_new (allocator, pool, type_index, BLOCK_SIZE);
+          gsk_vulkan_memory_block_alloc (block, size, alignment, &self->offset);
+          g_ptr_array_add (blocks, block);
+        }
+    }
+
+  self->block = block;
+
+  allocator->stats[pool].n_allocations++;
+  allocator->stats[pool].used += size;
 
   return self;
 }
@@ -56,40 +363,122 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 void
 gsk_vulkan_memory_free (GskVulkanMemory *self)
 {
-  vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
-                self->vk_memory,
-                NULL);
+  GskVulkanMemoryBlock *block = self->block;
+  GskVulkanAllocator *allocator = block->allocator;
+  GPtrArray *blocks = allocator->blocks[block->pool];
+  guint i;
+
+  gsk_vulkan_memory_block_release (block, self->offset, self->size);
+
+  allocator->stats[block->pool].n_allocations--;
+  allocator->stats[block->pool].used -= self->size;
+
+  /* Keep one empty block of each pool around, so that memory that is
+   * allocated and freed every frame does not go back to the device */
+  if (block->used == 0)
+    {
+      gboolean keep = block->size == BLOCK_SIZE && !allocator->released;
+
+      for (i = 0; keep && i < blocks->len; i++)
+        {
+          GskVulkanMemoryBlock *b = g_ptr_array_index (blocks, i);
+
+          if (b != block && b->used == 0 && b->type_index == block->type_index)
+            keep = FALSE;
+        }
+
+      if (!keep)
+        g_ptr_array_remove_fast (blocks, block);
+    }
 
   g_object_unref (self->vulkan);
 
   g_slice_free (GskVulkanMemory, self);
 }
 
+/* Gives all unused blocks back to the device. This must be called while
+ * the device is still alive, the allocator itself only goes away when the
+ * context is finalized, and the device is gone by then.
+ */
+void
+gsk_vulkan_memory_release_cached (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *allocator;
+  gboolean empty = TRUE;
+  guint i, j;
+
+  allocator = g_object_get_data (G_OBJECT (context), "gsk-vulkan-allocator");
+  if (allocator == NULL)
+    return;
+
+  for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+    {
+      GPtrArray *blocks = allocator->blocks[i];
+
+      for (j = blocks->len; j > 0; j--)
+        {
+          GskVulkanMemoryBlock *block = g_ptr_array_index (blocks, j - 1);
+
+          if (block->used == 0)
+            g_ptr_array_remove_index_fast (blocks, j - 1);
+          else
+            empty = FALSE;
+        }
+    }
+
+  if (empty)
+    g_object_set_data (G_OBJECT (context), "gsk-vulkan-allocator", NULL);
+  else
+    allocator->released = TRUE;
+}
+
 VkDeviceMemory
 gsk_vulkan_memory_get_device_memory (GskVulkanMemory *self)
 {
-  return self->vk_memory;
+  return self->block->vk_memory;
+}
+
+gsize
+gsk_vulkan_memory_get_offset (GskVulkanMemory *self)
+{
+  return self->offset;
 }
 
 guchar *
 gsk_vulkan_memory_map (GskVulkanMemory *self)
 {
-  void *data;
-
-  GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
-                             self->vk_memory,
-                             0,
-                             self->size,
-                             0,
-                             &data);
+  g_return_val_if_fail (self->block->map != NULL, NULL);
 
-  return data;
+  return self->block->map + self->offset;
 }
 
 void
 gsk_vulkan_memory_unmap (GskVulkanMemory *self)
 {
-  vkUnmapMemory (gdk_vulkan_context_get_device (self->vulkan),
-                 self->vk_memory);
+  GskVulkanMemoryBlock *block = self->block;
+  GskVulkanAllocator *allocator = block->allocator;
+
+  /* The block stays mapped, but writes to non-coherent memory need to be
+   * made visible to the device */
+  if (allocator->properties.memoryTypes[block->type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+    return;
+
+  GSK_VK_CHECK (vkFlushMappedMemoryRanges, gdk_vulkan_context_get_device (self->vulkan),
+                                           1,
+                                           &(VkMappedMemoryRange) {
+                                               .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                                               .memory = block->vk_memory,
+                                               .offset = 0,
+                                               .size = VK_WHOLE_SIZE
+                                           });
 }
 
+void
+gsk_vulkan_memory_get_stats (GdkVulkanContext     *context,
+                             GskVulkanMemoryPool   pool,
+                             GskVulkanMemoryStats *stats)
+{
+  g_return_if_fail (pool < GSK_VULKAN_N_MEMORY_POOLS);
+
+  *stats = gsk_vulkan_allocator_get (context)->stats[pool];
+}
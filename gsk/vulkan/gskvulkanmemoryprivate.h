@@ -7,17 +7,37 @@ G_BEGIN_DECLS
 
 typedef struct _GskVulkanMemory GskVulkanMemory;
 
+typedef enum {
+  GSK_VULKAN_MEMORY_STAGING,
+  GSK_VULKAN_MEMORY_VERTEX,
+  GSK_VULKAN_MEMORY_IMAGE,
+  GSK_VULKAN_N_MEMORY_POOLS
+} GskVulkanMemoryPool;
+
+typedef struct {
+  guint n_blocks;
+  guint n_allocations;
+  gsize allocated; /* from the device */
+  gsize used;      /* by allocations */
+} GskVulkanMemoryStats;
+
 GskVulkanMemory *       gsk_vulkan_memory_new                           (GdkVulkanContext       *context,
-                                                                         uint32_t                allowed_types,
-                                                                         VkMemoryPropertyFlags   properties,
-                                                                         gsize                   size);
+                                                                         GskVulkanMemoryPool     pool,
+                                                                         const VkMemoryRequirements *requirements,
+                                                                         VkMemoryPropertyFlags   properties);
 void                    gsk_vulkan_memory_free                          (GskVulkanMemory        *memory);
+void                    gsk_vulkan_memory_release_cached                (GdkVulkanContext       *context);
 
 VkDeviceMemory          gsk_vulkan_memory_get_device_memory             (GskVulkanMemory        *self);
+gsize                   gsk_vulkan_memory_get_offset                    (GskVulkanMemory        *self);
 
 guchar *                gsk_vulkan_memory_map                           (GskVulkanMemory        *self);
 void                    gsk_vulkan_memory_unmap                         (GskVulkanMemory        *self);
 
+void                    gsk_vulkan_memory_get_stats                     (GdkVulkanContext       *context,
+                                                                         GskVulkanMemoryPool     pool,
+                                                                         GskVulkanMemoryStats   *stats);
+
 G_END_DECLS
 
 #endif /* __GSK_VULKAN_MEMORY_PRIVATE_H__ */
@@ -5,6 +5,9 @@
 #include "gskvulkanpushconstantsprivate.h"
 #include "gskvulkanshaderprivate.h"
 
+#include "gskdebugprivate.h"
+#include "gskdiskcacheprivate.h"
+
 #include <graphene.h>
 
 typedef struct _GskVulkanPipelinePrivate GskVulkanPipelinePrivate;
@@ -53,6 +56,112 @@ gsk_vulkan_pipeline_init (GskVulkanPipeline *self)
 {
 }
 
+/* Compiled pipelines are kept in a VkPipelineCache that is attached to
+ * the context and written to disk when the renderer goes away. Like the
+ * GL program cache, the disk is not used with GSK_DEBUG=shaders.
+ */
+#define PIPELINE_CACHE_KEY "gsk-vulkan-pipeline-cache"
+
+static char *
+get_pipeline_cache_key (GdkVulkanContext *context)
+{
+  VkPhysicalDeviceProperties props;
+  char *ids, *uuid;
+  char *key;
+
+  vkGetPhysicalDeviceProperties (gdk_vulkan_context_get_physical_device (context), &props);
+
+  ids = g_strdup_printf ("%u:%u:%u", props.vendorID, props.deviceID, props.driverVersion);
+  uuid = g_base64_encode (props.pipelineCacheUUID, VK_UUID_SIZE);
+  key = gsk_disk_cache_compute_key (ids, uuid, NULL);
+
+  g_free (uuid);
+  g_free (ids);
+
+  return key;
+}
+
+static VkPipelineCache
+get_pipeline_cache (GdkVulkanContext *context)
+{
+  VkPipelineCache *cache = g_object_get_data (G_OBJECT (context), PIPELINE_CACHE_KEY);
+
+  return cache ? *cache : VK_NULL_HANDLE;
+}
+
+void
+gsk_vulkan_pipeline_cache_load (GdkVulkanContext *context)
+{
+  VkPipelineCache *cache;
+  GBytes *bytes = NULL;
+  char *key;
+  gsize size = 0;
+  gconstpointer data = NULL;
+
+  g_return_if_fail (GDK_IS_VULKAN_CONTEXT (context));
+
+  if (get_pipeline_cache (context) != VK_NULL_HANDLE)
+    return;
+
+  key = get_pipeline_cache_key (context);
+  if (!GSK_DEBUG_CHECK (SHADERS))
+    bytes = gsk_disk_cache_load ("vulkan-pipelines", key);
+  if (bytes)
+    data = g_bytes_get_data (bytes, &size);
+
+  cache = g_new (VkPipelineCache, 1);
+
+  /* The driver checks the header itself and ignores data it does not like */
+  if (GSK_VK_CHECK (vkCreatePipelineCache, gdk_vulkan_context_get_device (context),
+                                           &(VkPipelineCacheCreateInfo) {
+                                               .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+                                               .initialDataSize = size,
+                                               .pInitialData = data
+                                           },
+                                           NULL,
+                                           cache) == VK_SUCCESS)
+    g_object_set_data_full (G_OBJECT (context), PIPELINE_CACHE_KEY, cache, g_free);
+  else
+    g_free (cache);
+
+  g_clear_pointer (&bytes, g_bytes_unref);
+  g_free (key);
+}
+
+void
+gsk_vulkan_pipeline_cache_save (GdkVulkanContext *context)
+{
+  VkPipelineCache cache;
+  VkDevice device;
+  size_t size = 0;
+  gpointer data;
+  char *key;
+
+  g_return_if_fail (GDK_IS_VULKAN_CONTEXT (context));
+
+  cache = get_pipeline_cache (context);
+  if (cache == VK_NULL_HANDLE)
+    return;
+
+  device = gdk_vulkan_context_get_device (context);
+
+  if (!GSK_DEBUG_CHECK (SHADERS) &&
+      GSK_VK_CHECK (vkGetPipelineCacheData, device, cache, &size, NULL) == VK_SUCCESS && size > 0)
+    {
+      data = g_malloc (size);
+      if (GSK_VK_CHECK (vkGetPipelineCacheData, device, cache, &size, data) == VK_SUCCESS)
+        {
+          key = get_pipeline_cache_key (context);
+          gsk_disk_cache_save ("vulkan-pipelines", key, data, size);
+          g_free (key);
+        }
+      g_free (data);
+    }
+
+  vkDestroyPipelineCache (device, cache, NULL);
+  g_object_set_data (G_OBJECT (context), PIPELINE_CACHE_KEY, NULL);
+}
+
 GskVulkanPipeline *
 gsk_vulkan_pipeline_new (GType                    pipeline_type,
                          GdkVulkanContext        *context,
@@ -96,7 +205,7 @@ gsk_vulkan_pipeline_new_full (GType                    pipeline_type,
   priv->fragment_shader = gsk_vulkan_shader_new_from_resource (context, GSK_VULKAN_SHADER_FRAGMENT, shader_name, NULL);
 
   GSK_VK_CHECK (vkCreateGraphicsPipelines, device,
-                                           VK_NULL_HANDLE,
+                                           get_pipeline_cache (context),
                                            1,
                                            &(VkGraphicsPipelineCreateInfo) {
                                                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -24,7 +24,13 @@
 #include "gskvulkanpushconstantsprivate.h"
 
 #define DESCRIPTOR_POOL_MAXSETS 128
-#define DESCRIPTOR_POOL_MAXSETS_INCREASE 128
+/* descriptor sets that were not used for this many frames get freed */
+#define DESCRIPTOR_SET_MAX_AGE 60
+
+#define VERTEX_BUFFER_MIN_SIZE (64 * 1024)
+#define VERTEX_DATA_ALIGNMENT 16
+
+#define MAX_RECORD_THREADS 4
 
 struct _GskVulkanRender
 {
@@ -43,11 +49,16 @@ struct _GskVulkanRender
   VkPipelineLayout pipeline_layout[3]; /* indexed by number of textures */
   GskVulkanUploader *uploader;
 
-  GHashTable *descriptor_set_indexes;
-  VkDescriptorPool descriptor_pool;
-  uint32_t descriptor_pool_maxsets;
-  VkDescriptorSet *descriptor_sets;
-  gsize n_descriptor_sets;
+  /* Descriptor sets are kept around for as long as their image lives
+   * and keeps being used, so images drawn every frame don't need new
+   * descriptor writes. They can be reused as-is, as this render is only
+   * ever reset once the GPU is done with it. */
+  GHashTable *cached_descriptor_sets;
+  GPtrArray *descriptor_pools;
+  GArray *dead_descriptor_sets;
+  /* the sets used for this frame, indexed by descriptor set index */
+  GArray *descriptor_sets;
+  guint64 frame;
   GskVulkanPipeline *pipelines[GSK_VULKAN_N_PIPELINES];
 
   GskVulkanImage *target;
@@ -58,6 +69,28 @@ struct _GskVulkanRender
   GList *render_passes;
   GSList *cleanup_images;
 
+  /* The vertex data of all passes, written directly into mapped memory.
+   * The buffer is reused once the fence says the frame is done, older
+   * buffers that turned out too small are freed at that point. */
+  GskVulkanBuffer *vertex_buffer;
+  guchar *vertex_buffer_data;
+  gsize vertex_buffer_size;
+  gsize vertex_buffer_used;
+  GSList *cleanup_buffers;
+
+  /* Render passes are recorded into their command buffers by a few
+   * threads, each with its own command pool. Submitting them still
+   * happens in order from the main thread. */
+  GThreadPool *record_threads;
+  guint n_record_threads;
+  GskVulkanCommandPool *record_command_pools[MAX_RECORD_THREADS];
+  GskVulkanRenderPass **record_passes;
+  VkCommandBuffer *record_buffers;
+  guint n_record_passes;
+  guint n_record_jobs;
+  GMutex record_lock;
+  GCond record_cond;
+
   GQuark render_pass_counter;
   GQuark gpu_time_timer;
 };
@@ -65,7 +98,8 @@ struct _GskVulkanRender
 static void
 gsk_vulkan_render_setup (GskVulkanRender       *self,
                          GskVulkanImage        *target,
-                         const graphene_rect_t *rect)
+                         const graphene_rect_t *rect,
+                         const cairo_region_t  *clip)
 {
   GdkWindow *window = gsk_renderer_get_window (self->renderer);
 
@@ -87,12 +121,32 @@ gsk_vulkan_render_setup (GskVulkanRender       *self,
       self->viewport = GRAPHENE_RECT_INIT (0, 0,
                                            gdk_window_get_width (window) * self->scale_factor,
                                            gdk_window_get_height (window) * self->scale_factor);
-      self->clip = gdk_drawing_context_get_clip (gsk_renderer_get_drawing_context (self->renderer));
+      if (clip)
+        self->clip = cairo_region_copy (clip);
+      else
+        self->clip = gdk_drawing_context_get_clip (gsk_renderer_get_drawing_context (self->renderer));
     }
 }
 
+typedef struct {
+  VkDescriptorPool pool;
+  guint n_used;
+} DescriptorPool;
+
+typedef struct {
+  GskVulkanImage *image;
+  gboolean repeat;
+  GskVulkanRender *render;
+  DescriptorPool *pool;
+  VkDescriptorSet set;
+  /* the frame this was last used in, and at which index */
+  guint64 frame;
+  gsize index;
+} CachedDescriptorSet;
+
 static guint desc_set_index_hash (gconstpointer v);
 static gboolean desc_set_index_equal (gconstpointer v1, gconstpointer v2);
+static void gsk_vulkan_render_record_passes (gpointer data, gpointer user_data);
 
 GskVulkanRender *
 gsk_vulkan_render_new (GskRenderer      *renderer,
@@ -106,11 +160,31 @@ gsk_vulkan_render_new (GskRenderer      *renderer,
   self->vulkan = context;
   self->renderer = renderer;
   self->framebuffers = g_hash_table_new (g_direct_hash, g_direct_equal);
-  self->descriptor_set_indexes = g_hash_table_new_full (desc_set_index_hash, desc_set_index_equal, NULL, g_free);
+  self->cached_descriptor_sets = g_hash_table_new (desc_set_index_hash, desc_set_index_equal);
+  self->descriptor_pools = g_ptr_array_new_with_free_func (g_free);
+  self->dead_descriptor_sets = g_array_new (FALSE, FALSE, sizeof (CachedDescriptorSet));
+  self->descriptor_sets = g_array_new (FALSE, FALSE, sizeof (VkDescriptorSet));
 
   device = gdk_vulkan_context_get_device (self->vulkan);
 
   self->command_pool = gsk_vulkan_command_pool_new (self->vulkan);
+
+  self->n_record_threads = MIN (g_get_num_processors (), MAX_RECORD_THREADS);
+  if (self->n_record_threads > 1)
+    {
+      guint i;
+
+      g_mutex_init (&self->record_lock);
+      g_cond_init (&self->record_cond);
+      for (i = 0; i < self->n_record_threads; i++)
+        self->record_command_pools[i] = gsk_vulkan_command_pool_new (self->vulkan);
+      self->record_threads = g_thread_pool_new (gsk_vulkan_render_record_passes,
+                                                self,
+                                                self->n_record_threads,
+                                                FALSE,
+                                                NULL);
+    }
+
   GSK_VK_CHECK (vkCreateFence, device,
                                &(VkFenceCreateInfo) {
                                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
@@ -119,22 +193,6 @@ gsk_vulkan_render_new (GskRenderer      *renderer,
                                NULL,
                                &self->fence);
 
-  self->descriptor_pool_maxsets = DESCRIPTOR_POOL_MAXSETS;
-  GSK_VK_CHECK (vkCreateDescriptorPool, device,
-                                        &(VkDescriptorPoolCreateInfo) {
-                                            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                                            .maxSets = self->descriptor_pool_maxsets,
-                                            .poolSizeCount = 1,
-                                            .pPoolSizes = (VkDescriptorPoolSize[1]) {
-                                                {
-                                                    .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                                    .descriptorCount = self->descriptor_pool_maxsets
-                                                }
-                                            }
-                                        },
-                                        NULL,
-                                        &self->descriptor_pool);
-
   GSK_VK_CHECK (vkCreateRenderPass, gdk_vulkan_context_get_device (self->vulkan),
                                     &(VkRenderPassCreateInfo) {
                                         .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
@@ -310,6 +368,46 @@ gsk_vulkan_render_add_cleanup_image (GskVulkanRender *self,
   self->cleanup_images = g_slist_prepend (self->cleanup_images, image);
 }
 
+/* Returns the start of the mapped buffer, the reserved range is
+ * @n_bytes long and begins at @offset.
+ */
+guchar *
+gsk_vulkan_render_reserve_vertex_data (GskVulkanRender  *self,
+                                       gsize             n_bytes,
+                                       GskVulkanBuffer **buffer,
+                                       gsize            *offset)
+{
+  gsize start;
+
+  start = (self->vertex_buffer_used + VERTEX_DATA_ALIGNMENT - 1) & ~(VERTEX_DATA_ALIGNMENT - 1);
+
+  if (self->vertex_buffer == NULL || start + n_bytes > self->vertex_buffer_size)
+    {
+      gsize size = MAX (self->vertex_buffer_size, VERTEX_BUFFER_MIN_SIZE);
+
+      while (size < n_bytes)
+        size *= 2;
+      if (self->vertex_buffer)
+        size *= 2;
+
+      /* passes that were already collected may still use the old one */
+      if (self->vertex_buffer)
+        self->cleanup_buffers = g_slist_prepend (self->cleanup_buffers, self->vertex_buffer);
+
+      self->vertex_buffer = gsk_vulkan_buffer_new (self->vulkan, size);
+      self->vertex_buffer_data = gsk_vulkan_buffer_map (self->vertex_buffer);
+      self->vertex_buffer_size = size;
+      start = 0;
+    }
+
+  self->vertex_buffer_used = start + n_bytes;
+
+  *buffer = self->vertex_buffer;
+  *offset = start;
+
+  return self->vertex_buffer_data;
+}
+
 void
 gsk_vulkan_render_add_render_pass (GskVulkanRender     *self,
                                    GskVulkanRenderPass *pass)
@@ -423,21 +521,15 @@ VkDescriptorSet
 gsk_vulkan_render_get_descriptor_set (GskVulkanRender *self,
                                       gsize            id)
 {
-  g_assert (id < self->n_descriptor_sets);
+  g_assert (id < self->descriptor_sets->len);
 
-  return self->descriptor_sets[id];
+  return g_array_index (self->descriptor_sets, VkDescriptorSet, id);
 }
 
-typedef struct {
-  gsize index;
-  GskVulkanImage *image;
-  gboolean repeat;
-} HashDescriptorSetIndexEntry;
-
 static guint
 desc_set_index_hash (gconstpointer v)
 {
-  const HashDescriptorSetIndexEntry *e = v;
+  const CachedDescriptorSet *e = v;
 
   return GPOINTER_TO_UINT (e->image) + e->repeat;
 }
@@ -445,34 +537,143 @@ desc_set_index_hash (gconstpointer v)
 static gboolean
 desc_set_index_equal (gconstpointer v1, gconstpointer v2)
 {
-  const HashDescriptorSetIndexEntry *e1 = v1;
-  const HashDescriptorSetIndexEntry *e2 = v2;
+  const CachedDescriptorSet *e1 = v1;
+  const CachedDescriptorSet *e2 = v2;
 
   return e1->image == e2->image && e1->repeat == e2->repeat;
 }
 
+static void
+gsk_vulkan_render_free_descriptor_set (GskVulkanRender     *self,
+                                       CachedDescriptorSet *entry)
+{
+  GSK_VK_CHECK (vkFreeDescriptorSets, gdk_vulkan_context_get_device (self->vulkan),
+                                      entry->pool->pool,
+                                      1,
+                                      &entry->set);
+  entry->pool->n_used--;
+}
+
+static void
+gsk_vulkan_render_remove_descriptor_set_from_image (gpointer  data,
+                                                    GObject  *image)
+{
+  CachedDescriptorSet *entry = data;
+  GskVulkanRender *self = entry->render;
+
+  /* The set may still be used by a frame in flight, so only free it in
+   * gsk_vulkan_render_cleanup(), but make sure that a new image with the
+   * same address doesn't find it. */
+  g_hash_table_remove (self->cached_descriptor_sets, entry);
+  g_array_append_vals (self->dead_descriptor_sets, entry, 1);
+  g_free (entry);
+}
+
+static DescriptorPool *
+gsk_vulkan_render_get_descriptor_pool (GskVulkanRender *self)
+{
+  DescriptorPool *pool;
+  guint i;
+
+  for (i = 0; i < self->descriptor_pools->len; i++)
+    {
+      pool = g_ptr_array_index (self->descriptor_pools, i);
+      if (pool->n_used < DESCRIPTOR_POOL_MAXSETS)
+        return pool;
+    }
+
+  pool = g_new0 (DescriptorPool, 1);
+  GSK_VK_CHECK (vkCreateDescriptorPool, gdk_vulkan_context_get_device (self->vulkan),
+                                        &(VkDescriptorPoolCreateInfo) {
+                                            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                                            .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+                                            .maxSets = DESCRIPTOR_POOL_MAXSETS,
+                                            .poolSizeCount = 1,
+                                            .pPoolSizes = (VkDescriptorPoolSize[1]) {
+                                                {
+                                                    .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                    .descriptorCount = DESCRIPTOR_POOL_MAXSETS
+                                                }
+                                            }
+                                        },
+                                        NULL,
+                                        &pool->pool);
+  g_ptr_array_add (self->descriptor_pools, pool);
+
+  return pool;
+}
+
+static CachedDescriptorSet *
+gsk_vulkan_render_create_descriptor_set (GskVulkanRender *self,
+                                         GskVulkanImage  *image,
+                                         gboolean         repeat)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  CachedDescriptorSet *entry;
+
+  entry = g_new0 (CachedDescriptorSet, 1);
+  entry->image = image;
+  entry->repeat = repeat;
+  entry->render = self;
+  entry->pool = gsk_vulkan_render_get_descriptor_pool (self);
+
+  GSK_VK_CHECK (vkAllocateDescriptorSets, device,
+                                          &(VkDescriptorSetAllocateInfo) {
+                                              .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                                              .descriptorPool = entry->pool->pool,
+                                              .descriptorSetCount = 1,
+                                              .pSetLayouts = &self->descriptor_set_layout
+                                          },
+                                          &entry->set);
+  entry->pool->n_used++;
+
+  vkUpdateDescriptorSets (device,
+                          1,
+                          (VkWriteDescriptorSet[1]) {
+                              {
+                                  .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                  .dstSet = entry->set,
+                                  .dstBinding = 0,
+                                  .dstArrayElement = 0,
+                                  .descriptorCount = 1,
+                                  .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                  .pImageInfo = &(VkDescriptorImageInfo) {
+                                      .sampler = repeat ? self->repeating_sampler : self->sampler,
+                                      .imageView = gsk_vulkan_image_get_image_view (image),
+                                      .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                                  }
+                              }
+                          },
+                          0, NULL);
+
+  g_hash_table_add (self->cached_descriptor_sets, entry);
+  g_object_weak_ref (G_OBJECT (image), gsk_vulkan_render_remove_descriptor_set_from_image, entry);
+
+  return entry;
+}
+
 gsize
 gsk_vulkan_render_reserve_descriptor_set (GskVulkanRender *self,
                                           GskVulkanImage  *source,
                                           gboolean         repeat)
 {
-  HashDescriptorSetIndexEntry lookup;
-  HashDescriptorSetIndexEntry *entry;
+  CachedDescriptorSet lookup;
+  CachedDescriptorSet *entry;
 
   g_assert (source != NULL);
 
   lookup.image = source;
   lookup.repeat = repeat;
 
-  entry = g_hash_table_lookup (self->descriptor_set_indexes, &lookup);
-  if (entry)
+  entry = g_hash_table_lookup (self->cached_descriptor_sets, &lookup);
+  if (entry == NULL)
+    entry = gsk_vulkan_render_create_descriptor_set (self, source, repeat);
+  else if (entry->frame == self->frame)
     return entry->index;
 
-  entry = g_new (HashDescriptorSetIndexEntry, 1);
-  entry->image = source;
-  entry->repeat = repeat;
-  entry->index = g_hash_table_size (self->descriptor_set_indexes);
-  g_hash_table_add (self->descriptor_set_indexes, entry);
+  entry->frame = self->frame;
+  entry->index = self->descriptor_sets->len;
+  g_array_append_val (self->descriptor_sets, entry->set);
 
   return entry->index;
 }
@@ -480,104 +681,45 @@ gsk_vulkan_render_reserve_descriptor_set (GskVulkanRender *self,
 static void
 gsk_vulkan_render_prepare_descriptor_sets (GskVulkanRender *self)
 {
-  GHashTableIter iter;
-  gpointer key;
-  VkDevice device;
   GList *l;
-  guint i, needed_sets;
-
-  device = gdk_vulkan_context_get_device (self->vulkan);
 
   for (l = self->render_passes; l; l = l->next)
     {
       GskVulkanRenderPass *pass = l->data;
       gsk_vulkan_render_pass_reserve_descriptor_sets (pass, self);
     }
-  
-  needed_sets = g_hash_table_size (self->descriptor_set_indexes);
-  if (needed_sets > self->n_descriptor_sets)
-    {
-      if (needed_sets > self->descriptor_pool_maxsets)
-        {
-          guint added_sets = needed_sets - self->descriptor_pool_maxsets;
-          added_sets = added_sets + DESCRIPTOR_POOL_MAXSETS_INCREASE - 1;
-          added_sets -= added_sets % DESCRIPTOR_POOL_MAXSETS_INCREASE;
-
-          vkDestroyDescriptorPool (device,
-                                   self->descriptor_pool,
-                                   NULL);
-          self->descriptor_pool_maxsets += added_sets;
-          GSK_VK_CHECK (vkCreateDescriptorPool, device,
-                                                &(VkDescriptorPoolCreateInfo) {
-                                                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-                                                    .maxSets = self->descriptor_pool_maxsets,
-                                                    .poolSizeCount = 1,
-                                                    .pPoolSizes = (VkDescriptorPoolSize[1]) {
-                                                        {
-                                                            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                                            .descriptorCount = self->descriptor_pool_maxsets
-                                                        }
-                                                    }
-                                                },
-                                                NULL,
-                                                &self->descriptor_pool);
-        }
-      else
-        {
-          GSK_VK_CHECK (vkResetDescriptorPool, device,
-                                               self->descriptor_pool,
-                                               0);
-        }
-
-      self->n_descriptor_sets = needed_sets;
-      self->descriptor_sets = g_renew (VkDescriptorSet, self->descriptor_sets, needed_sets);
-    }
-
-  VkDescriptorSetLayout *layouts = g_newa (VkDescriptorSetLayout, needed_sets);
-  for (i = 0; i < needed_sets; i++)
-    layouts[i] = self->descriptor_set_layout;
+}
 
-  GSK_VK_CHECK (vkAllocateDescriptorSets, device,
-                                          &(VkDescriptorSetAllocateInfo) {
-                                              .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-                                              .descriptorPool = self->descriptor_pool,
-                                              .descriptorSetCount = needed_sets,
-                                              .pSetLayouts = layouts
-                                          },
-                                          self->descriptor_sets);
+/* Runs in one of the record threads; job n records every n-th pass
+ * using its own command pool, as command pools must not be used from
+ * several threads at once. */
+static void
+gsk_vulkan_render_record_passes (gpointer data,
+                                 gpointer user_data)
+{
+  GskVulkanRender *self = user_data;
+  guint job = GPOINTER_TO_UINT (data) - 1;
+  guint i;
 
-  g_hash_table_iter_init (&iter, self->descriptor_set_indexes);
-  while (g_hash_table_iter_next (&iter, &key, NULL))
+  for (i = job; i < self->n_record_passes; i += self->n_record_threads)
     {
-      HashDescriptorSetIndexEntry *entry = key;
-      GskVulkanImage *image = entry->image;
-      gsize id = entry->index;
-      gboolean repeat = entry->repeat;
-
-      vkUpdateDescriptorSets (device,
-                              1,
-                              (VkWriteDescriptorSet[1]) {
-                                  {
-                                      .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                                      .dstSet = self->descriptor_sets[id],
-                                      .dstBinding = 0,
-                                      .dstArrayElement = 0,
-                                      .descriptorCount = 1,
-                                      .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                      .pImageInfo = &(VkDescriptorImageInfo) {
-                                          .sampler = repeat ? self->repeating_sampler : self->sampler,
-                                          .imageView = gsk_vulkan_image_get_image_view (image),
-                                          .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-                                      }
-                                  }
-                              },
-                              0, NULL);
+      self->record_buffers[i] = gsk_vulkan_command_pool_get_buffer (self->record_command_pools[job]);
+      gsk_vulkan_render_pass_draw (self->record_passes[i], self, 3, self->pipeline_layout, self->record_buffers[i]);
     }
+
+  g_mutex_lock (&self->record_lock);
+  self->n_record_jobs--;
+  if (self->n_record_jobs == 0)
+    g_cond_signal (&self->record_cond);
+  g_mutex_unlock (&self->record_lock);
 }
 
 void
 gsk_vulkan_render_draw (GskVulkanRender *self)
 {
+  GskVulkanRenderPass **passes;
+  VkCommandBuffer *command_buffers;
+  guint i, n_passes;
   GList *l;
 
 #ifdef G_ENABLE_DEBUG
@@ -587,29 +729,63 @@ gsk_vulkan_render_draw (GskVulkanRender *self)
 
   gsk_vulkan_render_prepare_descriptor_sets (self);
 
-  for (l = self->render_passes; l; l = l->next)
+  n_passes = g_list_length (self->render_passes);
+  passes = g_newa (GskVulkanRenderPass *, n_passes);
+  command_buffers = g_newa (VkCommandBuffer, n_passes);
+
+  /* Everything that touches the render itself happens here, the
+   * recording does only read from it. */
+  for (l = self->render_passes, i = 0; l; l = l->next, i++)
+    {
+      passes[i] = l->data;
+      gsk_vulkan_render_pass_prepare_draw (passes[i], self);
+    }
+
+  if (self->record_threads && n_passes > 1)
+    {
+      self->record_passes = passes;
+      self->record_buffers = command_buffers;
+      self->n_record_passes = n_passes;
+      self->n_record_jobs = MIN (n_passes, self->n_record_threads);
+
+      for (i = 0; i < MIN (n_passes, self->n_record_threads); i++)
+        g_thread_pool_push (self->record_threads, GUINT_TO_POINTER (i + 1), NULL);
+
+      g_mutex_lock (&self->record_lock);
+      while (self->n_record_jobs > 0)
+        g_cond_wait (&self->record_cond, &self->record_lock);
+      g_mutex_unlock (&self->record_lock);
+
+      self->record_passes = NULL;
+      self->record_buffers = NULL;
+      self->n_record_passes = 0;
+    }
+  else
+    {
+      for (i = 0; i < n_passes; i++)
+        {
+          command_buffers[i] = gsk_vulkan_command_pool_get_buffer (self->command_pool);
+          gsk_vulkan_render_pass_draw (passes[i], self, 3, self->pipeline_layout, command_buffers[i]);
+        }
+    }
+
+  for (i = 0; i < n_passes; i++)
     {
-      GskVulkanRenderPass *pass = l->data;
-      VkCommandBuffer command_buffer;
       gsize wait_semaphore_count;
       gsize signal_semaphore_count;
       VkSemaphore *wait_semaphores;
       VkSemaphore *signal_semaphores;
 
-      wait_semaphore_count = gsk_vulkan_render_pass_get_wait_semaphores (pass, &wait_semaphores);
-      signal_semaphore_count = gsk_vulkan_render_pass_get_signal_semaphores (pass, &signal_semaphores);
-
-      command_buffer = gsk_vulkan_command_pool_get_buffer (self->command_pool);
-
-      gsk_vulkan_render_pass_draw (pass, self, 3, self->pipeline_layout, command_buffer);
+      wait_semaphore_count = gsk_vulkan_render_pass_get_wait_semaphores (passes[i], &wait_semaphores);
+      signal_semaphore_count = gsk_vulkan_render_pass_get_signal_semaphores (passes[i], &signal_semaphores);
 
       gsk_vulkan_command_pool_submit_buffer (self->command_pool,
-                                             command_buffer,
+                                             command_buffers[i],
                                              wait_semaphore_count,
                                              wait_semaphores,
                                              signal_semaphore_count,
                                              signal_semaphores,
-                                             l->next != NULL ? VK_NULL_HANDLE : self->fence);
+                                             i + 1 < n_passes ? VK_NULL_HANDLE : self->fence);
     }
 
 #ifdef G_ENABLE_DEBUG
@@ -643,6 +819,9 @@ static void
 gsk_vulkan_render_cleanup (GskVulkanRender *self)
 {
   VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+  CachedDescriptorSet *entry;
+  GHashTableIter iter;
+  guint i;
 
   /* XXX: Wait for fence here or just in reset()? */
   GSK_VK_CHECK (vkWaitForFences, device,
@@ -658,17 +837,40 @@ gsk_vulkan_render_cleanup (GskVulkanRender *self)
   gsk_vulkan_uploader_reset (self->uploader);
 
   gsk_vulkan_command_pool_reset (self->command_pool);
-
-  g_hash_table_remove_all (self->descriptor_set_indexes);
-  GSK_VK_CHECK (vkResetDescriptorPool, device,
-                                       self->descriptor_pool,
-                                       0);
+  for (i = 0; i < MAX_RECORD_THREADS; i++)
+    {
+      if (self->record_command_pools[i])
+        gsk_vulkan_command_pool_reset (self->record_command_pools[i]);
+    }
 
   g_list_free_full (self->render_passes, (GDestroyNotify) gsk_vulkan_render_pass_free);
   self->render_passes = NULL;
   g_slist_free_full (self->cleanup_images, g_object_unref);
   self->cleanup_images = NULL;
 
+  /* look for descriptor sets whose image is gone or that have grown old */
+  for (i = 0; i < self->dead_descriptor_sets->len; i++)
+    gsk_vulkan_render_free_descriptor_set (self, &g_array_index (self->dead_descriptor_sets, CachedDescriptorSet, i));
+  g_array_set_size (self->dead_descriptor_sets, 0);
+
+  g_hash_table_iter_init (&iter, self->cached_descriptor_sets);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL))
+    {
+      if (self->frame - entry->frame < DESCRIPTOR_SET_MAX_AGE)
+        continue;
+
+      g_object_weak_unref (G_OBJECT (entry->image), gsk_vulkan_render_remove_descriptor_set_from_image, entry);
+      gsk_vulkan_render_free_descriptor_set (self, entry);
+      g_hash_table_iter_remove (&iter);
+      g_free (entry);
+    }
+
+  g_array_set_size (self->descriptor_sets, 0);
+  self->frame++;
+  g_slist_free_full (self->cleanup_buffers, (GDestroyNotify) gsk_vulkan_buffer_free);
+  self->cleanup_buffers = NULL;
+  self->vertex_buffer_used = 0;
+
   g_clear_pointer (&self->clip, cairo_region_destroy);
   g_clear_object (&self->target);
 }
@@ -704,6 +906,8 @@ gsk_vulkan_render_free (GskVulkanRender *self)
 
   g_clear_pointer (&self->uploader, gsk_vulkan_uploader_free);
 
+  g_clear_pointer (&self->vertex_buffer, gsk_vulkan_buffer_free);
+
   for (i = 0; i < 3; i++)
     vkDestroyPipelineLayout (device,
                              self->pipeline_layout[i],
@@ -713,11 +917,29 @@ gsk_vulkan_render_free (GskVulkanRender *self)
                        self->render_pass,
                        NULL);
 
-  vkDestroyDescriptorPool (device,
-                           self->descriptor_pool,
-                           NULL);
-  g_free (self->descriptor_sets);
-  g_hash_table_unref (self->descriptor_set_indexes);
+  /* destroying the pools frees all their sets */
+  g_hash_table_iter_init (&iter, self->cached_descriptor_sets);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      CachedDescriptorSet *entry = key;
+
+      g_object_weak_unref (G_OBJECT (entry->image), gsk_vulkan_render_remove_descriptor_set_from_image, entry);
+      g_hash_table_iter_remove (&iter);
+      g_free (entry);
+    }
+  g_hash_table_unref (self->cached_descriptor_sets);
+  g_array_unref (self->dead_descriptor_sets);
+  g_array_unref (self->descriptor_sets);
+
+  for (i = 0; i < self->descriptor_pools->len; i++)
+    {
+      DescriptorPool *pool = g_ptr_array_index (self->descriptor_pools, i);
+
+      vkDestroyDescriptorPool (device,
+                               pool->pool,
+                               NULL);
+    }
+  g_ptr_array_unref (self->descriptor_pools);
 
   vkDestroyDescriptorSetLayout (device,
                                 self->descriptor_set_layout,
@@ -735,6 +957,15 @@ gsk_vulkan_render_free (GskVulkanRender *self)
                     self->repeating_sampler,
                     NULL);
 
+  if (self->record_threads)
+    {
+      g_thread_pool_free (self->record_threads, FALSE, TRUE);
+      for (i = 0; i < self->n_record_threads; i++)
+        gsk_vulkan_command_pool_free (self->record_command_pools[i]);
+      g_mutex_clear (&self->record_lock);
+      g_cond_clear (&self->record_cond);
+    }
+
   gsk_vulkan_command_pool_free (self->command_pool);
 
   g_slice_free (GskVulkanRender, self);
@@ -749,11 +980,12 @@ gsk_vulkan_render_is_busy (GskVulkanRender *self)
 void
 gsk_vulkan_render_reset (GskVulkanRender       *self,
                          GskVulkanImage        *target,
-                         const graphene_rect_t *rect)
+                         const graphene_rect_t *rect,
+                         const cairo_region_t  *clip)
 {
   gsk_vulkan_render_cleanup (self);
 
-  gsk_vulkan_render_setup (self, target, rect);
+  gsk_vulkan_render_setup (self, target, rect, clip);
 }
 
 GskRenderer *
@@ -8,6 +8,7 @@
 #include "gskrendernodeprivate.h"
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderprivate.h"
 #include "gskvulkanglyphcacheprivate.h"
@@ -16,6 +17,17 @@
 
 #include <graphene.h>
 
+/* How many frames the CPU may build ahead of the GPU */
+#define MAX_FRAMES_IN_FLIGHT 3
+
+/* Offscreen images that weren't used for this many frames are dropped */
+#define OFFSCREEN_MAX_AGE 60
+/* How many offscreen images are kept at most, the least recently
+ * used one is dropped to make room for a new one */
+#define MAX_OFFSCREENS 64
+/* How many dropped offscreen images are kept for reuse */
+#define MAX_POOLED_IMAGES 16
+
 typedef struct _GskVulkanTextureData GskVulkanTextureData;
 
 struct _GskVulkanTextureData {
@@ -24,12 +36,44 @@ struct _GskVulkanTextureData {
   GskVulkanRenderer *renderer;
 };
 
+typedef struct _GskVulkanSurfaceData GskVulkanSurfaceData;
+
+struct _GskVulkanSurfaceData {
+  cairo_surface_t *surface;
+  GskVulkanImage *image;
+  GskVulkanRenderer *renderer;
+};
+
+static cairo_user_data_key_t surface_data_key;
+
+typedef struct _GskVulkanOffscreenKey GskVulkanOffscreenKey;
+typedef struct _GskVulkanOffscreen GskVulkanOffscreen;
+
+struct _GskVulkanOffscreenKey {
+  GskRenderNode *node;
+  float mv[16];
+  graphene_rect_t bounds;
+  int scale_factor;
+};
+
+struct _GskVulkanOffscreen {
+  GskVulkanOffscreenKey key; /* must be first */
+  GskVulkanImage *image;
+  /* the render that draws the image, until it is known to be done */
+  GskVulkanRender *render;
+  guint64 frame; /* when the image was last used */
+};
+
 #ifdef G_ENABLE_DEBUG
 typedef struct {
   GQuark frames;
   GQuark render_passes;
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  /* per memory pool */
+  GQuark memory_allocated[GSK_VULKAN_N_MEMORY_POOLS];
+  GQuark memory_used[GSK_VULKAN_N_MEMORY_POOLS];
+  GQuark memory_allocations[GSK_VULKAN_N_MEMORY_POOLS];
 } ProfileCounters;
 
 typedef struct {
@@ -46,10 +90,21 @@ struct _GskVulkanRenderer
 
   guint n_targets;
   GskVulkanImage **targets;
+  /* area that changed since each target was last drawn,
+   * or NULL if the target's contents are unknown */
+  cairo_region_t **target_damage;
 
-  GskVulkanRender *render;
+  /* in the order they were submitted, oldest first */
+  GList *renders;
 
   GSList *textures;
+  GSList *surfaces;
+
+  /* Images of subtrees that were drawn offscreen, see
+   * gsk_vulkan_renderer_ref_offscreen_image() */
+  GHashTable *offscreens;
+  GPtrArray *image_pool;
+  guint64 frame;
 
   GskVulkanGlyphCache *glyph_cache;
 
@@ -66,6 +121,182 @@ struct _GskVulkanRendererClass
 
 G_DEFINE_TYPE (GskVulkanRenderer, gsk_vulkan_renderer, GSK_TYPE_RENDERER)
 
+#ifdef G_ENABLE_DEBUG
+static void
+gsk_vulkan_renderer_update_memory_counters (GskVulkanRenderer *self,
+                                            GskProfiler       *profiler)
+{
+  GskVulkanMemoryStats stats;
+  guint i;
+
+  for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+    {
+      gsk_vulkan_memory_get_stats (self->vulkan, i, &stats);
+
+      gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocated[i], stats.allocated);
+      gsk_profiler_counter_set (profiler, self->profile_counters.memory_used[i], stats.used);
+      gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocations[i], stats.n_allocations);
+    }
+}
+#endif
+
+static guint
+gsk_vulkan_offscreen_key_hash (gconstpointer data)
+{
+  const GskVulkanOffscreenKey *key = data;
+  guint hash;
+
+  hash = gsk_hash_combine (gsk_render_node_hash (key->node), key->scale_factor);
+  hash = gsk_hash_floats (hash, key->mv, 16);
+  hash = gsk_hash_floats (hash,
+                          (float[4]) { key->bounds.origin.x, key->bounds.origin.y,
+                                       key->bounds.size.width, key->bounds.size.height },
+                          4);
+
+  return hash;
+}
+
+static gboolean
+gsk_vulkan_offscreen_key_equal (gconstpointer v1,
+                                gconstpointer v2)
+{
+  const GskVulkanOffscreenKey *key1 = v1;
+  const GskVulkanOffscreenKey *key2 = v2;
+  guint i;
+
+  if (key1->scale_factor != key2->scale_factor ||
+      !graphene_rect_equal (&key1->bounds, &key2->bounds))
+    return FALSE;
+
+  for (i = 0; i < 16; i++)
+    {
+      if (key1->mv[i] != key2->mv[i])
+        return FALSE;
+    }
+
+  return gsk_render_node_equal (key1->node, key2->node);
+}
+
+static void
+gsk_vulkan_offscreen_key_init (GskVulkanOffscreenKey   *key,
+                               GskRenderNode           *node,
+                               const graphene_matrix_t *mv,
+                               const graphene_rect_t   *bounds,
+                               int                      scale_factor)
+{
+  key->node = node;
+  graphene_matrix_to_float (mv, key->mv);
+  key->bounds = *bounds;
+  key->scale_factor = scale_factor;
+}
+
+static void
+gsk_vulkan_offscreen_free (gpointer data)
+{
+  GskVulkanOffscreen *offscreen = data;
+
+  gsk_render_node_unref (offscreen->key.node);
+  g_object_unref (offscreen->image);
+
+  g_slice_free (GskVulkanOffscreen, offscreen);
+}
+
+/* Keeps @image for gsk_vulkan_renderer_get_pooled_image(), takes
+ * ownership of it */
+static void
+gsk_vulkan_renderer_pool_image (GskVulkanRenderer *self,
+                                GskVulkanImage    *image)
+{
+  if (self->image_pool->len >= MAX_POOLED_IMAGES)
+    {
+      g_object_unref (g_ptr_array_index (self->image_pool, 0));
+      g_ptr_array_remove_index (self->image_pool, 0);
+    }
+
+  g_ptr_array_add (self->image_pool, image);
+}
+
+static GskVulkanImage *
+gsk_vulkan_renderer_get_pooled_image (GskVulkanRenderer *self,
+                                      gsize              width,
+                                      gsize              height)
+{
+  guint i;
+
+  for (i = 0; i < self->image_pool->len; i++)
+    {
+      GskVulkanImage *image = g_ptr_array_index (self->image_pool, i);
+
+      /* Renders that still sample from the image hold a reference,
+       * drawing into it would change their result. */
+      if (gsk_vulkan_image_get_width (image) == width &&
+          gsk_vulkan_image_get_height (image) == height &&
+          G_OBJECT (image)->ref_count == 1)
+        {
+          g_ptr_array_remove_index (self->image_pool, i);
+          return image;
+        }
+    }
+
+  return NULL;
+}
+
+static void
+gsk_vulkan_renderer_begin_offscreen_frame (GskVulkanRenderer *self)
+{
+  GHashTableIter iter;
+  GskVulkanOffscreen *offscreen;
+
+  self->frame++;
+
+  g_hash_table_iter_init (&iter, self->offscreens);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &offscreen))
+    {
+      if (self->frame - offscreen->frame < OFFSCREEN_MAX_AGE)
+        continue;
+
+      gsk_vulkan_renderer_pool_image (self, g_object_ref (offscreen->image));
+      g_hash_table_iter_remove (&iter);
+    }
+}
+
+static void
+gsk_vulkan_renderer_drop_oldest_offscreen (GskVulkanRenderer *self)
+{
+  GHashTableIter iter;
+  GskVulkanOffscreen *offscreen, *oldest = NULL;
+
+  g_hash_table_iter_init (&iter, self->offscreens);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &offscreen))
+    {
+      if (oldest == NULL || offscreen->frame < oldest->frame)
+        oldest = offscreen;
+    }
+
+  if (oldest == NULL)
+    return;
+
+  gsk_vulkan_renderer_pool_image (self, g_object_ref (oldest->image));
+  g_hash_table_remove (self->offscreens, &oldest->key);
+}
+
+/* Called when @render finished all its work, either because it is about
+ * to go away or because it is reset for a new frame */
+static void
+gsk_vulkan_renderer_forget_render (GskVulkanRenderer *self,
+                                   GskVulkanRender   *render)
+{
+  GHashTableIter iter;
+  GskVulkanOffscreen *offscreen;
+
+  g_hash_table_iter_init (&iter, self->offscreens);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &offscreen))
+    {
+      if (offscreen->render == render)
+        offscreen->render = NULL;
+    }
+}
+
 static void
 gsk_vulkan_renderer_free_targets (GskVulkanRenderer *self)
 {
@@ -74,9 +305,11 @@ gsk_vulkan_renderer_free_targets (GskVulkanRenderer *self)
   for (i = 0; i < self->n_targets; i++)
     {
       g_object_unref (self->targets[i]);
+      g_clear_pointer (&self->target_damage[i], cairo_region_destroy);
     }
 
   g_clear_pointer (&self->targets, g_free);
+  g_clear_pointer (&self->target_damage, g_free);
   self->n_targets = 0;
 }
 
@@ -93,6 +326,7 @@ gsk_vulkan_renderer_update_images_cb (GdkVulkanContext  *context,
 
   self->n_targets = gdk_vulkan_context_get_n_images (context);
   self->targets = g_new (GskVulkanImage *, self->n_targets);
+  self->target_damage = g_new0 (cairo_region_t *, self->n_targets);
 
   window = gsk_renderer_get_window (GSK_RENDERER (self));
   scale_factor = gdk_window_get_scale_factor (window);
@@ -125,7 +359,7 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
                     self);
   gsk_vulkan_renderer_update_images_cb (self->vulkan, self);
 
-  self->render = gsk_vulkan_render_new (renderer, self->vulkan);
+  gsk_vulkan_pipeline_cache_load (self->vulkan);
 
   self->glyph_cache = gsk_vulkan_glyph_cache_new (renderer, self->vulkan);
 
@@ -140,6 +374,10 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
 
   g_clear_object (&self->glyph_cache);
 
+  g_hash_table_remove_all (self->offscreens);
+  g_ptr_array_foreach (self->image_pool, (GFunc) g_object_unref, NULL);
+  g_ptr_array_set_size (self->image_pool, 0);
+
   for (l = self->textures; l; l = l->next)
     {
       GskVulkanTextureData *data = l->data;
@@ -149,9 +387,22 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
     }
   g_clear_pointer (&self->textures, (GDestroyNotify) g_slist_free);
 
-  g_clear_pointer (&self->render, gsk_vulkan_render_free);
+  for (l = self->surfaces; l; l = l->next)
+    {
+      GskVulkanSurfaceData *data = l->data;
+
+      data->renderer = NULL;
+      cairo_surface_set_user_data (data->surface, &surface_data_key, NULL, NULL);
+    }
+  g_clear_pointer (&self->surfaces, (GDestroyNotify) g_slist_free);
+
+  g_list_free_full (self->renders, (GDestroyNotify) gsk_vulkan_render_free);
+  self->renders = NULL;
+
+  gsk_vulkan_pipeline_cache_save (self->vulkan);
 
   gsk_vulkan_renderer_free_targets (self);
+  gsk_vulkan_memory_release_cached (self->vulkan);
   g_signal_handlers_disconnect_by_func(self->vulkan,
                                        gsk_vulkan_renderer_update_images_cb,
                                        self);
@@ -183,11 +434,13 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
 
   render = gsk_vulkan_render_new (renderer, self->vulkan);
 
+  gsk_vulkan_renderer_begin_offscreen_frame (self);
+
   image = gsk_vulkan_image_new_for_framebuffer (self->vulkan,
                                                 ceil (viewport->size.width),
                                                 ceil (viewport->size.height));
 
-  gsk_vulkan_render_reset (render, image, viewport);
+  gsk_vulkan_render_reset (render, image, viewport, NULL);
 
   gsk_vulkan_render_add_node (render, root);
 
@@ -198,9 +451,12 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   texture = gsk_vulkan_render_download_target (render);
 
   g_object_unref (image);
+  gsk_vulkan_renderer_forget_render (self, render);
   gsk_vulkan_render_free (render);
 
 #ifdef G_ENABLE_DEBUG
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
+
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
@@ -210,12 +466,95 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   return texture;
 }
 
+/* Returns the part of the drawing context clip that needs to be drawn
+ * to bring the target up to date, or NULL to draw the whole clip.
+ */
+static cairo_region_t *
+gsk_vulkan_renderer_get_render_region (GskVulkanRenderer *self,
+                                       guint              draw_index)
+{
+  cairo_region_t *damage = gsk_renderer_get_damage (GSK_RENDERER (self));
+  cairo_region_t *clip, *result;
+  guint i;
+
+  for (i = 0; i < self->n_targets; i++)
+    {
+      if (self->target_damage[i] == NULL)
+        continue;
+
+      if (damage)
+        cairo_region_union (self->target_damage[i], damage);
+      else
+        g_clear_pointer (&self->target_damage[i], cairo_region_destroy);
+    }
+
+  clip = gdk_drawing_context_get_clip (gsk_renderer_get_drawing_context (GSK_RENDERER (self)));
+  if (clip == NULL)
+    clip = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                              0, 0,
+                                              gdk_window_get_width (gsk_renderer_get_window (GSK_RENDERER (self))),
+                                              gdk_window_get_height (gsk_renderer_get_window (GSK_RENDERER (self)))
+                                          });
+
+  if (self->target_damage[draw_index] == NULL)
+    {
+      /* The clip GDK computed for this target brings it up to date */
+      result = NULL;
+      self->target_damage[draw_index] = cairo_region_create ();
+    }
+  else
+    {
+      result = cairo_region_copy (self->target_damage[draw_index]);
+      cairo_region_intersect (result, clip);
+      cairo_region_subtract (self->target_damage[draw_index], clip);
+    }
+
+  cairo_region_destroy (clip);
+
+  return result;
+}
+
+/* Every render has its own command buffers, descriptor sets, vertex
+ * buffer and uploader, so while the GPU is still busy with one frame we
+ * can build the next one in another render. Only once all of them are
+ * in flight do we wait for the oldest one to finish.
+ */
+static GskVulkanRender *
+gsk_vulkan_renderer_get_render (GskVulkanRenderer *self)
+{
+  GskVulkanRender *render;
+  GList *l;
+
+  for (l = self->renders; l; l = l->next)
+    {
+      if (!gsk_vulkan_render_is_busy (l->data))
+        break;
+    }
+
+  if (l == NULL && g_list_length (self->renders) < MAX_FRAMES_IN_FLIGHT)
+    {
+      render = gsk_vulkan_render_new (GSK_RENDERER (self), self->vulkan);
+    }
+  else
+    {
+      if (l == NULL)
+        l = self->renders;
+      render = l->data;
+      self->renders = g_list_delete_link (self->renders, l);
+    }
+
+  self->renders = g_list_append (self->renders, render);
+
+  return render;
+}
+
 static void
 gsk_vulkan_renderer_render (GskRenderer   *renderer,
                             GskRenderNode *root)
 {
   GskVulkanRenderer *self = GSK_VULKAN_RENDERER (renderer);
   GskVulkanRender *render;
+  cairo_region_t *clip;
 #ifdef G_ENABLE_DEBUG
   GskProfiler *profiler;
   gint64 cpu_time;
@@ -229,9 +568,17 @@ gsk_vulkan_renderer_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  render = self->render;
+  render = gsk_vulkan_renderer_get_render (self);
+
+  clip = gsk_vulkan_renderer_get_render_region (self, gdk_vulkan_context_get_draw_index (self->vulkan));
+
+  gsk_vulkan_render_reset (render, self->targets[gdk_vulkan_context_get_draw_index (self->vulkan)], NULL, clip);
+  gsk_vulkan_renderer_forget_render (self, render);
+
+  g_clear_pointer (&clip, cairo_region_destroy);
 
-  gsk_vulkan_render_reset (render, self->targets[gdk_vulkan_context_get_draw_index (self->vulkan)], NULL);
+  gsk_vulkan_glyph_cache_begin_frame (self->glyph_cache);
+  gsk_vulkan_renderer_begin_offscreen_frame (self);
 
   gsk_vulkan_render_add_node (render, root);
 
@@ -241,6 +588,7 @@ gsk_vulkan_renderer_render (GskRenderer   *renderer,
 
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (profiler, self->profile_counters.frames);
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
 
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
@@ -263,11 +611,26 @@ gsk_vulkan_renderer_begin_draw_frame (GskRenderer          *renderer,
   return result;
 }
 
+static void
+gsk_vulkan_renderer_finalize (GObject *object)
+{
+  GskVulkanRenderer *self = GSK_VULKAN_RENDERER (object);
+
+  g_hash_table_unref (self->offscreens);
+  g_ptr_array_foreach (self->image_pool, (GFunc) g_object_unref, NULL);
+  g_ptr_array_unref (self->image_pool);
+
+  G_OBJECT_CLASS (gsk_vulkan_renderer_parent_class)->finalize (object);
+}
+
 static void
 gsk_vulkan_renderer_class_init (GskVulkanRendererClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
 
+  object_class->finalize = gsk_vulkan_renderer_finalize;
+
   renderer_class->realize = gsk_vulkan_renderer_realize;
   renderer_class->unrealize = gsk_vulkan_renderer_unrealize;
   renderer_class->render = gsk_vulkan_renderer_render;
@@ -284,12 +647,46 @@ gsk_vulkan_renderer_init (GskVulkanRenderer *self)
 
   gsk_ensure_resources ();
 
+  self->offscreens = g_hash_table_new_full (gsk_vulkan_offscreen_key_hash,
+                                            gsk_vulkan_offscreen_key_equal,
+                                            NULL,
+                                            gsk_vulkan_offscreen_free);
+  self->image_pool = g_ptr_array_new ();
+
 #ifdef G_ENABLE_DEBUG
   self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
   self->profile_counters.render_passes = gsk_profiler_add_counter (profiler, "render-passes", "Render passes", FALSE);
   self->profile_counters.fallback_pixels = gsk_profiler_add_counter (profiler, "fallback-pixels", "Fallback pixels", TRUE);
   self->profile_counters.texture_pixels = gsk_profiler_add_counter (profiler, "texture-pixels", "Texture pixels", TRUE);
 
+  {
+    static const char *pools[GSK_VULKAN_N_MEMORY_POOLS] = { "staging", "vertex", "image" };
+    guint i;
+
+    for (i = 0; i < GSK_VULKAN_N_MEMORY_POOLS; i++)
+      {
+        char *name, *description;
+
+        name = g_strdup_printf ("%s-memory-allocated", pools[i]);
+        description = g_strdup_printf ("Device memory in %s pool", pools[i]);
+        self->profile_counters.memory_allocated[i] = gsk_profiler_add_counter (profiler, name, description, FALSE);
+        g_free (name);
+        g_free (description);
+
+        name = g_strdup_printf ("%s-memory-used", pools[i]);
+        description = g_strdup_printf ("Used memory in %s pool", pools[i]);
+        self->profile_counters.memory_used[i] = gsk_profiler_add_counter (profiler, name, description, FALSE);
+        g_free (name);
+        g_free (description);
+
+        name = g_strdup_printf ("%s-memory-allocations", pools[i]);
+        description = g_strdup_printf ("Allocations in %s pool", pools[i]);
+        self->profile_counters.memory_allocations[i] = gsk_profiler_add_counter (profiler, name, description, FALSE);
+        g_free (name);
+        g_free (description);
+      }
+  }
+
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), SYNC))
     self->profile_timers.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU time", FALSE, TRUE);
@@ -348,28 +745,176 @@ gsk_vulkan_renderer_ref_texture_image (GskVulkanRenderer *self,
   return image;
 }
 
+static void
+gsk_vulkan_renderer_clear_surface (gpointer p)
+{
+  GskVulkanSurfaceData *data = p;
+
+  if (data->renderer != NULL)
+    data->renderer->surfaces = g_slist_remove (data->renderer->surfaces, data);
+
+  g_object_unref (data->image);
+
+  g_slice_free (GskVulkanSurfaceData, data);
+}
+
+/* Like gsk_vulkan_renderer_ref_texture_image(), but for the image
+ * surfaces of cairo nodes. Their pixels don't change once they have
+ * been drawn, so the image is kept until the surface goes away. */
+GskVulkanImage *
+gsk_vulkan_renderer_ref_surface_image (GskVulkanRenderer *self,
+                                       cairo_surface_t   *surface,
+                                       GskVulkanUploader *uploader)
+{
+  GskVulkanSurfaceData *data;
+  GskVulkanImage *image;
+
+  data = cairo_surface_get_user_data (surface, &surface_data_key);
+  if (data && data->renderer == self)
+    return g_object_ref (data->image);
+
+  image = gsk_vulkan_image_new_from_data (uploader,
+                                          cairo_image_surface_get_data (surface),
+                                          cairo_image_surface_get_width (surface),
+                                          cairo_image_surface_get_height (surface),
+                                          cairo_image_surface_get_stride (surface));
+
+  /* The surface is cached by another renderer */
+  if (data)
+    return image;
+
+  data = g_slice_new0 (GskVulkanSurfaceData);
+  data->image = g_object_ref (image);
+  data->surface = surface;
+  data->renderer = self;
+
+  if (cairo_surface_set_user_data (surface, &surface_data_key, data, gsk_vulkan_renderer_clear_surface) == CAIRO_STATUS_SUCCESS)
+    {
+      self->surfaces = g_slist_prepend (self->surfaces, data);
+    }
+  else
+    {
+      g_object_unref (data->image);
+      g_slice_free (GskVulkanSurfaceData, data);
+    }
+
+  return image;
+}
+
+/* Render nodes are immutable, so the image of an equal subtree that was
+ * drawn with the same transform into the same area in an earlier frame
+ * can be used again. Returns %NULL if there is no such image, or if the
+ * GPU may still be drawing it.
+ */
+GskVulkanImage *
+gsk_vulkan_renderer_ref_offscreen_image (GskVulkanRenderer       *self,
+                                         GskVulkanRender         *render,
+                                         GskRenderNode           *node,
+                                         const graphene_matrix_t *mv,
+                                         const graphene_rect_t   *bounds,
+                                         int                      scale_factor)
+{
+  GskVulkanOffscreenKey key;
+  GskVulkanOffscreen *offscreen;
+
+  gsk_vulkan_offscreen_key_init (&key, node, mv, bounds, scale_factor);
+
+  offscreen = g_hash_table_lookup (self->offscreens, &key);
+  if (offscreen == NULL)
+    return NULL;
+
+  if (offscreen->render != NULL)
+    {
+      /* A render that isn't busy is done with everything it
+       * submitted. Passes of the same render are only ordered by
+       * their semaphores, so don't share images there. Renders forget
+       * their images when they are reset, so this only refuses images
+       * drawn in the current frame. */
+      if (offscreen->render == render ||
+          gsk_vulkan_render_is_busy (offscreen->render))
+        return NULL;
+
+      offscreen->render = NULL;
+    }
+
+  offscreen->frame = self->frame;
+
+  return g_object_ref (offscreen->image);
+}
+
+/* Returns an image of the given size that @render draws @node into,
+ * and remembers it for gsk_vulkan_renderer_ref_offscreen_image().
+ */
+GskVulkanImage *
+gsk_vulkan_renderer_create_offscreen_image (GskVulkanRenderer       *self,
+                                            GskVulkanRender         *render,
+                                            GskRenderNode           *node,
+                                            const graphene_matrix_t *mv,
+                                            const graphene_rect_t   *bounds,
+                                            int                      scale_factor,
+                                            gsize                    width,
+                                            gsize                    height)
+{
+  GskVulkanOffscreen *offscreen, *old;
+  GskVulkanImage *image;
+
+  image = gsk_vulkan_renderer_get_pooled_image (self, width, height);
+  if (image == NULL)
+    image = gsk_vulkan_image_new_for_texture (self->vulkan, width, height);
+
+  offscreen = g_slice_new0 (GskVulkanOffscreen);
+  gsk_vulkan_offscreen_key_init (&offscreen->key, gsk_render_node_ref (node), mv, bounds, scale_factor);
+  offscreen->image = g_object_ref (image);
+  offscreen->render = render;
+  offscreen->frame = self->frame;
+
+  /* The image for the same key from an earlier frame may still be in
+   * use, the pool only hands it out again once it isn't. */
+  old = g_hash_table_lookup (self->offscreens, &offscreen->key);
+  if (old)
+    {
+      gsk_vulkan_renderer_pool_image (self, g_object_ref (old->image));
+      g_hash_table_remove (self->offscreens, &old->key);
+    }
+  else if (g_hash_table_size (self->offscreens) >= MAX_OFFSCREENS)
+    {
+      gsk_vulkan_renderer_drop_oldest_offscreen (self);
+    }
+
+  g_hash_table_insert (self->offscreens, &offscreen->key, offscreen);
+
+  return image;
+}
+
 guint
 gsk_vulkan_renderer_cache_glyph (GskVulkanRenderer *self,
                                  PangoFont         *font,
                                  PangoGlyph         glyph,
+                                 guint              phase,
                                  float              scale)
 {
-  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, TRUE, font, glyph, scale)->texture_index;
+  GskCachedGlyph *cached;
+
+  cached = gsk_vulkan_glyph_cache_lookup (self->glyph_cache, TRUE, font, glyph, phase, scale);
+
+  /* 0 for glyphs that don't need to be drawn or don't fit into the cache */
+  return cached->atlas ? cached->atlas->id : 0;
 }
 
 GskVulkanImage *
 gsk_vulkan_renderer_ref_glyph_image (GskVulkanRenderer  *self,
                                      GskVulkanUploader  *uploader,
-                                     guint               index)
+                                     guint               atlas_id)
 {
-  return g_object_ref (gsk_vulkan_glyph_cache_get_glyph_image (self->glyph_cache, uploader, index));
+  return g_object_ref (gsk_vulkan_glyph_cache_get_glyph_image (self->glyph_cache, uploader, atlas_id));
 }
 
-GskVulkanCachedGlyph *
+GskCachedGlyph *
 gsk_vulkan_renderer_get_cached_glyph (GskVulkanRenderer *self,
                                       PangoFont         *font,
                                       PangoGlyph         glyph,
+                                      guint              phase,
                                       float              scale)
 {
-  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, FALSE, font, glyph, scale);
+  return gsk_vulkan_glyph_cache_lookup (self->glyph_cache, FALSE, font, glyph, phase, scale);
 }
@@ -5,6 +5,8 @@
 #include <gsk/gskrenderer.h>
 
 #include "gskvulkanimageprivate.h"
+#include "gskglyphcacheprivate.h"
+#include "gsk/gskprivate.h"
 
 G_BEGIN_DECLS
 
@@ -24,36 +26,39 @@ GType gsk_vulkan_renderer_get_type (void) G_GNUC_CONST;
 GskVulkanImage *        gsk_vulkan_renderer_ref_texture_image           (GskVulkanRenderer      *self,
                                                                          GdkTexture             *texture,
                                                                          GskVulkanUploader      *uploader);
+GskVulkanImage *        gsk_vulkan_renderer_ref_surface_image           (GskVulkanRenderer      *self,
+                                                                         cairo_surface_t        *surface,
+                                                                         GskVulkanUploader      *uploader);
 
-typedef struct
-{
-  guint texture_index;
-
-  float tx;
-  float ty;
-  float tw;
-  float th;
-
-  int draw_x;
-  int draw_y;
-  int draw_width;
-  int draw_height;
-
-  guint64 timestamp;
-} GskVulkanCachedGlyph;
+GskVulkanImage *        gsk_vulkan_renderer_ref_offscreen_image         (GskVulkanRenderer      *self,
+                                                                         GskVulkanRender        *render,
+                                                                         GskRenderNode          *node,
+                                                                         const graphene_matrix_t *mv,
+                                                                         const graphene_rect_t  *bounds,
+                                                                         int                     scale_factor);
+GskVulkanImage *        gsk_vulkan_renderer_create_offscreen_image      (GskVulkanRenderer      *self,
+                                                                         GskVulkanRender        *render,
+                                                                         GskRenderNode          *node,
+                                                                         const graphene_matrix_t *mv,
+                                                                         const graphene_rect_t  *bounds,
+                                                                         int                     scale_factor,
+                                                                         gsize                   width,
+                                                                         gsize                   height);
 
 guint                  gsk_vulkan_renderer_cache_glyph      (GskVulkanRenderer *renderer,
                                                              PangoFont         *font,
                                                              PangoGlyph         glyph,
+                                                             guint              phase,
                                                              float              scale);
 
 GskVulkanImage *       gsk_vulkan_renderer_ref_glyph_image  (GskVulkanRenderer *self,
                                                              GskVulkanUploader *uploader,
-                                                             guint              index);
+                                                             guint              atlas_id);
 
-GskVulkanCachedGlyph * gsk_vulkan_renderer_get_cached_glyph (GskVulkanRenderer *self,
+GskCachedGlyph *       gsk_vulkan_renderer_get_cached_glyph (GskVulkanRenderer *self,
                                                              PangoFont         *font,
                                                              PangoGlyph         glyph,
+                                                             guint              phase,
                                                              float              scale);
 
 
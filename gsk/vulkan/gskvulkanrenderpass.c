@@ -87,7 +87,7 @@ struct _GskVulkanOpText
   gsize                vertex_offset; /* offset into vertex buffer */
   gsize                vertex_count; /* number of vertices */
   gsize                descriptor_set_index; /* index into descriptor sets array for the right descriptor set to bind */
-  guint                texture_index; /* index of the texture in the glyph cache */
+  guint                texture_index; /* id of the glyph cache atlas */
   guint                start_glyph; /* the first glyph in nodes glyphstring that we render */
   guint                num_glyphs; /* number of *non-empty* glyphs (== instances) we render */
   float                scale;
@@ -124,7 +124,9 @@ struct _GskVulkanRenderPass
   VkRenderPass render_pass;
   VkSemaphore signal_semaphore;
   GArray *wait_semaphores;
+  /* owned by the GskVulkanRender */
   GskVulkanBuffer *vertex_data;
+  VkFramebuffer framebuffer;
 
   GQuark fallback_pixels;
   GQuark texture_pixels;
@@ -224,8 +226,6 @@ gsk_vulkan_render_pass_free (GskVulkanRenderPass *self)
   vkDestroyRenderPass (gdk_vulkan_context_get_device (self->vulkan),
                        self->render_pass,
                        NULL);
-  if (self->vertex_data)
-    gsk_vulkan_buffer_free (self->vertex_data);
   if (self->signal_semaphore != VK_NULL_HANDLE)
     vkDestroySemaphore (gdk_vulkan_context_get_device (self->vulkan),
                         self->signal_semaphore,
@@ -276,6 +276,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
       g_assert_not_reached ();
       return;
     case GSK_SHADOW_NODE:
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
     default:
       FALLBACK ("Unsupported node '%s'", node->node_class->type_name);
 
@@ -284,7 +286,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP_ROUNDED;
       else
         FALLBACK ("Repeat nodes can't deal with clip type %u", constants->clip.type);
@@ -298,7 +301,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_BLEND_MODE;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_BLEND_MODE_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_BLEND_MODE_CLIP_ROUNDED;
       else
         FALLBACK ("Blend nodes can't deal with clip type %u", constants->clip.type);
@@ -312,7 +316,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_CROSS_FADE;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_CROSS_FADE_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_CROSS_FADE_CLIP_ROUNDED;
       else
         FALLBACK ("Cross fade nodes can't deal with clip type %u", constants->clip.type);
@@ -328,7 +333,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_INSET_SHADOW;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_INSET_SHADOW_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_INSET_SHADOW_CLIP_ROUNDED;
       else
         FALLBACK ("Inset shadow nodes can't deal with clip type %u", constants->clip.type);
@@ -344,7 +350,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_OUTSET_SHADOW;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_OUTSET_SHADOW_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_OUTSET_SHADOW_CLIP_ROUNDED;
       else
         FALLBACK ("Outset shadow nodes can't deal with clip type %u", constants->clip.type);
@@ -360,7 +367,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP_ROUNDED;
       else
         FALLBACK ("Cairo nodes can't deal with clip type %u", constants->clip.type);
@@ -377,6 +385,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         int i;
         guint count;
         guint texture_index;
+        int x_position = 0;
+        float x = gsk_text_node_get_x (node);
         GskVulkanRenderer *renderer = GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render));
 
         if (font_has_color_glyphs (font))
@@ -385,7 +395,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
               pipeline_type = GSK_VULKAN_PIPELINE_COLOR_TEXT;
             else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
               pipeline_type = GSK_VULKAN_PIPELINE_COLOR_TEXT_CLIP;
-            else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+            else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+                     constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
               pipeline_type = GSK_VULKAN_PIPELINE_COLOR_TEXT_CLIP_ROUNDED;
             else
               FALLBACK ("Text nodes can't deal with clip type %u", constants->clip.type);
@@ -397,7 +408,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
               pipeline_type = GSK_VULKAN_PIPELINE_TEXT;
             else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
               pipeline_type = GSK_VULKAN_PIPELINE_TEXT_CLIP;
-            else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+            else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+                     constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
               pipeline_type = GSK_VULKAN_PIPELINE_TEXT_CLIP_ROUNDED;
             else
               FALLBACK ("Text nodes can't deal with clip type %u", constants->clip.type);
@@ -412,8 +424,19 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         for (i = 0, count = 0; i < num_glyphs; i++)
           {
             const PangoGlyphInfo *gi = &glyphs[i];
+            guint phase;
 
-            texture_index = gsk_vulkan_renderer_cache_glyph (renderer, (PangoFont *)font, gi->glyph, op.text.scale);
+            gsk_glyph_cache_snap_x (x + (float)(x_position + gi->geometry.x_offset) / PANGO_SCALE,
+                                    op.text.scale, &phase);
+            x_position += gi->geometry.width;
+
+            texture_index = gsk_vulkan_renderer_cache_glyph (renderer, (PangoFont *)font, gi->glyph, phase, op.text.scale);
+            if (texture_index == 0)
+              {
+                /* nothing to draw, so it can go with any atlas */
+                count++;
+                continue;
+              }
             if (op.text.texture_index == G_MAXUINT)
               op.text.texture_index = texture_index;
             if (texture_index != op.text.texture_index)
@@ -444,7 +467,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_TEXTURE_CLIP_ROUNDED;
       else
         FALLBACK ("Texture nodes can't deal with clip type %u", constants->clip.type);
@@ -458,7 +482,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_CLIP_ROUNDED;
       else
         FALLBACK ("Color nodes can't deal with clip type %u", constants->clip.type);
@@ -477,7 +502,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_LINEAR_GRADIENT;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_LINEAR_GRADIENT_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_LINEAR_GRADIENT_CLIP_ROUNDED;
       else
         FALLBACK ("Linear gradient nodes can't deal with clip type %u", constants->clip.type);
@@ -491,7 +517,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX_CLIP_ROUNDED;
       else
         FALLBACK ("Opacity nodes can't deal with clip type %u", constants->clip.type);
@@ -505,7 +532,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_BLUR;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_BLUR_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_BLUR_CLIP_ROUNDED;
       else
         FALLBACK ("Blur nodes can't deal with clip type %u", constants->clip.type);
@@ -519,7 +547,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_COLOR_MATRIX_CLIP_ROUNDED;
       else
         FALLBACK ("Color matrix nodes can't deal with clip type %u", constants->clip.type);
@@ -533,7 +562,8 @@ gsk_vulkan_render_pass_add_node (GskVulkanRenderPass           *self,
         pipeline_type = GSK_VULKAN_PIPELINE_BORDER;
       else if (constants->clip.type == GSK_VULKAN_CLIP_RECT)
         pipeline_type = GSK_VULKAN_PIPELINE_BORDER_CLIP;
-      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR)
+      else if (constants->clip.type == GSK_VULKAN_CLIP_ROUNDED_CIRCULAR ||
+               constants->clip.type == GSK_VULKAN_CLIP_ROUNDED)
         pipeline_type = GSK_VULKAN_PIPELINE_BORDER_CLIP_ROUNDED;
       else
         FALLBACK ("Border nodes can't deal with clip type %u", constants->clip.type);
@@ -697,6 +727,7 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
 
     default:
       {
+        GskVulkanRenderer *renderer = GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render));
         VkSemaphore semaphore;
         graphene_rect_t view;
         cairo_region_t *clip;
@@ -717,48 +748,63 @@ gsk_vulkan_render_pass_get_node_as_texture (GskVulkanRenderPass   *self,
         view.size.width = ceil (view.size.width);
         view.size.height = ceil (view.size.height);
 
-        result = gsk_vulkan_image_new_for_texture (self->vulkan,
-                                                   view.size.width,
-                                                   view.size.height);
+        result = gsk_vulkan_renderer_ref_offscreen_image (renderer,
+                                                          render,
+                                                          node,
+                                                          &self->mv,
+                                                          &clipped,
+                                                          self->scale_factor);
+        if (result == NULL)
+          {
+            result = gsk_vulkan_renderer_create_offscreen_image (renderer,
+                                                                 render,
+                                                                 node,
+                                                                 &self->mv,
+                                                                 &clipped,
+                                                                 self->scale_factor,
+                                                                 view.size.width,
+                                                                 view.size.height);
 
 #ifdef G_ENABLE_DEBUG
-        {
-          GskProfiler *profiler = gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render));
-          gsk_profiler_counter_add (profiler,
-                                    self->texture_pixels,
-                                    view.size.width * view.size.height);
-        }
+            {
+              GskProfiler *profiler = gsk_renderer_get_profiler (gsk_vulkan_render_get_renderer (render));
+              gsk_profiler_counter_add (profiler,
+                                        self->texture_pixels,
+                                        view.size.width * view.size.height);
+            }
 #endif
 
-        vkCreateSemaphore (gdk_vulkan_context_get_device (self->vulkan),
-                           &(VkSemaphoreCreateInfo) {
-                             VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-                             NULL,
-                             0
-                           },
-                           NULL,
-                           &semaphore);
-
-        g_array_append_val (self->wait_semaphores, semaphore);
-
-        clip = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
-                                                0, 0,
-                                                gsk_vulkan_image_get_width (result),
-                                                gsk_vulkan_image_get_height (result)
-                                              });
-
-        pass = gsk_vulkan_render_pass_new (self->vulkan,
-                                           result,
-                                           self->scale_factor,
-                                           &self->mv,
-                                           &view,
-                                           clip,
-                                           semaphore);
-
-        cairo_region_destroy (clip);
-
-        gsk_vulkan_render_add_render_pass (render, pass);
-        gsk_vulkan_render_pass_add (pass, render, node);
+            vkCreateSemaphore (gdk_vulkan_context_get_device (self->vulkan),
+                               &(VkSemaphoreCreateInfo) {
+                                 VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                                 NULL,
+                                 0
+                               },
+                               NULL,
+                               &semaphore);
+
+            g_array_append_val (self->wait_semaphores, semaphore);
+
+            clip = cairo_region_create_rectangle (&(cairo_rectangle_int_t) {
+                                                    0, 0,
+                                                    gsk_vulkan_image_get_width (result),
+                                                    gsk_vulkan_image_get_height (result)
+                                                  });
+
+            pass = gsk_vulkan_render_pass_new (self->vulkan,
+                                               result,
+                                               self->scale_factor,
+                                               &self->mv,
+                                               &view,
+                                               clip,
+                                               semaphore);
+
+            cairo_region_destroy (clip);
+
+            gsk_vulkan_render_add_render_pass (render, pass);
+            gsk_vulkan_render_pass_add (pass, render, node);
+          }
+
         gsk_vulkan_render_add_cleanup_image (render, result);
 
         /* assuming the unclipped bounds should go to texture coordinates 0..1,
@@ -911,11 +957,9 @@ gsk_vulkan_render_pass_upload (GskVulkanRenderPass  *self,
             cairo_surface_t *surface;
 
             surface = (cairo_surface_t *)gsk_cairo_node_peek_surface (op->render.node);
-            op->render.source = gsk_vulkan_image_new_from_data (uploader,
-                                                                cairo_image_surface_get_data (surface),
-                                                                cairo_image_surface_get_width (surface),
-                                                                cairo_image_surface_get_height (surface),
-                                                                cairo_image_surface_get_stride (surface));
+            op->render.source = gsk_vulkan_renderer_ref_surface_image (GSK_VULKAN_RENDERER (gsk_vulkan_render_get_renderer (render)),
+                                                                       surface,
+                                                                       uploader);
             op->render.source_rect = GRAPHENE_RECT_INIT(0, 0, 1, 1);
 
             gsk_vulkan_render_add_cleanup_image (render, op->render.source);
@@ -1419,14 +1463,12 @@ gsk_vulkan_render_pass_get_vertex_data (GskVulkanRenderPass *self,
 {
   if (self->vertex_data == NULL)
     {
-      gsize n_bytes;
+      gsize n_bytes, offset;
       guchar *data;
 
       n_bytes = gsk_vulkan_render_pass_count_vertex_data (self);
-      self->vertex_data = gsk_vulkan_buffer_new (self->vulkan, n_bytes);
-      data = gsk_vulkan_buffer_map (self->vertex_data);
-      gsk_vulkan_render_pass_collect_vertex_data (self, render, data, 0, n_bytes);
-      gsk_vulkan_buffer_unmap (self->vertex_data);
+      data = gsk_vulkan_render_reserve_vertex_data (render, n_bytes, &self->vertex_data, &offset);
+      gsk_vulkan_render_pass_collect_vertex_data (self, render, data, offset, offset + n_bytes);
     }
 
   return self->vertex_data;
@@ -1884,6 +1926,17 @@ gsk_vulkan_render_pass_draw_rect (GskVulkanRenderPass     *self,
     }
 }
 
+/* Does the parts of drawing that change the render, so that
+ * gsk_vulkan_render_pass_draw() can run in a thread afterwards.
+ */
+void
+gsk_vulkan_render_pass_prepare_draw (GskVulkanRenderPass *self,
+                                     GskVulkanRender     *render)
+{
+  gsk_vulkan_render_pass_get_vertex_data (self, render);
+  self->framebuffer = gsk_vulkan_render_get_framebuffer (render, self->target);
+}
+
 void
 gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
                              GskVulkanRender         *render,
@@ -1923,7 +1976,7 @@ gsk_vulkan_render_pass_draw (GskVulkanRenderPass     *self,
                             &(VkRenderPassBeginInfo) {
                                 .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
                                 .renderPass = self->render_pass,
-                                .framebuffer = gsk_vulkan_render_get_framebuffer (render, self->target),
+                                .framebuffer = self->framebuffer,
                                 .renderArea = { 
                                     { rect.x * self->scale_factor, rect.y * self->scale_factor },
                                     { rect.width * self->scale_factor, rect.height * self->scale_factor }
@@ -4,6 +4,7 @@
 #include <gdk/gdk.h>
 #include <gsk/gskrendernode.h>
 
+#include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderpassprivate.h"
@@ -59,13 +60,19 @@ void                    gsk_vulkan_render_free                          (GskVulk
 gboolean                gsk_vulkan_render_is_busy                       (GskVulkanRender        *self);
 void                    gsk_vulkan_render_reset                         (GskVulkanRender        *self,
                                                                          GskVulkanImage         *target,
-                                                                         const graphene_rect_t  *rect);
+                                                                         const graphene_rect_t  *rect,
+                                                                         const cairo_region_t   *clip);
 
 GskRenderer *           gsk_vulkan_render_get_renderer                  (GskVulkanRender        *self);
 
 void                    gsk_vulkan_render_add_cleanup_image             (GskVulkanRender        *self,
                                                                          GskVulkanImage         *image);
 
+guchar *                gsk_vulkan_render_reserve_vertex_data           (GskVulkanRender        *self,
+                                                                         gsize                   n_bytes,
+                                                                         GskVulkanBuffer       **buffer,
+                                                                         gsize                  *offset);
+
 void                    gsk_vulkan_render_add_node                      (GskVulkanRender        *self,
                                                                          GskRenderNode          *node);
 
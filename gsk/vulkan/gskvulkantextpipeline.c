@@ -2,6 +2,8 @@
 
 #include "gskvulkantextpipelineprivate.h"
 
+#include <math.h>
+
 struct _GskVulkanTextPipeline
 {
   GObject parent_instance;
@@ -130,10 +132,15 @@ gsk_vulkan_text_pipeline_collect_vertex_data (GskVulkanTextPipeline  *pipeline,
         {
           double cx = (double)(x_position + gi->geometry.x_offset) / PANGO_SCALE;
           double cy = (double)(gi->geometry.y_offset) / PANGO_SCALE;
+          guint phase;
           GskVulkanTextInstance *instance = &instances[count];
-          GskVulkanCachedGlyph *glyph;
+          GskCachedGlyph *glyph;
+
+          /* same as in gsk_vulkan_render_pass_add_node() */
+          cx = gsk_glyph_cache_snap_x (x + cx, scale, &phase) - x;
+          cy = roundf ((y + cy) * scale) / scale - y;
 
-          glyph = gsk_vulkan_renderer_get_cached_glyph (renderer, font, gi->glyph, scale);
+          glyph = gsk_vulkan_renderer_get_cached_glyph (renderer, font, gi->glyph, phase, scale);
 
           instance->tex_rect[0] = glyph->tx;
           instance->tex_rect[1] = glyph->ty;
@@ -35,9 +35,23 @@
 #include "gtkcellaccessibleparent.h"
 #include "gtkcellaccessibleprivate.h"
 
+/* Above this many cells, changes to the rows or columns are only
+ * announced with the AtkTable signals. A children-changed signal for
+ * every cell takes long and floods AT clients with events that tell
+ * them nothing the AtkTable signal didn't.
+ */
+#define MAX_CHILDREN_CHANGED 1000
+
 struct _GtkTreeViewAccessiblePrivate
 {
   GHashTable *cell_infos;
+
+  /* Rows that were added but not announced yet, see
+   * _gtk_tree_view_accessible_add()
+   */
+  guint pending_row;
+  guint pending_n_rows;
+  guint pending_rows_id;
 };
 
 typedef struct _GtkTreeViewAccessibleCellInfo  GtkTreeViewAccessibleCellInfo;
@@ -74,6 +88,7 @@ static gboolean         get_rbtree_column_from_index    (GtkTreeView
 static GtkTreeViewAccessibleCellInfo* find_cell_info    (GtkTreeViewAccessible           *view,
                                                          GtkCellAccessible               *cell);
 static AtkObject *       get_header_from_column         (GtkTreeViewColumn      *tv_col);
+static void             gtk_tree_view_accessible_flush_rows (GtkTreeViewAccessible *accessible);
 
 
 static void atk_table_interface_init                  (AtkTableIface                *iface);
@@ -171,6 +186,9 @@ gtk_tree_view_accessible_finalize (GObject *object)
 {
   GtkTreeViewAccessible *accessible = GTK_TREE_VIEW_ACCESSIBLE (object);
 
+  if (accessible->priv->pending_rows_id != 0)
+    g_source_remove (accessible->priv->pending_rows_id);
+
   if (accessible->priv->cell_infos)
     g_hash_table_destroy (accessible->priv->cell_infos);
 
@@ -225,6 +243,12 @@ gtk_tree_view_accessible_widget_unset (GtkAccessible *gtkaccessible)
 
   g_hash_table_remove_all (accessible->priv->cell_infos);
 
+  if (accessible->priv->pending_rows_id != 0)
+    {
+      g_source_remove (accessible->priv->pending_rows_id);
+      accessible->priv->pending_rows_id = 0;
+    }
+
   GTK_ACCESSIBLE_CLASS (gtk_tree_view_accessible_parent_class)->widget_unset (gtkaccessible);
 }
 
@@ -1414,6 +1438,8 @@ _gtk_tree_view_accessible_reorder (GtkTreeView *treeview)
   if (accessible == NULL)
     return;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   g_signal_emit_by_name (accessible, "row-reordered");
 }
 
@@ -1598,18 +1624,73 @@ get_header_from_column (GtkTreeViewColumn *tv_col)
   return rc;
 }
 
+static void
+emit_rows_inserted (GtkTreeViewAccessible *accessible)
+{
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+  GtkWidget *widget;
+  guint row, n_rows, n_cols, i;
+
+  row = priv->pending_row;
+  n_rows = priv->pending_n_rows;
+
+  g_signal_emit_by_name (accessible, "row-inserted", row, n_rows);
+
+  widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible));
+  if (widget == NULL)
+    return;
+
+  n_cols = get_n_columns (GTK_TREE_VIEW (widget));
+  if (n_cols && (guint64) n_rows * n_cols <= MAX_CHILDREN_CHANGED)
+    {
+      for (i = (row + 1) * n_cols; i < (row + n_rows + 1) * n_cols; i++)
+        {
+         /* Pass NULL as the child object, i.e. 4th argument */
+          g_signal_emit_by_name (accessible, "children-changed::add", i, NULL, NULL);
+        }
+    }
+}
+
+static gboolean
+emit_rows_inserted_cb (gpointer data)
+{
+  GtkTreeViewAccessible *accessible = data;
+
+  accessible->priv->pending_rows_id = 0;
+  emit_rows_inserted (accessible);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Announces the pending rows now, so that the events for a
+ * change that comes after them are emitted in the right order.
+ */
+static void
+gtk_tree_view_accessible_flush_rows (GtkTreeViewAccessible *accessible)
+{
+  if (accessible->priv->pending_rows_id == 0)
+    return;
+
+  g_source_remove (accessible->priv->pending_rows_id);
+  accessible->priv->pending_rows_id = 0;
+  emit_rows_inserted (accessible);
+}
+
 void
 _gtk_tree_view_accessible_add (GtkTreeView *treeview,
                                GtkRBTree   *tree,
                                GtkRBNode   *node)
 {
   GtkTreeViewAccessible *accessible;
-  guint row, n_rows, n_cols, i;
+  GtkTreeViewAccessiblePrivate *priv;
+  guint row, n_rows;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (_gtk_widget_peek_accessible (GTK_WIDGET (treeview)));
   if (accessible == NULL)
     return;
 
+  priv = accessible->priv;
+
   if (node == NULL)
     {
       row = tree->parent_tree ? _gtk_rbtree_node_get_index (tree->parent_tree, tree->parent_node) : 0;
@@ -1621,17 +1702,24 @@ _gtk_tree_view_accessible_add (GtkTreeView *treeview,
       n_rows = 1 + (node->children ? node->children->root->total_count : 0);
     }
 
-  g_signal_emit_by_name (accessible, "row-inserted", row, n_rows);
-
-  n_cols = get_n_columns (treeview);
-  if (n_cols)
+  /* Models are usually filled one row after the other, so rows that
+   * are added next to each other are collected and announced together
+   * from an idle.
+   */
+  if (priv->pending_rows_id != 0 &&
+      row >= priv->pending_row &&
+      row <= priv->pending_row + priv->pending_n_rows)
     {
-      for (i = (row + 1) * n_cols; i < (row + n_rows + 1) * n_cols; i++)
-        {
-         /* Pass NULL as the child object, i.e. 4th argument */
-          g_signal_emit_by_name (accessible, "children-changed::add", i, NULL, NULL);
-        }
+      priv->pending_n_rows += n_rows;
+      return;
     }
+
+  gtk_tree_view_accessible_flush_rows (accessible);
+
+  priv->pending_row = row;
+  priv->pending_n_rows = n_rows;
+  priv->pending_rows_id = g_idle_add (emit_rows_inserted_cb, accessible);
+  g_source_set_name_by_id (priv->pending_rows_id, "[gtk+] emit_rows_inserted_cb");
 }
 
 void
@@ -1648,6 +1736,8 @@ _gtk_tree_view_accessible_remove (GtkTreeView *treeview,
   if (accessible == NULL)
     return;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   /* if this shows up in profiles, special-case node->children == NULL */
 
   if (node == NULL)
@@ -1668,10 +1758,13 @@ _gtk_tree_view_accessible_remove (GtkTreeView *treeview,
   n_cols = get_n_columns (treeview);
   if (n_cols)
     {
-      for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
+      if ((guint64) n_rows * n_cols <= MAX_CHILDREN_CHANGED)
         {
-         /* Pass NULL as the child object, i.e. 4th argument */
-          g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
+          for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
+            {
+             /* Pass NULL as the child object, i.e. 4th argument */
+              g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
+            }
         }
 
       g_hash_table_iter_init (&iter, accessible->priv->cell_infos);
@@ -1693,7 +1786,12 @@ _gtk_tree_view_accessible_changed (GtkTreeView *treeview,
   GtkTreeViewAccessible *accessible;
   guint i;
 
-  accessible = GTK_TREE_VIEW_ACCESSIBLE (gtk_widget_get_accessible (GTK_WIDGET (treeview)));
+  /* Don't create the accessible just to tell it about the change */
+  accessible = GTK_TREE_VIEW_ACCESSIBLE (_gtk_widget_peek_accessible (GTK_WIDGET (treeview)));
+  if (accessible == NULL)
+    return;
+
+  gtk_tree_view_accessible_flush_rows (accessible);
 
   for (i = 0; i < gtk_tree_view_get_n_columns (treeview); i++)
     {
@@ -1741,12 +1839,17 @@ gtk_tree_view_accessible_do_add_column (GtkTreeViewAccessible *accessible,
 {
   guint row, n_rows, n_cols;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   /* Generate column-inserted signal */
   g_signal_emit_by_name (accessible, "column-inserted", id, 1);
 
   n_rows = get_n_rows (treeview);
   n_cols = get_n_columns (treeview);
 
+  if (n_rows >= MAX_CHILDREN_CHANGED)
+    return;
+
   /* Generate children-changed signals */
   for (row = 0; row <= n_rows; row++)
     {
@@ -1787,6 +1890,8 @@ gtk_tree_view_accessible_do_remove_column (GtkTreeViewAccessible *accessible,
   gpointer value;
   guint row, n_rows, n_cols;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   /* Clean column from cache */
   g_hash_table_iter_init (&iter, accessible->priv->cell_infos);
   while (g_hash_table_iter_next (&iter, NULL, &value))
@@ -1802,6 +1907,9 @@ gtk_tree_view_accessible_do_remove_column (GtkTreeViewAccessible *accessible,
   n_rows = get_n_rows (treeview);
   n_cols = get_n_columns (treeview);
 
+  if (n_rows >= MAX_CHILDREN_CHANGED)
+    return;
+
   /* Generate children-changed signals */
   for (row = 0; row <= n_rows; row++)
     {
@@ -1841,6 +1949,8 @@ _gtk_tree_view_accessible_reorder_column (GtkTreeView       *treeview,
   if (obj == NULL)
     return;
 
+  gtk_tree_view_accessible_flush_rows (GTK_TREE_VIEW_ACCESSIBLE (obj));
+
   g_signal_emit_by_name (obj, "column-reordered");
 }
 
@@ -1918,6 +2028,8 @@ _gtk_tree_view_accessible_update_focus_column (GtkTreeView       *treeview,
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   if (!_gtk_tree_view_get_cursor_node (treeview, &cursor_tree, &cursor_node))
     return;
 
@@ -1957,6 +2069,8 @@ _gtk_tree_view_accessible_add_state (GtkTreeView          *treeview,
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   if (state == GTK_CELL_RENDERER_FOCUSED)
     {
       single_column = get_effective_focus_column (treeview, _gtk_tree_view_get_focus_column (treeview));
@@ -2022,6 +2136,8 @@ _gtk_tree_view_accessible_remove_state (GtkTreeView          *treeview,
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   if (state == GTK_CELL_RENDERER_FOCUSED)
     {
       single_column = get_effective_focus_column (treeview, _gtk_tree_view_get_focus_column (treeview));
@@ -2,11 +2,22 @@
 #
 # Generate gtk.gresources.xml
 #
-# Usage: gen-gtk-gresources-xml SRCDIR_GTK [OUTPUT-FILE]
+# Usage: gen-gtk-gresources-xml [--pixdata] SRCDIR_GTK [OUTPUT-FILE]
+#
+# With --pixdata, the PNG assets of the themes are stored as
+# uncompressed GdkPixdata, so that they don't need to be decoded
+# when they are loaded.
 
 import os, sys
 
-srcdir = sys.argv[1]
+args = sys.argv[1:]
+
+theme_image_preprocess = ''
+if args and args[0] == '--pixdata':
+  theme_image_preprocess = ' preprocess=\'to-pixdata\''
+  args = args[1:]
+
+srcdir = args[0]
 
 xml = '''<?xml version='1.0' encoding='UTF-8'?>
 <gresources>
@@ -24,7 +35,7 @@ xml += '''
 '''
 
 for f in get_files('theme/Adwaita/assets', '.png'):
-  xml += '    <file>theme/Adwaita/assets/{0}</file>\n'.format(f)
+  xml += '    <file{0}>theme/Adwaita/assets/{1}</file>\n'.format(theme_image_preprocess, f)
 
 xml += '\n'
 
@@ -39,7 +50,7 @@ xml += '''
 '''
 
 for f in get_files('theme/HighContrast/assets', '.png'):
-  xml += '    <file>theme/HighContrast/assets/{0}</file>\n'.format(f)
+  xml += '    <file{0}>theme/HighContrast/assets/{1}</file>\n'.format(theme_image_preprocess, f)
 
 xml += '\n'
 
@@ -82,8 +93,8 @@ xml += '''
   </gresource>
 </gresources>'''
 
-if len(sys.argv) > 2:
-  outfile = sys.argv[2]
+if len(args) > 1:
+  outfile = args[1]
   f = open(outfile, 'w')
   f.write(xml)
   f.close()
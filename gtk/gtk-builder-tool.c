@@ -716,6 +716,152 @@ do_simplify (int          *argc,
     }
 }
 
+typedef struct {
+  FILE *output;
+  GString *pending_text;
+  gboolean unclosed_starttag;
+  gboolean in_leaf;
+} PrecompileData;
+
+static void
+precompile_flush (PrecompileData *data,
+                  gboolean        keep_blank)
+{
+  const gchar *p;
+  gchar *escaped;
+
+  if (data->unclosed_starttag)
+    {
+      fputc ('>', data->output);
+      data->unclosed_starttag = FALSE;
+    }
+
+  if (data->pending_text->len == 0)
+    return;
+
+  for (p = data->pending_text->str; *p; p++)
+    if (!g_ascii_isspace (*p))
+      break;
+
+  /* Whitespace only matters as the content of an element, not as
+   * the indentation between elements.
+   */
+  if (*p != '\0' || keep_blank)
+    {
+      escaped = g_markup_escape_text (data->pending_text->str, data->pending_text->len);
+      fputs (escaped, data->output);
+      g_free (escaped);
+    }
+
+  g_string_truncate (data->pending_text, 0);
+}
+
+static void
+precompile_start_element (GMarkupParseContext  *context,
+                          const gchar          *element_name,
+                          const gchar         **attribute_names,
+                          const gchar         **attribute_values,
+                          gpointer              user_data,
+                          GError              **error)
+{
+  PrecompileData *data = user_data;
+  gchar *escaped;
+  gint i;
+
+  precompile_flush (data, FALSE);
+
+  g_fprintf (data->output, "<%s", element_name);
+  for (i = 0; attribute_names[i]; i++)
+    {
+      escaped = g_markup_escape_text (attribute_values[i], -1);
+      g_fprintf (data->output, " %s=\"%s\"", attribute_names[i], escaped);
+      g_free (escaped);
+    }
+
+  data->unclosed_starttag = TRUE;
+  data->in_leaf = TRUE;
+}
+
+static void
+precompile_end_element (GMarkupParseContext  *context,
+                        const gchar          *element_name,
+                        gpointer              user_data,
+                        GError              **error)
+{
+  PrecompileData *data = user_data;
+
+  if (data->unclosed_starttag && data->pending_text->len == 0)
+    {
+      fputs ("/>", data->output);
+      data->unclosed_starttag = FALSE;
+    }
+  else
+    {
+      precompile_flush (data, data->in_leaf);
+      g_fprintf (data->output, "</%s>", element_name);
+    }
+
+  data->in_leaf = FALSE;
+}
+
+static void
+precompile_text (GMarkupParseContext  *context,
+                 const gchar          *text,
+                 gsize                 text_len,
+                 gpointer              user_data,
+                 GError              **error)
+{
+  PrecompileData *data = user_data;
+
+  g_string_append_len (data->pending_text, text, text_len);
+}
+
+static const GMarkupParser precompile_parser = {
+  precompile_start_element,
+  precompile_end_element,
+  precompile_text,
+  NULL,
+  NULL
+};
+
+/* Writes the file in the most compact form GtkBuilder still loads
+ * directly: no comments, no indentation and no XML declaration, so
+ * that parsing it does not have to go through any of that at runtime.
+ */
+static void
+do_precompile (const gchar *filename)
+{
+  GMarkupParseContext *context;
+  PrecompileData data;
+  gchar *buffer;
+  GError *error = NULL;
+
+  if (!g_file_get_contents (filename, &buffer, NULL, &error))
+    {
+      g_printerr (_("Can’t load file: %s\n"), error->message);
+      exit (1);
+    }
+
+  data.output = stdout;
+  data.pending_text = g_string_new (NULL);
+  data.unclosed_starttag = FALSE;
+  data.in_leaf = FALSE;
+
+  context = g_markup_parse_context_new (&precompile_parser, G_MARKUP_TREAT_CDATA_AS_TEXT, &data, NULL);
+  if (!g_markup_parse_context_parse (context, buffer, -1, &error) ||
+      !g_markup_parse_context_end_parse (context, &error))
+    {
+      g_printerr (_("Can’t parse file: %s\n"), error->message);
+      exit (1);
+    }
+
+  fputc ('\n', data.output);
+
+  g_markup_parse_context_free (context);
+  g_string_free (data.pending_text, TRUE);
+  g_free (buffer);
+}
+
 static GType
 make_fake_type (const gchar *type_name,
                 const gchar *parent_name)
@@ -1057,6 +1203,7 @@ usage (void)
              "Commands:\n"
              "  validate           Validate the file\n"
              "  simplify [OPTIONS] Simplify the file\n"
+             "  precompile         Write the file in compact form\n"
              "  enumerate          List all named objects\n"
              "  preview [OPTIONS]  Preview the file\n"
              "\n"
@@ -1093,6 +1240,8 @@ main (int argc, const char *argv[])
     do_validate (argv[1]);
   else if (strcmp (argv[0], "simplify") == 0)
     do_simplify (&argc, &argv);
+  else if (strcmp (argv[0], "precompile") == 0)
+    do_precompile (argv[1]);
   else if (strcmp (argv[0], "enumerate") == 0)
     do_enumerate (argv[1]);
   else if (strcmp (argv[0], "preview") == 0)
@@ -0,0 +1,184 @@
+/*  Copyright 2018 Red Hat, Inc.
+ *
+ * GTK+ is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * GLib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GTK+; see the file COPYING.  If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib/gi18n.h>
+#include <glib/gprintf.h>
+#include <gtk/gtk.h>
+#include "gtkcssproviderprivate.h"
+
+static void
+parsing_error_cb (GtkCssProvider *provider,
+                  GtkCssSection  *section,
+                  const GError   *error,
+                  gpointer        user_data)
+{
+  gboolean *failed = user_data;
+  GFile *file;
+  char *path;
+
+  file = gtk_css_section_get_file (section);
+  path = file ? g_file_get_path (file) : NULL;
+
+  g_printerr ("%s:%u:%u: %s\n",
+              path ? path : "<data>",
+              gtk_css_section_get_start_line (section) + 1,
+              gtk_css_section_get_start_position (section),
+              error->message);
+
+  g_free (path);
+
+  *failed = TRUE;
+}
+
+static GtkCssProvider *
+load_file (const char *filename)
+{
+  GtkCssProvider *provider;
+  gboolean failed = FALSE;
+
+  provider = gtk_css_provider_new ();
+  g_signal_connect (provider, "parsing-error", G_CALLBACK (parsing_error_cb), &failed);
+  gtk_css_provider_load_from_path (provider, filename);
+
+  if (failed)
+    exit (1);
+
+  return provider;
+}
+
+static void
+do_validate (const char *filename)
+{
+  GtkCssProvider *provider;
+
+  provider = load_file (filename);
+  g_object_unref (provider);
+}
+
+static void
+do_compile (int          *argc,
+            const char ***argv)
+{
+  GOptionContext *context;
+  char *output = NULL;
+  char **filenames = NULL;
+  const GOptionEntry entries[] = {
+    { "output", 0, 0, G_OPTION_ARG_FILENAME, &output, NULL, NULL },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, NULL },
+    { NULL, }
+  };
+  GtkCssProvider *provider;
+  GError *error = NULL;
+  GString *str;
+  char *css;
+
+  context = g_option_context_new (NULL);
+  g_option_context_set_help_enabled (context, FALSE);
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, argc, (char ***)argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  g_option_context_free (context);
+
+  if (filenames == NULL)
+    {
+      g_printerr ("No .css file specified\n");
+      exit (1);
+    }
+
+  if (g_strv_length (filenames) > 1)
+    {
+      g_printerr ("Can only compile a single .css file\n");
+      exit (1);
+    }
+
+  provider = load_file (filenames[0]);
+
+  css = gtk_css_provider_to_string (provider);
+  str = g_string_new (GTK_CSS_COMPILED_HEADER);
+  g_string_append (str, css);
+  g_free (css);
+
+  if (output)
+    {
+      /* Include the terminating NUL, so the file can be used without copying */
+      if (!g_file_set_contents (output, str->str, str->len + 1, &error))
+        {
+          g_printerr (_("Can’t save file %s: %s\n"), output, error->message);
+          g_error_free (error);
+          exit (1);
+        }
+    }
+  else
+    fwrite (str->str, 1, str->len + 1, stdout);
+
+  g_string_free (str, TRUE);
+  g_object_unref (provider);
+  g_strfreev (filenames);
+  g_free (output);
+}
+
+static void
+usage (void)
+{
+  g_print (_("Usage:\n"
+             "  gtk-css-tool [COMMAND] FILE\n"
+             "\n"
+             "Commands:\n"
+             "  validate           Validate the file\n"
+             "  compile [OPTIONS]  Compile the file\n"
+             "\n"
+             "Compile Options:\n"
+             "  --output=FILE      Write to FILE instead of stdout\n"
+             "\n"
+             "Perform various tasks on GTK+ CSS files.\n"));
+  exit (1);
+}
+
+int
+main (int argc, const char *argv[])
+{
+  g_set_prgname ("gtk-css-tool");
+
+  gtk_init ();
+
+  if (argc < 3)
+    usage ();
+
+  if (strcmp (argv[2], "--help") == 0)
+    usage ();
+
+  argv++;
+  argc--;
+
+  if (strcmp (argv[0], "validate") == 0)
+    do_validate (argv[1]);
+  else if (strcmp (argv[0], "compile") == 0)
+    do_compile (&argc, &argv);
+  else
+    usage ();
+
+  return 0;
+}
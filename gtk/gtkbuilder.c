@@ -163,6 +163,19 @@
  * The possible values for the “type” attribute are described in the
  * sections describing the widget-specific portions of UI definitions.
  *
+ * Widgets that may never be shown, such as the pages of a #GtkStack or
+ * #GtkNotebook, can be created on demand by setting the “lazy” attribute
+ * of their <child> element to a true value. GtkBuilder then adds an empty
+ * placeholder in their place and only builds the child the first time
+ * the placeholder is mapped; packing properties apply to the placeholder.
+ * Until then, gtk_builder_get_object() returns %NULL for the objects of
+ * the child, so they must not be referred to from outside of it. Their
+ * signals are connected the same way as the last call to
+ * gtk_builder_connect_signals() or gtk_builder_connect_signals_full()
+ * connected the other signals. The builder is kept alive as long as
+ * there are placeholders left. Lazy children can not have a “type” or
+ * “internal-child” attribute.
+ *
  * # A GtkBuilder UI Definition
  *
  * |[
@@ -214,6 +227,7 @@
 #include "gtkprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkwindow.h"
+#include "gtkbox.h"
 #include "gtkicontheme.h"
 #include "gtktestutils.h"
 
@@ -250,6 +264,11 @@ struct _GtkBuilderPrivate
   gchar *resource_prefix;
   GType template_type;
   GtkApplication *application;
+
+  /* How signals were last connected, for lazy children */
+  GtkBuilderConnectFunc connect_func;
+  gpointer connect_data;
+  gboolean connect_default;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
@@ -926,6 +945,97 @@ _gtk_builder_add (GtkBuilder *builder,
   child_info->added = TRUE;
 }
 
+typedef struct
+{
+  GtkBuilder *builder;
+  gchar *id;
+  gchar *buffer;
+} LazyChild;
+
+static GQuark quark_lazy_child;
+
+static void
+lazy_child_free (gpointer data)
+{
+  LazyChild *lazy = data;
+
+  g_object_unref (lazy->builder);
+  g_free (lazy->id);
+  g_free (lazy->buffer);
+  g_slice_free (LazyChild, lazy);
+}
+
+static void
+lazy_child_map (GtkWidget *placeholder,
+                gpointer   user_data)
+{
+  LazyChild *lazy = user_data;
+  GtkBuilderPrivate *priv = lazy->builder->priv;
+  GError *error = NULL;
+  GObject *object;
+
+  g_signal_handlers_disconnect_by_func (placeholder, lazy_child_map, lazy);
+
+  GTK_NOTE (BUILDER, g_message ("building lazy child %s", lazy->id));
+
+  if (gtk_builder_add_from_string (lazy->builder, lazy->buffer, -1, &error))
+    {
+      object = gtk_builder_get_object (lazy->builder, lazy->id);
+      if (GTK_IS_WIDGET (object))
+        gtk_container_add (GTK_CONTAINER (placeholder), GTK_WIDGET (object));
+      else
+        g_warning ("Lazy child %s is not a widget", lazy->id);
+
+      if (priv->connect_default)
+        gtk_builder_connect_signals (lazy->builder, priv->connect_data);
+      else if (priv->connect_func)
+        gtk_builder_connect_signals_full (lazy->builder, priv->connect_func, priv->connect_data);
+    }
+  else
+    {
+      g_warning ("Failed to build lazy child %s: %s", lazy->id, error->message);
+      g_error_free (error);
+    }
+
+  g_object_set_qdata (G_OBJECT (placeholder), quark_lazy_child, NULL);
+}
+
+/*< private >
+ * _gtk_builder_create_lazy_child:
+ * @builder: a #GtkBuilder
+ * @id: the id of the object described by @buffer
+ * @buffer: (transfer full): a UI definition containing just that object
+ *
+ * Creates the placeholder for a child with the “lazy” attribute.
+ *
+ * Returns: a new floating #GtkWidget that builds the child when mapped
+ */
+GObject *
+_gtk_builder_create_lazy_child (GtkBuilder  *builder,
+                                const gchar *id,
+                                gchar       *buffer)
+{
+  GtkWidget *placeholder;
+  LazyChild *lazy;
+
+  if (quark_lazy_child == 0)
+    quark_lazy_child = g_quark_from_static_string ("gtk-builder-lazy-child");
+
+  lazy = g_slice_new (LazyChild);
+  lazy->builder = g_object_ref (builder);
+  lazy->id = g_strdup (id);
+  lazy->buffer = buffer;
+
+  /* Homogeneous, so the child gets all of the space */
+  placeholder = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  gtk_box_set_homogeneous (GTK_BOX (placeholder), TRUE);
+
+  g_object_set_qdata_full (G_OBJECT (placeholder), quark_lazy_child, lazy, lazy_child_free);
+  g_signal_connect (placeholder, "map", G_CALLBACK (lazy_child_map), lazy);
+
+  return G_OBJECT (placeholder);
+}
+
 void
 _gtk_builder_add_signals (GtkBuilder *builder,
                           GSList     *signals)
@@ -1695,6 +1805,10 @@ gtk_builder_connect_signals (GtkBuilder *builder,
 
   args.data = user_data;
 
+  builder->priv->connect_default = TRUE;
+  builder->priv->connect_func = NULL;
+  builder->priv->connect_data = user_data;
+
   if (g_module_supported ())
     args.module = g_module_open (NULL, G_MODULE_BIND_LAZY);
   else
@@ -1752,6 +1866,13 @@ gtk_builder_connect_signals_full (GtkBuilder            *builder,
   g_return_if_fail (GTK_IS_BUILDER (builder));
   g_return_if_fail (func != NULL);
 
+  if (func != gtk_builder_connect_signals_default)
+    {
+      builder->priv->connect_default = FALSE;
+      builder->priv->connect_func = func;
+      builder->priv->connect_data = user_data;
+    }
+
   if (!builder->priv->signals)
     return;
 
@@ -505,6 +505,7 @@ parse_child (ParserData   *data,
   ChildInfo *child_info;
   const gchar *type = NULL;
   const gchar *internal_child = NULL;
+  gboolean lazy = FALSE;
 
   object_info = state_peek_info (data, ObjectInfo);
   if (!object_info ||
@@ -518,16 +519,32 @@ parse_child (ParserData   *data,
   if (!g_markup_collect_attributes (element_name, names, values, error,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type", &type,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "internal-child", &internal_child,
+                                    G_MARKUP_COLLECT_BOOLEAN|G_MARKUP_COLLECT_OPTIONAL, "lazy", &lazy,
                                     G_MARKUP_COLLECT_INVALID))
     {
       _gtk_builder_prefix_error (data->builder, data->ctx, error);
       return;
     }
 
+  if (lazy && (type || internal_child))
+    {
+      gint line, col;
+
+      g_markup_parse_context_get_position (data->ctx, &line, &col);
+      g_set_error (error,
+                   GTK_BUILDER_ERROR,
+                   GTK_BUILDER_ERROR_INVALID_ATTRIBUTE,
+                   "%s:%d:%d Lazy children can not have a type or be internal children",
+                   data->filename, line, col);
+      return;
+    }
+
   child_info = g_slice_new0 (ChildInfo);
   child_info->tag_type = TAG_CHILD;
   child_info->type = g_strdup (type);
   child_info->internal_child = g_strdup (internal_child);
+  /* Only postpone what would be built anyway */
+  child_info->lazy = lazy && data->requested_objects == NULL;
   child_info->parent = (CommonInfo*)object_info;
   state_push (data, child_info);
 
@@ -927,6 +944,76 @@ parse_custom (GMarkupParseContext  *context,
   return TRUE;
 }
 
+static void
+lazy_append_start_element (ParserData   *data,
+                           const gchar  *element_name,
+                           const gchar **names,
+                           const gchar **values)
+{
+  gint i;
+
+  g_string_append_printf (data->lazy_markup, "<%s", element_name);
+  for (i = 0; names[i]; i++)
+    {
+      gchar *escaped = g_markup_escape_text (values[i], -1);
+      g_string_append_printf (data->lazy_markup, " %s=\"%s\"", names[i], escaped);
+      g_free (escaped);
+    }
+  g_string_append_c (data->lazy_markup, '>');
+}
+
+static void
+lazy_start (ParserData   *data,
+            const gchar  *element_name,
+            const gchar **names,
+            const gchar **values)
+{
+  const gchar *id = NULL;
+  gint i;
+
+  for (i = 0; names[i]; i++)
+    if (strcmp (names[i], "id") == 0)
+      id = values[i];
+
+  data->lazy_markup = g_string_new (NULL);
+  data->lazy_level = 0;
+
+  if (data->domain)
+    {
+      gchar *escaped = g_markup_escape_text (data->domain, -1);
+      g_string_append_printf (data->lazy_markup, "<interface domain=\"%s\">", escaped);
+      g_free (escaped);
+    }
+  else
+    g_string_append (data->lazy_markup, "<interface>");
+
+  lazy_append_start_element (data, element_name, names, values);
+
+  if (id)
+    data->lazy_id = g_strdup (id);
+  else
+    {
+      /* The object needs an id to be found once it is built */
+      data->lazy_id = g_strdup_printf ("___lazy_child_%d___", ++data->object_counter);
+      g_string_truncate (data->lazy_markup, data->lazy_markup->len - 1);
+      g_string_append_printf (data->lazy_markup, " id=\"%s\">", data->lazy_id);
+    }
+}
+
+static void
+lazy_end (ParserData *data)
+{
+  ChildInfo *child_info = state_peek_info (data, ChildInfo);
+
+  g_string_append (data->lazy_markup, "</interface>");
+
+  child_info->object = _gtk_builder_create_lazy_child (data->builder,
+                                                       data->lazy_id,
+                                                       g_string_free (data->lazy_markup, FALSE));
+  data->lazy_markup = NULL;
+  g_clear_pointer (&data->lazy_id, g_free);
+}
+
 static void
 start_element (GMarkupParseContext  *context,
                const gchar          *element_name,
@@ -962,6 +1049,13 @@ start_element (GMarkupParseContext  *context,
     }
   data->last_element = element_name;
 
+  if (data->lazy_markup)
+    {
+      lazy_append_start_element (data, element_name, names, values);
+      data->lazy_level++;
+      return;
+    }
+
   if (data->subparser)
     {
       if (!subparser_start (context, element_name, names, values, data, error))
@@ -969,7 +1063,15 @@ start_element (GMarkupParseContext  *context,
     }
 
   if (strcmp (element_name, "object") == 0)
-    parse_object (context, data, element_name, names, values, error);
+    {
+      ChildInfo *child_info = state_peek_info (data, ChildInfo);
+
+      if (child_info && child_info->tag_type == TAG_CHILD &&
+          child_info->lazy && child_info->object == NULL)
+        lazy_start (data, element_name, names, values);
+      else
+        parse_object (context, data, element_name, names, values, error);
+    }
   else if (data->requested_objects && !data->inside_requested_object)
     {
       /* If outside a requested object, simply ignore this tag */
@@ -1023,6 +1125,14 @@ end_element (GMarkupParseContext  *context,
 
   GTK_NOTE (BUILDER, g_message ("</%s>", element_name));
 
+  if (data->lazy_markup)
+    {
+      g_string_append_printf (data->lazy_markup, "</%s>", element_name);
+      if (data->lazy_level-- == 0)
+        lazy_end (data);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       subparser_end (context, element_name, data, error);
@@ -1169,6 +1279,14 @@ text (GMarkupParseContext  *context,
   ParserData *data = (ParserData*)user_data;
   CommonInfo *info;
 
+  if (data->lazy_markup)
+    {
+      gchar *escaped = g_markup_escape_text (text, text_len);
+      g_string_append (data->lazy_markup, escaped);
+      g_free (escaped);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       GError *tmp_error = NULL;
@@ -1308,6 +1426,9 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_free_full (data.custom_finalizers, (GDestroyNotify)free_subparser);
   g_slist_free (data.finalizers);
   g_free (data.domain);
+  if (data.lazy_markup)
+    g_string_free (data.lazy_markup, TRUE);
+  g_free (data.lazy_id);
   g_hash_table_destroy (data.object_ids);
   g_markup_parse_context_free (data.ctx);
 
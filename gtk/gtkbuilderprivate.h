@@ -47,6 +47,7 @@ typedef struct {
   gchar *type;
   gchar *internal_child;
   gboolean added;
+  gboolean lazy;
 } ChildInfo;
 
 typedef struct {
@@ -116,6 +117,11 @@ typedef struct {
   gint object_counter;
 
   GHashTable *object_ids;
+
+  /* The markup of a lazy child that is being collected */
+  GString *lazy_markup;
+  gchar *lazy_id;
+  gint lazy_level;
 } ParserData;
 
 typedef GType (*GTypeGetFunc) (void);
@@ -138,6 +144,9 @@ void      _gtk_builder_add_object (GtkBuilder  *builder,
                                    GObject     *object);
 void      _gtk_builder_add (GtkBuilder *builder,
                             ChildInfo *child_info);
+GObject * _gtk_builder_create_lazy_child (GtkBuilder  *builder,
+                                          const gchar *id,
+                                          gchar       *buffer);
 void      _gtk_builder_add_signals (GtkBuilder *builder,
 				    GSList     *signals);
 void      _gtk_builder_finish (GtkBuilder *builder);
@@ -51,6 +51,7 @@
 #include "gtkcelllayout.h"
 #include "gtkcellareabox.h"
 #include "gtkcellareaboxcontextprivate.h"
+#include "gtkcellrendererprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
 
@@ -145,6 +146,7 @@ static void      gtk_cell_area_box_focus_changed                  (GtkCellArea
 /* CellInfo/CellGroup metadata handling and convenience functions */
 typedef struct {
   GtkCellRenderer *renderer;
+  gulong           notify_id;
 
   guint            expand : 1; /* Whether the cell expands */
   guint            pack   : 1; /* Whether it is packed from the start or end */
@@ -195,6 +197,8 @@ static GSList        *get_allocated_cells    (GtkCellAreaBox        *box,
                                               GtkWidget             *widget,
                                               gint                   width,
                                               gint                   height);
+static void           forget_renderer_size   (GtkCellAreaBox        *box,
+                                              GtkCellRenderer       *renderer);
 
 
 struct _GtkCellAreaBoxPrivate
@@ -398,6 +402,7 @@ cell_info_new  (GtkCellRenderer *renderer,
   CellInfo *info = g_slice_new (CellInfo);
 
   info->renderer = g_object_ref_sink (renderer);
+  info->notify_id = 0;
   info->pack     = pack;
   info->expand   = expand;
   info->align    = align;
@@ -409,6 +414,8 @@ cell_info_new  (GtkCellRenderer *renderer,
 static void
 cell_info_free (CellInfo *info)
 {
+  if (info->notify_id)
+    g_signal_handler_disconnect (info->renderer, info->notify_id);
   g_object_unref (info->renderer);
 
   g_slice_free (CellInfo, info);
@@ -1118,6 +1125,7 @@ gtk_cell_area_box_remove (GtkCellArea        *area,
     {
       CellInfo *info = node->data;
 
+      forget_renderer_size (box, renderer);
       cell_info_free (info);
 
       priv->cells = g_list_delete_link (priv->cells, node);
@@ -1492,6 +1500,54 @@ gtk_cell_area_box_get_request_mode (GtkCellArea *area)
     GTK_SIZE_REQUEST_WIDTH_FOR_HEIGHT;
 }
 
+static void
+forget_renderer_size (GtkCellAreaBox  *box,
+                      GtkCellRenderer *renderer)
+{
+  GtkCellAreaBoxPrivate *priv = box->priv;
+  GSList                *l;
+
+  for (l = priv->contexts; l; l = l->next)
+    _gtk_cell_area_box_context_forget_renderer (l->data, renderer);
+}
+
+static void
+cell_notify (GtkCellRenderer *renderer,
+             GParamSpec      *pspec,
+             GtkCellAreaBox  *box)
+{
+  if (_gtk_cell_renderer_property_affects_size (renderer, pspec))
+    forget_renderer_size (box, renderer);
+}
+
+/* Like gtk_cell_area_request_renderer(), but reuses the size of
+ * renderers whose size did not change since the last request. Many
+ * renderers, like toggles, only get size neutral properties applied
+ * from the model, so they are measured once instead of for every row.
+ */
+static void
+request_renderer (GtkCellAreaBox        *box,
+                  GtkCellAreaBoxContext *context,
+                  GtkCellRenderer       *renderer,
+                  GtkOrientation         orientation,
+                  GtkWidget             *widget,
+                  gint                   for_size,
+                  gint                  *minimum_size,
+                  gint                  *natural_size)
+{
+  if (for_size < 0 &&
+      _gtk_cell_area_box_context_get_renderer_size (context, renderer, orientation,
+                                                    minimum_size, natural_size))
+    return;
+
+  gtk_cell_area_request_renderer (GTK_CELL_AREA (box), renderer, orientation, widget, for_size,
+                                  minimum_size, natural_size);
+
+  if (for_size < 0)
+    _gtk_cell_area_box_context_set_renderer_size (context, renderer, orientation,
+                                                  *minimum_size, *natural_size);
+}
+
 static void
 compute_size (GtkCellAreaBox        *box,
               GtkOrientation         orientation,
@@ -1502,7 +1558,6 @@ compute_size (GtkCellAreaBox        *box,
               gint                  *natural_size)
 {
   GtkCellAreaBoxPrivate *priv = box->priv;
-  GtkCellArea           *area = GTK_CELL_AREA (box);
   GList                 *list;
   gint                   i;
   gint                   min_size = 0;
@@ -1522,8 +1577,8 @@ compute_size (GtkCellAreaBox        *box,
           if (!gtk_cell_renderer_get_visible (info->renderer))
               continue;
 
-          gtk_cell_area_request_renderer (area, info->renderer, orientation, widget, for_size,
-                                          &renderer_min_size, &renderer_nat_size);
+          request_renderer (box, context, info->renderer, orientation, widget, for_size,
+                            &renderer_min_size, &renderer_nat_size);
 
           if (orientation == priv->orientation)
             {
@@ -2167,6 +2222,7 @@ gtk_cell_area_box_pack_start  (GtkCellAreaBox  *box,
     }
 
   info = cell_info_new (renderer, GTK_PACK_START, expand, align, fixed);
+  info->notify_id = g_signal_connect (renderer, "notify", G_CALLBACK (cell_notify), box);
 
   priv->cells = g_list_append (priv->cells, info);
 
@@ -2212,6 +2268,7 @@ gtk_cell_area_box_pack_end (GtkCellAreaBox  *box,
     }
 
   info = cell_info_new (renderer, GTK_PACK_END, expand, align, fixed);
+  info->notify_id = g_signal_connect (renderer, "notify", G_CALLBACK (cell_notify), box);
 
   priv->cells = g_list_append (priv->cells, info);
 
@@ -63,6 +63,12 @@ typedef struct {
   gint     nat_size;
 } CachedSize;
 
+/* The size of a single renderer, indexed by GtkOrientation */
+typedef struct {
+  CachedSize size[2];
+  gboolean   valid[2];
+} RendererSize;
+
 struct _GtkCellAreaBoxContextPrivate
 {
   /* Table of per renderer CachedSizes */
@@ -78,6 +84,11 @@ struct _GtkCellAreaBoxContextPrivate
 
   /* Whether each group is aligned */
   gboolean  *align;
+
+  /* Per renderer RendererSizes, for renderers whose size is the
+   * same for all rows (see _gtk_cell_area_box_context_get_renderer_size())
+   */
+  GHashTable *renderer_sizes;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCellAreaBoxContext, _gtk_cell_area_box_context, GTK_TYPE_CELL_AREA_CONTEXT)
@@ -177,6 +188,9 @@ _gtk_cell_area_box_context_init (GtkCellAreaBoxContext *box_context)
                                               NULL, (GDestroyNotify)free_cache_array);
   priv->heights      = g_hash_table_new_full (g_direct_hash, g_direct_equal,
                                               NULL, (GDestroyNotify)free_cache_array);
+
+  priv->renderer_sizes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                g_object_unref, g_free);
 }
 
 static void 
@@ -206,6 +220,7 @@ _gtk_cell_area_box_context_finalize (GObject *object)
   g_array_free (priv->base_heights, TRUE);
   g_hash_table_destroy (priv->widths);
   g_hash_table_destroy (priv->heights);
+  g_hash_table_destroy (priv->renderer_sizes);
 
   g_free (priv->expand);
   g_free (priv->align);
@@ -240,6 +255,7 @@ _gtk_cell_area_box_context_reset (GtkCellAreaContext *context)
   /* Reset context sizes as well */
   g_hash_table_remove_all (priv->widths);
   g_hash_table_remove_all (priv->heights);
+  g_hash_table_remove_all (priv->renderer_sizes);
 
   GTK_CELL_AREA_CONTEXT_CLASS
     (_gtk_cell_area_box_context_parent_class)->reset (context);
@@ -823,6 +839,69 @@ _gtk_cell_area_box_context_get_heights (GtkCellAreaBoxContext *box_context,
   return _gtk_cell_area_box_context_get_requests (box_context, area, GTK_ORIENTATION_VERTICAL, -1, n_heights);
 }
 
+/* The size of a renderer only gets recorded here while only its size
+ * neutral properties change (see _gtk_cell_renderer_property_affects_size()),
+ * GtkCellAreaBox forgets it as soon as anything else changes.
+ */
+gboolean
+_gtk_cell_area_box_context_get_renderer_size (GtkCellAreaBoxContext *box_context,
+                                              GtkCellRenderer       *renderer,
+                                              GtkOrientation         orientation,
+                                              gint                  *minimum_size,
+                                              gint                  *natural_size)
+{
+  GtkCellAreaBoxContextPrivate *priv;
+  RendererSize                 *size;
+
+  g_return_val_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (box_context), FALSE);
+
+  priv = box_context->priv;
+  size = g_hash_table_lookup (priv->renderer_sizes, renderer);
+
+  if (size == NULL || !size->valid[orientation])
+    return FALSE;
+
+  *minimum_size = size->size[orientation].min_size;
+  *natural_size = size->size[orientation].nat_size;
+
+  return TRUE;
+}
+
+void
+_gtk_cell_area_box_context_set_renderer_size (GtkCellAreaBoxContext *box_context,
+                                              GtkCellRenderer       *renderer,
+                                              GtkOrientation         orientation,
+                                              gint                   minimum_size,
+                                              gint                   natural_size)
+{
+  GtkCellAreaBoxContextPrivate *priv;
+  RendererSize                 *size;
+
+  g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (box_context));
+
+  priv = box_context->priv;
+  size = g_hash_table_lookup (priv->renderer_sizes, renderer);
+
+  if (size == NULL)
+    {
+      size = g_new0 (RendererSize, 1);
+      g_hash_table_insert (priv->renderer_sizes, g_object_ref (renderer), size);
+    }
+
+  size->size[orientation].min_size = minimum_size;
+  size->size[orientation].nat_size = natural_size;
+  size->valid[orientation] = TRUE;
+}
+
+void
+_gtk_cell_area_box_context_forget_renderer (GtkCellAreaBoxContext *box_context,
+                                            GtkCellRenderer       *renderer)
+{
+  g_return_if_fail (GTK_IS_CELL_AREA_BOX_CONTEXT (box_context));
+
+  g_hash_table_remove (box_context->priv->renderer_sizes, renderer);
+}
+
 GtkCellAreaBoxAllocation *
 _gtk_cell_area_box_context_get_orientation_allocs (GtkCellAreaBoxContext *context,
                                                   gint                  *n_allocs)
@@ -121,6 +121,20 @@ GtkRequestedSize *_gtk_cell_area_box_context_get_widths         (GtkCellAreaBoxC
 GtkRequestedSize *_gtk_cell_area_box_context_get_heights        (GtkCellAreaBoxContext *box_context,
                                                                 gint                  *n_heights);
 
+/* Sizes of renderers that are the same for all rows */
+gboolean _gtk_cell_area_box_context_get_renderer_size           (GtkCellAreaBoxContext *box_context,
+                                                                GtkCellRenderer       *renderer,
+                                                                GtkOrientation         orientation,
+                                                                gint                  *minimum_size,
+                                                                gint                  *natural_size);
+void    _gtk_cell_area_box_context_set_renderer_size            (GtkCellAreaBoxContext *box_context,
+                                                                GtkCellRenderer       *renderer,
+                                                                GtkOrientation         orientation,
+                                                                gint                   minimum_size,
+                                                                gint                   natural_size);
+void    _gtk_cell_area_box_context_forget_renderer              (GtkCellAreaBoxContext *box_context,
+                                                                GtkCellRenderer       *renderer);
+
 /* Private context/area interaction */
 typedef struct {
   gint group_idx; /* Groups containing only invisible cells are not allocated */
@@ -17,6 +17,7 @@
 
 #include "config.h"
 #include "gtkcellrenderer.h"
+#include "gtkcellrendererprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 #include "gtktypebuiltins.h"
@@ -137,6 +138,8 @@ struct _GtkCellRendererClassPrivate
   GType accessible_type;
 };
 
+static GQuark quark_size_neutral;
+
 enum {
   PROP_0,
   PROP_MODE,
@@ -421,6 +424,19 @@ gtk_cell_renderer_class_init (GtkCellRendererClass *class)
     g_type_class_adjust_private_offset (class, &GtkCellRenderer_private_offset);
 
   gtk_cell_renderer_class_set_accessible_type (class, GTK_TYPE_RENDERER_CELL_ACCESSIBLE);
+
+  quark_size_neutral = g_quark_from_static_string ("gtk-cell-renderer-size-neutral");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "mode");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "visible");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "sensitive");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "xalign");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "yalign");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "is-expander");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "is-expanded");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "cell-background");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "cell-background-rgba");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "cell-background-set");
+  _gtk_cell_renderer_class_set_size_neutral_property (class, "editing");
 }
 
 static void
@@ -1786,3 +1802,53 @@ _gtk_cell_renderer_get_accessible_type (GtkCellRenderer *renderer)
   return GTK_CELL_RENDERER_GET_CLASS (renderer)->priv->accessible_type;
 }
 
+/*
+ * _gtk_cell_renderer_class_set_size_neutral_property:
+ * @renderer_class: a #GtkCellRendererClass
+ * @property_name: the name of a property of @renderer_class
+ *
+ * Declares that the value of the property does not change the size
+ * that is requested by renderers of @renderer_class, like the state
+ * of a toggle or a color. Cell areas can reuse the size of a renderer
+ * across rows for as long as only such properties change.
+ *
+ * This applies to subclasses as well, so it should only be used for
+ * properties whose value the renderer does not use for its size.
+ */
+void
+_gtk_cell_renderer_class_set_size_neutral_property (GtkCellRendererClass *renderer_class,
+                                                    const gchar          *property_name)
+{
+  GParamSpec *pspec;
+
+  pspec = g_object_class_find_property (G_OBJECT_CLASS (renderer_class), property_name);
+  g_return_if_fail (pspec != NULL);
+
+  g_param_spec_set_qdata (pspec, quark_size_neutral, GINT_TO_POINTER (TRUE));
+}
+
+/*
+ * _gtk_cell_renderer_property_affects_size:
+ * @cell: a #GtkCellRenderer
+ * @pspec: a property of @cell that changed
+ *
+ * Returns: %TRUE if the size requested by @cell may have changed
+ *     because of the change of @pspec
+ */
+gboolean
+_gtk_cell_renderer_property_affects_size (GtkCellRenderer *cell,
+                                          GParamSpec      *pspec)
+{
+  GtkCellRendererPrivate *priv = cell->priv;
+
+  if (g_param_spec_get_qdata (pspec, quark_size_neutral))
+    return FALSE;
+
+  /* The size of a cell with a fixed size is that fixed size */
+  if (priv->width >= 0 && priv->height >= 0)
+    return pspec->owner_type == GTK_TYPE_CELL_RENDERER &&
+           (g_str_equal (pspec->name, "width") || g_str_equal (pspec->name, "height"));
+
+  return TRUE;
+}
+
@@ -0,0 +1,34 @@
+/* gtkcellrendererprivate.h
+ * Copyright (C) 2000  Red Hat, Inc.,  Jonathan Blandford <jrb@redhat.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CELL_RENDERER_PRIVATE_H__
+#define __GTK_CELL_RENDERER_PRIVATE_H__
+
+#include "gtkcellrenderer.h"
+
+G_BEGIN_DECLS
+
+void            _gtk_cell_renderer_class_set_size_neutral_property
+                                                  (GtkCellRendererClass *renderer_class,
+                                                   const gchar          *property_name);
+gboolean        _gtk_cell_renderer_property_affects_size
+                                                  (GtkCellRenderer      *cell,
+                                                   GParamSpec           *pspec);
+
+G_END_DECLS
+
+#endif /* __GTK_CELL_RENDERER_PRIVATE_H__ */
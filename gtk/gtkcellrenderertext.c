@@ -18,8 +18,10 @@
 #include "config.h"
 
 #include "gtkcellrenderertext.h"
+#include "gtkcellrendererprivate.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gtkeditable.h"
 #include "gtkentry.h"
@@ -158,6 +160,8 @@ static GParamSpec *text_cell_renderer_props [LAST_PROP];
 
 #define GTK_CELL_RENDERER_TEXT_PATH "gtk-cell-renderer-text-path"
 
+typedef struct _LayoutCacheEntry LayoutCacheEntry;
+
 struct _GtkCellRendererTextPrivate
 {
   GtkWidget *entry;
@@ -203,6 +207,9 @@ struct _GtkCellRendererTextPrivate
   gulong focus_out_id;
   gulong populate_popup_id;
   gulong entry_menu_popdown_timeout;
+
+  LayoutCacheEntry *layout_cache;
+  guint layout_cache_next;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCellRendererText, gtk_cell_renderer_text, GTK_TYPE_CELL_RENDERER)
@@ -657,8 +664,19 @@ gtk_cell_renderer_text_class_init (GtkCellRendererTextClass *class)
 		  G_TYPE_STRING);
 
   gtk_cell_renderer_class_set_accessible_type (cell_class, GTK_TYPE_TEXT_CELL_ACCESSIBLE);
+
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "background");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "background-rgba");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "background-set");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "foreground");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "foreground-rgba");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "foreground-set");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "editable");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "editable-set");
 }
 
+static void gtk_cell_renderer_text_clear_layout_cache (GtkCellRendererText *celltext);
+
 static void
 gtk_cell_renderer_text_finalize (GObject *object)
 {
@@ -678,6 +696,8 @@ gtk_cell_renderer_text_finalize (GObject *object)
 
   g_clear_object (&priv->entry);
 
+  gtk_cell_renderer_text_clear_layout_cache (celltext);
+
   G_OBJECT_CLASS (gtk_cell_renderer_text_parent_class)->finalize (object);
 }
 
@@ -1716,6 +1736,201 @@ get_size (GtkCellRenderer    *cell,
   g_object_unref (layout);
 }
 
+/* Layouts that were drawn recently, so that redrawing cells with the
+ * same contents, like when scrolling or when the pointer moves over
+ * a tree view, doesn't have to shape the text again.
+ */
+#define LAYOUT_CACHE_SIZE 64
+
+typedef struct
+{
+  /* Compared with memcmp(), so keys must be cleared before they are
+   * filled in.
+   */
+  PangoContext         *context;
+  guint                 context_serial;
+  PangoAttrList        *extra_attrs;
+  PangoLanguage        *language;
+  GdkRGBA               foreground;
+  gdouble               font_scale;
+  PangoUnderline        underline_style;
+  PangoEllipsizeMode    ellipsize;
+  PangoWrapMode         wrap_mode;
+  PangoAlignment        align;
+  GtkTextDirection      direction;
+  GtkCellRendererState  flags;
+  gint                  rise;
+  gint                  wrap_width;
+  gint                  width;
+  gint                  height;
+  gint                  xpad;
+  gint                  ypad;
+  gfloat                xalign;
+  gfloat                yalign;
+  guint                 bits;
+} LayoutKey;
+
+struct _LayoutCacheEntry
+{
+  LayoutKey             key;
+  guint                 hash;
+  gchar                *text;
+  PangoFontDescription *font;
+  PangoLayout          *layout;
+  gint                  x_offset;
+  gint                  y_offset;
+};
+
+static void
+layout_cache_entry_clear (LayoutCacheEntry *entry)
+{
+  g_clear_object (&entry->layout);
+  g_clear_object (&entry->key.context);
+  g_clear_pointer (&entry->key.extra_attrs, pango_attr_list_unref);
+  g_clear_pointer (&entry->font, pango_font_description_free);
+  g_clear_pointer (&entry->text, g_free);
+}
+
+static void
+gtk_cell_renderer_text_clear_layout_cache (GtkCellRendererText *celltext)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  guint i;
+
+  if (priv->layout_cache == NULL)
+    return;
+
+  for (i = 0; i < LAYOUT_CACHE_SIZE; i++)
+    layout_cache_entry_clear (&priv->layout_cache[i]);
+
+  g_clear_pointer (&priv->layout_cache, g_free);
+}
+
+/* Fills in the key for drawing the text of @celltext into @cell_area.
+ * Returns %FALSE if the result can't be cached.
+ */
+static gboolean
+layout_key_init (LayoutKey            *key,
+                 GtkCellRendererText  *celltext,
+                 GtkWidget            *widget,
+                 const GdkRectangle   *cell_area,
+                 GtkCellRendererState  flags)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  GtkCellRenderer *cell = GTK_CELL_RENDERER (celltext);
+
+  /* The placeholder color comes from the theme, and computing the
+   * fixed height makes get_size() skip the offsets.
+   */
+  if (show_placeholder_text (celltext) || priv->calc_fixed_height)
+    return FALSE;
+
+  memset (key, 0, sizeof (LayoutKey));
+
+  key->context = gtk_widget_get_pango_context (widget);
+  key->context_serial = pango_context_get_serial (key->context);
+  key->extra_attrs = priv->extra_attrs;
+  key->language = priv->language;
+  key->foreground = priv->foreground;
+  key->font_scale = priv->font_scale;
+  key->underline_style = priv->underline_style;
+  key->ellipsize = priv->ellipsize;
+  key->wrap_mode = priv->wrap_mode;
+  key->align = priv->align;
+  key->direction = gtk_widget_get_direction (widget);
+  key->flags = flags & (GTK_CELL_RENDERER_SELECTED | GTK_CELL_RENDERER_PRELIT);
+  key->rise = priv->rise;
+  key->wrap_width = priv->wrap_width;
+  key->width = cell_area->width;
+  key->height = cell_area->height;
+  gtk_cell_renderer_get_padding (cell, &key->xpad, &key->ypad);
+  gtk_cell_renderer_get_alignment (cell, &key->xalign, &key->yalign);
+  key->bits = priv->strikethrough
+              | priv->scale_set << 1
+              | priv->foreground_set << 2
+              | priv->underline_set << 3
+              | priv->rise_set << 4
+              | priv->strikethrough_set << 5
+              | priv->single_paragraph << 6
+              | priv->language_set << 7
+              | priv->ellipsize_set << 8
+              | priv->align_set << 9;
+
+  return TRUE;
+}
+
+static guint
+layout_key_hash (const LayoutKey *key,
+                 const gchar     *text)
+{
+  const guchar *p = (const guchar *) key;
+  guint hash = g_str_hash (text ? text : "");
+  gsize i;
+
+  for (i = 0; i < sizeof (LayoutKey); i++)
+    hash = (hash * 33) + p[i];
+
+  return hash;
+}
+
+static LayoutCacheEntry *
+gtk_cell_renderer_text_lookup_layout (GtkCellRendererText *celltext,
+                                      const LayoutKey     *key,
+                                      guint                hash)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  guint i;
+
+  if (priv->layout_cache == NULL)
+    return NULL;
+
+  for (i = 0; i < LAYOUT_CACHE_SIZE; i++)
+    {
+      LayoutCacheEntry *entry = &priv->layout_cache[i];
+
+      if (entry->layout != NULL &&
+          entry->hash == hash &&
+          memcmp (&entry->key, key, sizeof (LayoutKey)) == 0 &&
+          g_strcmp0 (entry->text, priv->text) == 0 &&
+          pango_font_description_equal (entry->font, priv->font))
+        return entry;
+    }
+
+  return NULL;
+}
+
+static void
+gtk_cell_renderer_text_store_layout (GtkCellRendererText *celltext,
+                                     const LayoutKey     *key,
+                                     guint                hash,
+                                     PangoLayout         *layout,
+                                     gint                 x_offset,
+                                     gint                 y_offset)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  LayoutCacheEntry *entry;
+
+  if (priv->layout_cache == NULL)
+    priv->layout_cache = g_new0 (LayoutCacheEntry, LAYOUT_CACHE_SIZE);
+
+  entry = &priv->layout_cache[priv->layout_cache_next];
+  priv->layout_cache_next = (priv->layout_cache_next + 1) % LAYOUT_CACHE_SIZE;
+
+  layout_cache_entry_clear (entry);
+
+  /* The references keep the addresses in the key from being reused */
+  memcpy (&entry->key, key, sizeof (LayoutKey));
+  g_object_ref (entry->key.context);
+  if (entry->key.extra_attrs)
+    pango_attr_list_ref (entry->key.extra_attrs);
+  entry->hash = hash;
+  entry->text = g_strdup (priv->text);
+  entry->font = pango_font_description_copy (priv->font);
+  entry->layout = g_object_ref (layout);
+  entry->x_offset = x_offset;
+  entry->y_offset = y_offset;
+}
+
 static void
 gtk_cell_renderer_text_snapshot (GtkCellRenderer      *cell,
 			         GtkSnapshot          *snapshot,
@@ -1733,9 +1948,30 @@ gtk_cell_renderer_text_snapshot (GtkCellRenderer      *cell,
   gint y_offset = 0;
   gint xpad, ypad;
   PangoRectangle rect;
+  LayoutKey key;
+  LayoutCacheEntry *entry = NULL;
+  gboolean cacheable;
+  guint hash = 0;
+
+  cacheable = layout_key_init (&key, celltext, widget, cell_area, flags);
+  if (cacheable)
+    {
+      hash = layout_key_hash (&key, priv->text);
+      entry = gtk_cell_renderer_text_lookup_layout (celltext, &key, hash);
+    }
+
+  if (entry)
+    {
+      layout = g_object_ref (entry->layout);
+      x_offset = entry->x_offset;
+      y_offset = entry->y_offset;
+    }
+  else
+    {
+      layout = get_layout (celltext, widget, cell_area, flags);
+      get_size (cell, widget, cell_area, layout, &x_offset, &y_offset, NULL, NULL);
+    }
 
-  layout = get_layout (celltext, widget, cell_area, flags);
-  get_size (cell, widget, cell_area, layout, &x_offset, &y_offset, NULL, NULL);
   context = gtk_widget_get_style_context (widget);
 
   if (priv->background_set && (flags & GTK_CELL_RENDERER_SELECTED) == 0)
@@ -1751,14 +1987,21 @@ gtk_cell_renderer_text_snapshot (GtkCellRenderer      *cell,
 
   gtk_cell_renderer_get_padding (cell, &xpad, &ypad);
 
-  if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
-    pango_layout_set_width (layout,
-			    (cell_area->width - x_offset - 2 * xpad) * PANGO_SCALE);
-  else if (priv->wrap_width == -1)
-    pango_layout_set_width (layout, -1);
-
-  pango_layout_get_pixel_extents (layout, NULL, &rect);
-  x_offset = x_offset - rect.x;
+  if (entry == NULL)
+    {
+      if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
+        pango_layout_set_width (layout,
+                                (cell_area->width - x_offset - 2 * xpad) * PANGO_SCALE);
+      else if (priv->wrap_width == -1)
+        pango_layout_set_width (layout, -1);
+
+      pango_layout_get_pixel_extents (layout, NULL, &rect);
+      x_offset = x_offset - rect.x;
+
+      if (cacheable)
+        gtk_cell_renderer_text_store_layout (celltext, &key, hash,
+                                             layout, x_offset, y_offset);
+    }
 
   gtk_snapshot_push_clip (snapshot,
                           &GRAPHENE_RECT_INIT(
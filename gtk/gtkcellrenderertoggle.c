@@ -18,6 +18,7 @@
 #include "config.h"
 #include <stdlib.h>
 #include "gtkcellrenderertoggle.h"
+#include "gtkcellrendererprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
@@ -185,6 +186,10 @@ gtk_cell_renderer_toggle_class_init (GtkCellRendererToggleClass *class)
 		  G_TYPE_STRING);
 
   gtk_cell_renderer_class_set_accessible_type (cell_class, GTK_TYPE_BOOLEAN_CELL_ACCESSIBLE);
+
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "active");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "inconsistent");
+  _gtk_cell_renderer_class_set_size_neutral_property (cell_class, "activatable");
 }
 
 static void
@@ -0,0 +1,1154 @@
+/* gtkcolumnstore.c
+ * Copyright (C) 2017 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <gobject/gvaluecollector.h>
+#include "gtktreemodel.h"
+#include "gtkcolumnstore.h"
+
+
+/**
+ * SECTION:gtkcolumnstore
+ * @Short_description: A list model that stores its data per column
+ * @Title: GtkColumnStore
+ * @See_also: #GtkTreeModel, #GtkListStore
+ *
+ * The #GtkColumnStore object is a list model for use with a #GtkTreeView
+ * widget. Unlike #GtkListStore, which keeps a chain of cells for every
+ * row, it keeps every column in a single contiguous array. This makes it
+ * a good fit for large, mostly static tables of numbers and strings, such
+ * as data loaded from a file.
+ *
+ * Only fundamental numeric types, enums, flags and strings can be stored.
+ * Integral values are kept as 64-bit integers, floating point values as
+ * doubles, and strings are deduplicated within the store, so repeated
+ * strings only take up memory once.
+ *
+ * Rows are addressed by their position, so a #GtkColumnStore does not
+ * have the %GTK_TREE_MODEL_ITERS_PERSIST flag: iterators are invalidated
+ * whenever a row is removed.
+ *
+ * Rows can be added in bulk with gtk_column_store_append_rows() and then
+ * be filled column by column with gtk_column_store_set_int64_column(),
+ * gtk_column_store_set_double_column() and
+ * gtk_column_store_set_string_column().
+ *
+ * ## Filling a GtkColumnStore
+ *
+ * |[<!-- language="C" -->
+ * static const gint64 ids[] = { 1, 2, 3 };
+ * static const gchar *names[] = { "Alice", "Bob", "Carol" };
+ * GtkColumnStore *store;
+ *
+ * store = gtk_column_store_new (2, G_TYPE_INT64, G_TYPE_STRING);
+ * gtk_column_store_append_rows (store, 3, NULL);
+ * gtk_column_store_set_int64_column (store, 0, 0, 3, ids);
+ * gtk_column_store_set_string_column (store, 1, 0, 3, names);
+ * ]|
+ */
+
+
+typedef enum {
+  COLUMN_STORAGE_INT64,
+  COLUMN_STORAGE_DOUBLE,
+  COLUMN_STORAGE_STRING
+} ColumnStorage;
+
+typedef struct
+{
+  GType type;
+  ColumnStorage storage;
+  GArray *data;
+} Column;
+
+struct _GtkColumnStorePrivate
+{
+  Column *columns;
+  gint n_columns;
+
+  guint n_rows;
+  gint stamp;
+
+  GStringChunk *strings;
+};
+
+#define ROW_INDEX(iter) GPOINTER_TO_UINT ((iter)->user_data)
+
+static void         gtk_column_store_tree_model_init (GtkTreeModelIface *iface);
+static void         gtk_column_store_finalize        (GObject           *object);
+static GtkTreeModelFlags gtk_column_store_get_flags  (GtkTreeModel      *tree_model);
+static gint         gtk_column_store_get_n_columns   (GtkTreeModel      *tree_model);
+static GType        gtk_column_store_get_column_type (GtkTreeModel      *tree_model,
+                                                      gint               index);
+static gboolean     gtk_column_store_get_iter        (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter,
+                                                      GtkTreePath       *path);
+static GtkTreePath *gtk_column_store_get_path        (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter);
+static void         gtk_column_store_get_value       (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter,
+                                                      gint               column,
+                                                      GValue            *value);
+static gboolean     gtk_column_store_iter_next       (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter);
+static gboolean     gtk_column_store_iter_previous   (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter);
+static gboolean     gtk_column_store_iter_children   (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter,
+                                                      GtkTreeIter       *parent);
+static gboolean     gtk_column_store_iter_has_child  (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter);
+static gint         gtk_column_store_iter_n_children (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter);
+static gboolean     gtk_column_store_iter_nth_child  (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter,
+                                                      GtkTreeIter       *parent,
+                                                      gint               n);
+static gboolean     gtk_column_store_iter_parent     (GtkTreeModel      *tree_model,
+                                                      GtkTreeIter       *iter,
+                                                      GtkTreeIter       *child);
+
+
+G_DEFINE_TYPE_WITH_CODE (GtkColumnStore, gtk_column_store, G_TYPE_OBJECT,
+                         G_ADD_PRIVATE (GtkColumnStore)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gtk_column_store_tree_model_init))
+
+
+static void
+gtk_column_store_class_init (GtkColumnStoreClass *class)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+  object_class->finalize = gtk_column_store_finalize;
+}
+
+static void
+gtk_column_store_tree_model_init (GtkTreeModelIface *iface)
+{
+  iface->get_flags = gtk_column_store_get_flags;
+  iface->get_n_columns = gtk_column_store_get_n_columns;
+  iface->get_column_type = gtk_column_store_get_column_type;
+  iface->get_iter = gtk_column_store_get_iter;
+  iface->get_path = gtk_column_store_get_path;
+  iface->get_value = gtk_column_store_get_value;
+  iface->iter_next = gtk_column_store_iter_next;
+  iface->iter_previous = gtk_column_store_iter_previous;
+  iface->iter_children = gtk_column_store_iter_children;
+  iface->iter_has_child = gtk_column_store_iter_has_child;
+  iface->iter_n_children = gtk_column_store_iter_n_children;
+  iface->iter_nth_child = gtk_column_store_iter_nth_child;
+  iface->iter_parent = gtk_column_store_iter_parent;
+}
+
+static void
+gtk_column_store_init (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+
+  column_store->priv = gtk_column_store_get_instance_private (column_store);
+  priv = column_store->priv;
+
+  priv->columns = NULL;
+  priv->n_columns = 0;
+  priv->n_rows = 0;
+  priv->stamp = g_random_int ();
+  priv->strings = g_string_chunk_new (4096);
+}
+
+static void
+gtk_column_store_finalize (GObject *object)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (object);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  gint i;
+
+  for (i = 0; i < priv->n_columns; i++)
+    g_array_unref (priv->columns[i].data);
+
+  g_free (priv->columns);
+  g_string_chunk_free (priv->strings);
+
+  G_OBJECT_CLASS (gtk_column_store_parent_class)->finalize (object);
+}
+
+static gboolean
+gtk_column_store_get_storage (GType          type,
+                              ColumnStorage *storage)
+{
+  switch (G_TYPE_FUNDAMENTAL (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_UCHAR:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+      *storage = COLUMN_STORAGE_INT64;
+      return TRUE;
+
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      *storage = COLUMN_STORAGE_DOUBLE;
+      return TRUE;
+
+    case G_TYPE_STRING:
+      *storage = COLUMN_STORAGE_STRING;
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+/**
+ * gtk_column_store_newv: (rename-to gtk_column_store_new)
+ * @n_columns: number of columns in the column store
+ * @types: (array length=n_columns): an array of #GType types for the columns, from first to last
+ *
+ * Non-vararg creation function. Used primarily by language bindings.
+ *
+ * Returns: (transfer full): a new #GtkColumnStore
+ *
+ * Since: 3.94
+ */
+GtkColumnStore *
+gtk_column_store_newv (gint   n_columns,
+                       GType *types)
+{
+  GtkColumnStore *retval;
+  GtkColumnStorePrivate *priv;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  retval = g_object_new (GTK_TYPE_COLUMN_STORE, NULL);
+  priv = retval->priv;
+
+  priv->columns = g_new0 (Column, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      Column *column = &priv->columns[i];
+      guint element_size;
+
+      if (!gtk_column_store_get_storage (types[i], &column->storage))
+        {
+          g_warning ("%s: Invalid type %s", G_STRLOC, g_type_name (types[i]));
+          g_object_unref (retval);
+          return NULL;
+        }
+
+      switch (column->storage)
+        {
+        case COLUMN_STORAGE_INT64:
+          element_size = sizeof (gint64);
+          break;
+        case COLUMN_STORAGE_DOUBLE:
+          element_size = sizeof (gdouble);
+          break;
+        case COLUMN_STORAGE_STRING:
+        default:
+          element_size = sizeof (const gchar *);
+          break;
+        }
+
+      column->type = types[i];
+      column->data = g_array_new (FALSE, TRUE, element_size);
+      priv->n_columns++;
+    }
+
+  return retval;
+}
+
+/**
+ * gtk_column_store_new:
+ * @n_columns: number of columns in the column store
+ * @...: all #GType types for the columns, from first to last
+ *
+ * Creates a new column store with @n_columns columns, each of the types
+ * passed in. Only numeric types, enums, flags and strings are supported.
+ *
+ * Returns: a new #GtkColumnStore
+ *
+ * Since: 3.94
+ */
+GtkColumnStore *
+gtk_column_store_new (gint n_columns,
+                      ...)
+{
+  GtkColumnStore *retval;
+  GType *types;
+  va_list args;
+  gint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  types = g_new (GType, n_columns);
+
+  va_start (args, n_columns);
+  for (i = 0; i < n_columns; i++)
+    types[i] = va_arg (args, GType);
+  va_end (args);
+
+  retval = gtk_column_store_newv (n_columns, types);
+
+  g_free (types);
+
+  return retval;
+}
+
+static inline gboolean
+iter_is_valid (GtkTreeIter    *iter,
+               GtkColumnStore *column_store)
+{
+  return iter != NULL &&
+         iter->stamp == column_store->priv->stamp &&
+         ROW_INDEX (iter) < column_store->priv->n_rows;
+}
+
+static GtkTreeModelFlags
+gtk_column_store_get_flags (GtkTreeModel *tree_model)
+{
+  return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+gtk_column_store_get_n_columns (GtkTreeModel *tree_model)
+{
+  return GTK_COLUMN_STORE (tree_model)->priv->n_columns;
+}
+
+static GType
+gtk_column_store_get_column_type (GtkTreeModel *tree_model,
+                                  gint          index)
+{
+  GtkColumnStorePrivate *priv = GTK_COLUMN_STORE (tree_model)->priv;
+
+  g_return_val_if_fail (index >= 0 && index < priv->n_columns, G_TYPE_INVALID);
+
+  return priv->columns[index].type;
+}
+
+static gboolean
+gtk_column_store_get_iter (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter,
+                           GtkTreePath  *path)
+{
+  GtkColumnStorePrivate *priv = GTK_COLUMN_STORE (tree_model)->priv;
+  gint i;
+
+  i = gtk_tree_path_get_indices (path)[0];
+
+  if (i < 0 || (guint) i >= priv->n_rows)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (i);
+
+  return TRUE;
+}
+
+static GtkTreePath *
+gtk_column_store_get_path (GtkTreeModel *tree_model,
+                           GtkTreeIter  *iter)
+{
+  g_return_val_if_fail (iter_is_valid (iter, GTK_COLUMN_STORE (tree_model)), NULL);
+
+  return gtk_tree_path_new_from_indices (ROW_INDEX (iter), -1);
+}
+
+static void
+gtk_column_store_get_value (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter,
+                            gint          column,
+                            GValue       *value)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  GtkColumnStorePrivate *priv = column_store->priv;
+  Column *col;
+  guint row;
+  gint64 i;
+
+  g_return_if_fail (column >= 0 && column < priv->n_columns);
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  col = &priv->columns[column];
+  row = ROW_INDEX (iter);
+
+  g_value_init (value, col->type);
+
+  switch (col->storage)
+    {
+    case COLUMN_STORAGE_DOUBLE:
+      if (G_TYPE_FUNDAMENTAL (col->type) == G_TYPE_FLOAT)
+        g_value_set_float (value, g_array_index (col->data, gdouble, row));
+      else
+        g_value_set_double (value, g_array_index (col->data, gdouble, row));
+      return;
+
+    case COLUMN_STORAGE_STRING:
+      g_value_set_string (value, g_array_index (col->data, const gchar *, row));
+      return;
+
+    case COLUMN_STORAGE_INT64:
+    default:
+      break;
+    }
+
+  i = g_array_index (col->data, gint64, row);
+
+  switch (G_TYPE_FUNDAMENTAL (col->type))
+    {
+    case G_TYPE_BOOLEAN:
+      g_value_set_boolean (value, i != 0);
+      break;
+    case G_TYPE_CHAR:
+      g_value_set_schar (value, (gint8) i);
+      break;
+    case G_TYPE_UCHAR:
+      g_value_set_uchar (value, (guchar) i);
+      break;
+    case G_TYPE_INT:
+      g_value_set_int (value, (gint) i);
+      break;
+    case G_TYPE_UINT:
+      g_value_set_uint (value, (guint) i);
+      break;
+    case G_TYPE_LONG:
+      g_value_set_long (value, (glong) i);
+      break;
+    case G_TYPE_ULONG:
+      g_value_set_ulong (value, (gulong) i);
+      break;
+    case G_TYPE_INT64:
+      g_value_set_int64 (value, i);
+      break;
+    case G_TYPE_UINT64:
+      g_value_set_uint64 (value, (guint64) i);
+      break;
+    case G_TYPE_ENUM:
+      g_value_set_enum (value, (gint) i);
+      break;
+    case G_TYPE_FLAGS:
+      g_value_set_flags (value, (guint) i);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+gtk_column_store_iter_next (GtkTreeModel *tree_model,
+                            GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  guint row;
+
+  g_return_val_if_fail (iter_is_valid (iter, column_store), FALSE);
+
+  row = ROW_INDEX (iter) + 1;
+  if (row >= column_store->priv->n_rows)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GUINT_TO_POINTER (row);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_previous (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+  guint row;
+
+  g_return_val_if_fail (iter_is_valid (iter, column_store), FALSE);
+
+  row = ROW_INDEX (iter);
+  if (row == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->user_data = GUINT_TO_POINTER (row - 1);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_children (GtkTreeModel *tree_model,
+                                GtkTreeIter  *iter,
+                                GtkTreeIter  *parent)
+{
+  GtkColumnStorePrivate *priv = GTK_COLUMN_STORE (tree_model)->priv;
+
+  /* this is a list, nodes have no children */
+  if (parent || priv->n_rows == 0)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (0);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_has_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter)
+{
+  return FALSE;
+}
+
+static gint
+gtk_column_store_iter_n_children (GtkTreeModel *tree_model,
+                                  GtkTreeIter  *iter)
+{
+  GtkColumnStore *column_store = GTK_COLUMN_STORE (tree_model);
+
+  if (iter == NULL)
+    return column_store->priv->n_rows;
+
+  g_return_val_if_fail (iter_is_valid (iter, column_store), -1);
+
+  return 0;
+}
+
+static gboolean
+gtk_column_store_iter_nth_child (GtkTreeModel *tree_model,
+                                 GtkTreeIter  *iter,
+                                 GtkTreeIter  *parent,
+                                 gint          n)
+{
+  GtkColumnStorePrivate *priv = GTK_COLUMN_STORE (tree_model)->priv;
+
+  if (parent || n < 0 || (guint) n >= priv->n_rows)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (n);
+
+  return TRUE;
+}
+
+static gboolean
+gtk_column_store_iter_parent (GtkTreeModel *tree_model,
+                              GtkTreeIter  *iter,
+                              GtkTreeIter  *child)
+{
+  iter->stamp = 0;
+  return FALSE;
+}
+
+static void
+gtk_column_store_store_value (GtkColumnStore *column_store,
+                              Column         *col,
+                              guint           row,
+                              const GValue   *value)
+{
+  gint64 i;
+
+  switch (col->storage)
+    {
+    case COLUMN_STORAGE_DOUBLE:
+      if (G_TYPE_FUNDAMENTAL (col->type) == G_TYPE_FLOAT)
+        g_array_index (col->data, gdouble, row) = g_value_get_float (value);
+      else
+        g_array_index (col->data, gdouble, row) = g_value_get_double (value);
+      return;
+
+    case COLUMN_STORAGE_STRING:
+      {
+        const gchar *str = g_value_get_string (value);
+
+        g_array_index (col->data, const gchar *, row) =
+          str ? g_string_chunk_insert_const (column_store->priv->strings, str) : NULL;
+      }
+      return;
+
+    case COLUMN_STORAGE_INT64:
+    default:
+      break;
+    }
+
+  switch (G_TYPE_FUNDAMENTAL (col->type))
+    {
+    case G_TYPE_BOOLEAN:
+      i = g_value_get_boolean (value) ? 1 : 0;
+      break;
+    case G_TYPE_CHAR:
+      i = g_value_get_schar (value);
+      break;
+    case G_TYPE_UCHAR:
+      i = g_value_get_uchar (value);
+      break;
+    case G_TYPE_INT:
+      i = g_value_get_int (value);
+      break;
+    case G_TYPE_UINT:
+      i = g_value_get_uint (value);
+      break;
+    case G_TYPE_LONG:
+      i = g_value_get_long (value);
+      break;
+    case G_TYPE_ULONG:
+      i = g_value_get_ulong (value);
+      break;
+    case G_TYPE_INT64:
+      i = g_value_get_int64 (value);
+      break;
+    case G_TYPE_UINT64:
+      i = (gint64) g_value_get_uint64 (value);
+      break;
+    case G_TYPE_ENUM:
+      i = g_value_get_enum (value);
+      break;
+    case G_TYPE_FLAGS:
+      i = g_value_get_flags (value);
+      break;
+    default:
+      g_assert_not_reached ();
+      i = 0;
+    }
+
+  g_array_index (col->data, gint64, row) = i;
+}
+
+static gboolean
+gtk_column_store_real_set_value (GtkColumnStore *column_store,
+                                 GtkTreeIter    *iter,
+                                 gint            column,
+                                 GValue         *value)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+  Column *col;
+
+  g_return_val_if_fail (column >= 0 && column < priv->n_columns, FALSE);
+  g_return_val_if_fail (G_IS_VALUE (value), FALSE);
+
+  col = &priv->columns[column];
+
+  if (!g_type_is_a (G_VALUE_TYPE (value), col->type))
+    {
+      GValue real_value = G_VALUE_INIT;
+
+      if (! (g_value_type_transformable (G_VALUE_TYPE (value), col->type)))
+        {
+          g_warning ("%s: Unable to convert from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (col->type));
+          return FALSE;
+        }
+
+      g_value_init (&real_value, col->type);
+      if (!g_value_transform (value, &real_value))
+        {
+          g_warning ("%s: Unable to make conversion from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (col->type));
+          g_value_unset (&real_value);
+          return FALSE;
+        }
+
+      gtk_column_store_store_value (column_store, col, ROW_INDEX (iter), &real_value);
+      g_value_unset (&real_value);
+    }
+  else
+    gtk_column_store_store_value (column_store, col, ROW_INDEX (iter), value);
+
+  return TRUE;
+}
+
+static void
+gtk_column_store_emit_rows_changed (GtkColumnStore *column_store,
+                                    guint           first_row,
+                                    guint           n_rows)
+{
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  guint i;
+
+  path = gtk_tree_path_new_from_indices (first_row, -1);
+  iter.stamp = column_store->priv->stamp;
+
+  for (i = first_row; i < first_row + n_rows; i++)
+    {
+      iter.user_data = GUINT_TO_POINTER (i);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (column_store), path, &iter);
+      gtk_tree_path_next (path);
+    }
+
+  gtk_tree_path_free (path);
+}
+
+/**
+ * gtk_column_store_set_value:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @column: column number to modify
+ * @value: new value for the cell
+ *
+ * Sets the data in the cell specified by @iter and @column.
+ * The type of @value must be convertible to the type of the
+ * column.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set_value (GtkColumnStore *column_store,
+                            GtkTreeIter    *iter,
+                            gint            column,
+                            GValue         *value)
+{
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  if (gtk_column_store_real_set_value (column_store, iter, column, value))
+    gtk_column_store_emit_rows_changed (column_store, ROW_INDEX (iter), 1);
+}
+
+/**
+ * gtk_column_store_set_valist:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter for the row being modified
+ * @var_args: va_list of column/value pairs
+ *
+ * See gtk_column_store_set(); this version takes a va_list for use by
+ * language bindings.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set_valist (GtkColumnStore *column_store,
+                             GtkTreeIter    *iter,
+                             va_list         var_args)
+{
+  GtkColumnStorePrivate *priv;
+  gboolean emit_signal = FALSE;
+  gint column;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (iter_is_valid (iter, column_store));
+
+  priv = column_store->priv;
+
+  column = va_arg (var_args, gint);
+
+  while (column != -1)
+    {
+      GValue value = G_VALUE_INIT;
+      gchar *error = NULL;
+
+      if (column < 0 || column >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %d added to iter (remember to end your list of columns with a -1)", G_STRLOC, column);
+          break;
+        }
+
+      G_VALUE_COLLECT_INIT (&value, priv->columns[column].type,
+                            var_args, 0, &error);
+      if (error)
+        {
+          g_warning ("%s: %s", G_STRLOC, error);
+          g_free (error);
+
+          /* we purposely leak the value here, it might not be
+           * in a sane state if an error condition occoured
+           */
+          break;
+        }
+
+      emit_signal = gtk_column_store_real_set_value (column_store,
+                                                     iter,
+                                                     column,
+                                                     &value) || emit_signal;
+
+      g_value_unset (&value);
+
+      column = va_arg (var_args, gint);
+    }
+
+  if (emit_signal)
+    gtk_column_store_emit_rows_changed (column_store, ROW_INDEX (iter), 1);
+}
+
+/**
+ * gtk_column_store_set:
+ * @column_store: a #GtkColumnStore
+ * @iter: row iterator
+ * @...: pairs of column number and value, terminated with -1
+ *
+ * Sets the value of one or more cells in the row referenced by @iter.
+ * The variable argument list should contain integer column numbers,
+ * each column number followed by the value to be set.
+ * The list is terminated by a -1. For example, to set column 0 with type
+ * %G_TYPE_STRING to “Foo”, you would write
+ * `gtk_column_store_set (store, iter, 0, "Foo", -1)`.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set (GtkColumnStore *column_store,
+                      GtkTreeIter    *iter,
+                      ...)
+{
+  va_list var_args;
+
+  va_start (var_args, iter);
+  gtk_column_store_set_valist (column_store, iter, var_args);
+  va_end (var_args);
+}
+
+static gboolean
+gtk_column_store_check_range (GtkColumnStore *column_store,
+                              gint            column,
+                              ColumnStorage   storage,
+                              guint           first_row,
+                              guint           n_rows)
+{
+  GtkColumnStorePrivate *priv = column_store->priv;
+
+  if (column < 0 || column >= priv->n_columns)
+    {
+      g_warning ("%s: Invalid column number %d", G_STRLOC, column);
+      return FALSE;
+    }
+
+  if (priv->columns[column].storage != storage)
+    {
+      g_warning ("%s: Column %d of type %s can not be set in bulk with this function",
+                 G_STRLOC, column, g_type_name (priv->columns[column].type));
+      return FALSE;
+    }
+
+  if (first_row > priv->n_rows || n_rows > priv->n_rows - first_row)
+    {
+      g_warning ("%s: Rows %u to %u are out of range", G_STRLOC,
+                 first_row, first_row + n_rows);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_column_store_set_int64_column:
+ * @column_store: a #GtkColumnStore
+ * @column: the column to set
+ * @first_row: the first row to set
+ * @n_rows: the number of rows to set
+ * @values: (array length=n_rows): the new values
+ *
+ * Sets @n_rows values of @column at once, starting at @first_row.
+ * @column must hold an integral type, boolean, enum or flags; the
+ * values are not checked against the range of that type.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set_int64_column (GtkColumnStore *column_store,
+                                   gint            column,
+                                   guint           first_row,
+                                   guint           n_rows,
+                                   const gint64   *values)
+{
+  GArray *data;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (values != NULL || n_rows == 0);
+
+  if (!gtk_column_store_check_range (column_store, column, COLUMN_STORAGE_INT64,
+                                     first_row, n_rows))
+    return;
+
+  data = column_store->priv->columns[column].data;
+  memcpy (&g_array_index (data, gint64, first_row), values, n_rows * sizeof (gint64));
+
+  gtk_column_store_emit_rows_changed (column_store, first_row, n_rows);
+}
+
+/**
+ * gtk_column_store_set_double_column:
+ * @column_store: a #GtkColumnStore
+ * @column: the column to set
+ * @first_row: the first row to set
+ * @n_rows: the number of rows to set
+ * @values: (array length=n_rows): the new values
+ *
+ * Sets @n_rows values of @column at once, starting at @first_row.
+ * @column must hold %G_TYPE_DOUBLE or %G_TYPE_FLOAT.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set_double_column (GtkColumnStore *column_store,
+                                    gint            column,
+                                    guint           first_row,
+                                    guint           n_rows,
+                                    const gdouble  *values)
+{
+  GArray *data;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (values != NULL || n_rows == 0);
+
+  if (!gtk_column_store_check_range (column_store, column, COLUMN_STORAGE_DOUBLE,
+                                     first_row, n_rows))
+    return;
+
+  data = column_store->priv->columns[column].data;
+  memcpy (&g_array_index (data, gdouble, first_row), values, n_rows * sizeof (gdouble));
+
+  gtk_column_store_emit_rows_changed (column_store, first_row, n_rows);
+}
+
+/**
+ * gtk_column_store_set_string_column:
+ * @column_store: a #GtkColumnStore
+ * @column: the column to set
+ * @first_row: the first row to set
+ * @n_rows: the number of rows to set
+ * @values: (array length=n_rows) (element-type utf8) (nullable): the new values
+ *
+ * Sets @n_rows values of @column at once, starting at @first_row.
+ * @column must hold %G_TYPE_STRING. The strings are copied; equal
+ * strings are only stored once.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_set_string_column (GtkColumnStore      *column_store,
+                                    gint                 column,
+                                    guint                first_row,
+                                    guint                n_rows,
+                                    const gchar * const *values)
+{
+  GtkColumnStorePrivate *priv;
+  GArray *data;
+  guint i;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+  g_return_if_fail (values != NULL || n_rows == 0);
+
+  if (!gtk_column_store_check_range (column_store, column, COLUMN_STORAGE_STRING,
+                                     first_row, n_rows))
+    return;
+
+  priv = column_store->priv;
+  data = priv->columns[column].data;
+
+  for (i = 0; i < n_rows; i++)
+    g_array_index (data, const gchar *, first_row + i) =
+      values[i] ? g_string_chunk_insert_const (priv->strings, values[i]) : NULL;
+
+  gtk_column_store_emit_rows_changed (column_store, first_row, n_rows);
+}
+
+/**
+ * gtk_column_store_append_rows:
+ * @column_store: a #GtkColumnStore
+ * @n_rows: the number of rows to append
+ * @first_iter: (out) (optional): return location for the first new row
+ *
+ * Appends @n_rows empty rows to @column_store. Numeric cells are set
+ * to 0 and string cells to %NULL. If @first_iter is not %NULL and
+ * @n_rows is not 0, it is set to point to the first new row.
+ *
+ * This is considerably faster than appending the rows one by one.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_append_rows (GtkColumnStore *column_store,
+                              guint           n_rows,
+                              GtkTreeIter    *first_iter)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  guint first_row;
+  guint i;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  priv = column_store->priv;
+
+  g_return_if_fail (n_rows <= G_MAXINT - priv->n_rows);
+
+  if (first_iter)
+    first_iter->stamp = 0;
+
+  if (n_rows == 0)
+    return;
+
+  first_row = priv->n_rows;
+  priv->n_rows += n_rows;
+
+  for (i = 0; i < priv->n_columns; i++)
+    g_array_set_size (priv->columns[i].data, priv->n_rows);
+
+  path = gtk_tree_path_new_from_indices (first_row, -1);
+  iter.stamp = priv->stamp;
+
+  for (i = first_row; i < priv->n_rows; i++)
+    {
+      iter.user_data = GUINT_TO_POINTER (i);
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (column_store), path, &iter);
+      gtk_tree_path_next (path);
+    }
+
+  gtk_tree_path_free (path);
+
+  if (first_iter)
+    {
+      first_iter->stamp = priv->stamp;
+      first_iter->user_data = GUINT_TO_POINTER (first_row);
+    }
+}
+
+/**
+ * gtk_column_store_append:
+ * @column_store: A #GtkColumnStore
+ * @iter: (out): An unset #GtkTreeIter to set to the appended row
+ *
+ * Appends a new row to @column_store. @iter will be changed to point
+ * to this new row. The row will be empty after this function is called.
+ * To fill in values, you need to call gtk_column_store_set() or
+ * gtk_column_store_set_value().
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_append (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  gtk_column_store_append_rows (column_store, 1, iter);
+}
+
+/**
+ * gtk_column_store_remove:
+ * @column_store: A #GtkColumnStore
+ * @iter: A valid #GtkTreeIter
+ *
+ * Removes the given row from the column store. After being removed,
+ * @iter is set to be the next valid row, or invalidated if it pointed
+ * to the last row in @column_store.
+ *
+ * Returns: %TRUE if @iter is valid, %FALSE if not.
+ *
+ * Since: 3.94
+ */
+gboolean
+gtk_column_store_remove (GtkColumnStore *column_store,
+                         GtkTreeIter    *iter)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+  guint row;
+  gint i;
+
+  g_return_val_if_fail (GTK_IS_COLUMN_STORE (column_store), FALSE);
+  g_return_val_if_fail (iter_is_valid (iter, column_store), FALSE);
+
+  priv = column_store->priv;
+  row = ROW_INDEX (iter);
+
+  for (i = 0; i < priv->n_columns; i++)
+    g_array_remove_index (priv->columns[i].data, row);
+
+  priv->n_rows--;
+
+  /* rows after this one moved, so all outstanding iters are invalid */
+  do
+    priv->stamp++;
+  while (priv->stamp == 0);
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_model_row_deleted (GTK_TREE_MODEL (column_store), path);
+  gtk_tree_path_free (path);
+
+  if (row >= priv->n_rows)
+    {
+      iter->stamp = 0;
+      return FALSE;
+    }
+
+  iter->stamp = priv->stamp;
+  iter->user_data = GUINT_TO_POINTER (row);
+
+  return TRUE;
+}
+
+/**
+ * gtk_column_store_clear:
+ * @column_store: a #GtkColumnStore.
+ *
+ * Removes all rows from the column store.
+ *
+ * Since: 3.94
+ */
+void
+gtk_column_store_clear (GtkColumnStore *column_store)
+{
+  GtkColumnStorePrivate *priv;
+  GtkTreePath *path;
+  gint i;
+
+  g_return_if_fail (GTK_IS_COLUMN_STORE (column_store));
+
+  priv = column_store->priv;
+
+  /* Remove rows from the end, so no data needs to be moved */
+  while (priv->n_rows > 0)
+    {
+      priv->n_rows--;
+
+      do
+        priv->stamp++;
+      while (priv->stamp == 0);
+
+      for (i = 0; i < priv->n_columns; i++)
+        g_array_set_size (priv->columns[i].data, priv->n_rows);
+
+      path = gtk_tree_path_new_from_indices (priv->n_rows, -1);
+      gtk_tree_model_row_deleted (GTK_TREE_MODEL (column_store), path);
+      gtk_tree_path_free (path);
+    }
+
+  g_string_chunk_clear (priv->strings);
+}
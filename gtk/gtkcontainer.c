@@ -1589,6 +1589,11 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
       gtk_css_node_validate (gtk_widget_get_css_node (GTK_WIDGET (container)));
     }
 
+  /* Find out which content changes actually change sizes before
+   * looking at what needs to be allocated.
+   */
+  gtk_widget_ensure_resize_checks (GTK_WIDGET (container));
+
   /* we may be invoked with a container_resize_queue of NULL, because
    * queue_resize could have been adding an extra idle function while
    * the queue still got processed. we better just ignore such case
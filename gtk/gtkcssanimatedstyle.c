@@ -489,3 +489,23 @@ gtk_css_animated_style_new_advance (GtkCssAnimatedStyle *source,
 
   return GTK_CSS_STYLE (result);
 }
+
+/* Returns TRUE if all animations of @style only change compositor
+ * properties, so @style differs from its base style only in values
+ * that don't affect any other node.
+ */
+gboolean
+gtk_css_animated_style_is_compositor (GtkCssAnimatedStyle *style)
+{
+  GSList *l;
+
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_ANIMATED_STYLE (style), FALSE);
+
+  for (l = style->animations; l; l = l->next)
+    {
+      if (!_gtk_style_animation_is_compositor (l->data))
+        return FALSE;
+    }
+
+  return TRUE;
+}
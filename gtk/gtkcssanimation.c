@@ -22,6 +22,7 @@
 #include "gtkcssanimationprivate.h"
 
 #include "gtkcsseasevalueprivate.h"
+#include "gtkcssstylepropertyprivate.h"
 #include "gtkprogresstrackerprivate.h"
 
 #include <math.h>
@@ -134,6 +135,23 @@ gtk_css_animation_is_static (GtkStyleAnimation *style_animation)
   return gtk_progress_tracker_get_state (&animation->tracker) == GTK_PROGRESS_STATE_AFTER;
 }
 
+static gboolean
+gtk_css_animation_is_compositor (GtkStyleAnimation *style_animation)
+{
+  GtkCssAnimation *animation = GTK_CSS_ANIMATION (style_animation);
+  guint i;
+
+  for (i = 0; i < _gtk_css_keyframes_get_n_properties (animation->keyframes); i++)
+    {
+      guint property_id = _gtk_css_keyframes_get_property_id (animation->keyframes, i);
+
+      if (!_gtk_css_style_property_is_compositor (_gtk_css_style_property_lookup_by_id (property_id)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_css_animation_finalize (GObject *object)
 {
@@ -158,6 +176,7 @@ _gtk_css_animation_class_init (GtkCssAnimationClass *klass)
   animation_class->apply_values = gtk_css_animation_apply_values;
   animation_class->is_finished = gtk_css_animation_is_finished;
   animation_class->is_static = gtk_css_animation_is_static;
+  animation_class->is_compositor = gtk_css_animation_is_compositor;
 }
 
 static void
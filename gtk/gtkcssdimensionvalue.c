@@ -30,9 +30,16 @@ struct _GtkCssValue {
   double value;
 };
 
+/* All dimension values that are not singletons are interned here,
+ * so equal values share one instance */
+static GHashTable *dimension_values;
+
 static void
 gtk_css_value_dimension_free (GtkCssValue *value)
 {
+  if (g_hash_table_lookup (dimension_values, value) == value)
+    g_hash_table_remove (dimension_values, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -167,6 +174,16 @@ gtk_css_value_dimension_equal (const GtkCssValue *number1,
          number1->value == number2->value;
 }
 
+static guint
+gtk_css_value_dimension_hash (gconstpointer item)
+{
+  const GtkCssValue *number = item;
+  /* -0.0 and 0.0 are equal, so they must hash the same */
+  double value = number->value == 0 ? 0 : number->value;
+
+  return g_double_hash (&value) ^ number->unit;
+}
+
 static void
 gtk_css_value_dimension_print (const GtkCssValue *number,
                             GString           *string)
@@ -301,6 +318,7 @@ gtk_css_dimension_value_new (double     value,
     { &GTK_CSS_VALUE_DIMENSION.value_class, 1, GTK_CSS_PX, 3 },
     { &GTK_CSS_VALUE_DIMENSION.value_class, 1, GTK_CSS_PX, 4 },
   };
+  GtkCssValue key = { &GTK_CSS_VALUE_DIMENSION.value_class, 1, unit, value };
   GtkCssValue *result;
 
   if (unit == GTK_CSS_NUMBER && (value == 0 || value == 1))
@@ -316,10 +334,22 @@ gtk_css_dimension_value_new (double     value,
       return _gtk_css_value_ref (&px_singletons[(int) value]);
     }
 
+  if (dimension_values == NULL)
+    dimension_values = g_hash_table_new (gtk_css_value_dimension_hash,
+                                         (GEqualFunc) gtk_css_value_dimension_equal);
+
+  result = g_hash_table_lookup (dimension_values, &key);
+  if (result)
+    return _gtk_css_value_ref (result);
+
   result = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_DIMENSION.value_class);
   result->unit = unit;
   result->value = value;
 
+  /* NaN never compares equal, so it can't be found again */
+  if (!isnan (value))
+    g_hash_table_add (dimension_values, result);
+
   return result;
 }
 
@@ -27,6 +27,7 @@
 #include "gtkcssstyleprivate.h"
 #include "gtkhslaprivate.h"
 
+#include <gdk/gdktextureprivate.h>
 #include <math.h>
 
 #include "fallback-c89.c"
@@ -642,6 +643,85 @@ gtk_css_image_builtin_draw (GtkCssImage            *image,
   }
 }
 
+/* The images only depend on their type, size and colors, so they are
+ * drawn once and the textures are shared by all the widgets showing
+ * them. That way, the renderers upload them only once, too.
+ */
+#define MAX_CACHED_TEXTURES 256
+
+typedef struct {
+  GtkCssImageBuiltinType type;
+  int width;
+  int height;
+  GdkRGBA fg_color;
+  GdkRGBA bg_color;
+} TextureKey;
+
+static GHashTable *texture_cache;
+
+static guint
+texture_key_hash (gconstpointer data)
+{
+  const TextureKey *key = data;
+
+  return ((key->type << 24) ^ (key->width << 12) ^ key->height)
+         ^ gdk_rgba_hash (&key->fg_color)
+         ^ (gdk_rgba_hash (&key->bg_color) << 1);
+}
+
+static gboolean
+texture_key_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const TextureKey *key1 = a;
+  const TextureKey *key2 = b;
+
+  return key1->type == key2->type &&
+         key1->width == key2->width &&
+         key1->height == key2->height &&
+         gdk_rgba_equal (&key1->fg_color, &key2->fg_color) &&
+         gdk_rgba_equal (&key1->bg_color, &key2->bg_color);
+}
+
+static GdkTexture *
+gtk_css_image_builtin_get_texture (GtkCssImageBuiltin     *builtin,
+                                   int                     width,
+                                   int                     height,
+                                   GtkCssImageBuiltinType  image_type)
+{
+  TextureKey lookup = { image_type, width, height, builtin->fg_color, builtin->bg_color };
+  TextureKey *key;
+  GdkTexture *texture;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  if (G_UNLIKELY (texture_cache == NULL))
+    texture_cache = g_hash_table_new_full (texture_key_hash, texture_key_equal,
+                                           g_free, g_object_unref);
+
+  texture = g_hash_table_lookup (texture_cache, &lookup);
+  if (texture)
+    return texture;
+
+  /* Textures that are in use are kept alive by their nodes,
+   * so just start over */
+  if (g_hash_table_size (texture_cache) >= MAX_CACHED_TEXTURES)
+    g_hash_table_remove_all (texture_cache);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  gtk_css_image_builtin_draw (GTK_CSS_IMAGE (builtin), cr, width, height, image_type);
+  cairo_destroy (cr);
+
+  texture = gdk_texture_new_for_surface (surface);
+  cairo_surface_destroy (surface);
+
+  key = g_memdup (&lookup, sizeof (TextureKey));
+  g_hash_table_insert (texture_cache, key, texture);
+
+  return texture;
+}
+
 void
 gtk_css_image_builtin_snapshot (GtkCssImage            *image,
                                 GtkSnapshot            *snapshot,
@@ -662,6 +742,24 @@ gtk_css_image_builtin_snapshot (GtkCssImage            *image,
       return;
     }
 
+  if (image_type == GTK_CSS_IMAGE_BUILTIN_NONE)
+    return;
+
+  /* Textures are drawn at their size; anything else would not match
+   * what a cairo node draws */
+  if (width == ceil (width) && height == ceil (height))
+    {
+      GdkTexture *texture;
+
+      texture = gtk_css_image_builtin_get_texture (GTK_CSS_IMAGE_BUILTIN (image),
+                                                   width, height, image_type);
+      gtk_snapshot_append_texture (snapshot,
+                                   texture,
+                                   &GRAPHENE_RECT_INIT (0, 0, width, height),
+                                   "BuiltinImage<%d>", (int) image_type);
+      return;
+    }
+
   cr = gtk_snapshot_append_cairo (snapshot,
                                   &GRAPHENE_RECT_INIT (0, 0, width, height),
                                   "BuiltinImage<%d>", (int) image_type);
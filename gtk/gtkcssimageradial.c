@@ -74,20 +74,17 @@ gtk_css_image_radial_get_start_end (GtkCssImageRadial *radial,
 }
 
 static void
-gtk_css_image_radial_draw (GtkCssImage *image,
-                           cairo_t     *cr,
-                           double       width,
-                           double       height)
+gtk_css_image_radial_get_geometry (GtkCssImageRadial *radial,
+                                   double             width,
+                                   double             height,
+                                   double            *center_x,
+                                   double            *center_y,
+                                   double            *hradius,
+                                   double            *vradius)
 {
-  GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
-  cairo_pattern_t *pattern;
-  cairo_matrix_t matrix;
   double x, y;
-  double radius, yscale;
-  double start, end;
+  double radius;
   double r1, r2, r3, r4, r;
-  double offset;
-  int i, last;
 
   x = _gtk_css_position_value_get_x (radial->position, width);
   y = _gtk_css_position_value_get_y (radial->position, height);
@@ -122,45 +119,65 @@ gtk_css_image_radial_draw (GtkCssImage *image,
         }
 
       radius = MAX (1.0, radius);
-      yscale = 1.0;
+      *hradius = radius;
+      *vradius = radius;
     }
   else
     {
-      double hradius, vradius;
-
       switch (radial->size)
         {
         case GTK_CSS_EXPLICIT_SIZE:
-          hradius = _gtk_css_number_value_get (radial->sizes[0], width);
-          vradius = _gtk_css_number_value_get (radial->sizes[1], height);
+          *hradius = _gtk_css_number_value_get (radial->sizes[0], width);
+          *vradius = _gtk_css_number_value_get (radial->sizes[1], height);
           break;
         case GTK_CSS_CLOSEST_SIDE:
-          hradius = MIN (x, width - x);
-          vradius = MIN (y, height - y);
+          *hradius = MIN (x, width - x);
+          *vradius = MIN (y, height - y);
           break;
         case GTK_CSS_FARTHEST_SIDE:
-          hradius = MAX (x, width - x);
-          vradius = MAX (y, height - y);
+          *hradius = MAX (x, width - x);
+          *vradius = MAX (y, height - y);
           break;
         case GTK_CSS_CLOSEST_CORNER:
-          hradius = M_SQRT2 * MIN (x, width - x);
-          vradius = M_SQRT2 * MIN (y, height - y);
+          *hradius = M_SQRT2 * MIN (x, width - x);
+          *vradius = M_SQRT2 * MIN (y, height - y);
           break;
         case GTK_CSS_FARTHEST_CORNER:
-          hradius = M_SQRT2 * MAX (x, width - x);
-          vradius = M_SQRT2 * MAX (y, height - y);
+          *hradius = M_SQRT2 * MAX (x, width - x);
+          *vradius = M_SQRT2 * MAX (y, height - y);
           break;
         default:
           g_assert_not_reached ();
         }
 
-      hradius = MAX (1.0, hradius);
-      vradius = MAX (1.0, vradius);
-
-      radius = hradius;
-      yscale = vradius / hradius;
+      *hradius = MAX (1.0, *hradius);
+      *vradius = MAX (1.0, *vradius);
     }
 
+  *center_x = x;
+  *center_y = y;
+}
+
+static void
+gtk_css_image_radial_draw (GtkCssImage *image,
+                           cairo_t     *cr,
+                           double       width,
+                           double       height)
+{
+  GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
+  cairo_pattern_t *pattern;
+  cairo_matrix_t matrix;
+  double x, y;
+  double hradius, vradius;
+  double radius, yscale;
+  double start, end;
+  double offset;
+  int i, last;
+
+  gtk_css_image_radial_get_geometry (radial, width, height, &x, &y, &hradius, &vradius);
+  radius = hradius;
+  yscale = vradius / hradius;
+
   gtk_css_image_radial_get_start_end (radial, radius, &start, &end);
 
   pattern = cairo_pattern_create_radial (0, 0, radius * start, 0, 0, radius * end);
@@ -227,6 +244,116 @@ gtk_css_image_radial_draw (GtkCssImage *image,
   cairo_pattern_destroy (pattern);
 }
 
+static void
+gtk_css_image_radial_snapshot (GtkCssImage *image,
+                               GtkSnapshot *snapshot,
+                               double       width,
+                               double       height)
+{
+  GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
+  GskColorStop *stops;
+  double x, y;
+  double hradius, vradius;
+  double start, end;
+  double offset;
+  int i, last;
+
+  gtk_css_image_radial_get_geometry (radial, width, height, &x, &y, &hradius, &vradius);
+  gtk_css_image_radial_get_start_end (radial, hradius, &start, &end);
+
+  if (start >= end)
+    {
+      /* repeating gradients with all color stops sharing the same offset
+       * get the color of the last color stop */
+      GtkCssImageRadialColorStop *stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, radial->stops->len - 1);
+
+      gtk_snapshot_append_color (snapshot,
+                                 _gtk_css_rgba_value_get_rgba (stop->color),
+                                 &GRAPHENE_RECT_INIT (0, 0, width, height),
+                                 "RepeatingRadialGradient<degenerate>");
+      return;
+    }
+
+  offset = start;
+  last = -1;
+  stops = g_newa (GskColorStop, radial->stops->len);
+
+  for (i = 0; i < radial->stops->len; i++)
+    {
+      GtkCssImageRadialColorStop *stop;
+      double pos, step;
+
+      stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, i);
+
+      if (stop->offset == NULL)
+        {
+          if (i == 0)
+            pos = 0.0;
+          else if (i + 1 == radial->stops->len)
+            pos = 1.0;
+          else
+            continue;
+        }
+      else
+        pos = _gtk_css_number_value_get (stop->offset, hradius) / hradius;
+
+      pos = MAX (pos, offset);
+      step = (pos - offset) / (i - last);
+      for (last = last + 1; last <= i; last++)
+        {
+          stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, last);
+
+          offset += step;
+
+          stops[last].offset = offset;
+          stops[last].color = *_gtk_css_rgba_value_get_rgba (stop->color);
+        }
+
+      offset = pos;
+      last = i;
+    }
+
+  /* Stops past 100% of a non-repeating gradient make it end later */
+  end = MAX (end, offset);
+  for (i = 0; i < radial->stops->len; i++)
+    stops[i].offset = (stops[i].offset - start) / (end - start);
+
+  if (radial->repeating)
+    {
+      /* The nodes need a positive start; moving it by whole
+       * periods does not change a repeating gradient */
+      if (start < 0)
+        {
+          double shift = ceil (-start / (end - start)) * (end - start);
+
+          start += shift;
+          end += shift;
+        }
+
+      gtk_snapshot_append_repeating_radial_gradient (
+          snapshot,
+          &GRAPHENE_RECT_INIT (0, 0, width, height),
+          &GRAPHENE_POINT_INIT (x, y),
+          hradius, vradius,
+          start, end,
+          stops,
+          radial->stops->len,
+          "RepeatingRadialGradient<%ustops>", radial->stops->len);
+    }
+  else
+    {
+      gtk_snapshot_append_radial_gradient (
+          snapshot,
+          &GRAPHENE_RECT_INIT (0, 0, width, height),
+          &GRAPHENE_POINT_INIT (x, y),
+          hradius, vradius,
+          start, end,
+          stops,
+          radial->stops->len,
+          "RadialGradient<%ustops>", radial->stops->len);
+    }
+}
+
 static gboolean
 gtk_css_image_radial_parse (GtkCssImage  *image,
                             GtkCssParser *parser)
@@ -668,6 +795,7 @@ _gtk_css_image_radial_class_init (GtkCssImageRadialClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   image_class->draw = gtk_css_image_radial_draw;
+  image_class->snapshot = gtk_css_image_radial_snapshot;
   image_class->parse = gtk_css_image_radial_parse;
   image_class->print = gtk_css_image_radial_print;
   image_class->compute = gtk_css_image_radial_compute;
@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <string.h>
+#include <glib/gstdio.h>
 
 #include "gtkcssimageurlprivate.h"
 #include "gtkcssimagesurfaceprivate.h"
@@ -27,6 +28,27 @@
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
 
+/* Files at least this large are decoded in a thread */
+#define ASYNC_LOAD_THRESHOLD (64 * 1024)
+
+static void
+gtk_css_image_url_set_error (GtkCssImageUrl  *url,
+                             GError          *local_error,
+                             GError         **error)
+{
+  char *uri;
+
+  if (error == NULL)
+    return;
+
+  uri = g_file_get_uri (url->file);
+  g_set_error (error,
+               GTK_CSS_PROVIDER_ERROR,
+               GTK_CSS_PROVIDER_ERROR_FAILED,
+               "Error loading image '%s': %s", uri, local_error->message);
+  g_free (uri);
+}
+
 static GtkCssImage *
 gtk_css_image_url_load_image (GtkCssImageUrl  *url,
                               GError         **error)
@@ -56,19 +78,7 @@ gtk_css_image_url_load_image (GtkCssImageUrl  *url,
     }
 
   if (texture == NULL)
-    {
-      if (error)
-        {
-          char *uri;
-
-          uri = g_file_get_uri (url->file);
-          g_set_error (error,
-                       GTK_CSS_PROVIDER_ERROR,
-                       GTK_CSS_PROVIDER_ERROR_FAILED,
-                       "Error loading image '%s': %s", uri, local_error->message);
-          g_free (uri);
-       }
-    }
+    gtk_css_image_url_set_error (url, local_error, error);
 
   url->loaded_image = gtk_css_image_surface_new (texture);
 
@@ -78,11 +88,120 @@ gtk_css_image_url_load_image (GtkCssImageUrl  *url,
   return url->loaded_image;
 }
 
+static void
+gtk_css_image_url_load_thread (GTask        *task,
+                               gpointer      source_object,
+                               gpointer      task_data,
+                               GCancellable *cancellable)
+{
+  GtkCssImageUrl *url = source_object;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = gdk_texture_new_from_file (url->file, &error);
+  if (texture)
+    g_task_return_pointer (task, texture, g_object_unref);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+gtk_css_image_url_load_done (GObject      *source,
+                             GAsyncResult *result,
+                             gpointer      data)
+{
+  GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (source);
+  GWeakRef *provider_ref = g_task_get_task_data (G_TASK (result));
+  GtkStyleProvider *provider;
+  GdkTexture *texture;
+  GError *error = NULL;
+
+  texture = g_task_propagate_pointer (G_TASK (result), &error);
+
+  url->loading = FALSE;
+
+  /* Somebody may have needed the image in the meantime */
+  if (url->loaded_image == NULL)
+    {
+      url->loaded_image = gtk_css_image_surface_new (texture);
+      url->load_error = error;
+      error = NULL;
+    }
+
+  g_clear_object (&texture);
+  g_clear_error (&error);
+
+  /* Styles using the image hold on to the url until they are
+   * recomputed, so make that happen.
+   */
+  provider = g_weak_ref_get (provider_ref);
+  if (provider)
+    {
+      gtk_style_provider_changed (provider);
+      g_object_unref (provider);
+    }
+}
+
+static void
+weak_ref_free (gpointer data)
+{
+  GWeakRef *ref = data;
+
+  g_weak_ref_clear (ref);
+  g_slice_free (GWeakRef, ref);
+}
+
+/* Starts decoding the image in a thread if the file is large enough
+ * for that to be worth it. Until it is done, the url acts as an
+ * empty image of the size found in the file header.
+ */
+static gboolean
+gtk_css_image_url_load_async (GtkCssImageUrl   *url,
+                              GtkStyleProvider *provider)
+{
+  GWeakRef *provider_ref;
+  GStatBuf buf;
+  GTask *task;
+  char *path;
+  gboolean result = FALSE;
+
+  path = g_file_get_path (url->file);
+  if (path == NULL)
+    return FALSE;
+
+  if (g_stat (path, &buf) != 0 || buf.st_size < ASYNC_LOAD_THRESHOLD)
+    goto out;
+
+  if (gdk_pixbuf_get_file_info (path, &url->width, &url->height) == NULL)
+    goto out;
+
+  provider_ref = g_slice_new (GWeakRef);
+  g_weak_ref_init (provider_ref, provider);
+
+  url->loading = TRUE;
+
+  task = g_task_new (url, NULL, gtk_css_image_url_load_done, NULL);
+  g_task_set_source_tag (task, gtk_css_image_url_load_async);
+  g_task_set_task_data (task, provider_ref, weak_ref_free);
+  g_task_run_in_thread (task, gtk_css_image_url_load_thread);
+  g_object_unref (task);
+
+  result = TRUE;
+
+out:
+  g_free (path);
+
+  return result;
+}
+
 static int
 gtk_css_image_url_get_width (GtkCssImage *image)
 {
   GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (image);
 
+  if (url->loading && url->loaded_image == NULL)
+    return url->width;
+
   return _gtk_css_image_get_width (gtk_css_image_url_load_image (url, NULL));
 }
 
@@ -91,6 +210,9 @@ gtk_css_image_url_get_height (GtkCssImage *image)
 {
   GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (image);
 
+  if (url->loading && url->loaded_image == NULL)
+    return url->height;
+
   return _gtk_css_image_get_height (gtk_css_image_url_load_image (url, NULL));
 }
 
@@ -99,6 +221,9 @@ gtk_css_image_url_get_aspect_ratio (GtkCssImage *image)
 {
   GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (image);
 
+  if (url->loading && url->loaded_image == NULL)
+    return (double) url->width / url->height;
+
   return _gtk_css_image_get_aspect_ratio (gtk_css_image_url_load_image (url, NULL));
 }
 
@@ -110,6 +235,9 @@ gtk_css_image_url_snapshot (GtkCssImage *image,
 {
   GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (image);
 
+  if (url->loading && url->loaded_image == NULL)
+    return;
+
   gtk_css_image_snapshot (gtk_css_image_url_load_image (url, NULL), snapshot, width, height);
 }
 
@@ -124,6 +252,16 @@ gtk_css_image_url_compute (GtkCssImage      *image,
   GtkCssImage *copy;
   GError *error = NULL;
 
+  if (url->loaded_image == NULL &&
+      (url->loading || gtk_css_image_url_load_async (url, provider)))
+    return g_object_ref (image);
+
+  if (url->load_error)
+    {
+      gtk_css_image_url_set_error (url, url->load_error, &error);
+      g_clear_error (&url->load_error);
+    }
+
   copy = gtk_css_image_url_load_image (url, &error);
   if (error)
     {
@@ -174,6 +312,7 @@ gtk_css_image_url_dispose (GObject *object)
 
   g_clear_object (&url->file);
   g_clear_object (&url->loaded_image);
+  g_clear_error (&url->load_error);
 
   G_OBJECT_CLASS (_gtk_css_image_url_parent_class)->dispose (object);
 }
@@ -40,6 +40,11 @@ struct _GtkCssImageUrl
 
   GFile           *file;                /* the file we're loading from */
   GtkCssImage     *loaded_image;        /* the actual image we render */
+  GError          *load_error;          /* error from loading in a thread */
+
+  guint            loading : 1;         /* loading in a thread */
+  int              width;               /* the size from the file header, while loading */
+  int              height;
 };
 
 struct _GtkCssImageUrlClass
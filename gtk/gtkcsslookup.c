@@ -25,26 +25,16 @@
 #include "gtkprivate.h"
 
 void
-_gtk_css_lookup_init (GtkCssLookup     *lookup,
-                      const GtkBitmask *relevant)
+_gtk_css_lookup_init (GtkCssLookup *lookup)
 {
   memset (lookup, 0, sizeof (*lookup));
 
-  if (relevant)
-    {
-      lookup->missing = _gtk_bitmask_copy (relevant);
-    }
-  else
-    {
-      lookup->missing = _gtk_bitmask_new ();
-      lookup->missing = _gtk_bitmask_invert_range (lookup->missing, 0, GTK_CSS_PROPERTY_N_PROPERTIES);
-    }
+  gtk_css_property_set_init_all (&lookup->missing);
 }
 
 void
 _gtk_css_lookup_destroy (GtkCssLookup *lookup)
 {
-  _gtk_bitmask_free (lookup->missing);
 }
 
 gboolean
@@ -53,7 +43,7 @@ _gtk_css_lookup_is_missing (const GtkCssLookup *lookup,
 {
   gtk_internal_return_val_if_fail (lookup != NULL, FALSE);
 
-  return _gtk_bitmask_get (lookup->missing, id);
+  return gtk_css_property_set_get (&lookup->missing, id);
 }
 
 /**
@@ -76,10 +66,10 @@ _gtk_css_lookup_set (GtkCssLookup  *lookup,
                      GtkCssValue   *value)
 {
   gtk_internal_return_if_fail (lookup != NULL);
-  gtk_internal_return_if_fail (_gtk_bitmask_get (lookup->missing, id));
+  gtk_internal_return_if_fail (gtk_css_property_set_get (&lookup->missing, id));
   gtk_internal_return_if_fail (value != NULL);
 
-  lookup->missing = _gtk_bitmask_set (lookup->missing, id, FALSE);
+  gtk_css_property_set_remove (&lookup->missing, id);
   lookup->values[id].value = value;
   lookup->values[id].section = section;
 }
@@ -112,7 +102,7 @@ _gtk_css_lookup_resolve (GtkCssLookup      *lookup,
   for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
     {
       if (lookup->values[i].value ||
-          _gtk_bitmask_get (lookup->missing, i))
+          gtk_css_property_set_get (&lookup->missing, i))
         gtk_css_static_style_compute_value (style,
                                             provider,
                                             parent_style,
@@ -19,7 +19,7 @@
 #define __GTK_CSS_LOOKUP_PRIVATE_H__
 
 #include <glib-object.h>
-#include "gtk/gtkbitmaskprivate.h"
+#include "gtk/gtkcsspropertysetprivate.h"
 #include "gtk/gtkcssstaticstyleprivate.h"
 #include "gtk/gtkcsssection.h"
 
@@ -34,15 +34,14 @@ typedef struct {
 } GtkCssLookupValue;
 
 struct _GtkCssLookup {
-  GtkBitmask        *missing;
+  GtkCssPropertySet  missing;
   GtkCssLookupValue  values[GTK_CSS_PROPERTY_N_PROPERTIES];
 };
 
-void                    _gtk_css_lookup_init                    (GtkCssLookup               *lookup,
-                                                                 const GtkBitmask           *relevant);
+void                    _gtk_css_lookup_init                    (GtkCssLookup               *lookup);
 void                    _gtk_css_lookup_destroy                 (GtkCssLookup               *lookup);
 
-static inline const GtkBitmask *_gtk_css_lookup_get_missing     (const GtkCssLookup         *lookup);
+static inline const GtkCssPropertySet *_gtk_css_lookup_get_missing (const GtkCssLookup      *lookup);
 gboolean                _gtk_css_lookup_is_missing              (const GtkCssLookup         *lookup,
                                                                  guint                       id);
 void                    _gtk_css_lookup_set                     (GtkCssLookup               *lookup,
@@ -54,10 +53,10 @@ void                    _gtk_css_lookup_resolve                 (GtkCssLookup
                                                                  GtkCssStaticStyle          *style,
                                                                  GtkCssStyle                *parent_style);
 
-static inline const GtkBitmask *
+static inline const GtkCssPropertySet *
 _gtk_css_lookup_get_missing (const GtkCssLookup *lookup)
 {
-  return lookup->missing;
+  return &lookup->missing;
 }
 
 
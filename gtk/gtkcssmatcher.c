@@ -198,7 +198,15 @@ gtk_css_matcher_node_get_parent (GtkCssMatcher       *matcher,
   if (node == NULL)
     return FALSE;
 
-  return gtk_css_node_init_matcher (node, matcher);
+  if (!gtk_css_node_init_matcher (node, matcher))
+    return FALSE;
+
+  /* The filter of the child's ancestors is a superset of ours,
+   * which is good enough for rejecting selectors. */
+  if (matcher->klass == child->klass)
+    matcher->node.filter = child->node.filter;
+
+  return TRUE;
 }
 
 static GtkCssNode *
@@ -231,7 +239,14 @@ gtk_css_matcher_node_get_previous (GtkCssMatcher       *matcher,
   if (node == NULL)
     return FALSE;
 
-  return gtk_css_node_init_matcher (node, matcher);
+  if (!gtk_css_node_init_matcher (node, matcher))
+    return FALSE;
+
+  /* siblings share their ancestors */
+  if (matcher->klass == next->klass)
+    matcher->node.filter = next->node.filter;
+
+  return TRUE;
 }
 
 static GtkStateFlags
@@ -325,6 +340,50 @@ _gtk_css_matcher_node_init (GtkCssMatcher *matcher,
 {
   matcher->node.klass = &GTK_CSS_MATCHER_NODE;
   matcher->node.node = node;
+  matcher->node.filter = NULL;
+}
+
+gboolean
+_gtk_css_matcher_is_node (const GtkCssMatcher *matcher)
+{
+  return matcher->klass == &GTK_CSS_MATCHER_NODE;
+}
+
+void
+_gtk_css_matcher_node_set_ancestor_filter (GtkCssMatcher              *matcher,
+                                           const GtkCssAncestorFilter *filter)
+{
+  g_return_if_fail (matcher->klass == &GTK_CSS_MATCHER_NODE);
+
+  matcher->node.filter = filter;
+}
+
+const GtkCssAncestorFilter *
+_gtk_css_matcher_get_ancestor_filter (const GtkCssMatcher *matcher)
+{
+  if (matcher->klass != &GTK_CSS_MATCHER_NODE)
+    return NULL;
+
+  return matcher->node.filter;
+}
+
+void
+_gtk_css_ancestor_filter_add_node (GtkCssAncestorFilter *filter,
+                                   GtkCssNode           *node)
+{
+  const GQuark *classes;
+  const char *id;
+  guint i, n_classes;
+
+  _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_name (gtk_css_node_get_name (node)));
+
+  id = gtk_css_node_get_id (node);
+  if (id)
+    _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_id (id));
+
+  classes = gtk_css_node_list_classes (node, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    _gtk_css_ancestor_filter_add (filter, _gtk_css_ancestor_filter_hash_class (classes[i]));
 }
 
 /* GTK_CSS_MATCHER_WIDGET_ANY */
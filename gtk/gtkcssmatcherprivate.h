@@ -28,6 +28,17 @@ typedef struct _GtkCssMatcherNode GtkCssMatcherNode;
 typedef struct _GtkCssMatcherSuperset GtkCssMatcherSuperset;
 typedef struct _GtkCssMatcherWidgetPath GtkCssMatcherWidgetPath;
 typedef struct _GtkCssMatcherClass GtkCssMatcherClass;
+typedef struct _GtkCssAncestorFilter GtkCssAncestorFilter;
+
+/* A bloom filter of the names, classes and IDs of all ancestors of
+ * a node. It may contain false positives, but never false negatives,
+ * so it can be used to reject descendant selectors early.
+ */
+#define GTK_CSS_ANCESTOR_FILTER_BITS 512
+
+struct _GtkCssAncestorFilter {
+  guint32 bits[GTK_CSS_ANCESTOR_FILTER_BITS / 32];
+};
 
 struct _GtkCssMatcherClass {
   gboolean        (* get_parent)                  (GtkCssMatcher          *matcher,
@@ -60,6 +71,7 @@ struct _GtkCssMatcherWidgetPath {
 struct _GtkCssMatcherNode {
   const GtkCssMatcherClass *klass;
   GtkCssNode               *node;
+  const GtkCssAncestorFilter *filter;   /* filter of the ancestors or %NULL */
 };
 
 struct _GtkCssMatcherSuperset {
@@ -80,6 +92,11 @@ gboolean          _gtk_css_matcher_init           (GtkCssMatcher          *match
                                                    const GtkCssNodeDeclaration *decl) G_GNUC_WARN_UNUSED_RESULT;
 void              _gtk_css_matcher_node_init      (GtkCssMatcher          *matcher,
                                                    GtkCssNode             *node);
+gboolean          _gtk_css_matcher_is_node        (const GtkCssMatcher    *matcher);
+void              _gtk_css_matcher_node_set_ancestor_filter (GtkCssMatcher      *matcher,
+                                                   const GtkCssAncestorFilter *filter);
+const GtkCssAncestorFilter *
+                  _gtk_css_matcher_get_ancestor_filter (const GtkCssMatcher *matcher);
 void              _gtk_css_matcher_any_init       (GtkCssMatcher          *matcher);
 void              _gtk_css_matcher_superset_init  (GtkCssMatcher          *matcher,
                                                    const GtkCssMatcher    *subset,
@@ -142,6 +159,48 @@ _gtk_css_matcher_matches_any (const GtkCssMatcher *matcher)
   return matcher->klass->is_any;
 }
 
+static inline guint
+_gtk_css_ancestor_filter_hash_name (/*interned*/ const char *name)
+{
+  return (guint) (GPOINTER_TO_SIZE (name) >> 3) * 2654435761u;
+}
+
+static inline guint
+_gtk_css_ancestor_filter_hash_class (GQuark class_name)
+{
+  return (class_name * 2654435761u) ^ 0x5bd1e995;
+}
+
+static inline guint
+_gtk_css_ancestor_filter_hash_id (/*interned*/ const char *id)
+{
+  return ((guint) (GPOINTER_TO_SIZE (id) >> 3) * 2654435761u) ^ 0x9e3779b9;
+}
+
+static inline void
+_gtk_css_ancestor_filter_add (GtkCssAncestorFilter *filter,
+                              guint                 hash)
+{
+  guint bit1 = hash % GTK_CSS_ANCESTOR_FILTER_BITS;
+  guint bit2 = (hash >> 16) % GTK_CSS_ANCESTOR_FILTER_BITS;
+
+  filter->bits[bit1 / 32] |= 1u << (bit1 % 32);
+  filter->bits[bit2 / 32] |= 1u << (bit2 % 32);
+}
+
+static inline gboolean
+_gtk_css_ancestor_filter_may_contain (const GtkCssAncestorFilter *filter,
+                                      guint                       hash)
+{
+  guint bit1 = hash % GTK_CSS_ANCESTOR_FILTER_BITS;
+  guint bit2 = (hash >> 16) % GTK_CSS_ANCESTOR_FILTER_BITS;
+
+  return (filter->bits[bit1 / 32] & (1u << (bit1 % 32))) &&
+         (filter->bits[bit2 / 32] & (1u << (bit2 % 32)));
+}
+
+void              _gtk_css_ancestor_filter_add_node (GtkCssAncestorFilter *filter,
+                                                   GtkCssNode             *node);
 
 G_END_DECLS
 
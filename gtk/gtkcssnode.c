@@ -20,6 +20,7 @@
 #include "gtkcssnodeprivate.h"
 
 #include "gtkcssanimatedstyleprivate.h"
+#include "gtkcsslookupprivate.h"
 #include "gtkcsssectionprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkintl.h"
@@ -27,6 +28,8 @@
 #include "gtksettingsprivate.h"
 #include "gtktypebuiltins.h"
 
+#include <string.h>
+
 /*
  * CSS nodes are the backbone of the GtkStyleContext implementation and
  * replace the role that GtkWidgetPath played in the past. A CSS node has
@@ -301,11 +304,36 @@ may_use_global_parent_cache (GtkCssNode *node)
   return TRUE;
 }
 
+static guint
+gtk_css_node_get_sibling_declarations (GtkCssNode             *node,
+                                       GtkCssNodeDeclaration **siblings)
+{
+  GtkCssNode *iter;
+  guint n_siblings = 0;
+
+  for (iter = node->previous_sibling;
+       iter != NULL;
+       iter = iter->previous_sibling)
+    {
+      if (!iter->visible)
+        continue;
+
+      if (n_siblings == GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS)
+        return n_siblings + 1;
+
+      siblings[n_siblings++] = iter->decl;
+    }
+
+  return n_siblings;
+}
+
 static GtkCssStyle *
 lookup_in_global_parent_cache (GtkCssNode                  *node,
                                const GtkCssNodeDeclaration *decl)
 {
+  GtkCssNodeDeclaration *siblings[GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS];
   GtkCssNode *parent;
+  guint n_siblings;
 
   parent = node->parent;
 
@@ -316,11 +344,15 @@ lookup_in_global_parent_cache (GtkCssNode                  *node,
   if (parent->cache == NULL)
     return NULL;
 
+  n_siblings = gtk_css_node_get_sibling_declarations (node, siblings);
+
   g_assert (node->cache == NULL);
   node->cache = gtk_css_node_style_cache_lookup (parent->cache,
                                                  decl,
-                                                 gtk_css_node_is_first_child (node),
-                                                 gtk_css_node_is_last_child (node));
+                                                 n_siblings == 0,
+                                                 gtk_css_node_is_last_child (node),
+                                                 siblings,
+                                                 n_siblings);
   if (node->cache == NULL)
     return NULL;
 
@@ -332,7 +364,9 @@ store_in_global_parent_cache (GtkCssNode                  *node,
                               const GtkCssNodeDeclaration *decl,
                               GtkCssStyle                 *style)
 {
+  GtkCssNodeDeclaration *siblings[GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS];
   GtkCssNode *parent;
+  guint n_siblings;
 
   g_assert (GTK_IS_CSS_STATIC_STYLE (style));
 
@@ -345,17 +379,202 @@ store_in_global_parent_cache (GtkCssNode                  *node,
   if (parent->cache == NULL)
     parent->cache = gtk_css_node_style_cache_new (parent->style);
 
+  n_siblings = gtk_css_node_get_sibling_declarations (node, siblings);
+
   node->cache = gtk_css_node_style_cache_insert (parent->cache,
                                                  (GtkCssNodeDeclaration *) decl,
-                                                 gtk_css_node_is_first_child (node),
+                                                 n_siblings == 0,
                                                  gtk_css_node_is_last_child (node),
+                                                 siblings,
+                                                 n_siblings,
                                                  style);
 }
 
+/* Matching selectors only reads the node tree and the style providers,
+ * so when many children of a node need a new style, their lookups are
+ * done on a thread pool. Computing the styles from the lookups happens
+ * on the main thread.
+ */
+#define GTK_CSS_NODE_PARALLEL_MIN_CHILDREN 16
+
+typedef struct {
+  GtkCssNode       *node;
+  GtkStyleProvider *provider;
+  GtkCssMatcher     matcher;
+  GtkCssLookup      lookup;
+  GtkCssChange      change;
+  guint             used : 1;
+} GtkCssNodePrematch;
+
+typedef struct {
+  GtkCssNodePrematch *items;
+  guint               n_items;
+  guint               cursor;
+  guint               serial;
+  gint                next;
+  gint                n_running;
+  GMutex              mutex;
+  GCond               cond;
+} GtkCssNodePrematchJob;
+
+static GThreadPool *prematch_pool;
+static GtkCssNodePrematchJob *validating_prematch;
+
+/* Incremented whenever anything changes that selectors can match on,
+ * so we know when prematched lookups became stale. */
+static guint declaration_serial;
+
+/* While gtk_css_node_validate() walks the tree, this is the ancestor
+ * filter for the children of validating_parent, or %NULL if their
+ * matchers can't use one.
+ */
+static GtkCssNode *validating_parent;
+static const GtkCssAncestorFilter *validating_filter;
+
+/* Fills @filter with the ancestors that a matcher for @cssnode would
+ * visit. Returns %FALSE if those can't be described by a filter.
+ */
+static gboolean
+gtk_css_node_build_ancestor_filter (GtkCssNode           *cssnode,
+                                    GtkCssAncestorFilter *filter)
+{
+  GtkCssMatcher matcher;
+  GtkCssNode *node;
+
+  memset (filter, 0, sizeof (GtkCssAncestorFilter));
+
+  for (node = cssnode->parent; node; node = node->parent)
+    {
+      if (!gtk_css_node_init_matcher (node, &matcher))
+        break;
+
+      if (!_gtk_css_matcher_is_node (&matcher))
+        return FALSE;
+
+      _gtk_css_ancestor_filter_add_node (filter, node);
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_node_get_ancestor_filter (GtkCssNode           *cssnode,
+                                  GtkCssAncestorFilter *filter)
+{
+  if (cssnode->parent != NULL && cssnode->parent == validating_parent)
+    {
+      if (validating_filter == NULL)
+        return FALSE;
+
+      *filter = *validating_filter;
+      return TRUE;
+    }
+
+  return gtk_css_node_build_ancestor_filter (cssnode, filter);
+}
+
+static gboolean
+gtk_css_node_get_child_ancestor_filter (GtkCssNode           *cssnode,
+                                        GtkCssAncestorFilter *filter)
+{
+  GtkCssMatcher matcher;
+
+  if (!gtk_css_node_init_matcher (cssnode, &matcher))
+    {
+      /* matching stops here, so children have no ancestors */
+      memset (filter, 0, sizeof (GtkCssAncestorFilter));
+      return TRUE;
+    }
+
+  if (!_gtk_css_matcher_is_node (&matcher) ||
+      !gtk_css_node_get_ancestor_filter (cssnode, filter))
+    return FALSE;
+
+  _gtk_css_ancestor_filter_add_node (filter, cssnode);
+
+  return TRUE;
+}
+
+static void
+gtk_css_node_prematch_run (GtkCssNodePrematchJob *job)
+{
+  gint i;
+
+  while ((i = g_atomic_int_add (&job->next, 1)) < (gint) job->n_items)
+    {
+      GtkCssNodePrematch *item = &job->items[i];
+
+      gtk_css_static_style_lookup (item->provider,
+                                   &item->matcher,
+                                   &item->lookup,
+                                   &item->change);
+    }
+}
+
+static void
+gtk_css_node_prematch_thread (gpointer data,
+                              gpointer user_data)
+{
+  GtkCssNodePrematchJob *job = data;
+
+  gtk_css_node_prematch_run (job);
+
+  g_mutex_lock (&job->mutex);
+  job->n_running--;
+  g_cond_signal (&job->cond);
+  g_mutex_unlock (&job->mutex);
+}
+
+static void
+gtk_css_node_prematch_free (GtkCssNodePrematchJob *job)
+{
+  guint i;
+
+  for (i = 0; i < job->n_items; i++)
+    _gtk_css_lookup_destroy (&job->items[i].lookup);
+
+  g_mutex_clear (&job->mutex);
+  g_cond_clear (&job->cond);
+  g_free (job->items);
+  g_slice_free (GtkCssNodePrematchJob, job);
+}
+
+static GtkCssNodePrematch *
+gtk_css_node_find_prematch (GtkCssNode *cssnode)
+{
+  GtkCssNodePrematchJob *job = validating_prematch;
+  guint i;
+
+  if (job == NULL ||
+      cssnode->parent != validating_parent ||
+      job->serial != declaration_serial)
+    return NULL;
+
+  /* children are usually validated in order */
+  for (i = 0; i < job->n_items; i++)
+    {
+      GtkCssNodePrematch *item = &job->items[(job->cursor + i) % job->n_items];
+
+      if (item->node == cssnode)
+        {
+          job->cursor = (job->cursor + i + 1) % job->n_items;
+          if (item->used)
+            return NULL;
+
+          item->used = TRUE;
+          return item;
+        }
+    }
+
+  return NULL;
+}
+
 static GtkCssStyle *
 gtk_css_node_create_style (GtkCssNode *cssnode)
 {
   const GtkCssNodeDeclaration *decl;
+  GtkCssNodePrematch *prematch;
+  GtkCssAncestorFilter filter;
   GtkCssMatcher matcher;
   GtkCssStyle *parent;
   GtkCssStyle *style;
@@ -368,10 +587,22 @@ gtk_css_node_create_style (GtkCssNode *cssnode)
 
   parent = cssnode->parent ? cssnode->parent->style : NULL;
 
-  if (gtk_css_node_init_matcher (cssnode, &matcher))
-    style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
-                                              &matcher,
-                                              parent);
+  prematch = gtk_css_node_find_prematch (cssnode);
+  if (prematch)
+    style = gtk_css_static_style_new_from_lookup (prematch->provider,
+                                                  &prematch->lookup,
+                                                  prematch->change,
+                                                  parent);
+  else if (gtk_css_node_init_matcher (cssnode, &matcher))
+    {
+      if (_gtk_css_matcher_is_node (&matcher) &&
+          gtk_css_node_get_ancestor_filter (cssnode, &filter))
+        _gtk_css_matcher_node_set_ancestor_filter (&matcher, &filter);
+
+      style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
+                                                &matcher,
+                                                parent);
+    }
   else
     style = gtk_css_static_style_new_compute (gtk_css_node_get_style_provider (cssnode),
                                               NULL,
@@ -405,6 +636,81 @@ gtk_css_style_needs_recreation (GtkCssStyle  *style,
     return FALSE;
 }
 
+/* Looks up the styles of all children of @cssnode that are going
+ * to need a new one, if there are enough of them to be worth it.
+ */
+static GtkCssNodePrematchJob *
+gtk_css_node_prematch_children (GtkCssNode                 *cssnode,
+                                const GtkCssAncestorFilter *filter)
+{
+  GtkCssNodePrematchJob *job;
+  GtkCssNode *child;
+  guint n_items, n_threads, i;
+
+  n_threads = g_get_num_processors ();
+  if (n_threads < 2)
+    return NULL;
+
+  n_items = 0;
+  for (child = cssnode->first_child; child; child = child->next_sibling)
+    {
+      if (child->visible && child->invalid && child->style_is_invalid &&
+          gtk_css_style_needs_recreation (child->style, child->pending_changes))
+        n_items++;
+    }
+
+  if (n_items < GTK_CSS_NODE_PARALLEL_MIN_CHILDREN)
+    return NULL;
+
+  job = g_slice_new0 (GtkCssNodePrematchJob);
+  job->items = g_new (GtkCssNodePrematch, n_items);
+  job->serial = declaration_serial;
+
+  for (child = cssnode->first_child; child; child = child->next_sibling)
+    {
+      GtkCssNodePrematch *item;
+
+      if (!(child->visible && child->invalid && child->style_is_invalid &&
+            gtk_css_style_needs_recreation (child->style, child->pending_changes)))
+        continue;
+
+      item = &job->items[job->n_items];
+      if (!gtk_css_node_init_matcher (child, &item->matcher))
+        continue;
+
+      if (_gtk_css_matcher_is_node (&item->matcher) && filter)
+        _gtk_css_matcher_node_set_ancestor_filter (&item->matcher, filter);
+
+      item->node = child;
+      /* may create the provider, so don't do this on a thread */
+      item->provider = gtk_css_node_get_style_provider (child);
+      item->used = FALSE;
+      job->n_items++;
+    }
+
+  if (prematch_pool == NULL)
+    prematch_pool = g_thread_pool_new (gtk_css_node_prematch_thread, NULL,
+                                       n_threads - 1, FALSE, NULL);
+
+  g_mutex_init (&job->mutex);
+  g_cond_init (&job->cond);
+
+  n_threads = MIN (n_threads - 1, (job->n_items + 7) / 8);
+  job->n_running = n_threads;
+  for (i = 0; i < n_threads; i++)
+    g_thread_pool_push (prematch_pool, job, NULL);
+
+  /* help out instead of just waiting */
+  gtk_css_node_prematch_run (job);
+
+  g_mutex_lock (&job->mutex);
+  while (job->n_running > 0)
+    g_cond_wait (&job->cond, &job->mutex);
+  g_mutex_unlock (&job->mutex);
+
+  return job;
+}
+
 static GtkCssStyle *
 gtk_css_node_real_update_style (GtkCssNode   *cssnode,
                                 GtkCssChange  change,
@@ -747,6 +1053,8 @@ gtk_css_node_reposition (GtkCssNode *node,
   /* Take a reference here so the whole function has a reference */
   g_object_ref (node);
 
+  declaration_serial++;
+
   if (node->visible)
     {
       if (node->next_sibling)
@@ -777,7 +1085,7 @@ gtk_css_node_reposition (GtkCssNode *node,
         }
 
       if (gtk_css_node_get_style_provider_or_null (node) == NULL)
-        gtk_css_node_invalidate_style_provider (node);
+        gtk_css_node_invalidate_style_provider (node, NULL);
       gtk_css_node_invalidate (node, GTK_CSS_CHANGE_TIMESTAMP | GTK_CSS_CHANGE_ANIMATIONS);
 
       if (new_parent)
@@ -951,18 +1259,71 @@ gtk_css_node_set_style (GtkCssNode  *cssnode,
   return style_changed;
 }
 
+static GtkCssStyle *
+gtk_css_style_get_static_style (GtkCssStyle *style)
+{
+  if (GTK_IS_CSS_ANIMATED_STYLE (style))
+    return GTK_CSS_ANIMATED_STYLE (style)->style;
+
+  return style;
+}
+
+static gboolean
+gtk_css_style_is_compositor (GtkCssStyle *style)
+{
+  if (GTK_IS_CSS_ANIMATED_STYLE (style))
+    return gtk_css_animated_style_is_compositor (GTK_CSS_ANIMATED_STYLE (style));
+
+  return TRUE;
+}
+
+/* When a node only advances animations of compositor properties, like
+ * the rotation of a spinner or a fade, the new style differs only in
+ * values that are applied when snapshotting the node itself. Children
+ * don't depend on those, so they don't need to be restyled.
+ */
+static gboolean
+gtk_css_node_is_compositor_change (GtkCssStyle *old_style,
+                                   GtkCssStyle *new_style)
+{
+  if (old_style == NULL)
+    return FALSE;
+
+  if (gtk_css_style_get_static_style (old_style) != gtk_css_style_get_static_style (new_style))
+    return FALSE;
+
+  return gtk_css_style_is_compositor (old_style) &&
+         gtk_css_style_is_compositor (new_style);
+}
+
+static gboolean
+gtk_css_node_inherits_compositor (GtkCssNode *cssnode)
+{
+  GtkCssStyle *style;
+
+  if (cssnode->style == NULL)
+    return FALSE;
+
+  style = gtk_css_style_get_static_style (cssnode->style);
+  if (!GTK_IS_CSS_STATIC_STYLE (style))
+    return TRUE;
+
+  return GTK_CSS_STATIC_STYLE (style)->inherits_compositor;
+}
+
 static void
 gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
-                                        gboolean    style_changed)
+                                        gboolean    style_changed,
+                                        gboolean    compositor_change)
 {
   GtkCssChange change, child_change;
   GtkCssNode *child;
 
   change = _gtk_css_change_for_child (cssnode->pending_changes);
-  if (style_changed)
+  if (style_changed && !compositor_change)
     change |= GTK_CSS_CHANGE_PARENT_STYLE;
 
-  if (!cssnode->needs_propagation && change == 0)
+  if (!cssnode->needs_propagation && change == 0 && !style_changed)
     return;
 
   for (child = gtk_css_node_get_first_child (cssnode);
@@ -970,7 +1331,11 @@ gtk_css_node_propagate_pending_changes (GtkCssNode *cssnode,
        child = gtk_css_node_get_next_sibling (child))
     {
       child_change = child->pending_changes;
-      gtk_css_node_invalidate (child, change);
+      if (style_changed && compositor_change &&
+          gtk_css_node_inherits_compositor (child))
+        gtk_css_node_invalidate (child, change | GTK_CSS_CHANGE_PARENT_STYLE);
+      else
+        gtk_css_node_invalidate (child, change);
       if (child->visible)
         change |= _gtk_css_change_for_sibling (child_change);
     }
@@ -988,7 +1353,7 @@ static void
 gtk_css_node_ensure_style (GtkCssNode *cssnode,
                            gint64      current_time)
 {
-  gboolean style_changed;
+  gboolean style_changed, compositor_change;
 
   if (!gtk_css_node_needs_new_style (cssnode))
     return;
@@ -1010,15 +1375,17 @@ gtk_css_node_ensure_style (GtkCssNode *cssnode,
                                                                   current_time,
                                                                   cssnode->style);
 
+      compositor_change = gtk_css_node_is_compositor_change (cssnode->style, new_style);
       style_changed = gtk_css_node_set_style (cssnode, new_style);
       g_object_unref (new_style);
     }
   else
     {
       style_changed = FALSE;
+      compositor_change = FALSE;
     }
 
-  gtk_css_node_propagate_pending_changes (cssnode, style_changed);
+  gtk_css_node_propagate_pending_changes (cssnode, style_changed, compositor_change);
 
   cssnode->pending_changes = 0;
   cssnode->style_is_invalid = FALSE;
@@ -1047,6 +1414,7 @@ gtk_css_node_set_visible (GtkCssNode *cssnode,
     return;
 
   cssnode->visible = visible;
+  declaration_serial++;
   g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_VISIBLE]);
 
   if (cssnode->invalid)
@@ -1104,12 +1472,40 @@ gtk_css_node_get_visible (GtkCssNode *cssnode)
   return cssnode->visible;
 }
 
+/* Deferred nodes still take part in matching and compute their style
+ * when it is asked for, but validation doesn't descend into them, so
+ * hidden parts of the UI don't update their styles for every change.
+ */
+void
+gtk_css_node_set_defer_validation (GtkCssNode *cssnode,
+                                   gboolean    defer_validation)
+{
+  defer_validation = !!defer_validation;
+
+  if (cssnode->defer_validation == defer_validation)
+    return;
+
+  cssnode->defer_validation = defer_validation;
+
+  /* Changes may have piled up, make sure the next validation sees them */
+  if (!defer_validation && cssnode->invalid &&
+      cssnode->visible && cssnode->parent)
+    gtk_css_node_set_invalid (cssnode->parent, TRUE);
+}
+
+gboolean
+gtk_css_node_get_defer_validation (GtkCssNode *cssnode)
+{
+  return cssnode->defer_validation;
+}
+
 void
 gtk_css_node_set_name (GtkCssNode              *cssnode,
                        /*interned*/ const char *name)
 {
   if (gtk_css_node_declaration_set_name (&cssnode->decl, name))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_NAME);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_NAME]);
     }
@@ -1127,6 +1523,7 @@ gtk_css_node_set_widget_type (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_set_type (&cssnode->decl, widget_type))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_NAME);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_WIDGET_TYPE]);
     }
@@ -1144,6 +1541,7 @@ gtk_css_node_set_id (GtkCssNode                *cssnode,
 {
   if (gtk_css_node_declaration_set_id (&cssnode->decl, id))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_ID);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_ID]);
     }
@@ -1161,6 +1559,7 @@ gtk_css_node_set_state (GtkCssNode    *cssnode,
 {
   if (gtk_css_node_declaration_set_state (&cssnode->decl, state_flags))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_STATE);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_STATE]);
     }
@@ -1177,6 +1576,7 @@ gtk_css_node_clear_classes (GtkCssNode *cssnode)
 {
   if (gtk_css_node_declaration_clear_classes (&cssnode->decl))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1228,6 +1628,7 @@ gtk_css_node_add_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_add_class (&cssnode->decl, style_class))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1239,6 +1640,7 @@ gtk_css_node_remove_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_remove_class (&cssnode->decl, style_class))
     {
+      declaration_serial++;
       gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
@@ -1264,22 +1666,74 @@ gtk_css_node_get_declaration (GtkCssNode *cssnode)
   return cssnode->decl;
 }
 
-void
-gtk_css_node_invalidate_style_provider (GtkCssNode *cssnode)
+static gboolean
+gtk_css_node_is_affected_by (GtkCssNode                   *cssnode,
+                             const GtkStyleProviderChange *change)
+{
+  GtkCssMatcher matcher;
+  const GQuark *classes;
+  const char *id;
+  guint i, n_classes;
+
+  /* Only node matchers match by the node's own keys */
+  if (!gtk_css_node_init_matcher (cssnode, &matcher) ||
+      !_gtk_css_matcher_is_node (&matcher))
+    return TRUE;
+
+  if (gtk_style_provider_change_contains (change, GTK_CSS_SELECTOR_BUCKET_NAME,
+                                          (gpointer) gtk_css_node_get_name (cssnode)))
+    return TRUE;
+
+  id = gtk_css_node_get_id (cssnode);
+  if (id && gtk_style_provider_change_contains (change, GTK_CSS_SELECTOR_BUCKET_ID, (gpointer) id))
+    return TRUE;
+
+  classes = gtk_css_node_list_classes (cssnode, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    {
+      if (gtk_style_provider_change_contains (change, GTK_CSS_SELECTOR_BUCKET_CLASS,
+                                              GUINT_TO_POINTER (classes[i])))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_css_node_invalidate_style_provider_for_change (GtkCssNode                   *cssnode,
+                                                   const GtkStyleProviderChange *change)
 {
   GtkCssNode *child;
 
-  gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
+  if (change == NULL || gtk_css_node_is_affected_by (cssnode, change))
+    gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_SOURCE);
 
   for (child = cssnode->first_child;
        child;
        child = child->next_sibling)
     {
       if (gtk_css_node_get_style_provider_or_null (child) == NULL)
-        gtk_css_node_invalidate_style_provider (child);
+        gtk_css_node_invalidate_style_provider_for_change (child, change);
     }
 }
 
+/* If @change is not %NULL, only nodes that may match one of the
+ * changed rules get restyled. Their children follow because their
+ * parent style changes.
+ */
+void
+gtk_css_node_invalidate_style_provider (GtkCssNode                   *cssnode,
+                                        const GtkStyleProviderChange *change)
+{
+  /* Cached styles and prematched lookups may have been computed from
+   * the old rules */
+  if (change)
+    gtk_css_node_style_cache_flush ();
+  declaration_serial++;
+
+  gtk_css_node_invalidate_style_provider_for_change (cssnode, change);
+}
+
 static void
 gtk_css_node_invalidate_timestamp (GtkCssNode *cssnode)
 {
@@ -1334,6 +1788,10 @@ static void
 gtk_css_node_validate_internal (GtkCssNode *cssnode,
                                 gint64      timestamp)
 {
+  GtkCssAncestorFilter child_filter;
+  const GtkCssAncestorFilter *saved_filter;
+  GtkCssNodePrematchJob *saved_prematch;
+  GtkCssNode *saved_parent;
   GtkCssNode *child;
 
   if (!cssnode->invalid)
@@ -1348,13 +1806,32 @@ gtk_css_node_validate_internal (GtkCssNode *cssnode,
 
   GTK_CSS_NODE_GET_CLASS (cssnode)->validate (cssnode);
 
+  if (cssnode->first_child == NULL)
+    return;
+
+  /* Keep the ancestor filter up to date while descending, so that
+   * children don't need to walk all their parents to build one. */
+  saved_parent = validating_parent;
+  saved_filter = validating_filter;
+  saved_prematch = validating_prematch;
+  validating_filter = gtk_css_node_get_child_ancestor_filter (cssnode, &child_filter) ? &child_filter : NULL;
+  validating_parent = cssnode;
+  validating_prematch = gtk_css_node_prematch_children (cssnode, validating_filter);
+
   for (child = gtk_css_node_get_first_child (cssnode);
        child;
        child = gtk_css_node_get_next_sibling (child))
     {
-      if (child->visible)
+      if (child->visible && !child->defer_validation)
         gtk_css_node_validate_internal (child, timestamp);
     }
+
+  if (validating_prematch)
+    gtk_css_node_prematch_free (validating_prematch);
+
+  validating_parent = saved_parent;
+  validating_filter = saved_filter;
+  validating_prematch = saved_prematch;
 }
 
 void
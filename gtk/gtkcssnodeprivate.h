@@ -23,6 +23,7 @@
 #include "gtkcssstylechangeprivate.h"
 #include "gtkbitmaskprivate.h"
 #include "gtkcsstypesprivate.h"
+#include "gtkstyleproviderprivate.h"
 
 G_BEGIN_DECLS
 
@@ -60,6 +61,7 @@ struct _GtkCssNode
    * So if a valid style is computed, one has to previously ensure that the parent's and the previous sibling's style
    * are valid. This allows both validation and invalidation to run in O(nodes-in-tree) */
   guint                  style_is_invalid :1;   /* the style needs to be recomputed */
+  guint                  defer_validation :1;   /* node and its children are skipped when validating */
 };
 
 struct _GtkCssNodeClass
@@ -116,6 +118,9 @@ GtkCssNode *            gtk_css_node_get_next_sibling   (GtkCssNode            *
 void                    gtk_css_node_set_visible        (GtkCssNode            *cssnode,
                                                          gboolean               visible);
 gboolean                gtk_css_node_get_visible        (GtkCssNode            *cssnode);
+void                    gtk_css_node_set_defer_validation (GtkCssNode          *cssnode,
+                                                         gboolean               defer_validation);
+gboolean                gtk_css_node_get_defer_validation (GtkCssNode          *cssnode);
 
 void                    gtk_css_node_set_name           (GtkCssNode            *cssnode,
                                                          /*interned*/const char*name);
@@ -147,7 +152,8 @@ GtkCssStyle *           gtk_css_node_get_style          (GtkCssNode            *
 
 
 void                    gtk_css_node_invalidate_style_provider
-                                                        (GtkCssNode            *cssnode);
+                                                        (GtkCssNode            *cssnode,
+                                                         const GtkStyleProviderChange *change);
 void                    gtk_css_node_invalidate_frame_clock
                                                         (GtkCssNode            *cssnode,
                                                          gboolean               just_timestamp);
@@ -22,26 +22,54 @@
 #include "gtkdebug.h"
 #include "gtkcssstaticstyleprivate.h"
 
+#include <string.h>
+
 struct _GtkCssNodeStyleCache {
   guint        ref_count;
   GtkCssStyle *style;
   GHashTable  *children;
+  GHashTable  *sibling_children;
 };
 
+typedef struct {
+  GtkCssNodeDeclaration *decl;
+  guint                  is_last;
+  guint                  n_siblings;
+  GtkCssNodeDeclaration *siblings[GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS];
+} GtkCssNodeStyleCacheKey;
+
+typedef enum {
+  GTK_CSS_NODE_STYLE_CACHE_NONE,
+  GTK_CSS_NODE_STYLE_CACHE_CHILD,
+  GTK_CSS_NODE_STYLE_CACHE_SIBLINGS
+} GtkCssNodeStyleCacheKind;
+
 #define UNPACK_DECLARATION(packed) ((GtkCssNodeDeclaration *) (GPOINTER_TO_SIZE (packed) & ~0x3))
 #define UNPACK_FLAGS(packed) (GPOINTER_TO_SIZE (packed) & 0x3)
 #define PACK(decl, first_child, last_child) GSIZE_TO_POINTER (GPOINTER_TO_SIZE (decl) | ((first_child) ? 0x2 : 0) | ((last_child) ? 0x1 : 0))
 
+/* All caches that are alive, so gtk_css_node_style_cache_flush() can
+ * find them. The caches remove themselves when they are freed.
+ */
+static GHashTable *all_caches;
+
+static GtkCssNodeStyleCacheStats stats;
+
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_new (GtkCssStyle *style)
 {
   GtkCssNodeStyleCache *result;
 
+  if (all_caches == NULL)
+    all_caches = g_hash_table_new (NULL, NULL);
+
   result = g_slice_new0 (GtkCssNodeStyleCache);
 
   result->ref_count = 1;
   result->style = g_object_ref (style);
 
+  g_hash_table_add (all_caches, result);
+
   return result;
 }
 
@@ -61,9 +89,13 @@ gtk_css_node_style_cache_unref (GtkCssNodeStyleCache *cache)
   if (cache->ref_count > 0)
     return;
 
+  g_hash_table_remove (all_caches, cache);
+
   g_object_unref (cache->style);
   if (cache->children)
     g_hash_table_unref (cache->children);
+  if (cache->sibling_children)
+    g_hash_table_unref (cache->sibling_children);
 
   g_slice_free (GtkCssNodeStyleCache, cache);
 }
@@ -74,7 +106,41 @@ gtk_css_node_style_cache_get_style (GtkCssNodeStyleCache *cache)
   return cache->style;
 }
 
-static gboolean
+void
+gtk_css_node_style_cache_get_stats (GtkCssNodeStyleCacheStats *out_stats)
+{
+  *out_stats = stats;
+}
+
+/* Drops all cached children, for when a style provider changed
+ * and the cached styles may be outdated. */
+void
+gtk_css_node_style_cache_flush (void)
+{
+  GHashTableIter iter;
+  GtkCssNodeStyleCache *cache;
+  GSList *caches = NULL, *l;
+
+  if (all_caches == NULL)
+    return;
+
+  /* Clearing the children may free caches, which modifies the table */
+  g_hash_table_iter_init (&iter, all_caches);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &cache, NULL))
+    caches = g_slist_prepend (caches, gtk_css_node_style_cache_ref (cache));
+
+  for (l = caches; l; l = l->next)
+    {
+      cache = l->data;
+
+      g_clear_pointer (&cache->children, g_hash_table_unref);
+      g_clear_pointer (&cache->sibling_children, g_hash_table_unref);
+    }
+
+  g_slist_free_full (caches, (GDestroyNotify) gtk_css_node_style_cache_unref);
+}
+
+static GtkCssNodeStyleCacheKind
 may_be_stored_in_cache (GtkCssStyle *style)
 {
   GtkCssChange change;
@@ -88,27 +154,28 @@ may_be_stored_in_cache (GtkCssStyle *style)
    */
 #ifdef G_ENABLE_DEBUG
   if (GTK_DEBUG_CHECK (NO_CSS_CACHE))
-    return FALSE;
+    return GTK_CSS_NODE_STYLE_CACHE_NONE;
 #endif
 
   if (!GTK_IS_CSS_STATIC_STYLE (style))
-    return FALSE;
+    return GTK_CSS_NODE_STYLE_CACHE_NONE;
 
   change = gtk_css_static_style_get_change (GTK_CSS_STATIC_STYLE (style));
 
-  /* The cache is shared between all children of the parent, so if a
-   * style depends on a sibling it is not independant of the child.
+  /* Counting from the end depends on the siblings that come after
+   * the node, which are not part of any key.
    */
-  if (change & GTK_CSS_CHANGE_ANY_SIBLING)
-    return FALSE;
+  if (change & (GTK_CSS_CHANGE_NTH_LAST_CHILD | GTK_CSS_CHANGE_SIBLING_NTH_LAST_CHILD))
+    return GTK_CSS_NODE_STYLE_CACHE_NONE;
 
-  /* Again, the cache is shared between all children of the parent.
-   * If the position is relevant, no child has the same style.
+  /* The cache is shared between all children of the parent, so if a
+   * style depends on a sibling or on the position, it can only be
+   * shared with nodes that are preceded by the same siblings.
    */
-  if (change & (GTK_CSS_CHANGE_NTH_CHILD | GTK_CSS_CHANGE_NTH_LAST_CHILD))
-    return FALSE;
+  if (change & (GTK_CSS_CHANGE_ANY_SIBLING | GTK_CSS_CHANGE_NTH_CHILD))
+    return GTK_CSS_NODE_STYLE_CACHE_SIBLINGS;
 
-  return TRUE;
+  return GTK_CSS_NODE_STYLE_CACHE_CHILD;
 }
 
 static guint
@@ -135,41 +202,169 @@ gtk_css_node_style_cache_decl_free (gpointer item)
   gtk_css_node_declaration_unref (UNPACK_DECLARATION (item));
 }
 
+static guint
+gtk_css_node_style_cache_key_hash (gconstpointer item)
+{
+  const GtkCssNodeStyleCacheKey *key = item;
+  guint i, hash;
+
+  hash = gtk_css_node_declaration_hash (key->decl) << 1 | key->is_last;
+
+  for (i = 0; i < key->n_siblings; i++)
+    hash = hash * 31 + gtk_css_node_declaration_hash (key->siblings[i]);
+
+  return hash;
+}
+
+static gboolean
+gtk_css_node_style_cache_key_equal (gconstpointer item1,
+                                    gconstpointer item2)
+{
+  const GtkCssNodeStyleCacheKey *key1 = item1;
+  const GtkCssNodeStyleCacheKey *key2 = item2;
+  guint i;
+
+  if (key1->is_last != key2->is_last ||
+      key1->n_siblings != key2->n_siblings)
+    return FALSE;
+
+  if (!gtk_css_node_declaration_equal (key1->decl, key2->decl))
+    return FALSE;
+
+  for (i = 0; i < key1->n_siblings; i++)
+    {
+      if (!gtk_css_node_declaration_equal (key1->siblings[i], key2->siblings[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gtk_css_node_style_cache_key_free (gpointer item)
+{
+  GtkCssNodeStyleCacheKey *key = item;
+  guint i;
+
+  gtk_css_node_declaration_unref (key->decl);
+  for (i = 0; i < key->n_siblings; i++)
+    gtk_css_node_declaration_unref (key->siblings[i]);
+
+  g_slice_free (GtkCssNodeStyleCacheKey, key);
+}
+
+static void
+gtk_css_node_style_cache_key_init (GtkCssNodeStyleCacheKey      *key,
+                                   const GtkCssNodeDeclaration  *decl,
+                                   gboolean                      is_last,
+                                   GtkCssNodeDeclaration       **siblings,
+                                   guint                         n_siblings)
+{
+  key->decl = (GtkCssNodeDeclaration *) decl;
+  key->is_last = is_last ? 1 : 0;
+  key->n_siblings = n_siblings;
+  memcpy (key->siblings, siblings, n_siblings * sizeof (GtkCssNodeDeclaration *));
+}
+
+/* @siblings are the declarations of the visible siblings preceding
+ * the node, closest first. If there are more than
+ * GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS of them, @n_siblings is larger
+ * than that and styles that depend on siblings are not cached.
+ */
 GtkCssNodeStyleCache *
 gtk_css_node_style_cache_insert (GtkCssNodeStyleCache   *parent,
                                  GtkCssNodeDeclaration  *decl,
                                  gboolean                is_first,
                                  gboolean                is_last,
+                                 GtkCssNodeDeclaration **siblings,
+                                 guint                   n_siblings,
                                  GtkCssStyle            *style)
 {
   GtkCssNodeStyleCache *result;
-
-  if (!may_be_stored_in_cache (style))
-    return NULL;
-
-  if (parent->children == NULL)
-    parent->children = g_hash_table_new_full (gtk_css_node_style_cache_decl_hash,
-                                              gtk_css_node_style_cache_decl_equal,
-                                              gtk_css_node_style_cache_decl_free,
-                                              (GDestroyNotify) gtk_css_node_style_cache_unref);
-
-  result = gtk_css_node_style_cache_new (style);
-
-  g_hash_table_insert (parent->children,
-                       PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
-                       gtk_css_node_style_cache_ref (result));
+  GtkCssNodeStyleCacheKey *key;
+  guint i;
+
+  switch (may_be_stored_in_cache (style))
+    {
+    case GTK_CSS_NODE_STYLE_CACHE_NONE:
+      stats.uncacheable++;
+      return NULL;
+
+    case GTK_CSS_NODE_STYLE_CACHE_CHILD:
+      if (parent->children == NULL)
+        parent->children = g_hash_table_new_full (gtk_css_node_style_cache_decl_hash,
+                                                  gtk_css_node_style_cache_decl_equal,
+                                                  gtk_css_node_style_cache_decl_free,
+                                                  (GDestroyNotify) gtk_css_node_style_cache_unref);
+
+      result = gtk_css_node_style_cache_new (style);
+
+      g_hash_table_insert (parent->children,
+                           PACK (gtk_css_node_declaration_ref (decl), is_first, is_last),
+                           gtk_css_node_style_cache_ref (result));
+      break;
+
+    case GTK_CSS_NODE_STYLE_CACHE_SIBLINGS:
+      if (n_siblings > GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS)
+        {
+          stats.uncacheable++;
+          return NULL;
+        }
+
+      if (parent->sibling_children == NULL)
+        parent->sibling_children = g_hash_table_new_full (gtk_css_node_style_cache_key_hash,
+                                                          gtk_css_node_style_cache_key_equal,
+                                                          gtk_css_node_style_cache_key_free,
+                                                          (GDestroyNotify) gtk_css_node_style_cache_unref);
+
+      result = gtk_css_node_style_cache_new (style);
+
+      key = g_slice_new (GtkCssNodeStyleCacheKey);
+      gtk_css_node_style_cache_key_init (key, decl, is_last, siblings, n_siblings);
+      gtk_css_node_declaration_ref (key->decl);
+      for (i = 0; i < n_siblings; i++)
+        gtk_css_node_declaration_ref (key->siblings[i]);
+
+      g_hash_table_insert (parent->sibling_children,
+                           key,
+                           gtk_css_node_style_cache_ref (result));
+      break;
+
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
 
   return result;
 }
 
 GtkCssNodeStyleCache *
-gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
-                                 const GtkCssNodeDeclaration *decl,
-                                 gboolean                     is_first,
-                                 gboolean                     is_last)
+gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache         *parent,
+                                 const GtkCssNodeDeclaration  *decl,
+                                 gboolean                      is_first,
+                                 gboolean                      is_last,
+                                 GtkCssNodeDeclaration       **siblings,
+                                 guint                         n_siblings)
 {
   GtkCssNodeStyleCache *result;
 
+  stats.lookups++;
+
+  if (parent->sibling_children != NULL &&
+      n_siblings <= GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS)
+    {
+      GtkCssNodeStyleCacheKey key;
+
+      gtk_css_node_style_cache_key_init (&key, decl, is_last, siblings, n_siblings);
+      result = g_hash_table_lookup (parent->sibling_children, &key);
+      if (result)
+        {
+          stats.hits++;
+          stats.sibling_hits++;
+          return gtk_css_node_style_cache_ref (result);
+        }
+    }
+
   if (parent->children == NULL)
     return NULL;
 
@@ -177,6 +372,7 @@ gtk_css_node_style_cache_lookup (GtkCssNodeStyleCache        *parent,
   if (result == NULL)
     return NULL;
 
+  stats.hits++;
+
   return gtk_css_node_style_cache_ref (result);
 }
-
@@ -24,6 +24,18 @@
 G_BEGIN_DECLS
 
 typedef struct _GtkCssNodeStyleCache GtkCssNodeStyleCache;
+typedef struct _GtkCssNodeStyleCacheStats GtkCssNodeStyleCacheStats;
+
+/* Styles depending on siblings are only cached for nodes with
+ * at most this many visible siblings before them */
+#define GTK_CSS_NODE_STYLE_CACHE_MAX_SIBLINGS 8
+
+struct _GtkCssNodeStyleCacheStats {
+  guint lookups;
+  guint hits;
+  guint sibling_hits;
+  guint uncacheable;
+};
 
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_new            (GtkCssStyle            *style);
 GtkCssNodeStyleCache *  gtk_css_node_style_cache_ref            (GtkCssNodeStyleCache   *cache);
@@ -35,11 +47,18 @@ GtkCssNodeStyleCache *  gtk_css_node_style_cache_insert         (GtkCssNodeStyle
                                                                  GtkCssNodeDeclaration  *decl,
                                                                  gboolean                is_first,
                                                                  gboolean                is_last,
+                                                                 GtkCssNodeDeclaration **siblings,
+                                                                 guint                   n_siblings,
                                                                  GtkCssStyle            *style);
-GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup         (GtkCssNodeStyleCache        *parent,
-                                                                 const GtkCssNodeDeclaration *decl,
-                                                                 gboolean                     is_first,
-                                                                 gboolean                     is_last);
+GtkCssNodeStyleCache *  gtk_css_node_style_cache_lookup         (GtkCssNodeStyleCache         *parent,
+                                                                 const GtkCssNodeDeclaration  *decl,
+                                                                 gboolean                      is_first,
+                                                                 gboolean                      is_last,
+                                                                 GtkCssNodeDeclaration       **siblings,
+                                                                 guint                         n_siblings);
+
+void                    gtk_css_node_style_cache_get_stats      (GtkCssNodeStyleCacheStats *stats);
+void                    gtk_css_node_style_cache_flush          (void);
 
 G_END_DECLS
 
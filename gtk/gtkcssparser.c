@@ -278,22 +278,44 @@ gtk_css_parser_skip_comment (GtkCssParser *parser)
 void
 _gtk_css_parser_skip_whitespace (GtkCssParser *parser)
 {
-  size_t len;
+  const char *data = parser->data;
 
-  while (*parser->data)
+  /* This is called after almost every token, so keep it a tight loop
+   * over the buffer instead of going through strspn() and
+   * gtk_css_parser_new_line() for every character. */
+  while (TRUE)
     {
-      if (gtk_css_parser_new_line (parser))
-        continue;
-
-      len = strspn (parser->data, WHITESPACE_CHARS);
-      if (len)
+      switch (*data)
         {
-          parser->data += len;
-          continue;
+        case ' ':
+        case '\t':
+        case '\f':
+          data++;
+          break;
+
+        case '\r':
+          if (data[1] == '\n')
+            data++;
+          /* fall through */
+        case '\n':
+          data++;
+          parser->line++;
+          parser->line_start = data;
+          break;
+
+        case '/':
+          if (data[1] == '*')
+            {
+              parser->data = data;
+              gtk_css_parser_skip_comment (parser);
+              data = parser->data;
+              break;
+            }
+          /* fall through */
+        default:
+          parser->data = data;
+          return;
         }
-      
-      if (!gtk_css_parser_skip_comment (parser))
-        break;
     }
 }
 
@@ -413,26 +435,68 @@ _gtk_css_parser_get_ident (GtkCssParser *parser)
   return result;
 }
 
-char *
-_gtk_css_parser_try_name (GtkCssParser *parser,
+static inline gboolean
+gtk_css_parser_is_nmchar (char c)
+{
+  return g_ascii_isalnum (c) || c == '-' || c == '_';
+}
+
+/* Characters that _gtk_css_parser_read_char() needs to handle specially */
+static inline gboolean
+gtk_css_parser_needs_unescape (char c)
+{
+  return c == '\\' || c >= 127;
+}
+
+/* Reads the remaining characters of a name or identifier starting at
+ * @start. Names without escapes or non-ASCII characters are copied
+ * straight out of the source buffer. */
+static char *
+gtk_css_parser_read_name (GtkCssParser *parser,
+                          const char   *start,
                           gboolean      skip_whitespace)
 {
   GString *name;
+  const char *end;
+  char *result;
 
-  g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
+  end = parser->data;
+  while (gtk_css_parser_is_nmchar (*end))
+    end++;
 
-  if (parser->ident_str == NULL)
-    parser->ident_str = g_string_new (NULL);
+  if (!gtk_css_parser_needs_unescape (*end))
+    {
+      result = g_strndup (start, end - start);
+      parser->data = end;
+    }
+  else
+    {
+      if (parser->ident_str == NULL)
+        parser->ident_str = g_string_new (NULL);
 
-  name = parser->ident_str;
+      name = parser->ident_str;
+      g_string_append_len (name, start, end - start);
+      parser->data = end;
 
-  while (_gtk_css_parser_read_char (parser, name, NMCHAR))
-    ;
+      while (_gtk_css_parser_read_char (parser, name, NMCHAR))
+        ;
+
+      result = _gtk_css_parser_get_ident (parser);
+    }
 
   if (skip_whitespace)
     _gtk_css_parser_skip_whitespace (parser);
 
-  return _gtk_css_parser_get_ident (parser);
+  return result;
+}
+
+char *
+_gtk_css_parser_try_name (GtkCssParser *parser,
+                          gboolean      skip_whitespace)
+{
+  g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
+
+  return gtk_css_parser_read_name (parser, parser->data, skip_whitespace);
 }
 
 char *
@@ -445,7 +509,19 @@ _gtk_css_parser_try_ident (GtkCssParser *parser,
   g_return_val_if_fail (GTK_IS_CSS_PARSER (parser), NULL);
 
   start = parser->data;
-  
+
+  /* Fast path: the identifier starts with a plain ASCII letter */
+  if (g_ascii_isalpha (start[0]))
+    {
+      parser->data++;
+      return gtk_css_parser_read_name (parser, start, skip_whitespace);
+    }
+  else if (start[0] == '-' && g_ascii_isalpha (start[1]))
+    {
+      parser->data += 2;
+      return gtk_css_parser_read_name (parser, start, skip_whitespace);
+    }
+
   if (parser->ident_str == NULL)
     parser->ident_str = g_string_new (NULL);
 
@@ -499,6 +575,20 @@ _gtk_css_parser_read_string (GtkCssParser *parser)
   
   parser->data++;
 
+  /* Fast path: no escapes, so the string can be copied in one go */
+  {
+    gsize len = strcspn (parser->data, "\\'\"\n\r\f");
+
+    if (parser->data[len] == quote)
+      {
+        char *result = g_strndup (parser->data, len);
+
+        parser->data += len + 1;
+        _gtk_css_parser_skip_whitespace (parser);
+        return result;
+      }
+  }
+
   if (parser->ident_str == NULL)
     parser->ident_str = g_string_new (NULL);
 
@@ -0,0 +1,110 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_PROPERTY_SET_PRIVATE_H__
+#define __GTK_CSS_PROPERTY_SET_PRIVATE_H__
+
+#include <string.h>
+
+#include "gtk/gtkcsstypesprivate.h"
+
+G_BEGIN_DECLS
+
+/* A set of CSS style property ids.
+ *
+ * Unlike #GtkBitmask, which has to allocate as soon as it holds bits
+ * beyond the size of a pointer, this is sized for all the style
+ * properties at compile time, so it can live on the stack or inside
+ * other structs.
+ */
+
+#define GTK_CSS_PROPERTY_SET_N_WORDS ((GTK_CSS_PROPERTY_N_PROPERTIES + 63) / 64)
+
+typedef struct _GtkCssPropertySet GtkCssPropertySet;
+
+struct _GtkCssPropertySet {
+  guint64 words[GTK_CSS_PROPERTY_SET_N_WORDS];
+};
+
+static inline void
+gtk_css_property_set_init (GtkCssPropertySet *set)
+{
+  memset (set, 0, sizeof (GtkCssPropertySet));
+}
+
+static inline void
+gtk_css_property_set_init_all (GtkCssPropertySet *set)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    set->words[i] = G_MAXUINT64;
+
+  /* Keep the bits beyond the last property clear */
+  if (GTK_CSS_PROPERTY_N_PROPERTIES % 64)
+    set->words[GTK_CSS_PROPERTY_SET_N_WORDS - 1] = (G_GUINT64_CONSTANT (1) << (GTK_CSS_PROPERTY_N_PROPERTIES % 64)) - 1;
+}
+
+static inline gboolean
+gtk_css_property_set_get (const GtkCssPropertySet *set,
+                          guint                    id)
+{
+  return (set->words[id / 64] >> (id % 64)) & 1;
+}
+
+static inline void
+gtk_css_property_set_add (GtkCssPropertySet *set,
+                          guint              id)
+{
+  set->words[id / 64] |= G_GUINT64_CONSTANT (1) << (id % 64);
+}
+
+static inline void
+gtk_css_property_set_remove (GtkCssPropertySet *set,
+                             guint              id)
+{
+  set->words[id / 64] &= ~(G_GUINT64_CONSTANT (1) << (id % 64));
+}
+
+static inline gboolean
+gtk_css_property_set_is_empty (const GtkCssPropertySet *set)
+{
+  guint64 bits = 0;
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    bits |= set->words[i];
+
+  return bits == 0;
+}
+
+static inline gboolean
+gtk_css_property_set_intersects (const GtkCssPropertySet *set,
+                                 const GtkCssPropertySet *other)
+{
+  guint64 bits = 0;
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_SET_N_WORDS; i++)
+    bits |= set->words[i] & other->words[i];
+
+  return bits != 0;
+}
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_PROPERTY_SET_PRIVATE_H__ */
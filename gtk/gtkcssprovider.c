@@ -25,10 +25,11 @@
 
 #include "gtkcssproviderprivate.h"
 
-#include "gtkbitmaskprivate.h"
+#include "gtkcsspropertysetprivate.h"
 #include "gtkcssarrayvalueprivate.h"
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcsskeyframesprivate.h"
+#include "gtkcssnodeprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcsssectionprivate.h"
 #include "gtkcssselectorprivate.h"
@@ -94,11 +95,26 @@ struct GtkCssRuleset
   GtkCssSelector *selector;
   GtkCssSelectorTree *selector_match;
   PropertyValue *styles;
-  GtkBitmask *set_styles;
+  GtkCssPropertySet set_styles;
   guint n_styles;
   guint owns_styles : 1;
+  GtkCssSelectorBucket bucket;
+  gpointer bucket_key;
 };
 
+typedef struct {
+  GtkCssSelectorBucket bucket;
+  gpointer key;
+  char *text;
+} GtkCssProviderSnapshotRule;
+
+/* The printed contents of a provider, used to find out which
+ * rules changed when the provider is reloaded */
+typedef struct {
+  char *globals;
+  GArray *rules;
+} GtkCssProviderSnapshot;
+
 struct _GtkCssScanner
 {
   GtkCssProvider *provider;
@@ -117,6 +133,10 @@ struct _GtkCssProviderPrivate
 
   GArray *rulesets;
   GtkCssSelectorTree *tree;
+  /* rulesets partitioned by their rightmost ID, class or name, see
+   * _gtk_css_selector_get_bucket().  Used to only match the rules
+   * that can apply to a node. */
+  GHashTable *buckets[GTK_CSS_SELECTOR_N_BUCKETS];
   GResource *resource;
   gchar *path;
 };
@@ -135,6 +155,71 @@ static void gtk_css_style_provider_iface_init (GtkStyleProviderInterface *iface)
 static void gtk_css_style_provider_emit_error (GtkStyleProvider *provider,
                                                GtkCssSection    *section,
                                                const GError     *error);
+static void gtk_css_ruleset_print (const GtkCssRuleset *ruleset,
+                                   GString             *str);
+static void gtk_css_provider_print_colors (GHashTable *colors,
+                                           GString    *str);
+static void gtk_css_provider_print_keyframes (GHashTable *keyframes,
+                                              GString    *str);
+
+/* Returns the NUL-terminated contents of @file. Resources and compiled
+ * stylesheets, which include the terminating NUL, are not copied.
+ */
+static GBytes *
+gtk_css_provider_load_bytes (GFile   *file,
+                             GError **error)
+{
+  char *data;
+  gsize length;
+
+  if (g_file_has_uri_scheme (file, "resource"))
+    {
+      char *uri, *path;
+      GBytes *bytes;
+
+      uri = g_file_get_uri (file);
+      path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
+      bytes = g_resources_lookup_data (path, 0, error);
+      g_free (path);
+      g_free (uri);
+
+      /* resource data is always NUL-terminated */
+      return bytes;
+    }
+
+  if (g_file_is_native (file))
+    {
+      GMappedFile *mapped;
+      char *path;
+
+      path = g_file_get_path (file);
+      mapped = g_mapped_file_new (path, FALSE, NULL);
+      g_free (path);
+
+      if (mapped)
+        {
+          GBytes *bytes = NULL;
+
+          data = g_mapped_file_get_contents (mapped);
+          length = g_mapped_file_get_length (mapped);
+
+          if (length > strlen (GTK_CSS_COMPILED_HEADER) &&
+              data[length - 1] == '\0' &&
+              strncmp (data, GTK_CSS_COMPILED_HEADER, strlen (GTK_CSS_COMPILED_HEADER)) == 0)
+            bytes = g_mapped_file_get_bytes (mapped);
+
+          g_mapped_file_unref (mapped);
+
+          if (bytes)
+            return bytes;
+        }
+    }
+
+  if (!g_file_load_contents (file, NULL, &data, &length, NULL, error))
+    return NULL;
+
+  return g_bytes_new_take (data, length + 1);
+}
 
 static void
 gtk_css_provider_load_internal (GtkCssProvider *css_provider,
@@ -239,8 +324,6 @@ gtk_css_ruleset_init_copy (GtkCssRuleset       *new,
   /* First copy takes over ownership */
   if (ruleset->owns_styles)
     ruleset->owns_styles = FALSE;
-  if (new->set_styles)
-    new->set_styles = _gtk_bitmask_copy (new->set_styles);
 }
 
 static void
@@ -259,8 +342,6 @@ gtk_css_ruleset_clear (GtkCssRuleset *ruleset)
         }
       g_free (ruleset->styles);
     }
-  if (ruleset->set_styles)
-    _gtk_bitmask_free (ruleset->set_styles);
   if (ruleset->selector)
     _gtk_css_selector_free (ruleset->selector);
 
@@ -277,12 +358,8 @@ gtk_css_ruleset_add (GtkCssRuleset       *ruleset,
 
   g_return_if_fail (ruleset->owns_styles || ruleset->n_styles == 0);
 
-  if (ruleset->set_styles == NULL)
-    ruleset->set_styles = _gtk_bitmask_new ();
-
-  ruleset->set_styles = _gtk_bitmask_set (ruleset->set_styles,
-                                          _gtk_css_style_property_get_id (property),
-                                          TRUE);
+  gtk_css_property_set_add (&ruleset->set_styles,
+                            _gtk_css_style_property_get_id (property));
 
   ruleset->owns_styles = TRUE;
 
@@ -429,11 +506,17 @@ static void
 gtk_css_provider_init (GtkCssProvider *css_provider)
 {
   GtkCssProviderPrivate *priv;
+  guint i;
 
   priv = css_provider->priv = gtk_css_provider_get_instance_private (css_provider);
 
   priv->rulesets = g_array_new (FALSE, FALSE, sizeof (GtkCssRuleset));
 
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    priv->buckets[i] = g_hash_table_new_full (NULL, NULL,
+                                              NULL,
+                                              (GDestroyNotify) _gtk_css_selector_tree_free);
+
   priv->symbolic_colors = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                  (GDestroyNotify) g_free,
                                                  (GDestroyNotify) _gtk_css_value_unref);
@@ -552,6 +635,50 @@ gtk_css_style_provider_get_keyframes (GtkStyleProvider *provider,
   return g_hash_table_lookup (css_provider->priv->keyframes, name);
 }
 
+static void
+gtk_css_provider_match_bucket (GtkCssProvider       *css_provider,
+                               GtkCssSelectorBucket  bucket,
+                               gconstpointer         key,
+                               const GtkCssMatcher  *matcher,
+                               GPtrArray           **tree_rules)
+{
+  GtkCssSelectorTree *tree;
+
+  tree = g_hash_table_lookup (css_provider->priv->buckets[bucket], key);
+  if (tree)
+    _gtk_css_selector_tree_add_matches (tree, matcher, tree_rules);
+}
+
+static GPtrArray *
+gtk_css_provider_match_all (GtkCssProvider      *css_provider,
+                            const GtkCssMatcher *matcher)
+{
+  GPtrArray *tree_rules = NULL;
+  GtkCssNode *node;
+  const GQuark *classes;
+  const char *id;
+  guint i, n_classes;
+
+  /* Other matchers can't tell us their keys */
+  if (!_gtk_css_matcher_is_node (matcher))
+    return _gtk_css_selector_tree_match_all (css_provider->priv->tree, matcher);
+
+  node = matcher->node.node;
+
+  gtk_css_provider_match_bucket (css_provider, GTK_CSS_SELECTOR_BUCKET_UNIVERSAL, NULL, matcher, &tree_rules);
+  gtk_css_provider_match_bucket (css_provider, GTK_CSS_SELECTOR_BUCKET_NAME, gtk_css_node_get_name (node), matcher, &tree_rules);
+
+  id = gtk_css_node_get_id (node);
+  if (id)
+    gtk_css_provider_match_bucket (css_provider, GTK_CSS_SELECTOR_BUCKET_ID, id, matcher, &tree_rules);
+
+  classes = gtk_css_node_list_classes (node, &n_classes);
+  for (i = 0; i < n_classes; i++)
+    gtk_css_provider_match_bucket (css_provider, GTK_CSS_SELECTOR_BUCKET_CLASS, GUINT_TO_POINTER (classes[i]), matcher, &tree_rules);
+
+  return tree_rules;
+}
+
 static void
 gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
                                const GtkCssMatcher *matcher,
@@ -568,7 +695,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
   css_provider = GTK_CSS_PROVIDER (provider);
   priv = css_provider->priv;
 
-  tree_rules = _gtk_css_selector_tree_match_all (priv->tree, matcher);
+  tree_rules = gtk_css_provider_match_all (css_provider, matcher);
   if (tree_rules)
     {
       verify_tree_match_results (css_provider, matcher, tree_rules);
@@ -580,8 +707,8 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
           if (ruleset->styles == NULL)
             continue;
 
-          if (!_gtk_bitmask_intersects (_gtk_css_lookup_get_missing (lookup),
-                                        ruleset->set_styles))
+          if (!gtk_css_property_set_intersects (_gtk_css_lookup_get_missing (lookup),
+                                                &ruleset->set_styles))
           continue;
 
           for (j = 0; j < ruleset->n_styles; j++)
@@ -598,7 +725,7 @@ gtk_css_style_provider_lookup (GtkStyleProvider    *provider,
                                   ruleset->styles[j].value);
             }
 
-          if (_gtk_bitmask_is_empty (_gtk_css_lookup_get_missing (lookup)))
+          if (gtk_css_property_set_is_empty (_gtk_css_lookup_get_missing (lookup)))
             break;
         }
 
@@ -640,6 +767,8 @@ gtk_css_provider_finalize (GObject *object)
 
   g_array_free (priv->rulesets, TRUE);
   _gtk_css_selector_tree_free (priv->tree);
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    g_hash_table_destroy (priv->buckets[i]);
 
   g_hash_table_destroy (priv->symbolic_colors);
   g_hash_table_destroy (priv->keyframes);
@@ -781,6 +910,8 @@ gtk_css_provider_reset (GtkCssProvider *css_provider)
   g_array_set_size (priv->rulesets, 0);
   _gtk_css_selector_tree_free (priv->tree);
   priv->tree = NULL;
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    g_hash_table_remove_all (priv->buckets[i]);
 
 }
 
@@ -1341,6 +1472,54 @@ gtk_css_provider_compare_rule (gconstpointer a_,
   return 0;
 }
 
+static void
+gtk_css_provider_build_buckets (GtkCssProvider *css_provider)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  GHashTable *builders[GTK_CSS_SELECTOR_N_BUCKETS];
+  GtkCssSelectorTreeBuilder *builder;
+  GtkCssSelectorBucket bucket;
+  GHashTableIter iter;
+  gpointer key;
+  guint i;
+
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    builders[i] = g_hash_table_new_full (NULL, NULL,
+                                         NULL,
+                                         (GDestroyNotify) _gtk_css_selector_tree_builder_free);
+
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset;
+
+      ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      bucket = _gtk_css_selector_get_bucket (ruleset->selector, &key);
+      ruleset->bucket = bucket;
+      ruleset->bucket_key = key;
+      builder = g_hash_table_lookup (builders[bucket], key);
+      if (builder == NULL)
+        {
+          builder = _gtk_css_selector_tree_builder_new ();
+          g_hash_table_insert (builders[bucket], key, builder);
+        }
+
+      _gtk_css_selector_tree_builder_add (builder,
+                                          ruleset->selector,
+                                          NULL,
+                                          ruleset);
+    }
+
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    {
+      g_hash_table_iter_init (&iter, builders[i]);
+      while (g_hash_table_iter_next (&iter, &key, (gpointer *) &builder))
+        g_hash_table_insert (priv->buckets[i], key, _gtk_css_selector_tree_builder_build (builder));
+
+      g_hash_table_destroy (builders[i]);
+    }
+}
+
 static void
 gtk_css_provider_postprocess (GtkCssProvider *css_provider)
 {
@@ -1366,6 +1545,8 @@ gtk_css_provider_postprocess (GtkCssProvider *css_provider)
   priv->tree = _gtk_css_selector_tree_builder_build (builder);
   _gtk_css_selector_tree_builder_free (builder);
 
+  gtk_css_provider_build_buckets (css_provider);
+
 #ifndef VERIFY_TREE
   for (i = 0; i < priv->rulesets->len; i++)
     {
@@ -1386,17 +1567,16 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 const char     *text)
 {
   GtkCssScanner *scanner;
-  char *free_data = NULL;
+  GBytes *bytes = NULL;
 
   if (text == NULL)
     {
       GError *load_error = NULL;
 
-      if (g_file_load_contents (file, NULL,
-                                &free_data, NULL,
-                                NULL, &load_error))
+      bytes = gtk_css_provider_load_bytes (file, &load_error);
+      if (bytes)
         {
-          text = free_data;
+          text = g_bytes_get_data (bytes, NULL);
         }
       else
         {
@@ -1445,7 +1625,220 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
         gtk_css_provider_postprocess (css_provider);
     }
 
-  g_free (free_data);
+  if (bytes)
+    g_bytes_unref (bytes);
+}
+
+static GtkCssProviderSnapshot *
+gtk_css_provider_snapshot_new (GtkCssProvider *css_provider)
+{
+  GtkCssProviderPrivate *priv = css_provider->priv;
+  GtkCssProviderSnapshot *snapshot;
+  GString *str;
+  guint i;
+
+  snapshot = g_slice_new (GtkCssProviderSnapshot);
+
+  str = g_string_new (NULL);
+  gtk_css_provider_print_colors (priv->symbolic_colors, str);
+  gtk_css_provider_print_keyframes (priv->keyframes, str);
+  snapshot->globals = g_string_free (str, FALSE);
+
+  snapshot->rules = g_array_sized_new (FALSE, FALSE, sizeof (GtkCssProviderSnapshotRule), priv->rulesets->len);
+  str = g_string_new (NULL);
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      GtkCssProviderSnapshotRule rule;
+
+      g_string_truncate (str, 0);
+      gtk_css_ruleset_print (ruleset, str);
+
+      rule.bucket = ruleset->bucket;
+      rule.key = ruleset->bucket_key;
+      rule.text = g_strdup (str->str);
+      g_array_append_val (snapshot->rules, rule);
+    }
+  g_string_free (str, TRUE);
+
+  return snapshot;
+}
+
+static void
+gtk_css_provider_snapshot_free (GtkCssProviderSnapshot *snapshot)
+{
+  guint i;
+
+  for (i = 0; i < snapshot->rules->len; i++)
+    g_free (g_array_index (snapshot->rules, GtkCssProviderSnapshotRule, i).text);
+  g_array_free (snapshot->rules, TRUE);
+  g_free (snapshot->globals);
+
+  g_slice_free (GtkCssProviderSnapshot, snapshot);
+}
+
+static void
+gtk_css_provider_string_free (gpointer str)
+{
+  g_string_free (str, TRUE);
+}
+
+/* Concatenates the rules of every bucket key, in order */
+static void
+gtk_css_provider_snapshot_collect (GtkCssProviderSnapshot *snapshot,
+                                   GHashTable             *by_key[GTK_CSS_SELECTOR_N_BUCKETS])
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    by_key[i] = g_hash_table_new_full (NULL, NULL, NULL, gtk_css_provider_string_free);
+
+  for (i = 0; i < snapshot->rules->len; i++)
+    {
+      GtkCssProviderSnapshotRule *rule = &g_array_index (snapshot->rules, GtkCssProviderSnapshotRule, i);
+      GString *str;
+
+      str = g_hash_table_lookup (by_key[rule->bucket], rule->key);
+      if (str == NULL)
+        {
+          str = g_string_new (NULL);
+          g_hash_table_insert (by_key[rule->bucket], rule->key, str);
+        }
+
+      g_string_append (str, rule->text);
+    }
+}
+
+static void
+gtk_css_provider_diff_buckets (GtkStyleProviderChange *change,
+                               GtkCssSelectorBucket    bucket,
+                               GHashTable             *a,
+                               GHashTable             *b)
+{
+  GHashTableIter iter;
+  gpointer key;
+  GString *str, *other;
+
+  g_hash_table_iter_init (&iter, a);
+  while (g_hash_table_iter_next (&iter, &key, (gpointer *) &str))
+    {
+      other = g_hash_table_lookup (b, key);
+      if (other == NULL || !g_string_equal (str, other))
+        gtk_style_provider_change_add (change, bucket, key);
+    }
+}
+
+static gboolean
+gtk_css_provider_snapshot_rule_changed (const GtkStyleProviderChange     *change,
+                                        const GtkCssProviderSnapshotRule *rule)
+{
+  return gtk_style_provider_change_contains (change, rule->bucket, rule->key);
+}
+
+/* Returns the elements affected when going from @old to @new, or
+ * %NULL if all elements may be affected */
+static GtkStyleProviderChange *
+gtk_css_provider_snapshot_diff (GtkCssProviderSnapshot *old,
+                                GtkCssProviderSnapshot *new)
+{
+  GtkStyleProviderChange *change;
+  GHashTable *old_keys[GTK_CSS_SELECTOR_N_BUCKETS];
+  GHashTable *new_keys[GTK_CSS_SELECTOR_N_BUCKETS];
+  guint i, j;
+
+  /* Colors and keyframes are referenced by name from anywhere */
+  if (!g_str_equal (old->globals, new->globals))
+    return NULL;
+
+  gtk_css_provider_snapshot_collect (old, old_keys);
+  gtk_css_provider_snapshot_collect (new, new_keys);
+
+  change = gtk_style_provider_change_new ();
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    {
+      gtk_css_provider_diff_buckets (change, i, old_keys[i], new_keys[i]);
+      gtk_css_provider_diff_buckets (change, i, new_keys[i], old_keys[i]);
+      g_hash_table_destroy (old_keys[i]);
+      g_hash_table_destroy (new_keys[i]);
+    }
+
+  if (g_hash_table_size (change->keys[GTK_CSS_SELECTOR_BUCKET_UNIVERSAL]) > 0)
+    {
+      gtk_style_provider_change_free (change);
+      return NULL;
+    }
+
+  /* The order of rules with equal specificity decides which one wins, so the
+   * unchanged rules must still be in the same order. */
+  i = j = 0;
+  while (TRUE)
+    {
+      GtkCssProviderSnapshotRule *old_rule = NULL, *new_rule = NULL;
+
+      for (; i < old->rules->len; i++)
+        {
+          old_rule = &g_array_index (old->rules, GtkCssProviderSnapshotRule, i);
+          if (!gtk_css_provider_snapshot_rule_changed (change, old_rule))
+            break;
+          old_rule = NULL;
+        }
+
+      for (; j < new->rules->len; j++)
+        {
+          new_rule = &g_array_index (new->rules, GtkCssProviderSnapshotRule, j);
+          if (!gtk_css_provider_snapshot_rule_changed (change, new_rule))
+            break;
+          new_rule = NULL;
+        }
+
+      if (old_rule == NULL && new_rule == NULL)
+        break;
+
+      if (old_rule == NULL || new_rule == NULL ||
+          !g_str_equal (old_rule->text, new_rule->text))
+        {
+          gtk_style_provider_change_free (change);
+          return NULL;
+        }
+
+      i++;
+      j++;
+    }
+
+  return change;
+}
+
+/* Reloads the provider and only restyles the elements that may be affected
+ * by the rules that changed. This makes live editing of big stylesheets,
+ * like in the inspector, a lot cheaper. */
+static void
+gtk_css_provider_reload (GtkCssProvider *css_provider,
+                         GFile          *file,
+                         const char     *text)
+{
+  GtkCssProviderSnapshot *old_snapshot = NULL, *new_snapshot;
+  GtkStyleProviderChange *change = NULL;
+
+  /* Use a full restyle for the initial load, everything changes anyway */
+  if (css_provider->priv->rulesets->len > 0)
+    old_snapshot = gtk_css_provider_snapshot_new (css_provider);
+
+  gtk_css_provider_reset (css_provider);
+
+  gtk_css_provider_load_internal (css_provider, NULL, file, text);
+
+  if (old_snapshot)
+    {
+      new_snapshot = gtk_css_provider_snapshot_new (css_provider);
+      change = gtk_css_provider_snapshot_diff (old_snapshot, new_snapshot);
+      gtk_css_provider_snapshot_free (new_snapshot);
+      gtk_css_provider_snapshot_free (old_snapshot);
+    }
+
+  gtk_style_provider_changed_partial (GTK_STYLE_PROVIDER (css_provider), change);
+
+  if (change)
+    gtk_style_provider_change_free (change);
 }
 
 /**
@@ -1480,13 +1873,9 @@ gtk_css_provider_load_from_data (GtkCssProvider  *css_provider,
       data = free_data;
     }
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, NULL, data);
+  gtk_css_provider_reload (css_provider, NULL, data);
 
   g_free (free_data);
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
 }
 
 /**
@@ -1504,11 +1893,7 @@ gtk_css_provider_load_from_file (GtkCssProvider  *css_provider,
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (G_IS_FILE (file));
 
-  gtk_css_provider_reset (css_provider);
-
-  gtk_css_provider_load_internal (css_provider, NULL, file, NULL);
-
-  gtk_style_provider_changed (GTK_STYLE_PROVIDER (css_provider));
+  gtk_css_provider_reload (css_provider, file, NULL);
 }
 
 /**
@@ -22,6 +22,12 @@
 
 G_BEGIN_DECLS
 
+/* Compiled stylesheets, as written by gtk4-css-tool, start with this
+ * comment, so that they stay valid CSS. They are NUL-terminated on disk,
+ * so they can be parsed straight from a mapped file.
+ */
+#define GTK_CSS_COMPILED_HEADER "/* GTK compiled stylesheet, format 1 */\n"
+
 gchar *_gtk_get_theme_dir (void);
 
 const gchar *_gtk_css_provider_get_theme_dir (GtkCssProvider *provider);
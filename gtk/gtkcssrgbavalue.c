@@ -22,14 +22,22 @@
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkstylecontextprivate.h"
 
+#include "fallback-c89.c"
+
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
   GdkRGBA rgba;
 };
 
+/* All RGBA values are interned here, so equal values share one instance */
+static GHashTable *rgba_values;
+
 static void
 gtk_css_value_rgba_free (GtkCssValue *value)
 {
+  if (g_hash_table_lookup (rgba_values, value) == value)
+    g_hash_table_remove (rgba_values, value);
+
   g_slice_free (GtkCssValue, value);
 }
 
@@ -50,6 +58,14 @@ gtk_css_value_rgba_equal (const GtkCssValue *rgba1,
   return gdk_rgba_equal (&rgba1->rgba, &rgba2->rgba);
 }
 
+static guint
+gtk_css_value_rgba_hash (gconstpointer item)
+{
+  const GtkCssValue *value = item;
+
+  return gdk_rgba_hash (&value->rgba);
+}
+
 static inline double
 transition (double start,
             double end,
@@ -108,13 +124,29 @@ static const GtkCssValueClass GTK_CSS_VALUE_RGBA = {
 GtkCssValue *
 _gtk_css_rgba_value_new_from_rgba (const GdkRGBA *rgba)
 {
+  GtkCssValue key = { &GTK_CSS_VALUE_RGBA, 1, };
   GtkCssValue *value;
 
   g_return_val_if_fail (rgba != NULL, NULL);
 
+  key.rgba = *rgba;
+
+  if (rgba_values == NULL)
+    rgba_values = g_hash_table_new (gtk_css_value_rgba_hash,
+                                    (GEqualFunc) gtk_css_value_rgba_equal);
+
+  value = g_hash_table_lookup (rgba_values, &key);
+  if (value)
+    return _gtk_css_value_ref (value);
+
   value = _gtk_css_value_new (GtkCssValue, &GTK_CSS_VALUE_RGBA);
   value->rgba = *rgba;
 
+  /* NaN never compares equal, so it can't be found again */
+  if (!isnan (rgba->red) && !isnan (rgba->green) &&
+      !isnan (rgba->blue) && !isnan (rgba->alpha))
+    g_hash_table_add (rgba_values, value);
+
   return value;
 }
 
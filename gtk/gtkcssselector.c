@@ -1361,6 +1361,53 @@ _gtk_css_selector_matches (const GtkCssSelector *selector,
   return gtk_css_selector_foreach (selector, matcher, gtk_css_selector_foreach_match, NULL);
 }
 
+/**
+ * _gtk_css_selector_get_bucket:
+ * @selector: the selector
+ * @key: (out): the key for the bucket
+ *
+ * Determines a key that every element matched by @selector must have.
+ * IDs are preferred over classes and classes over names, because they
+ * are more selective. For the ID and name buckets, @key is the interned
+ * string, for the class bucket it is the #GQuark.
+ *
+ * Returns: the type of key found
+ **/
+GtkCssSelectorBucket
+_gtk_css_selector_get_bucket (const GtkCssSelector *selector,
+                              gpointer             *key)
+{
+  const GtkCssSelector *iter;
+  GtkCssSelectorBucket bucket = GTK_CSS_SELECTOR_BUCKET_UNIVERSAL;
+
+  *key = NULL;
+
+  for (iter = selector;
+       iter && iter->class->is_simple;
+       iter = gtk_css_selector_previous (iter))
+    {
+      if (iter->class == &GTK_CSS_SELECTOR_ID)
+        {
+          *key = (gpointer) iter->id.name;
+          return GTK_CSS_SELECTOR_BUCKET_ID;
+        }
+      else if (iter->class == &GTK_CSS_SELECTOR_CLASS &&
+               bucket != GTK_CSS_SELECTOR_BUCKET_CLASS)
+        {
+          *key = GUINT_TO_POINTER (iter->style_class.style_class);
+          bucket = GTK_CSS_SELECTOR_BUCKET_CLASS;
+        }
+      else if (iter->class == &GTK_CSS_SELECTOR_NAME &&
+               bucket == GTK_CSS_SELECTOR_BUCKET_UNIVERSAL)
+        {
+          *key = (gpointer) iter->name.name;
+          bucket = GTK_CSS_SELECTOR_BUCKET_NAME;
+        }
+    }
+
+  return bucket;
+}
+
 /* Computes specificity according to CSS 2.1.
  * The arguments must be initialized to 0 */
 static void
@@ -1476,6 +1523,36 @@ gtk_css_selectors_skip_initial_selector (GtkCssSelector *selector, const GtkCssS
   return (GtkCssSelector *)gtk_css_selector_previous (selector);
 }
 
+/* Checks if any of the selectors that must match an ancestor of a
+ * descendant combinator can possibly match one according to @filter.
+ */
+static gboolean
+gtk_css_selector_tree_may_match_ancestors (const GtkCssSelectorTree   *tree,
+                                           const GtkCssAncestorFilter *filter)
+{
+  const GtkCssSelectorTree *prev;
+  guint hash;
+
+  for (prev = gtk_css_selector_tree_get_previous (tree);
+       prev != NULL;
+       prev = gtk_css_selector_tree_get_sibling (prev))
+    {
+      if (prev->selector.class == &GTK_CSS_SELECTOR_NAME)
+        hash = _gtk_css_ancestor_filter_hash_name (prev->selector.name.name);
+      else if (prev->selector.class == &GTK_CSS_SELECTOR_CLASS)
+        hash = _gtk_css_ancestor_filter_hash_class (prev->selector.style_class.style_class);
+      else if (prev->selector.class == &GTK_CSS_SELECTOR_ID)
+        hash = _gtk_css_ancestor_filter_hash_id (prev->selector.id.name);
+      else
+        return TRUE;
+
+      if (_gtk_css_ancestor_filter_may_contain (filter, hash))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 static gboolean
 gtk_css_selector_tree_match_foreach (const GtkCssSelector *selector,
                                      const GtkCssMatcher  *matcher,
@@ -1483,16 +1560,27 @@ gtk_css_selector_tree_match_foreach (const GtkCssSelector *selector,
 {
   const GtkCssSelectorTree *tree = (const GtkCssSelectorTree *) selector;
   const GtkCssSelectorTree *prev;
+  const GtkCssAncestorFilter *filter;
 
   if (!gtk_css_selector_match (selector, matcher))
     return FALSE;
 
   gtk_css_selector_tree_found_match (tree, res);
 
+  filter = _gtk_css_matcher_get_ancestor_filter (matcher);
+
   for (prev = gtk_css_selector_tree_get_previous (tree);
        prev != NULL;
        prev = gtk_css_selector_tree_get_sibling (prev))
-    gtk_css_selector_foreach (&prev->selector, matcher, gtk_css_selector_tree_match_foreach, res);
+    {
+      /* Avoid walking all parents if no ancestor can match */
+      if (filter &&
+          prev->selector.class == &GTK_CSS_SELECTOR_DESCENDANT &&
+          !gtk_css_selector_tree_may_match_ancestors (prev, filter))
+        continue;
+
+      gtk_css_selector_foreach (&prev->selector, matcher, gtk_css_selector_tree_match_foreach, res);
+    }
 
   return FALSE;
 }
@@ -1503,13 +1591,24 @@ _gtk_css_selector_tree_match_all (const GtkCssSelectorTree *tree,
 {
   GPtrArray *array = NULL;
 
-  for (; tree != NULL;
-       tree = gtk_css_selector_tree_get_sibling (tree))
-    gtk_css_selector_foreach (&tree->selector, matcher, gtk_css_selector_tree_match_foreach, &array);
+  _gtk_css_selector_tree_add_matches (tree, matcher, &array);
 
   return array;
 }
 
+/* Like _gtk_css_selector_tree_match_all(), but adds the matches to
+ * @array, keeping it sorted. @array may point to %NULL.
+ */
+void
+_gtk_css_selector_tree_add_matches (const GtkCssSelectorTree  *tree,
+                                    const GtkCssMatcher       *matcher,
+                                    GPtrArray                **array)
+{
+  for (; tree != NULL;
+       tree = gtk_css_selector_tree_get_sibling (tree))
+    gtk_css_selector_foreach (&tree->selector, matcher, gtk_css_selector_tree_match_foreach, array);
+}
+
 /* When checking for changes via the tree we need to know if a rule further
    down the tree matched, because if so we need to add "our bit" to the
    Change. For instance in a a match like *.class:active we'll
@@ -27,6 +27,14 @@ typedef union _GtkCssSelector GtkCssSelector;
 typedef struct _GtkCssSelectorTree GtkCssSelectorTree;
 typedef struct _GtkCssSelectorTreeBuilder GtkCssSelectorTreeBuilder;
 
+typedef enum {
+  GTK_CSS_SELECTOR_BUCKET_UNIVERSAL,
+  GTK_CSS_SELECTOR_BUCKET_ID,
+  GTK_CSS_SELECTOR_BUCKET_CLASS,
+  GTK_CSS_SELECTOR_BUCKET_NAME,
+  GTK_CSS_SELECTOR_N_BUCKETS
+} GtkCssSelectorBucket;
+
 GtkCssSelector *  _gtk_css_selector_parse           (GtkCssParser           *parser);
 void              _gtk_css_selector_free            (GtkCssSelector         *selector);
 
@@ -39,10 +47,15 @@ gboolean          _gtk_css_selector_matches         (const GtkCssSelector   *sel
 GtkCssChange      _gtk_css_selector_get_change      (const GtkCssSelector   *selector);
 int               _gtk_css_selector_compare         (const GtkCssSelector   *a,
                                                      const GtkCssSelector   *b);
+GtkCssSelectorBucket _gtk_css_selector_get_bucket   (const GtkCssSelector   *selector,
+                                                     gpointer               *key);
 
 void         _gtk_css_selector_tree_free             (GtkCssSelectorTree       *tree);
 GPtrArray *  _gtk_css_selector_tree_match_all        (const GtkCssSelectorTree *tree,
 						      const GtkCssMatcher      *matcher);
+void         _gtk_css_selector_tree_add_matches      (const GtkCssSelectorTree *tree,
+						      const GtkCssMatcher      *matcher,
+						      GPtrArray               **array);
 GtkCssChange _gtk_css_selector_tree_get_change_all   (const GtkCssSelectorTree *tree,
 						      const GtkCssMatcher *matcher);
 void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *tree,
@@ -26,6 +26,7 @@
 #include "gtkcssenumvalueprivate.h"
 #include "gtkcssinheritvalueprivate.h"
 #include "gtkcssinitialvalueprivate.h"
+#include "gtkcsslookupprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcsssectionprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
@@ -41,6 +42,274 @@
 
 G_DEFINE_TYPE (GtkCssStaticStyle, gtk_css_static_style, GTK_TYPE_CSS_STYLE)
 
+static guint8 property_group[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 property_index[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 group_size[GTK_CSS_N_VALUES_GROUPS];
+static guint8 group_properties[GTK_CSS_N_VALUES_GROUPS][GTK_CSS_PROPERTY_N_PROPERTIES];
+static gboolean group_inherit[GTK_CSS_N_VALUES_GROUPS];
+static GHashTable *interned_values;
+
+static GtkCssValuesGroup
+gtk_css_property_get_group (guint id)
+{
+  switch (id)
+    {
+    case GTK_CSS_PROPERTY_COLOR:
+    case GTK_CSS_PROPERTY_DPI:
+    case GTK_CSS_PROPERTY_FONT_SIZE:
+    case GTK_CSS_PROPERTY_ICON_THEME:
+    case GTK_CSS_PROPERTY_ICON_PALETTE:
+      return GTK_CSS_CORE_VALUES;
+
+    case GTK_CSS_PROPERTY_BACKGROUND_COLOR:
+    case GTK_CSS_PROPERTY_BOX_SHADOW:
+    case GTK_CSS_PROPERTY_BACKGROUND_CLIP:
+    case GTK_CSS_PROPERTY_BACKGROUND_ORIGIN:
+    case GTK_CSS_PROPERTY_BACKGROUND_SIZE:
+    case GTK_CSS_PROPERTY_BACKGROUND_POSITION:
+    case GTK_CSS_PROPERTY_BACKGROUND_REPEAT:
+    case GTK_CSS_PROPERTY_BACKGROUND_IMAGE:
+    case GTK_CSS_PROPERTY_BACKGROUND_BLEND_MODE:
+      return GTK_CSS_BACKGROUND_VALUES;
+
+    case GTK_CSS_PROPERTY_BORDER_TOP_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_TOP_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_STYLE:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH:
+    case GTK_CSS_PROPERTY_BORDER_TOP_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_TOP_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_BORDER_TOP_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_RIGHT_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_BOTTOM_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_LEFT_COLOR:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_SOURCE:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_REPEAT:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_SLICE:
+    case GTK_CSS_PROPERTY_BORDER_IMAGE_WIDTH:
+      return GTK_CSS_BORDER_VALUES;
+
+    case GTK_CSS_PROPERTY_OUTLINE_STYLE:
+    case GTK_CSS_PROPERTY_OUTLINE_WIDTH:
+    case GTK_CSS_PROPERTY_OUTLINE_OFFSET:
+    case GTK_CSS_PROPERTY_OUTLINE_TOP_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_OUTLINE_TOP_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_OUTLINE_BOTTOM_RIGHT_RADIUS:
+    case GTK_CSS_PROPERTY_OUTLINE_BOTTOM_LEFT_RADIUS:
+    case GTK_CSS_PROPERTY_OUTLINE_COLOR:
+      return GTK_CSS_OUTLINE_VALUES;
+
+    case GTK_CSS_PROPERTY_MARGIN_TOP:
+    case GTK_CSS_PROPERTY_MARGIN_LEFT:
+    case GTK_CSS_PROPERTY_MARGIN_BOTTOM:
+    case GTK_CSS_PROPERTY_MARGIN_RIGHT:
+    case GTK_CSS_PROPERTY_PADDING_TOP:
+    case GTK_CSS_PROPERTY_PADDING_LEFT:
+    case GTK_CSS_PROPERTY_PADDING_BOTTOM:
+    case GTK_CSS_PROPERTY_PADDING_RIGHT:
+    case GTK_CSS_PROPERTY_BORDER_SPACING:
+    case GTK_CSS_PROPERTY_MIN_WIDTH:
+    case GTK_CSS_PROPERTY_MIN_HEIGHT:
+      return GTK_CSS_SIZE_VALUES;
+
+    case GTK_CSS_PROPERTY_FONT_FAMILY:
+    case GTK_CSS_PROPERTY_FONT_STYLE:
+    case GTK_CSS_PROPERTY_FONT_WEIGHT:
+    case GTK_CSS_PROPERTY_FONT_STRETCH:
+    case GTK_CSS_PROPERTY_LETTER_SPACING:
+    case GTK_CSS_PROPERTY_TEXT_SHADOW:
+    case GTK_CSS_PROPERTY_CARET_COLOR:
+    case GTK_CSS_PROPERTY_SECONDARY_CARET_COLOR:
+    case GTK_CSS_PROPERTY_FONT_FEATURE_SETTINGS:
+    case GTK_CSS_PROPERTY_FONT_VARIATION_SETTINGS:
+      return GTK_CSS_FONT_VALUES;
+
+    case GTK_CSS_PROPERTY_TEXT_DECORATION_LINE:
+    case GTK_CSS_PROPERTY_TEXT_DECORATION_COLOR:
+    case GTK_CSS_PROPERTY_TEXT_DECORATION_STYLE:
+    case GTK_CSS_PROPERTY_FONT_KERNING:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_LIGATURES:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_POSITION:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_CAPS:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_NUMERIC:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_ALTERNATES:
+    case GTK_CSS_PROPERTY_FONT_VARIANT_EAST_ASIAN:
+      return GTK_CSS_FONT_VARIANT_VALUES;
+
+    case GTK_CSS_PROPERTY_ICON_SIZE:
+    case GTK_CSS_PROPERTY_ICON_SHADOW:
+    case GTK_CSS_PROPERTY_ICON_STYLE:
+      return GTK_CSS_ICON_VALUES;
+
+    case GTK_CSS_PROPERTY_TRANSITION_PROPERTY:
+    case GTK_CSS_PROPERTY_TRANSITION_DURATION:
+    case GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION:
+    case GTK_CSS_PROPERTY_TRANSITION_DELAY:
+      return GTK_CSS_TRANSITION_VALUES;
+
+    case GTK_CSS_PROPERTY_ANIMATION_NAME:
+    case GTK_CSS_PROPERTY_ANIMATION_DURATION:
+    case GTK_CSS_PROPERTY_ANIMATION_TIMING_FUNCTION:
+    case GTK_CSS_PROPERTY_ANIMATION_ITERATION_COUNT:
+    case GTK_CSS_PROPERTY_ANIMATION_DIRECTION:
+    case GTK_CSS_PROPERTY_ANIMATION_PLAY_STATE:
+    case GTK_CSS_PROPERTY_ANIMATION_DELAY:
+    case GTK_CSS_PROPERTY_ANIMATION_FILL_MODE:
+      return GTK_CSS_ANIMATION_VALUES;
+
+    case GTK_CSS_PROPERTY_ICON_SOURCE:
+    case GTK_CSS_PROPERTY_ICON_TRANSFORM:
+    case GTK_CSS_PROPERTY_ICON_FILTER:
+    case GTK_CSS_PROPERTY_OPACITY:
+    case GTK_CSS_PROPERTY_FILTER:
+    case GTK_CSS_PROPERTY_GTK_KEY_BINDINGS:
+      return GTK_CSS_OTHER_VALUES;
+
+    default:
+      g_assert_not_reached ();
+      return GTK_CSS_OTHER_VALUES;
+    }
+}
+
+static guint
+gtk_css_values_hash (gconstpointer data)
+{
+  const GtkCssValues *values = data;
+
+  return values->hash;
+}
+
+static gboolean
+gtk_css_values_equal (gconstpointer data1,
+                      gconstpointer data2)
+{
+  const GtkCssValues *values1 = data1;
+  const GtkCssValues *values2 = data2;
+  guint i, n;
+
+  if (values1->group != values2->group ||
+      values1->hash != values2->hash)
+    return FALSE;
+
+  n = group_size[values1->group];
+
+  /* Computed values are mostly shared, so comparing pointers
+   * catches the common case without the cost of a deep compare.
+   */
+  for (i = 0; i < n; i++)
+    {
+      if (values1->values[i] != values2->values[i])
+        return FALSE;
+    }
+
+  if (values1->sections == NULL || values2->sections == NULL)
+    return values1->sections == values2->sections;
+
+  for (i = 0; i < n; i++)
+    {
+      if (values1->sections[i] != values2->sections[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GtkCssValues *
+gtk_css_values_new (GtkCssValuesGroup group)
+{
+  GtkCssValues *values;
+
+  values = g_malloc0 (sizeof (GtkCssValues) + (group_size[group] - 1) * sizeof (GtkCssValue *));
+  values->ref_count = 1;
+  values->group = group;
+
+  return values;
+}
+
+static GtkCssValues *
+gtk_css_values_ref (GtkCssValues *values)
+{
+  values->ref_count++;
+
+  return values;
+}
+
+static void
+gtk_css_values_unref (GtkCssValues *values)
+{
+  guint i, n;
+
+  values->ref_count--;
+  if (values->ref_count > 0)
+    return;
+
+  if (values->interned)
+    g_hash_table_remove (interned_values, values);
+
+  n = group_size[values->group];
+  for (i = 0; i < n; i++)
+    {
+      if (values->values[i])
+        _gtk_css_value_unref (values->values[i]);
+    }
+
+  if (values->sections)
+    {
+      for (i = 0; i < n; i++)
+        {
+          if (values->sections[i])
+            gtk_css_section_unref (values->sections[i]);
+        }
+      g_free (values->sections);
+    }
+
+  g_free (values);
+}
+
+static void
+gtk_css_values_compute_hash (GtkCssValues *values)
+{
+  guint i, n, hash;
+
+  n = group_size[values->group];
+  hash = values->group;
+  for (i = 0; i < n; i++)
+    hash = (hash << 5) - hash + GPOINTER_TO_UINT (values->values[i]);
+  if (values->sections)
+    {
+      for (i = 0; i < n; i++)
+        hash = (hash << 5) - hash + GPOINTER_TO_UINT (values->sections[i]);
+    }
+  values->hash = hash;
+}
+
+/* Takes ownership of @values and returns an equal group that
+ * may be shared with other styles.
+ */
+static GtkCssValues *
+gtk_css_values_intern (GtkCssValues *values)
+{
+  GtkCssValues *interned;
+
+  interned = g_hash_table_lookup (interned_values, values);
+  if (interned)
+    {
+      gtk_css_values_ref (interned);
+      gtk_css_values_unref (values);
+      return interned;
+    }
+
+  values->interned = TRUE;
+  g_hash_table_add (interned_values, values);
+
+  return values;
+}
+
 static GtkCssValue *
 gtk_css_static_style_get_value (GtkCssStyle *style,
                                 guint        id)
@@ -48,7 +317,7 @@ gtk_css_static_style_get_value (GtkCssStyle *style,
   /* This is called a lot, so we avoid a dynamic type check here */
   GtkCssStaticStyle *sstyle = (GtkCssStaticStyle *) style;
 
-  return sstyle->values[id];
+  return sstyle->groups[property_group[id]]->values[property_index[id]];
 }
 
 static GtkCssSection *
@@ -56,12 +325,13 @@ gtk_css_static_style_get_section (GtkCssStyle *style,
                                     guint        id)
 {
   GtkCssStaticStyle *sstyle = GTK_CSS_STATIC_STYLE (style);
+  GtkCssValues *values;
 
-  if (sstyle->sections == NULL ||
-      id >= sstyle->sections->len)
+  values = sstyle->groups[property_group[id]];
+  if (values == NULL || values->sections == NULL)
     return NULL;
 
-  return g_ptr_array_index (sstyle->sections, id);
+  return values->sections[property_index[id]];
 }
 
 static void
@@ -70,15 +340,13 @@ gtk_css_static_style_dispose (GObject *object)
   GtkCssStaticStyle *style = GTK_CSS_STATIC_STYLE (object);
   guint i;
 
-  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
-    {
-      if (style->values[i])
-        _gtk_css_value_unref (style->values[i]);
-    }
-  if (style->sections)
+  for (i = 0; i < GTK_CSS_N_VALUES_GROUPS; i++)
     {
-      g_ptr_array_unref (style->sections);
-      style->sections = NULL;
+      if (style->groups[i])
+        {
+          gtk_css_values_unref (style->groups[i]);
+          style->groups[i] = NULL;
+        }
     }
 
   G_OBJECT_CLASS (gtk_css_static_style_parent_class)->dispose (object);
@@ -89,23 +357,35 @@ gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkCssStyleClass *style_class = GTK_CSS_STYLE_CLASS (klass);
+  guint i, group;
 
   object_class->dispose = gtk_css_static_style_dispose;
 
   style_class->get_value = gtk_css_static_style_get_value;
   style_class->get_section = gtk_css_static_style_get_section;
-}
 
-static void
-gtk_css_static_style_init (GtkCssStaticStyle *style)
-{
+  for (i = 0; i < GTK_CSS_N_VALUES_GROUPS; i++)
+    group_inherit[i] = TRUE;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      group = gtk_css_property_get_group (i);
+
+      property_group[i] = group;
+      property_index[i] = group_size[group];
+      group_properties[group][group_size[group]] = i;
+      group_size[group]++;
+
+      if (!_gtk_css_style_property_is_inherit (_gtk_css_style_property_lookup_by_id (i)))
+        group_inherit[group] = FALSE;
+    }
+
+  interned_values = g_hash_table_new (gtk_css_values_hash, gtk_css_values_equal);
 }
 
 static void
-maybe_unref_section (gpointer section)
+gtk_css_static_style_init (GtkCssStaticStyle *style)
 {
-  if (section)
-    gtk_css_section_unref (section);
 }
 
 static void
@@ -114,24 +394,105 @@ gtk_css_static_style_set_value (GtkCssStaticStyle *style,
                                 GtkCssValue       *value,
                                 GtkCssSection     *section)
 {
-  if (style->values[id])
-    _gtk_css_value_unref (style->values[id]);
-  style->values[id] = _gtk_css_value_ref (value);
+  GtkCssValues *values;
+  guint group, index;
+
+  group = property_group[id];
+  index = property_index[id];
+
+  values = style->groups[group];
+  if (values == NULL)
+    {
+      values = gtk_css_values_new (group);
+      style->groups[group] = values;
+    }
+
+  /* Groups are only written to while the style is computed,
+   * before they get interned.
+   */
+  g_assert (!values->interned);
+
+  if (values->values[index])
+    _gtk_css_value_unref (values->values[index]);
+  values->values[index] = _gtk_css_value_ref (value);
 
-  if (style->sections && style->sections->len > id && g_ptr_array_index (style->sections, id))
+  if (values->sections && values->sections[index])
     {
-      gtk_css_section_unref (g_ptr_array_index (style->sections, id));
-      g_ptr_array_index (style->sections, id) = NULL;
+      gtk_css_section_unref (values->sections[index]);
+      values->sections[index] = NULL;
     }
 
   if (section)
     {
-      if (style->sections == NULL)
-        style->sections = g_ptr_array_new_with_free_func (maybe_unref_section);
-      if (style->sections->len <= id)
-        g_ptr_array_set_size (style->sections, id + 1);
+      if (values->sections == NULL)
+        values->sections = g_new0 (GtkCssSection *, group_size[group]);
+
+      values->sections[index] = gtk_css_section_ref (section);
+    }
+}
+
+/* Inherited groups that the lookup doesn't touch at all are
+ * identical to the parent's, so we take them by reference and
+ * mark their properties as not needing computation.
+ */
+static void
+gtk_css_static_style_share_groups (GtkCssStaticStyle *style,
+                                   GtkCssLookup      *lookup,
+                                   GtkCssStaticStyle *parent)
+{
+  guint group, i, id;
+
+  for (group = 0; group < GTK_CSS_N_VALUES_GROUPS; group++)
+    {
+      if (!group_inherit[group])
+        continue;
+
+      for (i = 0; i < group_size[group]; i++)
+        {
+          id = group_properties[group][i];
+          if (lookup->values[id].value != NULL ||
+              !gtk_css_property_set_get (&lookup->missing, id))
+            break;
+        }
+
+      if (i < group_size[group])
+        continue;
+
+      style->groups[group] = gtk_css_values_ref (parent->groups[group]);
+      for (i = 0; i < group_size[group]; i++)
+        gtk_css_property_set_remove (&lookup->missing, group_properties[group][i]);
+    }
+}
+
+static void
+gtk_css_static_style_intern_groups (GtkCssStaticStyle *style,
+                                    GtkCssStaticStyle *parent)
+{
+  guint group;
+
+  for (group = 0; group < GTK_CSS_N_VALUES_GROUPS; group++)
+    {
+      GtkCssValues *values = style->groups[group];
+
+      if (values->interned)
+        continue;
 
-      g_ptr_array_index (style->sections, id) = gtk_css_section_ref (section);
+      gtk_css_values_compute_hash (values);
+
+      /* Cheap check first: most groups end up equal to the parent's */
+      if (parent)
+        {
+          GtkCssValues *parent_values = parent->groups[group];
+
+          if (gtk_css_values_equal (values, parent_values))
+            {
+              style->groups[group] = gtk_css_values_ref (parent_values);
+              gtk_css_values_unref (values);
+              continue;
+            }
+        }
+
+      style->groups[group] = gtk_css_values_intern (values);
     }
 }
 
@@ -166,37 +527,80 @@ gtk_css_static_style_get_default (void)
   return default_style;
 }
 
-GtkCssStyle *
-gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
-                                  const GtkCssMatcher *matcher,
-                                  GtkCssStyle         *parent)
+/**
+ * gtk_css_static_style_lookup:
+ * @provider: the provider to look up in
+ * @matcher: (allow-none): the matcher for the node
+ * @lookup: (out caller-allocates): the lookup to initialize
+ * @change: (out): the change for the resulting style
+ *
+ * Does the selector matching part of computing a style. This only
+ * reads the provider and node tree, so unlike the rest of the style
+ * computation it may be done on a different thread.
+ * Pass the result to gtk_css_static_style_new_from_lookup() and
+ * destroy @lookup afterwards.
+ **/
+void
+gtk_css_static_style_lookup (GtkStyleProvider    *provider,
+                             const GtkCssMatcher *matcher,
+                             GtkCssLookup        *lookup,
+                             GtkCssChange        *change)
 {
-  GtkCssStaticStyle *result;
-  GtkCssLookup lookup;
-  GtkCssChange change = GTK_CSS_CHANGE_ANY_SELF | GTK_CSS_CHANGE_ANY_SIBLING | GTK_CSS_CHANGE_ANY_PARENT;
+  *change = GTK_CSS_CHANGE_ANY_SELF | GTK_CSS_CHANGE_ANY_SIBLING | GTK_CSS_CHANGE_ANY_PARENT;
 
-  _gtk_css_lookup_init (&lookup, NULL);
+  _gtk_css_lookup_init (lookup);
 
   if (matcher)
     gtk_style_provider_lookup (provider,
                                matcher,
-                               &lookup,
-                               &change);
+                               lookup,
+                               change);
+}
+
+GtkCssStyle *
+gtk_css_static_style_new_from_lookup (GtkStyleProvider *provider,
+                                      GtkCssLookup     *lookup,
+                                      GtkCssChange      change,
+                                      GtkCssStyle      *parent)
+{
+  GtkCssStaticStyle *result;
 
   result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
 
   result->change = change;
 
-  _gtk_css_lookup_resolve (&lookup,
+  if (GTK_IS_CSS_STATIC_STYLE (parent))
+    gtk_css_static_style_share_groups (result, lookup, GTK_CSS_STATIC_STYLE (parent));
+
+  _gtk_css_lookup_resolve (lookup,
                            provider,
                            result,
                            parent);
 
-  _gtk_css_lookup_destroy (&lookup);
+  gtk_css_static_style_intern_groups (result,
+                                      GTK_IS_CSS_STATIC_STYLE (parent) ? GTK_CSS_STATIC_STYLE (parent) : NULL);
 
   return GTK_CSS_STYLE (result);
 }
 
+GtkCssStyle *
+gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
+                                  const GtkCssMatcher *matcher,
+                                  GtkCssStyle         *parent)
+{
+  GtkCssStyle *result;
+  GtkCssLookup lookup;
+  GtkCssChange change;
+
+  gtk_css_static_style_lookup (provider, matcher, &lookup, &change);
+
+  result = gtk_css_static_style_new_from_lookup (provider, &lookup, change, parent);
+
+  _gtk_css_lookup_destroy (&lookup);
+
+  return result;
+}
+
 void
 gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
                                     GtkStyleProvider  *provider,
@@ -227,7 +631,15 @@ gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
         specified = _gtk_css_initial_value_new ();
     }
   else
-    _gtk_css_value_ref (specified);
+    {
+      /* Changes to compositor properties are not propagated to children,
+       * unless they explicitly inherit them. */
+      if (specified == _gtk_css_inherit_value_get () &&
+          _gtk_css_style_property_is_compositor (_gtk_css_style_property_lookup_by_id (id)))
+        style->inherits_compositor = TRUE;
+
+      _gtk_css_value_ref (specified);
+    }
 
   value = _gtk_css_value_compute (specified, id, provider, GTK_CSS_STYLE (style), parent_style);
 
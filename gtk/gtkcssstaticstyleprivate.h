@@ -34,15 +34,46 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssStaticStyle           GtkCssStaticStyle;
 typedef struct _GtkCssStaticStyleClass      GtkCssStaticStyleClass;
+typedef struct _GtkCssValues                GtkCssValues;
+
+/* Properties are stored in groups of related values. Groups are
+ * refcounted and interned, so styles that only differ in a few
+ * properties share all other groups.
+ */
+typedef enum {
+  GTK_CSS_CORE_VALUES,
+  GTK_CSS_BACKGROUND_VALUES,
+  GTK_CSS_BORDER_VALUES,
+  GTK_CSS_OUTLINE_VALUES,
+  GTK_CSS_SIZE_VALUES,
+  GTK_CSS_FONT_VALUES,
+  GTK_CSS_FONT_VARIANT_VALUES,
+  GTK_CSS_ICON_VALUES,
+  GTK_CSS_TRANSITION_VALUES,
+  GTK_CSS_ANIMATION_VALUES,
+  GTK_CSS_OTHER_VALUES,
+  /* add more */
+  GTK_CSS_N_VALUES_GROUPS
+} GtkCssValuesGroup;
+
+struct _GtkCssValues
+{
+  guint                  ref_count;
+  guint                  group : 8;            /* GtkCssValuesGroup */
+  guint                  interned : 1;
+  guint                  hash;
+  GtkCssSection        **sections;             /* sections the values are defined in or %NULL */
+  GtkCssValue           *values[1];            /* the values */
+};
 
 struct _GtkCssStaticStyle
 {
   GtkCssStyle parent;
 
-  GtkCssValue           *values[GTK_CSS_PROPERTY_N_PROPERTIES]; /* the values */
-  GPtrArray             *sections;             /* sections the values are defined in */
+  GtkCssValues          *groups[GTK_CSS_N_VALUES_GROUPS];
 
   GtkCssChange           change;               /* change as returned by value lookup */
+  guint                  inherits_compositor : 1; /* a compositor property is explicitly inherited */
 };
 
 struct _GtkCssStaticStyleClass
@@ -56,6 +87,14 @@ GtkCssStyle *           gtk_css_static_style_get_default        (void);
 GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvider       *provider,
                                                                  const GtkCssMatcher    *matcher,
                                                                  GtkCssStyle            *parent);
+void                    gtk_css_static_style_lookup             (GtkStyleProvider       *provider,
+                                                                 const GtkCssMatcher    *matcher,
+                                                                 struct _GtkCssLookup   *lookup,
+                                                                 GtkCssChange           *change);
+GtkCssStyle *           gtk_css_static_style_new_from_lookup    (GtkStyleProvider       *provider,
+                                                                 struct _GtkCssLookup   *lookup,
+                                                                 GtkCssChange            change,
+                                                                 GtkCssStyle            *parent);
 
 void                    gtk_css_static_style_compute_value      (GtkCssStaticStyle      *style,
                                                                  GtkStyleProvider       *provider,
@@ -39,6 +39,8 @@
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+#include "gdk/gdk-private.h"
+
 G_DEFINE_ABSTRACT_TYPE (GtkCssStyle, gtk_css_style, G_TYPE_OBJECT)
 
 static GtkCssSection *
@@ -54,9 +56,42 @@ gtk_css_style_real_is_static (GtkCssStyle *style)
   return TRUE;
 }
 
+/* Only used from constructed and finalize: during instance init,
+ * G_OBJECT_TYPE() may still be the type of a parent class */
+static gsize
+gtk_css_style_get_instance_size (GObject *object)
+{
+  GTypeQuery query;
+
+  g_type_query (G_OBJECT_TYPE (object), &query);
+
+  return query.instance_size;
+}
+
+static void
+gtk_css_style_constructed (GObject *object)
+{
+  G_OBJECT_CLASS (gtk_css_style_parent_class)->constructed (object);
+
+  gdk_memory_stats_alloc (GDK_MEMORY_CSS_STYLES, gtk_css_style_get_instance_size (object));
+}
+
+static void
+gtk_css_style_finalize (GObject *object)
+{
+  gdk_memory_stats_free (GDK_MEMORY_CSS_STYLES, gtk_css_style_get_instance_size (object));
+
+  G_OBJECT_CLASS (gtk_css_style_parent_class)->finalize (object);
+}
+
 static void
 gtk_css_style_class_init (GtkCssStyleClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->constructed = gtk_css_style_constructed;
+  object_class->finalize = gtk_css_style_finalize;
+
   klass->get_section = gtk_css_style_real_get_section;
   klass->is_static = gtk_css_style_real_is_static;
 }
@@ -32,7 +32,7 @@ gtk_css_style_change_init (GtkCssStyleChange *change,
   change->n_compared = 0;
 
   change->affects = 0;
-  change->changes = _gtk_bitmask_new ();
+  gtk_css_property_set_init (&change->changes);
   
   /* Make sure we don't do extra work if old and new are equal. */
   if (old_style == new_style)
@@ -44,7 +44,6 @@ gtk_css_style_change_finish (GtkCssStyleChange *change)
 {
   g_object_unref (change->old_style);
   g_object_unref (change->new_style);
-  _gtk_bitmask_free (change->changes);
 }
 
 GtkCssStyle *
@@ -69,7 +68,7 @@ gtk_css_style_compare_next_value (GtkCssStyleChange *change)
                              gtk_css_style_get_value (change->new_style, change->n_compared)))
     {
       change->affects |= _gtk_css_style_property_get_affects (_gtk_css_style_property_lookup_by_id (change->n_compared));
-      change->changes = _gtk_bitmask_set (change->changes, change->n_compared, TRUE);
+      gtk_css_property_set_add (&change->changes, change->n_compared);
     }
 
   change->n_compared++;
@@ -81,7 +80,7 @@ gboolean
 gtk_css_style_change_has_change (GtkCssStyleChange *change)
 {
   do {
-    if (!_gtk_bitmask_is_empty (change->changes))
+    if (!gtk_css_property_set_is_empty (&change->changes))
       return TRUE;
   } while (gtk_css_style_compare_next_value (change));
 
@@ -107,7 +106,7 @@ gtk_css_style_change_changes_property (GtkCssStyleChange *change,
   while (change->n_compared <= id)
     gtk_css_style_compare_next_value (change);
 
-  return _gtk_bitmask_get (change->changes, id);
+  return gtk_css_property_set_get (&change->changes, id);
 }
 
 void
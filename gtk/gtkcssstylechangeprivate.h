@@ -19,6 +19,7 @@
 #define __GTK_CSS_STYLE_CHANGE_PRIVATE_H__
 
 #include "gtkcssstyleprivate.h"
+#include "gtkcsspropertysetprivate.h"
 
 G_BEGIN_DECLS
 
@@ -30,8 +31,8 @@ struct _GtkCssStyleChange {
 
   guint          n_compared;
 
-  GtkCssAffects  affects;
-  GtkBitmask    *changes;
+  GtkCssAffects      affects;
+  GtkCssPropertySet  changes;
 };
 
 void            gtk_css_style_change_init               (GtkCssStyleChange      *change,
@@ -321,6 +321,34 @@ _gtk_css_style_property_is_animated (GtkCssStyleProperty *property)
   return property->animated;
 }
 
+/**
+ * _gtk_css_style_property_is_compositor:
+ * @property: the property
+ *
+ * Queries if the given @property only affects how the finished
+ * rendering of an element is composited. These properties are not
+ * inherited and no other property depends on them, so changing them
+ * only affects the element itself.
+ *
+ * Returns: %TRUE if the property is a compositor property.
+ **/
+gboolean
+_gtk_css_style_property_is_compositor (GtkCssStyleProperty *property)
+{
+  gtk_internal_return_val_if_fail (GTK_IS_CSS_STYLE_PROPERTY (property), FALSE);
+
+  switch (property->id)
+    {
+    case GTK_CSS_PROPERTY_OPACITY:
+    case GTK_CSS_PROPERTY_FILTER:
+    case GTK_CSS_PROPERTY_ICON_TRANSFORM:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
 /**
  * _gtk_css_style_property_get_affects:
  * @property: the property
@@ -69,6 +69,7 @@ GtkCssStyleProperty *   _gtk_css_style_property_lookup_by_id    (guint
 
 gboolean                _gtk_css_style_property_is_inherit      (GtkCssStyleProperty    *property);
 gboolean                _gtk_css_style_property_is_animated     (GtkCssStyleProperty    *property);
+gboolean                _gtk_css_style_property_is_compositor   (GtkCssStyleProperty    *property);
 GtkCssAffects           _gtk_css_style_property_get_affects     (GtkCssStyleProperty    *property);
 gboolean                _gtk_css_style_property_affects_size    (GtkCssStyleProperty    *property);
 gboolean                _gtk_css_style_property_affects_font    (GtkCssStyleProperty    *property);
@@ -22,6 +22,7 @@
 #include "gtkcsstransitionprivate.h"
 
 #include "gtkcsseasevalueprivate.h"
+#include "gtkcssstylepropertyprivate.h"
 #include "gtkprogresstrackerprivate.h"
 
 G_DEFINE_TYPE (GtkCssTransition, _gtk_css_transition, GTK_TYPE_STYLE_ANIMATION)
@@ -97,6 +98,14 @@ gtk_css_transition_is_static (GtkStyleAnimation *animation)
   return gtk_progress_tracker_get_state (&transition->tracker) == GTK_PROGRESS_STATE_AFTER;
 }
 
+static gboolean
+gtk_css_transition_is_compositor (GtkStyleAnimation *animation)
+{
+  GtkCssTransition *transition = GTK_CSS_TRANSITION (animation);
+
+  return _gtk_css_style_property_is_compositor (_gtk_css_style_property_lookup_by_id (transition->property));
+}
+
 static void
 gtk_css_transition_finalize (GObject *object)
 {
@@ -120,6 +129,7 @@ _gtk_css_transition_class_init (GtkCssTransitionClass *klass)
   animation_class->apply_values = gtk_css_transition_apply_values;
   animation_class->is_finished = gtk_css_transition_is_finished;
   animation_class->is_static = gtk_css_transition_is_static;
+  animation_class->is_compositor = gtk_css_transition_is_compositor;
 }
 
 static void
@@ -30,7 +30,10 @@
 #include "gtkstylecontext.h"
 #include "gtkwidgetprivate.h"
 
+#include <gdk/gdktextureprivate.h>
+
 typedef struct _GtkDrawingAreaPrivate GtkDrawingAreaPrivate;
+typedef struct _DrawJob DrawJob;
 
 struct _GtkDrawingAreaPrivate {
   int content_width;
@@ -39,12 +42,38 @@ struct _GtkDrawingAreaPrivate {
   GtkDrawingAreaDrawFunc draw_func;
   gpointer draw_func_target;
   GDestroyNotify draw_func_target_destroy_notify;
+
+  /* for threaded drawing */
+  guint threaded : 1;
+  guint texture_is_new : 1;     /* the texture hasn't been shown yet */
+  guint redraw_pending : 1;     /* a redraw was queued while drawing */
+  DrawJob *job;                 /* the drawing in progress, if any */
+  GdkTexture *texture;          /* the last finished drawing */
+  int texture_width;
+  int texture_height;
+  int texture_scale;
+};
+
+/* Everything the draw function needs in the thread, so that it
+ * does not have to look at the drawing area. */
+struct _DrawJob {
+  GtkDrawingAreaDrawFunc draw_func;
+  gpointer draw_func_target;
+  /* set if the draw function was replaced while it was drawing */
+  GDestroyNotify draw_func_target_destroy_notify;
+  gboolean stale;
+
+  cairo_surface_t *surface;
+  int width;
+  int height;
+  int scale;
 };
 
 enum {
   PROP_0,
   PROP_CONTENT_WIDTH,
   PROP_CONTENT_HEIGHT,
+  PROP_THREADED,
   LAST_PROP
 };
 
@@ -141,6 +170,19 @@ static GParamSpec *props[LAST_PROP] = { NULL, };
  *
  * If you need more complex control over your widget, you should consider
  * creating your own #GtkWidget subclass.
+ *
+ * # Threaded drawing
+ *
+ * Draw functions that take long, like the ones of plots with many points,
+ * block the handling of input while they run. With
+ * gtk_drawing_area_set_threaded(), the draw function is called in a
+ * worker thread instead, to draw into an image surface. Until it is done,
+ * the drawing area keeps showing what was drawn before.
+ *
+ * In that case, the draw function must be thread-safe: it must not call
+ * any GTK+ functions, including on the drawing area it gets passed, and
+ * must protect the data it draws from changes by the main thread. Only
+ * one call of the draw function runs at a time.
  */
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkDrawingArea, gtk_drawing_area, GTK_TYPE_WIDGET)
@@ -163,6 +205,10 @@ gtk_drawing_area_set_property (GObject      *gobject,
       gtk_drawing_area_set_content_height (self, g_value_get_int (value));
       break;
 
+    case PROP_THREADED:
+      gtk_drawing_area_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -187,23 +233,56 @@ gtk_drawing_area_get_property (GObject    *gobject,
       g_value_set_int (value, priv->content_height);
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, priv->threaded);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
 }
 
 static void
-gtk_drawing_area_dispose (GObject *object)
+draw_job_free (gpointer data)
+{
+  DrawJob *job = data;
+
+  if (job->draw_func_target_destroy_notify != NULL)
+    job->draw_func_target_destroy_notify (job->draw_func_target);
+
+  cairo_surface_destroy (job->surface);
+
+  g_slice_free (DrawJob, job);
+}
+
+/* Frees the target of the draw function, or leaves that to the
+ * job that is still using it. */
+static void
+gtk_drawing_area_clear_draw_func (GtkDrawingArea *self)
 {
-  GtkDrawingArea *self = GTK_DRAWING_AREA (object);
   GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
 
-  if (priv->draw_func_target_destroy_notify != NULL)
+  if (priv->job && !priv->job->stale)
+    {
+      priv->job->draw_func_target_destroy_notify = priv->draw_func_target_destroy_notify;
+      priv->job->stale = TRUE;
+    }
+  else if (priv->draw_func_target_destroy_notify != NULL)
     priv->draw_func_target_destroy_notify (priv->draw_func_target);
 
   priv->draw_func = NULL;
   priv->draw_func_target = NULL;
   priv->draw_func_target_destroy_notify = NULL;
+}
+
+static void
+gtk_drawing_area_dispose (GObject *object)
+{
+  GtkDrawingArea *self = GTK_DRAWING_AREA (object);
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  gtk_drawing_area_clear_draw_func (self);
+  g_clear_object (&priv->texture);
 
   G_OBJECT_CLASS (gtk_drawing_area_parent_class)->dispose (object);
 }
@@ -230,6 +309,121 @@ gtk_drawing_area_measure (GtkWidget      *widget,
     }
 }
 
+static void
+gtk_drawing_area_draw_thread (GTask        *task,
+                              gpointer      source_object,
+                              gpointer      task_data,
+                              GCancellable *cancellable)
+{
+  DrawJob *job = task_data;
+  cairo_t *cr;
+
+  cr = cairo_create (job->surface);
+  job->draw_func (source_object,
+                  cr,
+                  job->width, job->height,
+                  job->draw_func_target);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (job->surface);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+gtk_drawing_area_draw_done (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      data)
+{
+  GtkDrawingArea *self = GTK_DRAWING_AREA (source);
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+  DrawJob *job = g_task_get_task_data (G_TASK (result));
+
+  g_assert (job == priv->job);
+
+  priv->job = NULL;
+
+  /* Unless the draw function was changed or threading turned off */
+  if (!job->stale && priv->threaded)
+    {
+      g_clear_object (&priv->texture);
+      priv->texture = gdk_texture_new_for_surface (job->surface);
+      priv->texture_width = job->width;
+      priv->texture_height = job->height;
+      priv->texture_scale = job->scale;
+    }
+
+  /* Anything queued while drawing makes the next snapshot
+   * start drawing again */
+  priv->texture_is_new = !job->stale && priv->threaded && !priv->redraw_pending;
+  priv->redraw_pending = FALSE;
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
+
+static void
+gtk_drawing_area_start_job (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+  GtkWidget *widget = GTK_WIDGET (self);
+  DrawJob *job;
+  GTask *task;
+
+  g_assert (priv->job == NULL);
+
+  job = g_slice_new0 (DrawJob);
+  job->draw_func = priv->draw_func;
+  job->draw_func_target = priv->draw_func_target;
+  job->width = gtk_widget_get_width (widget);
+  job->height = gtk_widget_get_height (widget);
+  job->scale = gtk_widget_get_scale_factor (widget);
+  job->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                             job->width * job->scale,
+                                             job->height * job->scale);
+  cairo_surface_set_device_scale (job->surface, job->scale, job->scale);
+
+  priv->job = job;
+
+  task = g_task_new (self, NULL, gtk_drawing_area_draw_done, NULL);
+  g_task_set_source_tag (task, gtk_drawing_area_start_job);
+  g_task_set_task_data (task, job, draw_job_free);
+  g_task_run_in_thread (task, gtk_drawing_area_draw_thread);
+  g_object_unref (task);
+}
+
+static void
+gtk_drawing_area_snapshot_threaded (GtkDrawingArea *self,
+                                    GtkSnapshot    *snapshot,
+                                    int             width,
+                                    int             height)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  /* Every snapshot but the one showing a new result means that
+   * something needs to be drawn again */
+  if (!priv->texture_is_new ||
+      priv->texture_width != width ||
+      priv->texture_height != height ||
+      priv->texture_scale != gtk_widget_get_scale_factor (GTK_WIDGET (self)))
+    {
+      if (priv->job)
+        priv->redraw_pending = TRUE;
+      else
+        gtk_drawing_area_start_job (self);
+    }
+
+  priv->texture_is_new = FALSE;
+
+  if (priv->texture)
+    gtk_snapshot_append_texture (snapshot,
+                                 priv->texture,
+                                 &GRAPHENE_RECT_INIT (
+                                     0, 0,
+                                     priv->texture_width, priv->texture_height
+                                 ),
+                                 "DrawingAreaContents");
+}
+
 static void
 gtk_drawing_area_snapshot (GtkWidget   *widget,
                            GtkSnapshot *snapshot)
@@ -245,6 +439,13 @@ gtk_drawing_area_snapshot (GtkWidget   *widget,
   width = gtk_widget_get_width (widget);
   height = gtk_widget_get_height (widget);
 
+  if (priv->threaded)
+    {
+      if (width > 0 && height > 0)
+        gtk_drawing_area_snapshot_threaded (self, snapshot, width, height);
+      return;
+    }
+
 
   cr = gtk_snapshot_append_cairo (snapshot,
                                   &GRAPHENE_RECT_INIT (
@@ -300,6 +501,21 @@ gtk_drawing_area_class_init (GtkDrawingAreaClass *class)
                       0, G_MAXINT, 0,
                       GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkDrawingArea:threaded
+   *
+   * Whether the draw function is called in a thread.
+   * See gtk_drawing_area_set_threaded() for details.
+   *
+   * Since: 3.94
+   */
+  props[PROP_THREADED] =
+    g_param_spec_boolean ("threaded",
+                          P_("Threaded"),
+                          P_("Whether to draw in a thread"),
+                          FALSE,
+                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, LAST_PROP, props);
 
   gtk_widget_class_set_accessible_role (widget_class, ATK_ROLE_DRAWING_AREA);
@@ -463,8 +679,7 @@ gtk_drawing_area_set_draw_func (GtkDrawingArea         *self,
 
   g_return_if_fail (GTK_IS_DRAWING_AREA (self));
 
-  if (priv->draw_func_target_destroy_notify != NULL)
-    priv->draw_func_target_destroy_notify (priv->draw_func_target);
+  gtk_drawing_area_clear_draw_func (self);
 
   priv->draw_func = draw_func;
   priv->draw_func_target = user_data;
@@ -473,3 +688,62 @@ gtk_drawing_area_set_draw_func (GtkDrawingArea         *self,
   gtk_widget_queue_draw (GTK_WIDGET (self));
 }
 
+/**
+ * gtk_drawing_area_set_threaded:
+ * @self: a #GtkDrawingArea
+ * @threaded: whether to call the draw function in a thread
+ *
+ * Sets whether the draw function of @self is called in a worker thread
+ * to draw into an image surface, instead of during the drawing stage
+ * of GTK+. While it runs, the drawing area shows what was drawn before,
+ * so that long running draw functions don't block the main loop.
+ *
+ * The draw function then must be thread-safe. It must not call any
+ * GTK+ functions, and the data it draws must not be changed while it
+ * runs. Calls of the draw function don't overlap.
+ *
+ * Since: 3.94
+ */
+void
+gtk_drawing_area_set_threaded (GtkDrawingArea *self,
+                               gboolean        threaded)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_return_if_fail (GTK_IS_DRAWING_AREA (self));
+
+  threaded = threaded != FALSE;
+
+  if (priv->threaded == threaded)
+    return;
+
+  priv->threaded = threaded;
+
+  /* A job that is still running finishes on its own */
+  priv->texture_is_new = FALSE;
+  g_clear_object (&priv->texture);
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_THREADED]);
+}
+
+/**
+ * gtk_drawing_area_get_threaded:
+ * @self: a #GtkDrawingArea
+ *
+ * Returns whether the draw function of @self is called in a thread.
+ * See gtk_drawing_area_set_threaded().
+ *
+ * Returns: %TRUE if @self draws in a thread
+ *
+ * Since: 3.94
+ */
+gboolean
+gtk_drawing_area_get_threaded (GtkDrawingArea *self)
+{
+  GtkDrawingAreaPrivate *priv = gtk_drawing_area_get_instance_private (self);
+
+  g_return_val_if_fail (GTK_IS_DRAWING_AREA (self), FALSE);
+
+  return priv->threaded;
+}
@@ -105,6 +105,11 @@ void            gtk_drawing_area_set_draw_func          (GtkDrawingArea
                                                          GtkDrawingAreaDrawFunc  draw_func,
                                                          gpointer                user_data,
                                                          GDestroyNotify          destroy);
+GDK_AVAILABLE_IN_3_94
+void            gtk_drawing_area_set_threaded           (GtkDrawingArea         *self,
+                                                         gboolean                threaded);
+GDK_AVAILABLE_IN_3_94
+gboolean        gtk_drawing_area_get_threaded           (GtkDrawingArea         *self);
 
 G_END_DECLS
 
@@ -33,6 +33,10 @@
 #include "gtkscrolledwindow.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
+#include "gtkwidgetprivate.h"
+
+/* Time to spend on adding emoji per idle callback, in µs */
+#define POPULATE_BUDGET 8000
 
 typedef struct {
   GtkWidget *box;
@@ -41,6 +45,8 @@ typedef struct {
   const char *first;
   gunichar label;
   gboolean empty;
+  int start; /* range of the section's items in the emoji data */
+  int end;
 } EmojiSection;
 
 struct _GtkEmojiChooser
@@ -70,6 +76,15 @@ struct _GtkEmojiChooser
   GtkGesture *body_multi_press;
 
   GVariant *data;
+  int n_items;
+  char **keywords; /* casefolded names of the items */
+  guint8 *matches; /* items matching the search text */
+
+  /* The sections get populated in the background, in order */
+  int n_populated;
+  guint populate_idle;
+  EmojiSection *scroll_section;
+  guint scroll_tick;
 
   GSettings *settings;
 };
@@ -87,12 +102,34 @@ static int signals[LAST_SIGNAL];
 
 G_DEFINE_TYPE (GtkEmojiChooser, gtk_emoji_chooser, GTK_TYPE_POPOVER)
 
+static void
+gtk_emoji_chooser_dispose (GObject *object)
+{
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (object);
+
+  if (chooser->populate_idle)
+    {
+      g_source_remove (chooser->populate_idle);
+      chooser->populate_idle = 0;
+    }
+
+  if (chooser->scroll_tick)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (chooser), chooser->scroll_tick);
+      chooser->scroll_tick = 0;
+    }
+
+  G_OBJECT_CLASS (gtk_emoji_chooser_parent_class)->dispose (object);
+}
+
 static void
 gtk_emoji_chooser_finalize (GObject *object)
 {
   GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (object);
 
   g_variant_unref (chooser->data);
+  g_strfreev (chooser->keywords);
+  g_free (chooser->matches);
   g_object_unref (chooser->settings);
 
   g_clear_object (&chooser->recent_long_press);
@@ -105,29 +142,69 @@ gtk_emoji_chooser_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_emoji_chooser_parent_class)->finalize (object);
 }
 
+static GtkWidget *add_emoji (GtkWidget    *box,
+                             gboolean      prepend,
+                             GVariant     *item,
+                             gunichar      modifier,
+                             GtkEmojiChooser *chooser);
+static void populate_until (GtkEmojiChooser *chooser,
+                            int              end);
+
 static void
-scroll_to_section (GtkButton *button,
-                   gpointer   data)
+animate_to_section (GtkEmojiChooser *chooser,
+                    EmojiSection    *section)
 {
-  EmojiSection *section = data;
-  GtkEmojiChooser *chooser;
   GtkAdjustment *adj;
   GtkAllocation alloc = { 0, 0, 0, 0 };
 
-  chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (GTK_WIDGET (button), GTK_TYPE_EMOJI_CHOOSER));
-
   adj = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (chooser->scrolled_window));
   if (section->heading)
     gtk_widget_get_allocation (section->heading, &alloc);
   gtk_adjustment_animate_to_value (adj, alloc.y);
 }
 
+static gboolean
+scroll_to_section_tick (GtkWidget     *widget,
+                        GdkFrameClock *frame_clock,
+                        gpointer       data)
+{
+  GtkEmojiChooser *chooser = GTK_EMOJI_CHOOSER (widget);
+
+  /* Wait until the heading is where the new items put it */
+  if (gtk_widget_needs_allocate (chooser->scrolled_window))
+    return G_SOURCE_CONTINUE;
+
+  animate_to_section (chooser, chooser->scroll_section);
+  chooser->scroll_section = NULL;
+  chooser->scroll_tick = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
-add_emoji (GtkWidget    *box,
-           gboolean      prepend,
-           GVariant     *item,
-           gunichar      modifier,
-           GtkEmojiChooser *chooser);
+scroll_to_section (GtkButton *button,
+                   gpointer   data)
+{
+  EmojiSection *section = data;
+  GtkEmojiChooser *chooser;
+
+  chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (GTK_WIDGET (button), GTK_TYPE_EMOJI_CHOOSER));
+
+  if (section->start > chooser->n_populated)
+    populate_until (chooser, section->start);
+
+  if (!gtk_widget_needs_allocate (chooser->scrolled_window))
+    {
+      animate_to_section (chooser, section);
+      return;
+    }
+
+  chooser->scroll_section = section;
+  if (chooser->scroll_tick == 0)
+    chooser->scroll_tick = gtk_widget_add_tick_callback (GTK_WIDGET (chooser),
+                                                         scroll_to_section_tick,
+                                                         NULL, NULL);
+}
 
 #define MAX_RECENT (7*3)
 
@@ -330,7 +407,7 @@ popup_menu (GtkWidget *widget,
   return TRUE;
 }
 
-static void
+static GtkWidget *
 add_emoji (GtkWidget    *box,
            gboolean      prepend,
            GVariant     *item,
@@ -380,7 +457,7 @@ add_emoji (GtkWidget    *box,
   if (rect.width >= 2 * width)
     {
       gtk_widget_destroy (label);
-      return;
+      return NULL;
     }
 
   child = gtk_flow_box_child_new ();
@@ -396,49 +473,163 @@ add_emoji (GtkWidget    *box,
 
   gtk_container_add (GTK_CONTAINER (child), label);
   gtk_flow_box_insert (GTK_FLOW_BOX (box), child, prepend ? 0 : -1);
+
+  return child;
+}
+
+static EmojiSection *
+get_section_for_item (GtkEmojiChooser *chooser,
+                      int              index)
+{
+  EmojiSection *sections[] = {
+    &chooser->people,
+    &chooser->body,
+    &chooser->nature,
+    &chooser->food,
+    &chooser->travel,
+    &chooser->activities,
+    &chooser->objects,
+    &chooser->symbols,
+    &chooser->flags,
+  };
+  gsize i;
+
+  for (i = 0; i < G_N_ELEMENTS (sections) - 1; i++)
+    {
+      if (index < sections[i]->end)
+        break;
+    }
+
+  return sections[i];
+}
+
+static void
+populate_next (GtkEmojiChooser *chooser)
+{
+  EmojiSection *section;
+  GtkWidget *child;
+  GVariant *item;
+  int index;
+
+  index = chooser->n_populated++;
+  section = get_section_for_item (chooser, index);
+  item = g_variant_get_child_value (chooser->data, index);
+
+  child = add_emoji (section->box, FALSE, item, 0, chooser);
+  if (child)
+    g_object_set_data (G_OBJECT (child), "emoji-index", GINT_TO_POINTER (index + 1));
+
+  g_variant_unref (item);
 }
 
+static void
+populate_for (GtkEmojiChooser *chooser,
+              gint64           budget)
+{
+  gint64 start;
+
+  start = g_get_monotonic_time ();
+  while (chooser->n_populated < chooser->n_items &&
+         g_get_monotonic_time () - start < budget)
+    populate_next (chooser);
+}
+
+static gboolean
+populate_idle_cb (gpointer data)
+{
+  GtkEmojiChooser *chooser = data;
+
+  populate_for (chooser, POPULATE_BUDGET);
+
+  if (chooser->n_populated < chooser->n_items)
+    return G_SOURCE_CONTINUE;
+
+  chooser->populate_idle = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+populate_until (GtkEmojiChooser *chooser,
+                int              end)
+{
+  end = MIN (end, chooser->n_items);
+
+  while (chooser->n_populated < end)
+    populate_next (chooser);
+
+  if (chooser->n_populated == chooser->n_items && chooser->populate_idle)
+    {
+      g_source_remove (chooser->populate_idle);
+      chooser->populate_idle = 0;
+    }
+}
+
+/* Creating thousands of widgets takes a while, so only the first
+ * section is populated right away. The others follow from an idle,
+ * or when they are scrolled to.
+ */
 static void
 populate_emoji_chooser (GtkEmojiChooser *chooser)
 {
+  EmojiSection *sections[] = {
+    &chooser->people,
+    &chooser->body,
+    &chooser->nature,
+    &chooser->food,
+    &chooser->travel,
+    &chooser->activities,
+    &chooser->objects,
+    &chooser->symbols,
+    &chooser->flags,
+  };
   GBytes *bytes = NULL;
-  GVariantIter iter;
-  GVariant *item;
-  GtkWidget *box;
+  int i;
+  gsize s;
 
   bytes = g_resources_lookup_data ("/org/gtk/libgtk/emoji/emoji.data", 0, NULL);
   chooser->data = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE ("a(auss)"), bytes, TRUE));
+  g_bytes_unref (bytes);
 
-  g_variant_iter_init (&iter, chooser->data);
-  box = chooser->people.box;
-  while ((item = g_variant_iter_next_value (&iter)))
+  chooser->n_items = g_variant_n_children (chooser->data);
+  chooser->keywords = g_new0 (char *, chooser->n_items + 1);
+  chooser->matches = g_new0 (guint8, chooser->n_items);
+
+  /* Find the sections and build the index for searching */
+  sections[0]->start = 0;
+  for (i = 0, s = 0; i < chooser->n_items; i++)
     {
+      GVariant *item;
       const char *name;
 
+      item = g_variant_get_child_value (chooser->data, i);
       g_variant_get_child (item, 1, "&s", &name);
 
-      if (strcmp (name, chooser->body.first) == 0)
-        box = chooser->body.box;
-      else if (strcmp (name, chooser->nature.first) == 0)
-        box = chooser->nature.box;
-      else if (strcmp (name, chooser->food.first) == 0)
-        box = chooser->food.box;
-      else if (strcmp (name, chooser->travel.first) == 0)
-        box = chooser->travel.box;
-      else if (strcmp (name, chooser->activities.first) == 0)
-        box = chooser->activities.box;
-      else if (strcmp (name, chooser->objects.first) == 0)
-        box = chooser->objects.box;
-      else if (strcmp (name, chooser->symbols.first) == 0)
-        box = chooser->symbols.box;
-      else if (strcmp (name, chooser->flags.first) == 0)
-        box = chooser->flags.box;
-
-      add_emoji (box, FALSE, item, 0, chooser);
+      if (s + 1 < G_N_ELEMENTS (sections) &&
+          strcmp (name, sections[s + 1]->first) == 0)
+        {
+          sections[s]->end = i;
+          s++;
+          sections[s]->start = i;
+        }
+
+      chooser->keywords[i] = g_utf8_casefold (name, -1);
       g_variant_unref (item);
     }
 
-  g_bytes_unref (bytes);
+  for (; s < G_N_ELEMENTS (sections); s++)
+    {
+      if (s > 0 && sections[s]->start == 0)
+        sections[s]->start = chooser->n_items;
+      sections[s]->end = chooser->n_items;
+    }
+
+  populate_until (chooser, chooser->people.end);
+
+  if (chooser->n_populated < chooser->n_items)
+    {
+      chooser->populate_idle = g_idle_add (populate_idle_cb, chooser);
+      g_source_set_name_by_id (chooser->populate_idle, "[gtk+] populate_emoji_chooser");
+    }
 }
 
 static void
@@ -462,6 +653,11 @@ adj_value_changed (GtkAdjustment *adj,
   EmojiSection const *select_section = sections[0];
   gsize i;
 
+  /* Don't let scrolling catch up with the population */
+  if (chooser->n_populated < chooser->n_items &&
+      value + 2 * gtk_adjustment_get_page_size (adj) >= gtk_adjustment_get_upper (adj))
+    populate_for (chooser, POPULATE_BUDGET);
+
   /* Figure out which section the current scroll position is within */
   for (i = 0; i < G_N_ELEMENTS (sections); ++i)
     {
@@ -501,16 +697,25 @@ filter_func (GtkFlowBoxChild *child,
   const char *text;
   const char *name;
   gboolean res;
+  int index;
 
   res = TRUE;
 
   chooser = GTK_EMOJI_CHOOSER (gtk_widget_get_ancestor (GTK_WIDGET (child), GTK_TYPE_EMOJI_CHOOSER));
   text = gtk_entry_get_text (GTK_ENTRY (chooser->search_entry));
   emoji_data = (GVariant *) g_object_get_data (G_OBJECT (child), "emoji-data");
+  index = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (child), "emoji-index"));
 
   if (text[0] == 0)
     goto out;
 
+  /* Items from the emoji data were looked up in the index already */
+  if (index > 0)
+    {
+      res = chooser->matches[index - 1];
+      goto out;
+    }
+
   if (!emoji_data)
     goto out;
 
@@ -563,22 +768,67 @@ update_headings (GtkEmojiChooser *chooser)
     gtk_stack_set_visible_child_name (GTK_STACK (chooser->stack), "list");
 }
 
+static void
+update_matches (GtkEmojiChooser *chooser,
+                const char      *text)
+{
+  char *folded;
+  int i;
+
+  folded = g_utf8_casefold (text, -1);
+  for (i = 0; i < chooser->n_items; i++)
+    chooser->matches[i] = strstr (chooser->keywords[i], folded) != NULL;
+  g_free (folded);
+}
+
+/* Sections may not be populated yet, so the index decides whether
+ * they have matches.
+ */
+static void
+update_section (GtkEmojiChooser *chooser,
+                EmojiSection    *section,
+                const char      *text)
+{
+  int i;
+
+  invalidate_section (section);
+
+  section->empty = section->start == section->end;
+  if (text[0] == 0)
+    return;
+
+  section->empty = TRUE;
+  for (i = section->start; i < section->end; i++)
+    {
+      if (chooser->matches[i])
+        {
+          section->empty = FALSE;
+          break;
+        }
+    }
+}
+
 static void
 search_changed (GtkEntry *entry,
                 gpointer  data)
 {
   GtkEmojiChooser *chooser = data;
+  const char *text;
+
+  text = gtk_entry_get_text (entry);
+  if (text[0] != 0)
+    update_matches (chooser, text);
 
   invalidate_section (&chooser->recent);
-  invalidate_section (&chooser->people);
-  invalidate_section (&chooser->body);
-  invalidate_section (&chooser->nature);
-  invalidate_section (&chooser->food);
-  invalidate_section (&chooser->travel);
-  invalidate_section (&chooser->activities);
-  invalidate_section (&chooser->objects);
-  invalidate_section (&chooser->symbols);
-  invalidate_section (&chooser->flags);
+  update_section (chooser, &chooser->people, text);
+  update_section (chooser, &chooser->body, text);
+  update_section (chooser, &chooser->nature, text);
+  update_section (chooser, &chooser->food, text);
+  update_section (chooser, &chooser->travel, text);
+  update_section (chooser, &chooser->activities, text);
+  update_section (chooser, &chooser->objects, text);
+  update_section (chooser, &chooser->symbols, text);
+  update_section (chooser, &chooser->flags, text);
 
   update_headings (chooser);
 }
@@ -676,6 +926,7 @@ gtk_emoji_chooser_class_init (GtkEmojiChooserClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
+  object_class->dispose = gtk_emoji_chooser_dispose;
   object_class->finalize = gtk_emoji_chooser_finalize;
   widget_class->show = gtk_emoji_chooser_show;
 
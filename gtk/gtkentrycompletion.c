@@ -139,6 +139,11 @@ static void     gtk_entry_completion_dispose             (GObject      *object);
 static gboolean gtk_entry_completion_visible_func        (GtkTreeModel       *model,
                                                           GtkTreeIter        *iter,
                                                           gpointer            data);
+static void     gtk_entry_completion_clear_matches       (GtkEntryCompletion *completion);
+static void     gtk_entry_completion_watch_model         (GtkEntryCompletion *completion,
+                                                          GtkTreeModel       *model);
+static void     gtk_entry_completion_unwatch_model       (GtkEntryCompletion *completion);
+static void     gtk_entry_completion_update_matches      (GtkEntryCompletion *completion);
 static gboolean gtk_entry_completion_popup_event         (GtkWidget          *widget,
                                                           GdkEvent           *event,
                                                           gpointer            user_data);
@@ -642,6 +647,7 @@ gtk_entry_completion_set_property (GObject      *object,
 
       case PROP_TEXT_COLUMN:
         priv->text_column = g_value_get_int (value);
+        gtk_entry_completion_clear_matches (completion);
         break;
 
       case PROP_INLINE_COMPLETION:
@@ -752,6 +758,7 @@ gtk_entry_completion_finalize (GObject *object)
 
   g_free (priv->case_normalized_key);
   g_free (priv->completion_prefix);
+  gtk_entry_completion_clear_matches (completion);
 
   if (priv->match_notify)
     (* priv->match_notify) (priv->match_data);
@@ -765,6 +772,12 @@ gtk_entry_completion_dispose (GObject *object)
   GtkEntryCompletion *completion = GTK_ENTRY_COMPLETION (object);
   GtkEntryCompletionPrivate *priv = completion->priv;
 
+  if (priv->filter_model)
+    {
+      gtk_entry_completion_unwatch_model (completion);
+      priv->filter_model = NULL;
+    }
+
   if (priv->tree_view)
     {
       gtk_widget_destroy (priv->tree_view);
@@ -818,6 +831,156 @@ gtk_entry_completion_get_area (GtkCellLayout *cell_layout)
   return priv->cell_area;
 }
 
+/* The default match function of list models is done on a copy of the
+ * text column, normalized and case folded once. Extending the key can
+ * only make the list of matches shorter, so only the rows that matched
+ * the previous key need to be looked at again when the user types.
+ */
+static void
+gtk_entry_completion_clear_matches (GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  g_clear_pointer (&priv->match_strings, g_ptr_array_unref);
+  g_clear_pointer (&priv->matches, g_array_unref);
+  g_clear_pointer (&priv->matched_rows, g_free);
+  g_clear_pointer (&priv->matches_key, g_free);
+}
+
+static void
+gtk_entry_completion_watch_model (GtkEntryCompletion *completion,
+                                  GtkTreeModel       *model)
+{
+  gtk_entry_completion_clear_matches (completion);
+
+  g_signal_connect_swapped (model, "row-changed",
+                            G_CALLBACK (gtk_entry_completion_clear_matches), completion);
+  g_signal_connect_swapped (model, "row-inserted",
+                            G_CALLBACK (gtk_entry_completion_clear_matches), completion);
+  g_signal_connect_swapped (model, "row-deleted",
+                            G_CALLBACK (gtk_entry_completion_clear_matches), completion);
+  g_signal_connect_swapped (model, "rows-reordered",
+                            G_CALLBACK (gtk_entry_completion_clear_matches), completion);
+}
+
+static void
+gtk_entry_completion_unwatch_model (GtkEntryCompletion *completion)
+{
+  GtkTreeModel *model;
+
+  model = gtk_tree_model_filter_get_model (completion->priv->filter_model);
+  g_signal_handlers_disconnect_by_func (model,
+                                        gtk_entry_completion_clear_matches,
+                                        completion);
+
+  gtk_entry_completion_clear_matches (completion);
+}
+
+static gchar *
+case_normalize (const gchar *item)
+{
+  gchar *normalized_string;
+  gchar *case_normalized_string;
+
+  normalized_string = g_utf8_normalize (item, -1, G_NORMALIZE_ALL);
+  if (normalized_string == NULL)
+    return NULL;
+
+  case_normalized_string = g_utf8_casefold (normalized_string, -1);
+  g_free (normalized_string);
+
+  return case_normalized_string;
+}
+
+static gboolean
+key_matches (const gchar *key,
+             gsize        key_len,
+             const gchar *case_normalized_string)
+{
+  return case_normalized_string != NULL &&
+         strncmp (key, case_normalized_string, key_len) == 0;
+}
+
+static void
+gtk_entry_completion_update_matches (GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+  const gchar *key = priv->case_normalized_key;
+  GtkTreeModel *model;
+  gsize key_len;
+  guint i, j;
+
+  if (priv->match_func || priv->text_column < 0 || key == NULL)
+    {
+      gtk_entry_completion_clear_matches (completion);
+      return;
+    }
+
+  model = gtk_tree_model_filter_get_model (priv->filter_model);
+  if ((gtk_tree_model_get_flags (model) & GTK_TREE_MODEL_LIST_ONLY) == 0 ||
+      gtk_tree_model_get_column_type (model, priv->text_column) != G_TYPE_STRING)
+    {
+      gtk_entry_completion_clear_matches (completion);
+      return;
+    }
+
+  key_len = strlen (key);
+
+  if (priv->match_strings == NULL)
+    {
+      GtkTreeIter iter;
+      gboolean valid;
+
+      priv->match_strings = g_ptr_array_new_with_free_func (g_free);
+
+      for (valid = gtk_tree_model_get_iter_first (model, &iter);
+           valid;
+           valid = gtk_tree_model_iter_next (model, &iter))
+        {
+          gchar *item = NULL;
+
+          gtk_tree_model_get (model, &iter, priv->text_column, &item, -1);
+          g_ptr_array_add (priv->match_strings, item ? case_normalize (item) : NULL);
+          g_free (item);
+        }
+
+      priv->matched_rows = g_malloc0 (MAX (priv->match_strings->len, 1));
+    }
+
+  if (priv->matches && g_str_has_prefix (key, priv->matches_key))
+    {
+      for (i = 0, j = 0; i < priv->matches->len; i++)
+        {
+          guint row = g_array_index (priv->matches, guint, i);
+
+          if (key_matches (key, key_len, g_ptr_array_index (priv->match_strings, row)))
+            g_array_index (priv->matches, guint, j++) = row;
+          else
+            priv->matched_rows[row] = FALSE;
+        }
+
+      g_array_set_size (priv->matches, j);
+    }
+  else
+    {
+      if (priv->matches)
+        g_array_set_size (priv->matches, 0);
+      else
+        priv->matches = g_array_new (FALSE, FALSE, sizeof (guint));
+
+      for (i = 0; i < priv->match_strings->len; i++)
+        {
+          priv->matched_rows[i] = key_matches (key, key_len,
+                                               g_ptr_array_index (priv->match_strings, i));
+          if (priv->matched_rows[i])
+            g_array_append_val (priv->matches, i);
+        }
+    }
+
+  g_free (priv->matches_key);
+  priv->matches_key = g_strdup (key);
+}
+
 /* all those callbacks */
 static gboolean
 gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
@@ -826,7 +989,6 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
                                               gpointer            user_data)
 {
   gchar *item = NULL;
-  gchar *normalized_string;
   gchar *case_normalized_string;
 
   gboolean ret = FALSE;
@@ -838,24 +1000,29 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
   g_return_val_if_fail (gtk_tree_model_get_column_type (model, completion->priv->text_column) == G_TYPE_STRING,
                         FALSE);
 
+  if (completion->priv->matches)
+    {
+      GtkTreePath *path;
+      gint row;
+
+      path = gtk_tree_model_get_path (model, iter);
+      row = gtk_tree_path_get_indices (path)[0];
+      gtk_tree_path_free (path);
+
+      if (row >= 0 && (guint) row < completion->priv->match_strings->len &&
+          g_strcmp0 (key, completion->priv->matches_key) == 0)
+        return completion->priv->matched_rows[row];
+    }
+
   gtk_tree_model_get (model, iter,
                       completion->priv->text_column, &item,
                       -1);
 
   if (item != NULL)
     {
-      normalized_string = g_utf8_normalize (item, -1, G_NORMALIZE_ALL);
-
-      if (normalized_string != NULL)
-        {
-          case_normalized_string = g_utf8_casefold (normalized_string, -1);
-
-          if (!strncmp (key, case_normalized_string, strlen (key)))
-            ret = TRUE;
-
-          g_free (case_normalized_string);
-        }
-      g_free (normalized_string);
+      case_normalized_string = case_normalize (item);
+      ret = key_matches (key, strlen (key), case_normalized_string);
+      g_free (case_normalized_string);
     }
   g_free (item);
 
@@ -1088,6 +1255,9 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
   g_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
 
+  if (completion->priv->filter_model)
+    gtk_entry_completion_unwatch_model (completion);
+
   if (!model)
     {
       gtk_tree_view_set_model (GTK_TREE_VIEW (completion->priv->tree_view),
@@ -1097,6 +1267,11 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
       return;
     }
 
+  /* Connect before the filter model does, so that the matches are
+   * dropped before it asks for the visibility of changed rows.
+   */
+  gtk_entry_completion_watch_model (completion, model);
+
   /* code will unref the old filter model (if any) */
   completion->priv->filter_model =
     GTK_TREE_MODEL_FILTER (gtk_tree_model_filter_new (model, NULL));
@@ -1165,6 +1340,8 @@ gtk_entry_completion_set_match_func (GtkEntryCompletion          *completion,
   completion->priv->match_func = func;
   completion->priv->match_data = func_data;
   completion->priv->match_notify = func_notify;
+
+  gtk_entry_completion_clear_matches (completion);
 }
 
 /**
@@ -1242,6 +1419,8 @@ gtk_entry_completion_complete (GtkEntryCompletion *completion)
   completion->priv->case_normalized_key = g_utf8_casefold (tmp, -1);
   g_free (tmp);
 
+  gtk_entry_completion_update_matches (completion);
+
   gtk_tree_model_filter_refilter (completion->priv->filter_model);
 
   if (!gtk_tree_model_get_iter_first (GTK_TREE_MODEL (completion->priv->filter_model), &iter))
@@ -1383,6 +1562,7 @@ gtk_entry_completion_set_text_column (GtkEntryCompletion *completion,
     return;
 
   completion->priv->text_column = column;
+  gtk_entry_completion_clear_matches (completion);
 
   cell = gtk_cell_renderer_text_new ();
   gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (completion),
@@ -47,6 +47,12 @@ struct _GtkEntryCompletionPrivate
 
   gchar *case_normalized_key;
 
+  /* For the default match function on list models */
+  GPtrArray *match_strings;
+  GArray *matches;
+  guint8 *matched_rows;
+  gchar *matches_key;
+
   /* only used by GtkEntry when attached: */
   GtkWidget *popup_window;
   GtkWidget *vbox;
@@ -57,6 +57,8 @@ struct _GtkEventControllerPrivate
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (GtkEventController, gtk_event_controller, G_TYPE_OBJECT)
 
+G_STATIC_ASSERT (GDK_EVENT_LAST <= 64);
+
 static gboolean
 gtk_event_controller_handle_event_default (GtkEventController *controller,
                                            const GdkEvent     *event)
@@ -150,6 +152,7 @@ gtk_event_controller_class_init (GtkEventControllerClass *klass)
 
   klass->filter_event = gtk_event_controller_handle_event_default;
   klass->handle_event = gtk_event_controller_handle_event_default;
+  klass->event_types = G_MAXUINT64;
 
   object_class->set_property = gtk_event_controller_set_property;
   object_class->get_property = gtk_event_controller_get_property;
@@ -330,6 +333,9 @@ gtk_event_controller_set_propagation_phase (GtkEventController  *controller,
 
   priv->phase = phase;
 
+  if (priv->widget)
+    _gtk_widget_invalidate_controller_event_types (priv->widget);
+
   if (phase == GTK_PHASE_NONE)
     gtk_event_controller_reset (controller);
 
@@ -94,6 +94,9 @@ gtk_event_controller_motion_class_init (GtkEventControllerMotionClass *klass)
   GtkEventControllerClass *controller_class = GTK_EVENT_CONTROLLER_CLASS (klass);
 
   controller_class->handle_event = gtk_event_controller_motion_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_ENTER_NOTIFY) |
+                                  GTK_EVENT_TYPE_BIT (GDK_LEAVE_NOTIFY) |
+                                  GTK_EVENT_TYPE_BIT (GDK_MOTION_NOTIFY);
 
   /**
    * GtkEventControllerMotion::enter:
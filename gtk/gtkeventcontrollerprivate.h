@@ -42,7 +42,16 @@ struct _GtkEventControllerClass
    */
   gboolean (* filter_event) (GtkEventController *controller,
                              const GdkEvent     *event);
+
+  /* The event types that handle_event() can do anything with, as
+   * GTK_EVENT_TYPE_BIT()s. Widgets use this to skip the controller
+   * for other events. Subclasses inherit it, the default is all types.
+   */
+  guint64 event_types;
+
   gpointer padding[10];
 };
 
+#define GTK_EVENT_TYPE_BIT(type) (G_GUINT64_CONSTANT (1) << (type))
+
 #endif /* __GTK_EVENT_CONTROLLER_PRIVATE_H__ */
@@ -63,7 +63,7 @@
 #include "gtkintl.h"
 #include "gtkwidget.h"
 #include "gtkeventcontrollerprivate.h"
-#include "gtkeventcontrollerscroll.h"
+#include "gtkeventcontrollerscrollprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
@@ -153,43 +153,85 @@ scroll_history_reset (GtkEventControllerScroll *scroll)
                         scroll->scroll_history->len);
 }
 
+/* The velocity is the slope of a least squares fit of the scrolled
+ * distance over time. Unlike the average over the whole history, this
+ * isn't thrown off much by jitter in the delivery of the events.
+ */
 static void
-scroll_history_finish (GtkEventControllerScroll *scroll,
-                       gdouble                  *velocity_x,
-                       gdouble                  *velocity_y)
+scroll_history_get_velocity (GtkEventControllerScroll *scroll,
+                             gdouble                  *velocity_x,
+                             gdouble                  *velocity_y)
 {
-  gdouble accum_dx = 0, accum_dy = 0;
-  guint32 first = 0, last = 0;
+  gdouble sum_t = 0, sum_tt = 0;
+  gdouble sum_x = 0, sum_tx = 0;
+  gdouble sum_y = 0, sum_ty = 0;
+  gdouble x = 0, y = 0, n, denominator;
+  guint32 first;
   guint i;
 
   *velocity_x = 0;
   *velocity_y = 0;
 
-  if (scroll->scroll_history->len == 0)
+  if (scroll->scroll_history->len < 2)
     return;
 
+  first = g_array_index (scroll->scroll_history, ScrollHistoryElem, 0).evtime;
+
   for (i = 0; i < scroll->scroll_history->len; i++)
     {
       ScrollHistoryElem *elem;
+      gdouble t;
 
       elem = &g_array_index (scroll->scroll_history, ScrollHistoryElem, i);
-      accum_dx += elem->dx;
-      accum_dy += elem->dy;
-      last = elem->evtime;
-
-      if (i == 0)
-        first = elem->evtime;
+      x += elem->dx;
+      y += elem->dy;
+      t = (elem->evtime - first) / 1000.;
+
+      sum_t += t;
+      sum_tt += t * t;
+      sum_x += x;
+      sum_tx += t * x;
+      sum_y += y;
+      sum_ty += t * y;
     }
 
-  if (last != first)
-    {
-      *velocity_x = (accum_dx * 1000) / (last - first);
-      *velocity_y = (accum_dy * 1000) / (last - first);
-    }
+  n = scroll->scroll_history->len;
+  denominator = n * sum_tt - sum_t * sum_t;
+  if (denominator <= 0)
+    return;
+
+  *velocity_x = (n * sum_tx - sum_t * sum_x) / denominator;
+  *velocity_y = (n * sum_ty - sum_t * sum_y) / denominator;
+}
 
+static void
+scroll_history_finish (GtkEventControllerScroll *scroll,
+                       gdouble                  *velocity_x,
+                       gdouble                  *velocity_y)
+{
+  scroll_history_get_velocity (scroll, velocity_x, velocity_y);
   scroll_history_reset (scroll);
 }
 
+/*< private >
+ * gtk_event_controller_scroll_get_velocity:
+ * @scroll: a #GtkEventControllerScroll
+ * @velocity_x: (out): return location for the horizontal velocity
+ * @velocity_y: (out): return location for the vertical velocity
+ *
+ * Estimates the current velocity of an ongoing scroll, in scroll
+ * units per second, from the recent deltas. This is only available
+ * for controllers with the %GTK_EVENT_CONTROLLER_SCROLL_KINETIC flag,
+ * the velocity is 0 for others.
+ */
+void
+gtk_event_controller_scroll_get_velocity (GtkEventControllerScroll *scroll,
+                                          gdouble                  *velocity_x,
+                                          gdouble                  *velocity_y)
+{
+  scroll_history_get_velocity (scroll, velocity_x, velocity_y);
+}
+
 static void
 gtk_event_controller_scroll_finalize (GObject *object)
 {
@@ -360,6 +402,7 @@ gtk_event_controller_scroll_class_init (GtkEventControllerScrollClass *klass)
   object_class->get_property = gtk_event_controller_scroll_get_property;
 
   controller_class->handle_event = gtk_event_controller_scroll_handle_event;
+  controller_class->event_types = GTK_EVENT_TYPE_BIT (GDK_SCROLL);
 
   /**
    * GtkEventControllerScroll:flags:
@@ -256,6 +256,9 @@ struct _GtkFileChooserWidgetPrivate {
   GtkFileSystemModel *browse_files_model;
   char *browse_files_last_selected_name;
 
+  /* Models of recently visited folders, most recent first */
+  GList *cached_folder_models;
+
   GtkWidget *places_sidebar;
   GtkWidget *places_view;
   StartupMode startup_mode;
@@ -362,10 +365,14 @@ struct _GtkFileChooserWidgetPrivate {
   guint show_size_column : 1;
   guint create_folders : 1;
   guint auto_selecting_first_row : 1;
+  guint browse_files_model_loaded : 1;
 };
 
 #define MAX_LOADING_TIME 500
 
+/* Number of models of recently visited folders to keep around */
+#define MAX_CACHED_FOLDER_MODELS 3
+
 #define DEFAULT_NEW_FOLDER_NAME _("Type name of new folder")
 
 /* Signal IDs */
@@ -705,6 +712,7 @@ gtk_file_chooser_widget_finalize (GObject *object)
   search_clear_model (impl, FALSE);
   recent_clear_model (impl, FALSE);
   g_clear_object (&impl->priv->model_for_search);
+  g_list_free_full (priv->cached_folder_models, g_object_unref);
 
   /* stopping the load above should have cleared this */
   g_assert (priv->load_timeout_id == 0);
@@ -1785,9 +1793,14 @@ clear_model_cache (GtkFileChooserWidget *impl,
 {
   GtkFileChooserWidgetPrivate *priv = impl->priv;
 
+  GList *l;
+
   if (priv->browse_files_model)
     _gtk_file_system_model_clear_cache (priv->browse_files_model, column);
 
+  for (l = priv->cached_folder_models; l; l = l->next)
+    _gtk_file_system_model_clear_cache (l->data, column);
+
   if (priv->search_model)
     _gtk_file_system_model_clear_cache (priv->search_model, column);
 
@@ -3993,6 +4006,10 @@ compare_directory (GtkFileSystemModel   *model,
   return 0;
 }
 
+/* The collation keys in MODEL_COL_NAME_COLLATED are computed on first use
+ * and cached in the model's nodes, so sorting only compares bytes and does
+ * not normalize the names again for every comparison.
+ */
 static gint
 compare_name (GtkFileSystemModel   *model,
               GtkTreeIter          *a,
@@ -4540,6 +4557,8 @@ browse_files_model_finished_loading_cb (GtkFileSystemModel   *model,
       set_busy_cursor (impl, FALSE);
       show_error_on_reading_current_folder (impl, error);
     }
+  else
+    priv->browse_files_model_loaded = TRUE;
 
   if (priv->load_state == LOAD_PRELOAD)
     {
@@ -4572,15 +4591,71 @@ browse_files_model_finished_loading_cb (GtkFileSystemModel   *model,
   profile_end ("end", NULL);
 }
 
+/* Keeps the model of a folder that was left around, so that going back
+ * to the folder does not need to enumerate it again. Only models that
+ * finished loading and are kept up to date by a directory monitor are
+ * worth keeping.
+ */
+static void
+cache_folder_model (GtkFileChooserWidget *impl,
+                    GtkFileSystemModel   *model)
+{
+  GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GList *last;
+
+  if (!_gtk_file_system_model_is_monitored (model))
+    return;
+
+  g_signal_handlers_disconnect_by_data (model, impl);
+
+  priv->cached_folder_models = g_list_prepend (priv->cached_folder_models,
+                                               g_object_ref (model));
+
+  if (g_list_length (priv->cached_folder_models) > MAX_CACHED_FOLDER_MODELS)
+    {
+      last = g_list_last (priv->cached_folder_models);
+      g_object_unref (last->data);
+      priv->cached_folder_models = g_list_delete_link (priv->cached_folder_models, last);
+    }
+}
+
+/* Takes the cached model for @folder out of the cache, if there is one */
+static GtkFileSystemModel *
+steal_cached_folder_model (GtkFileChooserWidget *impl,
+                           GFile                *folder)
+{
+  GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GList *l;
+
+  for (l = priv->cached_folder_models; l; l = l->next)
+    {
+      GtkFileSystemModel *model = l->data;
+
+      if (g_file_equal (_gtk_file_system_model_get_directory (model), folder))
+        {
+          priv->cached_folder_models = g_list_delete_link (priv->cached_folder_models, l);
+          return model;
+        }
+    }
+
+  return NULL;
+}
+
 static void
 stop_loading_and_clear_list_model (GtkFileChooserWidget *impl,
                                    gboolean              remove)
 {
   GtkFileChooserWidgetPrivate *priv = impl->priv;
 
+  if (priv->browse_files_model &&
+      priv->browse_files_model_loaded &&
+      priv->load_state == LOAD_FINISHED)
+    cache_folder_model (impl, priv->browse_files_model);
+
   load_remove_timer (impl, LOAD_EMPTY);
 
   g_set_object (&priv->browse_files_model, NULL);
+  priv->browse_files_model_loaded = FALSE;
 
   if (remove)
     gtk_tree_view_set_model (GTK_TREE_VIEW (priv->browse_files_tree_view), NULL);
@@ -4975,6 +5050,7 @@ set_list_model (GtkFileChooserWidget  *impl,
                 GError               **error)
 {
   GtkFileChooserWidgetPrivate *priv = impl->priv;
+  GtkFileSystemModel *cached_model;
 
   g_assert (priv->current_folder != NULL);
 
@@ -4988,12 +5064,16 @@ set_list_model (GtkFileChooserWidget  *impl,
 
   set_busy_cursor (impl, TRUE);
 
-  priv->browse_files_model =
-    _gtk_file_system_model_new_for_directory (priv->current_folder,
-                                              MODEL_ATTRIBUTES,
-                                              file_system_model_set,
-                                              impl,
-                                              MODEL_COLUMN_TYPES);
+  cached_model = steal_cached_folder_model (impl, priv->current_folder);
+  if (cached_model)
+    priv->browse_files_model = cached_model;
+  else
+    priv->browse_files_model =
+      _gtk_file_system_model_new_for_directory (priv->current_folder,
+                                                MODEL_ATTRIBUTES,
+                                                file_system_model_set,
+                                                impl,
+                                                MODEL_COLUMN_TYPES);
 
   _gtk_file_system_model_set_show_hidden (priv->browse_files_model, priv->show_hidden);
 
@@ -5014,6 +5094,12 @@ set_list_model (GtkFileChooserWidget  *impl,
 
   _gtk_file_system_model_set_filter (priv->browse_files_model, priv->current_filter);
 
+  /* A cached model is complete already, and its monitor kept it
+   * up to date while we were elsewhere.
+   */
+  if (cached_model)
+    browse_files_model_finished_loading_cb (priv->browse_files_model, NULL, impl);
+
   profile_end ("end", NULL);
 
   return TRUE;
@@ -115,6 +115,12 @@
  * freeze_updates()) during the intial population process.  When the model is
  * frozen, sorting will not happen.  The model will sort itself when the freeze
  * count goes back to zero, via corresponding calls to thaw_updates().
+ *
+ * Files added while the model is frozen are only appended to the
+ * model->files array.  On thawing, they get sorted among themselves and
+ * merged into the rest of the array, which is already sorted; see
+ * gtk_file_system_model_merge_frozen_nodes().  Only a change of the sort
+ * order needs a full re-sort.
  */
 
 /*** DEFINES ***/
@@ -826,6 +832,67 @@ gtk_file_system_model_sort (GtkFileSystemModel *model)
   model->sort_on_thaw = FALSE;
 }
 
+/* Sorts the nodes that were added while the model was frozen into the
+ * already sorted rest of the model. The new nodes are not visible yet,
+ * and merging keeps the relative order of the existing nodes, so unlike
+ * gtk_file_system_model_sort() no rows need to be reordered. This keeps
+ * loading big directories, which arrive in many batches, from becoming
+ * quadratic.
+ */
+static void
+gtk_file_system_model_merge_frozen_nodes (GtkFileSystemModel *model)
+{
+  SortData data;
+  GArray *files;
+  guint first_new, i, j;
+
+  if (!sort_data_init (&data, model))
+    return;
+
+  first_new = model->files->len;
+  while (first_new > 1 && get_node (model, first_new - 1)->frozen_add)
+    first_new--;
+
+  if (first_new == model->files->len)
+    return;
+
+  g_qsort_with_data (get_node (model, first_new),
+                     model->files->len - first_new,
+                     model->node_size,
+                     compare_array_element,
+                     &data);
+
+  /* Nothing to merge if the new nodes all sort after the old ones */
+  if (first_new == 1 ||
+      compare_array_element (get_node (model, first_new - 1),
+                             get_node (model, first_new),
+                             &data) <= 0)
+    return;
+
+  files = g_array_sized_new (FALSE, FALSE, model->node_size, model->files->len);
+  g_array_append_vals (files, get_node (model, 0), 1); /* the editable row stays first */
+
+  i = 1;
+  j = first_new;
+  while (i < first_new && j < model->files->len)
+    {
+      if (compare_array_element (get_node (model, i), get_node (model, j), &data) <= 0)
+        g_array_append_vals (files, get_node (model, i++), 1);
+      else
+        g_array_append_vals (files, get_node (model, j++), 1);
+    }
+  if (i < first_new)
+    g_array_append_vals (files, get_node (model, i), first_new - i);
+  if (j < model->files->len)
+    g_array_append_vals (files, get_node (model, j), model->files->len - j);
+
+  g_array_free (model->files, TRUE);
+  model->files = files;
+
+  model->n_nodes_valid = 0;
+  g_hash_table_remove_all (model->file_lookup);
+}
+
 static void
 gtk_file_system_model_sort_node (GtkFileSystemModel *model, guint node)
 {
@@ -1143,7 +1210,16 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
 
   if (files)
     {
-      if (model->dir_thaw_source == 0)
+      gboolean first_batch;
+
+      /* Show the first batch right away, and collect the following
+       * ones for a bit so that they get merged into the model together.
+       */
+      first_batch = model->files->len <= 1 && model->dir_thaw_source == 0;
+
+      if (first_batch)
+        freeze_updates (model);
+      else if (model->dir_thaw_source == 0)
         {
           freeze_updates (model);
           model->dir_thaw_source = gdk_threads_add_timeout_full (IO_PRIORITY + 1,
@@ -1175,6 +1251,9 @@ gtk_file_system_model_got_files (GObject *object, GAsyncResult *res, gpointer da
         }
       g_list_free (files);
 
+      if (first_batch)
+        thaw_updates (model);
+
       g_file_enumerator_next_files_async (enumerator,
 					  g_file_is_native (model->dir) ? 50 * FILES_PER_QUERY : FILES_PER_QUERY,
 					  IO_PRIORITY,
@@ -1867,8 +1946,11 @@ add_file (GtkFileSystemModel *model,
   g_array_append_vals (model->files, node, 1);
   g_slice_free1 (model->node_size, node);
 
-  if (!model->frozen)
-    node_compute_visibility_and_filters (model, model->files->len -1);
+  /* Files added while frozen get merged into place when thawing */
+  if (model->frozen)
+    return;
+
+  node_compute_visibility_and_filters (model, model->files->len -1);
 
   gtk_file_system_model_sort_node (model, model->files->len -1);
 }
@@ -2054,6 +2136,8 @@ thaw_updates (GtkFileSystemModel *model)
     gtk_file_system_model_refilter_all (model);
   if (model->sort_on_thaw)
     gtk_file_system_model_sort (model);
+  else if (stuff_added)
+    gtk_file_system_model_merge_frozen_nodes (model);
   if (stuff_added)
     {
       guint i;
@@ -2195,3 +2279,20 @@ _gtk_file_system_model_get_directory (GtkFileSystemModel *model)
   return model->dir;
 }
 
+/**
+ * _gtk_file_system_model_is_monitored:
+ * @model: a #GtkFileSystemModel
+ *
+ * Checks whether the model follows changes to its directory. Only
+ * those models are kept up to date after they finished loading.
+ *
+ * Returns: %TRUE if the directory of @model is being monitored
+ **/
+gboolean
+_gtk_file_system_model_is_monitored (GtkFileSystemModel *model)
+{
+  g_return_val_if_fail (GTK_IS_FILE_SYSTEM_MODEL (model), FALSE);
+
+  return model->dir_monitor != NULL;
+}
+
@@ -51,6 +51,7 @@ GtkFileSystemModel *_gtk_file_system_model_new_for_directory(GFile *
                                                              guint               n_columns,
                                                              ...);
 GFile *             _gtk_file_system_model_get_directory    (GtkFileSystemModel *model);
+gboolean            _gtk_file_system_model_is_monitored     (GtkFileSystemModel *model);
 GCancellable *      _gtk_file_system_model_get_cancellable  (GtkFileSystemModel *model);
 gboolean            _gtk_file_system_model_iter_is_visible  (GtkFileSystemModel *model,
 							     GtkTreeIter        *iter);
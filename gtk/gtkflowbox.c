@@ -116,6 +116,8 @@ static void gtk_flow_box_set_accept_unpaired_release (GtkFlowBox *box,
                                                       gboolean    accept);
 
 static void gtk_flow_box_check_model_compat  (GtkFlowBox *box);
+static void gtk_flow_box_queue_virtual_update (GtkFlowBox *box);
+static guint gtk_flow_box_get_virtual_first (GtkFlowBox *box);
 
 static void
 get_current_selection_modifiers (GtkWidget *widget,
@@ -270,7 +272,9 @@ typedef struct _GtkFlowBoxChildPrivate GtkFlowBoxChildPrivate;
 struct _GtkFlowBoxChildPrivate
 {
   GSequenceIter *iter;
+  GObject       *item;
   gboolean       selected;
+  gboolean       wraps_widget;
 };
 
 #define CHILD_PRIV(child) ((GtkFlowBoxChildPrivate*)gtk_flow_box_child_get_instance_private ((GtkFlowBoxChild*)(child)))
@@ -438,12 +442,22 @@ gtk_flow_box_child_size_allocate (GtkWidget           *widget,
 
 /* GObject implementation {{{2 */
 
+static void
+gtk_flow_box_child_finalize (GObject *obj)
+{
+  g_clear_object (&CHILD_PRIV (obj)->item);
+
+  G_OBJECT_CLASS (gtk_flow_box_child_parent_class)->finalize (obj);
+}
+
 static void
 gtk_flow_box_child_class_init (GtkFlowBoxChildClass *class)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (class);
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (class);
 
+  object_class->finalize = gtk_flow_box_child_finalize;
+
   widget_class->get_request_mode = gtk_flow_box_child_get_request_mode;
   widget_class->measure = gtk_flow_box_child_measure;
   widget_class->size_allocate = gtk_flow_box_child_size_allocate;
@@ -522,7 +536,12 @@ gtk_flow_box_child_get_index (GtkFlowBoxChild *child)
   priv = CHILD_PRIV (child);
 
   if (priv->iter != NULL)
-    return g_sequence_iter_get_position (priv->iter);
+    {
+      GtkFlowBox *box = gtk_flow_box_child_get_box (child);
+      gint offset = box ? gtk_flow_box_get_virtual_first (box) : 0;
+
+      return g_sequence_iter_get_position (priv->iter) + offset;
+    }
 
   return -1;
 }
@@ -679,6 +698,22 @@ struct _GtkFlowBoxPrivate {
   GtkFlowBoxCreateWidgetFunc  create_widget_func;
   gpointer                    create_widget_func_data;
   GDestroyNotify              create_widget_func_data_destroy;
+
+  /* Only children for the items in view exist when bound with
+   * gtk_flow_box_bind_model_virtual(). children then holds the
+   * children for the items starting at virtual_first, and the
+   * ones that went out of view are kept in recycled_children.
+   * The geometry is that of a homogeneous box, with lines of
+   * virtual_line_length items that are virtual_line_size high.
+   */
+  gboolean                    virtual_model;
+  GtkFlowBoxBindWidgetFunc    bind_widget_func;
+  GtkFlowBoxBindWidgetFunc    unbind_widget_func;
+  GPtrArray                  *recycled_children;
+  guint                       virtual_first;
+  gint                        virtual_line_length;
+  gint                        virtual_line_size;
+  guint                       virtual_tick_id;
 };
 
 #define BOX_PRIV(box) ((GtkFlowBoxPrivate*)gtk_flow_box_get_instance_private ((GtkFlowBox*)(box)))
@@ -1385,6 +1420,181 @@ get_offset_pixels (GtkAlign align,
   return offset;
 }
 
+/* Children of a virtual model only exist for the items in view, so
+ * the layout is computed from the children that exist as if the box
+ * was homogeneous, and applied to all items of the model.
+ */
+static gboolean
+gtk_flow_box_get_virtual_geometry (GtkFlowBox *box,
+                                   gint        avail_size,
+                                   gint       *line_length,
+                                   gint       *item_size,
+                                   gint       *line_size)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint min_items, item_spacing, nat_item_size;
+
+  min_items = MAX (1, priv->min_children_per_line);
+
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    item_spacing = priv->column_spacing;
+  else
+    item_spacing = priv->row_spacing;
+
+  get_max_item_size (box, priv->orientation, NULL, &nat_item_size);
+  if (nat_item_size <= 0)
+    return FALSE;
+
+  *line_length = avail_size / (nat_item_size + item_spacing);
+  if (*line_length * item_spacing + (*line_length + 1) * nat_item_size <= avail_size)
+    (*line_length)++;
+
+  *line_length = MAX (min_items, *line_length);
+  *line_length = MIN (*line_length, priv->max_children_per_line);
+
+  *item_size = (avail_size - (*line_length - 1) * item_spacing) / *line_length;
+  if (ORIENTATION_ALIGN (box) != GTK_ALIGN_FILL)
+    *item_size = MIN (*item_size, nat_item_size);
+
+  get_largest_size_for_opposing_orientation (box,
+                                             priv->orientation,
+                                             *item_size,
+                                             NULL,
+                                             line_size);
+
+  return TRUE;
+}
+
+static void
+gtk_flow_box_measure_virtual (GtkFlowBox     *box,
+                              GtkOrientation  orientation,
+                              gint            for_size,
+                              gint           *minimum,
+                              gint           *natural)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  gint n_items, min_items, nat_items;
+  gint min_item_size, nat_item_size, item_spacing, line_spacing;
+  gint line_length, item_size, line_size, n_lines;
+
+  *minimum = *natural = 0;
+
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  if (n_items == 0)
+    return;
+
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      item_spacing = priv->column_spacing;
+      line_spacing = priv->row_spacing;
+    }
+  else
+    {
+      item_spacing = priv->row_spacing;
+      line_spacing = priv->column_spacing;
+    }
+
+  min_items = MAX (1, priv->min_children_per_line);
+  nat_items = MAX (min_items, MIN (n_items, priv->max_children_per_line));
+
+  get_max_item_size (box, priv->orientation, &min_item_size, &nat_item_size);
+
+  if (orientation == priv->orientation)
+    {
+      *minimum = min_items * min_item_size + (min_items - 1) * item_spacing;
+      *natural = nat_items * nat_item_size + (nat_items - 1) * item_spacing;
+      return;
+    }
+
+  if (for_size < 0)
+    for_size = nat_items * nat_item_size + (nat_items - 1) * item_spacing;
+
+  if (!gtk_flow_box_get_virtual_geometry (box, for_size, &line_length, &item_size, &line_size))
+    return;
+
+  n_lines = (n_items + line_length - 1) / line_length;
+
+  *minimum = *natural = n_lines * line_size + (n_lines - 1) * line_spacing;
+}
+
+static void
+gtk_flow_box_allocate_virtual (GtkFlowBox          *box,
+                               const GtkAllocation *allocation,
+                               GtkAllocation       *out_clip)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkAllocation child_allocation;
+  GdkRectangle child_clip;
+  GSequenceIter *iter;
+  gint avail_size, item_spacing, line_spacing;
+  gint line_length, item_size, line_size;
+  guint i;
+
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      avail_size = allocation->width;
+      item_spacing = priv->column_spacing;
+      line_spacing = priv->row_spacing;
+    }
+  else
+    {
+      avail_size = allocation->height;
+      item_spacing = priv->row_spacing;
+      line_spacing = priv->column_spacing;
+    }
+
+  if (!gtk_flow_box_get_virtual_geometry (box, avail_size, &line_length, &item_size, &line_size))
+    return;
+
+  /* Which items are in view depends on the geometry */
+  if (line_length != priv->virtual_line_length ||
+      line_size != priv->virtual_line_size)
+    {
+      priv->virtual_line_length = line_length;
+      priv->virtual_line_size = line_size;
+      gtk_flow_box_queue_virtual_update (box);
+    }
+
+  priv->cur_children_per_line = line_length;
+
+  for (i = priv->virtual_first, iter = g_sequence_get_begin_iter (priv->children);
+       !g_sequence_iter_is_end (iter);
+       i++, iter = g_sequence_iter_next (iter))
+    {
+      GtkWidget *child;
+      gint item_offset, line_offset;
+
+      child = g_sequence_get (iter);
+
+      if (!child_is_visible (child))
+        continue;
+
+      item_offset = (i % line_length) * (item_size + item_spacing);
+      line_offset = (i / line_length) * (line_size + line_spacing);
+
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+          child_allocation.x = item_offset;
+          child_allocation.y = line_offset;
+          child_allocation.width = item_size;
+          child_allocation.height = line_size;
+        }
+      else /* GTK_ORIENTATION_VERTICAL */
+        {
+          child_allocation.x = line_offset;
+          child_allocation.y = item_offset;
+          child_allocation.width = line_size;
+          child_allocation.height = item_size;
+        }
+
+      if (gtk_widget_get_direction (GTK_WIDGET (box)) == GTK_TEXT_DIR_RTL)
+        child_allocation.x = allocation->width - child_allocation.x - child_allocation.width;
+
+      gtk_widget_size_allocate (child, &child_allocation, -1, &child_clip);
+      gdk_rectangle_union (out_clip, &child_clip, out_clip);
+    }
+}
+
 static void
 gtk_flow_box_size_allocate (GtkWidget           *widget,
                             const GtkAllocation *allocation,
@@ -1410,6 +1620,12 @@ gtk_flow_box_size_allocate (GtkWidget           *widget,
   gint i, this_line_size;
   GSequenceIter *iter;
 
+  if (priv->virtual_model)
+    {
+      gtk_flow_box_allocate_virtual (box, allocation, out_clip);
+      return;
+    }
+
   min_items = MAX (1, priv->min_children_per_line);
 
   if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
@@ -1825,6 +2041,12 @@ gtk_flow_box_measure (GtkWidget      *widget,
   GtkFlowBox *box = GTK_FLOW_BOX (widget);
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
 
+  if (priv->virtual_model)
+    {
+      gtk_flow_box_measure_virtual (box, orientation, for_size, minimum, natural);
+      return;
+    }
+
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
       if (for_size < 0)
@@ -3378,6 +3600,12 @@ gtk_flow_box_finalize (GObject *obj)
     priv->sort_destroy (priv->sort_data);
 
   g_sequence_free (priv->children);
+  if (priv->hadjustment)
+    g_signal_handlers_disconnect_by_func (priv->hadjustment,
+                                          gtk_flow_box_queue_virtual_update, obj);
+  if (priv->vadjustment)
+    g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                          gtk_flow_box_queue_virtual_update, obj);
   g_clear_object (&priv->hadjustment);
   g_clear_object (&priv->vadjustment);
 
@@ -3393,6 +3621,9 @@ gtk_flow_box_finalize (GObject *obj)
       g_clear_object (&priv->bound_model);
     }
 
+  g_ptr_array_foreach (priv->recycled_children, (GFunc) g_object_unref, NULL);
+  g_ptr_array_unref (priv->recycled_children);
+
   G_OBJECT_CLASS (gtk_flow_box_parent_class)->finalize (obj);
 }
 
@@ -3743,6 +3974,7 @@ gtk_flow_box_init (GtkFlowBox *box)
   _gtk_orientable_set_style_classes (GTK_ORIENTABLE (box));
 
   priv->children = g_sequence_new (NULL);
+  priv->recycled_children = g_ptr_array_new ();
 
   priv->multipress_gesture = gtk_gesture_multi_press_new (GTK_WIDGET (box));
   gtk_gesture_single_set_touch_only (GTK_GESTURE_SINGLE (priv->multipress_gesture),
@@ -3775,6 +4007,285 @@ gtk_flow_box_init (GtkFlowBox *box)
                     G_CALLBACK (gtk_flow_box_drag_gesture_end), box);
 }
 
+static guint
+gtk_flow_box_get_virtual_first (GtkFlowBox *box)
+{
+  return BOX_PRIV (box)->virtual_first;
+}
+
+static GtkWidget *
+gtk_flow_box_child_get_item_widget (GtkFlowBoxChild *child)
+{
+  if (CHILD_PRIV (child)->wraps_widget)
+    return gtk_bin_get_child (GTK_BIN (child));
+
+  return GTK_WIDGET (child);
+}
+
+/* Returns a child for @item, either a recycled one or a new one
+ * from the create_widget_func. The caller owns a reference.
+ */
+static GtkFlowBoxChild *
+gtk_flow_box_obtain_virtual_child (GtkFlowBox *box,
+                                   GObject    *item)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkFlowBoxChild *child;
+  GtkWidget *widget;
+
+  if (priv->recycled_children->len > 0)
+    {
+      child = g_ptr_array_index (priv->recycled_children, priv->recycled_children->len - 1);
+      g_ptr_array_remove_index_fast (priv->recycled_children, priv->recycled_children->len - 1);
+
+      priv->bind_widget_func (gtk_flow_box_child_get_item_widget (child),
+                              item,
+                              priv->create_widget_func_data);
+    }
+  else
+    {
+      widget = priv->create_widget_func (item, priv->create_widget_func_data);
+      if (g_object_is_floating (widget))
+        g_object_ref_sink (widget);
+
+      gtk_widget_show (widget);
+
+      if (GTK_IS_FLOW_BOX_CHILD (widget))
+        child = GTK_FLOW_BOX_CHILD (widget);
+      else
+        {
+          child = GTK_FLOW_BOX_CHILD (gtk_flow_box_child_new ());
+          g_object_ref_sink (child);
+          gtk_container_add (GTK_CONTAINER (child), widget);
+          CHILD_PRIV (child)->wraps_widget = TRUE;
+          g_object_unref (widget);
+        }
+    }
+
+  CHILD_PRIV (child)->item = g_object_ref (item);
+
+  return child;
+}
+
+static void
+gtk_flow_box_recycle_child (GtkFlowBox      *box,
+                            GtkFlowBoxChild *child)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkFlowBoxChildPrivate *child_priv = CHILD_PRIV (child);
+
+  if (child == priv->cursor_child)
+    priv->cursor_child = NULL;
+  if (child == priv->rubberband_first)
+    priv->rubberband_first = NULL;
+  if (child == priv->rubberband_last)
+    priv->rubberband_last = NULL;
+
+  g_ptr_array_add (priv->recycled_children, g_object_ref (child));
+  gtk_container_remove (GTK_CONTAINER (box), GTK_WIDGET (child));
+  gtk_flow_box_child_set_selected (child, FALSE);
+
+  if (priv->unbind_widget_func)
+    priv->unbind_widget_func (gtk_flow_box_child_get_item_widget (child),
+                              child_priv->item,
+                              priv->create_widget_func_data);
+  g_clear_object (&child_priv->item);
+}
+
+static void
+gtk_flow_box_recycle_all_children (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  while (g_sequence_get_length (priv->children) > 0)
+    gtk_flow_box_recycle_child (box, g_sequence_get (g_sequence_get_begin_iter (priv->children)));
+
+  priv->virtual_first = 0;
+}
+
+static void
+gtk_flow_box_add_virtual_child (GtkFlowBox *box,
+                                guint       position,
+                                gboolean    prepend)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkFlowBoxChild *child;
+  GObject *item;
+
+  item = g_list_model_get_item (priv->bound_model, position);
+  child = gtk_flow_box_obtain_virtual_child (box, item);
+  gtk_flow_box_insert (box, GTK_WIDGET (child), prepend ? 0 : -1);
+  g_object_unref (child);
+  g_object_unref (item);
+}
+
+/* Makes the children match the lines in view, plus half a page of
+ * overscan in each direction, recycling the children that went out
+ * of view for the items that came into view.
+ */
+static void
+gtk_flow_box_update_virtual_children (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  GtkAdjustment *adjustment;
+  guint n_items, n_children, first, last;
+
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  n_children = g_sequence_get_length (priv->children);
+
+  /* Lines are stacked in the opposing orientation */
+  if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+    adjustment = priv->vadjustment;
+  else
+    adjustment = priv->hadjustment;
+
+  if (n_items == 0)
+    {
+      first = last = 0;
+    }
+  else if (adjustment == NULL)
+    {
+      /* Not scrolled, so everything is in view */
+      first = 0;
+      last = n_items;
+    }
+  else if (priv->virtual_line_size <= 0)
+    {
+      /* The geometry gets determined from the children that exist
+       * in the next allocation, which queues another update.
+       */
+      if (n_children == 0)
+        {
+          priv->virtual_first = 0;
+          gtk_flow_box_add_virtual_child (box, 0, FALSE);
+        }
+
+      gtk_widget_queue_resize (GTK_WIDGET (box));
+      return;
+    }
+  else
+    {
+      gdouble top, bottom, overscan;
+      gint line_spacing, stride;
+      guint line_length;
+
+      if (priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        line_spacing = priv->row_spacing;
+      else
+        line_spacing = priv->column_spacing;
+
+      stride = priv->virtual_line_size + line_spacing;
+      line_length = priv->virtual_line_length;
+
+      overscan = gtk_adjustment_get_page_size (adjustment) / 2;
+      top = MAX (0, gtk_adjustment_get_value (adjustment) - overscan);
+      bottom = gtk_adjustment_get_value (adjustment)
+               + gtk_adjustment_get_page_size (adjustment) + overscan;
+
+      first = MIN ((guint) (top / stride), (n_items - 1) / line_length) * line_length;
+      last = CLAMP (((guint) (bottom / stride) + 1) * line_length, first + 1, n_items);
+    }
+
+  if (first >= priv->virtual_first + n_children || last <= priv->virtual_first)
+    {
+      gtk_flow_box_recycle_all_children (box);
+      n_children = 0;
+    }
+  else
+    {
+      while (priv->virtual_first < first)
+        {
+          gtk_flow_box_recycle_child (box, g_sequence_get (g_sequence_get_begin_iter (priv->children)));
+          priv->virtual_first++;
+          n_children--;
+        }
+
+      while (priv->virtual_first + n_children > last)
+        {
+          gtk_flow_box_recycle_child (box, g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter (priv->children))));
+          n_children--;
+        }
+    }
+
+  if (n_children == 0)
+    priv->virtual_first = first;
+
+  while (priv->virtual_first > first)
+    {
+      priv->virtual_first--;
+      gtk_flow_box_add_virtual_child (box, priv->virtual_first, TRUE);
+      n_children++;
+    }
+
+  while (priv->virtual_first + n_children < last)
+    {
+      gtk_flow_box_add_virtual_child (box, priv->virtual_first + n_children, FALSE);
+      n_children++;
+    }
+}
+
+static gboolean
+gtk_flow_box_virtual_tick (GtkWidget     *widget,
+                           GdkFrameClock *frame_clock,
+                           gpointer       user_data)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (widget);
+
+  priv->virtual_tick_id = 0;
+
+  if (priv->virtual_model)
+    gtk_flow_box_update_virtual_children (GTK_FLOW_BOX (widget));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Children are only added and removed from a tick callback, so
+ * that scrolling or resizing never changes the children in the
+ * middle of a size allocation.
+ */
+static void
+gtk_flow_box_queue_virtual_update (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (!priv->virtual_model || priv->virtual_tick_id != 0)
+    return;
+
+  priv->virtual_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (box),
+                                                        gtk_flow_box_virtual_tick,
+                                                        NULL, NULL);
+}
+
+static void
+gtk_flow_box_virtual_model_changed (GtkFlowBox *box,
+                                    guint       position,
+                                    guint       removed,
+                                    guint       added)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+  guint n_children;
+
+  n_children = g_sequence_get_length (priv->children);
+
+  /* Children are placed by their index in the model, so a shift
+   * that isn't a whole line moves all of them.
+   */
+  if (position + removed <= priv->virtual_first &&
+      priv->virtual_line_length > 0 &&
+      ((gint) added - (gint) removed) % priv->virtual_line_length == 0)
+    {
+      /* The children we have still show the same items */
+      priv->virtual_first = priv->virtual_first + added - removed;
+    }
+  else if (position < priv->virtual_first + n_children)
+    {
+      gtk_flow_box_recycle_all_children (box);
+    }
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+  gtk_flow_box_queue_virtual_update (box);
+}
+
 static void
 gtk_flow_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3786,6 +4297,12 @@ gtk_flow_box_bound_model_changed (GListModel *list,
   GtkFlowBoxPrivate *priv = BOX_PRIV (box);
   gint i;
 
+  if (priv->virtual_model)
+    {
+      gtk_flow_box_virtual_model_changed (box, position, removed, added);
+      return;
+    }
+
   while (removed--)
     {
       GtkFlowBoxChild *child;
@@ -3939,6 +4456,10 @@ gtk_flow_box_get_child_at_index (GtkFlowBox *box,
 
   g_return_val_if_fail (GTK_IS_FLOW_BOX (box), NULL);
 
+  idx -= BOX_PRIV (box)->virtual_first;
+  if (idx < 0)
+    return NULL;
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, idx);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -4018,9 +4539,20 @@ gtk_flow_box_set_hadjustment (GtkFlowBox    *box,
 
   g_object_ref (adjustment);
   if (priv->hadjustment)
-    g_object_unref (priv->hadjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->hadjustment,
+                                            gtk_flow_box_queue_virtual_update, box);
+      g_object_unref (priv->hadjustment);
+    }
   priv->hadjustment = adjustment;
   gtk_container_set_focus_hadjustment (GTK_CONTAINER (box), adjustment);
+
+  g_signal_connect_swapped (adjustment, "value-changed",
+                            G_CALLBACK (gtk_flow_box_queue_virtual_update), box);
+  g_signal_connect_swapped (adjustment, "changed",
+                            G_CALLBACK (gtk_flow_box_queue_virtual_update), box);
+
+  gtk_flow_box_queue_virtual_update (box);
 }
 
 /**
@@ -4055,9 +4587,20 @@ gtk_flow_box_set_vadjustment (GtkFlowBox    *box,
 
   g_object_ref (adjustment);
   if (priv->vadjustment)
-    g_object_unref (priv->vadjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->vadjustment,
+                                            gtk_flow_box_queue_virtual_update, box);
+      g_object_unref (priv->vadjustment);
+    }
   priv->vadjustment = adjustment;
   gtk_container_set_focus_vadjustment (GTK_CONTAINER (box), adjustment);
+
+  g_signal_connect_swapped (adjustment, "value-changed",
+                            G_CALLBACK (gtk_flow_box_queue_virtual_update), box);
+  g_signal_connect_swapped (adjustment, "changed",
+                            G_CALLBACK (gtk_flow_box_queue_virtual_update), box);
+
+  gtk_flow_box_queue_virtual_update (box);
 }
 
 static void
@@ -4070,6 +4613,43 @@ gtk_flow_box_check_model_compat (GtkFlowBox *box)
     g_warning ("GtkFlowBox with a model will ignore sort and filter functions");
 }
 
+static void
+gtk_flow_box_unbind_model (GtkFlowBox *box)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  if (priv->virtual_model)
+    {
+      gtk_flow_box_recycle_all_children (box);
+
+      g_ptr_array_foreach (priv->recycled_children, (GFunc) g_object_unref, NULL);
+      g_ptr_array_set_size (priv->recycled_children, 0);
+
+      if (priv->virtual_tick_id != 0)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (box), priv->virtual_tick_id);
+          priv->virtual_tick_id = 0;
+        }
+
+      priv->virtual_model = FALSE;
+      priv->bind_widget_func = NULL;
+      priv->unbind_widget_func = NULL;
+      priv->virtual_line_length = 0;
+      priv->virtual_line_size = 0;
+    }
+
+  if (priv->bound_model)
+    {
+      if (priv->create_widget_func_data_destroy)
+        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+
+      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
+      g_clear_object (&priv->bound_model);
+    }
+
+  gtk_flow_box_forall (GTK_CONTAINER (box), (GtkCallback) gtk_widget_destroy, NULL);
+}
+
 /**
  * gtk_flow_box_bind_model:
  * @box: a #GtkFlowBox
@@ -4110,16 +4690,74 @@ gtk_flow_box_bind_model (GtkFlowBox                 *box,
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
   g_return_if_fail (model == NULL || create_widget_func != NULL);
 
-  if (priv->bound_model)
-    {
-      if (priv->create_widget_func_data_destroy)
-        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+  gtk_flow_box_unbind_model (box);
 
-      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_flow_box_bound_model_changed, box);
-      g_clear_object (&priv->bound_model);
-    }
+  if (model == NULL)
+    return;
 
-  gtk_flow_box_forall (GTK_CONTAINER (box), (GtkCallback) gtk_widget_destroy, NULL);
+  priv->bound_model = g_object_ref (model);
+  priv->create_widget_func = create_widget_func;
+  priv->create_widget_func_data = user_data;
+  priv->create_widget_func_data_destroy = user_data_free_func;
+
+  gtk_flow_box_check_model_compat (box);
+
+  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_flow_box_bound_model_changed), box);
+  gtk_flow_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+}
+
+/**
+ * gtk_flow_box_bind_model_virtual:
+ * @box: a #GtkFlowBox
+ * @model: (nullable): the #GListModel to be bound to @box
+ * @create_widget_func: (nullable): a function that creates widgets for items
+ *   or %NULL in case you also passed %NULL as @model
+ * @bind_widget_func: (nullable): a function that makes a widget represent
+ *   another item, or %NULL in case you also passed %NULL as @model
+ * @unbind_widget_func: (nullable): a function that is called when a widget
+ *   stops representing an item, or %NULL
+ * @user_data: user data passed to the functions
+ * @user_data_free_func: function for freeing @user_data
+ *
+ * Binds @model to @box like gtk_flow_box_bind_model(), but only creates
+ * children for the items that are in view, plus some margin. When @box
+ * is scrolled, the children of the items that go out of view are reused
+ * for the ones that come into view by calling @unbind_widget_func and
+ * @bind_widget_func on the widgets that @create_widget_func returned.
+ * This keeps the number of widgets constant no matter how many items
+ * @model contains.
+ *
+ * The children are laid out as if @box was homogeneous, with the size
+ * of the largest child that exists, so all children should have about
+ * the same size. For the visible part of @box to be known, the adjustment
+ * in the direction that lines are stacked in must be set with
+ * gtk_flow_box_set_vadjustment() or gtk_flow_box_set_hadjustment().
+ *
+ * Since children only exist for the items in view,
+ * gtk_flow_box_get_child_at_index() returns %NULL for other items,
+ * and selection and keyboard focus are lost when their child is
+ * scrolled out of view. The filtering and sorting functionality of
+ * GtkFlowBox is not supported in this mode.
+ *
+ * Since: 3.94
+ */
+void
+gtk_flow_box_bind_model_virtual (GtkFlowBox                 *box,
+                                 GListModel                 *model,
+                                 GtkFlowBoxCreateWidgetFunc  create_widget_func,
+                                 GtkFlowBoxBindWidgetFunc    bind_widget_func,
+                                 GtkFlowBoxBindWidgetFunc    unbind_widget_func,
+                                 gpointer                    user_data,
+                                 GDestroyNotify              user_data_free_func)
+{
+  GtkFlowBoxPrivate *priv = BOX_PRIV (box);
+
+  g_return_if_fail (GTK_IS_FLOW_BOX (box));
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+  g_return_if_fail (model == NULL || create_widget_func != NULL);
+  g_return_if_fail (model == NULL || bind_widget_func != NULL);
+
+  gtk_flow_box_unbind_model (box);
 
   if (model == NULL)
     return;
@@ -4128,11 +4766,14 @@ gtk_flow_box_bind_model (GtkFlowBox                 *box,
   priv->create_widget_func = create_widget_func;
   priv->create_widget_func_data = user_data;
   priv->create_widget_func_data_destroy = user_data_free_func;
+  priv->virtual_model = TRUE;
+  priv->bind_widget_func = bind_widget_func;
+  priv->unbind_widget_func = unbind_widget_func;
 
   gtk_flow_box_check_model_compat (box);
 
   g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_flow_box_bound_model_changed), box);
-  gtk_flow_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+  gtk_flow_box_queue_virtual_update (box);
 }
 
 /* Setters and getters {{{2 */
@@ -114,6 +114,22 @@ struct _GtkFlowBoxChildClass
 typedef GtkWidget * (*GtkFlowBoxCreateWidgetFunc) (gpointer item,
                                                    gpointer  user_data);
 
+/**
+ * GtkFlowBoxBindWidgetFunc:
+ * @widget: a widget that was created by the #GtkFlowBoxCreateWidgetFunc
+ * @item: (type GObject): the item from the model
+ * @user_data: (closure): user data from gtk_flow_box_bind_model_virtual()
+ *
+ * Called for flow boxes that are bound to a #GListModel with
+ * gtk_flow_box_bind_model_virtual() when @widget is reused to
+ * represent @item, or when it stops representing @item.
+ *
+ * Since: 3.94
+ */
+typedef void (*GtkFlowBoxBindWidgetFunc) (GtkWidget *widget,
+                                          gpointer   item,
+                                          gpointer   user_data);
+
 GDK_AVAILABLE_IN_3_12
 GType                 gtk_flow_box_child_get_type            (void) G_GNUC_CONST;
 GDK_AVAILABLE_IN_3_12
@@ -138,6 +154,14 @@ void                  gtk_flow_box_bind_model                (GtkFlowBox
                                                               GtkFlowBoxCreateWidgetFunc  create_widget_func,
                                                               gpointer                    user_data,
                                                               GDestroyNotify              user_data_free_func);
+GDK_AVAILABLE_IN_3_94
+void                  gtk_flow_box_bind_model_virtual        (GtkFlowBox                 *box,
+                                                              GListModel                 *model,
+                                                              GtkFlowBoxCreateWidgetFunc  create_widget_func,
+                                                              GtkFlowBoxBindWidgetFunc    bind_widget_func,
+                                                              GtkFlowBoxBindWidgetFunc    unbind_widget_func,
+                                                              gpointer                    user_data,
+                                                              GDestroyNotify              user_data_free_func);
 
 GDK_AVAILABLE_IN_3_12
 void                  gtk_flow_box_set_homogeneous           (GtkFlowBox           *box,
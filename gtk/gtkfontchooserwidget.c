@@ -109,6 +109,14 @@ struct _GtkFontChooserWidgetPrivate
   GtkTreeModel *model;
   GtkTreeModel *filter_model;
 
+  PangoFontFamily **families;     /* families that are not in the model yet */
+  int               n_families;
+  int               n_loaded_families;
+  guint             load_idle;
+
+  char            **search_terms; /* casefolded, NULL if not searching */
+  int               preview_text_height;
+
   GtkWidget       *preview;
   GtkWidget       *preview2;
   GtkWidget       *font_name_label;
@@ -152,9 +160,13 @@ enum {
   FAMILY_COLUMN,
   FACE_COLUMN,
   FONT_DESC_COLUMN,
-  PREVIEW_TITLE_COLUMN
+  PREVIEW_TITLE_COLUMN,
+  SEARCH_KEY_COLUMN
 };
 
+/* Time in µs that loading fonts may take per idle */
+#define LOAD_BUDGET 8000
+
 static void gtk_font_chooser_widget_set_property         (GObject         *object,
                                                           guint            prop_id,
                                                           const GValue    *value,
@@ -196,6 +208,7 @@ static void     gtk_font_chooser_widget_set_show_preview_entry (GtkFontChooserWi
 static void     gtk_font_chooser_widget_set_cell_size          (GtkFontChooserWidget *fontchooser);
 static void     gtk_font_chooser_widget_load_fonts             (GtkFontChooserWidget *fontchooser,
                                                                 gboolean              force);
+static void     gtk_font_chooser_widget_clear_families         (GtkFontChooserWidget *fontchooser);
 static void     gtk_font_chooser_widget_populate_features      (GtkFontChooserWidget *fontchooser);
 static gboolean visible_func                                   (GtkTreeModel *model,
 								GtkTreeIter  *iter,
@@ -358,6 +371,21 @@ static void
 text_changed_cb (GtkEntry             *entry,
                  GtkFontChooserWidget *fc)
 {
+  GtkFontChooserWidgetPrivate *priv = fc->priv;
+  const char *search_text;
+
+  g_clear_pointer (&priv->search_terms, g_strfreev);
+
+  /* Split and casefold the search once, instead of once per row */
+  search_text = gtk_entry_get_text (entry);
+  if (search_text[0] != '\0')
+    {
+      char *search_casefold = g_utf8_casefold (search_text, -1);
+
+      priv->search_terms = g_strsplit (search_casefold, " ", 0);
+      g_free (search_casefold);
+    }
+
   gtk_font_chooser_widget_refilter_font_list (fc);
 }
 
@@ -598,7 +626,9 @@ rows_changed_cb (GtkFontChooserWidget *fontchooser)
   GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
   const char *page;
 
-  if (gtk_tree_model_iter_n_children (priv->filter_model, NULL) == 0)
+  /* Don't claim there are no matches while fonts are still being loaded */
+  if (gtk_tree_model_iter_n_children (priv->filter_model, NULL) == 0 &&
+      priv->load_idle == 0)
     page = "empty";
   else
     page = "list";
@@ -683,6 +713,8 @@ gtk_font_chooser_widget_dispose (GObject *object)
       priv->stack = NULL;
     }
 
+  gtk_font_chooser_widget_clear_families (self);
+
   G_OBJECT_CLASS (gtk_font_chooser_widget_parent_class)->dispose (object);
 }
 
@@ -899,12 +931,154 @@ cmp_families (const void *a,
   return g_utf8_collate (a_name, b_name);
 }
 
+static gboolean
+my_pango_font_family_equal (const char *familya,
+                            const char *familyb)
+{
+  return g_ascii_strcasecmp (familya, familyb) == 0;
+}
+
+static void
+gtk_font_chooser_widget_clear_families (GtkFontChooserWidget *fontchooser)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+  int i;
+
+  if (priv->load_idle != 0)
+    {
+      g_source_remove (priv->load_idle);
+      priv->load_idle = 0;
+    }
+
+  for (i = priv->n_loaded_families; i < priv->n_families; i++)
+    g_object_unref (priv->families[i]);
+  g_clear_pointer (&priv->families, g_free);
+  priv->n_families = 0;
+  priv->n_loaded_families = 0;
+}
+
+static void
+gtk_font_chooser_widget_add_family (GtkFontChooserWidget *fontchooser,
+                                    PangoFontFamily      *family)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+  GtkListStore *list_store = GTK_LIST_STORE (priv->model);
+  PangoFontFace **faces;
+  int             j, n_faces;
+  const gchar    *fam_name = pango_font_family_get_name (family);
+
+  pango_font_family_list_faces (family, &faces, &n_faces);
+
+  for (j = 0; j < n_faces; j++)
+    {
+      GtkDelayedFontDescription *desc;
+      GtkTreeIter iter;
+      const gchar *face_name;
+      char *title, *search_key;
+
+      face_name = pango_font_face_get_face_name (faces[j]);
+
+      if (priv->level == GTK_FONT_CHOOSER_LEVEL_FAMILY)
+        title = g_strdup (fam_name);
+      else
+        title = g_strconcat (fam_name, " ", face_name, NULL);
+      search_key = g_utf8_casefold (title, -1);
+
+      desc = gtk_delayed_font_description_new (faces[j]);
+
+      gtk_list_store_insert_with_values (list_store, &iter, -1,
+                                         FAMILY_COLUMN, family,
+                                         FACE_COLUMN, faces[j],
+                                         FONT_DESC_COLUMN, desc,
+                                         PREVIEW_TITLE_COLUMN, title,
+                                         SEARCH_KEY_COLUMN, search_key,
+                                         -1);
+
+      g_free (title);
+      g_free (search_key);
+      gtk_delayed_font_description_unref (desc);
+
+      if (priv->level == GTK_FONT_CHOOSER_LEVEL_FAMILY)
+        break;
+    }
+
+  g_free (faces);
+}
+
+/* Adds the families up to @until to the model, but stops early
+ * once @budget µs have passed, unless @budget is -1.
+ */
+static void
+gtk_font_chooser_widget_load_families (GtkFontChooserWidget *fontchooser,
+                                       int                   until,
+                                       gint64                budget)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+  gint64 end_time;
+
+  if (priv->n_loaded_families >= until)
+    return;
+
+  end_time = budget < 0 ? G_MAXINT64 : g_get_monotonic_time () + budget;
+
+  g_signal_handlers_block_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
+  g_signal_handlers_block_by_func (priv->filter_model, rows_changed_cb, fontchooser);
+
+  do
+    {
+      PangoFontFamily *family = priv->families[priv->n_loaded_families++];
+
+      gtk_font_chooser_widget_add_family (fontchooser, family);
+      g_object_unref (family);
+    }
+  while (priv->n_loaded_families < until &&
+         g_get_monotonic_time () < end_time);
+
+  if (priv->n_loaded_families == priv->n_families)
+    gtk_font_chooser_widget_clear_families (fontchooser);
+
+  rows_changed_cb (fontchooser);
+
+  g_signal_handlers_unblock_by_func (priv->filter_model, rows_changed_cb, fontchooser);
+  g_signal_handlers_unblock_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
+}
+
+/* Makes sure all families named @family_name are in the model */
+static void
+gtk_font_chooser_widget_load_family (GtkFontChooserWidget *fontchooser,
+                                     const char           *family_name)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+  int i, until;
+
+  until = 0;
+  for (i = priv->n_loaded_families; i < priv->n_families; i++)
+    {
+      if (my_pango_font_family_equal (family_name,
+                                      pango_font_family_get_name (priv->families[i])))
+        until = i + 1;
+    }
+
+  gtk_font_chooser_widget_load_families (fontchooser, until, -1);
+}
+
+static gboolean
+load_fonts_idle_cb (gpointer data)
+{
+  GtkFontChooserWidget *fontchooser = data;
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+
+  gtk_font_chooser_widget_load_families (fontchooser, priv->n_families, LOAD_BUDGET);
+
+  /* Loading the last families cleared the idle */
+  return priv->load_idle != 0 ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
 static void
 gtk_font_chooser_widget_load_fonts (GtkFontChooserWidget *fontchooser,
                                     gboolean              force)
 {
   GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
-  GtkListStore *list_store;
   gint n_families, i;
   PangoFontFamily **families;
   guint fontconfig_timestamp;
@@ -927,7 +1101,7 @@ gtk_font_chooser_widget_load_fonts (GtkFontChooserWidget *fontchooser,
   if (!need_reload && !force)
     return;
 
-  list_store = GTK_LIST_STORE (priv->model);
+  gtk_font_chooser_widget_clear_families (fontchooser);
 
   if (priv->font_map)
     font_map = priv->font_map;
@@ -937,58 +1111,34 @@ gtk_font_chooser_widget_load_fonts (GtkFontChooserWidget *fontchooser,
 
   qsort (families, n_families, sizeof (PangoFontFamily *), cmp_families);
 
+  /* Listing the faces of all families and creating the rows for them
+   * takes seconds on systems with thousands of fonts, so only the first
+   * ones are added right away, the rest is added from an idle. The
+   * families are kept alive until then, the font map may drop them.
+   */
+  for (i = 0; i < n_families; i++)
+    g_object_ref (families[i]);
+  priv->families = families;
+  priv->n_families = n_families;
+
   g_signal_handlers_block_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
   g_signal_handlers_block_by_func (priv->filter_model, rows_changed_cb, fontchooser);
-  gtk_list_store_clear (list_store);
+  gtk_list_store_clear (GTK_LIST_STORE (priv->model));
+  g_signal_handlers_unblock_by_func (priv->filter_model, rows_changed_cb, fontchooser);
+  g_signal_handlers_unblock_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
 
-  /* Iterate over families and faces */
-  for (i = 0; i < n_families; i++)
+  if (n_families > 0)
     {
-      GtkTreeIter     iter;
-      PangoFontFace **faces;
-      int             j, n_faces;
-      const gchar    *fam_name = pango_font_family_get_name (families[i]);
-
-      pango_font_family_list_faces (families[i], &faces, &n_faces);
-
-      for (j = 0; j < n_faces; j++)
-        {
-          GtkDelayedFontDescription *desc;
-          const gchar *face_name;
-          char *title;
-
-          face_name = pango_font_face_get_face_name (faces[j]);
-
-          if (priv->level == GTK_FONT_CHOOSER_LEVEL_FAMILY)
-            title = g_strdup (fam_name);
-          else
-            title = g_strconcat (fam_name, " ", face_name, NULL);
-
-          desc = gtk_delayed_font_description_new (faces[j]);
-
-          gtk_list_store_insert_with_values (list_store, &iter, -1,
-                                             FAMILY_COLUMN, families[i],
-                                             FACE_COLUMN, faces[j],
-                                             FONT_DESC_COLUMN, desc,
-                                             PREVIEW_TITLE_COLUMN, title,
-                                             -1);
-
-          g_free (title);
-          gtk_delayed_font_description_unref (desc);
+      priv->load_idle = g_idle_add (load_fonts_idle_cb, fontchooser);
+      g_source_set_name_by_id (priv->load_idle, "[gtk+] gtk_font_chooser_widget_load_fonts");
 
-          if (priv->level == GTK_FONT_CHOOSER_LEVEL_FAMILY)
-            break;
-        }
-
-      g_free (faces);
+      gtk_font_chooser_widget_load_families (fontchooser, n_families, LOAD_BUDGET);
+    }
+  else
+    {
+      g_clear_pointer (&priv->families, g_free);
+      rows_changed_cb (fontchooser);
     }
-
-  g_free (families);
-
-  rows_changed_cb (fontchooser);
-
-  g_signal_handlers_unblock_by_func (priv->filter_model, rows_changed_cb, fontchooser);
-  g_signal_handlers_unblock_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
 
   /* now make sure the font list looks right */
   if (!gtk_font_chooser_widget_find_font (fontchooser, priv->font_desc, &priv->font_iter))
@@ -1004,9 +1154,7 @@ visible_func (GtkTreeModel *model,
 {
   GtkFontChooserWidgetPrivate *priv = user_data;
   gboolean result = TRUE;
-  const gchar *search_text;
-  gchar **split_terms;
-  gchar *font_name, *font_name_casefold;
+  gchar *search_key;
   guint i;
 
   if (priv->filter_func != NULL)
@@ -1029,33 +1177,23 @@ visible_func (GtkTreeModel *model,
     }
 
   /* If there's no filter string we show the item */
-  search_text = gtk_entry_get_text (GTK_ENTRY (priv->search_entry));
-  if (strlen (search_text) == 0)
+  if (priv->search_terms == NULL)
     return TRUE;
 
   gtk_tree_model_get (model, iter,
-                      PREVIEW_TITLE_COLUMN, &font_name,
+                      SEARCH_KEY_COLUMN, &search_key,
                       -1);
 
-  if (font_name == NULL)
+  if (search_key == NULL)
     return FALSE;
 
-  split_terms = g_strsplit (search_text, " ", 0);
-  font_name_casefold = g_utf8_casefold (font_name, -1);
-
-  for (i = 0; split_terms[i] && result; i++)
+  for (i = 0; priv->search_terms[i] && result; i++)
     {
-      gchar* term_casefold = g_utf8_casefold (split_terms[i], -1);
-
-      if (!strstr (font_name_casefold, term_casefold))
+      if (!strstr (search_key, priv->search_terms[i]))
         result = FALSE;
-
-      g_free (term_casefold);
     }
 
-  g_free (font_name_casefold);
-  g_free (font_name);
-  g_strfreev (split_terms);
+  g_free (search_key);
 
   return result;
 }
@@ -1094,7 +1232,7 @@ gtk_font_chooser_widget_get_preview_attributes (GtkFontChooserWidget       *font
       pango_attr_list_insert (attrs, attribute);
     }
 
-  attribute = pango_attr_size_new_absolute (gtk_font_chooser_widget_get_preview_text_height (fontchooser));
+  attribute = pango_attr_size_new_absolute (fontchooser->priv->preview_text_height);
   pango_attr_list_insert (attrs, attribute);
 
   return attrs;
@@ -1141,6 +1279,11 @@ gtk_font_chooser_widget_set_cell_size (GtkFontChooserWidget *fontchooser)
 
   gtk_cell_renderer_set_fixed_size (priv->family_face_cell, -1, -1);
 
+  /* This is needed for every row that is drawn, so only look it up
+   * when the style changes.
+   */
+  priv->preview_text_height = gtk_font_chooser_widget_get_preview_text_height (fontchooser);
+
   attrs = gtk_font_chooser_widget_get_preview_attributes (fontchooser, NULL);
   
   g_object_set (priv->family_face_cell,
@@ -1172,6 +1315,7 @@ gtk_font_chooser_widget_finalize (GObject *object)
     priv->filter_data_destroy (priv->filter_data);
 
   g_free (priv->preview_text);
+  g_strfreev (priv->search_terms);
 
   g_clear_object (&priv->font_map);
 
@@ -1187,13 +1331,6 @@ gtk_font_chooser_widget_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_font_chooser_widget_parent_class)->finalize (object);
 }
 
-static gboolean
-my_pango_font_family_equal (const char *familya,
-                            const char *familyb)
-{
-  return g_ascii_strcasecmp (familya, familyb) == 0;
-}
-
 static gboolean
 gtk_font_chooser_widget_find_font (GtkFontChooserWidget        *fontchooser,
                                    const PangoFontDescription  *font_desc,
@@ -1206,6 +1343,8 @@ gtk_font_chooser_widget_find_font (GtkFontChooserWidget        *fontchooser,
   if (pango_font_description_get_family (font_desc) == NULL)
     return FALSE;
 
+  gtk_font_chooser_widget_load_family (fontchooser, pango_font_description_get_family (font_desc));
+
   for (valid = gtk_tree_model_get_iter_first (priv->model, iter);
        valid;
        valid = gtk_tree_model_iter_next (priv->model, iter))
@@ -41,7 +41,7 @@
 #endif
 
 #define MAJOR_VERSION 1
-#define MINOR_VERSION 0
+#define MINOR_VERSION 1
 
 #define GET_UINT16(cache, offset) (GUINT16_FROM_BE (*(guint16 *)((cache) + (offset))))
 #define GET_UINT32(cache, offset) (GUINT32_FROM_BE (*(guint32 *)((cache) + (offset))))
@@ -59,16 +59,14 @@ struct _GtkIconCache {
 GtkIconCache *
 gtk_icon_cache_ref (GtkIconCache *cache)
 {
-  cache->ref_count++;
+  g_atomic_int_inc (&cache->ref_count);
   return cache;
 }
 
 void
 gtk_icon_cache_unref (GtkIconCache *cache)
 {
-  cache->ref_count --;
-
-  if (cache->ref_count == 0)
+  if (g_atomic_int_dec_and_test (&cache->ref_count))
     {
       GTK_NOTE (ICONTHEME, g_message ("unmapping icon cache"));
 
@@ -536,3 +534,60 @@ G_GNUC_END_IGNORE_DEPRECATIONS
   return pixbuf;
 }
 
+/* Returns an svg icon that was pre-rendered to fit @size by
+ * gtk-update-icon-cache, pointing directly into the cache.
+ */
+GdkPixbuf *
+gtk_icon_cache_get_rendered_icon (GtkIconCache *cache,
+                                  const gchar  *icon_name,
+                                  gint          directory_index,
+                                  gint          size)
+{
+  guint32 offset, image_data_offset, pixel_data_offset;
+  guint32 n_renderings, i;
+  GdkPixbuf *pixbuf;
+
+  offset = find_image_offset (cache, icon_name, directory_index);
+  if (!offset)
+    return NULL;
+
+  image_data_offset = GET_UINT32 (cache->buffer, offset + 4);
+  if (!image_data_offset)
+    return NULL;
+
+  pixel_data_offset = GET_UINT32 (cache->buffer, image_data_offset);
+  if (!pixel_data_offset)
+    return NULL;
+
+  /* Type 1 is a list of renderings */
+  if (GET_UINT32 (cache->buffer, pixel_data_offset) != 1)
+    return NULL;
+
+  n_renderings = GET_UINT32 (cache->buffer, pixel_data_offset + 8);
+  for (i = 0; i < n_renderings; i++)
+    {
+      guint32 rendering = pixel_data_offset + 12 + 16 * i;
+      guint32 width, height, rowstride, data_offset;
+
+      width = GET_UINT32 (cache->buffer, rendering);
+      height = GET_UINT32 (cache->buffer, rendering + 4);
+
+      if (MAX (width, height) != size)
+        continue;
+
+      rowstride = GET_UINT32 (cache->buffer, rendering + 8);
+      data_offset = GET_UINT32 (cache->buffer, rendering + 12);
+
+      pixbuf = gdk_pixbuf_new_from_data ((guchar *)(cache->buffer + pixel_data_offset + data_offset),
+                                         GDK_COLORSPACE_RGB, TRUE, 8,
+                                         width, height, rowstride,
+                                         (GdkPixbufDestroyNotify)pixbuf_destroy_cb,
+                                         cache);
+      gtk_icon_cache_ref (cache);
+
+      return pixbuf;
+    }
+
+  return NULL;
+}
+
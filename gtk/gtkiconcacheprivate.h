@@ -44,6 +44,10 @@ gint          gtk_icon_cache_get_icon_flags             (GtkIconCache *cache,
 GdkPixbuf    *gtk_icon_cache_get_icon                   (GtkIconCache *cache,
                                                          const gchar  *icon_name,
                                                          gint          directory_index);
+GdkPixbuf    *gtk_icon_cache_get_rendered_icon          (GtkIconCache *cache,
+                                                         const gchar  *icon_name,
+                                                         gint          directory_index,
+                                                         gint          size);
 
 GtkIconCache *gtk_icon_cache_ref                        (GtkIconCache *cache);
 void          gtk_icon_cache_unref                      (GtkIconCache *cache);
@@ -156,9 +156,35 @@ check_pixel_data (CacheInfo *info,
   check ("offset, pixel data type", get_uint32 (info, offset, &type));
   check ("offset, pixel data length", get_uint32 (info, offset + 4, &length));
 
-  check ("pixel data type", type == 0);
+  check ("pixel data type", type == 0 || type == 1);
   check ("pixel data length", offset + 8 + length < info->cache_size);
 
+  if (type == 1)
+    {
+      guint32 n_renderings;
+      guint32 i;
+
+      check ("offset, rendering list", get_uint32 (info, offset + 8, &n_renderings));
+      check ("rendering list length", 4 + 16 * (guint64) n_renderings <= length);
+
+      for (i = 0; i < n_renderings; i++)
+        {
+          guint32 width, height, rowstride, data_offset;
+          guint32 rendering = offset + 12 + 16 * i;
+
+          check ("offset, rendering width", get_uint32 (info, rendering, &width));
+          check ("offset, rendering height", get_uint32 (info, rendering + 4, &height));
+          check ("offset, rendering rowstride", get_uint32 (info, rendering + 8, &rowstride));
+          check ("offset, rendering data", get_uint32 (info, rendering + 12, &data_offset));
+
+          check ("rendering rowstride", rowstride >= 4 * (guint64) width && rowstride % 4 == 0);
+          check ("rendering data", data_offset % 4 == 0 &&
+                                   data_offset + (guint64) rowstride * height <= length + 8);
+        }
+
+      return TRUE;
+    }
+
   if (info->flags & CHECK_PIXBUFS)
     {
       GdkPixdata data;
@@ -122,7 +122,10 @@ typedef enum
   ICON_SUFFIX_SYMBOLIC_PNG = 1 << 4
 } IconSuffix;
 
-#define INFO_CACHE_LRU_SIZE 32
+/* Default budget for the infos kept alive by the LRU cache. Each
+ * entry is charged for its info and the pixels it holds on to.
+ */
+#define INFO_CACHE_LRU_BUDGET (1024 * 1024)
 #if 0
 #define DEBUG_CACHE(args) g_print args
 #else
@@ -132,7 +135,9 @@ typedef enum
 struct _GtkIconThemePrivate
 {
   GHashTable *info_cache;
-  GList *info_cache_lru;
+  GQueue info_cache_lru;
+  gsize info_cache_lru_size;
+  gsize info_cache_lru_budget;
 
   gchar *current_theme;
   gchar **search_path;
@@ -202,6 +207,11 @@ struct _GtkIconInfo
   /* Cache pixbuf (if there is any) */
   GdkPixbuf *cache_pixbuf;
 
+  /* Icon cache that may have pre-rendered versions of an svg */
+  GtkIconCache *svg_cache;
+  gchar *svg_cache_name;
+  gint svg_cache_dir_index;
+
   /* Information about the directory where
    * the source was found
    */
@@ -232,8 +242,11 @@ struct _GtkIconInfo
 
   SymbolicPixbufCache *symbolic_pixbuf_cache;
 
-  gint symbolic_width;
-  gint symbolic_height;
+  /* Link in the LRU cache of the icon theme; data is set
+   * while the info is in the LRU.
+   */
+  GList lru_link;
+  gsize lru_size;
 };
 
 typedef struct
@@ -245,6 +258,11 @@ typedef struct
 
   /* In search order */
   GList *dirs;
+
+  /* If no dir has an icon cache, maps icon names
+   * to the dirs that have them, in search order
+   */
+  GHashTable *icons;
 } IconTheme;
 
 typedef struct
@@ -299,6 +317,7 @@ static gboolean     theme_has_icon            (IconTheme        *theme,
                                                const gchar      *icon_name);
 static void         theme_list_contexts       (IconTheme        *theme,
                                                GHashTable       *contexts);
+static void         theme_build_icon_index    (IconTheme        *theme);
 static void         theme_subdir_load         (GtkIconTheme     *icon_theme,
                                                IconTheme        *theme,
                                                GKeyFile         *theme_file,
@@ -669,6 +688,8 @@ gtk_icon_theme_init (GtkIconTheme *icon_theme)
 
   priv->info_cache = g_hash_table_new_full (icon_info_key_hash, icon_info_key_equal, NULL,
                                             (GDestroyNotify)icon_info_uncached);
+  g_queue_init (&priv->info_cache_lru);
+  priv->info_cache_lru_budget = INFO_CACHE_LRU_BUDGET;
 
   priv->custom_theme = FALSE;
 
@@ -787,7 +808,7 @@ gtk_icon_theme_finalize (GObject *object)
   priv = icon_theme->priv;
 
   g_hash_table_destroy (priv->info_cache);
-  g_assert (priv->info_cache_lru == NULL);
+  g_assert (g_queue_is_empty (&priv->info_cache_lru));
 
   if (priv->theme_changed_idle)
     g_source_remove (priv->theme_changed_idle);
@@ -1191,6 +1212,7 @@ insert_theme (GtkIconTheme *icon_theme,
   g_strfreev (scaled_dirs);
 
   theme->dirs = g_list_reverse (theme->dirs);
+  theme_build_icon_index (theme);
 
   themes = g_key_file_get_string_list (theme_file,
                                        "Icon Theme",
@@ -1422,8 +1444,12 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
   
   if (!priv->themes_valid)
     {
+      gint64 before = g_get_monotonic_time ();
+
       load_themes (icon_theme);
 
+      gdk_profiler_add_mark (before, g_get_monotonic_time () - before, "icon theme load", priv->current_theme);
+
       if (was_valid)
         queue_theme_changed (icon_theme);
     }
@@ -1439,26 +1465,67 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
  * references the info. So, when we get a cache hit
  * we remove it from the list, and when the proxy
  * pixmap is released we put it on the list.
+ *
+ * The list is bounded by the memory held by its infos
+ * rather than their number. Infos are linked in through
+ * their own lru_link, so all operations are O(1).
  */
+static gsize
+icon_info_get_lru_size (GtkIconInfo *icon_info)
+{
+  SymbolicPixbufCache *symbolic_cache;
+  gsize size;
+
+  size = sizeof (GtkIconInfo);
+
+  if (icon_info->pixbuf)
+    size += (gsize) gdk_pixbuf_get_rowstride (icon_info->pixbuf) *
+            gdk_pixbuf_get_height (icon_info->pixbuf);
+
+  if (icon_info->texture)
+    size += (gsize) 4 * gdk_texture_get_width (icon_info->texture) *
+            gdk_texture_get_height (icon_info->texture);
+
+  for (symbolic_cache = icon_info->symbolic_pixbuf_cache;
+       symbolic_cache != NULL;
+       symbolic_cache = symbolic_cache->next)
+    size += (gsize) gdk_pixbuf_get_rowstride (symbolic_cache->pixbuf) *
+            gdk_pixbuf_get_height (symbolic_cache->pixbuf);
+
+  return size;
+}
+
 static void
-ensure_lru_cache_space (GtkIconTheme *icon_theme)
+unlink_from_lru_cache (GtkIconTheme *icon_theme,
+                       GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
-  GList *l;
 
-  /* Remove last item if LRU full */
-  l = g_list_nth (priv->info_cache_lru, INFO_CACHE_LRU_SIZE - 1);
-  if (l)
+  g_queue_unlink (&priv->info_cache_lru, &icon_info->lru_link);
+  icon_info->lru_link.data = NULL;
+  priv->info_cache_lru_size -= icon_info->lru_size;
+  icon_info->lru_size = 0;
+}
+
+static void
+ensure_lru_cache_space (GtkIconTheme *icon_theme,
+                        gsize         size)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+
+  /* Remove the least recently used items until the new one fits */
+  while (priv->info_cache_lru.tail != NULL &&
+         priv->info_cache_lru_size + size > priv->info_cache_lru_budget)
     {
-      GtkIconInfo *icon_info = l->data;
+      GtkIconInfo *icon_info = priv->info_cache_lru.tail->data;
 
       DEBUG_CACHE (("removing (due to out of space) %p (%s %d 0x%x) from LRU cache (cache size %d)\n",
                     icon_info,
                     g_strjoinv (",", icon_info->key.icon_names),
                     icon_info->key.size, icon_info->key.flags,
-                    g_list_length (priv->info_cache_lru)));
+                    priv->info_cache_lru.length));
 
-      priv->info_cache_lru = g_list_delete_link (priv->info_cache_lru, l);
+      unlink_from_lru_cache (icon_theme, icon_info);
       g_object_unref (icon_info);
     }
 }
@@ -1468,34 +1535,41 @@ add_to_lru_cache (GtkIconTheme *icon_theme,
                   GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
+  gsize size;
 
   DEBUG_CACHE (("adding  %p (%s %d 0x%x) to LRU cache (cache size %d)\n",
                 icon_info,
                 g_strjoinv (",", icon_info->key.icon_names),
                 icon_info->key.size, icon_info->key.flags,
-                g_list_length (priv->info_cache_lru)));
+                priv->info_cache_lru.length));
+
+  g_assert (icon_info->lru_link.data == NULL);
 
-  g_assert (g_list_find (priv->info_cache_lru, icon_info) == NULL);
+  size = icon_info_get_lru_size (icon_info);
+  if (size > priv->info_cache_lru_budget)
+    return;
 
-  ensure_lru_cache_space (icon_theme);
+  ensure_lru_cache_space (icon_theme, size);
   /* prepend new info to LRU */
-  priv->info_cache_lru = g_list_prepend (priv->info_cache_lru,
-                                         g_object_ref (icon_info));
+  icon_info->lru_link.data = g_object_ref (icon_info);
+  icon_info->lru_size = size;
+  g_queue_push_head_link (&priv->info_cache_lru, &icon_info->lru_link);
+  priv->info_cache_lru_size += size;
 }
 
 static void
 ensure_in_lru_cache (GtkIconTheme *icon_theme,
                      GtkIconInfo  *icon_info)
 {
-  GtkIconThemePrivate *priv = icon_theme->priv;
-  GList *l;
-
-  l = g_list_find (priv->info_cache_lru, icon_info);
-  if (l)
+  if (icon_info->lru_link.data != NULL)
     {
-      /* Move to front of LRU if already in it */
-      priv->info_cache_lru = g_list_remove_link (priv->info_cache_lru, l);
-      priv->info_cache_lru = g_list_concat (l, priv->info_cache_lru);
+      /* Move to front of LRU if already in it; the info may have
+       * loaded more pixels since it was added, so account for them
+       * again.
+       */
+      unlink_from_lru_cache (icon_theme, icon_info);
+      add_to_lru_cache (icon_theme, icon_info);
+      g_object_unref (icon_info);
     }
   else
     add_to_lru_cache (icon_theme, icon_info);
@@ -1506,15 +1580,16 @@ remove_from_lru_cache (GtkIconTheme *icon_theme,
                        GtkIconInfo  *icon_info)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
-  if (g_list_find (priv->info_cache_lru, icon_info))
+
+  if (icon_info->lru_link.data != NULL)
     {
       DEBUG_CACHE (("removing %p (%s %d 0x%x) from LRU cache (cache size %d)\n",
                     icon_info,
                     g_strjoinv (",", icon_info->key.icon_names),
                     icon_info->key.size, icon_info->key.flags,
-                    g_list_length (priv->info_cache_lru)));
+                    priv->info_cache_lru.length));
 
-      priv->info_cache_lru = g_list_remove (priv->info_cache_lru, icon_info);
+      unlink_from_lru_cache (icon_theme, icon_info);
       g_object_unref (icon_info);
     }
 }
@@ -2696,6 +2771,52 @@ rescan_themes (GtkIconTheme *icon_theme)
   return FALSE;
 }
 
+/**
+ * gtk_icon_theme_set_cache_budget:
+ * @icon_theme: a #GtkIconTheme
+ * @budget: the maximum number of bytes to keep alive
+ *
+ * Sets how much memory @icon_theme may use to keep icons that are
+ * no longer in use loaded, so they can be reused without loading
+ * them again. This includes the pixel data of the icons.
+ *
+ * Applications that show many different icons may want to raise
+ * this; a budget of 0 disables the cache.
+ *
+ * Since: 3.94
+ */
+void
+gtk_icon_theme_set_cache_budget (GtkIconTheme *icon_theme,
+                                 gsize         budget)
+{
+  GtkIconThemePrivate *priv;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (icon_theme));
+
+  priv = icon_theme->priv;
+
+  priv->info_cache_lru_budget = budget;
+  ensure_lru_cache_space (icon_theme, 0);
+}
+
+/**
+ * gtk_icon_theme_get_cache_budget:
+ * @icon_theme: a #GtkIconTheme
+ *
+ * Returns the value set with gtk_icon_theme_set_cache_budget().
+ *
+ * Returns: the maximum number of bytes used to keep unused icons
+ *
+ * Since: 3.94
+ */
+gsize
+gtk_icon_theme_get_cache_budget (GtkIconTheme *icon_theme)
+{
+  g_return_val_if_fail (GTK_IS_ICON_THEME (icon_theme), 0);
+
+  return icon_theme->priv->info_cache_lru_budget;
+}
+
 /**
  * gtk_icon_theme_rescan_if_needed:
  * @icon_theme: a #GtkIconTheme
@@ -2731,6 +2852,8 @@ theme_destroy (IconTheme *theme)
   g_free (theme->name);
   g_free (theme->example);
 
+  if (theme->icons)
+    g_hash_table_destroy (theme->icons);
   g_list_free_full (theme->dirs, (GDestroyNotify) theme_dir_destroy);
   
   g_free (theme);
@@ -2949,6 +3072,34 @@ compare_dir_matches (IconThemeDir *dir_a, gint difference_a,
   return diff_a <= diff_b;
 }
 
+static void
+theme_dir_match_icon (IconThemeDir  *dir,
+                      const gchar   *icon_name,
+                      gint           size,
+                      gint           scale,
+                      gboolean       allow_svg,
+                      IconThemeDir **min_dir,
+                      gint          *min_difference)
+{
+  IconSuffix suffix;
+  gint difference;
+
+  GTK_NOTE (ICONTHEME, g_message ("look up icon dir %s", dir->dir));
+  suffix = theme_dir_get_icon_suffix (dir, icon_name, NULL);
+  if (best_suffix (suffix, allow_svg) != ICON_SUFFIX_NONE)
+    {
+      difference = theme_dir_size_difference (dir, size, scale);
+      if (*min_dir == NULL ||
+          compare_dir_matches (dir, difference,
+                               *min_dir, *min_difference,
+                               size, scale))
+        {
+          *min_dir = dir;
+          *min_difference = difference;
+        }
+    }
+}
+
 static GtkIconInfo *
 theme_lookup_icon (IconTheme   *theme,
                    const gchar *icon_name,
@@ -2957,38 +3108,33 @@ theme_lookup_icon (IconTheme   *theme,
                    gboolean     allow_svg,
                    gboolean     use_builtin)
 {
-  GList *dirs, *l;
-  IconThemeDir *dir, *min_dir;
+  GList *l;
+  IconThemeDir *min_dir;
   gchar *file;
-  gint min_difference, difference;
+  gint min_difference;
   IconSuffix suffix;
 
   min_difference = G_MAXINT;
   min_dir = NULL;
 
-  dirs = theme->dirs;
-
-  l = dirs;
-  while (l != NULL)
+  if (theme->icons)
     {
-      dir = l->data;
-
-      GTK_NOTE (ICONTHEME, g_message ("look up icon dir %s", dir->dir));
-      suffix = theme_dir_get_icon_suffix (dir, icon_name, NULL);
-      if (best_suffix (suffix, allow_svg) != ICON_SUFFIX_NONE)
-        {
-          difference = theme_dir_size_difference (dir, size, scale);
-          if (min_dir == NULL ||
-              compare_dir_matches (dir, difference,
-                                   min_dir, min_difference,
-                                   size, scale))
-            {
-              min_dir = dir;
-              min_difference = difference;
-            }
-        }
-
-      l = l->next;
+      GPtrArray *dirs;
+      guint i;
+
+      /* Only look at the dirs that have the icon */
+      dirs = g_hash_table_lookup (theme->icons, icon_name);
+      for (i = 0; dirs != NULL && i < dirs->len; i++)
+        theme_dir_match_icon (g_ptr_array_index (dirs, i), icon_name,
+                              size, scale, allow_svg,
+                              &min_dir, &min_difference);
+    }
+  else
+    {
+      for (l = theme->dirs; l != NULL; l = l->next)
+        theme_dir_match_icon (l->data, icon_name,
+                              size, scale, allow_svg,
+                              &min_dir, &min_difference);
     }
 
   if (min_dir)
@@ -3033,6 +3179,13 @@ theme_lookup_icon (IconTheme   *theme,
         {
           icon_info->cache_pixbuf = gtk_icon_cache_get_icon (min_dir->cache, icon_name,
                                                               min_dir->subdir_index);
+
+          if (icon_info->cache_pixbuf == NULL && suffix == ICON_SUFFIX_SVG)
+            {
+              icon_info->svg_cache = gtk_icon_cache_ref (min_dir->cache);
+              icon_info->svg_cache_name = g_strdup (icon_name);
+              icon_info->svg_cache_dir_index = min_dir->subdir_index;
+            }
         }
 
       return icon_info;
@@ -3071,6 +3224,9 @@ theme_has_icon (IconTheme   *theme,
 {
   GList *l;
 
+  if (theme->icons)
+    return g_hash_table_contains (theme->icons, icon_name);
+
   for (l = theme->dirs; l; l = l->next)
     {
       IconThemeDir *dir = l->data;
@@ -3090,6 +3246,52 @@ theme_has_icon (IconTheme   *theme,
   return FALSE;
 }
 
+/* Themes without icon caches have a hash table of icons per dir,
+ * so finding an icon means one lookup for each dir of the theme.
+ * Merge them into a single table of the dirs that have each icon.
+ * Cached themes don't need this, and enumerating their caches
+ * would cost more than it saves.
+ */
+static void
+theme_build_icon_index (IconTheme *theme)
+{
+  GList *l;
+
+  for (l = theme->dirs; l; l = l->next)
+    {
+      IconThemeDir *dir = l->data;
+
+      if (dir->cache || dir->icons == NULL)
+        return;
+    }
+
+  /* Keys are owned by the dirs */
+  theme->icons = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                        NULL, (GDestroyNotify) g_ptr_array_unref);
+
+  for (l = theme->dirs; l; l = l->next)
+    {
+      IconThemeDir *dir = l->data;
+      GHashTableIter iter;
+      gpointer key;
+
+      g_hash_table_iter_init (&iter, dir->icons);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          GPtrArray *dirs;
+
+          dirs = g_hash_table_lookup (theme->icons, key);
+          if (dirs == NULL)
+            {
+              dirs = g_ptr_array_new ();
+              g_hash_table_insert (theme->icons, key, dirs);
+            }
+
+          g_ptr_array_add (dirs, dir);
+        }
+    }
+}
+
 static void
 theme_list_contexts (IconTheme  *theme, 
                      GHashTable *contexts)
@@ -3402,6 +3604,10 @@ icon_info_dup (GtkIconInfo *icon_info)
 
   if (icon_info->cache_pixbuf)
     dup->cache_pixbuf = g_object_ref (icon_info->cache_pixbuf);
+  if (icon_info->svg_cache)
+    dup->svg_cache = gtk_icon_cache_ref (icon_info->svg_cache);
+  dup->svg_cache_name = g_strdup (icon_info->svg_cache_name);
+  dup->svg_cache_dir_index = icon_info->svg_cache_dir_index;
 
   dup->scale = icon_info->scale;
   dup->unscaled_scale = icon_info->unscaled_scale;
@@ -3412,8 +3618,6 @@ icon_info_dup (GtkIconInfo *icon_info)
   dup->is_resource = icon_info->is_resource;
   dup->min_size = icon_info->min_size;
   dup->max_size = icon_info->max_size;
-  dup->symbolic_width = icon_info->symbolic_width;
-  dup->symbolic_height = icon_info->symbolic_height;
 
   return dup;
 }
@@ -3436,6 +3640,8 @@ gtk_icon_info_finalize (GObject *object)
   g_clear_object (&icon_info->pixbuf);
   g_clear_object (&icon_info->proxy_pixbuf);
   g_clear_object (&icon_info->cache_pixbuf);
+  g_clear_pointer (&icon_info->svg_cache, gtk_icon_cache_unref);
+  g_free (icon_info->svg_cache_name);
   g_clear_error (&icon_info->load_error);
 
   symbolic_pixbuf_cache_free (icon_info->symbolic_pixbuf_cache);
@@ -3671,6 +3877,24 @@ icon_info_get_pixbuf_ready (GtkIconInfo *icon_info)
  * on the size at which to load the icon and loading it at
  * that size.
  */
+static GdkPixbuf *
+icon_info_load_cached_svg (GtkIconInfo *icon_info,
+                           gint         scaled_desired_size,
+                           gdouble      dir_scale)
+{
+  gint size;
+
+  if (icon_info->forced_size || icon_info->dir_type == ICON_THEME_DIR_UNTHEMED)
+    size = scaled_desired_size;
+  else
+    size = icon_info->dir_size * dir_scale * icon_info->scale;
+
+  return gtk_icon_cache_get_rendered_icon (icon_info->svg_cache,
+                                           icon_info->svg_cache_name,
+                                           icon_info->svg_cache_dir_index,
+                                           size);
+}
+
 static gboolean
 icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
 {
@@ -3730,6 +3954,13 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
   source_pixbuf = NULL;
   if (icon_info->cache_pixbuf)
     source_pixbuf = g_object_ref (icon_info->cache_pixbuf);
+  else if (icon_info->svg_cache &&
+           (source_pixbuf = icon_info_load_cached_svg (icon_info,
+                                                       scaled_desired_size,
+                                                       dir_scale)) != NULL)
+    {
+      /* Rendered at this size by gtk-update-icon-cache */
+    }
   else if (icon_info->is_resource)
     {
       if (icon_info->is_svg)
@@ -4039,6 +4270,25 @@ gtk_icon_info_load_surface (GtkIconInfo  *icon_info,
   return surface;
 }
 
+static void
+icon_info_take_load_result (GtkIconInfo *icon_info,
+                            GtkIconInfo *dup)
+{
+  /* Check if someone else updated the icon_info in between */
+  if (icon_info_get_pixbuf_ready (icon_info))
+    return;
+
+  /* If not, copy results from dup back to icon_info */
+  icon_info->emblems_applied = dup->emblems_applied;
+  icon_info->scale = dup->scale;
+  g_clear_object (&icon_info->pixbuf);
+  if (dup->pixbuf)
+    icon_info->pixbuf = g_object_ref (dup->pixbuf);
+  g_clear_error (&icon_info->load_error);
+  if (dup->load_error)
+    icon_info->load_error = g_error_copy (dup->load_error);
+}
+
 static void
 load_icon_thread  (GTask        *task,
                    gpointer      source_object,
@@ -4129,20 +4379,7 @@ gtk_icon_info_load_icon_finish (GtkIconInfo   *icon_info,
     return g_task_propagate_pointer (task, error);
 
   /* We ran the thread and it was not cancelled */
-
-  /* Check if someone else updated the icon_info in between */
-  if (!icon_info_get_pixbuf_ready (icon_info))
-    {
-      /* If not, copy results from dup back to icon_info */
-      icon_info->emblems_applied = dup->emblems_applied;
-      icon_info->scale = dup->scale;
-      g_clear_object (&icon_info->pixbuf);
-      if (dup->pixbuf)
-        icon_info->pixbuf = g_object_ref (dup->pixbuf);
-      g_clear_error (&icon_info->load_error);
-      if (dup->load_error)
-        icon_info->load_error = g_error_copy (dup->load_error);
-    }
+  icon_info_take_load_result (icon_info, dup);
 
   g_assert (icon_info_get_pixbuf_ready (icon_info));
 
@@ -4150,6 +4387,189 @@ gtk_icon_info_load_icon_finish (GtkIconInfo   *icon_info,
   return gtk_icon_info_load_icon (icon_info, error);
 }
 
+/* Icons are preloaded by a small pool of threads per call, each of
+ * which loads a copy of the info, like gtk_icon_info_load_icon_async().
+ * The results are moved back to the infos in the main context once all
+ * of them are done, and the infos are put in the LRU cache so that the
+ * following lookups find them loaded.
+ */
+#define PRELOAD_MAX_THREADS 4
+
+typedef struct
+{
+  GTask *task;
+  GPtrArray *infos;
+  GPtrArray *dups;
+  gint pending;
+} PreloadData;
+
+static void
+preload_data_free (gpointer data)
+{
+  PreloadData *preload = data;
+
+  g_ptr_array_unref (preload->infos);
+  g_ptr_array_unref (preload->dups);
+  g_free (preload);
+}
+
+static gboolean
+preload_done (gpointer data)
+{
+  PreloadData *preload = data;
+  GTask *task = preload->task;
+  guint i;
+
+  for (i = 0; i < preload->infos->len; i++)
+    {
+      GtkIconInfo *icon_info = g_ptr_array_index (preload->infos, i);
+      GtkIconInfo *dup = g_ptr_array_index (preload->dups, i);
+
+      if (!icon_info_get_pixbuf_ready (dup))
+        continue;
+
+      icon_info_take_load_result (icon_info, dup);
+
+      if (icon_info->in_cache != NULL)
+        ensure_in_lru_cache (icon_info->in_cache, icon_info);
+    }
+
+  if (!g_task_return_error_if_cancelled (task))
+    g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+preload_thread (gpointer data,
+                gpointer user_data)
+{
+  PreloadData *preload = user_data;
+  GtkIconInfo *dup = g_ptr_array_index (preload->dups, GPOINTER_TO_UINT (data) - 1);
+
+  if (!g_cancellable_is_cancelled (g_task_get_cancellable (preload->task)))
+    (void)icon_info_ensure_scale_and_pixbuf (dup);
+
+  if (g_atomic_int_dec_and_test (&preload->pending))
+    g_main_context_invoke (g_task_get_context (preload->task), preload_done, preload);
+}
+
+/**
+ * gtk_icon_theme_preload_async:
+ * @icon_theme: a #GtkIconTheme
+ * @icon_names: (array zero-terminated=1): the names of the icons to load
+ * @size: desired icon size
+ * @scale: the desired scale
+ * @flags: flags modifying the behavior of the icon lookup
+ * @cancellable: (allow-none): optional #GCancellable object, %NULL to ignore
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the
+ *     icons are loaded
+ * @user_data: (closure): the data to pass to callback function
+ *
+ * Looks up each of @icon_names, as gtk_icon_theme_lookup_icon_for_scale()
+ * does, and loads the icons that are found in worker threads.
+ *
+ * The loaded icons are kept in the cache of @icon_theme, so that looking
+ * them up again later with the same @size, @scale and @flags returns
+ * a #GtkIconInfo that can be rendered without loading the icon. This is
+ * useful to load the icons of a window before it is shown.
+ *
+ * Since: 3.94
+ */
+void
+gtk_icon_theme_preload_async (GtkIconTheme        *icon_theme,
+                              const gchar * const *icon_names,
+                              gint                 size,
+                              gint                 scale,
+                              GtkIconLookupFlags   flags,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+  PreloadData *preload;
+  GThreadPool *pool;
+  GTask *task;
+  guint i;
+
+  g_return_if_fail (GTK_IS_ICON_THEME (icon_theme));
+  g_return_if_fail (icon_names != NULL);
+  g_return_if_fail (scale >= 1);
+
+  task = g_task_new (icon_theme, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_icon_theme_preload_async);
+
+  preload = g_new0 (PreloadData, 1);
+  preload->task = task;
+  preload->infos = g_ptr_array_new_with_free_func (g_object_unref);
+  preload->dups = g_ptr_array_new_with_free_func (g_object_unref);
+  g_task_set_task_data (task, preload, preload_data_free);
+
+  for (i = 0; icon_names[i] != NULL; i++)
+    {
+      GtkIconInfo *icon_info;
+
+      icon_info = gtk_icon_theme_lookup_icon_for_scale (icon_theme, icon_names[i],
+                                                        size, scale, flags);
+      if (icon_info == NULL)
+        continue;
+
+      if (icon_info_get_pixbuf_ready (icon_info))
+        {
+          g_object_unref (icon_info);
+          continue;
+        }
+
+      g_ptr_array_add (preload->infos, icon_info);
+      g_ptr_array_add (preload->dups, icon_info_dup (icon_info));
+    }
+
+  if (preload->infos->len == 0)
+    {
+      g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+      return;
+    }
+
+  preload->pending = preload->infos->len;
+
+  pool = g_thread_pool_new (preload_thread, preload,
+                            MIN (preload->infos->len, PRELOAD_MAX_THREADS),
+                            FALSE, NULL);
+  for (i = 0; i < preload->infos->len; i++)
+    g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL);
+
+  /* The pool goes away once the queued icons are loaded */
+  g_thread_pool_free (pool, FALSE, FALSE);
+}
+
+/**
+ * gtk_icon_theme_preload_finish:
+ * @icon_theme: a #GtkIconTheme
+ * @result: a #GAsyncResult
+ * @error: (allow-none): location to store error information on failure,
+ *     or %NULL.
+ *
+ * Finishes a preload started with gtk_icon_theme_preload_async().
+ *
+ * Icons that could not be found or loaded are not considered an
+ * error; this only fails if the preload was cancelled.
+ *
+ * Returns: %TRUE if the icons were loaded
+ *
+ * Since: 3.94
+ */
+gboolean
+gtk_icon_theme_preload_finish (GtkIconTheme  *icon_theme,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, icon_theme), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_icon_theme_preload_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 static void
 proxy_symbolic_pixbuf_destroy (guchar   *pixels,
                                gpointer  data)
@@ -4200,17 +4620,6 @@ symbolic_cache_get_proxy (SymbolicPixbufCache *symbolic_cache,
   return symbolic_cache->proxy_pixbuf;
 }
 
-static gchar *
-rgba_to_string_noalpha (const GdkRGBA *rgba)
-{
-  GdkRGBA color;
-
-  color = *rgba;
-  color.alpha = 1.0;
-
-  return gdk_rgba_to_string (&color);
-}
-
 static void
 rgba_to_pixel(const GdkRGBA  *rgba,
 	      guint8 pixel[4])
@@ -4305,13 +4714,18 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   return colored;
 }
 
+/* Symbolic icons are loaded as a mask, with the fraction of the
+ * success, warning and error colors in the rgb channels. The renderers
+ * recolor that mask on the GPU; for pixbufs, we color it here, so the
+ * SVG only has to be rasterized once, whatever the colors.
+ */
 static GdkPixbuf *
-gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
+gtk_icon_info_load_symbolic_from_mask (GtkIconInfo    *icon_info,
+                                       const GdkRGBA  *fg,
+                                       const GdkRGBA  *success_color,
+                                       const GdkRGBA  *warning_color,
+                                       const GdkRGBA  *error_color,
+                                       GError        **error)
 {
   GdkRGBA fg_default = { 0.7450980392156863, 0.7450980392156863, 0.7450980392156863, 1.0};
   GdkRGBA success_default = { 0.3046921492332342,0.6015716792553597, 0.023437857633325704, 1.0};
@@ -4343,152 +4757,6 @@ gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                                error_color ? error_color : &error_default);
 }
 
-static GdkPixbuf *
-gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
-{
-  GInputStream *stream;
-  GdkPixbuf *pixbuf;
-  gchar *css_fg;
-  gchar *css_success;
-  gchar *css_warning;
-  gchar *css_error;
-  gchar *data;
-  gchar *width;
-  gchar *height;
-  gchar *file_data, *escaped_file_data;
-  gsize file_len;
-  gint symbolic_size;
-  double alpha;
-  gchar alphastr[G_ASCII_DTOSTR_BUF_SIZE];
-
-  alpha = fg->alpha;
-
-  css_fg = rgba_to_string_noalpha (fg);
-
-  css_success = css_warning = css_error = NULL;
-
-  if (warning_color)
-    css_warning = rgba_to_string_noalpha (warning_color);
-  else
-    css_warning = g_strdup ("rgb(245,121,62)");
-
-  if (error_color)
-    css_error = rgba_to_string_noalpha (error_color);
-  else
-    css_error = g_strdup ("rgb(204,0,0)");
-
-  if (success_color)
-    css_success = rgba_to_string_noalpha (success_color);
-  else
-    css_success = g_strdup ("rgb(78,154,6)");
-
-  if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
-    return NULL;
-
-  if (!icon_info_ensure_scale_and_pixbuf (icon_info))
-    {
-      g_propagate_error (error, icon_info->load_error);
-      icon_info->load_error = NULL;
-      g_free (css_fg);
-      g_free (css_warning);
-      g_free (css_error);
-      g_free (css_success);
-      g_free (file_data);
-      return NULL;
-    }
-
-  if (icon_info->symbolic_width == 0 ||
-      icon_info->symbolic_height == 0)
-    {
-      /* Fetch size from the original icon */
-      stream = g_memory_input_stream_new_from_data (file_data, file_len, NULL);
-      pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, error);
-      g_object_unref (stream);
-
-      if (!pixbuf)
-        {
-          g_free (css_fg);
-          g_free (css_warning);
-          g_free (css_error);
-          g_free (css_success);
-          g_free (file_data);
-          return NULL;
-        }
-
-      icon_info->symbolic_width = gdk_pixbuf_get_width (pixbuf);
-      icon_info->symbolic_height = gdk_pixbuf_get_height (pixbuf);
-      g_object_unref (pixbuf);
-    }
-
-  symbolic_size = MAX (icon_info->symbolic_width, icon_info->symbolic_height);
-
-  GTK_NOTE (ICONTHEME,
-  if (icon_info->dir_type == ICON_THEME_DIR_UNTHEMED)
-    g_message ("Symbolic icon %s is not in an icon theme directory",
-               icon_info->key.icon_names ? icon_info->key.icon_names[0] : icon_info->filename);
-  else if (icon_info->dir_size * icon_info->dir_scale != symbolic_size)
-    g_message ("Symbolic icon %s of size %d is in an icon theme directory of size %d",
-               icon_info->key.icon_names ? icon_info->key.icon_names[0] : icon_info->filename,
-               symbolic_size,
-               icon_info->dir_size * icon_info->dir_scale)
-  );
-
-  width = g_strdup_printf ("%d", icon_info->symbolic_width);
-  height = g_strdup_printf ("%d", icon_info->symbolic_height);
-
-  escaped_file_data = g_markup_escape_text (file_data, file_len);
-  g_free (file_data);
-
-  g_ascii_dtostr (alphastr, G_ASCII_DTOSTR_BUF_SIZE, CLAMP (alpha, 0, 1));
-
-  data = g_strconcat ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
-                      "<svg version=\"1.1\"\n"
-                      "     xmlns=\"http://www.w3.org/2000/svg\"\n"
-                      "     xmlns:xi=\"http://www.w3.org/2001/XInclude\"\n"
-                      "     width=\"", width, "\"\n"
-                      "     height=\"", height, "\">\n"
-                      "  <style type=\"text/css\">\n"
-                      "    rect,path {\n"
-                      "      fill: ", css_fg," !important;\n"
-                      "    }\n"
-                      "    .warning {\n"
-                      "      fill: ", css_warning, " !important;\n"
-                      "    }\n"
-                      "    .error {\n"
-                      "      fill: ", css_error ," !important;\n"
-                      "    }\n"
-                      "    .success {\n"
-                      "      fill: ", css_success, " !important;\n"
-                      "    }\n"
-                      "  </style>\n"
-                      "  <g opacity=\"", alphastr, "\" ><xi:include href=\"data:text/xml,", escaped_file_data, "\"/></g>\n"
-                      "</svg>",
-                      NULL);
-  g_free (escaped_file_data);
-  g_free (css_fg);
-  g_free (css_warning);
-  g_free (css_error);
-  g_free (css_success);
-  g_free (width);
-  g_free (height);
-
-  stream = g_memory_input_stream_new_from_data (data, -1, g_free);
-  pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
-                                                gdk_pixbuf_get_width (icon_info->pixbuf),
-                                                gdk_pixbuf_get_height (icon_info->pixbuf),
-                                                TRUE,
-                                                NULL,
-                                                error);
-  g_object_unref (stream);
-
-  return pixbuf;
-}
-
 
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
@@ -4501,7 +4769,6 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
 {
   GdkPixbuf *pixbuf;
   SymbolicPixbufCache *symbolic_cache;
-  char *icon_uri;
 
   if (use_cache)
     {
@@ -4516,13 +4783,7 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
    */
   g_return_val_if_fail (fg != NULL, NULL);
 
-  icon_uri = g_file_get_uri (icon_info->icon_file);
-  if (g_str_has_suffix (icon_uri, ".symbolic.png"))
-    pixbuf = gtk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
-  else
-    pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
-
-  g_free (icon_uri);
+  pixbuf = gtk_icon_info_load_symbolic_from_mask (icon_info, fg, success_color, warning_color, error_color, error);
 
   if (pixbuf != NULL)
     {
@@ -272,6 +272,26 @@ char *        gtk_icon_theme_get_example_icon_name (GtkIconTheme
 GDK_AVAILABLE_IN_ALL
 gboolean      gtk_icon_theme_rescan_if_needed      (GtkIconTheme                *icon_theme);
 
+GDK_AVAILABLE_IN_3_94
+void          gtk_icon_theme_set_cache_budget      (GtkIconTheme                *icon_theme,
+                                                    gsize                        budget);
+GDK_AVAILABLE_IN_3_94
+gsize         gtk_icon_theme_get_cache_budget      (GtkIconTheme                *icon_theme);
+
+GDK_AVAILABLE_IN_3_94
+void          gtk_icon_theme_preload_async         (GtkIconTheme                *icon_theme,
+                                                    const gchar * const         *icon_names,
+                                                    gint                         size,
+                                                    gint                         scale,
+                                                    GtkIconLookupFlags           flags,
+                                                    GCancellable                *cancellable,
+                                                    GAsyncReadyCallback          callback,
+                                                    gpointer                     user_data);
+GDK_AVAILABLE_IN_3_94
+gboolean      gtk_icon_theme_preload_finish        (GtkIconTheme                *icon_theme,
+                                                    GAsyncResult                *result,
+                                                    GError                     **error);
+
 GDK_AVAILABLE_IN_ALL
 GType                 gtk_icon_info_get_type           (void) G_GNUC_CONST;
 
@@ -1397,6 +1397,40 @@ gtk_icon_view_is_empty (GtkIconView *icon_view)
   return icon_view->priv->items == NULL;
 }
 
+static void
+gtk_icon_view_invalidate_item_size_cache (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  priv->n_item_sizes = 0;
+  priv->cell_area_context_valid = FALSE;
+}
+
+/* Returns whether the item sizes computed so far are still valid.
+ * They are only kept until the end of the frame they were computed
+ * in, so that changes to the cell renderers that don't tell us are
+ * picked up by the next relayout.
+ */
+static gboolean
+gtk_icon_view_check_item_size_cache (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GdkFrameClock *frame_clock;
+  gint64 frame;
+
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (icon_view));
+  frame = frame_clock ? gdk_frame_clock_get_frame_counter (frame_clock) : -1;
+
+  if (frame == -1 || frame != priv->item_size_frame)
+    {
+      gtk_icon_view_invalidate_item_size_cache (icon_view);
+      priv->item_size_frame = frame;
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static void
 gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
                                        GtkOrientation  orientation,
@@ -1407,22 +1441,61 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
   GtkIconViewPrivate *priv = icon_view->priv;
   GtkCellAreaContext *context;
   GList *items;
+  gint min, nat;
+  guint i;
 
   g_assert (!gtk_icon_view_is_empty (icon_view));
 
-  context = gtk_cell_area_create_context (priv->cell_area);
+  if (gtk_icon_view_check_item_size_cache (icon_view))
+    {
+      for (i = 0; i < priv->n_item_sizes; i++)
+        {
+          if (priv->item_sizes[i].orientation == orientation &&
+              priv->item_sizes[i].for_size == for_size)
+            {
+              if (minimum)
+                *minimum = priv->item_sizes[i].minimum;
+              if (natural)
+                *natural = priv->item_sizes[i].natural;
+              return;
+            }
+        }
+    }
+
+  if (!minimum)
+    minimum = &min;
+  if (!natural)
+    natural = &nat;
 
   for_size -= 2 * priv->item_padding;
 
-  if (for_size > 0)
+  if (orientation == GTK_ORIENTATION_HORIZONTAL && for_size <= 0)
+    {
+      /* These are the same widths that gtk_icon_view_layout() needs,
+       * so collect them in its context */
+      context = g_object_ref (priv->cell_area_context);
+      gtk_cell_area_context_reset (context);
+    }
+  else if (orientation == GTK_ORIENTATION_VERTICAL && for_size > 0 &&
+           priv->cell_area_context_valid)
+    {
+      /* The widths were collected already, no need to do that again */
+      context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+    }
+  else
     {
-      /* This is necessary for the context to work properly */
-      for (items = priv->items; items; items = items->next)
+      context = gtk_cell_area_create_context (priv->cell_area);
+
+      if (for_size > 0)
         {
-          GtkIconViewItem *item = items->data;
+          /* This is necessary for the context to work properly */
+          for (items = priv->items; items; items = items->next)
+            {
+              GtkIconViewItem *item = items->data;
 
-          _gtk_icon_view_set_cell_data (icon_view, item);
-          cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
+              _gtk_icon_view_set_cell_data (icon_view, item);
+              cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
+            }
         }
     }
 
@@ -1465,12 +1538,23 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
         *natural = *minimum;
     }
 
-  if (minimum)
-    *minimum = MAX (1, *minimum + 2 * priv->item_padding);
-  if (natural)
-    *natural = MAX (1, *natural + 2 * priv->item_padding);
+  *minimum = MAX (1, *minimum + 2 * priv->item_padding);
+  *natural = MAX (1, *natural + 2 * priv->item_padding);
 
   g_object_unref (context);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL && for_size <= 0)
+    priv->cell_area_context_valid = TRUE;
+
+  if (priv->item_size_frame != -1 &&
+      priv->n_item_sizes < G_N_ELEMENTS (priv->item_sizes))
+    {
+      i = priv->n_item_sizes++;
+      priv->item_sizes[i].orientation = orientation;
+      priv->item_sizes[i].for_size = for_size + 2 * priv->item_padding;
+      priv->item_sizes[i].minimum = *minimum;
+      priv->item_sizes[i].natural = *natural;
+    }
 }
 
 static void
@@ -2798,18 +2882,10 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   /* Clear the per row contexts */
   g_ptr_array_set_size (icon_view->priv->row_contexts, 0);
 
-  gtk_cell_area_context_reset (priv->cell_area_context);
-  /* because layouting is complicated. We designed an API
-   * that is O(N²) and nonsensical.
-   * And we're proud of it. */
-  for (items = priv->items; items; items = items->next)
-    {
-      _gtk_icon_view_set_cell_data (icon_view, items->data);
-      gtk_cell_area_get_preferred_width (priv->cell_area,
-                                         priv->cell_area_context,
-                                         widget,
-                                         NULL, NULL);
-    }
+  /* Computing the number of columns above collected the widths of all
+   * items in priv->cell_area_context, see
+   * gtk_icon_view_get_preferred_item_size().
+   */
 
   sizes = g_newa (GtkRequestedSize, n_rows);
   items = priv->items;
@@ -2890,6 +2966,8 @@ gtk_icon_view_layout (GtkIconView *icon_view)
 static void
 gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
 {
+  gtk_icon_view_invalidate_item_size_cache (icon_view);
+
   /* Clear all item sizes */
   g_list_foreach (icon_view->priv->items,
 		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
@@ -3295,6 +3373,7 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
     
   verify_items (icon_view);
 
+  gtk_icon_view_invalidate_item_size_cache (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -3350,6 +3429,7 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
 
   verify_items (icon_view);  
   
+  gtk_icon_view_invalidate_item_size_cache (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
   if (emit)
@@ -3398,6 +3478,7 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   g_list_free (icon_view->priv->items);
   icon_view->priv->items = items;
 
+  gtk_icon_view_invalidate_item_size_cache (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
   verify_items (icon_view);  
@@ -4833,6 +4914,7 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
   if (dirty)
     g_signal_emit (icon_view, icon_view_signals[SELECTION_CHANGED], 0);
 
+  gtk_icon_view_invalidate_item_size_cache (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -5489,6 +5571,7 @@ gtk_icon_view_set_columns (GtkIconView *icon_view,
       if (icon_view->priv->cell_area)
 	gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
+      gtk_icon_view_invalidate_item_size_cache (icon_view);
       gtk_widget_queue_resize (GTK_WIDGET (icon_view));
       
       g_object_notify (G_OBJECT (icon_view), "columns");
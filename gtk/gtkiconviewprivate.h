@@ -48,6 +48,20 @@ struct _GtkIconViewPrivate
 
   GPtrArray          *row_contexts;
 
+  /* Measuring and allocating asks for the same item sizes several
+   * times, each of which goes through all items. These are the results
+   * for the current frame, see gtk_icon_view_get_preferred_item_size().
+   */
+  gint64              item_size_frame;
+  gboolean            cell_area_context_valid;
+  struct {
+    GtkOrientation orientation;
+    gint for_size;
+    gint minimum;
+    gint natural;
+  } item_sizes[4];
+  guint               n_item_sizes;
+
   gint width, height;
   double mouse_x;
   double mouse_y;
@@ -27,6 +27,7 @@
 #include <math.h>
 #include <string.h>
 #include <cairo-gobject.h>
+#include <glib/gstdio.h>
 
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkiconhelperprivate.h"
@@ -83,8 +84,17 @@ struct _GtkImagePrivate
 
   gchar                *filename;       /* Only used with GTK_IMAGE_SURFACE */
   gchar                *resource_path;  /* Only used with GTK_IMAGE_SURFACE */
+
+  GCancellable         *load_cancellable; /* Set while a file is loaded in a thread */
+  int                   load_width;
+  int                   load_height;
 };
 
+/* Files at least this large are decoded in a thread. Smaller ones
+ * are cheaper to decode right away than to lay out twice.
+ */
+#define ASYNC_LOAD_THRESHOLD (64 * 1024)
+
 
 static void gtk_image_snapshot             (GtkWidget    *widget,
                                             GtkSnapshot  *snapshot);
@@ -600,7 +610,7 @@ gtk_image_new_from_gicon (GIcon *icon)
 }
 
 typedef struct {
-  GtkImage *image;
+  gint requested_scale;
   gint scale_factor;
 } LoaderData;
 
@@ -622,13 +632,13 @@ on_loader_size_prepared (GdkPixbufLoader *loader,
       return;
     }
 
-  scale_factor = gtk_widget_get_scale_factor (GTK_WIDGET (loader_data->image));
+  scale_factor = loader_data->requested_scale;
   gdk_pixbuf_loader_set_size (loader, width * scale_factor, height * scale_factor);
   loader_data->scale_factor = scale_factor;
 }
 
 static GdkPixbufAnimation *
-load_scalable_with_loader (GtkImage    *image,
+load_scalable_with_loader (gint         requested_scale,
 			   const gchar *file_path,
 			   const gchar *resource_path,
 			   gint        *scale_factor_out)
@@ -645,7 +655,7 @@ load_scalable_with_loader (GtkImage    *image,
   bytes = NULL;
 
   loader = gdk_pixbuf_loader_new ();
-  loader_data.image = image;
+  loader_data.requested_scale = requested_scale;
 
   g_signal_connect (loader, "size-prepared", G_CALLBACK (on_loader_size_prepared), &loader_data);
 
@@ -689,12 +699,135 @@ load_scalable_with_loader (GtkImage    *image,
   return animation;
 }
 
+typedef struct {
+  gchar *filename;
+  gint requested_scale;
+  gint scale_factor;
+} AsyncLoadData;
+
+static void
+async_load_data_free (gpointer data)
+{
+  AsyncLoadData *load_data = data;
+
+  g_free (load_data->filename);
+  g_slice_free (AsyncLoadData, load_data);
+}
+
+static void
+load_file_thread (GTask        *task,
+                  gpointer      source_object,
+                  gpointer      task_data,
+                  GCancellable *cancellable)
+{
+  AsyncLoadData *load_data = task_data;
+  GdkPixbufAnimation *anim;
+
+  anim = load_scalable_with_loader (load_data->requested_scale,
+                                    load_data->filename, NULL,
+                                    &load_data->scale_factor);
+  if (anim)
+    g_task_return_pointer (task, anim, g_object_unref);
+  else
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "Failed to load %s", load_data->filename);
+}
+
+static void
+load_file_done (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  GtkImage *image = GTK_IMAGE (source);
+  GtkImagePrivate *priv = gtk_image_get_instance_private (image);
+  AsyncLoadData *load_data = g_task_get_task_data (G_TASK (result));
+  GdkPixbufAnimation *anim;
+  cairo_surface_t *surface;
+  gchar *filename;
+
+  anim = g_task_propagate_pointer (G_TASK (result), NULL);
+
+  /* The image was changed while we were loading */
+  if (g_task_get_cancellable (G_TASK (result)) != priv->load_cancellable)
+    {
+      g_clear_object (&anim);
+      return;
+    }
+
+  g_clear_object (&priv->load_cancellable);
+
+  /* Setting the image clears the filename, so keep it around */
+  filename = priv->filename;
+  priv->filename = NULL;
+
+  g_object_freeze_notify (G_OBJECT (image));
+
+  if (anim)
+    {
+      surface = gdk_cairo_surface_create_from_pixbuf (gdk_pixbuf_animation_get_static_image (anim),
+                                                      load_data->scale_factor,
+                                                      _gtk_widget_get_window (GTK_WIDGET (image)));
+      gtk_image_set_from_surface (image, surface);
+      cairo_surface_destroy (surface);
+      g_object_unref (anim);
+    }
+  else
+    gtk_image_set_from_icon_name (image, "image-missing");
+
+  priv->filename = filename;
+
+  g_object_thaw_notify (G_OBJECT (image));
+}
+
+/* Starts loading @filename in a thread if it is large enough for
+ * that to be worth it. Until the image is loaded, its size is the
+ * one found in the file header.
+ */
+static gboolean
+gtk_image_load_file_async (GtkImage    *image,
+                           const gchar *filename)
+{
+  GtkImagePrivate *priv = gtk_image_get_instance_private (image);
+  AsyncLoadData *load_data;
+  GStatBuf buf;
+  GTask *task;
+  int width, height;
+
+  if (g_stat (filename, &buf) != 0 || buf.st_size < ASYNC_LOAD_THRESHOLD)
+    return FALSE;
+
+  if (gdk_pixbuf_get_file_info (filename, &width, &height) == NULL)
+    return FALSE;
+
+  load_data = g_slice_new (AsyncLoadData);
+  load_data->filename = g_strdup (filename);
+  load_data->requested_scale = gtk_widget_get_scale_factor (GTK_WIDGET (image));
+  load_data->scale_factor = 1;
+
+  priv->load_cancellable = g_cancellable_new ();
+  priv->load_width = width;
+  priv->load_height = height;
+
+  task = g_task_new (image, priv->load_cancellable, load_file_done, NULL);
+  g_task_set_source_tag (task, gtk_image_load_file_async);
+  g_task_set_task_data (task, load_data, async_load_data_free);
+  g_task_run_in_thread (task, load_file_thread);
+  g_object_unref (task);
+
+  gtk_widget_queue_resize (GTK_WIDGET (image));
+
+  return TRUE;
+}
+
 /**
  * gtk_image_set_from_file:
  * @image: a #GtkImage
  * @filename: (type filename) (allow-none): a filename or %NULL
  *
  * See gtk_image_new_from_file() for details.
+ *
+ * Large files are loaded in a thread. Until loading finishes, the
+ * image stays empty but is sized like the image in the file.
  **/
 void
 gtk_image_set_from_file   (GtkImage    *image,
@@ -718,7 +851,15 @@ gtk_image_set_from_file   (GtkImage    *image,
       return;
     }
 
-  anim = load_scalable_with_loader (image, filename, NULL, &scale_factor);
+  if (gtk_image_load_file_async (image, filename))
+    {
+      priv->filename = g_strdup (filename);
+      g_object_thaw_notify (G_OBJECT (image));
+      return;
+    }
+
+  anim = load_scalable_with_loader (gtk_widget_get_scale_factor (GTK_WIDGET (image)),
+                                    filename, NULL, &scale_factor);
 
   if (anim == NULL)
     {
@@ -804,7 +945,8 @@ gtk_image_set_from_resource (GtkImage    *image,
     }
   else
     {
-      animation = load_scalable_with_loader (image, NULL, resource_path, &scale_factor);
+      animation = load_scalable_with_loader (gtk_widget_get_scale_factor (GTK_WIDGET (image)),
+                                             NULL, resource_path, &scale_factor);
     }
 
   if (animation == NULL)
@@ -1310,6 +1452,13 @@ gtk_image_clear (GtkImage *image)
       g_object_notify_by_pspec (G_OBJECT (image), image_props[PROP_RESOURCE]);
     }
 
+  if (priv->load_cancellable)
+    {
+      g_cancellable_cancel (priv->load_cancellable);
+      g_clear_object (&priv->load_cancellable);
+      gtk_widget_queue_resize (GTK_WIDGET (image));
+    }
+
   _gtk_icon_helper_clear (&priv->icon_helper);
 
   g_object_thaw_notify (G_OBJECT (image));
@@ -1328,7 +1477,13 @@ gtk_image_measure (GtkWidget      *widget,
   gint width, height;
   float baseline_align;
 
-  _gtk_icon_helper_get_size (&priv->icon_helper, &width, &height);
+  if (priv->load_cancellable)
+    {
+      width = priv->load_width;
+      height = priv->load_height;
+    }
+  else
+    _gtk_icon_helper_get_size (&priv->icon_helper, &width, &height);
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
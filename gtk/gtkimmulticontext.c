@@ -21,6 +21,7 @@
 #include <locale.h>
 
 #include "gtkimmulticontext.h"
+#include "gtkdebug.h"
 #include "gtkimmoduleprivate.h"
 #include "gtkintl.h"
 #include "gtklabel.h"
@@ -38,6 +39,9 @@
  */
 
 
+/* Filtering a key event for longer than this (in µs) is reported */
+#define SLOW_FILTER_TIME (20 * 1000)
+
 struct _GtkIMMulticontextPrivate
 {
   GtkIMContext          *slave;
@@ -355,7 +359,24 @@ gtk_im_multicontext_filter_keypress (GtkIMContext *context,
 
   if (slave)
     {
-      return gtk_im_context_filter_keypress (slave, event);
+      GtkIMMulticontextPrivate *priv = multicontext->priv;
+      gint64 before, duration;
+      gboolean result;
+
+      /* Input methods may do round trips to their servers here, which
+       * shows up as typing latency; make it visible.
+       */
+      before = g_get_monotonic_time ();
+      result = gtk_im_context_filter_keypress (slave, event);
+      duration = g_get_monotonic_time () - before;
+
+      gdk_profiler_add_mark (before, duration, "im filter keypress", priv->context_id);
+      GTK_NOTE (MODULES,
+                if (duration > SLOW_FILTER_TIME)
+                  g_message ("Input method %s took %" G_GINT64_FORMAT " ms to filter a key event",
+                             priv->context_id, duration / 1000));
+
+      return result;
     }
   else if (gdk_event_get_keyval ((GdkEvent *) event, &keyval) &&
            gdk_event_get_state ((GdkEvent *) event, &state))
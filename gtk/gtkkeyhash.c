@@ -37,15 +37,67 @@ struct _GtkKeyHashEntry
   gint n_keys;
 };
 
+typedef struct _GtkKeyHashLookup GtkKeyHashLookup;
+
+/* The arguments of a _gtk_key_hash_lookup() call, used as the key
+ * of the cache of lookup results
+ */
+struct _GtkKeyHashLookup
+{
+  guint16 hardware_keycode;
+  GdkModifierType state;
+  GdkModifierType mask;
+  gint group;
+};
+
 struct _GtkKeyHash
 {
   GdkKeymap *keymap;
   GHashTable *keycode_hash;
   GHashTable *reverse_hash;
+  GHashTable *lookup_cache;
   GList *entries_list;
   GDestroyNotify destroy_notify;
 };
 
+/* The cache is dropped when it grows beyond this, which only happens
+ * with lots of different modifier states or keyboard groups.
+ */
+#define MAX_CACHED_LOOKUPS 256
+
+static guint
+key_hash_lookup_hash (gconstpointer data)
+{
+  const GtkKeyHashLookup *lookup = data;
+
+  return lookup->hardware_keycode ^ (lookup->state << 8) ^ (lookup->mask << 16) ^ (lookup->group << 28);
+}
+
+static gboolean
+key_hash_lookup_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const GtkKeyHashLookup *lookup_a = a;
+  const GtkKeyHashLookup *lookup_b = b;
+
+  return lookup_a->hardware_keycode == lookup_b->hardware_keycode &&
+         lookup_a->state == lookup_b->state &&
+         lookup_a->mask == lookup_b->mask &&
+         lookup_a->group == lookup_b->group;
+}
+
+static void
+key_hash_lookup_free (gpointer data)
+{
+  g_slice_free (GtkKeyHashLookup, data);
+}
+
+static void
+key_hash_clear_lookup_cache (GtkKeyHash *key_hash)
+{
+  g_hash_table_remove_all (key_hash->lookup_cache);
+}
+
 static void
 key_hash_clear_keycode (gpointer key,
 			gpointer value,
@@ -103,6 +155,8 @@ key_hash_keys_changed (GdkKeymap  *keymap,
 {
   /* The keymap changed, so we have to regenerate the keycode hash
    */
+  key_hash_clear_lookup_cache (key_hash);
+
   if (key_hash->keycode_hash)
     {
       g_hash_table_foreach (key_hash->keycode_hash, key_hash_clear_keycode, NULL);
@@ -134,6 +188,10 @@ _gtk_key_hash_new (GdkKeymap      *keymap,
   key_hash->entries_list = NULL;
   key_hash->keycode_hash = NULL;
   key_hash->reverse_hash = g_hash_table_new (g_direct_hash, NULL);
+  key_hash->lookup_cache = g_hash_table_new_full (key_hash_lookup_hash,
+                                                  key_hash_lookup_equal,
+                                                  key_hash_lookup_free,
+                                                  (GDestroyNotify) g_slist_free);
   key_hash->destroy_notify = item_destroy_notify;
 
   return key_hash;
@@ -180,6 +238,7 @@ _gtk_key_hash_free (GtkKeyHash *key_hash)
     }
   
   g_hash_table_destroy (key_hash->reverse_hash);
+  g_hash_table_destroy (key_hash->lookup_cache);
 
   g_list_foreach (key_hash->entries_list, key_hash_free_entry_foreach, key_hash);
   g_list_free (key_hash->entries_list);
@@ -209,6 +268,8 @@ _gtk_key_hash_add_entry (GtkKeyHash      *key_hash,
   entry->modifiers = modifiers;
   entry->keys = NULL;
 
+  key_hash_clear_lookup_cache (key_hash);
+
   key_hash->entries_list = g_list_prepend (key_hash->entries_list, entry);
   g_hash_table_insert (key_hash->reverse_hash, value, key_hash->entries_list);
 
@@ -234,6 +295,8 @@ _gtk_key_hash_remove_entry (GtkKeyHash *key_hash,
     {
       GtkKeyHashEntry *entry = entry_node->data;
 
+      key_hash_clear_lookup_cache (key_hash);
+
       if (key_hash->keycode_hash)
 	{
 	  gint i;
@@ -352,36 +415,15 @@ keyval_in_group (GdkKeymap  *keymap,
   return FALSE;
 }
 
-/**
- * _gtk_key_hash_lookup:
- * @key_hash: a #GtkKeyHash
- * @hardware_keycode: hardware keycode field from a #GdkEventKey
- * @state: state field from a #GdkEventKey
- * @mask: mask of modifiers to consider when matching against the
- *        modifiers in entries.
- * @group: group field from a #GdkEventKey
- * 
- * Looks up the best matching entry or entries in the hash table for
- * a given event. The results are sorted so that entries with less
- * modifiers come before entries with more modifiers.
- * 
- * The matches returned by this function can be exact (i.e. keycode, level
- * and group all match) or fuzzy (i.e. keycode and level match, but group
- * does not). As long there are any exact matches, only exact matches
- * are returned. If there are no exact matches, fuzzy matches will be
- * returned, as long as they are not shadowing a possible exact match.
- * This means that fuzzy matches won’t be considered if their keyval is 
- * present in the current group.
- * 
- * Returns: A newly-allocated #GSList of matching entries.
- *     Free with g_slist_free() when no longer needed.
+/* Does the work of _gtk_key_hash_lookup(), returning the entries
+ * instead of their values
  */
-GSList *
-_gtk_key_hash_lookup (GtkKeyHash      *key_hash,
-		      guint16          hardware_keycode,
-		      GdkModifierType  state,
-		      GdkModifierType  mask,
-		      gint             group)
+static GSList *
+key_hash_lookup_entries (GtkKeyHash      *key_hash,
+                         guint16          hardware_keycode,
+                         GdkModifierType  state,
+                         GdkModifierType  mask,
+                         gint             group)
 {
   GHashTable *keycode_hash = key_hash_get_keycode_hash (key_hash);
   GSList *keys = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER ((guint)hardware_keycode));
@@ -516,7 +558,61 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
         }
     }
     
-  results = sort_lookup_results (results);
+  return sort_lookup_results (results);
+}
+
+/**
+ * _gtk_key_hash_lookup:
+ * @key_hash: a #GtkKeyHash
+ * @hardware_keycode: hardware keycode field from a #GdkEventKey
+ * @state: state field from a #GdkEventKey
+ * @mask: mask of modifiers to consider when matching against the
+ *        modifiers in entries.
+ * @group: group field from a #GdkEventKey
+ * 
+ * Looks up the best matching entry or entries in the hash table for
+ * a given event. The results are sorted so that entries with less
+ * modifiers come before entries with more modifiers.
+ * 
+ * The matches returned by this function can be exact (i.e. keycode, level
+ * and group all match) or fuzzy (i.e. keycode and level match, but group
+ * does not). As long there are any exact matches, only exact matches
+ * are returned. If there are no exact matches, fuzzy matches will be
+ * returned, as long as they are not shadowing a possible exact match.
+ * This means that fuzzy matches won’t be considered if their keyval is 
+ * present in the current group.
+ *
+ * The results are remembered until the keymap or the entries of
+ * @key_hash change, so that repeated key presses don't have to go
+ * through the keymap again.
+ * 
+ * Returns: A newly-allocated #GSList of matching entries.
+ *     Free with g_slist_free() when no longer needed.
+ */
+GSList *
+_gtk_key_hash_lookup (GtkKeyHash      *key_hash,
+		      guint16          hardware_keycode,
+		      GdkModifierType  state,
+		      GdkModifierType  mask,
+		      gint             group)
+{
+  GtkKeyHashLookup lookup = { hardware_keycode, state, mask, group };
+  GSList *entries, *results, *l;
+
+  if (!g_hash_table_lookup_extended (key_hash->lookup_cache, &lookup,
+                                     NULL, (gpointer *) &entries))
+    {
+      entries = key_hash_lookup_entries (key_hash, hardware_keycode, state, mask, group);
+
+      if (g_hash_table_size (key_hash->lookup_cache) >= MAX_CACHED_LOOKUPS)
+        key_hash_clear_lookup_cache (key_hash);
+
+      g_hash_table_insert (key_hash->lookup_cache,
+                           g_slice_dup (GtkKeyHashLookup, &lookup),
+                           entries);
+    }
+
+  results = g_slist_copy (entries);
   for (l = results; l; l = l->next)
     l->data = ((GtkKeyHashEntry *)l->data)->value;
 
@@ -247,6 +247,9 @@
  * the #GtkLabel::activate-link signal and the gtk_label_get_current_uri() function.
  */
 
+/* Height-for-width asks for a few widths before the allocation */
+#define N_MEASURING_LAYOUTS 3
+
 struct _GtkLabelPrivate
 {
   GtkLabelSelectionInfo *select_info;
@@ -256,6 +259,8 @@ struct _GtkLabelPrivate
   PangoAttrList *attrs;
   PangoAttrList *markup_attrs;
   PangoLayout   *layout;
+  /* Copies of layout with other widths, most recently used first */
+  PangoLayout   *measuring_layouts[N_MEASURING_LAYOUTS];
 
   gchar   *label;
   gchar   *text;
@@ -2157,7 +2162,7 @@ gtk_label_recalculate (GtkLabel *label)
 
   gtk_label_clear_layout (label);
   gtk_label_clear_select_info (label);
-  gtk_widget_queue_resize (GTK_WIDGET (label));
+  gtk_widget_queue_resize_checked (GTK_WIDGET (label));
 }
 
 /**
@@ -2226,7 +2231,7 @@ gtk_label_set_attributes (GtkLabel         *label,
   g_object_notify_by_pspec (G_OBJECT (label), label_props[PROP_ATTRIBUTES]);
 
   gtk_label_clear_layout (label);
-  gtk_widget_queue_resize (GTK_WIDGET (label));
+  gtk_widget_queue_resize_checked (GTK_WIDGET (label));
 }
 
 /**
@@ -3207,7 +3212,7 @@ gtk_label_finalize (GObject *object)
   g_free (priv->label);
   g_free (priv->text);
 
-  g_clear_object (&priv->layout);
+  gtk_label_clear_layout (label);
   g_clear_pointer (&priv->attrs, pango_attr_list_unref);
   g_clear_pointer (&priv->markup_attrs, pango_attr_list_unref);
 
@@ -3225,12 +3230,64 @@ gtk_label_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_label_parent_class)->finalize (object);
 }
 
+static void
+gtk_label_clear_measuring_layouts (GtkLabel *label)
+{
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+  guint i;
+
+  for (i = 0; i < N_MEASURING_LAYOUTS; i++)
+    g_clear_object (&priv->measuring_layouts[i]);
+}
+
 static void
 gtk_label_clear_layout (GtkLabel *label)
 {
   GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
 
   g_clear_object (&priv->layout);
+  gtk_label_clear_measuring_layouts (label);
+}
+
+/* Returns the measuring layout for @width and makes it the most
+ * recently used one. The layout is owned by the label.
+ */
+static PangoLayout *
+gtk_label_find_measuring_layout (GtkLabel *label,
+                                 int       width)
+{
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+  PangoLayout *layout;
+  guint i;
+
+  for (i = 0; i < N_MEASURING_LAYOUTS; i++)
+    {
+      layout = priv->measuring_layouts[i];
+      if (layout == NULL)
+        return NULL;
+
+      if (pango_layout_get_width (layout) == width)
+        {
+          memmove (&priv->measuring_layouts[1], &priv->measuring_layouts[0],
+                   i * sizeof (PangoLayout *));
+          priv->measuring_layouts[0] = layout;
+          return layout;
+        }
+    }
+
+  return NULL;
+}
+
+static void
+gtk_label_add_measuring_layout (GtkLabel    *label,
+                                PangoLayout *layout)
+{
+  GtkLabelPrivate *priv = gtk_label_get_instance_private (label);
+
+  g_clear_object (&priv->measuring_layouts[N_MEASURING_LAYOUTS - 1]);
+  memmove (&priv->measuring_layouts[1], &priv->measuring_layouts[0],
+           (N_MEASURING_LAYOUTS - 1) * sizeof (PangoLayout *));
+  priv->measuring_layouts[0] = g_object_ref (layout);
 }
 
 /**
@@ -3255,19 +3312,27 @@ gtk_label_get_measuring_layout (GtkLabel *   label,
   PangoRectangle rect;
   PangoLayout *copy;
 
+  /* Measuring layouts are kept around, so don't change the width
+   * of @existing_layout.
+   */
   if (existing_layout != NULL)
-    {
-      if (existing_layout != priv->layout)
-        {
-          pango_layout_set_width (existing_layout, width);
-          return existing_layout;
-        }
-
-      g_object_unref (existing_layout);
-    }
+    g_object_unref (existing_layout);
 
   gtk_label_ensure_layout (label);
 
+  /* Labels with the same text and font measure the same, so they
+   * can share the layouts for that. Only drawing needs our own.
+   * Wrapping labels get allocated the widths they were measured
+   * for, so they keep those layouts to use them for drawing, see
+   * gtk_label_size_allocate().
+   */
+  if (!priv->wrap || width == -1)
+    {
+      copy = _gtk_pango_layout_get_shared (priv->layout, width);
+      if (copy)
+        return copy;
+    }
+
   if (pango_layout_get_width (priv->layout) == width)
     {
       g_object_ref (priv->layout);
@@ -3299,8 +3364,13 @@ gtk_label_get_measuring_layout (GtkLabel *   label,
       return priv->layout;
     }
 
+  copy = gtk_label_find_measuring_layout (label, width);
+  if (copy)
+    return g_object_ref (copy);
+
   copy = pango_layout_copy (priv->layout);
   pango_layout_set_width (copy, width);
+  gtk_label_add_measuring_layout (label, copy);
   return copy;
 }
 
@@ -3359,6 +3429,7 @@ gtk_label_update_layout_attributes (GtkLabel *label)
   attrs = _gtk_pango_attr_list_merge (attrs, priv->attrs);
 
   pango_layout_set_attributes (priv->layout, attrs);
+  gtk_label_clear_measuring_layouts (label);
 
   if (attrs)
     pango_attr_list_unref (attrs);
@@ -3725,7 +3796,16 @@ gtk_label_size_allocate (GtkWidget           *widget,
 
   if (priv->layout)
     {
-      if (priv->ellipsize || priv->wrap)
+      PangoLayout *measured;
+
+      /* Use the layout that measured this width, it already knows
+       * where the lines break.
+       */
+      if (priv->wrap &&
+          pango_layout_get_width (priv->layout) != allocation->width * PANGO_SCALE &&
+          (measured = gtk_label_find_measuring_layout (label, allocation->width * PANGO_SCALE)))
+        g_set_object (&priv->layout, measured);
+      else if (priv->ellipsize || priv->wrap)
         pango_layout_set_width (priv->layout,
                                 allocation->width * PANGO_SCALE);
       else
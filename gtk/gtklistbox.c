@@ -118,6 +118,19 @@ typedef struct
   GtkListBoxCreateWidgetFunc create_widget_func;
   gpointer create_widget_func_data;
   GDestroyNotify create_widget_func_data_destroy;
+
+  /* Only rows for the items in view exist when bound with
+   * gtk_list_box_bind_model_virtual(). children then holds the rows
+   * for the items starting at virtual_first, and the rows that went
+   * out of view are kept in recycled_rows for reuse.
+   */
+  gboolean virtual_model;
+  GtkListBoxBindWidgetFunc bind_widget_func;
+  GtkListBoxBindWidgetFunc unbind_widget_func;
+  GPtrArray *recycled_rows;
+  guint virtual_first;
+  gint virtual_row_height;
+  guint virtual_tick_id;
 } GtkListBoxPrivate;
 
 typedef struct
@@ -125,12 +138,14 @@ typedef struct
   GSequenceIter *iter;
   GtkWidget *header;
   GtkActionHelper *action_helper;
+  GObject *item;
   gint y;
   gint height;
   guint visible     :1;
   guint selected    :1;
   guint activatable :1;
   guint selectable  :1;
+  guint wraps_widget :1;
 } GtkListBoxRowPrivate;
 
 enum {
@@ -278,6 +293,8 @@ static void                 gtk_list_box_bound_model_changed            (GListMo
                                                                          gpointer             user_data);
 
 static void                 gtk_list_box_check_model_compat             (GtkListBox          *box);
+static void                 gtk_list_box_unbind_model                   (GtkListBox          *box);
+static void                 gtk_list_box_queue_virtual_update           (GtkListBox          *box);
 
 static void gtk_list_box_measure (GtkWidget     *widget,
                                   GtkOrientation  orientation,
@@ -371,6 +388,9 @@ gtk_list_box_finalize (GObject *obj)
   if (priv->update_header_func_target_destroy_notify != NULL)
     priv->update_header_func_target_destroy_notify (priv->update_header_func_target);
 
+  if (priv->adjustment)
+    g_signal_handlers_disconnect_by_func (priv->adjustment,
+                                          gtk_list_box_queue_virtual_update, obj);
   g_clear_object (&priv->adjustment);
   g_clear_object (&priv->drag_highlighted_row);
   g_clear_object (&priv->multipress_gesture);
@@ -387,6 +407,9 @@ gtk_list_box_finalize (GObject *obj)
       g_clear_object (&priv->bound_model);
     }
 
+  g_ptr_array_foreach (priv->recycled_rows, (GFunc) g_object_unref, NULL);
+  g_ptr_array_unref (priv->recycled_rows);
+
   G_OBJECT_CLASS (gtk_list_box_parent_class)->finalize (obj);
 }
 
@@ -623,6 +646,7 @@ gtk_list_box_init (GtkListBox *box)
 
   priv->children = g_sequence_new (NULL);
   priv->header_hash = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, NULL);
+  priv->recycled_rows = g_ptr_array_new ();
 
   priv->multipress_gesture = gtk_gesture_multi_press_new (widget);
   gtk_event_controller_set_propagation_phase (GTK_EVENT_CONTROLLER (priv->multipress_gesture),
@@ -686,6 +710,10 @@ gtk_list_box_get_row_at_index (GtkListBox *box,
 
   g_return_val_if_fail (GTK_IS_LIST_BOX (box), NULL);
 
+  index_ -= BOX_PRIV (box)->virtual_first;
+  if (index_ < 0)
+    return NULL;
+
   iter = g_sequence_get_iter_at_pos (BOX_PRIV (box)->children, index_);
   if (!g_sequence_iter_is_end (iter))
     return g_sequence_get (iter);
@@ -986,8 +1014,22 @@ gtk_list_box_set_adjustment (GtkListBox    *box,
   if (adjustment)
     g_object_ref_sink (adjustment);
   if (priv->adjustment)
-    g_object_unref (priv->adjustment);
+    {
+      g_signal_handlers_disconnect_by_func (priv->adjustment,
+                                            gtk_list_box_queue_virtual_update, box);
+      g_object_unref (priv->adjustment);
+    }
   priv->adjustment = adjustment;
+
+  if (adjustment)
+    {
+      g_signal_connect_swapped (adjustment, "value-changed",
+                                G_CALLBACK (gtk_list_box_queue_virtual_update), box);
+      g_signal_connect_swapped (adjustment, "changed",
+                                G_CALLBACK (gtk_list_box_queue_virtual_update), box);
+    }
+
+  gtk_list_box_queue_virtual_update (box);
 }
 
 /**
@@ -2539,6 +2581,11 @@ gtk_list_box_measure (GtkWidget     *widget,
           *minimum += row_min;
         }
 
+      /* Items without a row are assumed to be as high as the average row */
+      if (priv->virtual_model)
+        *minimum += ((gint) g_list_model_get_n_items (priv->bound_model)
+                     - g_sequence_get_length (priv->children)) * priv->virtual_row_height;
+
       /* We always allocate the minimum height, since handling expanding rows
        * is way too costly, and unlikely to be used, as lists are generally put
        * inside a scrolling window anyway.
@@ -2584,6 +2631,8 @@ gtk_list_box_size_allocate (GtkWidget           *widget,
       child_allocation.y += child_min;
     }
 
+  child_allocation.y += (gint) priv->virtual_first * priv->virtual_row_height;
+
   for (iter = g_sequence_get_begin_iter (priv->children);
        !g_sequence_iter_is_end (iter);
        iter = g_sequence_iter_next (iter))
@@ -3176,7 +3225,12 @@ gtk_list_box_row_get_index (GtkListBoxRow *row)
   priv = ROW_PRIV (row);
 
   if (priv->iter != NULL)
-    return g_sequence_iter_get_position (priv->iter);
+    {
+      GtkListBox *box = gtk_list_box_row_get_box (row);
+      gint offset = box ? BOX_PRIV (box)->virtual_first : 0;
+
+      return g_sequence_iter_get_position (priv->iter) + offset;
+    }
 
   return -1;
 }
@@ -3439,6 +3493,7 @@ static void
 gtk_list_box_row_finalize (GObject *obj)
 {
   g_clear_object (&ROW_PRIV (GTK_LIST_BOX_ROW (obj))->header);
+  g_clear_object (&ROW_PRIV (GTK_LIST_BOX_ROW (obj))->item);
 
   G_OBJECT_CLASS (gtk_list_box_row_parent_class)->finalize (obj);
 }
@@ -3568,6 +3623,274 @@ gtk_list_box_buildable_interface_init (GtkBuildableIface *iface)
   iface->add_child = gtk_list_box_buildable_add_child;
 }
 
+static GtkWidget *
+gtk_list_box_row_get_item_widget (GtkListBoxRow *row)
+{
+  if (ROW_PRIV (row)->wraps_widget)
+    return gtk_bin_get_child (GTK_BIN (row));
+
+  return GTK_WIDGET (row);
+}
+
+/* Returns a row for @item, either a recycled one or a new one
+ * from the create_widget_func. The caller owns a reference.
+ */
+static GtkListBoxRow *
+gtk_list_box_obtain_virtual_row (GtkListBox *box,
+                                 GObject    *item)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GtkListBoxRow *row;
+  GtkWidget *widget;
+
+  if (priv->recycled_rows->len > 0)
+    {
+      row = g_ptr_array_index (priv->recycled_rows, priv->recycled_rows->len - 1);
+      g_ptr_array_remove_index_fast (priv->recycled_rows, priv->recycled_rows->len - 1);
+
+      priv->bind_widget_func (gtk_list_box_row_get_item_widget (row),
+                              item,
+                              priv->create_widget_func_data);
+    }
+  else
+    {
+      widget = priv->create_widget_func (item, priv->create_widget_func_data);
+      if (g_object_is_floating (widget))
+        g_object_ref_sink (widget);
+
+      gtk_widget_show (widget);
+
+      if (GTK_IS_LIST_BOX_ROW (widget))
+        row = GTK_LIST_BOX_ROW (widget);
+      else
+        {
+          row = GTK_LIST_BOX_ROW (gtk_list_box_row_new ());
+          g_object_ref_sink (row);
+          gtk_container_add (GTK_CONTAINER (row), widget);
+          ROW_PRIV (row)->wraps_widget = TRUE;
+          g_object_unref (widget);
+        }
+    }
+
+  ROW_PRIV (row)->item = g_object_ref (item);
+
+  return row;
+}
+
+static void
+gtk_list_box_recycle_row (GtkListBox    *box,
+                          GtkListBoxRow *row)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GtkListBoxRowPrivate *row_priv = ROW_PRIV (row);
+
+  g_ptr_array_add (priv->recycled_rows, g_object_ref (row));
+  gtk_container_remove (GTK_CONTAINER (box), GTK_WIDGET (row));
+  gtk_list_box_row_set_selected (row, FALSE);
+
+  if (priv->unbind_widget_func)
+    priv->unbind_widget_func (gtk_list_box_row_get_item_widget (row),
+                              row_priv->item,
+                              priv->create_widget_func_data);
+  g_clear_object (&row_priv->item);
+}
+
+static void
+gtk_list_box_recycle_all_rows (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  while (g_sequence_get_length (priv->children) > 0)
+    gtk_list_box_recycle_row (box, g_sequence_get (g_sequence_get_begin_iter (priv->children)));
+
+  priv->virtual_first = 0;
+}
+
+static void
+gtk_list_box_add_virtual_row (GtkListBox *box,
+                              guint       position,
+                              gboolean    prepend)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GtkListBoxRow *row;
+  GObject *item;
+
+  item = g_list_model_get_item (priv->bound_model, position);
+  row = gtk_list_box_obtain_virtual_row (box, item);
+  gtk_list_box_insert (box, GTK_WIDGET (row), prepend ? 0 : -1);
+  g_object_unref (row);
+  g_object_unref (item);
+}
+
+static gint
+gtk_list_box_estimate_row_height (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GSequenceIter *iter;
+  gint width, height, total, n;
+
+  width = gtk_widget_get_width (GTK_WIDGET (box));
+  if (width <= 0)
+    width = -1;
+
+  total = n = 0;
+  for (iter = g_sequence_get_begin_iter (priv->children);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      gtk_widget_measure (g_sequence_get (iter), GTK_ORIENTATION_VERTICAL, width,
+                          &height, NULL, NULL, NULL);
+      total += height;
+      n++;
+    }
+
+  return n > 0 ? MAX (1, total / n) : 0;
+}
+
+/* Makes the rows match the items in view, plus half a page of
+ * overscan in each direction, recycling the rows that went out
+ * of view for the items that came into view.
+ */
+static void
+gtk_list_box_update_virtual_rows (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  guint n_items, n_rows, first, last;
+
+  n_items = g_list_model_get_n_items (priv->bound_model);
+  n_rows = g_sequence_get_length (priv->children);
+
+  if (n_items == 0)
+    {
+      first = last = 0;
+    }
+  else if (priv->adjustment == NULL)
+    {
+      /* Not scrolled, so everything is in view */
+      first = 0;
+      last = n_items;
+    }
+  else
+    {
+      gdouble top, bottom, overscan;
+
+      if (priv->virtual_row_height <= 0)
+        {
+          if (n_rows == 0)
+            {
+              priv->virtual_first = 0;
+              gtk_list_box_add_virtual_row (box, 0, FALSE);
+              n_rows = 1;
+            }
+
+          priv->virtual_row_height = gtk_list_box_estimate_row_height (box);
+          gtk_widget_queue_resize (GTK_WIDGET (box));
+        }
+
+      overscan = gtk_adjustment_get_page_size (priv->adjustment) / 2;
+      top = gtk_adjustment_get_value (priv->adjustment) - overscan;
+      bottom = gtk_adjustment_get_value (priv->adjustment)
+               + gtk_adjustment_get_page_size (priv->adjustment) + overscan;
+
+      first = CLAMP (top / priv->virtual_row_height, 0, n_items - 1);
+      last = CLAMP (ceil (bottom / priv->virtual_row_height), first + 1, n_items);
+    }
+
+  if (first >= priv->virtual_first + n_rows || last <= priv->virtual_first)
+    {
+      gtk_list_box_recycle_all_rows (box);
+      n_rows = 0;
+    }
+  else
+    {
+      while (priv->virtual_first < first)
+        {
+          gtk_list_box_recycle_row (box, g_sequence_get (g_sequence_get_begin_iter (priv->children)));
+          priv->virtual_first++;
+          n_rows--;
+        }
+
+      while (priv->virtual_first + n_rows > last)
+        {
+          gtk_list_box_recycle_row (box, g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter (priv->children))));
+          n_rows--;
+        }
+    }
+
+  if (n_rows == 0)
+    priv->virtual_first = first;
+
+  while (priv->virtual_first > first)
+    {
+      priv->virtual_first--;
+      gtk_list_box_add_virtual_row (box, priv->virtual_first, TRUE);
+      n_rows++;
+    }
+
+  while (priv->virtual_first + n_rows < last)
+    {
+      gtk_list_box_add_virtual_row (box, priv->virtual_first + n_rows, FALSE);
+      n_rows++;
+    }
+}
+
+static gboolean
+gtk_list_box_virtual_tick (GtkWidget     *widget,
+                           GdkFrameClock *frame_clock,
+                           gpointer       user_data)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (widget);
+
+  priv->virtual_tick_id = 0;
+
+  if (priv->virtual_model)
+    gtk_list_box_update_virtual_rows (GTK_LIST_BOX (widget));
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Rows are only added and removed from a tick callback, so that
+ * scrolling or resizing never changes the children in the middle
+ * of a size allocation.
+ */
+static void
+gtk_list_box_queue_virtual_update (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  if (!priv->virtual_model || priv->virtual_tick_id != 0)
+    return;
+
+  priv->virtual_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (box),
+                                                        gtk_list_box_virtual_tick,
+                                                        NULL, NULL);
+}
+
+static void
+gtk_list_box_virtual_model_changed (GtkListBox *box,
+                                    guint       position,
+                                    guint       removed,
+                                    guint       added)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  guint n_rows;
+
+  n_rows = g_sequence_get_length (priv->children);
+
+  if (position + removed <= priv->virtual_first)
+    {
+      /* The rows we have still show the same items */
+      priv->virtual_first = priv->virtual_first + added - removed;
+    }
+  else if (position < priv->virtual_first + n_rows)
+    {
+      gtk_list_box_recycle_all_rows (box);
+    }
+
+  gtk_widget_queue_resize (GTK_WIDGET (box));
+  gtk_list_box_queue_virtual_update (box);
+}
+
 static void
 gtk_list_box_bound_model_changed (GListModel *list,
                                   guint       position,
@@ -3579,6 +3902,12 @@ gtk_list_box_bound_model_changed (GListModel *list,
   GtkListBoxPrivate *priv = BOX_PRIV (user_data);
   guint i;
 
+  if (priv->virtual_model)
+    {
+      gtk_list_box_virtual_model_changed (box, position, removed, added);
+      return;
+    }
+
   while (removed--)
     {
       GtkListBoxRow *row;
@@ -3623,6 +3952,49 @@ gtk_list_box_check_model_compat (GtkListBox *box)
     g_warning ("GtkListBox with a model will ignore sort and filter functions");
 }
 
+static void
+gtk_list_box_unbind_model (GtkListBox *box)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+  GSequenceIter *iter;
+
+  if (priv->virtual_model)
+    {
+      gtk_list_box_recycle_all_rows (box);
+
+      g_ptr_array_foreach (priv->recycled_rows, (GFunc) g_object_unref, NULL);
+      g_ptr_array_set_size (priv->recycled_rows, 0);
+
+      if (priv->virtual_tick_id != 0)
+        {
+          gtk_widget_remove_tick_callback (GTK_WIDGET (box), priv->virtual_tick_id);
+          priv->virtual_tick_id = 0;
+        }
+
+      priv->virtual_model = FALSE;
+      priv->bind_widget_func = NULL;
+      priv->unbind_widget_func = NULL;
+      priv->virtual_row_height = 0;
+    }
+
+  if (priv->bound_model)
+    {
+      if (priv->create_widget_func_data_destroy)
+        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+
+      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_list_box_bound_model_changed, box);
+      g_clear_object (&priv->bound_model);
+    }
+
+  iter = g_sequence_get_begin_iter (priv->children);
+  while (!g_sequence_iter_is_end (iter))
+    {
+      GtkWidget *row = g_sequence_get (iter);
+      iter = g_sequence_iter_next (iter);
+      gtk_list_box_remove (GTK_CONTAINER (box), row);
+    }
+}
+
 /**
  * gtk_list_box_bind_model:
  * @box: a #GtkListBox
@@ -3659,29 +4031,77 @@ gtk_list_box_bind_model (GtkListBox                 *box,
                          GDestroyNotify              user_data_free_func)
 {
   GtkListBoxPrivate *priv = BOX_PRIV (box);
-  GSequenceIter *iter;
 
   g_return_if_fail (GTK_IS_LIST_BOX (box));
   g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
   g_return_if_fail (model == NULL || create_widget_func != NULL);
 
-  if (priv->bound_model)
-    {
-      if (priv->create_widget_func_data_destroy)
-        priv->create_widget_func_data_destroy (priv->create_widget_func_data);
+  gtk_list_box_unbind_model (box);
 
-      g_signal_handlers_disconnect_by_func (priv->bound_model, gtk_list_box_bound_model_changed, box);
-      g_clear_object (&priv->bound_model);
-    }
+  if (model == NULL)
+    return;
 
-  iter = g_sequence_get_begin_iter (priv->children);
-  while (!g_sequence_iter_is_end (iter))
-    {
-      GtkWidget *row = g_sequence_get (iter);
-      iter = g_sequence_iter_next (iter);
-      gtk_list_box_remove (GTK_CONTAINER (box), row);
-    }
+  priv->bound_model = g_object_ref (model);
+  priv->create_widget_func = create_widget_func;
+  priv->create_widget_func_data = user_data;
+  priv->create_widget_func_data_destroy = user_data_free_func;
+
+  gtk_list_box_check_model_compat (box);
 
+  g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_list_box_bound_model_changed), box);
+  gtk_list_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+}
+
+/**
+ * gtk_list_box_bind_model_virtual:
+ * @box: a #GtkListBox
+ * @model: (nullable): the #GListModel to be bound to @box
+ * @create_widget_func: (nullable): a function that creates widgets for items
+ *   or %NULL in case you also passed %NULL as @model
+ * @bind_widget_func: (nullable): a function that makes a widget represent
+ *   another item, or %NULL in case you also passed %NULL as @model
+ * @unbind_widget_func: (nullable): a function that is called when a widget
+ *   stops representing an item, or %NULL
+ * @user_data: user data passed to the functions
+ * @user_data_free_func: function for freeing @user_data
+ *
+ * Binds @model to @box like gtk_list_box_bind_model(), but only creates
+ * rows for the items that are in view, plus some margin. When @box is
+ * scrolled, the rows of the items that go out of view are reused for the
+ * ones that come into view by calling @unbind_widget_func and
+ * @bind_widget_func on the widgets that @create_widget_func returned.
+ * This keeps the number of widgets constant no matter how many items
+ * @model contains.
+ *
+ * The total height of the list is estimated from the height of the rows
+ * that exist, so all rows should have about the same height. For the
+ * visible part of the list to be known, @box needs to be the child of a
+ * #GtkScrollable such as a #GtkViewport.
+ *
+ * Since rows only exist for the items in view, gtk_list_box_get_row_at_index()
+ * returns %NULL for other items, and selection and keyboard focus are lost
+ * when their row is scrolled out of view. Headers and the filtering and
+ * sorting functionality of GtkListBox are not supported in this mode.
+ *
+ * Since: 3.94
+ */
+void
+gtk_list_box_bind_model_virtual (GtkListBox                 *box,
+                                 GListModel                 *model,
+                                 GtkListBoxCreateWidgetFunc  create_widget_func,
+                                 GtkListBoxBindWidgetFunc    bind_widget_func,
+                                 GtkListBoxBindWidgetFunc    unbind_widget_func,
+                                 gpointer                    user_data,
+                                 GDestroyNotify              user_data_free_func)
+{
+  GtkListBoxPrivate *priv = BOX_PRIV (box);
+
+  g_return_if_fail (GTK_IS_LIST_BOX (box));
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+  g_return_if_fail (model == NULL || create_widget_func != NULL);
+  g_return_if_fail (model == NULL || bind_widget_func != NULL);
+
+  gtk_list_box_unbind_model (box);
 
   if (model == NULL)
     return;
@@ -3690,9 +4110,12 @@ gtk_list_box_bind_model (GtkListBox                 *box,
   priv->create_widget_func = create_widget_func;
   priv->create_widget_func_data = user_data;
   priv->create_widget_func_data_destroy = user_data_free_func;
+  priv->virtual_model = TRUE;
+  priv->bind_widget_func = bind_widget_func;
+  priv->unbind_widget_func = unbind_widget_func;
 
   gtk_list_box_check_model_compat (box);
 
   g_signal_connect (priv->bound_model, "items-changed", G_CALLBACK (gtk_list_box_bound_model_changed), box);
-  gtk_list_box_bound_model_changed (model, 0, 0, g_list_model_get_n_items (model), box);
+  gtk_list_box_queue_virtual_update (box);
 }
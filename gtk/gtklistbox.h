@@ -184,6 +184,22 @@ typedef void (*GtkListBoxUpdateHeaderFunc) (GtkListBoxRow *row,
 typedef GtkWidget * (*GtkListBoxCreateWidgetFunc) (gpointer item,
                                                    gpointer user_data);
 
+/**
+ * GtkListBoxBindWidgetFunc:
+ * @widget: a widget that was created by the #GtkListBoxCreateWidgetFunc
+ * @item: (type GObject): the item from the model
+ * @user_data: (closure): user data
+ *
+ * Called for list boxes that are bound to a #GListModel with
+ * gtk_list_box_bind_model_virtual() when @widget is reused to
+ * represent @item, or when it stops representing @item.
+ *
+ * Since: 3.94
+ */
+typedef void (*GtkListBoxBindWidgetFunc) (GtkWidget *widget,
+                                          gpointer   item,
+                                          gpointer   user_data);
+
 GDK_AVAILABLE_IN_3_10
 GType      gtk_list_box_row_get_type      (void) G_GNUC_CONST;
 GDK_AVAILABLE_IN_3_10
@@ -307,6 +323,14 @@ void           gtk_list_box_bind_model                   (GtkListBox
                                                           GtkListBoxCreateWidgetFunc    create_widget_func,
                                                           gpointer                      user_data,
                                                           GDestroyNotify                user_data_free_func);
+GDK_AVAILABLE_IN_3_94
+void           gtk_list_box_bind_model_virtual           (GtkListBox                   *box,
+                                                          GListModel                   *model,
+                                                          GtkListBoxCreateWidgetFunc    create_widget_func,
+                                                          GtkListBoxBindWidgetFunc      bind_widget_func,
+                                                          GtkListBoxBindWidgetFunc      unbind_widget_func,
+                                                          gpointer                      user_data,
+                                                          GDestroyNotify                user_data_free_func);
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBox, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GtkListBoxRow, g_object_unref)
@@ -1954,6 +1954,65 @@ gtk_list_store_compare_func (GSequenceIter *a,
   return retval;
 }
 
+/* When sorting by a column with the default sort function, the values
+ * are fetched once per row and sorted as keys, which avoids fetching
+ * and collating two values for each comparison.
+ */
+static gint *
+gtk_list_store_sort_by_key (GtkListStore *list_store)
+{
+  GtkListStorePrivate *priv = list_store->priv;
+  GtkTreeDataSortHeader *header;
+  GtkTreeDataSortKey *keys;
+  GSequenceIter *ptr, *end;
+  GtkTreeIter iter;
+  gint *new_order;
+  gint column, n_rows, i;
+  GType type;
+
+  if (priv->sort_column_id < 0)
+    return NULL;
+
+  header = _gtk_tree_data_list_get_header (priv->sort_list,
+                                           priv->sort_column_id);
+  if (header == NULL || header->func != _gtk_tree_data_list_compare_func)
+    return NULL;
+
+  column = GPOINTER_TO_INT (header->data);
+  type = priv->column_headers[column];
+  if (!_gtk_tree_data_list_has_sort_key (type))
+    return NULL;
+
+  n_rows = g_sequence_get_length (priv->seq);
+  keys = g_new (GtkTreeDataSortKey, n_rows);
+
+  iter.stamp = priv->stamp;
+  for (i = 0, ptr = g_sequence_get_begin_iter (priv->seq);
+       !g_sequence_iter_is_end (ptr);
+       i++, ptr = g_sequence_iter_next (ptr))
+    {
+      iter.user_data = ptr;
+      keys[i].row = ptr;
+      keys[i].index = i;
+      _gtk_tree_data_list_set_sort_key (&keys[i], GTK_TREE_MODEL (list_store),
+                                        &iter, column, type);
+    }
+
+  _gtk_tree_data_list_sort_keys (keys, n_rows, type, priv->order);
+
+  new_order = g_new (gint, n_rows);
+  end = g_sequence_get_end_iter (priv->seq);
+  for (i = 0; i < n_rows; i++)
+    {
+      new_order[i] = keys[i].index;
+      g_sequence_move (keys[i].row, end);
+    }
+
+  _gtk_tree_data_list_free_sort_keys (keys, n_rows, type);
+
+  return new_order;
+}
+
 static void
 gtk_list_store_sort (GtkListStore *list_store)
 {
@@ -1966,12 +2025,17 @@ gtk_list_store_sort (GtkListStore *list_store)
       g_sequence_get_length (priv->seq) <= 1)
     return;
 
-  old_positions = save_positions (priv->seq);
+  new_order = gtk_list_store_sort_by_key (list_store);
+  if (new_order == NULL)
+    {
+      old_positions = save_positions (priv->seq);
+
+      g_sequence_sort_iter (priv->seq, gtk_list_store_compare_func, list_store);
 
-  g_sequence_sort_iter (priv->seq, gtk_list_store_compare_func, list_store);
+      new_order = generate_order (priv->seq, old_positions);
+    }
 
   /* Let the world know about our new order */
-  new_order = generate_order (priv->seq, old_positions);
 
   path = gtk_tree_path_new ();
   gtk_tree_model_rows_reordered (GTK_TREE_MODEL (list_store),
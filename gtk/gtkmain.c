@@ -133,6 +133,11 @@
 
 #include "a11y/gtkaccessibility.h"
 
+#if defined(GDK_WINDOWING_X11) || defined(GDK_WINDOWING_WAYLAND)
+#include <fontconfig/fontconfig.h>
+#define LOAD_FONTCONFIG_IN_THREAD 1
+#endif
+
 static GtkWindowGroup *gtk_main_get_window_group (GtkWidget   *widget);
 
 static guint gtk_main_loop_level = 0;
@@ -170,7 +175,9 @@ static const GDebugKey gtk_debug_keys[] = {
   { "actions", GTK_DEBUG_ACTIONS },
   { "resize", GTK_DEBUG_RESIZE },
   { "layout", GTK_DEBUG_LAYOUT },
-  { "snapshot", GTK_DEBUG_SNAPSHOT }
+  { "snapshot", GTK_DEBUG_SNAPSHOT },
+  { "allocate", GTK_DEBUG_ALLOCATE },
+  { "widget-times", GTK_DEBUG_WIDGET_TIMES }
 };
 #endif /* G_ENABLE_DEBUG */
 
@@ -631,6 +638,24 @@ default_display_notify_cb (GdkDisplayManager *dm)
   debug_flags[0].display = gdk_display_get_default ();
 }
 
+#ifdef LOAD_FONTCONFIG_IN_THREAD
+/* Loading the fontconfig configuration and font cache doesn't depend
+ * on anything else GTK+ does during startup, so it runs while the
+ * display connection is being set up.
+ */
+static gpointer
+load_fontconfig (gpointer data)
+{
+  gint64 before = g_get_monotonic_time ();
+
+  FcInit ();
+
+  gdk_profiler_add_mark (before, g_get_monotonic_time () - before, "gtk init", "load fontconfig");
+
+  return NULL;
+}
+#endif
+
 static void
 do_post_parse_initialization (void)
 {
@@ -769,6 +794,10 @@ gboolean
 gtk_init_check (void)
 {
   gboolean ret;
+  gint64 before, after;
+#ifdef LOAD_FONTCONFIG_IN_THREAD
+  GThread *fontconfig_thread;
+#endif
 
   if (gtk_initialized)
     return TRUE;
@@ -778,10 +807,29 @@ gtk_init_check (void)
   if (!check_setugid ())
     return FALSE;
 
+  before = g_get_monotonic_time ();
   do_pre_parse_initialization ();
+  after = g_get_monotonic_time ();
+  gdk_profiler_add_mark (before, after - before, "gtk init", "pre-parse initialization");
+
+  before = after;
   do_post_parse_initialization ();
+  after = g_get_monotonic_time ();
+  gdk_profiler_add_mark (before, after - before, "gtk init", "post-parse initialization");
+
+#ifdef LOAD_FONTCONFIG_IN_THREAD
+  fontconfig_thread = g_thread_new ("gtk-fontconfig", load_fontconfig, NULL);
+#endif
 
+  before = after;
   ret = gdk_display_open_default () != NULL;
+  after = g_get_monotonic_time ();
+  gdk_profiler_add_mark (before, after - before, "gtk init", "open display");
+
+#ifdef LOAD_FONTCONFIG_IN_THREAD
+  /* Fonts are needed as soon as the first widget is created */
+  g_thread_join (fontconfig_thread);
+#endif
 
   if (gtk_get_debug_flags () & GTK_DEBUG_INTERACTIVE)
     gtk_window_set_interactive_debugging (TRUE);
@@ -1402,10 +1450,14 @@ synth_crossing (GtkWidget       *widget,
   if (other_widget)
     event->crossing.subwindow = g_object_ref (gtk_widget_get_window (other_widget));
 
-  if (enter)
-    gtk_widget_set_state_flags (widget, GTK_STATE_FLAG_PRELIGHT, FALSE);
-  else
-    gtk_widget_unset_state_flags (widget, GTK_STATE_FLAG_PRELIGHT);
+  /* Plain pointer motion can cross many widgets per frame, only
+   * the hover state at the next frame matters for the prelight flag.
+   * Grab crossings change it right away, as code reacting to grabs
+   * expects the state to be up to date.
+   */
+  gtk_window_queue_prelight (GTK_WINDOW (toplevel), widget, enter);
+  if (crossing_mode != GDK_CROSSING_NORMAL)
+    gtk_window_flush_prelight (GTK_WINDOW (toplevel));
 
   gdk_event_get_coords (source, &x, &y);
   event->crossing.x = x;
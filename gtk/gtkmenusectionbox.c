@@ -46,8 +46,15 @@ struct _GtkMenuSectionBox
   guint              separator_sync_idle;
   gboolean           iconic;
   gint               depth;
+  GSList            *recycled_buttons;
+  guint              n_recycled_buttons;
 };
 
+/* Plain menu items are kept around when they are removed, as models that
+ * change often would otherwise keep building and styling new buttons.
+ */
+#define MAX_RECYCLED_BUTTONS 16
+
 typedef struct
 {
   gint     n_items;
@@ -190,6 +197,86 @@ gtk_popover_item_activate (GtkWidget *button,
     }
 }
 
+static void
+gtk_menu_section_box_bind (GtkMenuTrackerItem *item,
+                           const gchar        *source_property,
+                           GtkWidget          *widget,
+                           const gchar        *target_property)
+{
+  GBinding *binding;
+  GSList *bindings;
+
+  binding = g_object_bind_property (item, source_property,
+                                    widget, target_property,
+                                    G_BINDING_SYNC_CREATE);
+
+  bindings = g_object_steal_data (G_OBJECT (widget), "gtk-menu-section-box-bindings");
+  bindings = g_slist_prepend (bindings, binding);
+  g_object_set_data_full (G_OBJECT (widget), "gtk-menu-section-box-bindings",
+                          bindings, (GDestroyNotify) g_slist_free);
+}
+
+static gboolean
+gtk_menu_section_box_recycle_button (GtkMenuSectionBox *box,
+                                     GtkWidget         *widget)
+{
+  GtkMenuSectionBox *toplevel = box->toplevel;
+  GtkMenuTrackerItem *item;
+  GSList *bindings, *l;
+
+  if (!g_object_get_data (G_OBJECT (widget), "gtk-menu-section-box-recyclable"))
+    return FALSE;
+
+  if (toplevel->n_recycled_buttons >= MAX_RECYCLED_BUTTONS ||
+      gtk_widget_in_destruction (GTK_WIDGET (toplevel)))
+    return FALSE;
+
+  item = g_object_get_data (G_OBJECT (widget), "GtkMenuTrackerItem");
+
+  bindings = g_object_steal_data (G_OBJECT (widget), "gtk-menu-section-box-bindings");
+  for (l = bindings; l; l = l->next)
+    g_binding_unbind (l->data);
+  g_slist_free (bindings);
+
+  g_signal_handlers_disconnect_by_func (widget, gtk_popover_item_activate, item);
+  g_object_set_data (G_OBJECT (widget), "GtkMenuTrackerItem", NULL);
+
+  g_object_set (widget,
+                "text", "",
+                "icon", NULL,
+                "role", GTK_BUTTON_ROLE_NORMAL,
+                "active", FALSE,
+                "iconic", FALSE,
+                "centered", FALSE,
+                NULL);
+  gtk_widget_set_sensitive (widget, TRUE);
+
+  g_object_ref (widget);
+  gtk_container_remove (GTK_CONTAINER (box->item_box), widget);
+
+  toplevel->recycled_buttons = g_slist_prepend (toplevel->recycled_buttons, widget);
+  toplevel->n_recycled_buttons++;
+
+  return TRUE;
+}
+
+static GtkWidget *
+gtk_menu_section_box_get_recycled_button (GtkMenuSectionBox *box)
+{
+  GtkMenuSectionBox *toplevel = box->toplevel;
+  GtkWidget *widget;
+
+  if (toplevel->recycled_buttons == NULL)
+    return NULL;
+
+  widget = toplevel->recycled_buttons->data;
+  toplevel->recycled_buttons = g_slist_delete_link (toplevel->recycled_buttons,
+                                                    toplevel->recycled_buttons);
+  toplevel->n_recycled_buttons--;
+
+  return widget;
+}
+
 static void
 gtk_menu_section_box_remove_func (gint     position,
                                   gpointer user_data)
@@ -214,7 +301,8 @@ gtk_menu_section_box_remove_func (gint     position,
         gtk_container_remove (GTK_CONTAINER (stack), subbox);
     }
 
-  gtk_widget_destroy (g_list_nth_data (children, position));
+  if (!gtk_menu_section_box_recycle_button (box, widget))
+    gtk_widget_destroy (widget);
   g_list_free (children);
 
   gtk_menu_section_box_schedule_separator_sync (box);
@@ -306,20 +394,27 @@ gtk_menu_section_box_insert_func (GtkMenuTrackerItem *item,
     }
   else
     {
-      widget = gtk_model_button_new ();
-      g_object_bind_property (item, "label", widget, "text", G_BINDING_SYNC_CREATE);
+      widget = gtk_menu_section_box_get_recycled_button (box);
+      if (widget == NULL)
+        {
+          widget = gtk_model_button_new ();
+          g_object_ref_sink (widget);
+          g_object_set_data (G_OBJECT (widget), "gtk-menu-section-box-recyclable", GINT_TO_POINTER (TRUE));
+        }
+
+      gtk_menu_section_box_bind (item, "label", widget, "text");
 
       if (box->iconic)
         {
-          g_object_bind_property (item, "verb-icon", widget, "icon", G_BINDING_SYNC_CREATE);
+          gtk_menu_section_box_bind (item, "verb-icon", widget, "icon");
           g_object_set (widget, "iconic", TRUE, "centered", TRUE, NULL);
         }
       else
-        g_object_bind_property (item, "icon", widget, "icon", G_BINDING_SYNC_CREATE);
+        gtk_menu_section_box_bind (item, "icon", widget, "icon");
 
-      g_object_bind_property (item, "sensitive", widget, "sensitive", G_BINDING_SYNC_CREATE);
-      g_object_bind_property (item, "role", widget, "role", G_BINDING_SYNC_CREATE);
-      g_object_bind_property (item, "toggled", widget, "active", G_BINDING_SYNC_CREATE);
+      gtk_menu_section_box_bind (item, "sensitive", widget, "sensitive");
+      gtk_menu_section_box_bind (item, "role", widget, "role");
+      gtk_menu_section_box_bind (item, "toggled", widget, "active");
       g_signal_connect (widget, "clicked", G_CALLBACK (gtk_popover_item_activate), item);
     }
 
@@ -329,6 +424,10 @@ gtk_menu_section_box_insert_func (GtkMenuTrackerItem *item,
   gtk_container_add (GTK_CONTAINER (box->item_box), widget);
   gtk_box_reorder_child (GTK_BOX (box->item_box), widget, position);
 
+  /* Recycled and new plain items come with a reference of our own */
+  if (g_object_get_data (G_OBJECT (widget), "gtk-menu-section-box-recyclable"))
+    g_object_unref (widget);
+
   gtk_menu_section_box_schedule_separator_sync (box);
 }
 
@@ -370,6 +469,10 @@ gtk_menu_section_box_dispose (GObject *object)
       box->tracker = NULL;
     }
 
+  g_slist_free_full (box->recycled_buttons, g_object_unref);
+  box->recycled_buttons = NULL;
+  box->n_recycled_buttons = 0;
+
   G_OBJECT_CLASS (gtk_menu_section_box_parent_class)->dispose (object);
 }
 
@@ -73,6 +73,7 @@ struct _GtkMenuTrackerSection
 {
   gpointer    model;   /* may be a GtkMenuTrackerItem or a GMenuModel */
   GSList     *items;
+  GPtrArray  *attributes; /* the attributes of each item, see describe_item() */
   gchar      *action_namespace;
 
   guint       separator_label : 1;
@@ -274,14 +275,85 @@ gtk_menu_tracker_section_measure (GtkMenuTrackerSection *section)
   return n_items;
 }
 
+/* Returns the attributes of an item as an a{sv} dictionary, or %NULL
+ * if the item has links. Items with the same attributes and without
+ * links turn into the same menu items, so this is used to find the
+ * items that didn't change when a model reports a change.
+ */
+static GVariant *
+describe_item (GMenuModel *model,
+               gint        position)
+{
+  GMenuAttributeIter *attr_iter;
+  GMenuLinkIter *link_iter;
+  GVariantBuilder builder;
+  gboolean has_links;
+  const gchar *name;
+  GVariant *value;
+
+  link_iter = g_menu_model_iterate_item_links (model, position);
+  has_links = g_menu_link_iter_next (link_iter);
+  g_object_unref (link_iter);
+
+  if (has_links)
+    return NULL;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+  attr_iter = g_menu_model_iterate_item_attributes (model, position);
+  while (g_menu_attribute_iter_get_next (attr_iter, &name, &value))
+    {
+      g_variant_builder_add (&builder, "{sv}", name, value);
+      g_variant_unref (value);
+    }
+  g_object_unref (attr_iter);
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static gboolean
+item_is_unchanged (GtkMenuTrackerSection *section,
+                   gint                   old_position,
+                   GMenuModel            *model,
+                   gint                   new_position)
+{
+  GVariant *old_attributes;
+  GVariant *new_attributes;
+  gboolean unchanged;
+
+  old_attributes = g_ptr_array_index (section->attributes, old_position);
+  if (old_attributes == NULL)
+    return FALSE;
+
+  new_attributes = describe_item (model, new_position);
+  if (new_attributes == NULL)
+    return FALSE;
+
+  unchanged = g_variant_equal (old_attributes, new_attributes);
+  g_variant_unref (new_attributes);
+
+  return unchanged;
+}
+
+static void
+free_attributes (gpointer data)
+{
+  if (data)
+    g_variant_unref (data);
+}
+
 static void
-gtk_menu_tracker_remove_items (GtkMenuTracker  *tracker,
-                               GSList         **change_point,
-                               gint             offset,
-                               gint             n_items)
+gtk_menu_tracker_remove_items (GtkMenuTracker         *tracker,
+                               GtkMenuTrackerSection  *section,
+                               GSList                **change_point,
+                               gint                    offset,
+                               gint                    position,
+                               gint                    n_items)
 {
   gint i;
 
+  g_ptr_array_remove_range (section->attributes, position, n_items);
+
   for (i = 0; i < n_items; i++)
     {
       GtkMenuTrackerSection *subsection;
@@ -311,6 +383,8 @@ gtk_menu_tracker_add_items (GtkMenuTracker         *tracker,
     {
       GMenuModel *submenu;
 
+      g_ptr_array_insert (section->attributes, position, describe_item (model, position + n_items));
+
       submenu = g_menu_model_get_item_link (model, position + n_items, G_MENU_LINK_SECTION);
       g_assert (submenu != model);
 
@@ -425,6 +499,30 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
    */
   section = gtk_menu_tracker_section_find_model (tracker->toplevel, model, &offset);
 
+  /* Models often report a change of all of their items when only a
+   * few of them changed, for instance when they are rebuilt from
+   * scratch. Leave the items at the start and end of the change alone
+   * if they are the same as before, so that their menu items don't
+   * have to be destroyed and created again.
+   */
+  while (removed > 0 && added > 0 &&
+         item_is_unchanged (section, position, model, position))
+    {
+      position++;
+      removed--;
+      added--;
+    }
+
+  while (removed > 0 && added > 0 &&
+         item_is_unchanged (section, position + removed - 1, model, position + added - 1))
+    {
+      removed--;
+      added--;
+    }
+
+  if (removed == 0 && added == 0)
+    return;
+
   /* Next, seek through that section to the change point.  This gives us
    * the correct GSList** to make the change to and also finds the final
    * offset at which we will make the changes (by measuring the number
@@ -448,7 +546,7 @@ gtk_menu_tracker_model_changed (GMenuModel *model,
    * means that we can populate in O(n) time instead of O(n^2) that we
    * would do by appending.
    */
-  gtk_menu_tracker_remove_items (tracker, change_point, offset, removed);
+  gtk_menu_tracker_remove_items (tracker, section, change_point, offset, position, removed);
   gtk_menu_tracker_add_items (tracker, section, change_point, offset, model, position, added);
 
   /* The offsets for insertion/removal of separators will be all over
@@ -465,6 +563,8 @@ gtk_menu_tracker_section_free (GtkMenuTrackerSection *section)
 
   g_signal_handler_disconnect (section->model, section->handler);
   g_slist_free_full (section->items, (GDestroyNotify) gtk_menu_tracker_section_free);
+  if (section->attributes)
+    g_ptr_array_unref (section->attributes);
   g_free (section->action_namespace);
   g_object_unref (section->model);
   g_slice_free (GtkMenuTrackerSection, section);
@@ -485,6 +585,7 @@ gtk_menu_tracker_section_new (GtkMenuTracker *tracker,
   section->with_separators = with_separators;
   section->action_namespace = g_strdup (action_namespace);
   section->separator_label = separator_label;
+  section->attributes = g_ptr_array_new_with_free_func (free_attributes);
 
   gtk_menu_tracker_add_items (tracker, section, &section->items, offset, model, 0, g_menu_model_get_n_items (model));
   section->handler = g_signal_connect (model, "items-changed", G_CALLBACK (gtk_menu_tracker_model_changed), tracker);
@@ -25,6 +25,7 @@
 #include "config.h"
 #include "gtkpango.h"
 #include <pango/pangocairo.h>
+#include <string.h>
 #include "gtkintl.h"
 
 #define GTK_TYPE_FILL_LAYOUT_RENDERER            (_gtk_fill_layout_renderer_get_type())
@@ -1281,3 +1282,315 @@ _gtk_pango_attr_list_merge (PangoAttrList *into,
 
   return into;
 }
+
+/* Shared layouts
+ *
+ * Lots of widgets show the same text in the same font, think of row
+ * labels in lists. Shaping that text again for every one of them when
+ * measuring is wasteful, so we keep a cache of layouts that can be
+ * shared. The layouts in the cache are never modified, they are only
+ * used to take measurements.
+ *
+ * Layouts for widgets use the widget's context, which can change at
+ * any time. The shared layouts use contexts of their own that copy the
+ * state of the widget contexts.
+ */
+
+#define MAX_SHARED_LAYOUTS 1000
+
+typedef struct {
+  PangoFontMap *font_map;
+  guint font_map_serial;
+  PangoFontDescription *font_desc;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  PangoGravity base_gravity;
+  PangoGravityHint gravity_hint;
+  cairo_font_options_t *font_options;
+  double resolution;
+
+  PangoContext *context;
+  guint n_layouts;
+} SharedContext;
+
+typedef struct {
+  SharedContext *context;
+  char *text;
+  int width;
+  int height;
+  int indent;
+  int spacing;
+  PangoWrapMode wrap;
+  PangoEllipsizeMode ellipsize;
+  PangoAlignment alignment;
+  guint justify          : 1;
+  guint auto_dir         : 1;
+  guint single_paragraph : 1;
+
+  PangoLayout *layout;
+  GList lru_link;
+} SharedLayout;
+
+static GHashTable *shared_contexts;
+static GHashTable *shared_layouts;
+static GQueue shared_layouts_lru = G_QUEUE_INIT;
+static GQuark quark_shared_layout;
+
+static guint
+shared_context_hash (gconstpointer data)
+{
+  const SharedContext *sc = data;
+  guint hash;
+
+  hash = g_direct_hash (sc->font_map) ^ sc->font_map_serial;
+  hash = hash * 31 + pango_font_description_hash (sc->font_desc);
+  hash = hash * 31 + g_direct_hash (sc->language);
+  hash = hash * 31 + (sc->base_dir << 8 | sc->base_gravity << 4 | sc->gravity_hint);
+  if (sc->font_options)
+    hash = hash * 31 + cairo_font_options_hash (sc->font_options);
+  hash = hash * 31 + (guint) sc->resolution;
+
+  return hash;
+}
+
+static gboolean
+shared_context_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  const SharedContext *sca = a;
+  const SharedContext *scb = b;
+
+  if (sca->font_options == NULL || scb->font_options == NULL)
+    {
+      if (sca->font_options != scb->font_options)
+        return FALSE;
+    }
+  else if (!cairo_font_options_equal (sca->font_options, scb->font_options))
+    return FALSE;
+
+  return sca->font_map == scb->font_map &&
+         sca->font_map_serial == scb->font_map_serial &&
+         sca->language == scb->language &&
+         sca->base_dir == scb->base_dir &&
+         sca->base_gravity == scb->base_gravity &&
+         sca->gravity_hint == scb->gravity_hint &&
+         sca->resolution == scb->resolution &&
+         pango_font_description_equal (sca->font_desc, scb->font_desc);
+}
+
+static void
+shared_context_free (gpointer data)
+{
+  SharedContext *sc = data;
+
+  g_clear_object (&sc->context);
+  g_object_unref (sc->font_map);
+  pango_font_description_free (sc->font_desc);
+  if (sc->font_options)
+    cairo_font_options_destroy (sc->font_options);
+  g_slice_free (SharedContext, sc);
+}
+
+static guint
+shared_layout_hash (gconstpointer data)
+{
+  const SharedLayout *sl = data;
+  guint hash;
+
+  hash = g_direct_hash (sl->context) ^ g_str_hash (sl->text);
+  hash = hash * 31 + sl->width;
+  hash = hash * 31 + sl->height;
+  hash = hash * 31 + (sl->wrap << 8 | sl->ellipsize << 4 | sl->alignment);
+
+  return hash;
+}
+
+static gboolean
+shared_layout_equal (gconstpointer a,
+                     gconstpointer b)
+{
+  const SharedLayout *sla = a;
+  const SharedLayout *slb = b;
+
+  return sla->context == slb->context &&
+         sla->width == slb->width &&
+         sla->height == slb->height &&
+         sla->indent == slb->indent &&
+         sla->spacing == slb->spacing &&
+         sla->wrap == slb->wrap &&
+         sla->ellipsize == slb->ellipsize &&
+         sla->alignment == slb->alignment &&
+         sla->justify == slb->justify &&
+         sla->auto_dir == slb->auto_dir &&
+         sla->single_paragraph == slb->single_paragraph &&
+         strcmp (sla->text, slb->text) == 0;
+}
+
+static void
+shared_layout_free (gpointer data)
+{
+  SharedLayout *sl = data;
+
+  g_queue_unlink (&shared_layouts_lru, &sl->lru_link);
+  g_clear_object (&sl->layout);
+  g_free (sl->text);
+
+  sl->context->n_layouts--;
+  if (sl->context->n_layouts == 0)
+    g_hash_table_remove (shared_contexts, sl->context);
+
+  g_slice_free (SharedLayout, sl);
+}
+
+static SharedContext *
+shared_context_lookup (PangoContext *context)
+{
+  SharedContext key, *sc;
+
+  if (pango_context_get_matrix (context) != NULL)
+    return NULL;
+
+  key.context = NULL;
+  key.n_layouts = 0;
+  key.font_map = pango_context_get_font_map (context);
+  key.font_map_serial = pango_font_map_get_serial (key.font_map);
+  key.font_desc = pango_context_get_font_description (context);
+  key.language = pango_context_get_language (context);
+  key.base_dir = pango_context_get_base_dir (context);
+  key.base_gravity = pango_context_get_base_gravity (context);
+  key.gravity_hint = pango_context_get_gravity_hint (context);
+  key.font_options = (cairo_font_options_t *) pango_cairo_context_get_font_options (context);
+  key.resolution = pango_cairo_context_get_resolution (context);
+
+  sc = g_hash_table_lookup (shared_contexts, &key);
+  if (sc)
+    return sc;
+
+  sc = g_slice_new (SharedContext);
+  *sc = key;
+  g_object_ref (sc->font_map);
+  sc->font_desc = pango_font_description_copy (key.font_desc);
+  if (key.font_options)
+    sc->font_options = cairo_font_options_copy (key.font_options);
+
+  sc->context = pango_font_map_create_context (sc->font_map);
+  pango_context_set_font_description (sc->context, sc->font_desc);
+  pango_context_set_language (sc->context, sc->language);
+  pango_context_set_base_dir (sc->context, sc->base_dir);
+  pango_context_set_base_gravity (sc->context, sc->base_gravity);
+  pango_context_set_gravity_hint (sc->context, sc->gravity_hint);
+  pango_cairo_context_set_font_options (sc->context, sc->font_options);
+  pango_cairo_context_set_resolution (sc->context, sc->resolution);
+
+  g_hash_table_add (shared_contexts, sc);
+
+  return sc;
+}
+
+/*
+ * _gtk_pango_layout_get_shared:
+ * @layout: a #PangoLayout
+ * @width: the width to use instead of the one of @layout
+ *
+ * Looks up a layout that measures the same as @layout would with
+ * the given width, from a cache that is shared by all widgets. The
+ * returned layout must not be modified.
+ *
+ * Only layouts without attributes, tabs or a font description of
+ * their own can be shared.
+ *
+ * Returns: (nullable): a new reference to a shared layout, or %NULL
+ *   if @layout can't be shared
+ */
+PangoLayout *
+_gtk_pango_layout_get_shared (PangoLayout *layout,
+                              int          width)
+{
+  SharedLayout key, *sl;
+  PangoLayout *shared;
+
+  if (pango_layout_get_attributes (layout) != NULL ||
+      pango_layout_get_tabs (layout) != NULL ||
+      pango_layout_get_font_description (layout) != NULL)
+    return NULL;
+
+  if (G_UNLIKELY (shared_contexts == NULL))
+    {
+      shared_contexts = g_hash_table_new_full (shared_context_hash, shared_context_equal,
+                                               shared_context_free, NULL);
+      shared_layouts = g_hash_table_new_full (shared_layout_hash, shared_layout_equal,
+                                              shared_layout_free, NULL);
+      quark_shared_layout = g_quark_from_static_string ("gtk-shared-layout");
+    }
+
+  key.context = shared_context_lookup (pango_layout_get_context (layout));
+  if (key.context == NULL)
+    return NULL;
+
+  key.text = (char *) pango_layout_get_text (layout);
+  key.width = width;
+  key.height = pango_layout_get_height (layout);
+  key.indent = pango_layout_get_indent (layout);
+  key.spacing = pango_layout_get_spacing (layout);
+  key.wrap = pango_layout_get_wrap (layout);
+  key.ellipsize = pango_layout_get_ellipsize (layout);
+  key.alignment = pango_layout_get_alignment (layout);
+  key.justify = pango_layout_get_justify (layout);
+  key.auto_dir = pango_layout_get_auto_dir (layout);
+  key.single_paragraph = pango_layout_get_single_paragraph_mode (layout);
+
+  sl = g_hash_table_lookup (shared_layouts, &key);
+  if (sl)
+    {
+      g_queue_unlink (&shared_layouts_lru, &sl->lru_link);
+      g_queue_push_head_link (&shared_layouts_lru, &sl->lru_link);
+
+      return g_object_ref (sl->layout);
+    }
+
+  shared = pango_layout_new (key.context->context);
+  pango_layout_set_text (shared, key.text, -1);
+  pango_layout_set_width (shared, key.width);
+  pango_layout_set_height (shared, key.height);
+  pango_layout_set_indent (shared, key.indent);
+  pango_layout_set_spacing (shared, key.spacing);
+  pango_layout_set_wrap (shared, key.wrap);
+  pango_layout_set_ellipsize (shared, key.ellipsize);
+  pango_layout_set_alignment (shared, key.alignment);
+  pango_layout_set_justify (shared, key.justify);
+  pango_layout_set_auto_dir (shared, key.auto_dir);
+  pango_layout_set_single_paragraph_mode (shared, key.single_paragraph);
+  g_object_set_qdata (G_OBJECT (shared), quark_shared_layout, GINT_TO_POINTER (TRUE));
+
+  sl = g_slice_new (SharedLayout);
+  *sl = key;
+  sl->text = g_strdup (key.text);
+  sl->layout = shared;
+  sl->lru_link.data = sl;
+  sl->lru_link.prev = sl->lru_link.next = NULL;
+  sl->context->n_layouts++;
+
+  g_queue_push_head_link (&shared_layouts_lru, &sl->lru_link);
+  g_hash_table_add (shared_layouts, sl);
+
+  if (shared_layouts_lru.length > MAX_SHARED_LAYOUTS)
+    g_hash_table_remove (shared_layouts, g_queue_peek_tail (&shared_layouts_lru));
+
+  return g_object_ref (shared);
+}
+
+/*
+ * _gtk_pango_layout_is_shared:
+ * @layout: a #PangoLayout
+ *
+ * Returns whether @layout was returned by _gtk_pango_layout_get_shared().
+ * Such layouts must not be modified.
+ *
+ * Returns: %TRUE if @layout is shared
+ */
+gboolean
+_gtk_pango_layout_is_shared (PangoLayout *layout)
+{
+  return quark_shared_layout != 0 &&
+         g_object_get_qdata (G_OBJECT (layout), quark_shared_layout) != NULL;
+}
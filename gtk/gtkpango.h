@@ -63,6 +63,10 @@ gchar *_gtk_pango_get_text_after  (PangoLayout     *layout,
 PangoAttrList *_gtk_pango_attr_list_merge (PangoAttrList *into,
                                            PangoAttrList *from);
 
+PangoLayout *_gtk_pango_layout_get_shared (PangoLayout *layout,
+                                           int          width);
+gboolean     _gtk_pango_layout_is_shared  (PangoLayout *layout);
+
 G_END_DECLS
 
 #endif /* __GTK_PANGO_H__ */
@@ -2317,6 +2317,53 @@ increment_page_sequence (PrintPagesData *data)
   data->total++;
 }
 
+/* The pages are rendered from a source that works like an idle, but
+ * that can be paused while the application draws a page on its own,
+ * see gtk_print_operation_set_defer_drawing(). It is ready while its
+ * ready time is 0.
+ */
+static gboolean
+print_pages_source_dispatch (GSource     *source,
+                             GSourceFunc  callback,
+                             gpointer     user_data)
+{
+  gboolean result;
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  gdk_threads_enter ();
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  result = callback (user_data);
+
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  gdk_threads_leave ();
+  G_GNUC_END_IGNORE_DEPRECATIONS
+
+  return result;
+}
+
+static GSourceFuncs print_pages_source_funcs = {
+  NULL,
+  NULL,
+  print_pages_source_dispatch,
+  NULL
+};
+
+static void
+print_pages_set_paused (GtkPrintOperation *op,
+                        gboolean           paused)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  GSource *source;
+
+  if (priv->print_pages_idle_id == 0)
+    return;
+
+  source = g_main_context_find_source_by_id (NULL, priv->print_pages_idle_id);
+  if (source != NULL)
+    g_source_set_ready_time (source, paused ? -1 : 0);
+}
+
 static void
 print_pages_idle_done (gpointer user_data)
 {
@@ -2407,6 +2454,9 @@ gtk_print_operation_set_defer_drawing (GtkPrintOperation *op)
   g_return_if_fail (priv->page_drawing_state == GTK_PAGE_DRAWING_STATE_DRAWING);
 
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DEFERRED_DRAWING;
+
+  /* Don't spin the main loop until the page is finished */
+  print_pages_set_paused (op, TRUE);
 }
 
 /**
@@ -2467,6 +2517,9 @@ gtk_print_operation_get_embed_page_setup (GtkPrintOperation *op)
  * has to be called by application. In another case it is called by the library
  * itself.
  *
+ * The next page is not rendered before this function is called, and the
+ * operation does not use any CPU time while it waits.
+ *
  * Since: 2.16
  **/
 void
@@ -2489,6 +2542,8 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
   g_object_unref (page_setup);
 
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
+
+  print_pages_set_paused (op, FALSE);
 }
 
 static void
@@ -2971,6 +3026,7 @@ print_pages (GtkPrintOperation       *op,
 {
   GtkPrintOperationPrivate *priv = op->priv;
   PrintPagesData *data;
+  GSource *source;
  
   if (!do_print) 
     {
@@ -3076,11 +3132,13 @@ print_pages (GtkPrintOperation       *op,
       priv->manual_number_up_layout = gtk_print_settings_get_number_up_layout (priv->print_settings);
     }
   
-  priv->print_pages_idle_id = gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE + 10,
-					                 print_pages_idle, 
-					                 data, 
-					                 print_pages_idle_done);
-  g_source_set_name_by_id (priv->print_pages_idle_id, "[gtk+] print_pages_idle");
+  source = g_source_new (&print_pages_source_funcs, sizeof (GSource));
+  g_source_set_priority (source, G_PRIORITY_DEFAULT_IDLE + 10);
+  g_source_set_ready_time (source, 0);
+  g_source_set_callback (source, print_pages_idle, data, print_pages_idle_done);
+  g_source_set_name (source, "[gtk+] print_pages_idle");
+  priv->print_pages_idle_id = g_source_attach (source, NULL);
+  g_source_unref (source);
   
   /* Recursive main loop to make sure we don't exit  on sync operations  */
   if (priv->is_sync)
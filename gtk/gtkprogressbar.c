@@ -760,7 +760,10 @@ tick_cb (GtkWidget     *widget,
   gdouble iteration, pulse_iterations, current_iterations, fraction;
 
   if (priv->pulse2 == 0 && priv->pulse1 == 0)
-    return G_SOURCE_CONTINUE;
+    {
+      priv->tick_id = 0;
+      return G_SOURCE_REMOVE;
+    }
 
   frame_time = gdk_frame_clock_get_frame_time (frame_clock);
   gtk_progress_tracker_advance_frame (&priv->tracker, frame_time);
@@ -778,8 +781,14 @@ tick_cb (GtkWidget     *widget,
   fraction = priv->pulse_fraction * (iteration - priv->last_iteration) / MAX (pulse_iterations, current_iterations);
   priv->last_iteration = iteration;
 
+  /* The block stops when pulses stop coming in. Don't keep the
+   * frame clock running for that, the next pulse restarts the tick.
+   */
   if (current_iterations > 3 * pulse_iterations)
-    return G_SOURCE_CONTINUE;
+    {
+      priv->tick_id = 0;
+      return G_SOURCE_REMOVE;
+    }
 
   /* advance the block */
   if (priv->activity_dir == 0)
@@ -808,6 +817,18 @@ tick_cb (GtkWidget     *widget,
   return G_SOURCE_CONTINUE;
 }
 
+static void
+gtk_progress_bar_start_tick (GtkProgressBar *pbar)
+{
+  GtkProgressBarPrivate *priv = pbar->priv;
+
+  /* No fixed schedule for pulses, will adapt after calls to update_pulse. Just
+   * start the tracker to repeat forever with iterations every second.*/
+  gtk_progress_tracker_start (&priv->tracker, G_USEC_PER_SEC, 0, INFINITY);
+  priv->tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (pbar), tick_cb, NULL, NULL);
+  priv->last_iteration = 0;
+}
+
 static void
 gtk_progress_bar_act_mode_enter (GtkProgressBar *pbar)
 {
@@ -837,13 +858,9 @@ gtk_progress_bar_act_mode_enter (GtkProgressBar *pbar)
     }
 
   update_node_classes (pbar);
-  /* No fixed schedule for pulses, will adapt after calls to update_pulse. Just
-   * start the tracker to repeat forever with iterations every second.*/
-  gtk_progress_tracker_start (&priv->tracker, G_USEC_PER_SEC, 0, INFINITY);
-  priv->tick_id = gtk_widget_add_tick_callback (widget, tick_cb, NULL, NULL);
   priv->pulse2 = 0;
   priv->pulse1 = 0;
-  priv->last_iteration = 0;
+  gtk_progress_bar_start_tick (pbar);
 }
 
 static void
@@ -940,6 +957,9 @@ gtk_progress_bar_update_pulse (GtkProgressBar *pbar)
 
   priv->pulse1 = priv->pulse2;
   priv->pulse2 = pulse_time;
+
+  if (priv->tick_id == 0)
+    gtk_progress_bar_start_tick (pbar);
 }
 
 /**
@@ -21,7 +21,8 @@
 
 static GtkRBNode * _gtk_rbnode_new                (GtkRBTree  *tree,
 						   gint        height);
-static void        _gtk_rbnode_free               (GtkRBNode  *node);
+static void        _gtk_rbnode_free               (GtkRBTree  *tree,
+                                                   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_left        (GtkRBTree  *tree,
 						   GtkRBNode  *node);
 static void        _gtk_rbnode_rotate_right       (GtkRBTree  *tree,
@@ -54,11 +55,38 @@ _gtk_rbtree_is_nil (GtkRBNode *node)
   return node == &nil;
 }
 
+#define RBNODE_CHUNK_MIN 16
+#define RBNODE_CHUNK_MAX 1024
+
 static GtkRBNode *
 _gtk_rbnode_new (GtkRBTree *tree,
 		 gint       height)
 {
-  GtkRBNode *node = g_slice_new (GtkRBNode);
+  GtkRBNode *node;
+
+  if (tree->free_nodes)
+    {
+      node = tree->free_nodes;
+      tree->free_nodes = node->parent;
+    }
+  else
+    {
+      if (tree->n_unused == 0)
+        {
+          /* Start small, lots of trees have only a few nodes */
+          if (tree->chunk_size == 0)
+            tree->chunk_size = RBNODE_CHUNK_MIN;
+          else
+            tree->chunk_size = MIN (tree->chunk_size * 2, RBNODE_CHUNK_MAX);
+
+          tree->node_chunks = g_slist_prepend (tree->node_chunks,
+                                               g_new (GtkRBNode, tree->chunk_size));
+          tree->n_unused = tree->chunk_size;
+        }
+
+      node = (GtkRBNode *) tree->node_chunks->data + tree->chunk_size - tree->n_unused;
+      tree->n_unused--;
+    }
 
   node->left = (GtkRBNode *) &nil;
   node->right = (GtkRBNode *) &nil;
@@ -72,7 +100,8 @@ _gtk_rbnode_new (GtkRBTree *tree,
 }
 
 static void
-_gtk_rbnode_free (GtkRBNode *node)
+_gtk_rbnode_free (GtkRBTree *tree,
+                  GtkRBNode *node)
 {
 #ifdef G_ENABLE_DEBUG
   if (GTK_DEBUG_CHECK (TREE))
@@ -86,7 +115,20 @@ _gtk_rbnode_free (GtkRBNode *node)
       node->flags = 0;
     }
 #endif
-  g_slice_free (GtkRBNode, node);
+
+  /* The free list is linked through the parent pointers */
+  node->parent = tree->free_nodes;
+  tree->free_nodes = node;
+}
+
+static void
+_gtk_rbtree_free_nodes (GtkRBTree *tree)
+{
+  g_slist_free_full (tree->node_chunks, g_free);
+  tree->node_chunks = NULL;
+  tree->free_nodes = NULL;
+  tree->chunk_size = 0;
+  tree->n_unused = 0;
 }
 
 static void
@@ -333,6 +375,10 @@ _gtk_rbtree_new (void)
   retval = g_new (GtkRBTree, 1);
   retval->parent_tree = NULL;
   retval->parent_node = NULL;
+  retval->node_chunks = NULL;
+  retval->free_nodes = NULL;
+  retval->chunk_size = 0;
+  retval->n_unused = 0;
 
   retval->root = (GtkRBNode *) &nil;
 
@@ -346,8 +392,6 @@ _gtk_rbtree_free_helper (GtkRBTree  *tree,
 {
   if (node->children)
     _gtk_rbtree_free (node->children);
-
-  _gtk_rbnode_free (node);
 }
 
 void
@@ -362,6 +406,7 @@ _gtk_rbtree_free (GtkRBTree *tree)
   if (tree->parent_node &&
       tree->parent_node->children == tree)
     tree->parent_node->children = NULL;
+  _gtk_rbtree_free_nodes (tree);
   g_free (tree);
 }
 
@@ -1246,7 +1291,11 @@ _gtk_rbtree_remove_node (GtkRBTree *tree,
                          y_height - node_height);
     }
 
-  _gtk_rbnode_free (node);
+  _gtk_rbnode_free (tree, node);
+
+  /* Give the memory back once the tree is empty */
+  if (_gtk_rbtree_is_nil (tree->root))
+    _gtk_rbtree_free_nodes (tree);
 
 #ifdef G_ENABLE_DEBUG
   if (GTK_DEBUG_CHECK (TREE))
@@ -57,6 +57,14 @@ struct _GtkRBTree
   GtkRBNode *root;
   GtkRBTree *parent_tree;
   GtkRBNode *parent_node;
+
+  /* Nodes are allocated in chunks owned by the tree, so rows that
+   * are next to each other usually are next to each other in memory.
+   */
+  GSList *node_chunks;
+  GtkRBNode *free_nodes;
+  guint chunk_size;
+  guint n_unused;
 };
 
 struct _GtkRBNode
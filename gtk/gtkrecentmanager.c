@@ -167,6 +167,9 @@ struct _GtkRecentManagerPrivate
   gchar *filename;
 
   guint is_dirty : 1;
+  guint write_in_progress : 1;
+  guint write_pending : 1;
+  guint sync_writes : 1;
 
   gint size;
 
@@ -174,6 +177,12 @@ struct _GtkRecentManagerPrivate
 
   GFileMonitor *monitor;
 
+  /* what the file looked like when we last read or wrote it */
+  gboolean file_exists;
+  guint64 file_inode;
+  gint64 file_size;
+  gint64 file_mtime;
+
   guint changed_timeout;
   guint changed_age;
 };
@@ -422,6 +431,9 @@ gtk_recent_manager_dispose (GObject *gobject)
 
   if (priv->is_dirty)
     {
+      /* there is no main loop to finish an asynchronous write */
+      priv->sync_writes = TRUE;
+
       g_object_ref (manager);
       g_signal_emit (manager, signal_changed, 0);
       g_object_unref (manager);
@@ -430,6 +442,164 @@ gtk_recent_manager_dispose (GObject *gobject)
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->dispose (gobject);
 }
 
+/* Remembers the state of the file on disk after reading or writing it,
+ * so that we can tell our own writes, and repeated notifications for
+ * the same write, from actual changes made by other processes.
+ */
+static void
+gtk_recent_manager_update_file_stamp (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GStatBuf buf;
+
+  if (priv->filename == NULL || g_stat (priv->filename, &buf) < 0)
+    {
+      priv->file_exists = FALSE;
+      return;
+    }
+
+  priv->file_exists = TRUE;
+  priv->file_inode = buf.st_ino;
+  priv->file_size = buf.st_size;
+  priv->file_mtime = buf.st_mtime;
+}
+
+static gboolean
+gtk_recent_manager_file_changed (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GStatBuf buf;
+
+  if (priv->filename == NULL)
+    return FALSE;
+
+  if (g_stat (priv->filename, &buf) < 0)
+    return priv->file_exists;
+
+  return !priv->file_exists ||
+         priv->file_inode != (guint64) buf.st_ino ||
+         priv->file_size != (gint64) buf.st_size ||
+         priv->file_mtime != (gint64) buf.st_mtime;
+}
+
+static void
+gtk_recent_manager_write_finished (GtkRecentManager *manager,
+                                   GError           *write_error)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+
+  if (write_error)
+    {
+      gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to store changes into '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 write_error->message);
+      g_free (utf8);
+      return;
+    }
+
+  if (g_chmod (priv->filename, 0600) < 0)
+    {
+      gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
+      g_warning ("Attempting to set the permissions of '%s', but failed: %s",
+                 utf8 ? utf8 : "(invalid filename)",
+                 g_strerror (errno));
+      g_free (utf8);
+    }
+
+  gtk_recent_manager_update_file_stamp (manager);
+}
+
+static void gtk_recent_manager_write (GtkRecentManager *manager);
+
+static void
+gtk_recent_manager_write_done (GObject      *source,
+                               GAsyncResult *result,
+                               gpointer      user_data)
+{
+  GtkRecentManager *manager = user_data;
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *write_error = NULL;
+
+  g_file_replace_contents_finish (G_FILE (source), result, NULL, &write_error);
+
+  gdk_threads_enter ();
+
+  priv->write_in_progress = FALSE;
+
+  if (priv->filename != NULL)
+    gtk_recent_manager_write_finished (manager, write_error);
+  g_clear_error (&write_error);
+
+  /* the list changed again while we were writing */
+  if (priv->write_pending)
+    {
+      priv->write_pending = FALSE;
+      gtk_recent_manager_write (manager);
+    }
+
+  gdk_threads_leave ();
+
+  g_object_unref (manager);
+}
+
+/* Writes the list to the file. The list is serialized right away, and
+ * the file is replaced atomically by a GIO worker thread; the list in
+ * memory stays authoritative until the write has finished.
+ */
+static void
+gtk_recent_manager_write (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GError *write_error = NULL;
+  gchar *data;
+  gsize length;
+
+  if (priv->filename == NULL)
+    return;
+
+  if (priv->write_in_progress)
+    {
+      priv->write_pending = TRUE;
+      return;
+    }
+
+  data = g_bookmark_file_to_data (priv->recent_items, &length, &write_error);
+  if (data == NULL)
+    {
+      gtk_recent_manager_write_finished (manager, write_error);
+      g_error_free (write_error);
+      return;
+    }
+
+  if (priv->sync_writes)
+    {
+      g_file_set_contents (priv->filename, data, length, &write_error);
+      gtk_recent_manager_write_finished (manager, write_error);
+      g_clear_error (&write_error);
+      g_free (data);
+    }
+  else
+    {
+      GFile *file;
+      GBytes *bytes;
+
+      file = g_file_new_for_path (priv->filename);
+      bytes = g_bytes_new_take (data, length);
+
+      priv->write_in_progress = TRUE;
+      g_file_replace_contents_bytes_async (file, bytes,
+                                           NULL, FALSE,
+                                           G_FILE_CREATE_PRIVATE,
+                                           NULL,
+                                           gtk_recent_manager_write_done,
+                                           g_object_ref (manager));
+
+      g_bytes_unref (bytes);
+      g_object_unref (file);
+    }
+}
+
 static void
 gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
 {
@@ -446,8 +616,6 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
   if (priv->is_dirty)
     {
-      GError *write_error;
-
       /* we are marked as dirty, so we dump the content of our
        * recently used items list
        */
@@ -493,29 +661,7 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
             }
         }
 
-      if (priv->filename != NULL)
-        {
-          write_error = NULL;
-          g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-          if (write_error)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to store changes into '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         write_error->message);
-              g_free (utf8);
-              g_error_free (write_error);
-            }
-
-          if (g_chmod (priv->filename, 0600) < 0)
-            {
-              gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
-              g_warning ("Attempting to set the permissions of '%s', but failed: %s",
-                         utf8 ? utf8 : "(invalid filename)",
-                         g_strerror (errno));
-              g_free (utf8);
-            }
-        }
+      gtk_recent_manager_write (manager);
 
       /* mark us as clean */
       priv->is_dirty = FALSE;
@@ -678,6 +824,8 @@ build_recent_items_list (GtkRecentManager *manager)
 
   if (priv->filename != NULL)
     {
+      gtk_recent_manager_update_file_stamp (manager);
+
       /* the file exists, and it's valid (we hope); if not, destroy the container
        * object and hope for a better result when the next "changed" signal is
        * fired.
@@ -1406,6 +1554,17 @@ emit_manager_changed (gpointer data)
   manager->priv->changed_age = 0;
   manager->priv->changed_timeout = 0;
 
+  /* The file monitor also tells us about our own writes, and may
+   * report a single write several times; re-reading the file and
+   * having every recent chooser rebuild its list is only worth it
+   * if the file was really changed by someone else. While we are
+   * writing, the list in memory is newer than the file anyway.
+   */
+  if (!manager->priv->is_dirty &&
+      (manager->priv->write_in_progress ||
+       !gtk_recent_manager_file_changed (manager)))
+    return FALSE;
+
   g_signal_emit (manager, signal_changed, 0);
 
   return FALSE;
@@ -1432,10 +1591,7 @@ gtk_recent_manager_changed (GtkRecentManager *manager)
       if (manager->priv->changed_age > 250)
         {
           g_source_remove (manager->priv->changed_timeout);
-          g_signal_emit (manager, signal_changed, 0);
-
-          manager->priv->changed_age = 0;
-          manager->priv->changed_timeout = 0;
+          emit_manager_changed (manager);
         }
     }
 }
@@ -337,6 +337,233 @@ gtk_border_image_render (GtkBorderImage   *image,
   cairo_surface_destroy (surface);
 }
 
+/* Snapshots the part @slice_x, @slice_y, @slice_width, @slice_height
+ * of @source, which is @source_width x @source_height big, stretched
+ * to fill the given tile.
+ */
+static void
+gtk_border_image_snapshot_tile (GtkSnapshot *snapshot,
+                                GtkCssImage *source,
+                                double       source_width,
+                                double       source_height,
+                                double       slice_x,
+                                double       slice_y,
+                                double       slice_width,
+                                double       slice_height,
+                                double       x,
+                                double       y,
+                                double       width,
+                                double       height)
+{
+  graphene_matrix_t scale;
+
+  gtk_snapshot_push_clip (snapshot, &GRAPHENE_RECT_INIT (x, y, width, height), "BorderImageTile");
+
+  gtk_snapshot_offset (snapshot, x, y);
+  graphene_matrix_init_scale (&scale, width / slice_width, height / slice_height, 1);
+  gtk_snapshot_push_transform (snapshot, &scale, "BorderImageScale");
+  gtk_snapshot_offset (snapshot, - slice_x, - slice_y);
+
+  gtk_css_image_snapshot (source, snapshot, source_width, source_height);
+
+  gtk_snapshot_pop (snapshot);
+  gtk_snapshot_pop (snapshot);
+}
+
+/* This is the same as gtk_border_image_render_slice(), but it creates
+ * clip, transform and repeat nodes for the slice, so that the source
+ * image is not rasterized by cairo.
+ */
+static void
+gtk_border_image_snapshot_slice (GtkSnapshot       *snapshot,
+                                 GtkCssImage       *source,
+                                 double             source_width,
+                                 double             source_height,
+                                 double             slice_x,
+                                 double             slice_y,
+                                 double             slice_width,
+                                 double             slice_height,
+                                 double             x,
+                                 double             y,
+                                 double             width,
+                                 double             height,
+                                 GtkCssRepeatStyle  hrepeat,
+                                 GtkCssRepeatStyle  vrepeat)
+{
+  double hscale, vscale;
+  double hspace = 0, vspace = 0;
+  double tile_x, tile_y;
+
+  /* We can't draw center tiles yet */
+  g_assert (hrepeat == GTK_CSS_REPEAT_STYLE_STRETCH || vrepeat == GTK_CSS_REPEAT_STYLE_STRETCH);
+
+  hscale = width / slice_width;
+  vscale = height / slice_height;
+
+  switch (hrepeat)
+    {
+    case GTK_CSS_REPEAT_STYLE_REPEAT:
+      hscale = vscale;
+      break;
+    case GTK_CSS_REPEAT_STYLE_SPACE:
+      {
+        double n;
+
+        hscale = vscale;
+
+        n = floor (width / (hscale * slice_width));
+        if (n == 0)
+          return;
+        hspace = (width - n * hscale * slice_width) / (n + 1);
+        x += hspace;
+        width -= 2 * hspace;
+      }
+      break;
+    case GTK_CSS_REPEAT_STYLE_STRETCH:
+      break;
+    case GTK_CSS_REPEAT_STYLE_ROUND:
+      hscale = width / (slice_width * MAX (round (width / (slice_width * vscale)), 1));
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  switch (vrepeat)
+    {
+    case GTK_CSS_REPEAT_STYLE_REPEAT:
+      vscale = hscale;
+      break;
+    case GTK_CSS_REPEAT_STYLE_SPACE:
+      {
+        double n;
+
+        vscale = hscale;
+
+        n = floor (height / (vscale * slice_height));
+        if (n == 0)
+          return;
+        vspace = (height - n * vscale * slice_height) / (n + 1);
+        y += vspace;
+        height -= 2 * vspace;
+      }
+      break;
+    case GTK_CSS_REPEAT_STYLE_STRETCH:
+      break;
+    case GTK_CSS_REPEAT_STYLE_ROUND:
+      vscale = height / (slice_height * MAX (round (height / (slice_height * hscale)), 1));
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  if (hrepeat == GTK_CSS_REPEAT_STYLE_STRETCH &&
+      vrepeat == GTK_CSS_REPEAT_STYLE_STRETCH)
+    {
+      gtk_border_image_snapshot_tile (snapshot, source, source_width, source_height,
+                                      slice_x, slice_y, slice_width, slice_height,
+                                      x, y, width, height);
+      return;
+    }
+
+  /* Repeated tiles are centered in the area, spaced tiles have the
+   * space after them included in the repeat step. */
+  tile_x = x;
+  tile_y = y;
+  if (hrepeat == GTK_CSS_REPEAT_STYLE_REPEAT)
+    tile_x = x + (width - hscale * slice_width) / 2;
+  if (vrepeat == GTK_CSS_REPEAT_STYLE_REPEAT)
+    tile_y = y + (height - vscale * slice_height) / 2;
+
+  gtk_snapshot_push_repeat (snapshot,
+                            &GRAPHENE_RECT_INIT (x, y, width, height),
+                            &GRAPHENE_RECT_INIT (tile_x, tile_y,
+                                                 hscale * slice_width + hspace,
+                                                 vscale * slice_height + vspace),
+                            "BorderImageRepeat");
+
+  gtk_border_image_snapshot_tile (snapshot, source, source_width, source_height,
+                                  slice_x, slice_y, slice_width, slice_height,
+                                  tile_x, tile_y,
+                                  hscale * slice_width, vscale * slice_height);
+
+  gtk_snapshot_pop (snapshot);
+}
+
+static void
+gtk_border_image_snapshot (GtkBorderImage   *image,
+                           const float       border_width[4],
+                           GtkSnapshot      *snapshot,
+                           double            width,
+                           double            height)
+{
+  GtkBorderImageSliceSize vertical_slice[3], horizontal_slice[3];
+  GtkBorderImageSliceSize vertical_border[3], horizontal_border[3];
+  double source_width, source_height;
+  int h, v;
+
+  _gtk_css_image_get_concrete_size (image->source,
+                                    0, 0,
+                                    width, height,
+                                    &source_width, &source_height);
+
+  gtk_border_image_compute_slice_size (horizontal_slice,
+                                       source_width,
+                                       _gtk_css_number_value_get (_gtk_css_border_value_get_left (image->slice), source_width),
+                                       _gtk_css_number_value_get (_gtk_css_border_value_get_right (image->slice), source_width));
+  gtk_border_image_compute_slice_size (vertical_slice,
+                                       source_height,
+                                       _gtk_css_number_value_get (_gtk_css_border_value_get_top (image->slice), source_height),
+                                       _gtk_css_number_value_get (_gtk_css_border_value_get_bottom (image->slice), source_height));
+  gtk_border_image_compute_border_size (horizontal_border,
+                                        0,
+                                        width,
+                                        border_width[GTK_CSS_LEFT],
+                                        border_width[GTK_CSS_RIGHT],
+                                        _gtk_css_border_value_get_left (image->width),
+                                        _gtk_css_border_value_get_right (image->width));
+  gtk_border_image_compute_border_size (vertical_border,
+                                        0,
+                                        height,
+                                        border_width[GTK_CSS_TOP],
+                                        border_width[GTK_CSS_BOTTOM],
+                                        _gtk_css_border_value_get_top (image->width),
+                                        _gtk_css_border_value_get_bottom(image->width));
+
+  for (v = 0; v < 3; v++)
+    {
+      if (vertical_slice[v].size == 0 ||
+          vertical_border[v].size == 0)
+        continue;
+
+      for (h = 0; h < 3; h++)
+        {
+          if (horizontal_slice[h].size == 0 ||
+              horizontal_border[h].size == 0)
+            continue;
+
+          if (h == 1 && v == 1)
+            continue;
+
+          gtk_border_image_snapshot_slice (snapshot,
+                                           image->source,
+                                           source_width,
+                                           source_height,
+                                           horizontal_slice[h].offset,
+                                           vertical_slice[v].offset,
+                                           horizontal_slice[h].size,
+                                           vertical_slice[v].size,
+                                           horizontal_border[h].offset,
+                                           vertical_border[v].offset,
+                                           horizontal_border[h].size,
+                                           vertical_border[v].size,
+                                           h == 1 ? _gtk_css_border_repeat_value_get_x (image->repeat) : GTK_CSS_REPEAT_STYLE_STRETCH,
+                                           v == 1 ? _gtk_css_border_repeat_value_get_y (image->repeat) : GTK_CSS_REPEAT_STYLE_STRETCH);
+        }
+    }
+}
+
 static void
 render_frame_fill (cairo_t        *cr,
                    GskRoundedRect *border_box,
@@ -445,26 +672,19 @@ snapshot_frame_fill (GtkSnapshot          *snapshot,
 }
 
 static void
-set_stroke_style (cairo_t        *cr,
-                  double          line_width,
-                  GtkBorderStyle  style,
-                  double          length)
+compute_dash_segments (double          line_width,
+                       GtkBorderStyle  style,
+                       double          length,
+                       double          segments[2])
 {
-  double segments[2];
   double n;
 
-  cairo_set_line_width (cr, line_width);
-
   if (style == GTK_BORDER_STYLE_DOTTED)
     {
       n = round (0.5 * length / line_width);
 
       segments[0] = 0;
       segments[1] = n ? length / n : 2;
-      cairo_set_dash (cr, segments, G_N_ELEMENTS (segments), 0);
-
-      cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
-      cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
     }
   else
     {
@@ -484,8 +704,29 @@ set_stroke_style (cairo_t        *cr,
           segments[0] = n ? (1. / 3) * length / n : 1;
           segments[1] = 2 * segments[0];
         }
-      cairo_set_dash (cr, segments, G_N_ELEMENTS (segments), 0);
+    }
+}
 
+static void
+set_stroke_style (cairo_t        *cr,
+                  double          line_width,
+                  GtkBorderStyle  style,
+                  double          length)
+{
+  double segments[2];
+
+  cairo_set_line_width (cr, line_width);
+
+  compute_dash_segments (line_width, style, length, segments);
+  cairo_set_dash (cr, segments, G_N_ELEMENTS (segments), 0);
+
+  if (style == GTK_BORDER_STYLE_DOTTED)
+    {
+      cairo_set_line_cap (cr, CAIRO_LINE_CAP_ROUND);
+      cairo_set_line_join (cr, CAIRO_LINE_JOIN_ROUND);
+    }
+  else
+    {
       cairo_set_line_cap (cr, CAIRO_LINE_CAP_SQUARE);
       cairo_set_line_join (cr, CAIRO_LINE_JOIN_MITER);
     }
@@ -578,6 +819,92 @@ render_frame_stroke (cairo_t        *cr,
     }
 }
 
+/* Appends the part from @start to @end of a dash that goes clockwise
+ * around @rect, starting at the top left corner.
+ *
+ * The dash is extended by half the line width on both ends, which
+ * is what square caps and miter joins do.
+ */
+static void
+snapshot_dash (GtkSnapshot           *snapshot,
+               const graphene_rect_t *rect,
+               double                 line_width,
+               double                 start,
+               double                 end,
+               const GdkRGBA         *color)
+{
+  const double side_length[4] = { rect->size.width, rect->size.height, rect->size.width, rect->size.height };
+  const double x = rect->origin.x;
+  const double y = rect->origin.y;
+  const double w = rect->size.width;
+  const double h = rect->size.height;
+  const double e = line_width / 2;
+  double side_start = 0;
+  guint i;
+
+  for (i = 0; i < 4; i++)
+    {
+      double u0, u1;
+
+      if (end >= side_start && start <= side_start + side_length[i])
+        {
+          u0 = MAX (start, side_start) - side_start;
+          u1 = MIN (end, side_start + side_length[i]) - side_start;
+
+          if (i == GTK_CSS_TOP)
+            gtk_snapshot_append_color (snapshot, color,
+                                       &GRAPHENE_RECT_INIT (x + u0 - e, y - e, u1 - u0 + 2 * e, 2 * e),
+                                       "Dash");
+          else if (i == GTK_CSS_RIGHT)
+            gtk_snapshot_append_color (snapshot, color,
+                                       &GRAPHENE_RECT_INIT (x + w - e, y + u0 - e, 2 * e, u1 - u0 + 2 * e),
+                                       "Dash");
+          else if (i == GTK_CSS_BOTTOM)
+            gtk_snapshot_append_color (snapshot, color,
+                                       &GRAPHENE_RECT_INIT (x + w - u1 - e, y + h - e, u1 - u0 + 2 * e, 2 * e),
+                                       "Dash");
+          else
+            gtk_snapshot_append_color (snapshot, color,
+                                       &GRAPHENE_RECT_INIT (x - e, y + h - u1 - e, 2 * e, u1 - u0 + 2 * e),
+                                       "Dash");
+        }
+
+      side_start += side_length[i];
+    }
+}
+
+/* Dashed borders around rectangles, like focus rectangles, are made
+ * from color nodes, so they don't need cairo. The dashes overlap at
+ * the corners, so they are drawn opaque and the alpha of the color is
+ * applied to the whole border.
+ */
+static void
+snapshot_dashed_frame (GtkSnapshot          *snapshot,
+                       const GskRoundedRect *outline,
+                       float                 line_width,
+                       const GdkRGBA        *color)
+{
+  graphene_rect_t stroke_rect;
+  GdkRGBA opaque;
+  double segments[2];
+  double length, pos;
+
+  stroke_rect = outline->bounds;
+  graphene_rect_inset (&stroke_rect, line_width / 2.0, line_width / 2.0);
+  length = 2 * (stroke_rect.size.width + stroke_rect.size.height);
+  compute_dash_segments (line_width, GTK_BORDER_STYLE_DASHED, length, segments);
+
+  opaque = *color;
+  opaque.alpha = 1.0;
+
+  gtk_snapshot_push_opacity (snapshot, color->alpha, "DashedBorder");
+
+  for (pos = 0; pos < length; pos += segments[0] + segments[1])
+    snapshot_dash (snapshot, &stroke_rect, line_width, pos, MIN (pos + segments[0], length), &opaque);
+
+  gtk_snapshot_pop (snapshot);
+}
+
 static void
 snapshot_frame_stroke (GtkSnapshot    *snapshot,
                        GskRoundedRect *outline,
@@ -589,6 +916,20 @@ snapshot_frame_stroke (GtkSnapshot    *snapshot,
   double double_width[4] = { border_width[0], border_width[1], border_width[2], border_width[3] };
   cairo_t *cr;
 
+  if (stroke_style == GTK_BORDER_STYLE_DASHED &&
+      hidden_side == 0 &&
+      gsk_rounded_rect_is_rectilinear (outline) &&
+      border_width[0] == border_width[1] &&
+      border_width[0] == border_width[2] &&
+      border_width[0] == border_width[3] &&
+      gdk_rgba_equal (&colors[0], &colors[1]) &&
+      gdk_rgba_equal (&colors[0], &colors[2]) &&
+      gdk_rgba_equal (&colors[0], &colors[3]))
+    {
+      snapshot_dashed_frame (snapshot, outline, border_width[0], &colors[0]);
+      return;
+    }
+
   cr = gtk_snapshot_append_cairo (snapshot,
                                   &outline->bounds,
                                   "BorderStroke");
@@ -927,25 +1268,15 @@ gtk_css_style_snapshot_border (GtkCssStyle *style,
 {
   GtkBorderImage border_image;
   float border_width[4];
-  graphene_rect_t bounds;
-  cairo_t *cr;
 
   border_width[0] = _gtk_css_number_value_get (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_TOP_WIDTH), 100);
   border_width[1] = _gtk_css_number_value_get (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH), 100);
   border_width[2] = _gtk_css_number_value_get (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH), 100);
   border_width[3] = _gtk_css_number_value_get (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_LEFT_WIDTH), 100);
 
-  graphene_rect_init (&bounds, 0, 0, width, height);
-
   if (gtk_border_image_init (&border_image, style))
     {
-      double double_width[4] = { border_width[0], border_width[1], border_width[2], border_width[3] };
-
-      cr = gtk_snapshot_append_cairo (snapshot,
-                                      &bounds,
-                                      "Border Image");
-      gtk_border_image_render (&border_image, double_width, cr, 0, 0, width, height);
-      cairo_destroy (cr);
+      gtk_border_image_snapshot (&border_image, border_width, snapshot, width, height);
     }
   else
     {
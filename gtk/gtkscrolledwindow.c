@@ -30,6 +30,7 @@
 #include "gtkadjustmentprivate.h"
 #include "gtkbindings.h"
 #include "gtkdnd.h"
+#include "gtkeventcontrollerscrollprivate.h"
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "gtkmarshalers.h"
@@ -177,6 +178,9 @@
 /* Animated scrolling */
 #define ANIMATION_DURATION 200
 
+/* Touchpad scrolling */
+#define MAX_SCROLL_PREDICTION 50000 /* µs */
+
 /* Overlay scrollbars */
 #define INDICATOR_FADE_OUT_DELAY 2000
 #define INDICATOR_FADE_OUT_DURATION 1000
@@ -270,6 +274,15 @@ struct _GtkScrolledWindowPrivate
 
   gdouble                unclamped_hadj_value;
   gdouble                unclamped_vadj_value;
+
+  /* Touchpad deltas are applied once per frame */
+  guint                  smooth_scroll_id;
+  gint64                 smooth_scroll_time;
+  gdouble                smooth_scroll_dx;
+  gdouble                smooth_scroll_dy;
+  /* The part of the unclamped values that is predicted */
+  gdouble                hscroll_prediction;
+  gdouble                vscroll_prediction;
 };
 
 typedef struct
@@ -1303,6 +1316,142 @@ start_scroll_deceleration_cb (gpointer user_data)
   return FALSE;
 }
 
+static void
+apply_smooth_scroll (GtkScrolledWindow *scrolled_window,
+                     GtkOrientation     orientation,
+                     gdouble            delta,
+                     gdouble            prediction)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+  GtkAdjustment *adj;
+  gdouble *value, *applied_prediction;
+  gdouble position;
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      adj = gtk_scrollbar_get_adjustment (GTK_SCROLLBAR (priv->hscrollbar));
+      value = &priv->unclamped_hadj_value;
+      applied_prediction = &priv->hscroll_prediction;
+    }
+  else
+    {
+      adj = gtk_scrollbar_get_adjustment (GTK_SCROLLBAR (priv->vscrollbar));
+      value = &priv->unclamped_vadj_value;
+      applied_prediction = &priv->vscroll_prediction;
+    }
+
+  /* The position the deltas so far scrolled to */
+  position = *value - *applied_prediction + delta;
+
+  _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
+                                             position + prediction);
+
+  /* If the value got clamped, so does the position */
+  *applied_prediction = CLAMP (*value - position, MIN (prediction, 0), MAX (prediction, 0));
+}
+
+static void
+gtk_scrolled_window_flush_smooth_scroll (GtkScrolledWindow *scrolled_window,
+                                         gdouble            lead)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+  gdouble velocity_x, velocity_y;
+
+  gtk_event_controller_scroll_get_velocity (GTK_EVENT_CONTROLLER_SCROLL (priv->scroll_controller),
+                                            &velocity_x, &velocity_y);
+
+  if (may_hscroll (scrolled_window))
+    {
+      gdouble unit = get_scroll_unit (scrolled_window, GTK_ORIENTATION_HORIZONTAL);
+
+      apply_smooth_scroll (scrolled_window, GTK_ORIENTATION_HORIZONTAL,
+                           priv->smooth_scroll_dx * unit,
+                           velocity_x * unit * lead);
+    }
+
+  if (may_vscroll (scrolled_window))
+    {
+      gdouble unit = get_scroll_unit (scrolled_window, GTK_ORIENTATION_VERTICAL);
+
+      apply_smooth_scroll (scrolled_window, GTK_ORIENTATION_VERTICAL,
+                           priv->smooth_scroll_dy * unit,
+                           velocity_y * unit * lead);
+    }
+
+  priv->smooth_scroll_dx = 0;
+  priv->smooth_scroll_dy = 0;
+}
+
+/* Touchpads don't send their events in sync with the frame clock, so
+ * a frame may see zero, one or several of them. Instead of applying the
+ * deltas as they arrive, we apply them once per frame and extrapolate
+ * the position to the time the frame gets presented, using the velocity
+ * of the scroll.
+ */
+static gboolean
+scrolled_window_smooth_scroll_cb (GtkWidget     *widget,
+                                  GdkFrameClock *frame_clock,
+                                  gpointer       user_data)
+{
+  GtkScrolledWindow *scrolled_window = GTK_SCROLLED_WINDOW (widget);
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+  gint64 frame_time, refresh_interval, presentation_time, lead;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time,
+                                    &refresh_interval, &presentation_time);
+  if (presentation_time == 0)
+    presentation_time = frame_time + refresh_interval;
+
+  lead = presentation_time - priv->smooth_scroll_time;
+  if (lead > MAX_SCROLL_PREDICTION)
+    {
+      /* The scroll stalled, stop guessing */
+      gtk_scrolled_window_flush_smooth_scroll (scrolled_window, 0);
+      priv->smooth_scroll_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  gtk_scrolled_window_flush_smooth_scroll (scrolled_window, MAX (lead, 0) / (gdouble) G_USEC_PER_SEC);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gtk_scrolled_window_queue_smooth_scroll (GtkScrolledWindow *scrolled_window,
+                                         gdouble            delta_x,
+                                         gdouble            delta_y)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+
+  priv->smooth_scroll_dx += delta_x;
+  priv->smooth_scroll_dy += delta_y;
+  priv->smooth_scroll_time = g_get_monotonic_time ();
+
+  if (priv->smooth_scroll_id == 0)
+    priv->smooth_scroll_id =
+      gtk_widget_add_tick_callback (GTK_WIDGET (scrolled_window),
+                                    scrolled_window_smooth_scroll_cb,
+                                    NULL, NULL);
+}
+
+static void
+gtk_scrolled_window_cancel_smooth_scroll (GtkScrolledWindow *scrolled_window)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+
+  if (priv->smooth_scroll_id == 0)
+    return;
+
+  gtk_widget_remove_tick_callback (GTK_WIDGET (scrolled_window),
+                                   priv->smooth_scroll_id);
+  priv->smooth_scroll_id = 0;
+  priv->smooth_scroll_dx = 0;
+  priv->smooth_scroll_dy = 0;
+  priv->hscroll_prediction = 0;
+  priv->vscroll_prediction = 0;
+}
+
 static void
 scroll_controller_scroll_begin (GtkEventControllerScroll *scroll,
                                 GtkScrolledWindow        *scrolled_window)
@@ -1341,6 +1490,12 @@ scroll_controller_scroll (GtkEventControllerScroll *scroll,
       delta_y = delta;
     }
 
+  if (priv->smooth_scroll)
+    {
+      gtk_scrolled_window_queue_smooth_scroll (scrolled_window, delta_x, delta_y);
+      delta_x = delta_y = 0;
+    }
+
   if (delta_x != 0.0 &&
       may_hscroll (scrolled_window))
     {
@@ -1393,6 +1548,13 @@ scroll_controller_scroll_end (GtkEventControllerScroll *scroll,
 {
   GtkScrolledWindowPrivate *priv = scrolled_window->priv;
 
+  /* Go to where the deltas took us, without predictions */
+  if (priv->smooth_scroll_id)
+    {
+      gtk_scrolled_window_flush_smooth_scroll (scrolled_window, 0);
+      gtk_scrolled_window_cancel_smooth_scroll (scrolled_window);
+    }
+
   priv->smooth_scroll = FALSE;
   uninstall_scroll_cursor (scrolled_window);
 }
@@ -2638,6 +2800,8 @@ gtk_scrolled_window_destroy (GtkWidget *widget)
       priv->deceleration_id = 0;
     }
 
+  gtk_scrolled_window_cancel_smooth_scroll (scrolled_window);
+
   if (priv->scroll_events_overshoot_id)
     {
       g_source_remove (priv->scroll_events_overshoot_id);
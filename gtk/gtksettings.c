@@ -26,7 +26,8 @@
 #include "gtkmodulesprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtkintl.h"
-#include "gtkwidget.h"
+#include "gtkwidgetprivate.h"
+#include "gtkwindow.h"
 #include "gtkprivate.h"
 #include "gtkcssproviderprivate.h"
 #include "gtkhslaprivate.h"
@@ -217,7 +218,7 @@ static void    settings_update_modules           (GtkSettings           *setting
 static void    settings_update_cursor_theme      (GtkSettings           *settings);
 static void    settings_update_font_options      (GtkSettings           *settings);
 static void    settings_update_font_values       (GtkSettings           *settings);
-static gboolean settings_update_fontconfig       (GtkSettings           *settings);
+static void    settings_update_fontconfig        (GtkSettings           *settings);
 static void    settings_update_theme             (GtkSettings           *settings);
 static void    settings_update_key_theme         (GtkSettings           *settings);
 static gboolean settings_update_xsetting         (GtkSettings           *settings,
@@ -1392,8 +1393,7 @@ gtk_settings_notify (GObject    *object,
       gtk_style_context_reset_widgets (priv->display);
       break;
     case PROP_FONTCONFIG_TIMESTAMP:
-      if (settings_update_fontconfig (settings))
-        gtk_style_context_reset_widgets (priv->display);
+      settings_update_fontconfig (settings);
       break;
     case PROP_ENABLE_ANIMATIONS:
       gtk_style_context_reset_widgets (priv->display);
@@ -2196,43 +2196,109 @@ settings_update_font_options (GtkSettings *settings)
   cairo_font_options_set_antialias (priv->font_options, antialias_mode);
 }
 
-static gboolean
-settings_update_fontconfig (GtkSettings *settings)
-{
 #if defined(GDK_WINDOWING_X11) || defined(GDK_WINDOWING_WAYLAND)
-  static guint    last_update_timestamp;
-  static gboolean last_update_needed;
+/* The timestamp we last reloaded fontconfig for, and the one we were
+ * asked to reload for. Reloading is shared by all displays, as the
+ * configuration is global. */
+static guint fontconfig_timestamp;
+static guint fontconfig_requested_timestamp;
+static gboolean fontconfig_reloading;
+
+static void start_fontconfig_reload (void);
+
+/* Loading the configuration and scanning the fonts can take a while
+ * after fonts were installed, so it happens in a thread. Everything
+ * keeps using the old configuration until the new one is complete.
+ */
+static void
+reload_fontconfig_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  FcConfig *config = NULL;
 
-  guint timestamp;
+  /* bug 547680 */
+  if (!FcConfigUptoDate (NULL))
+    config = FcInitLoadConfigAndFonts ();
 
-  g_object_get (settings,
-                "gtk-fontconfig-timestamp", &timestamp,
-                NULL);
+  g_task_return_pointer (task, config, (GDestroyNotify) FcConfigDestroy);
+}
 
-  /* if timestamp is the same as last_update_timestamp, we already have
-   * updated fontconig on this timestamp (another screen requested it perhaps?),
-   * just return the cached result.*/
+static void
+reload_fontconfig_done (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      data)
+{
+  FcConfig *config;
+
+  config = g_task_propagate_pointer (G_TASK (result), NULL);
+  fontconfig_reloading = FALSE;
 
-  if (timestamp != last_update_timestamp)
+  if (config != NULL && FcConfigSetCurrent (config))
     {
       PangoFontMap *fontmap = pango_cairo_font_map_get_default ();
-      gboolean update_needed = FALSE;
+      GSList *displays, *l;
 
-      /* bug 547680 */
-      if (PANGO_IS_FC_FONT_MAP (fontmap) && !FcConfigUptoDate (NULL))
-        {
-          pango_fc_font_map_config_changed (PANGO_FC_FONT_MAP (fontmap));
-          if (FcInitReinitialize ())
-            update_needed = TRUE;
-        }
+#if FC_VERSION >= 21291
+      /* FcConfigSetCurrent() takes its own reference */
+      FcConfigDestroy (config);
+#endif
+
+      if (PANGO_IS_FC_FONT_MAP (fontmap))
+        pango_fc_font_map_config_changed (PANGO_FC_FONT_MAP (fontmap));
 
-      last_update_timestamp = timestamp;
-      last_update_needed = update_needed;
+      /* Widgets cache sizes and layouts that depend on the fonts */
+      displays = gdk_display_manager_list_displays (gdk_display_manager_get ());
+      for (l = displays; l; l = l->next)
+        gtk_style_context_reset_widgets (l->data);
+      g_slist_free (displays);
+    }
+  else if (config != NULL)
+    {
+      FcConfigDestroy (config);
     }
 
-  return last_update_needed;
-#else
-  return FALSE;
+  /* The timestamp changed again while we were loading */
+  if (fontconfig_requested_timestamp != fontconfig_timestamp)
+    start_fontconfig_reload ();
+}
+
+static void
+start_fontconfig_reload (void)
+{
+  GTask *task;
+
+  fontconfig_timestamp = fontconfig_requested_timestamp;
+  fontconfig_reloading = TRUE;
+
+  task = g_task_new (NULL, NULL, reload_fontconfig_done, NULL);
+  g_task_set_source_tag (task, start_fontconfig_reload);
+  g_task_run_in_thread (task, reload_fontconfig_thread);
+  g_object_unref (task);
+}
+#endif /* GDK_WINDOWING_X11 || GDK_WINDOWING_WAYLAND */
+
+static void
+settings_update_fontconfig (GtkSettings *settings)
+{
+#if defined(GDK_WINDOWING_X11) || defined(GDK_WINDOWING_WAYLAND)
+  guint timestamp;
+
+  if (!PANGO_IS_FC_FONT_MAP (pango_cairo_font_map_get_default ()))
+    return;
+
+  g_object_get (settings,
+                "gtk-fontconfig-timestamp", &timestamp,
+                NULL);
+
+  /* if timestamp is the same as the last one, we already reloaded
+   * fontconfig for it (another display requested it perhaps?) */
+  fontconfig_requested_timestamp = timestamp;
+  if (timestamp == fontconfig_timestamp || fontconfig_reloading)
+    return;
+
+  start_fontconfig_reload ();
 #endif /* GDK_WINDOWING_X11 || GDK_WINDOWING_WAYLAND */
 }
 
@@ -2312,12 +2378,17 @@ settings_update_theme (GtkSettings *settings)
   gchar *theme_variant;
   const gchar *theme_dir;
   gchar *path;
+  gint64 before;
 
   get_theme_name (settings, &theme_name, &theme_variant);
 
+  before = g_get_monotonic_time ();
+
   _gtk_css_provider_load_named (priv->theme_provider,
                                 theme_name, theme_variant);
 
+  gdk_profiler_add_mark (before, g_get_monotonic_time () - before, "theme load", theme_name);
+
   /* reload per-theme settings */
   theme_dir = _gtk_css_provider_get_theme_dir (priv->theme_provider);
   if (theme_dir)
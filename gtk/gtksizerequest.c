@@ -29,6 +29,7 @@
 #include "gtksizegroup-private.h"
 #include "gtksizerequestcacheprivate.h"
 #include "gtkwidgetprivate.h"
+#include "gtkwidgettimesprivate.h"
 #include "gtkcssnodeprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 
@@ -70,6 +71,12 @@ pop_recursion_check (GtkWidget       *widget,
 #define pop_recursion_check(widget, orientation)
 #endif /* G_ENABLE_CONSISTENCY_CHECKS */
 
+#ifdef G_ENABLE_DEBUG
+/* Reported with GTK_DEBUG=size-request */
+static guint cache_hits = 0;
+static guint cache_misses = 0;
+#endif
+
 static gint
 get_number (GtkCssStyle *style,
             guint        property)
@@ -135,6 +142,7 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
   int css_extra_for_size;
   int css_extra_size;
 
+  gtk_widget_ensure_resize_checks (widget);
   gtk_widget_ensure_resize (widget);
 
   if (gtk_widget_get_request_mode (widget) == GTK_SIZE_REQUEST_CONSTANT_SIZE)
@@ -151,11 +159,19 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 
   widget_class = GTK_WIDGET_GET_CLASS (widget);
 
+#ifdef G_ENABLE_DEBUG
+  if (found_in_cache)
+    cache_hits++;
+  else
+    cache_misses++;
+#endif
+
   if (!found_in_cache)
     {
       int adjusted_min, adjusted_natural;
       int reported_min_size = 0;
       int reported_nat_size = 0;
+      GtkWidgetTimesFrame times_frame = { NULL, 0, 0 };
 
       style = gtk_css_node_get_style (gtk_widget_get_css_node (widget));
       get_box_margin (style, &margin);
@@ -179,6 +195,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 
       if (for_size < 0)
         {
+          if (gtk_widget_times_enabled ())
+            gtk_widget_times_begin (&times_frame);
+
           push_recursion_check (widget, orientation);
           widget_class->measure (widget, orientation, -1,
                                  &reported_min_size, &reported_nat_size,
@@ -208,6 +227,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 
           adjusted_for_size -= css_extra_for_size;
 
+          if (gtk_widget_times_enabled ())
+            gtk_widget_times_begin (&times_frame);
+
           push_recursion_check (widget, orientation);
           widget_class->measure (widget,
                                  orientation,
@@ -218,6 +240,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 
         }
 
+      if (times_frame.start != 0)
+        gtk_widget_times_end (&times_frame, widget, GTK_WIDGET_TIMES_MEASURE);
+
       min_size = MAX (0, MAX (reported_min_size, css_min_size)) + css_extra_size;
       nat_size = MAX (0, MAX (reported_nat_size, css_min_size)) + css_extra_size;
 
@@ -365,8 +390,9 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
                 g_string_append_printf (s, ", baseline %d/%d",
                                         min_baseline, nat_baseline);
               }
-	    g_string_append_printf (s, " (hit cache: %s)\n",
-		                    found_in_cache ? "yes" : "no");
+	    g_string_append_printf (s, " (hit cache: %s, %u hits, %u misses)\n",
+		                    found_in_cache ? "yes" : "no",
+                                    cache_hits, cache_misses);
             g_message ("%s", s->str);
             g_string_free (s, TRUE);
 	    });
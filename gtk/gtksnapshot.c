@@ -46,8 +46,17 @@
  * operates on. Use the gtk_snapshot_push() and gtk_snapshot_pop() functions to
  * change the current node.
  *
- * The only way to obtain a #GtkSnapshot object is as an argument to
- * the #GtkWidget::snapshot vfunc.
+ * Widgets obtain a #GtkSnapshot as an argument to the
+ * #GtkWidget::snapshot vfunc.
+ *
+ * To build render nodes outside of a widget, for example for a large
+ * drawing in a worker thread, create a snapshot with gtk_snapshot_new()
+ * and turn it into a node with gtk_snapshot_free_to_node(). Such a
+ * snapshot may be used from any thread, but only by one thread at a
+ * time. The functions that take a #GtkStyleContext must only be used
+ * on the main thread. Render nodes are immutable, so the resulting node
+ * can be passed to the main thread and appended to the snapshot of a
+ * widget with gtk_snapshot_append_node().
  */
 
 static GskRenderNode *
@@ -118,6 +127,10 @@ gtk_snapshot_get_previous_state (const GtkSnapshot *snapshot)
   return &g_array_index (snapshot->state_stack, GtkSnapshotState, snapshot->state_stack->len - 2);
 }
 
+static GArray *cached_state_stack = NULL; /* MT-safe */
+static GPtrArray *cached_nodes = NULL; /* MT-safe */
+G_LOCK_DEFINE_STATIC (cached_arrays);
+
 static void
 gtk_snapshot_state_clear (GtkSnapshotState *state)
 {
@@ -125,30 +138,41 @@ gtk_snapshot_state_clear (GtkSnapshotState *state)
   g_clear_pointer (&state->name, g_free);
 }
 
-void
-gtk_snapshot_init (GtkSnapshot          *snapshot,
-                   GskRenderer          *renderer,
-                   gboolean              record_names,
-                   const cairo_region_t *clip,
-                   const char           *name,
-                   ...)
+static void
+gtk_snapshot_init_va (GtkSnapshot          *snapshot,
+                      GskRenderer          *renderer,
+                      gboolean              record_names,
+                      const cairo_region_t *clip,
+                      const char           *name,
+                      va_list               args)
 {
   char *str;
 
   snapshot->record_names = record_names;
   snapshot->renderer = renderer;
-  snapshot->state_stack = g_array_new (FALSE, TRUE, sizeof (GtkSnapshotState));
-  g_array_set_clear_func (snapshot->state_stack, (GDestroyNotify)gtk_snapshot_state_clear);
-  snapshot->nodes = g_ptr_array_new_with_free_func ((GDestroyNotify)gsk_render_node_unref);
+  snapshot->state_stack = NULL;
 
-  if (name && record_names)
+  /* Reuse the arrays of the last finished snapshot, so we don't
+   * have to grow them again every frame */
+  G_LOCK (cached_arrays);
+  if (cached_state_stack)
     {
-      va_list args;
+      snapshot->state_stack = cached_state_stack;
+      snapshot->nodes = cached_nodes;
+      cached_state_stack = NULL;
+      cached_nodes = NULL;
+    }
+  G_UNLOCK (cached_arrays);
 
-      va_start (args, name);
-      str = g_strdup_vprintf (name, args);
-      va_end (args);
+  if (snapshot->state_stack == NULL)
+    {
+      snapshot->state_stack = g_array_sized_new (FALSE, TRUE, sizeof (GtkSnapshotState), 16);
+      g_array_set_clear_func (snapshot->state_stack, (GDestroyNotify)gtk_snapshot_state_clear);
+      snapshot->nodes = g_ptr_array_new_full (64, (GDestroyNotify)gsk_render_node_unref);
     }
+
+  if (name && record_names)
+    str = g_strdup_vprintf (name, args);
   else
     str = NULL;
 
@@ -159,6 +183,88 @@ gtk_snapshot_init (GtkSnapshot          *snapshot,
                            gtk_snapshot_collect_default);
 }
 
+void
+gtk_snapshot_init (GtkSnapshot          *snapshot,
+                   GskRenderer          *renderer,
+                   gboolean              record_names,
+                   const cairo_region_t *clip,
+                   const char           *name,
+                   ...)
+{
+  va_list args;
+
+  va_start (args, name);
+  gtk_snapshot_init_va (snapshot, renderer, record_names, clip, name, args);
+  va_end (args);
+}
+
+/**
+ * gtk_snapshot_new:
+ * @record_names: whether to keep the names of the nodes
+ * @name: (transfer none): a printf() style format string for the name of
+ *     the resulting node, or %NULL
+ * @...: arguments for @name
+ *
+ * Creates a new #GtkSnapshot that isn't tied to a widget.
+ *
+ * Unlike the snapshots that widgets are given, this can be used from
+ * any thread, as long as only one thread uses it at a time. Nodes
+ * that are appended to it aren't clipped and it has no renderer, so
+ * cairo nodes are drawn to image surfaces.
+ *
+ * Use gtk_snapshot_free_to_node() to get the result and free the
+ * snapshot.
+ *
+ * Returns: (transfer full): a new #GtkSnapshot
+ *
+ * Since: 3.94
+ */
+GtkSnapshot *
+gtk_snapshot_new (gboolean    record_names,
+                  const char *name,
+                  ...)
+{
+  GtkSnapshot *snapshot;
+  va_list args;
+
+  snapshot = g_slice_new (GtkSnapshot);
+
+  va_start (args, name);
+  gtk_snapshot_init_va (snapshot, NULL, record_names, NULL, name, args);
+  va_end (args);
+
+  return snapshot;
+}
+
+/**
+ * gtk_snapshot_free_to_node:
+ * @snapshot: (transfer full): a #GtkSnapshot created with gtk_snapshot_new()
+ *
+ * Returns the node that was constructed by @snapshot and frees
+ * @snapshot.
+ *
+ * The node is immutable, so it can be handed to another thread, for
+ * example to be appended to the snapshot of a widget on the main
+ * thread with gtk_snapshot_append_node().
+ *
+ * Returns: (transfer full) (nullable): the constructed #GskRenderNode,
+ *     or %NULL if nothing was appended
+ *
+ * Since: 3.94
+ */
+GskRenderNode *
+gtk_snapshot_free_to_node (GtkSnapshot *snapshot)
+{
+  GskRenderNode *result;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  result = gtk_snapshot_finish (snapshot);
+  g_slice_free (GtkSnapshot, snapshot);
+
+  return result;
+}
+
 /**
  * gtk_snapshot_push:
  * @snapshot: a #GtkSnapshot
@@ -1090,8 +1196,26 @@ gtk_snapshot_finish (GtkSnapshot *snapshot)
   
   result = gtk_snapshot_pop_internal (snapshot);
 
-  g_array_free (snapshot->state_stack, TRUE);
-  g_ptr_array_free (snapshot->nodes, TRUE);
+  g_array_set_size (snapshot->state_stack, 0);
+  g_ptr_array_set_size (snapshot->nodes, 0);
+
+  G_LOCK (cached_arrays);
+  if (cached_state_stack == NULL)
+    {
+      cached_state_stack = snapshot->state_stack;
+      cached_nodes = snapshot->nodes;
+      snapshot->state_stack = NULL;
+    }
+  G_UNLOCK (cached_arrays);
+
+  if (snapshot->state_stack)
+    {
+      g_array_free (snapshot->state_stack, TRUE);
+      g_ptr_array_free (snapshot->nodes, TRUE);
+    }
+  snapshot->state_stack = NULL;
+  snapshot->nodes = NULL;
+
   return result;
 }
 
@@ -1117,6 +1241,13 @@ gtk_snapshot_pop (GtkSnapshot *snapshot)
     }
 }
 
+/* Like gtk_snapshot_pop(), but returns the node instead of appending it */
+GskRenderNode *
+gtk_snapshot_pop_collect (GtkSnapshot *snapshot)
+{
+  return gtk_snapshot_pop_internal (snapshot);
+}
+
 /**
  * gtk_snapshot_get_renderer:
  * @snapshot: a #GtkSnapshot
@@ -1415,6 +1546,27 @@ gtk_snapshot_clips_rect (GtkSnapshot                 *snapshot,
   return cairo_region_contains_rectangle (current_state->clip_region, &offset_rect) == CAIRO_REGION_OVERLAP_OUT;
 }
 
+/* Tests whether the rectangle is entirely inside the clip region,
+ * ie nothing in it gets culled.
+ */
+gboolean
+gtk_snapshot_contains_rect (GtkSnapshot                 *snapshot,
+                            const cairo_rectangle_int_t *rect)
+{
+  const GtkSnapshotState *current_state = gtk_snapshot_get_current_state (snapshot);
+  cairo_rectangle_int_t offset_rect;
+
+  if (current_state->clip_region == NULL)
+    return TRUE;
+
+  offset_rect.x = rect->x + current_state->translate_x;
+  offset_rect.y = rect->y + current_state->translate_y;
+  offset_rect.width = rect->width;
+  offset_rect.height = rect->height;
+
+  return cairo_region_contains_rectangle (current_state->clip_region, &offset_rect) == CAIRO_REGION_OVERLAP_IN;
+}
+
 /**
  * gtk_snapshot_render_background:
  * @snapshot: a #GtkSnapshot
@@ -1558,6 +1710,34 @@ gtk_snapshot_render_layout (GtkSnapshot     *snapshot,
   gtk_snapshot_offset (snapshot, -x, -y);
 }
 
+/**
+ * gtk_snapshot_append_layout:
+ * @snapshot: a #GtkSnapshot
+ * @layout: the #PangoLayout to render
+ * @color: the foreground color to render the layout in
+ *
+ * Creates render nodes for rendering @layout in the given foreground
+ * @color and appends them to the current node of @snapshot without
+ * changing the current node.
+ *
+ * Unlike gtk_snapshot_render_layout(), this doesn't need a
+ * #GtkStyleContext, so it can be used with snapshots created by
+ * gtk_snapshot_new() in other threads.
+ *
+ * Since: 3.94
+ */
+void
+gtk_snapshot_append_layout (GtkSnapshot   *snapshot,
+                            PangoLayout   *layout,
+                            const GdkRGBA *color)
+{
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (PANGO_IS_LAYOUT (layout));
+  g_return_if_fail (color != NULL);
+
+  gsk_pango_show_layout (snapshot, color, layout);
+}
+
 /*
  * gtk_snapshot_append_linear_gradient:
  * @snapshot: a #GtkSnapshot
@@ -1717,3 +1897,173 @@ gtk_snapshot_append_repeating_linear_gradient (GtkSnapshot            *snapshot,
   gtk_snapshot_append_node (snapshot, node);
   gsk_render_node_unref (node);
 }
+
+/**
+ * gtk_snapshot_append_radial_gradient:
+ * @snapshot: a #GtkSnapshot
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius of the gradient
+ * @vradius: the vertical radius of the gradient
+ * @start: the position of the first color stop, as a multiple of the radii
+ * @end: the position of the last color stop, as a multiple of the radii
+ * @stops: (array length=n_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_stops: the number of elements in @color_stops
+ * @name: a printf format string for the name of the new node
+ * @...: arguments to insert into the format string
+ *
+ * Appends a radial gradient node with the given stops to @snapshot.
+ *
+ * Since: 3.94
+ */
+void
+gtk_snapshot_append_radial_gradient (GtkSnapshot            *snapshot,
+                                     const graphene_rect_t  *bounds,
+                                     const graphene_point_t *center,
+                                     float                   hradius,
+                                     float                   vradius,
+                                     float                   start,
+                                     float                   end,
+                                     const GskColorStop     *stops,
+                                     gsize                   n_stops,
+                                     const char             *name,
+                                     ...)
+{
+  const GtkSnapshotState *current_state = gtk_snapshot_get_current_state (snapshot);
+  GskRenderNode *node;
+  graphene_rect_t real_bounds;
+  graphene_point_t real_center;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (center != NULL);
+  g_return_if_fail (stops != NULL);
+  g_return_if_fail (n_stops > 1);
+
+  graphene_rect_offset_r (bounds, current_state->translate_x, current_state->translate_y, &real_bounds);
+  real_center.x = center->x + current_state->translate_x;
+  real_center.y = center->y + current_state->translate_y;
+
+  /* Like linear gradients, radial gradients can be trivially clipped */
+  if (current_state->clip_region)
+    {
+      cairo_rectangle_int_t clip_extents;
+
+      cairo_region_get_extents (current_state->clip_region, &clip_extents);
+      graphene_rect_intersection (&GRAPHENE_RECT_INIT (
+                                    clip_extents.x,
+                                    clip_extents.y,
+                                    clip_extents.width,
+                                    clip_extents.height
+                                  ),
+                                  &real_bounds, &real_bounds);
+    }
+
+  node = gsk_radial_gradient_node_new (&real_bounds,
+                                       &real_center,
+                                       hradius, vradius,
+                                       start, end,
+                                       stops,
+                                       n_stops);
+
+  if (name && snapshot->record_names)
+    {
+      va_list args;
+      char *str;
+
+      va_start (args, name);
+      str = g_strdup_vprintf (name, args);
+      va_end (args);
+
+      gsk_render_node_set_name (node, str);
+
+      g_free (str);
+    }
+
+  gtk_snapshot_append_node (snapshot, node);
+  gsk_render_node_unref (node);
+}
+
+/**
+ * gtk_snapshot_append_repeating_radial_gradient:
+ * @snapshot: a #GtkSnapshot
+ * @bounds: the rectangle to render the radial gradient into
+ * @center: the center of the gradient
+ * @hradius: the horizontal radius of the gradient
+ * @vradius: the vertical radius of the gradient
+ * @start: the position of the first color stop, as a multiple of the radii
+ * @end: the position of the last color stop, as a multiple of the radii
+ * @stops: (array length=n_stops): a pointer to an array of #GskColorStop defining the gradient
+ * @n_stops: the number of elements in @color_stops
+ * @name: a printf format string for the name of the new node
+ * @...: arguments to insert into the format string
+ *
+ * Appends a repeating radial gradient node with the given stops to @snapshot.
+ *
+ * Since: 3.94
+ */
+void
+gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
+                                               const graphene_rect_t  *bounds,
+                                               const graphene_point_t *center,
+                                               float                   hradius,
+                                               float                   vradius,
+                                               float                   start,
+                                               float                   end,
+                                               const GskColorStop     *stops,
+                                               gsize                   n_stops,
+                                               const char             *name,
+                                               ...)
+{
+  const GtkSnapshotState *current_state = gtk_snapshot_get_current_state (snapshot);
+  GskRenderNode *node;
+  graphene_rect_t real_bounds;
+  graphene_point_t real_center;
+
+  g_return_if_fail (snapshot != NULL);
+  g_return_if_fail (center != NULL);
+  g_return_if_fail (stops != NULL);
+  g_return_if_fail (n_stops > 1);
+
+  graphene_rect_offset_r (bounds, current_state->translate_x, current_state->translate_y, &real_bounds);
+  real_center.x = center->x + current_state->translate_x;
+  real_center.y = center->y + current_state->translate_y;
+
+  /* Like linear gradients, radial gradients can be trivially clipped */
+  if (current_state->clip_region)
+    {
+      cairo_rectangle_int_t clip_extents;
+
+      cairo_region_get_extents (current_state->clip_region, &clip_extents);
+      graphene_rect_intersection (&GRAPHENE_RECT_INIT (
+                                    clip_extents.x,
+                                    clip_extents.y,
+                                    clip_extents.width,
+                                    clip_extents.height
+                                  ),
+                                  &real_bounds, &real_bounds);
+    }
+
+  node = gsk_repeating_radial_gradient_node_new (&real_bounds,
+                                                 &real_center,
+                                                 hradius, vradius,
+                                                 start, end,
+                                                 stops,
+                                                 n_stops);
+
+  if (name && snapshot->record_names)
+    {
+      va_list args;
+      char *str;
+
+      va_start (args, name);
+      str = g_strdup_vprintf (name, args);
+      va_end (args);
+
+      gsk_render_node_set_name (node, str);
+
+      g_free (str);
+    }
+
+  gtk_snapshot_append_node (snapshot, node);
+  gsk_render_node_unref (node);
+}
@@ -36,6 +36,13 @@
 
 G_BEGIN_DECLS
 
+GDK_AVAILABLE_IN_3_94
+GtkSnapshot *   gtk_snapshot_new                        (gboolean                record_names,
+                                                         const char             *name,
+                                                         ...) G_GNUC_PRINTF (2, 3);
+GDK_AVAILABLE_IN_3_94
+GskRenderNode * gtk_snapshot_free_to_node               (GtkSnapshot            *snapshot);
+
 GDK_AVAILABLE_IN_3_90
 void            gtk_snapshot_push                       (GtkSnapshot            *snapshot,
                                                          gboolean                keep_coordinates,
@@ -127,6 +134,11 @@ void            gtk_snapshot_append_color               (GtkSnapshot
                                                          const char             *name,
                                                          ...) G_GNUC_PRINTF (4, 5);
 
+GDK_AVAILABLE_IN_3_94
+void            gtk_snapshot_append_layout              (GtkSnapshot            *snapshot,
+                                                         PangoLayout            *layout,
+                                                         const GdkRGBA          *color);
+
 GDK_AVAILABLE_IN_3_90
 gboolean        gtk_snapshot_clips_rect                 (GtkSnapshot            *snapshot,
                                                          const cairo_rectangle_int_t  *bounds);
@@ -184,6 +196,30 @@ void            gtk_snapshot_append_repeating_linear_gradient (GtkSnapshot
                                                                gsize                   n_stops,
                                                                 const char             *name,
                                                                ...) G_GNUC_PRINTF (7, 8);
+GDK_AVAILABLE_IN_3_94
+void            gtk_snapshot_append_radial_gradient           (GtkSnapshot            *snapshot,
+                                                               const graphene_rect_t  *bounds,
+                                                               const graphene_point_t *center,
+                                                               float                   hradius,
+                                                               float                   vradius,
+                                                               float                   start,
+                                                               float                   end,
+                                                               const GskColorStop     *stops,
+                                                               gsize                   n_stops,
+                                                               const char             *name,
+                                                               ...) G_GNUC_PRINTF (11, 12);
+GDK_AVAILABLE_IN_3_94
+void            gtk_snapshot_append_repeating_radial_gradient (GtkSnapshot            *snapshot,
+                                                               const graphene_rect_t  *bounds,
+                                                               const graphene_point_t *center,
+                                                               float                   hradius,
+                                                               float                   vradius,
+                                                               float                   start,
+                                                               float                   end,
+                                                               const GskColorStop     *stops,
+                                                               gsize                   n_stops,
+                                                               const char             *name,
+                                                               ...) G_GNUC_PRINTF (11, 12);
 
 
 G_END_DECLS
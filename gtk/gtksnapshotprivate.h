@@ -97,6 +97,10 @@ GskRenderNode * gtk_snapshot_finish             (GtkSnapshot             *state)
 
 GskRenderer *   gtk_snapshot_get_renderer       (const GtkSnapshot       *snapshot);
 
+GskRenderNode * gtk_snapshot_pop_collect        (GtkSnapshot             *snapshot);
+gboolean        gtk_snapshot_contains_rect      (GtkSnapshot             *snapshot,
+                                                 const cairo_rectangle_int_t *rect);
+
 G_END_DECLS
 
 #endif /* __GTK_SNAPSHOT_PRIVATE_H__ */
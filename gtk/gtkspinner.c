@@ -58,7 +58,8 @@
  * # CSS nodes
  *
  * GtkSpinner has a single CSS node with the name spinner. When the animation is
- * active, the :checked pseudoclass is added to this node.
+ * active, the :checked pseudoclass is added to this node. Spinners that are not
+ * mapped don't animate, so they don't have the :checked pseudoclass either.
  */
 
 
@@ -118,6 +119,37 @@ gtk_spinner_snapshot (GtkWidget   *widget,
                                GTK_CSS_IMAGE_BUILTIN_SPINNER);
 }
 
+/* The animation is a CSS animation on :checked, and it keeps the
+ * toplevel restyling every frame. Only run it while we can be seen.
+ */
+static void
+gtk_spinner_update_state (GtkSpinner *spinner)
+{
+  GtkSpinnerPrivate *priv = gtk_spinner_get_instance_private (spinner);
+  GtkWidget *widget = GTK_WIDGET (spinner);
+
+  if (priv->active && gtk_widget_get_mapped (widget))
+    gtk_widget_set_state_flags (widget, GTK_STATE_FLAG_CHECKED, FALSE);
+  else
+    gtk_widget_unset_state_flags (widget, GTK_STATE_FLAG_CHECKED);
+}
+
+static void
+gtk_spinner_map (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (gtk_spinner_parent_class)->map (widget);
+
+  gtk_spinner_update_state (GTK_SPINNER (widget));
+}
+
+static void
+gtk_spinner_unmap (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (gtk_spinner_parent_class)->unmap (widget);
+
+  gtk_spinner_update_state (GTK_SPINNER (widget));
+}
+
 static void
 gtk_spinner_set_active (GtkSpinner *spinner,
                         gboolean    active)
@@ -132,12 +164,7 @@ gtk_spinner_set_active (GtkSpinner *spinner,
 
       g_object_notify (G_OBJECT (spinner), "active");
 
-      if (active)
-        gtk_widget_set_state_flags (GTK_WIDGET (spinner),
-                                    GTK_STATE_FLAG_CHECKED, FALSE);
-      else
-        gtk_widget_unset_state_flags (GTK_WIDGET (spinner),
-                                      GTK_STATE_FLAG_CHECKED);
+      gtk_spinner_update_state (spinner);
     }
 }
 
@@ -188,6 +215,8 @@ gtk_spinner_class_init (GtkSpinnerClass *klass)
   widget_class = GTK_WIDGET_CLASS(klass);
   widget_class->snapshot = gtk_spinner_snapshot;
   widget_class->measure = gtk_spinner_measure;
+  widget_class->map = gtk_spinner_map;
+  widget_class->unmap = gtk_spinner_unmap;
 
   /* GtkSpinner:active:
    *
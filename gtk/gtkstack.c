@@ -30,6 +30,7 @@
 #include "gtksettingsprivate.h"
 #include "gtksnapshotprivate.h"
 #include "gtkwidgetprivate.h"
+#include "gtkwindowprivate.h"
 #include "a11y/gtkstackaccessible.h"
 #include "a11y/gtkstackaccessibleprivate.h"
 #include <math.h>
@@ -795,6 +796,72 @@ gtk_stack_progress_updated (GtkStack *stack)
     }
 }
 
+/* Pages larger than this are left as nodes, the renderers may not be
+ * able to create textures that large */
+#define MAX_CACHED_PAGE_SIZE 4096
+
+/* Renders the node captured from the last visible child into a texture,
+ * so that the transition only needs to draw that texture in every frame,
+ * instead of the whole node tree of the page.
+ *
+ * This can't happen while the node is captured, as that is in the middle
+ * of drawing a frame, so it happens in the next tick.
+ */
+static void
+gtk_stack_cache_last_visible_node (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+  GtkWidget *toplevel;
+  GskRenderer *renderer;
+  GskRenderNode *node;
+  GdkTexture *texture;
+  graphene_matrix_t scale_matrix;
+  graphene_rect_t bounds;
+  float x0, y0, x1, y1;
+  int scale;
+
+  if (priv->last_visible_node == NULL ||
+      gsk_render_node_get_node_type (priv->last_visible_node) == GSK_TEXTURE_NODE)
+    return;
+
+  toplevel = gtk_widget_get_toplevel (GTK_WIDGET (stack));
+  if (!GTK_IS_WINDOW (toplevel))
+    return;
+
+  renderer = gtk_window_get_renderer (GTK_WINDOW (toplevel));
+  if (renderer == NULL)
+    return;
+
+  scale = gtk_widget_get_scale_factor (GTK_WIDGET (stack));
+
+  gsk_render_node_get_bounds (priv->last_visible_node, &bounds);
+  x0 = floorf (bounds.origin.x);
+  y0 = floorf (bounds.origin.y);
+  x1 = ceilf (bounds.origin.x + bounds.size.width);
+  y1 = ceilf (bounds.origin.y + bounds.size.height);
+
+  if (x1 <= x0 || y1 <= y0 ||
+      (x1 - x0) * scale > MAX_CACHED_PAGE_SIZE ||
+      (y1 - y0) * scale > MAX_CACHED_PAGE_SIZE)
+    return;
+
+  graphene_matrix_init_scale (&scale_matrix, scale, scale, 1);
+  node = gsk_transform_node_new (priv->last_visible_node, &scale_matrix);
+  texture = gsk_renderer_render_texture (renderer, node,
+                                         &GRAPHENE_RECT_INIT (x0 * scale, y0 * scale,
+                                                              (x1 - x0) * scale, (y1 - y0) * scale));
+  gsk_render_node_unref (node);
+
+  if (texture == NULL)
+    return;
+
+  node = gsk_texture_node_new (texture, &GRAPHENE_RECT_INIT (x0, y0, x1 - x0, y1 - y0));
+  g_object_unref (texture);
+
+  gsk_render_node_unref (priv->last_visible_node);
+  priv->last_visible_node = node;
+}
+
 static gboolean
 gtk_stack_transition_cb (GtkWidget     *widget,
                          GdkFrameClock *frame_clock,
@@ -809,6 +876,8 @@ gtk_stack_transition_cb (GtkWidget     *widget,
   else
     priv->first_frame_skipped = TRUE;
 
+  gtk_stack_cache_last_visible_node (stack);
+
   /* Finish animation early if not mapped anymore */
   if (!gtk_widget_get_mapped (widget))
     gtk_progress_tracker_finish (&priv->tracker);
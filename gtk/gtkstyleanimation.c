@@ -48,6 +48,12 @@ gtk_style_animation_real_is_static (GtkStyleAnimation *animation)
   return FALSE;
 }
 
+static gboolean
+gtk_style_animation_real_is_compositor (GtkStyleAnimation *animation)
+{
+  return FALSE;
+}
+
 static void
 _gtk_style_animation_class_init (GtkStyleAnimationClass *klass)
 {
@@ -55,6 +61,7 @@ _gtk_style_animation_class_init (GtkStyleAnimationClass *klass)
   klass->apply_values = gtk_style_animation_real_apply_values;
   klass->is_finished = gtk_style_animation_real_is_finished;
   klass->is_static = gtk_style_animation_real_is_static;
+  klass->is_compositor = gtk_style_animation_real_is_compositor;
 }
 
 static void
@@ -123,3 +130,25 @@ _gtk_style_animation_is_static (GtkStyleAnimation *animation)
 
   return klass->is_static (animation);
 }
+
+/**
+ * _gtk_style_animation_is_compositor:
+ * @animation: The animation to query
+ *
+ * Checks if @animation only changes compositor properties, see
+ * _gtk_css_style_property_is_compositor(). The values of such
+ * animations do not affect any other element.
+ *
+ * Returns: %TRUE if @animation only changes compositor properties
+ **/
+gboolean
+_gtk_style_animation_is_compositor (GtkStyleAnimation *animation)
+{
+  GtkStyleAnimationClass *klass;
+
+  g_return_val_if_fail (GTK_IS_STYLE_ANIMATION (animation), FALSE);
+
+  klass = GTK_STYLE_ANIMATION_GET_CLASS (animation);
+
+  return klass->is_compositor (animation);
+}
@@ -45,6 +45,7 @@ struct _GtkStyleAnimationClass
 
   gboolean      (* is_finished)                         (GtkStyleAnimation      *animation);
   gboolean      (* is_static)                           (GtkStyleAnimation      *animation);
+  gboolean      (* is_compositor)                       (GtkStyleAnimation      *animation);
   void          (* apply_values)                        (GtkStyleAnimation      *animation,
                                                          GtkCssAnimatedStyle    *style);
   GtkStyleAnimation *  (* advance)                      (GtkStyleAnimation      *animation,
@@ -59,6 +60,7 @@ void            _gtk_style_animation_apply_values       (GtkStyleAnimation
                                                          GtkCssAnimatedStyle    *style);
 gboolean        _gtk_style_animation_is_finished        (GtkStyleAnimation      *animation);
 gboolean        _gtk_style_animation_is_static          (GtkStyleAnimation      *animation);
+gboolean        _gtk_style_animation_is_compositor      (GtkStyleAnimation      *animation);
 
 
 G_END_DECLS
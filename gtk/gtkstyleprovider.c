@@ -50,8 +50,9 @@ gtk_style_provider_default_init (GtkStyleProviderInterface *iface)
                                    G_SIGNAL_RUN_LAST,
                                    G_STRUCT_OFFSET (GtkStyleProviderInterface, changed),
                                    NULL, NULL,
-                                   g_cclosure_marshal_VOID__VOID,
-                                   G_TYPE_NONE, 0);
+                                   g_cclosure_marshal_VOID__POINTER,
+                                   G_TYPE_NONE, 1,
+                                   G_TYPE_POINTER);
 
 }
 
@@ -117,10 +118,65 @@ gtk_style_provider_lookup (GtkStyleProvider    *provider,
 
 void
 gtk_style_provider_changed (GtkStyleProvider *provider)
+{
+  gtk_style_provider_changed_partial (provider, NULL);
+}
+
+/*
+ * gtk_style_provider_changed_partial:
+ * @provider: a #GtkStyleProvider
+ * @change: (nullable): the elements affected by the change
+ *
+ * Like gtk_style_provider_changed(), but only elements described
+ * by @change need to be restyled.
+ */
+void
+gtk_style_provider_changed_partial (GtkStyleProvider             *provider,
+                                    const GtkStyleProviderChange *change)
 {
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
 
-  g_signal_emit (provider, signals[CHANGED], 0);
+  g_signal_emit (provider, signals[CHANGED], 0, change);
+}
+
+GtkStyleProviderChange *
+gtk_style_provider_change_new (void)
+{
+  GtkStyleProviderChange *change;
+  guint i;
+
+  change = g_slice_new (GtkStyleProviderChange);
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    change->keys[i] = g_hash_table_new (NULL, NULL);
+
+  return change;
+}
+
+void
+gtk_style_provider_change_free (GtkStyleProviderChange *change)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_SELECTOR_N_BUCKETS; i++)
+    g_hash_table_destroy (change->keys[i]);
+
+  g_slice_free (GtkStyleProviderChange, change);
+}
+
+void
+gtk_style_provider_change_add (GtkStyleProviderChange *change,
+                               GtkCssSelectorBucket    bucket,
+                               gpointer                key)
+{
+  g_hash_table_add (change->keys[bucket], key);
+}
+
+gboolean
+gtk_style_provider_change_contains (const GtkStyleProviderChange *change,
+                                    GtkCssSelectorBucket          bucket,
+                                    gpointer                      key)
+{
+  return g_hash_table_contains (change->keys[bucket], key);
 }
 
 GtkSettings *
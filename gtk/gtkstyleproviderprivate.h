@@ -22,6 +22,7 @@
 #include "gtk/gtkcsskeyframesprivate.h"
 #include "gtk/gtkcsslookupprivate.h"
 #include "gtk/gtkcssmatcherprivate.h"
+#include "gtk/gtkcssselectorprivate.h"
 #include "gtk/gtkcssvalueprivate.h"
 #include <gtk/gtktypes.h>
 
@@ -30,6 +31,17 @@ G_BEGIN_DECLS
 #define GTK_STYLE_PROVIDER_GET_INTERFACE(o)  (G_TYPE_INSTANCE_GET_INTERFACE ((o), GTK_TYPE_STYLE_PROVIDER, GtkStyleProviderInterface))
 
 typedef struct _GtkStyleProviderInterface GtkStyleProviderInterface;
+typedef struct _GtkStyleProviderChange GtkStyleProviderChange;
+
+/* Describes which elements are affected when a provider changes.
+ * Only elements that have one of the IDs, classes or names can
+ * have a different style than before. A %NULL change affects
+ * all elements.
+ */
+struct _GtkStyleProviderChange
+{
+  GHashTable *keys[GTK_CSS_SELECTOR_N_BUCKETS];
+};
 
 struct _GtkStyleProviderInterface
 {
@@ -49,7 +61,8 @@ struct _GtkStyleProviderInterface
                                                  GtkCssSection           *section,
                                                  const GError            *error);
   /* signal */
-  void                  (* changed)             (GtkStyleProvider *provider);
+  void                  (* changed)             (GtkStyleProvider *provider,
+                                                 const GtkStyleProviderChange *change);
 };
 
 GtkSettings *           gtk_style_provider_get_settings          (GtkStyleProvider *provider);
@@ -64,6 +77,17 @@ void                    gtk_style_provider_lookup                (GtkStyleProvid
                                                                   GtkCssChange            *out_change);
 
 void                    gtk_style_provider_changed               (GtkStyleProvider *provider);
+void                    gtk_style_provider_changed_partial       (GtkStyleProvider *provider,
+                                                                  const GtkStyleProviderChange *change);
+
+GtkStyleProviderChange *gtk_style_provider_change_new            (void);
+void                    gtk_style_provider_change_free           (GtkStyleProviderChange *change);
+void                    gtk_style_provider_change_add            (GtkStyleProviderChange *change,
+                                                                  GtkCssSelectorBucket    bucket,
+                                                                  gpointer                key);
+gboolean                gtk_style_provider_change_contains       (const GtkStyleProviderChange *change,
+                                                                  GtkCssSelectorBucket    bucket,
+                                                                  gpointer                key);
 
 void                    gtk_style_provider_emit_error            (GtkStyleProvider *provider,
                                                                   GtkCssSection           *section,
@@ -1118,6 +1118,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   int char_count_delta;                /* change to number of chars */
   GtkTextBTree *tree;
   gint start_byte_index;
+  gint end_byte_index;
   GtkTextLine *start_line;
 
   g_return_if_fail (text != NULL);
@@ -1155,6 +1156,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   sol = 0;
   line_count_delta = 0;
   char_count_delta = 0;
+  end_byte_index = start_byte_index;
   while (eol < len)
     {
       sol = eol;
@@ -1176,7 +1178,12 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       
       chunk_len = eol - sol;
 
-      g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+      /* The buffer validates the text, so this is only worth
+       * another pass over big insertions when debugging. */
+#ifdef G_ENABLE_DEBUG
+      if (GTK_DEBUG_CHECK (TEXT))
+        g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+#endif
       seg = _gtk_char_segment_new (&text[sol], chunk_len);
 
       char_count_delta += seg->char_count;
@@ -1196,6 +1203,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
         {
           /* chunk didn't end with a paragraph separator */
           g_assert (eol == len);
+          end_byte_index += chunk_len;
           break;
         }
 
@@ -1213,6 +1221,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       line = newline;
       cur_seg = NULL;
       line_count_delta++;
+      end_byte_index = 0;
     }
 
   /*
@@ -1239,12 +1248,13 @@ _gtk_text_btree_insert (GtkTextIter *iter,
                                       &start,
                                       start_line,
                                       start_byte_index);
-    end = start;
 
-    /* We could almost certainly be more efficient here
-       by saving the information from the insertion loop
-       above. FIXME */
-    gtk_text_iter_forward_chars (&end, char_count_delta);
+    /* The loop above knows where the text ended, so don't walk
+     * all of it again to find the end. */
+    _gtk_text_btree_get_iter_at_line (tree,
+                                      &end,
+                                      line,
+                                      end_byte_index);
 
     DV (g_print ("invalidating due to inserting some text (%s)\n", G_STRLOC));
     _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
@@ -4897,17 +4907,27 @@ gtk_text_btree_node_adjust_toggle_count (GtkTextBTreeNode  *node,
                                          GtkTextTagInfo  *info,
                                          gint adjust)
 {
-  Summary *summary;
+  Summary *summary, *prev;
 
+  prev = NULL;
   summary = node->summary;
   while (summary != NULL)
     {
       if (summary->info == info)
         {
           summary->toggle_count += adjust;
+
+          /* Recounting a line adjusts the same tags repeatedly */
+          if (prev != NULL)
+            {
+              prev->next = summary->next;
+              summary->next = node->summary;
+              node->summary = summary;
+            }
           break;
         }
 
+      prev = summary;
       summary = summary->next;
     }
 
@@ -6136,6 +6156,7 @@ recompute_level_nonzero_counts (GtkTextBTreeNode *node)
 {
   Summary *summary;
   GtkTextBTreeNode *child;
+  gboolean reparented = FALSE;
 
   g_assert (node->level > 0);
 
@@ -6149,7 +6170,7 @@ recompute_level_nonzero_counts (GtkTextBTreeNode *node)
       if (child->parent != node)
         {
           child->parent = node;
-          gtk_text_btree_node_invalidate_upward (node, NULL);
+          reparented = TRUE;
         }
 
       summary = child->summary;
@@ -6164,6 +6185,9 @@ recompute_level_nonzero_counts (GtkTextBTreeNode *node)
 
       child = child->next;
     }
+
+  if (reparented)
+    gtk_text_btree_node_invalidate_upward (node, NULL);
 }
 
 /*
@@ -6328,6 +6352,16 @@ _gtk_change_node_toggle_count (GtkTextBTreeNode *node,
           if (summary->toggle_count > 0 &&
               summary->toggle_count < info->toggle_count)
             {
+              /* Keep the entry at the front of the list; tagging tends
+               * to hit the same few tags over and over (think syntax
+               * highlighting), so this keeps the lookups short.
+               */
+              if (prevPtr != NULL)
+                {
+                  prevPtr->next = summary->next;
+                  summary->next = node->summary;
+                  node->summary = summary;
+                }
               continue;
             }
           if (summary->toggle_count != 0)
@@ -1794,6 +1794,92 @@ gtk_text_buffer_insert_with_tags_by_name  (GtkTextBuffer *buffer,
   va_end (args);
 }
 
+/**
+ * gtk_text_buffer_insert_chunks:
+ * @buffer: a #GtkTextBuffer
+ * @iter: an iterator in @buffer
+ * @texts: (array length=n_chunks): the texts to insert, in UTF-8 format
+ * @lengths: (array length=n_chunks) (nullable): the lengths of @texts in
+ *     bytes, or %NULL if all of them are nul-terminated
+ * @tags: (array length=n_chunks) (nullable): tags to apply to each of
+ *     the chunks, entries may be %NULL for no tag
+ * @n_chunks: number of chunks to insert
+ *
+ * Inserts many chunks of text at once, possibly each with a tag of its
+ * own. This is a lot faster than inserting the chunks one by one, as
+ * the text is inserted with a single emission of the
+ * #GtkTextBuffer::insert-text signal and the tags are applied
+ * afterwards, with one #GtkTextBuffer::apply-tag emission for every run
+ * of chunks with the same tag.
+ *
+ * This is meant for appending lots of output, e.g. in a log viewer.
+ * @iter will point to the end of the inserted text on return.
+ *
+ * Since: 3.94
+ */
+void
+gtk_text_buffer_insert_chunks (GtkTextBuffer  *buffer,
+                               GtkTextIter    *iter,
+                               const gchar   **texts,
+                               const gint     *lengths,
+                               GtkTextTag    **tags,
+                               guint           n_chunks)
+{
+  GtkTextIter start, end;
+  GString *str;
+  gint *offsets;
+  gint start_offset, offset;
+  guint i, run;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (iter != NULL);
+  g_return_if_fail (texts != NULL || n_chunks == 0);
+  g_return_if_fail (gtk_text_iter_get_buffer (iter) == buffer);
+
+  if (n_chunks == 0)
+    return;
+
+  start_offset = gtk_text_iter_get_offset (iter);
+
+  str = g_string_new (NULL);
+  offsets = g_new (gint, n_chunks + 1);
+  offset = 0;
+
+  for (i = 0; i < n_chunks; i++)
+    {
+      gint len = lengths ? lengths[i] : -1;
+
+      if (len < 0)
+        len = strlen (texts[i]);
+
+      offsets[i] = offset;
+      offset += g_utf8_strlen (texts[i], len);
+      g_string_append_len (str, texts[i], len);
+    }
+  offsets[n_chunks] = offset;
+
+  gtk_text_buffer_insert (buffer, iter, str->str, str->len);
+  g_string_free (str, TRUE);
+
+  if (tags != NULL)
+    {
+      for (i = 0; i < n_chunks; i = run)
+        {
+          for (run = i + 1; run < n_chunks && tags[run] == tags[i]; run++)
+            ;
+
+          if (tags[i] == NULL || offsets[i] == offsets[run])
+            continue;
+
+          gtk_text_buffer_get_iter_at_offset (buffer, &start, start_offset + offsets[i]);
+          gtk_text_buffer_get_iter_at_offset (buffer, &end, start_offset + offsets[run]);
+          gtk_text_buffer_apply_tag (buffer, tags[i], &start, &end);
+        }
+    }
+
+  g_free (offsets);
+}
+
 
 /*
  * Deletion
@@ -4059,6 +4145,299 @@ gtk_text_buffer_end_user_action (GtkTextBuffer *buffer)
     }
 }
 
+/*
+ * Asynchronous search
+ */
+
+/* Number of matches to collect before handing them to the main thread */
+#define SEARCH_BATCH_SIZE 256
+
+typedef struct _SearchData SearchData;
+struct _SearchData
+{
+  gchar *text;
+  gchar *needle;
+  GtkTextSearchFlags flags;
+
+  guint chars_changed_stamp;
+  guint invalidated : 1;
+
+  GtkTextBufferMatchFunc match_func;
+  gpointer user_data;
+};
+
+typedef struct _SearchBatch SearchBatch;
+struct _SearchBatch
+{
+  GTask *task;
+  GArray *matches;      /* pairs of start and end offsets */
+};
+
+static void
+search_data_free (gpointer data)
+{
+  SearchData *search = data;
+
+  g_free (search->text);
+  g_free (search->needle);
+
+  g_slice_free (SearchData, search);
+}
+
+static void
+search_batch_free (gpointer data)
+{
+  SearchBatch *batch = data;
+
+  g_object_unref (batch->task);
+  g_array_unref (batch->matches);
+
+  g_slice_free (SearchBatch, batch);
+}
+
+static gboolean
+search_batch_deliver (gpointer data)
+{
+  SearchBatch *batch = data;
+  GtkTextBuffer *buffer = g_task_get_source_object (batch->task);
+  SearchData *search = g_task_get_task_data (batch->task);
+  GtkTextIter start, end;
+  guint i;
+
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (batch->task)))
+    return G_SOURCE_REMOVE;
+
+  /* The offsets are meaningless once the text changed */
+  if (search->chars_changed_stamp != _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer)))
+    search->invalidated = TRUE;
+
+  if (search->invalidated)
+    return G_SOURCE_REMOVE;
+
+  for (i = 0; i < batch->matches->len; i += 2)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &start, g_array_index (batch->matches, gint, i));
+      gtk_text_buffer_get_iter_at_offset (buffer, &end, g_array_index (batch->matches, gint, i + 1));
+
+      search->match_func (buffer, &start, &end, search->user_data);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+search_flush (GTask   *task,
+              GArray **matches)
+{
+  SearchBatch *batch;
+
+  if ((*matches)->len == 0)
+    return;
+
+  batch = g_slice_new (SearchBatch);
+  batch->task = g_object_ref (task);
+  batch->matches = *matches;
+
+  g_main_context_invoke_full (g_task_get_context (task),
+                              G_PRIORITY_DEFAULT,
+                              search_batch_deliver,
+                              batch,
+                              search_batch_free);
+
+  *matches = g_array_new (FALSE, FALSE, sizeof (gint));
+}
+
+static void
+search_add_match (GTask   *task,
+                  GArray **matches,
+                  gint     start,
+                  gint     end)
+{
+  g_array_append_val (*matches, start);
+  g_array_append_val (*matches, end);
+
+  if ((*matches)->len >= 2 * SEARCH_BATCH_SIZE)
+    search_flush (task, matches);
+}
+
+static void
+search_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+  SearchData *search = task_data;
+  GArray *matches;
+  const gchar *p, *found, *found_end;
+  gint offset;
+
+  matches = g_array_new (FALSE, FALSE, sizeof (gint));
+  offset = 0;
+
+  if (search->flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE)
+    {
+      gchar *line, *eol;
+
+      /* Case folding needs to be done on nul-terminated strings, so
+       * split the text into lines in place. */
+      for (line = search->text; line != NULL; line = eol ? eol + 1 : NULL)
+        {
+          if (g_cancellable_is_cancelled (cancellable))
+            break;
+
+          eol = strchr (line, '\n');
+          if (eol)
+            *eol = '\0';
+
+          p = line;
+          while (*p && (found = _gtk_text_utf8_strcasestr (p, search->needle, &found_end)) != NULL)
+            {
+              gint start;
+
+              if (found_end == found)
+                break;
+
+              start = offset + g_utf8_strlen (p, found - p);
+              offset = start + g_utf8_strlen (found, found_end - found);
+              search_add_match (task, &matches, start, offset);
+              p = found_end;
+            }
+
+          offset += g_utf8_strlen (p, -1) + (eol ? 1 : 0);
+        }
+    }
+  else
+    {
+      gsize needle_len = strlen (search->needle);
+      gint needle_chars = g_utf8_strlen (search->needle, -1);
+
+      p = search->text;
+      while ((found = strstr (p, search->needle)) != NULL)
+        {
+          if (g_cancellable_is_cancelled (cancellable))
+            break;
+
+          offset += g_utf8_strlen (p, found - p);
+          search_add_match (task, &matches, offset, offset + needle_chars);
+          offset += needle_chars;
+          p = found + needle_len;
+        }
+    }
+
+  search_flush (task, &matches);
+  g_array_unref (matches);
+
+  if (!g_task_return_error_if_cancelled (task))
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * gtk_text_buffer_search_async:
+ * @buffer: a #GtkTextBuffer
+ * @str: a search string
+ * @flags: flags affecting how the search is done
+ * @cancellable: (nullable): a #GCancellable
+ * @match_func: (scope notified): function to call for every match
+ * @callback: (scope async): callback to call when the search is done
+ * @user_data: (closure): data to pass to @match_func and @callback
+ *
+ * Finds all non-overlapping occurrences of @str in @buffer, without
+ * blocking the main loop. The search runs on a copy of the text in
+ * a thread, and @match_func is called for the matches in batches
+ * while the search is going on, in the thread-default main context
+ * gtk_text_buffer_search_async() was called from.
+ *
+ * If the text of @buffer changes before the search is finished, no
+ * more matches are reported and gtk_text_buffer_search_finish() fails;
+ * start a new search in that case.
+ *
+ * Only %GTK_TEXT_SEARCH_CASE_INSENSITIVE is supported in @flags. For
+ * case insensitive searches, matches don't span multiple lines.
+ *
+ * Since: 3.94
+ */
+void
+gtk_text_buffer_search_async (GtkTextBuffer          *buffer,
+                              const gchar            *str,
+                              GtkTextSearchFlags      flags,
+                              GCancellable           *cancellable,
+                              GtkTextBufferMatchFunc  match_func,
+                              GAsyncReadyCallback     callback,
+                              gpointer                user_data)
+{
+  SearchData *search;
+  GtkTextIter start, end;
+  GTask *task;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (str != NULL && *str != '\0');
+  g_return_if_fail ((flags & ~GTK_TEXT_SEARCH_CASE_INSENSITIVE) == 0);
+  g_return_if_fail (match_func != NULL);
+
+  search = g_slice_new0 (SearchData);
+  search->flags = flags;
+  search->match_func = match_func;
+  search->user_data = user_data;
+  search->chars_changed_stamp = _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer));
+
+  if (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE)
+    {
+      gchar *casefold = g_utf8_casefold (str, -1);
+      search->needle = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
+      g_free (casefold);
+    }
+  else
+    search->needle = g_strdup (str);
+
+  /* The slice has one character for every offset in the buffer */
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  search->text = gtk_text_buffer_get_slice (buffer, &start, &end, TRUE);
+
+  task = g_task_new (buffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_text_buffer_search_async);
+  g_task_set_task_data (task, search, search_data_free);
+  g_task_run_in_thread (task, search_thread);
+  g_object_unref (task);
+}
+
+/**
+ * gtk_text_buffer_search_finish:
+ * @buffer: a #GtkTextBuffer
+ * @result: a #GAsyncResult
+ * @error: return location for an error
+ *
+ * Finishes a search started with gtk_text_buffer_search_async().
+ *
+ * Returns: %TRUE if all matches have been reported, %FALSE if
+ *     the search was cancelled or the buffer changed
+ *
+ * Since: 3.94
+ */
+gboolean
+gtk_text_buffer_search_finish (GtkTextBuffer  *buffer,
+                               GAsyncResult   *result,
+                               GError        **error)
+{
+  SearchData *search;
+
+  g_return_val_if_fail (g_task_is_valid (result, buffer), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_text_buffer_search_async, FALSE);
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  search = g_task_get_task_data (G_TASK (result));
+  if (search->invalidated ||
+      search->chars_changed_stamp != _gtk_text_btree_get_chars_changed_stamp (get_btree (buffer)))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           "The text changed during the search");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 /*
  * Logical attribute cache
  */
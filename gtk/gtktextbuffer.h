@@ -74,6 +74,23 @@ typedef struct _GtkTextBTree GtkTextBTree;
 typedef struct _GtkTextBufferPrivate GtkTextBufferPrivate;
 typedef struct _GtkTextBufferClass GtkTextBufferClass;
 
+/**
+ * GtkTextBufferMatchFunc:
+ * @buffer: the #GtkTextBuffer that is searched
+ * @match_start: start of the match
+ * @match_end: end of the match
+ * @user_data: user data passed to gtk_text_buffer_search_async()
+ *
+ * The type of the function that is called for every match found by
+ * gtk_text_buffer_search_async().
+ *
+ * Since: 3.94
+ */
+typedef void (* GtkTextBufferMatchFunc) (GtkTextBuffer     *buffer,
+                                         const GtkTextIter *match_start,
+                                         const GtkTextIter *match_end,
+                                         gpointer           user_data);
+
 struct _GtkTextBuffer
 {
   GObject parent_instance;
@@ -236,6 +253,14 @@ void     gtk_text_buffer_insert_markup            (GtkTextBuffer     *buffer,
                                                    const gchar       *markup,
                                                    gint               len);
 
+GDK_AVAILABLE_IN_3_94
+void     gtk_text_buffer_insert_chunks            (GtkTextBuffer     *buffer,
+                                                   GtkTextIter       *iter,
+                                                   const gchar      **texts,
+                                                   const gint        *lengths,
+                                                   GtkTextTag       **tags,
+                                                   guint              n_chunks);
+
 /* Delete from the buffer */
 GDK_AVAILABLE_IN_ALL
 void     gtk_text_buffer_delete             (GtkTextBuffer *buffer,
@@ -457,6 +482,19 @@ void            gtk_text_buffer_begin_user_action       (GtkTextBuffer *buffer);
 GDK_AVAILABLE_IN_ALL
 void            gtk_text_buffer_end_user_action         (GtkTextBuffer *buffer);
 
+GDK_AVAILABLE_IN_3_94
+void            gtk_text_buffer_search_async            (GtkTextBuffer          *buffer,
+                                                         const gchar            *str,
+                                                         GtkTextSearchFlags      flags,
+                                                         GCancellable           *cancellable,
+                                                         GtkTextBufferMatchFunc  match_func,
+                                                         GAsyncReadyCallback     callback,
+                                                         gpointer                user_data);
+GDK_AVAILABLE_IN_3_94
+gboolean        gtk_text_buffer_search_finish           (GtkTextBuffer          *buffer,
+                                                         GAsyncResult           *result,
+                                                         GError                **error);
+
 
 G_END_DECLS
 
@@ -78,6 +78,8 @@
 #include "gtktextviewprivate.h"
 #include "gtkwidgetprivate.h"
 #include "gtkstylecontextprivate.h"
+#include "gtksnapshotprivate.h"
+#include "gtktextbtree.h"
 #include "gtkintl.h"
 #include <gdk/gdktextureprivate.h>
 
@@ -815,6 +817,40 @@ get_text_renderer (void)
   return text_renderer;
 }
 
+static void
+get_selection_indices (GtkTextLayout     *layout,
+                       GtkTextLine       *line,
+                       const GtkTextIter *selection_start,
+                       const GtkTextIter *selection_end,
+                       gint              *selection_start_index,
+                       gint              *selection_end_index)
+{
+  GtkTextIter line_start, line_end;
+  gint byte_count;
+
+  gtk_text_layout_get_iter_at_line (layout,
+                                    &line_start,
+                                    line, 0);
+  line_end = line_start;
+  if (!gtk_text_iter_ends_line (&line_end))
+    gtk_text_iter_forward_to_line_end (&line_end);
+  byte_count = gtk_text_iter_get_visible_line_index (&line_end);
+
+  if (gtk_text_iter_compare (selection_start, &line_end) <= 0 &&
+      gtk_text_iter_compare (selection_end, &line_start) >= 0)
+    {
+      if (gtk_text_iter_compare (selection_start, &line_start) >= 0)
+        *selection_start_index = gtk_text_iter_get_visible_line_index (selection_start);
+      else
+        *selection_start_index = -1;
+
+      if (gtk_text_iter_compare (selection_end, &line_end) <= 0)
+        *selection_end_index = gtk_text_iter_get_visible_line_index (selection_end);
+      else
+        *selection_end_index = byte_count + 1; /* + 1 to flag past-the-end */
+    }
+}
+
 void
 gtk_text_layout_draw (GtkTextLayout *layout,
                       GtkWidget *widget,
@@ -872,32 +908,9 @@ gtk_text_layout_draw (GtkTextLayout *layout,
           g_assert (line_display->layout != NULL);
           
           if (have_selection)
-            {
-              GtkTextIter line_start, line_end;
-              gint byte_count;
-              
-              gtk_text_layout_get_iter_at_line (layout,
-                                                &line_start,
-                                                line, 0);
-              line_end = line_start;
-	      if (!gtk_text_iter_ends_line (&line_end))
-		gtk_text_iter_forward_to_line_end (&line_end);
-              byte_count = gtk_text_iter_get_visible_line_index (&line_end);     
-
-              if (gtk_text_iter_compare (&selection_start, &line_end) <= 0 &&
-                  gtk_text_iter_compare (&selection_end, &line_start) >= 0)
-                {
-                  if (gtk_text_iter_compare (&selection_start, &line_start) >= 0)
-                    selection_start_index = gtk_text_iter_get_visible_line_index (&selection_start);
-                  else
-                    selection_start_index = -1;
-
-                  if (gtk_text_iter_compare (&selection_end, &line_end) <= 0)
-                    selection_end_index = gtk_text_iter_get_visible_line_index (&selection_end);
-                  else
-                    selection_end_index = byte_count + 1; /* + 1 to flag past-the-end */
-                }
-            }
+            get_selection_indices (layout, line,
+                                   &selection_start, &selection_end,
+                                   &selection_start_index, &selection_end_index);
 
           render_para (text_renderer, line_display,
                        selection_start_index, selection_end_index);
@@ -934,3 +947,176 @@ gtk_text_layout_draw (GtkTextLayout *layout,
 
   g_slist_free (line_list);
 }
+
+static GskRenderNode *
+render_para_node (GtkTextRenderer       *text_renderer,
+                  GtkWidget             *widget,
+                  GskRenderer           *renderer,
+                  GtkTextLineDisplay    *line_display,
+                  const graphene_rect_t *bounds,
+                  int                    selection_start_index,
+                  int                    selection_end_index)
+{
+  GskRenderNode *node;
+  cairo_t *cr;
+
+  node = gsk_cairo_node_new (bounds);
+  cr = gsk_cairo_node_get_draw_context (node, renderer);
+
+  text_renderer_begin (text_renderer, widget, cr);
+  render_para (text_renderer, line_display,
+               selection_start_index, selection_end_index);
+  text_renderer_end (text_renderer);
+
+  cairo_destroy (cr);
+
+  return node;
+}
+
+void
+gtk_text_layout_snapshot (GtkTextLayout      *layout,
+                          GtkWidget          *widget,
+                          GtkSnapshot        *snapshot,
+                          const GdkRectangle *clip)
+{
+  GtkStyleContext *context;
+  gint offset_y;
+  GtkTextRenderer *text_renderer;
+  GtkTextIter selection_start, selection_end;
+  gboolean have_selection;
+  GSList *line_list;
+  GSList *tmp_list;
+  GdkRGBA color;
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+  g_return_if_fail (layout->default_style != NULL);
+  g_return_if_fail (layout->buffer != NULL);
+  g_return_if_fail (snapshot != NULL);
+
+  line_list = gtk_text_layout_get_lines (layout, clip->y, clip->y + clip->height, &offset_y);
+
+  if (line_list == NULL)
+    return; /* nothing on the screen */
+
+  text_renderer = get_text_renderer ();
+
+  context = gtk_widget_get_style_context (widget);
+  gtk_style_context_save_to_node (context, gtk_text_view_get_text_node ((GtkTextView *)widget));
+  gtk_style_context_get_color (context, &color);
+
+  gtk_text_layout_wrap_loop_start (layout);
+
+  have_selection = gtk_text_buffer_get_selection_bounds (layout->buffer,
+                                                         &selection_start,
+                                                         &selection_end);
+
+  tmp_list = line_list;
+  while (tmp_list != NULL)
+    {
+      GtkTextLineDisplay *line_display;
+      gint selection_start_index = -1;
+      gint selection_end_index = -1;
+
+      GtkTextLine *line = tmp_list->data;
+
+      line_display = gtk_text_layout_get_line_display (layout, line, FALSE);
+
+      if (line_display->height > 0)
+        {
+          GtkTextLineData *line_data;
+          graphene_rect_t bounds, node_bounds;
+          graphene_matrix_t offset;
+          GskRenderNode *node;
+          gboolean cacheable;
+
+          g_assert (line_display->layout != NULL);
+
+          if (have_selection)
+            get_selection_indices (layout, line,
+                                   &selection_start, &selection_end,
+                                   &selection_start_index, &selection_end_index);
+
+          /* Only the visible part of the line is rendered, so very long
+           * lines don't end up in huge nodes. Leave room for the ink of the
+           * line to overflow into its neighbours.
+           */
+          line_data = _gtk_text_line_get_data (line, layout);
+          graphene_rect_init (&bounds,
+                              clip->x,
+                              line_data ? - line_data->top_ink : 0,
+                              clip->width,
+                              line_display->height + (line_data ? line_data->top_ink + line_data->bottom_ink : 0));
+
+          /* Selections and block cursors change all the time, so
+           * lines that have them are not worth keeping.
+           */
+          cacheable = selection_start_index < 0 && selection_end_index < 0 &&
+                      !(line_display->has_block_cursor && gtk_widget_has_focus (widget));
+
+          if (line_display->node != NULL)
+            gsk_render_node_get_bounds (line_display->node, &node_bounds);
+
+          if (cacheable &&
+              line_display->node != NULL &&
+              graphene_rect_equal (&node_bounds, &bounds) &&
+              gdk_rgba_equal (&line_display->node_color, &color))
+            {
+              node = gsk_render_node_ref (line_display->node);
+            }
+          else
+            {
+              node = render_para_node (text_renderer, widget,
+                                       gtk_snapshot_get_renderer (snapshot),
+                                       line_display, &bounds,
+                                       selection_start_index, selection_end_index);
+
+              if (cacheable)
+                {
+                  g_clear_pointer (&line_display->node, gsk_render_node_unref);
+                  line_display->node = gsk_render_node_ref (node);
+                  line_display->node_color = color;
+                }
+            }
+
+          graphene_matrix_init_translate (&offset, &GRAPHENE_POINT3D_INIT (0, offset_y, 0));
+          gtk_snapshot_push_transform (snapshot, &offset, "Text Line");
+          gtk_snapshot_append_node (snapshot, node);
+          gtk_snapshot_pop (snapshot);
+          gsk_render_node_unref (node);
+
+          /* We paint the cursors last, because they overlap another chunk
+           * and need to appear on top.
+           */
+          if (line_display->cursors != NULL)
+            {
+              int i;
+
+              gtk_snapshot_offset (snapshot, 0, offset_y);
+
+              for (i = 0; i < line_display->cursors->len; i++)
+                {
+                  int index;
+                  PangoDirection dir;
+
+                  index = g_array_index(line_display->cursors, int, i);
+                  dir = (line_display->direction == GTK_TEXT_DIR_RTL) ? PANGO_DIRECTION_RTL : PANGO_DIRECTION_LTR;
+                  gtk_snapshot_render_insertion_cursor (snapshot, context,
+                                                        line_display->x_offset, line_display->top_margin,
+                                                        line_display->layout, index, dir);
+                }
+
+              gtk_snapshot_offset (snapshot, 0, - offset_y);
+            }
+        } /* line_display->height > 0 */
+
+      offset_y += line_display->height;
+      gtk_text_layout_free_line_display (layout, line_display);
+
+      tmp_list = tmp_list->next;
+    }
+
+  gtk_text_layout_wrap_loop_end (layout);
+  gtk_style_context_restore (context);
+
+  g_slist_free (line_list);
+}
@@ -94,6 +94,15 @@ void gtk_text_layout_draw (GtkTextLayout        *layout,
                            GtkWidget            *widget,
                            cairo_t              *cr);
 
+/* Like gtk_text_layout_draw(), but the rendered lines are kept with
+ * the line displays and reused as long as they don't change.
+ * clip              - The area of the layout to snapshot
+ */
+void gtk_text_layout_snapshot (GtkTextLayout        *layout,
+                               GtkWidget            *widget,
+                               GtkSnapshot          *snapshot,
+                               const GdkRectangle   *clip);
+
 
 G_END_DECLS
 
@@ -4522,10 +4522,12 @@ exact_prefix_cmp (const gchar *string,
 }
 
 static const gchar *
-utf8_strcasestr (const gchar *haystack,
-                 const gchar *needle)
+utf8_strcasestr (const gchar  *haystack,
+                 const gchar  *needle,
+                 const gchar **match_end)
 {
   gsize needle_len;
+  gsize needle_chars;
   gsize haystack_len;
   const gchar *ret = NULL;
   gchar *p;
@@ -4540,12 +4542,14 @@ utf8_strcasestr (const gchar *haystack,
   caseless_haystack = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
 
-  needle_len = g_utf8_strlen (needle, -1);
+  needle_len = needle_chars = g_utf8_strlen (needle, -1);
   haystack_len = g_utf8_strlen (caseless_haystack, -1);
 
   if (needle_len == 0)
     {
       ret = (gchar *)haystack;
+      if (match_end)
+        *match_end = ret;
       goto finally;
     }
 
@@ -4564,6 +4568,8 @@ utf8_strcasestr (const gchar *haystack,
       if (exact_prefix_cmp (p, needle, needle_len))
         {
           ret = pointer_from_offset_skipping_decomp (haystack, i);
+          if (match_end)
+            *match_end = pointer_from_offset_skipping_decomp (ret, needle_chars);
           goto finally;
         }
 
@@ -4577,6 +4583,17 @@ finally:
   return ret;
 }
 
+/* Finds the casefolded and normalized @needle in @haystack, like
+ * case insensitive searches do. This is safe to call from any thread.
+ */
+const gchar *
+_gtk_text_utf8_strcasestr (const gchar  *haystack,
+                           const gchar  *needle,
+                           const gchar **match_end)
+{
+  return utf8_strcasestr (haystack, needle, match_end);
+}
+
 static const gchar *
 utf8_strrcasestr (const gchar *haystack,
                   const gchar *needle)
@@ -4676,6 +4693,34 @@ utf8_caselessnmatch (const gchar *s1,
   return ret;
 }
 
+/* Rules out lines that can't contain @str without copying their text,
+ * which is what makes searching big buffers slow. This only works for
+ * lines whose text is all in one char segment, for everything else
+ * we have to assume the line may match.
+ */
+static gboolean
+line_may_contain (GtkTextLine *line,
+                  const gchar *str)
+{
+  GtkTextLineSegment *seg, *chars = NULL;
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->byte_count == 0)
+        continue;
+
+      if (seg->type != &gtk_text_char_type || chars != NULL)
+        return TRUE;
+
+      chars = seg;
+    }
+
+  if (chars == NULL)
+    return TRUE;
+
+  return strstr (chars->body.chars, str) != NULL;
+}
+
 static gboolean
 lines_match (const GtkTextIter *start,
              const gchar **lines,
@@ -4700,6 +4745,12 @@ lines_match (const GtkTextIter *start,
       return TRUE;
     }
 
+  /* Invisible text and case folding change the text that is matched,
+   * so only do the quick check for plain searches. */
+  if (match_start && !visible_only && !case_insensitive &&
+      !line_may_contain (_gtk_text_iter_get_text_line (start), *lines))
+    return FALSE;
+
   next = *start;
   gtk_text_iter_forward_line (&next);
 
@@ -4729,7 +4780,7 @@ lines_match (const GtkTextIter *start,
       if (!case_insensitive)
         found = strstr (line_text, *lines);
       else
-        found = utf8_strcasestr (line_text, *lines);
+        found = utf8_strcasestr (line_text, *lines, NULL);
     }
   else
     {
@@ -42,6 +42,10 @@ gboolean            _gtk_text_iter_backward_indexable_segment (GtkTextIter
 gint                _gtk_text_iter_get_segment_byte           (const GtkTextIter *iter);
 gint                _gtk_text_iter_get_segment_char           (const GtkTextIter *iter);
 
+const gchar *       _gtk_text_utf8_strcasestr                 (const gchar       *haystack,
+                                                               const gchar       *needle,
+                                                               const gchar      **match_end);
+
 gboolean       gtk_text_iter_get_attributes (const GtkTextIter *iter,
                                              GtkTextAttributes *values);
 
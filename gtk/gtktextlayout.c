@@ -84,6 +84,8 @@
 #include "gtktextutil.h"
 #include "gtkintl.h"
 
+#include "gdk/gdk-private.h"
+
 #include <stdlib.h>
 #include <string.h>
 
@@ -97,6 +99,18 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* With uniform_advance set, lines of plain ASCII text are measured
+   * arithmetically from the metrics of the first such line instead of
+   * being shaped. advance is in Pango units; 0 means not measured yet,
+   * -1 means the font turned out not to have a uniform advance.
+   */
+  guint uniform_advance : 1;
+  gint advance;
+  gint line_height;
+  gint extra_width;
+  gint top_ink;
+  gint bottom_ink;
 };
 
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
@@ -126,6 +140,7 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 						    gint               new_height);
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
+static void gtk_text_layout_clear_display_cache (GtkTextLayout *layout);
 
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
@@ -169,6 +184,10 @@ enum {
 
 #define PIXEL_BOUND(d) (((d) + PANGO_SCALE - 1) / PANGO_SCALE)
 
+/* Enough to cover the visible lines of a big text view plus
+ * some scrolling margin */
+#define MAX_CACHED_LINE_DISPLAYS 250
+
 static guint signals[LAST_SIGNAL] = { 0 };
 
 PangoAttrType gtk_text_attr_appearance_type = 0;
@@ -193,12 +212,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  gtk_text_layout_clear_display_cache (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -217,6 +231,7 @@ gtk_text_layout_finalize (GObject *object)
   layout = GTK_TEXT_LAYOUT (object);
 
   g_free (layout->preedit_string);
+  g_hash_table_destroy (layout->display_cache);
 
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
 }
@@ -277,6 +292,9 @@ static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
   text_layout->cursor_visible = TRUE;
+
+  text_layout->display_cache = g_hash_table_new (NULL, NULL);
+  g_queue_init (&text_layout->display_cache_lru);
 }
 
 GtkTextLayout*
@@ -285,6 +303,59 @@ gtk_text_layout_new (void)
   return g_object_new (GTK_TYPE_TEXT_LAYOUT, NULL);
 }
 
+static GtkTextLineDisplay *
+gtk_text_layout_lookup_display (GtkTextLayout *layout,
+                                GtkTextLine   *line)
+{
+  GList *link;
+
+  link = g_hash_table_lookup (layout->display_cache, line);
+  if (link == NULL)
+    return NULL;
+
+  g_queue_unlink (&layout->display_cache_lru, link);
+  g_queue_push_head_link (&layout->display_cache_lru, link);
+
+  return link->data;
+}
+
+static void
+gtk_text_layout_remove_display (GtkTextLayout      *layout,
+                                GtkTextLineDisplay *display)
+{
+  GList *link;
+
+  link = g_hash_table_lookup (layout->display_cache, display->line);
+  g_assert (link != NULL && link->data == display);
+
+  g_hash_table_remove (layout->display_cache, display->line);
+  g_queue_delete_link (&layout->display_cache_lru, link);
+
+  display->cached = FALSE;
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+static void
+gtk_text_layout_insert_display (GtkTextLayout      *layout,
+                                GtkTextLineDisplay *display)
+{
+  g_assert (g_hash_table_lookup (layout->display_cache, display->line) == NULL);
+
+  if (layout->display_cache_lru.length >= MAX_CACHED_LINE_DISPLAYS)
+    gtk_text_layout_remove_display (layout, g_queue_peek_tail (&layout->display_cache_lru));
+
+  display->cached = TRUE;
+  g_queue_push_head (&layout->display_cache_lru, display);
+  g_hash_table_insert (layout->display_cache, display->line, layout->display_cache_lru.head);
+}
+
+static void
+gtk_text_layout_clear_display_cache (GtkTextLayout *layout)
+{
+  while (!g_queue_is_empty (&layout->display_cache_lru))
+    gtk_text_layout_remove_display (layout, g_queue_peek_head (&layout->display_cache_lru));
+}
+
 static void
 free_style_cache (GtkTextLayout *text_layout)
 {
@@ -310,6 +381,7 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  gtk_text_layout_clear_display_cache (layout);
 
   if (layout->buffer)
     {
@@ -553,6 +625,54 @@ gtk_text_layout_get_cursor_visible (GtkTextLayout *layout)
   return layout->cursor_visible;
 }
 
+/**
+ * gtk_text_layout_set_uniform_advance:
+ * @layout: a #GtkTextLayout
+ * @uniform_advance: whether to assume a uniform glyph advance
+ *
+ * Sets whether all printable ASCII characters in the default font can
+ * be assumed to have the same advance width. If so, untagged lines
+ * that only contain such characters are measured without shaping them,
+ * which makes validating large buffers a lot cheaper.
+ *
+ * This only has an effect when wrapping is turned off.
+ */
+void
+gtk_text_layout_set_uniform_advance (GtkTextLayout *layout,
+                                     gboolean       uniform_advance)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  g_return_if_fail (GTK_IS_TEXT_LAYOUT (layout));
+
+  uniform_advance = uniform_advance != FALSE;
+
+  if (priv->uniform_advance != uniform_advance)
+    {
+      priv->uniform_advance = uniform_advance;
+      gtk_text_layout_invalidate_all (layout);
+    }
+}
+
+/**
+ * gtk_text_layout_get_uniform_advance:
+ * @layout: a #GtkTextLayout
+ *
+ * Returns whether a uniform glyph advance is assumed for plain
+ * ASCII lines, see gtk_text_layout_set_uniform_advance().
+ *
+ * Returns: %TRUE if lines may be measured without shaping them
+ */
+gboolean
+gtk_text_layout_get_uniform_advance (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), FALSE);
+
+  return priv->uniform_advance;
+}
+
 /**
  * gtk_text_layout_set_preedit_string:
  * @layout: a #PangoLayout
@@ -635,15 +755,20 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GList *l, *next;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = layout->display_cache_lru.head; l; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLineDisplay *display = l->data;
+      GtkTextLine *line = display->line;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
 						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      gint cache_height = display->height;
+
+      next = l->next;
 
       if (cache_y + cache_height > y && cache_y < y + old_height)
 	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
@@ -802,9 +927,13 @@ gtk_text_layout_wrap_loop_end (GtkTextLayout *layout)
 static void
 gtk_text_layout_invalidate_all (GtkTextLayout *layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextIter start;
   GtkTextIter end;
 
+  /* Whatever made us relayout everything may have changed the font */
+  priv->advance = 0;
+
   if (layout->buffer == NULL)
     return;
 
@@ -818,9 +947,13 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLineDisplay *display;
+  GList *link;
+
+  link = g_hash_table_lookup (layout->display_cache, line);
+  if (link)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      display = link->data;
 
       if (cursors_only)
 	{
@@ -832,8 +965,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	}
       else
 	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
+	  gtk_text_layout_remove_display (layout, display);
 	}
     }
 }
@@ -926,32 +1058,37 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GList *l;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cursors of the cached lines if so.
    */
-  if (layout->one_display_cache)
+  if (gtk_text_iter_get_line (start) == gtk_text_iter_get_line (end))
     {
-      GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
-
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+      /* The common case of a moving cursor, only one line to check */
+      gtk_text_layout_invalidate_cache (layout, _gtk_text_iter_get_text_line (start), TRUE);
+    }
+  else
+    {
+      gint start_line, end_line;
 
-      line_end = line_start;
-      if (!gtk_text_iter_ends_line (&line_end))
-	gtk_text_iter_forward_to_line_end (&line_end);
+      start_line = gtk_text_iter_get_line (start);
+      end_line = gtk_text_iter_get_line (end);
+      if (start_line > end_line)
+        {
+          gint tmp = start_line;
+          start_line = end_line;
+          end_line = tmp;
+        }
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
+      for (l = layout->display_cache_lru.head; l; l = l->next)
+        {
+          GtkTextLineDisplay *display = l->data;
+          gint line = _gtk_text_line_get_number (display->line);
 
-      if (gtk_text_iter_compare (&line_start, end) <= 0 &&
-	  gtk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
+          if (line >= start_line && line <= end_line)
+            gtk_text_layout_invalidate_cache (layout, display->line, TRUE);
+        }
     }
 
   gtk_text_layout_invalidated (layout);
@@ -1159,14 +1296,68 @@ gtk_text_layout_validate (GtkTextLayout *layout,
     }
 }
 
+/* Returns the number of characters in @line if it can be measured
+ * with the uniform advance, or -1 if it has to be shaped.
+ */
+static gint
+uniform_line_char_count (GtkTextLayout *layout,
+                         GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineSegment *seg;
+  GtkTextIter iter;
+  GtkTextTag **tags;
+  gint n_chars, n_tags, i;
+
+  if (!priv->uniform_advance || priv->advance < 0 ||
+      layout->default_style == NULL ||
+      layout->default_style->wrap_mode != GTK_WRAP_NONE ||
+      (layout->preedit_len > 0 && line == priv->cursor_line))
+    return -1;
+
+  n_chars = 0;
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_char_type)
+        {
+          for (i = 0; i < seg->byte_count; i++)
+            {
+              guchar c = seg->body.chars[i];
+
+              if (c >= 0x20 && c < 0x7f)
+                n_chars++;
+              else if (c != '\n' && c != '\r')
+                return -1;
+            }
+        }
+      else if (seg->type != &gtk_text_right_mark_type &&
+               seg->type != &gtk_text_left_mark_type)
+        return -1;
+    }
+
+  /* No toggles in the line, but a tag may still span it */
+  _gtk_text_btree_get_iter_at_line (_gtk_text_buffer_get_btree (layout->buffer),
+                                    &iter, line, 0);
+  tags = _gtk_text_btree_get_tags (&iter, &n_tags);
+  g_free (tags);
+
+  if (n_tags > 0)
+    return -1;
+
+  return n_chars;
+}
+
 static GtkTextLineData*
 gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            GtkTextLine     *line,
                            /* may be NULL */
                            GtkTextLineData *line_data)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
   PangoRectangle ink_rect, logical_rect;
+  gboolean was_cached, size_only;
+  gint n_chars;
 
   g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), NULL);
   g_return_val_if_fail (line != NULL, NULL);
@@ -1177,14 +1368,60 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
       _gtk_text_line_add_data (line, line_data);
     }
 
-  display = gtk_text_layout_get_line_display (layout, line, TRUE);
+  was_cached = g_hash_table_contains (layout->display_cache, line);
+
+  n_chars = was_cached ? -1 : uniform_line_char_count (layout, line);
+  if (n_chars >= 0 && priv->advance > 0)
+    {
+      line_data->width = priv->extra_width + PIXEL_BOUND (n_chars * priv->advance);
+      line_data->height = priv->line_height;
+      line_data->top_ink = priv->top_ink;
+      line_data->bottom_ink = priv->bottom_ink;
+      line_data->valid = TRUE;
+
+      return line_data;
+    }
+
+  /* The line with the cursor is usually the one being edited, and it
+   * will be drawn right after it has been measured. Lay it out fully
+   * right away, so that every keystroke doesn't shape it twice. */
+  size_only = line != priv->cursor_line;
+
+  display = gtk_text_layout_get_line_display (layout, line, size_only);
   line_data->width = display->width;
   line_data->height = display->height;
   line_data->valid = TRUE;
   pango_layout_get_pixel_extents (display->layout, &ink_rect, &logical_rect);
   line_data->top_ink = MAX (0, logical_rect.x - ink_rect.x);
   line_data->bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
-  gtk_text_layout_free_line_display (layout, display);
+
+  /* Take the metrics for the uniform advance from the first line of
+   * plain text, unless its width shows that the advances differ.
+   */
+  if (n_chars > 0 && priv->advance == 0)
+    {
+      PangoRectangle extents;
+
+      pango_layout_get_extents (display->layout, NULL, &extents);
+
+      if (extents.width % n_chars == 0)
+        {
+          priv->advance = extents.width / n_chars;
+          priv->line_height = display->height;
+          priv->extra_width = display->width - PIXEL_BOUND (extents.width);
+          priv->top_ink = line_data->top_ink;
+          priv->bottom_ink = line_data->bottom_ink;
+        }
+      else
+        priv->advance = -1;
+    }
+
+  /* Most lines are only measured when validating offscreen parts of the
+   * buffer, don't let them push the visible lines out of the cache. */
+  if (size_only && !was_cached && display->cached)
+    gtk_text_layout_remove_display (layout, display);
+  else
+    gtk_text_layout_free_line_display (layout, display);
 
   return line_data;
 }
@@ -2268,26 +2505,25 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  display = gtk_text_layout_lookup_display (layout, line);
+  if (display)
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      if (size_only || !display->size_only)
 	{
 	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
+            update_text_display_cursors (layout, line, display);
+	  return display;
 	}
       else
         {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
+          gtk_text_layout_remove_display (layout, display);
         }
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
+  gdk_memory_stats_alloc (GDK_MEMORY_TEXT_LINE_DISPLAYS, sizeof (GtkTextLineDisplay));
 
   display->size_only = size_only;
   display->line = line;
@@ -2611,7 +2847,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  gtk_text_layout_insert_display (layout, display);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2623,7 +2859,7 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
+  if (!display->cached)
     {
       if (display->layout)
         g_object_unref (display->layout);
@@ -2634,6 +2870,9 @@ gtk_text_layout_free_line_display (GtkTextLayout      *layout,
       if (display->pg_bg_rgba)
         gdk_rgba_free (display->pg_bg_rgba);
 
+      g_clear_pointer (&display->node, gsk_render_node_unref);
+
+      gdk_memory_stats_free (GDK_MEMORY_TEXT_LINE_DISPLAYS, sizeof (GtkTextLineDisplay));
       g_slice_free (GtkTextLineDisplay, display);
     }
 }
@@ -138,10 +138,13 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
+  /* A cache of the most recently used line displays, so that
+   * drawing and scrolling don't relayout the visible lines every
+   * frame. Maps GtkTextLine to its link in display_cache_lru,
+   * which has the most recently used display first.
    */
-  GtkTextLineDisplay *one_display_cache;
+  GHashTable *display_cache;
+  GQueue display_cache_lru;
 
   /* Whether we are allowed to wrap right now */
   gint wrap_loop_count;
@@ -245,8 +248,14 @@ struct _GtkTextLineDisplay
   guint has_block_cursor : 1;
   guint cursor_at_line_end : 1;
   guint size_only : 1;
+  guint cached : 1;
 
   GdkRGBA *pg_bg_rgba;
+
+  /* The rendered text, background and decorations of the line, without
+   * selection and cursors. Set by gtk_text_layout_snapshot(). */
+  GskRenderNode *node;
+  GdkRGBA node_color;
 };
 
 #ifdef GTK_COMPILATION
@@ -297,6 +306,10 @@ void     gtk_text_layout_set_cursor_visible (GtkTextLayout     *layout,
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_text_layout_get_cursor_visible (GtkTextLayout     *layout);
 
+void     gtk_text_layout_set_uniform_advance (GtkTextLayout     *layout,
+                                              gboolean           uniform_advance);
+gboolean gtk_text_layout_get_uniform_advance (GtkTextLayout     *layout);
+
 /* Getting the size or the lines potentially results in a call to
  * recompute, which is pretty massively expensive. Thus it should
  * basically only be done in an idle handler.
@@ -144,6 +144,10 @@
 #define SCREEN_HEIGHT(widget) text_window_get_height (GTK_TEXT_VIEW (widget)->priv->text_window)
 
 #define SPACE_FOR_CURSOR 1
+
+/* How long incremental validation may keep the main loop busy at a time,
+ * so that frames and input still get through. */
+#define GTK_TEXT_VIEW_VALIDATE_TIME_US 8000
 #define CURSOR_ASPECT_RATIO (0.04)
 
 #define GTK_TEXT_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_TEXT_VIEW, GtkTextViewPrivate))
@@ -289,6 +293,8 @@ struct _GtkTextViewPrivate
   guint populate_all   : 1;
 
   guint handling_key_event : 1;
+
+  guint uniform_advance : 1;
 };
 
 struct _GtkTextPendingScroll
@@ -356,7 +362,8 @@ enum
   PROP_INPUT_PURPOSE,
   PROP_INPUT_HINTS,
   PROP_POPULATE_ALL,
-  PROP_MONOSPACE
+  PROP_MONOSPACE,
+  PROP_UNIFORM_ADVANCE
 };
 
 static GQuark quark_text_selection_data = 0;
@@ -1026,6 +1033,27 @@ gtk_text_view_class_init (GtkTextViewClass *klass)
                                                          FALSE,
                                                          GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 
+  /**
+   * GtkTextView:uniform-advance:
+   *
+   * If %TRUE, the text view assumes that all printable ASCII characters
+   * in its font have the same width, as they do in monospace fonts.
+   * Lines that contain only such characters and no tags are then
+   * measured without shaping them, which makes large buffers such as
+   * logs much cheaper to scroll through.
+   *
+   * This only has an effect if #GtkTextView:wrap-mode is %GTK_WRAP_NONE.
+   *
+   * Since: 3.94
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_UNIFORM_ADVANCE,
+                                   g_param_spec_boolean ("uniform-advance",
+                                                         P_("Uniform advance"),
+                                                         P_("Whether all ASCII characters are assumed to have the same width"),
+                                                         FALSE,
+                                                         GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
+
   
 
    /* GtkScrollable interface */
@@ -3805,6 +3833,10 @@ gtk_text_view_set_property (GObject         *object,
       gtk_text_view_set_monospace (text_view, g_value_get_boolean (value));
       break;
 
+    case PROP_UNIFORM_ADVANCE:
+      gtk_text_view_set_uniform_advance (text_view, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3925,6 +3957,10 @@ gtk_text_view_get_property (GObject         *object,
       g_value_set_boolean (value, gtk_text_view_get_monospace (text_view));
       break;
 
+    case PROP_UNIFORM_ADVANCE:
+      g_value_set_boolean (value, priv->uniform_advance);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -4365,13 +4401,23 @@ incremental_validate_callback (gpointer data)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
+  gint64 end_time;
 
   DV(g_print(G_STRLOC"\n"));
-  
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+
+  /* Validate as much as fits in the time budget instead of a fixed
+   * amount, big buffers need a lot fewer iterations that way and the
+   * adjustments are only updated once per batch. */
+  end_time = g_get_monotonic_time () + GTK_TEXT_VIEW_VALIDATE_TIME_US;
+  do
+    {
+      gtk_text_layout_validate (text_view->priv->layout, 2000);
+    }
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < end_time);
 
   gtk_text_view_update_adjustments (text_view);
-  
+
   if (gtk_text_layout_is_valid (text_view->priv->layout))
     {
       text_view->priv->incremental_validate_idle = 0;
@@ -5486,10 +5532,11 @@ gtk_text_view_motion (GtkEventController *controller,
 
 static void
 gtk_text_view_paint (GtkWidget      *widget,
-                     cairo_t        *cr)
+                     GtkSnapshot    *snapshot)
 {
   GtkTextView *text_view;
   GtkTextViewPrivate *priv;
+  GdkRectangle clip;
   
   text_view = GTK_TEXT_VIEW (widget);
   priv = text_view->priv;
@@ -5517,19 +5564,19 @@ gtk_text_view_paint (GtkWidget      *widget,
           area->width, area->height);
 #endif
 
-  cairo_save (cr);
-  cairo_translate (cr, -priv->xoffset, -priv->yoffset);
-
-  gtk_text_layout_draw (priv->layout,
-                        widget,
-                        cr);
+  clip.x = priv->xoffset;
+  clip.y = priv->yoffset;
+  clip.width = gtk_widget_get_width (widget);
+  clip.height = gtk_widget_get_height (widget);
 
-  cairo_restore (cr);
+  gtk_snapshot_offset (snapshot, -priv->xoffset, -priv->yoffset);
+  gtk_text_layout_snapshot (priv->layout, widget, snapshot, &clip);
+  gtk_snapshot_offset (snapshot, priv->xoffset, priv->yoffset);
 }
 
 static void
-draw_text (GtkWidget *widget,
-           cairo_t   *cr)
+draw_text_background (GtkWidget *widget,
+                      cairo_t   *cr)
 {
   GtkTextView *text_view = GTK_TEXT_VIEW (widget);
   GtkTextViewPrivate *priv = text_view->priv;
@@ -5554,8 +5601,14 @@ draw_text (GtkWidget *widget,
       GTK_TEXT_VIEW_GET_CLASS (text_view)->draw_layer (text_view, GTK_TEXT_VIEW_LAYER_BELOW_TEXT, cr);
       cairo_restore (cr);
     }
+}
 
-  gtk_text_view_paint (widget, cr);
+static void
+draw_text_foreground (GtkWidget *widget,
+                      cairo_t   *cr)
+{
+  GtkTextView *text_view = GTK_TEXT_VIEW (widget);
+  GtkTextViewPrivate *priv = text_view->priv;
 
   if (GTK_TEXT_VIEW_GET_CLASS (text_view)->draw_layer != NULL)
     {
@@ -5606,24 +5659,38 @@ gtk_text_view_snapshot (GtkWidget   *widget,
 
   gtk_snapshot_push_clip (snapshot, &bounds, "Textview Clip");
 
-  cr = gtk_snapshot_append_cairo (snapshot, &bounds, "GtkTextView");
-
   context = gtk_widget_get_style_context (widget);
 
   text_window_set_padding (GTK_TEXT_VIEW (widget), context);
 
   DV(g_print (">Exposed ("G_STRLOC")\n"));
 
-  cairo_save (cr);
-  draw_text (widget, cr); 
-  cairo_restore (cr);
+  cr = gtk_snapshot_append_cairo (snapshot, &bounds, "GtkTextView");
+  draw_text_background (widget, cr);
+  cairo_destroy (cr);
 
-  paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->left_window, context);
-  paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->right_window, context);
-  paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->top_window, context);
-  paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->bottom_window, context);
+  /* The text goes into nodes of its own, so unchanged lines can be
+   * reused from the line display cache.
+   */
+  gtk_text_view_paint (widget, snapshot);
 
-  cairo_destroy (cr);
+  if (GTK_TEXT_VIEW_GET_CLASS (widget)->draw_layer != NULL ||
+      priv->left_window || priv->right_window ||
+      priv->top_window || priv->bottom_window)
+    {
+      cr = gtk_snapshot_append_cairo (snapshot, &bounds, "GtkTextView Foreground");
+
+      cairo_save (cr);
+      draw_text_foreground (widget, cr);
+      cairo_restore (cr);
+
+      paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->left_window, context);
+      paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->right_window, context);
+      paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->top_window, context);
+      paint_border_window (GTK_TEXT_VIEW (widget), cr, priv->bottom_window, context);
+
+      cairo_destroy (cr);
+    }
 
   /* Propagate exposes to all unanchored children. 
    * Anchored children are handled in gtk_text_view_paint(). 
@@ -7612,6 +7679,8 @@ gtk_text_view_ensure_layout (GtkTextView *text_view)
       gtk_text_layout_set_overwrite_mode (priv->layout,
 					  priv->overwrite_mode && priv->editable);
 
+      gtk_text_layout_set_uniform_advance (priv->layout, priv->uniform_advance);
+
       ltr_context = gtk_widget_create_pango_context (GTK_WIDGET (text_view));
       pango_context_set_base_dir (ltr_context, PANGO_DIRECTION_LTR);
       rtl_context = gtk_widget_create_pango_context (GTK_WIDGET (text_view));
@@ -10212,6 +10281,57 @@ gtk_text_view_get_monospace (GtkTextView *text_view)
   return gtk_style_context_has_class (context, GTK_STYLE_CLASS_MONOSPACE);
 }
 
+/**
+ * gtk_text_view_set_uniform_advance:
+ * @text_view: a #GtkTextView
+ * @uniform_advance: whether all ASCII characters have the same width
+ *
+ * Sets the #GtkTextView:uniform-advance property. Set this when the
+ * text view uses a monospace font, to let it measure plain ASCII lines
+ * without shaping them.
+ *
+ * Since: 3.94
+ */
+void
+gtk_text_view_set_uniform_advance (GtkTextView *text_view,
+                                   gboolean     uniform_advance)
+{
+  GtkTextViewPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_VIEW (text_view));
+
+  priv = text_view->priv;
+  uniform_advance = uniform_advance != FALSE;
+
+  if (priv->uniform_advance != uniform_advance)
+    {
+      priv->uniform_advance = uniform_advance;
+
+      if (priv->layout)
+        gtk_text_layout_set_uniform_advance (priv->layout, uniform_advance);
+
+      g_object_notify (G_OBJECT (text_view), "uniform-advance");
+    }
+}
+
+/**
+ * gtk_text_view_get_uniform_advance:
+ * @text_view: a #GtkTextView
+ *
+ * Gets the value of the #GtkTextView:uniform-advance property.
+ *
+ * Returns: %TRUE if ASCII characters are assumed to have the same width
+ *
+ * Since: 3.94
+ */
+gboolean
+gtk_text_view_get_uniform_advance (GtkTextView *text_view)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_VIEW (text_view), FALSE);
+
+  return text_view->priv->uniform_advance;
+}
+
 static void
 gtk_text_view_insert_emoji (GtkTextView *text_view)
 {
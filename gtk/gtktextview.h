@@ -437,6 +437,12 @@ void             gtk_text_view_set_monospace          (GtkTextView      *text_vi
 GDK_AVAILABLE_IN_3_16
 gboolean         gtk_text_view_get_monospace          (GtkTextView      *text_view);
 
+GDK_AVAILABLE_IN_3_94
+void             gtk_text_view_set_uniform_advance    (GtkTextView      *text_view,
+                                                       gboolean          uniform_advance);
+GDK_AVAILABLE_IN_3_94
+gboolean         gtk_text_view_get_uniform_advance    (GtkTextView      *text_view);
+
 G_END_DECLS
 
 #endif /* __GTK_TEXT_VIEW_H__ */
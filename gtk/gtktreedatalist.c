@@ -463,6 +463,182 @@ _gtk_tree_data_list_compare_func (GtkTreeModel *model,
   return retval;
 }
 
+/* Sorting by key
+ *
+ * Sorting with _gtk_tree_data_list_compare_func() fetches two values and,
+ * for strings, collates them in every comparison. Instead, the values can
+ * be fetched once per row into an array of keys, with strings turned into
+ * collation keys, and the array sorted without calling into the model.
+ */
+gboolean
+_gtk_tree_data_list_has_sort_key (GType type)
+{
+  switch (get_fundamental_type (type))
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_UCHAR:
+    case G_TYPE_UINT:
+    case G_TYPE_ULONG:
+    case G_TYPE_UINT64:
+    case G_TYPE_FLAGS:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_STRING:
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+void
+_gtk_tree_data_list_set_sort_key (GtkTreeDataSortKey *key,
+                                  GtkTreeModel       *model,
+                                  GtkTreeIter        *iter,
+                                  gint                column,
+                                  GType               type)
+{
+  GValue value = G_VALUE_INIT;
+  const gchar *str;
+
+  gtk_tree_model_get_value (model, iter, column, &value);
+
+  switch (get_fundamental_type (type))
+    {
+    case G_TYPE_BOOLEAN:
+      key->value.v_int64 = g_value_get_boolean (&value);
+      break;
+    case G_TYPE_CHAR:
+      key->value.v_int64 = g_value_get_schar (&value);
+      break;
+    case G_TYPE_INT:
+      key->value.v_int64 = g_value_get_int (&value);
+      break;
+    case G_TYPE_LONG:
+      key->value.v_int64 = g_value_get_long (&value);
+      break;
+    case G_TYPE_INT64:
+      key->value.v_int64 = g_value_get_int64 (&value);
+      break;
+    case G_TYPE_ENUM:
+      key->value.v_int64 = g_value_get_enum (&value);
+      break;
+    case G_TYPE_UCHAR:
+      key->value.v_uint64 = g_value_get_uchar (&value);
+      break;
+    case G_TYPE_UINT:
+      key->value.v_uint64 = g_value_get_uint (&value);
+      break;
+    case G_TYPE_ULONG:
+      key->value.v_uint64 = g_value_get_ulong (&value);
+      break;
+    case G_TYPE_UINT64:
+      key->value.v_uint64 = g_value_get_uint64 (&value);
+      break;
+    case G_TYPE_FLAGS:
+      key->value.v_uint64 = g_value_get_flags (&value);
+      break;
+    case G_TYPE_FLOAT:
+      key->value.v_double = g_value_get_float (&value);
+      break;
+    case G_TYPE_DOUBLE:
+      key->value.v_double = g_value_get_double (&value);
+      break;
+    case G_TYPE_STRING:
+      str = g_value_get_string (&value);
+      key->value.v_string = g_utf8_collate_key (str ? str : "", -1);
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  g_value_unset (&value);
+}
+
+typedef struct
+{
+  GType type;
+  GtkSortType order;
+} SortKeyData;
+
+static gint
+compare_sort_keys (gconstpointer a,
+                   gconstpointer b,
+                   gpointer      user_data)
+{
+  const GtkTreeDataSortKey *ka = a;
+  const GtkTreeDataSortKey *kb = b;
+  SortKeyData *data = user_data;
+  gint retval;
+
+  switch (data->type)
+    {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_CHAR:
+    case G_TYPE_INT:
+    case G_TYPE_LONG:
+    case G_TYPE_INT64:
+    case G_TYPE_ENUM:
+      retval = (ka->value.v_int64 > kb->value.v_int64) - (ka->value.v_int64 < kb->value.v_int64);
+      break;
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      retval = (ka->value.v_double > kb->value.v_double) - (ka->value.v_double < kb->value.v_double);
+      break;
+    case G_TYPE_STRING:
+      retval = strcmp (ka->value.v_string, kb->value.v_string);
+      break;
+    default:
+      retval = (ka->value.v_uint64 > kb->value.v_uint64) - (ka->value.v_uint64 < kb->value.v_uint64);
+      break;
+    }
+
+  if (data->order == GTK_SORT_DESCENDING)
+    retval = -retval;
+
+  /* Rows that compare equal keep their order */
+  if (retval == 0)
+    retval = ka->index - kb->index;
+
+  return retval;
+}
+
+void
+_gtk_tree_data_list_sort_keys (GtkTreeDataSortKey *keys,
+                               guint               n_keys,
+                               GType               type,
+                               GtkSortType         order)
+{
+  SortKeyData data;
+
+  data.type = get_fundamental_type (type);
+  data.order = order;
+
+  g_qsort_with_data (keys, n_keys, sizeof (GtkTreeDataSortKey),
+                     compare_sort_keys, &data);
+}
+
+void
+_gtk_tree_data_list_free_sort_keys (GtkTreeDataSortKey *keys,
+                                    guint               n_keys,
+                                    GType               type)
+{
+  guint i;
+
+  if (get_fundamental_type (type) == G_TYPE_STRING)
+    {
+      for (i = 0; i < n_keys; i++)
+        g_free (keys[i].value.v_string);
+    }
+
+  g_free (keys);
+}
+
 
 GList *
 _gtk_tree_data_list_header_new (gint   n_columns,
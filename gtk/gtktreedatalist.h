@@ -41,6 +41,18 @@ struct _GtkTreeDataList
   } data;
 };
 
+typedef struct _GtkTreeDataSortKey
+{
+  gpointer row;
+  gint     index;
+  union {
+    gint64   v_int64;
+    guint64  v_uint64;
+    gdouble  v_double;
+    gchar   *v_string;
+  } value;
+} GtkTreeDataSortKey;
+
 typedef struct _GtkTreeDataSortHeader
 {
   gint sort_column_id;
@@ -67,6 +79,19 @@ gint                   _gtk_tree_data_list_compare_func (GtkTreeModel *model,
 							 GtkTreeIter  *a,
 							 GtkTreeIter  *b,
 							 gpointer      user_data);
+gboolean               _gtk_tree_data_list_has_sort_key   (GType               type);
+void                   _gtk_tree_data_list_set_sort_key   (GtkTreeDataSortKey *key,
+                                                           GtkTreeModel       *model,
+                                                           GtkTreeIter        *iter,
+                                                           gint                column,
+                                                           GType               type);
+void                   _gtk_tree_data_list_sort_keys      (GtkTreeDataSortKey *keys,
+                                                           guint               n_keys,
+                                                           GType               type,
+                                                           GtkSortType         order);
+void                   _gtk_tree_data_list_free_sort_keys (GtkTreeDataSortKey *keys,
+                                                           guint               n_keys,
+                                                           GType               type);
 GList *                _gtk_tree_data_list_header_new  (gint          n_columns,
 							GType        *types);
 void                   _gtk_tree_data_list_header_free (GList        *header_list);
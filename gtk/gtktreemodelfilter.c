@@ -21,6 +21,7 @@
 #include "gtkintl.h"
 #include "gtktreednd.h"
 #include "gtkprivate.h"
+#include "gtkbitmaskprivate.h"
 #include <string.h>
 
 
@@ -4246,6 +4247,91 @@ gtk_tree_model_filter_refilter_helper (GtkTreeModel *model,
   return FALSE;
 }
 
+/* For flat child models without a virtual root, all rows live in the
+ * root level, so there is no need to go through the generic row-changed
+ * handler (and its path conversions) for every row.  Visibility is
+ * evaluated for all rows first and collected in a bitmask; afterwards
+ * only rows for which something needs to be done are visited.
+ */
+static void
+gtk_tree_model_filter_refilter_list (GtkTreeModelFilter *filter)
+{
+  GtkTreeModel *c_model = filter->priv->child_model;
+  GtkBitmask *requested;
+  GtkTreeIter c_iter;
+  gint i, n_rows;
+
+  requested = _gtk_bitmask_new ();
+  n_rows = 0;
+
+  if (gtk_tree_model_get_iter_first (c_model, &c_iter))
+    {
+      do
+        {
+          if (gtk_tree_model_filter_visible (filter, &c_iter))
+            requested = _gtk_bitmask_set (requested, n_rows, TRUE);
+          n_rows++;
+        }
+      while (gtk_tree_model_iter_next (c_model, &c_iter));
+    }
+
+  for (i = 0; i < n_rows; i++)
+    {
+      FilterLevel *level;
+      FilterElt *elt = NULL;
+      gboolean requested_state;
+      gboolean current_state;
+
+      /* The root level can be freed or built by the operations below,
+       * so look it up again for every row.
+       */
+      level = FILTER_LEVEL (filter->priv->root);
+      if (level)
+        elt = lookup_elt_with_offset (level->seq, i, NULL);
+
+      requested_state = _gtk_bitmask_get (requested, i);
+      current_state = elt && elt->visible_siter;
+
+      if (current_state == FALSE && requested_state == FALSE)
+        continue;
+
+      if (current_state == TRUE && requested_state == FALSE)
+        {
+          gtk_tree_model_filter_remove_elt_from_level (filter, level, elt);
+        }
+      else if (current_state == TRUE && requested_state == TRUE)
+        {
+          if (level->ext_ref_count > 0)
+            {
+              GtkTreeIter iter;
+              GtkTreePath *path;
+
+              iter.stamp = filter->priv->stamp;
+              iter.user_data = level;
+              iter.user_data2 = elt;
+
+              path = gtk_tree_model_get_path (GTK_TREE_MODEL (filter), &iter);
+              gtk_tree_model_row_changed (GTK_TREE_MODEL (filter), path, &iter);
+              gtk_tree_path_free (path);
+            }
+        }
+      else
+        {
+          GtkTreePath *c_path;
+
+          if (!gtk_tree_model_iter_nth_child (c_model, &c_iter, NULL, i))
+            break;
+
+          c_path = gtk_tree_path_new_from_indices (i, -1);
+          gtk_tree_model_filter_emit_row_inserted_for_path (filter, c_model,
+                                                            c_path, &c_iter);
+          gtk_tree_path_free (c_path);
+        }
+    }
+
+  _gtk_bitmask_free (requested);
+}
+
 /**
  * gtk_tree_model_filter_refilter:
  * @filter: A #GtkTreeModelFilter.
@@ -4260,6 +4346,14 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
 {
   g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
 
+  if (filter->priv->child_model &&
+      !filter->priv->virtual_root &&
+      (filter->priv->child_flags & GTK_TREE_MODEL_LIST_ONLY))
+    {
+      gtk_tree_model_filter_refilter_list (filter);
+      return;
+    }
+
   /* S L O W */
   gtk_tree_model_foreach (filter->priv->child_model,
                           gtk_tree_model_filter_refilter_helper,
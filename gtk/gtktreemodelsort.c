@@ -1884,6 +1884,66 @@ gtk_tree_model_sort_offset_compare_func (gconstpointer a,
   return retval;
 }
 
+/* When sorting by a column of the child model with the default sort
+ * function, the values are fetched once per row and sorted as keys,
+ * which avoids fetching and collating two values for each comparison.
+ */
+static gboolean
+gtk_tree_model_sort_sort_level_by_key (GtkTreeModelSort *tree_model_sort,
+                                       SortLevel        *level,
+                                       SortData         *data)
+{
+  GtkTreeModelSortPrivate *priv = tree_model_sort->priv;
+  GtkTreeDataSortKey *keys;
+  GSequenceIter *siter, *end_siter;
+  GtkTreeIter child_iter;
+  gint column, n_rows, i;
+  GType type;
+
+  if (data->sort_func != _gtk_tree_data_list_compare_func)
+    return FALSE;
+
+  column = GPOINTER_TO_INT (data->sort_data);
+  type = gtk_tree_model_get_column_type (priv->child_model, column);
+  if (!_gtk_tree_data_list_has_sort_key (type))
+    return FALSE;
+
+  n_rows = g_sequence_get_length (level->seq);
+  keys = g_new (GtkTreeDataSortKey, n_rows);
+
+  i = 0;
+  end_siter = g_sequence_get_end_iter (level->seq);
+  for (siter = g_sequence_get_begin_iter (level->seq);
+       siter != end_siter;
+       siter = g_sequence_iter_next (siter))
+    {
+      SortElt *elt = g_sequence_get (siter);
+
+      if (GTK_TREE_MODEL_SORT_CACHE_CHILD_ITERS (tree_model_sort))
+        child_iter = elt->iter;
+      else
+        {
+          data->parent_path_indices [data->parent_path_depth-1] = elt->offset;
+          gtk_tree_model_get_iter (priv->child_model, &child_iter, data->parent_path);
+        }
+
+      keys[i].row = siter;
+      keys[i].index = i;
+      _gtk_tree_data_list_set_sort_key (&keys[i], priv->child_model,
+                                        &child_iter, column, type);
+      i++;
+    }
+
+  _gtk_tree_data_list_sort_keys (keys, n_rows, type, priv->order);
+
+  for (i = 0; i < n_rows; i++)
+    g_sequence_move (keys[i].row, end_siter);
+
+  _gtk_tree_data_list_free_sort_keys (keys, n_rows, type);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
 				SortLevel        *level,
@@ -1932,7 +1992,7 @@ gtk_tree_model_sort_sort_level (GtkTreeModelSort *tree_model_sort,
   if (data.sort_func == NO_SORT_FUNC)
     g_sequence_sort (level->seq, gtk_tree_model_sort_offset_compare_func,
                      &data);
-  else
+  else if (!gtk_tree_model_sort_sort_level_by_key (tree_model_sort, level, &data))
     g_sequence_sort (level->seq, gtk_tree_model_sort_compare_func, &data);
 
   free_sort_data (&data);
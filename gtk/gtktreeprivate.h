@@ -136,6 +136,10 @@ gboolean          _gtk_tree_view_column_cell_get_dirty   (GtkTreeViewColumn  *tr
 void              _gtk_tree_view_column_push_padding          (GtkTreeViewColumn  *column,
 							       gint                padding);
 gint              _gtk_tree_view_column_get_requested_width   (GtkTreeViewColumn  *column);
+gboolean          _gtk_tree_view_column_sample_row            (GtkTreeViewColumn  *column,
+                                                               gboolean            visible);
+void              _gtk_tree_view_column_cell_get_height       (GtkTreeViewColumn  *column,
+                                                               gint               *height);
 gint              _gtk_tree_view_column_get_drag_x            (GtkTreeViewColumn  *column);
 GtkCellAreaContext *_gtk_tree_view_column_get_context         (GtkTreeViewColumn  *column);
 gboolean         _gtk_tree_view_column_coords_in_resize_rect  (GtkTreeViewColumn *column,
@@ -75,6 +75,11 @@ struct _GtkTreeStorePrivate
   gpointer default_sort_data;
   GDestroyNotify default_sort_destroy;
   guint columns_dirty : 1;
+
+  /* bulk loading */
+  gint bulk_load;
+  GHashTable *pending_nodes;   /* topmost rows whose insertion is not announced yet */
+  GHashTable *pending_parents; /* all ancestors of pending_nodes */
 };
 
 
@@ -483,6 +488,8 @@ gtk_tree_store_finalize (GObject *object)
   g_node_destroy (priv->root);
   _gtk_tree_data_list_header_free (priv->sort_list);
   g_free (priv->column_headers);
+  g_clear_pointer (&priv->pending_nodes, g_hash_table_unref);
+  g_clear_pointer (&priv->pending_parents, g_hash_table_unref);
 
   if (priv->default_sort_destroy)
     {
@@ -834,6 +841,183 @@ gtk_tree_store_iter_parent (GtkTreeModel *tree_model,
 }
 
 
+/* Bulk loading
+ *
+ * Between gtk_tree_store_begin_bulk_load() and gtk_tree_store_end_bulk_load()
+ * no signals are emitted for newly inserted rows.  Only the topmost new
+ * rows are remembered; their insertion is announced in tree order when the
+ * bulk load ends, or as soon as any other change makes it necessary for
+ * clients to know about them.  Rows below a new row are not announced at
+ * all: they can only be seen by clients after the new row itself has been
+ * announced, at which point they are regular children.
+ */
+static gboolean
+gtk_tree_store_node_is_pending (GtkTreeStore *tree_store,
+                                GNode        *node)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+
+  if (priv->pending_nodes == NULL)
+    return FALSE;
+
+  for (; node != NULL; node = node->parent)
+    {
+      if (g_hash_table_contains (priv->pending_nodes, node))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_tree_store_emit_pending_level (GtkTreeStore *tree_store,
+                                   GNode        *parent,
+                                   GtkTreePath  *path,
+                                   GHashTable   *pending_nodes,
+                                   GHashTable   *pending_parents)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GtkTreeIter iter;
+  GNode *node;
+  gboolean has_known_children = FALSE;
+
+  /* Children that are not pending have been announced already */
+  for (node = parent->children; node != NULL; node = node->next)
+    {
+      if (!g_hash_table_contains (pending_nodes, node))
+        {
+          has_known_children = TRUE;
+          break;
+        }
+    }
+
+  iter.stamp = priv->stamp;
+
+  gtk_tree_path_append_index (path, 0);
+
+  for (node = parent->children; node != NULL; node = node->next)
+    {
+      if (g_hash_table_contains (pending_nodes, node))
+        {
+          iter.user_data = node;
+          gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, &iter);
+
+          if (!has_known_children && parent != priv->root)
+            {
+              GtkTreePath *parent_path;
+
+              parent_path = gtk_tree_path_copy (path);
+              gtk_tree_path_up (parent_path);
+
+              iter.user_data = parent;
+              gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store),
+                                                    parent_path, &iter);
+              gtk_tree_path_free (parent_path);
+
+              has_known_children = TRUE;
+            }
+        }
+      else if (g_hash_table_contains (pending_parents, node))
+        {
+          gtk_tree_store_emit_pending_level (tree_store, node, path,
+                                             pending_nodes, pending_parents);
+        }
+
+      gtk_tree_path_next (path);
+    }
+
+  gtk_tree_path_up (path);
+}
+
+static void
+gtk_tree_store_flush_pending (GtkTreeStore *tree_store)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GHashTable *pending_nodes;
+  GHashTable *pending_parents;
+  GtkTreePath *path;
+
+  if (priv->pending_nodes == NULL ||
+      g_hash_table_size (priv->pending_nodes) == 0)
+    return;
+
+  /* Everything is announced from here on, even if handlers insert
+   * further rows while we are emitting.
+   */
+  pending_nodes = priv->pending_nodes;
+  pending_parents = priv->pending_parents;
+  priv->pending_nodes = g_hash_table_new (NULL, NULL);
+  priv->pending_parents = g_hash_table_new (NULL, NULL);
+
+  path = gtk_tree_path_new ();
+  gtk_tree_store_emit_pending_level (tree_store, priv->root, path,
+                                     pending_nodes, pending_parents);
+  gtk_tree_path_free (path);
+
+  g_hash_table_unref (pending_nodes);
+  g_hash_table_unref (pending_parents);
+}
+
+/* Returns whether a signal needs to be emitted for a change to @node.
+ * If so, all pending insertions are announced first, so that the
+ * path of @node is meaningful to clients.
+ */
+static gboolean
+gtk_tree_store_should_emit (GtkTreeStore *tree_store,
+                            GNode        *node)
+{
+  if (gtk_tree_store_node_is_pending (tree_store, node))
+    return FALSE;
+
+  gtk_tree_store_flush_pending (tree_store);
+
+  return TRUE;
+}
+
+static void
+gtk_tree_store_emit_row_inserted (GtkTreeStore *tree_store,
+                                  GtkTreeIter  *iter)
+{
+  GtkTreeStorePrivate *priv = tree_store->priv;
+  GNode *node = iter->user_data;
+  GNode *parent_node = node->parent;
+  GtkTreePath *path;
+
+  if (priv->bulk_load > 0)
+    {
+      GNode *ancestor;
+
+      if (gtk_tree_store_node_is_pending (tree_store, parent_node))
+        return;
+
+      g_hash_table_add (priv->pending_nodes, node);
+
+      for (ancestor = parent_node;
+           ancestor != NULL && !g_hash_table_contains (priv->pending_parents, ancestor);
+           ancestor = ancestor->parent)
+        g_hash_table_add (priv->pending_parents, ancestor);
+
+      return;
+    }
+
+  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
+  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
+
+  if (parent_node != priv->root &&
+      node->prev == NULL && node->next == NULL)
+    {
+      GtkTreeIter parent_iter;
+
+      parent_iter.stamp = priv->stamp;
+      parent_iter.user_data = parent_node;
+
+      gtk_tree_path_up (path);
+      gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, &parent_iter);
+    }
+
+  gtk_tree_path_free (path);
+}
+
 /* Does not emit a signal */
 static gboolean
 gtk_tree_store_real_set_value (GtkTreeStore *tree_store,
@@ -954,7 +1138,8 @@ gtk_tree_store_set_value (GtkTreeStore *tree_store,
   g_return_if_fail (column >= 0 && column < tree_store->priv->n_columns);
   g_return_if_fail (G_IS_VALUE (value));
 
-  if (gtk_tree_store_real_set_value (tree_store, iter, column, value, TRUE))
+  if (gtk_tree_store_real_set_value (tree_store, iter, column, value, TRUE) &&
+      gtk_tree_store_should_emit (tree_store, iter->user_data))
     {
       GtkTreePath *path;
 
@@ -1113,7 +1298,7 @@ gtk_tree_store_set_valuesv (GtkTreeStore *tree_store,
   if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, TRUE);
 
-  if (emit_signal)
+  if (emit_signal && gtk_tree_store_should_emit (tree_store, iter->user_data))
     {
       GtkTreePath *path;
 
@@ -1153,7 +1338,7 @@ gtk_tree_store_set_valist (GtkTreeStore *tree_store,
   if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, TRUE);
 
-  if (emit_signal)
+  if (emit_signal && gtk_tree_store_should_emit (tree_store, iter->user_data))
     {
       GtkTreePath *path;
 
@@ -1220,6 +1405,19 @@ gtk_tree_store_remove (GtkTreeStore *tree_store,
   g_assert (parent != NULL);
   next_node = G_NODE (iter->user_data)->next;
 
+  if (!gtk_tree_store_should_emit (tree_store, iter->user_data))
+    {
+      /* Nobody knows about this row yet */
+      g_hash_table_remove (priv->pending_nodes, iter->user_data);
+
+      if (G_NODE (iter->user_data)->data)
+        g_node_traverse (G_NODE (iter->user_data), G_POST_ORDER, G_TRAVERSE_ALL,
+                         -1, node_free, priv->column_headers);
+      g_node_destroy (G_NODE (iter->user_data));
+
+      goto out;
+    }
+
   if (G_NODE (iter->user_data)->data)
     g_node_traverse (G_NODE (iter->user_data), G_POST_ORDER, G_TRAVERSE_ALL,
 		     -1, node_free, priv->column_headers);
@@ -1243,6 +1441,7 @@ gtk_tree_store_remove (GtkTreeStore *tree_store,
     }
   gtk_tree_path_free (path);
 
+ out:
   /* revalidate iter */
   if (next_node != NULL)
     {
@@ -1282,7 +1481,6 @@ gtk_tree_store_insert (GtkTreeStore *tree_store,
 		       gint          position)
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
-  GtkTreePath *path;
   GNode *parent_node;
   GNode *new_node;
 
@@ -1304,19 +1502,7 @@ gtk_tree_store_insert (GtkTreeStore *tree_store,
   iter->user_data = new_node;
   g_node_insert (parent_node, position, new_node);
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-  if (parent_node != priv->root)
-    {
-      if (new_node->prev == NULL && new_node->next == NULL)
-        {
-          gtk_tree_path_up (path);
-          gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
-        }
-    }
-
-  gtk_tree_path_free (path);
+  gtk_tree_store_emit_row_inserted (tree_store, iter);
 
   validate_tree ((GtkTreeStore*)tree_store);
 }
@@ -1346,7 +1532,6 @@ gtk_tree_store_insert_before (GtkTreeStore *tree_store,
 			      GtkTreeIter  *sibling)
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
-  GtkTreePath *path;
   GNode *parent_node = NULL;
   GNode *new_node;
 
@@ -1380,24 +1565,7 @@ gtk_tree_store_insert_before (GtkTreeStore *tree_store,
   iter->stamp = priv->stamp;
   iter->user_data = new_node;
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-  if (parent_node != priv->root)
-    {
-      if (new_node->prev == NULL && new_node->next == NULL)
-        {
-          GtkTreeIter parent_iter;
-
-          parent_iter.stamp = priv->stamp;
-          parent_iter.user_data = parent_node;
-
-          gtk_tree_path_up (path);
-          gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, &parent_iter);
-        }
-    }
-
-  gtk_tree_path_free (path);
+  gtk_tree_store_emit_row_inserted (tree_store, iter);
 
   validate_tree (tree_store);
 }
@@ -1427,7 +1595,6 @@ gtk_tree_store_insert_after (GtkTreeStore *tree_store,
 			     GtkTreeIter  *sibling)
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
-  GtkTreePath *path;
   GNode *parent_node;
   GNode *new_node;
 
@@ -1462,24 +1629,7 @@ gtk_tree_store_insert_after (GtkTreeStore *tree_store,
   iter->stamp = priv->stamp;
   iter->user_data = new_node;
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-  if (parent_node != priv->root)
-    {
-      if (new_node->prev == NULL && new_node->next == NULL)
-        {
-          GtkTreeIter parent_iter;
-
-          parent_iter.stamp = priv->stamp;
-          parent_iter.user_data = parent_node;
-
-          gtk_tree_path_up (path);
-          gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, &parent_iter);
-        }
-    }
-
-  gtk_tree_path_free (path);
+  gtk_tree_store_emit_row_inserted (tree_store, iter);
 
   validate_tree (tree_store);
 }
@@ -1521,7 +1671,6 @@ gtk_tree_store_insert_with_values (GtkTreeStore *tree_store,
 				   ...)
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
-  GtkTreePath *path;
   GNode *parent_node;
   GNode *new_node;
   GtkTreeIter tmp_iter;
@@ -1559,19 +1708,7 @@ gtk_tree_store_insert_with_values (GtkTreeStore *tree_store,
   if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, FALSE);
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-  if (parent_node != priv->root)
-    {
-      if (new_node->prev == NULL && new_node->next == NULL)
-        {
-	  gtk_tree_path_up (path);
-	  gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
-	}
-    }
-
-  gtk_tree_path_free (path);
+  gtk_tree_store_emit_row_inserted (tree_store, iter);
 
   validate_tree ((GtkTreeStore *)tree_store);
 }
@@ -1602,7 +1739,6 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
 				    gint          n_values)
 {
   GtkTreeStorePrivate *priv = tree_store->priv;
-  GtkTreePath *path;
   GNode *parent_node;
   GNode *new_node;
   GtkTreeIter tmp_iter;
@@ -1637,19 +1773,7 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
   if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
     gtk_tree_store_sort_iter_changed (tree_store, iter, priv->sort_column_id, FALSE);
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-  gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-  if (parent_node != priv->root)
-    {
-      if (new_node->prev == NULL && new_node->next == NULL)
-        {
-	  gtk_tree_path_up (path);
-	  gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
-	}
-    }
-
-  gtk_tree_path_free (path);
+  gtk_tree_store_emit_row_inserted (tree_store, iter);
 
   validate_tree ((GtkTreeStore *)tree_store);
 }
@@ -1688,22 +1812,12 @@ gtk_tree_store_prepend (GtkTreeStore *tree_store,
 
   if (parent_node->children == NULL)
     {
-      GtkTreePath *path;
-      
       iter->stamp = priv->stamp;
       iter->user_data = g_node_new (NULL);
 
       g_node_prepend (parent_node, G_NODE (iter->user_data));
 
-      path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-      gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-      if (parent_node != priv->root)
-	{
-	  gtk_tree_path_up (path);
-	  gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
-	}
-      gtk_tree_path_free (path);
+      gtk_tree_store_emit_row_inserted (tree_store, iter);
     }
   else
     {
@@ -1747,22 +1861,12 @@ gtk_tree_store_append (GtkTreeStore *tree_store,
 
   if (parent_node->children == NULL)
     {
-      GtkTreePath *path;
-
       iter->stamp = priv->stamp;
       iter->user_data = g_node_new (NULL);
 
       g_node_append (parent_node, G_NODE (iter->user_data));
 
-      path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), iter);
-      gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, iter);
-
-      if (parent_node != priv->root)
-	{
-	  gtk_tree_path_up (path);
-	  gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
-	}
-      gtk_tree_path_free (path);
+      gtk_tree_store_emit_row_inserted (tree_store, iter);
     }
   else
     {
@@ -1884,6 +1988,71 @@ gtk_tree_store_clear (GtkTreeStore *tree_store)
   gtk_tree_store_increment_stamp (tree_store);
 }
 
+/**
+ * gtk_tree_store_begin_bulk_load:
+ * @tree_store: a #GtkTreeStore
+ *
+ * Starts adding a large number of rows to @tree_store.
+ *
+ * Until the matching call to gtk_tree_store_end_bulk_load(), rows
+ * inserted into @tree_store are not announced to clients one by one.
+ * Instead, when the bulk load ends, #GtkTreeModel::row-inserted is
+ * emitted once for each new row whose parent existed before, and rows
+ * below it are picked up by clients when they look at that row. Setting
+ * values on rows inserted this way does not emit any signals either.
+ *
+ * Other changes to the store are still possible during a bulk load,
+ * but they cause the rows inserted so far to be announced first.
+ *
+ * Calls to this function can be nested.
+ *
+ * Since: 3.94
+ */
+void
+gtk_tree_store_begin_bulk_load (GtkTreeStore *tree_store)
+{
+  GtkTreeStorePrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_STORE (tree_store));
+
+  priv = tree_store->priv;
+
+  if (priv->bulk_load++ == 0)
+    {
+      priv->pending_nodes = g_hash_table_new (NULL, NULL);
+      priv->pending_parents = g_hash_table_new (NULL, NULL);
+    }
+}
+
+/**
+ * gtk_tree_store_end_bulk_load:
+ * @tree_store: a #GtkTreeStore
+ *
+ * Ends a bulk load started with gtk_tree_store_begin_bulk_load(),
+ * and emits the signals for all rows that were inserted in the meantime.
+ *
+ * Since: 3.94
+ */
+void
+gtk_tree_store_end_bulk_load (GtkTreeStore *tree_store)
+{
+  GtkTreeStorePrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_STORE (tree_store));
+
+  priv = tree_store->priv;
+
+  g_return_if_fail (priv->bulk_load > 0);
+
+  if (--priv->bulk_load > 0)
+    return;
+
+  gtk_tree_store_flush_pending (tree_store);
+
+  g_clear_pointer (&priv->pending_nodes, g_hash_table_unref);
+  g_clear_pointer (&priv->pending_parents, g_hash_table_unref);
+}
+
 static gboolean
 gtk_tree_store_iter_is_valid_helper (GtkTreeIter *iter,
 				     GNode       *first)
@@ -2020,9 +2189,12 @@ copy_node_data (GtkTreeStore *tree_store,
 
   G_NODE (dest_iter->user_data)->data = copy_head;
 
-  path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), dest_iter);
-  gtk_tree_model_row_changed (GTK_TREE_MODEL (tree_store), path, dest_iter);
-  gtk_tree_path_free (path);
+  if (gtk_tree_store_should_emit (tree_store, dest_iter->user_data))
+    {
+      path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), dest_iter);
+      gtk_tree_model_row_changed (GTK_TREE_MODEL (tree_store), path, dest_iter);
+      gtk_tree_path_free (path);
+    }
 }
 
 static void
@@ -2279,6 +2451,8 @@ gtk_tree_store_reorder (GtkTreeStore *tree_store,
   g_return_if_fail (parent == NULL || VALID_ITER (parent, tree_store));
   g_return_if_fail (new_order != NULL);
 
+  gtk_tree_store_flush_pending (tree_store);
+
   if (!parent)
     level = G_NODE (tree_store->priv->root)->children;
   else
@@ -2367,6 +2541,8 @@ gtk_tree_store_swap (GtkTreeStore *tree_store,
   g_return_if_fail (VALID_ITER (a, tree_store));
   g_return_if_fail (VALID_ITER (b, tree_store));
 
+  gtk_tree_store_flush_pending (tree_store);
+
   node_a = G_NODE (a->user_data);
   node_b = G_NODE (b->user_data);
 
@@ -2507,6 +2683,8 @@ gtk_tree_store_move (GtkTreeStore *tree_store,
   if (position)
     g_return_if_fail (VALID_ITER (position, tree_store));
 
+  gtk_tree_store_flush_pending (tree_store);
+
   a = b = NULL;
 
   /* sanity checks */
@@ -2989,6 +3167,8 @@ gtk_tree_store_sort (GtkTreeStore *tree_store)
   if (!GTK_TREE_STORE_IS_SORTED (tree_store))
     return;
 
+  gtk_tree_store_flush_pending (tree_store);
+
   if (priv->sort_column_id != -1)
     {
       GtkTreeDataSortHeader *header = NULL;
@@ -3032,6 +3212,9 @@ gtk_tree_store_sort_iter_changed (GtkTreeStore *tree_store,
 
   g_return_if_fail (G_NODE (iter->user_data)->parent != NULL);
 
+  if (emit_signal && !gtk_tree_store_should_emit (tree_store, iter->user_data))
+    emit_signal = FALSE;
+
   tmp_iter.stamp = priv->stamp;
   if (priv->sort_column_id != -1)
     {
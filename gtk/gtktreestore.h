@@ -144,6 +144,10 @@ gint          gtk_tree_store_iter_depth       (GtkTreeStore *tree_store,
 					       GtkTreeIter  *iter);
 GDK_AVAILABLE_IN_ALL
 void          gtk_tree_store_clear            (GtkTreeStore *tree_store);
+GDK_AVAILABLE_IN_3_94
+void          gtk_tree_store_begin_bulk_load  (GtkTreeStore *tree_store);
+GDK_AVAILABLE_IN_3_94
+void          gtk_tree_store_end_bulk_load    (GtkTreeStore *tree_store);
 GDK_AVAILABLE_IN_ALL
 gboolean      gtk_tree_store_iter_is_valid    (GtkTreeStore *tree_store,
                                                GtkTreeIter  *iter);
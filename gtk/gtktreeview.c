@@ -247,7 +247,7 @@ typedef enum {
 #define GTK_TREE_VIEW_PRIORITY_VALIDATE (GDK_PRIORITY_REDRAW + 5)
 #define GTK_TREE_VIEW_PRIORITY_SCROLL_SYNC (GTK_TREE_VIEW_PRIORITY_VALIDATE + 2)
 /* 3/5 of gdkframeclockidle.c's FRAME_INTERVAL (16667 microsecs) */
-#define GTK_TREE_VIEW_TIME_MS_PER_IDLE 10
+#define GTK_TREE_VIEW_TIME_MS_PER_FRAME 10
 #define SCROLL_EDGE_SIZE 15
 #define GTK_TREE_VIEW_SEARCH_DIALOG_TIMEOUT 5000
 #define AUTO_EXPAND_TIMEOUT 500
@@ -329,9 +329,13 @@ struct _GtkTreeViewPrivate
   /* we cache it for simplicity of the code */
   gint dy;
 
-  guint validate_rows_timer;
+  guint validate_rows_tick_cb;
   guint scroll_sync_timer;
 
+  /* Time spent validating rows in the current frame, in microseconds */
+  gint64 validate_frame;
+  gint64 validate_time_used;
+
   /* Indentation and expander layout */
   GtkTreeViewColumn *expander_column;
 
@@ -441,6 +445,13 @@ struct _GtkTreeViewPrivate
   gulong search_entry_changed_id;
   guint typeselect_flush_timeout;
 
+  /* Sorted keys of the search column, for flat models using the
+   * default search equal func; plus the matches of the last lookup.
+   */
+  GArray *search_index;
+  gchar *search_index_key;
+  GArray *search_index_matches;
+
   /* Grid and tree lines */
   GtkTreeViewGridLines grid_lines;
   double grid_line_dashes[2];
@@ -468,6 +479,7 @@ struct _GtkTreeViewPrivate
 
   guint fixed_height_mode : 1;
   guint fixed_height_check : 1;
+  guint validating_visible_area : 1;
 
   guint activate_on_single_click : 1;
   guint reorderable : 1;
@@ -692,9 +704,10 @@ static gboolean validate_row             (GtkTreeView *tree_view,
 					  GtkTreeIter *iter,
 					  GtkTreePath *path);
 static void     validate_visible_area    (GtkTreeView *tree_view);
+static gint64   get_validate_budget      (GtkTreeView *tree_view);
 static gboolean do_validate_rows         (GtkTreeView *tree_view,
-					  gboolean     queue_resize);
-static gboolean validate_rows            (GtkTreeView *tree_view);
+					  gboolean     queue_resize,
+					  gint64       budget);
 static void     install_presize_handler  (GtkTreeView *tree_view);
 static void     install_scroll_sync_handler (GtkTreeView *tree_view);
 static void     gtk_tree_view_set_top_row   (GtkTreeView *tree_view,
@@ -839,6 +852,10 @@ static gboolean gtk_tree_view_search_iter               (GtkTreeModel     *model
 							 gint              n);
 static void     gtk_tree_view_search_init               (GtkWidget        *entry,
 							 GtkTreeView      *tree_view);
+static gboolean gtk_tree_view_search_nth                (GtkTreeView      *tree_view,
+							 const gchar      *text,
+							 gint              n);
+static void     gtk_tree_view_search_index_clear        (GtkTreeView      *tree_view);
 static void     gtk_tree_view_put                       (GtkTreeView      *tree_view,
 							 GtkWidget        *child_widget,
                                                          GtkTreePath      *path,
@@ -2035,6 +2052,7 @@ gtk_tree_view_destroy (GtkWidget *widget)
 
   gtk_tree_view_stop_editing (tree_view, TRUE);
   gtk_tree_view_stop_rubber_band (tree_view);
+  gtk_tree_view_search_index_clear (tree_view);
 
   if (tree_view->priv->columns != NULL)
     {
@@ -2258,10 +2276,10 @@ gtk_tree_view_unrealize (GtkWidget *widget)
       priv->presize_handler_tick_cb = 0;
     }
 
-  if (priv->validate_rows_timer != 0)
+  if (priv->validate_rows_tick_cb != 0)
     {
-      g_source_remove (priv->validate_rows_timer);
-      priv->validate_rows_timer = 0;
+      gtk_widget_remove_tick_callback (widget, priv->validate_rows_tick_cb);
+      priv->validate_rows_tick_cb = 0;
     }
 
   if (priv->scroll_sync_timer != 0)
@@ -2344,7 +2362,7 @@ gtk_tree_view_measure (GtkWidget        *widget,
       /* we validate some rows initially just to make sure we have some size.
        * In practice, with a lot of static lists, this should get a good width.
        */
-      do_validate_rows (tree_view, FALSE);
+      do_validate_rows (tree_view, FALSE, get_validate_budget (tree_view));
 
       /* keep this in sync with size_allocate below */
       for (list = tree_view->priv->columns; list; list = list->next)
@@ -5966,9 +5984,12 @@ validate_row (GtkTreeView *tree_view,
       gtk_tree_view_column_cell_set_cell_data (column, tree_view->priv->model, iter,
 					       GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
 					       node->children?TRUE:FALSE);
-      gtk_tree_view_column_cell_get_size (column,
-					  NULL, NULL, NULL,
-					  NULL, &row_height);
+      if (_gtk_tree_view_column_sample_row (column, tree_view->priv->validating_visible_area))
+        gtk_tree_view_column_cell_get_size (column,
+                                            NULL, NULL, NULL,
+                                            NULL, &row_height);
+      else
+        _gtk_tree_view_column_cell_get_height (column, &row_height);
 
       if (is_separator)
         {
@@ -6050,6 +6071,8 @@ validate_visible_area (GtkTreeView *tree_view)
   if (total_height == 0)
     return;
 
+  tree_view->priv->validating_visible_area = TRUE;
+
   /* First, we check to see if we need to scroll anywhere
    */
   if (tree_view->priv->scroll_to_path)
@@ -6389,6 +6412,8 @@ validate_visible_area (GtkTreeView *tree_view)
     }
   if (need_redraw)
     gtk_widget_queue_draw (GTK_WIDGET (tree_view));
+
+  tree_view->priv->validating_visible_area = FALSE;
 }
 
 static void
@@ -6422,14 +6447,43 @@ initialize_fixed_height_mode (GtkTreeView *tree_view)
                                  tree_view->priv->fixed_height, TRUE);
 }
 
+/* Rows are validated from a tick callback and while measuring, possibly
+ * several times per frame. All of these share one budget per frame, so
+ * that no frame spends more than GTK_TREE_VIEW_TIME_MS_PER_FRAME on it.
+ */
+static gint64
+get_validate_budget (GtkTreeView *tree_view)
+{
+  GdkFrameClock *frame_clock;
+  gint64 frame;
+
+  frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (tree_view));
+  if (frame_clock == NULL)
+    return GTK_TREE_VIEW_TIME_MS_PER_FRAME * 1000;
+
+  frame = gdk_frame_clock_get_frame_counter (frame_clock);
+  if (frame != tree_view->priv->validate_frame)
+    {
+      tree_view->priv->validate_frame = frame;
+      tree_view->priv->validate_time_used = 0;
+    }
+
+  return GTK_TREE_VIEW_TIME_MS_PER_FRAME * 1000 - tree_view->priv->validate_time_used;
+}
+
 /* Our strategy for finding nodes to validate is a little convoluted.  We find
  * the left-most uninvalidated node.  We then try walking right, validating
  * nodes.  Once we find a valid node, we repeat the previous process of finding
  * the first invalid node.
+ *
+ * Validation stops once @budget microseconds have passed. Returns %TRUE
+ * if there are rows left to validate.
  */
 
 static gboolean
-do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
+do_validate_rows (GtkTreeView *tree_view,
+                  gboolean     queue_resize,
+                  gint64       budget)
 {
   static gboolean prevent_recursion_hack = FALSE;
 
@@ -6439,7 +6493,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   gint retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
+  gint64 start_time;
   gint i = 0;
 
   gint y = -1;
@@ -6463,8 +6517,10 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  if (budget <= 0)
+    return GTK_RBNODE_FLAG_SET (tree_view->priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID);
+
+  start_time = g_get_monotonic_time ();
 
   do
     {
@@ -6553,7 +6609,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () - start_time < budget);
 
   if (!tree_view->priv->fixed_height_check)
    {
@@ -6612,7 +6668,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
+  tree_view->priv->validate_time_used += g_get_monotonic_time () - start_time;
 
   if (!retval && gtk_widget_get_mapped (GTK_WIDGET (tree_view)))
     update_prelight (tree_view,
@@ -6634,7 +6690,7 @@ static void
 maybe_reenable_adjustment_animation (GtkTreeView *tree_view)
 {
   if (tree_view->priv->presize_handler_tick_cb != 0 ||
-      tree_view->priv->validate_rows_timer != 0)
+      tree_view->priv->validate_rows_tick_cb != 0)
     return;
 
   gtk_adjustment_enable_animation (tree_view->priv->vadjustment,
@@ -6687,27 +6743,34 @@ presize_handler_callback (GtkWidget     *widget,
   return G_SOURCE_REMOVE;
 }
 
+/* The visible area and the scroll target are validated first, the
+ * rest of the frame's budget goes to the rows out of view, so the
+ * size and the scrollbars converge a bit with every frame.
+ */
 static gboolean
-validate_rows (GtkTreeView *tree_view)
+validate_rows_tick (GtkWidget     *widget,
+                    GdkFrameClock *clock,
+                    gpointer       unused)
 {
-  gboolean retval;
-  
+  GtkTreeView *tree_view = GTK_TREE_VIEW (widget);
+
   if (tree_view->priv->presize_handler_tick_cb)
     {
+      gint64 start_time;
+
+      get_validate_budget (tree_view);
+      start_time = g_get_monotonic_time ();
       do_presize_handler (tree_view);
-      return G_SOURCE_CONTINUE;
+      tree_view->priv->validate_time_used += g_get_monotonic_time () - start_time;
     }
 
-  retval = do_validate_rows (tree_view, TRUE);
-  
-  if (! retval && tree_view->priv->validate_rows_timer)
-    {
-      g_source_remove (tree_view->priv->validate_rows_timer);
-      tree_view->priv->validate_rows_timer = 0;
-      maybe_reenable_adjustment_animation (tree_view);
-    }
+  if (do_validate_rows (tree_view, TRUE, get_validate_budget (tree_view)))
+    return G_SOURCE_CONTINUE;
 
-  return retval;
+  tree_view->priv->validate_rows_tick_cb = 0;
+  maybe_reenable_adjustment_animation (tree_view);
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -6723,11 +6786,10 @@ install_presize_handler (GtkTreeView *tree_view)
       tree_view->priv->presize_handler_tick_cb =
 	gtk_widget_add_tick_callback (GTK_WIDGET (tree_view), presize_handler_callback, NULL, NULL);
     }
-  if (! tree_view->priv->validate_rows_timer)
+  if (! tree_view->priv->validate_rows_tick_cb)
     {
-      tree_view->priv->validate_rows_timer =
-	gdk_threads_add_idle_full (GTK_TREE_VIEW_PRIORITY_VALIDATE, (GSourceFunc) validate_rows, tree_view, NULL);
-      g_source_set_name_by_id (tree_view->priv->validate_rows_timer, "[gtk+] validate_rows");
+      tree_view->priv->validate_rows_tick_cb =
+	gtk_widget_add_tick_callback (GTK_WIDGET (tree_view), validate_rows_tick, NULL, NULL);
     }
 }
 
@@ -6882,8 +6944,8 @@ _gtk_tree_view_install_mark_rows_col_dirty (GtkTreeView *tree_view,
 }
 
 /*
- * This function works synchronously (due to the while (validate_rows...)
- * loop).
+ * This function works synchronously (it validates all rows without
+ * a time budget).
  *
  * There was a check for column_type != GTK_TREE_VIEW_COLUMN_AUTOSIZE
  * here. You now need to check that yourself.
@@ -6898,7 +6960,7 @@ _gtk_tree_view_column_autosize (GtkTreeView *tree_view,
   _gtk_tree_view_column_cell_set_dirty (column, FALSE);
 
   do_presize_handler (tree_view);
-  while (validate_rows (tree_view));
+  do_validate_rows (tree_view, TRUE, G_MAXINT64);
 
   gtk_widget_queue_resize (GTK_WIDGET (tree_view));
 }
@@ -8522,6 +8584,8 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL || iter != NULL);
 
+  gtk_tree_view_search_index_clear (tree_view);
+
   if (tree_view->priv->cursor_node != NULL)
     cursor_path = _gtk_tree_path_new_from_rbtree (tree_view->priv->cursor_tree,
                                                   tree_view->priv->cursor_node);
@@ -8606,6 +8670,8 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL || iter != NULL);
 
+  gtk_tree_view_search_index_clear (tree_view);
+
   if (tree_view->priv->fixed_height_mode
       && tree_view->priv->fixed_height >= 0)
     height = tree_view->priv->fixed_height;
@@ -8809,6 +8875,8 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
 
   g_return_if_fail (path != NULL);
 
+  gtk_tree_view_search_index_clear (tree_view);
+
   gtk_tree_row_reference_deleted (G_OBJECT (data), path);
 
   if (_gtk_tree_view_find_node (tree_view, path, &tree, &node))
@@ -8933,6 +9001,8 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
   GtkRBNode *node;
   gint len;
 
+  gtk_tree_view_search_index_clear (tree_view);
+
   len = gtk_tree_model_iter_n_children (model, iter);
 
   if (len < 2)
@@ -10945,6 +11015,8 @@ gtk_tree_view_set_model (GtkTreeView  *tree_view,
   if (tree_view->priv->rubber_band_status)
     gtk_tree_view_stop_rubber_band (tree_view);
 
+  gtk_tree_view_search_index_clear (tree_view);
+
   if (tree_view->priv->model)
     {
       GList *tmplist = tree_view->priv->columns;
@@ -12181,6 +12253,14 @@ gtk_tree_view_real_expand_row (GtkTreeView *tree_view,
 			    gtk_tree_path_get_depth (path) + 1,
 			    open_all);
 
+  /* Until they are validated, assume the new rows are as high as their
+   * parent, so that the scrollbars don't have to catch up with a large
+   * number of rows one validation chunk at a time.
+   */
+  if (tree_view->priv->fixed_height < 0 &&
+      !GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID))
+    _gtk_rbtree_set_fixed_height (node->children, GTK_RBNODE_GET_HEIGHT (node), FALSE);
+
   _gtk_tree_view_accessible_add (tree_view, node->children, NULL);
   _gtk_tree_view_accessible_add_state (tree_view,
                                        tree, node,
@@ -14102,6 +14182,7 @@ gtk_tree_view_set_search_column (GtkTreeView *tree_view,
     return;
 
   tree_view->priv->search_column = column;
+  gtk_tree_view_search_index_clear (tree_view);
   g_object_notify_by_pspec (G_OBJECT (tree_view), tree_view_props[PROP_SEARCH_COLUMN]);
 }
 
@@ -14150,6 +14231,8 @@ gtk_tree_view_set_search_equal_func (GtkTreeView                *tree_view,
   tree_view->priv->search_destroy = search_destroy;
   if (tree_view->priv->search_equal_func == NULL)
     tree_view->priv->search_equal_func = gtk_tree_view_search_equal_func;
+
+  gtk_tree_view_search_index_clear (tree_view);
 }
 
 /**
@@ -14578,7 +14661,6 @@ gtk_tree_view_search_move (GtkWidget   *window,
 {
   gboolean ret;
   gint len;
-  gint count = 0;
   const gchar *text;
   GtkTreeIter iter;
   GtkTreeModel *model;
@@ -14604,8 +14686,8 @@ gtk_tree_view_search_move (GtkWidget   *window,
   if (!gtk_tree_model_get_iter_first (model, &iter))
     return TRUE;
 
-  ret = gtk_tree_view_search_iter (model, selection, &iter, text,
-				   &count, up?((tree_view->priv->selected_iter) - 1):((tree_view->priv->selected_iter + 1)));
+  ret = gtk_tree_view_search_nth (tree_view, text,
+                                  up?((tree_view->priv->selected_iter) - 1):((tree_view->priv->selected_iter + 1)));
 
   if (ret)
     {
@@ -14616,11 +14698,7 @@ gtk_tree_view_search_move (GtkWidget   *window,
   else
     {
       /* return to old iter */
-      count = 0;
-      gtk_tree_model_get_iter_first (model, &iter);
-      gtk_tree_view_search_iter (model, selection,
-				 &iter, text,
-				 &count, tree_view->priv->selected_iter);
+      gtk_tree_view_search_nth (tree_view, text, tree_view->priv->selected_iter);
       return FALSE;
     }
 }
@@ -14786,12 +14864,236 @@ gtk_tree_view_search_iter (GtkTreeModel     *model,
   return FALSE;
 }
 
+/* Search index
+ *
+ * With the default search equal func, a row matches if its normalized,
+ * casefolded string is prefixed by the normalized, casefolded key.  For
+ * flat models, we keep these strings sorted, so all matches for a key are
+ * found with a binary search instead of running the equal func on every
+ * row for every keystroke.  The index is built on first use and dropped
+ * whenever the model changes.
+ */
+typedef struct
+{
+  gchar *key;
+  gint row;
+} SearchIndexEntry;
+
+static gchar *
+gtk_tree_view_search_normalize (const gchar *str)
+{
+  gchar *normalized;
+  gchar *casefolded;
+
+  normalized = g_utf8_normalize (str, -1, G_NORMALIZE_ALL);
+  if (normalized == NULL)
+    return NULL;
+
+  casefolded = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return casefolded;
+}
+
+static void
+search_index_entry_clear (gpointer data)
+{
+  SearchIndexEntry *entry = data;
+
+  g_free (entry->key);
+}
+
+static gint
+search_index_entry_compare (gconstpointer a,
+                            gconstpointer b)
+{
+  const SearchIndexEntry *entry_a = a;
+  const SearchIndexEntry *entry_b = b;
+  gint result;
+
+  result = strcmp (entry_a->key, entry_b->key);
+  if (result == 0)
+    result = entry_a->row - entry_b->row;
+
+  return result;
+}
+
+static gint
+compare_ints (gconstpointer a,
+              gconstpointer b)
+{
+  return *(const gint *) a - *(const gint *) b;
+}
+
+static void
+gtk_tree_view_search_index_clear (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+
+  g_clear_pointer (&priv->search_index, g_array_unref);
+  g_clear_pointer (&priv->search_index_matches, g_array_unref);
+  g_clear_pointer (&priv->search_index_key, g_free);
+}
+
+static gboolean
+gtk_tree_view_search_can_use_index (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+
+  return priv->model != NULL &&
+         priv->search_column >= 0 &&
+         priv->search_equal_func == gtk_tree_view_search_equal_func &&
+         (gtk_tree_model_get_flags (priv->model) & GTK_TREE_MODEL_LIST_ONLY);
+}
+
+static void
+gtk_tree_view_search_index_build (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  GtkTreeIter iter;
+  gint row = 0;
+
+  priv->search_index = g_array_new (FALSE, FALSE, sizeof (SearchIndexEntry));
+  g_array_set_clear_func (priv->search_index, search_index_entry_clear);
+
+  if (!gtk_tree_model_get_iter_first (priv->model, &iter))
+    return;
+
+  do
+    {
+      GValue value = G_VALUE_INIT;
+      GValue transformed = G_VALUE_INIT;
+      SearchIndexEntry entry;
+
+      gtk_tree_model_get_value (priv->model, &iter, priv->search_column, &value);
+      g_value_init (&transformed, G_TYPE_STRING);
+
+      if (g_value_transform (&value, &transformed) &&
+          g_value_get_string (&transformed) != NULL)
+        {
+          entry.key = gtk_tree_view_search_normalize (g_value_get_string (&transformed));
+          entry.row = row;
+
+          if (entry.key)
+            g_array_append_val (priv->search_index, entry);
+        }
+
+      g_value_unset (&transformed);
+      g_value_unset (&value);
+      row++;
+    }
+  while (gtk_tree_model_iter_next (priv->model, &iter));
+
+  g_array_sort (priv->search_index, search_index_entry_compare);
+}
+
+/* Returns the rows matching @text, in model order */
+static GArray *
+gtk_tree_view_search_index_lookup (GtkTreeView *tree_view,
+                                   const gchar *text)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  SearchIndexEntry *entries;
+  gchar *key;
+  gsize key_len;
+  guint lo, hi;
+
+  key = gtk_tree_view_search_normalize (text);
+
+  if (priv->search_index_matches &&
+      g_strcmp0 (key, priv->search_index_key) == 0)
+    {
+      g_free (key);
+      return priv->search_index_matches;
+    }
+
+  g_clear_pointer (&priv->search_index_matches, g_array_unref);
+  g_free (priv->search_index_key);
+  priv->search_index_key = key;
+  priv->search_index_matches = g_array_new (FALSE, FALSE, sizeof (gint));
+
+  if (key == NULL)
+    return priv->search_index_matches;
+
+  if (priv->search_index == NULL)
+    gtk_tree_view_search_index_build (tree_view);
+
+  entries = (SearchIndexEntry *) priv->search_index->data;
+  key_len = strlen (key);
+
+  /* find the first key that is not smaller than @key; all keys
+   * that @key is a prefix of follow it.
+   */
+  lo = 0;
+  hi = priv->search_index->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (strcmp (entries[mid].key, key) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (; lo < priv->search_index->len; lo++)
+    {
+      if (strncmp (entries[lo].key, key, key_len) != 0)
+        break;
+
+      g_array_append_val (priv->search_index_matches, entries[lo].row);
+    }
+
+  g_array_sort (priv->search_index_matches, compare_ints);
+
+  return priv->search_index_matches;
+}
+
+/* Selects the @n-th row matching @text, counting from 1 */
+static gboolean
+gtk_tree_view_search_nth (GtkTreeView *tree_view,
+                          const gchar *text,
+                          gint         n)
+{
+  GtkTreeModel *model = tree_view->priv->model;
+  GtkTreeSelection *selection = tree_view->priv->selection;
+  GtkTreePath *path;
+  GtkTreeIter iter;
+  GArray *matches;
+  gint count = 0;
+
+  if (!gtk_tree_view_search_can_use_index (tree_view))
+    {
+      if (!gtk_tree_model_get_iter_first (model, &iter))
+        return FALSE;
+
+      return gtk_tree_view_search_iter (model, selection, &iter, text, &count, n);
+    }
+
+  matches = gtk_tree_view_search_index_lookup (tree_view, text);
+  if (n < 1 || (guint) n > matches->len)
+    return FALSE;
+
+  path = gtk_tree_path_new_from_indices (g_array_index (matches, gint, n - 1), -1);
+  if (!gtk_tree_model_get_iter (model, &iter, path))
+    {
+      gtk_tree_path_free (path);
+      return FALSE;
+    }
+
+  gtk_tree_view_scroll_to_cell (tree_view, path, NULL, TRUE, 0.5, 0.0);
+  gtk_tree_selection_select_iter (selection, &iter);
+  gtk_tree_view_real_set_cursor (tree_view, path, CLAMP_NODE);
+  gtk_tree_path_free (path);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_view_search_init (GtkWidget   *entry,
 			   GtkTreeView *tree_view)
 {
   gint ret;
-  gint count = 0;
   const gchar *text;
   GtkTreeIter iter;
   GtkTreeModel *model;
@@ -14824,9 +15126,7 @@ gtk_tree_view_search_init (GtkWidget   *entry,
   if (!gtk_tree_model_get_iter_first (model, &iter))
     return;
 
-  ret = gtk_tree_view_search_iter (model, selection,
-				   &iter, text,
-				   &count, 1);
+  ret = gtk_tree_view_search_nth (tree_view, text, 1);
 
   if (ret)
     tree_view->priv->selected_iter = 1;
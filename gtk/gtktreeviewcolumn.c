@@ -144,6 +144,10 @@ struct _GtkTreeViewColumnPrivate
   gint min_width;
   gint max_width;
 
+  /* GTK_TREE_VIEW_COLUMN_SAMPLED */
+  gint n_sampled_rows;
+  gint sampled_width;
+
   /* dragging columns */
   gint drag_x;
   gint drag_y;
@@ -1965,6 +1969,33 @@ gtk_tree_view_column_get_x_offset (GtkTreeViewColumn *tree_column)
   return tree_column->priv->x_offset;
 }
 
+/* GTK_TREE_VIEW_COLUMN_SAMPLED measures the first rows, the visible
+ * ones and one in SAMPLED_RANDOM_RATE of the others.
+ */
+#define SAMPLED_FIRST_ROWS 100
+#define SAMPLED_RANDOM_RATE 32
+#define SAMPLED_WIDTH_HEADROOM 8
+
+/* Sampled columns grow by an extra eighth of their width, so that the
+ * next slightly wider sample does not resize the column right away.
+ */
+static gint
+gtk_tree_view_column_get_context_width (GtkTreeViewColumn *tree_column)
+{
+  GtkTreeViewColumnPrivate *priv = tree_column->priv;
+  gint width;
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &width, NULL);
+
+  if (priv->column_type != GTK_TREE_VIEW_COLUMN_SAMPLED)
+    return width;
+
+  if (width > priv->sampled_width)
+    priv->sampled_width = width + width / SAMPLED_WIDTH_HEADROOM;
+
+  return priv->sampled_width;
+}
+
 gint
 _gtk_tree_view_column_request_width (GtkTreeViewColumn *tree_column)
 {
@@ -1982,7 +2013,7 @@ _gtk_tree_view_column_request_width (GtkTreeViewColumn *tree_column)
       gint button_request;
       gint requested_width;
 
-      gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &requested_width, NULL);
+      requested_width = gtk_tree_view_column_get_context_width (tree_column);
       requested_width += priv->padding;
 
       gtk_widget_measure (priv->button, GTK_ORIENTATION_HORIZONTAL, -1,
@@ -1993,7 +2024,7 @@ _gtk_tree_view_column_request_width (GtkTreeViewColumn *tree_column)
     {
       gint requested_width;
 
-      gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &requested_width, NULL);
+      requested_width = gtk_tree_view_column_get_context_width (tree_column);
       requested_width += priv->padding;
 
       real_requested_width = requested_width;
@@ -2910,6 +2941,8 @@ _gtk_tree_view_column_cell_set_dirty (GtkTreeViewColumn *tree_column,
   priv->dirty = TRUE;
   priv->padding = 0;
   priv->width = 0;
+  priv->n_sampled_rows = 0;
+  priv->sampled_width = 0;
 
   /* Issue a manual reset on the context to have all
    * sizes re-requested for the context.
@@ -3053,11 +3086,55 @@ _gtk_tree_view_column_push_padding (GtkTreeViewColumn  *column,
 gint
 _gtk_tree_view_column_get_requested_width (GtkTreeViewColumn  *column)
 {
-  gint requested_width;
+  return gtk_tree_view_column_get_context_width (column) + column->priv->padding;
+}
 
-  gtk_cell_area_context_get_preferred_width (column->priv->cell_area_context, &requested_width, NULL);
+/* Returns whether the width of the cells in a row needs to be measured
+ * for @column, or if gtk_tree_view_column_cell_get_height() is enough.
+ */
+gboolean
+_gtk_tree_view_column_sample_row (GtkTreeViewColumn *column,
+                                  gboolean           visible)
+{
+  GtkTreeViewColumnPrivate *priv = column->priv;
 
-  return requested_width + column->priv->padding;
+  if (priv->column_type != GTK_TREE_VIEW_COLUMN_SAMPLED)
+    return TRUE;
+
+  if (!visible &&
+      priv->n_sampled_rows >= SAMPLED_FIRST_ROWS &&
+      g_random_int_range (0, SAMPLED_RANDOM_RATE) != 0)
+    return FALSE;
+
+  priv->n_sampled_rows++;
+
+  return TRUE;
+}
+
+/* Like gtk_tree_view_column_cell_get_size(), but only measures the
+ * height for the current width of the column, without making it wider.
+ */
+void
+_gtk_tree_view_column_cell_get_height (GtkTreeViewColumn *column,
+                                       gint              *height)
+{
+  GtkTreeViewColumnPrivate *priv = column->priv;
+  gint min_width;
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &min_width, NULL);
+
+  g_signal_handler_block (priv->cell_area_context,
+			  priv->context_changed_signal);
+
+  gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
+                                                priv->cell_area_context,
+                                                priv->tree_view,
+                                                min_width,
+                                                height,
+                                                NULL);
+
+  g_signal_handler_unblock (priv->cell_area_context,
+			    priv->context_changed_signal);
 }
 
 gint
@@ -47,6 +47,10 @@ typedef struct _GtkTreeViewColumnPrivate GtkTreeViewColumnPrivate;
  * @GTK_TREE_VIEW_COLUMN_GROW_ONLY: Columns only get bigger in reaction to changes in the model
  * @GTK_TREE_VIEW_COLUMN_AUTOSIZE: Columns resize to be the optimal size everytime the model changes.
  * @GTK_TREE_VIEW_COLUMN_FIXED: Columns are a fixed numbers of pixels wide.
+ * @GTK_TREE_VIEW_COLUMN_SAMPLED: Columns only get bigger, like with
+ *   @GTK_TREE_VIEW_COLUMN_GROW_ONLY, but their width is only measured for
+ *   the first and the visible rows and a random sample of the other rows.
+ *   Rows that are wider than all of the sampled rows get cut off. Since: 3.94
  *
  * The sizing method the column uses to determine its width.  Please note
  * that @GTK_TREE_VIEW_COLUMN_AUTOSIZE are inefficient for large views, and
@@ -56,7 +60,8 @@ typedef enum
 {
   GTK_TREE_VIEW_COLUMN_GROW_ONLY,
   GTK_TREE_VIEW_COLUMN_AUTOSIZE,
-  GTK_TREE_VIEW_COLUMN_FIXED
+  GTK_TREE_VIEW_COLUMN_FIXED,
+  GTK_TREE_VIEW_COLUMN_SAMPLED
 } GtkTreeViewColumnSizing;
 
 /**
@@ -31,7 +31,7 @@
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtkscrollable.h"
-#include "gtksnapshot.h"
+#include "gtksnapshotprivate.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
 
@@ -73,6 +73,14 @@ struct _GtkViewportPrivate
    * driving the scrollable adjustment values */
   guint hscroll_policy : 1;
   guint vscroll_policy : 1;
+
+  /* The last snapshot of the child, in the coordinates of the child.
+   * It covers content_area, which is larger than the visible part, so
+   * that scrolling only needs to move it. */
+  GskRenderNode  *content_node;
+  GtkWidget      *content_child;
+  GskRenderer    *content_renderer;
+  cairo_rectangle_int_t content_area;
 };
 
 enum {
@@ -94,6 +102,7 @@ static void gtk_viewport_get_property             (GObject         *object,
 						   GValue          *value,
 						   GParamSpec      *pspec);
 static void gtk_viewport_destroy                  (GtkWidget        *widget);
+static void gtk_viewport_unmap                    (GtkWidget        *widget);
 static void gtk_viewport_snapshot                 (GtkWidget        *widget,
 						   GtkSnapshot      *snapshot);
 static void gtk_viewport_size_allocate            (GtkWidget           *widget,
@@ -251,6 +260,7 @@ gtk_viewport_class_init (GtkViewportClass *class)
   gobject_class->get_property = gtk_viewport_get_property;
 
   widget_class->destroy = gtk_viewport_destroy;
+  widget_class->unmap = gtk_viewport_unmap;
   widget_class->snapshot = gtk_viewport_snapshot;
   widget_class->size_allocate = gtk_viewport_size_allocate;
   widget_class->measure = gtk_viewport_measure;
@@ -417,6 +427,16 @@ viewport_disconnect_adjustment (GtkViewport    *viewport,
     }
 }
 
+static void
+gtk_viewport_clear_content (GtkViewport *viewport)
+{
+  GtkViewportPrivate *priv = viewport->priv;
+
+  g_clear_pointer (&priv->content_node, gsk_render_node_unref);
+  priv->content_child = NULL;
+  priv->content_renderer = NULL;
+}
+
 static void
 gtk_viewport_destroy (GtkWidget *widget)
 {
@@ -424,10 +444,19 @@ gtk_viewport_destroy (GtkWidget *widget)
 
   viewport_disconnect_adjustment (viewport, GTK_ORIENTATION_HORIZONTAL);
   viewport_disconnect_adjustment (viewport, GTK_ORIENTATION_VERTICAL);
+  gtk_viewport_clear_content (viewport);
 
   GTK_WIDGET_CLASS (gtk_viewport_parent_class)->destroy (widget);
 }
 
+static void
+gtk_viewport_unmap (GtkWidget *widget)
+{
+  gtk_viewport_clear_content (GTK_VIEWPORT (widget));
+
+  GTK_WIDGET_CLASS (gtk_viewport_parent_class)->unmap (widget);
+}
+
 static void
 viewport_set_adjustment (GtkViewport    *viewport,
 			 GtkOrientation  orientation,
@@ -506,10 +535,112 @@ gtk_viewport_get_shadow_type (GtkViewport *viewport)
   return viewport->priv->shadow_type;
 }
 
+static gboolean
+rectangle_contains (const cairo_rectangle_int_t *outer,
+                    const cairo_rectangle_int_t *inner)
+{
+  return inner->x >= outer->x &&
+         inner->y >= outer->y &&
+         inner->x + inner->width <= outer->x + outer->width &&
+         inner->y + inner->height <= outer->y + outer->height;
+}
+
+/* Scrolling only moves the child, so we snapshot more of it than is
+ * visible and keep the node around. As long as nothing in the child
+ * changed and the visible part is still covered, a scroll is just
+ * a different translation of the same node. Otherwise, the children
+ * of the child keep offsets relative to it, so the ones that were
+ * snapshotted before reuse their nodes and only newly exposed parts
+ * get snapshotted.
+ */
+static void
+gtk_viewport_snapshot_child (GtkViewport *viewport,
+                             GtkWidget   *child,
+                             GtkSnapshot *snapshot)
+{
+  GtkViewportPrivate *priv = viewport->priv;
+  GtkWidget *widget = GTK_WIDGET (viewport);
+  GtkAllocation allocation, clip;
+  cairo_rectangle_int_t visible;
+  graphene_matrix_t transform;
+  GskRenderer *renderer;
+  int width, height;
+
+  if (!_gtk_widget_is_drawable (child))
+    return;
+
+  width = gtk_widget_get_width (widget);
+  height = gtk_widget_get_height (widget);
+  gtk_widget_get_allocation (child, &allocation);
+  gtk_widget_get_clip (child, &clip);
+  renderer = gtk_snapshot_get_renderer (snapshot);
+
+  /* Everything below is in the coordinates of the child */
+  clip.x -= allocation.x;
+  clip.y -= allocation.y;
+  visible.x = - allocation.x;
+  visible.y = - allocation.y;
+  visible.width = width;
+  visible.height = height;
+  if (!gdk_rectangle_intersect (&visible, &clip, &visible))
+    return;
+
+  graphene_matrix_init_translate (&transform,
+                                  &GRAPHENE_POINT3D_INIT (allocation.x, allocation.y, 0));
+  gtk_snapshot_push_transform (snapshot, &transform, "ViewportScroll");
+
+  if (snapshot->record_names ||
+      priv->content_node == NULL ||
+      priv->content_child != child ||
+      priv->content_renderer != renderer ||
+      gtk_widget_get_render_node_changed (child) ||
+      !rectangle_contains (&priv->content_area, &visible))
+    {
+      cairo_rectangle_int_t area;
+
+      area.x = visible.x - width;
+      area.y = visible.y - height;
+      area.width = visible.width + 2 * width;
+      area.height = visible.height + 2 * height;
+      gdk_rectangle_intersect (&area, &clip, &area);
+
+      gtk_viewport_clear_content (viewport);
+
+      /* The transform reset the offset and the clip, so the child ends
+       * up at the origin once the offset for its allocation is undone.
+       */
+      gtk_snapshot_push (snapshot, TRUE, NULL);
+      gtk_snapshot_push_clip (snapshot,
+                              &GRAPHENE_RECT_INIT (area.x, area.y, area.width, area.height),
+                              "ViewportContent");
+      gtk_snapshot_offset (snapshot, - allocation.x, - allocation.y);
+      gtk_widget_snapshot_child (widget, child, snapshot);
+      gtk_snapshot_offset (snapshot, allocation.x, allocation.y);
+      gtk_snapshot_pop (snapshot);
+      priv->content_node = gtk_snapshot_pop_collect (snapshot);
+
+      priv->content_child = child;
+      priv->content_renderer = renderer;
+      priv->content_area = area;
+      gtk_widget_reset_render_node_changed (child);
+    }
+
+  if (priv->content_node)
+    gtk_snapshot_append_node (snapshot, priv->content_node);
+
+  gtk_snapshot_pop (snapshot);
+
+  /* Nodes with names are only for the inspector, so don't keep them */
+  if (snapshot->record_names)
+    gtk_viewport_clear_content (viewport);
+}
+
 static void
 gtk_viewport_snapshot (GtkWidget   *widget,
                        GtkSnapshot *snapshot)
 {
+  GtkWidget *child;
+
   gtk_snapshot_push_clip (snapshot,
                           &GRAPHENE_RECT_INIT(
                             0, 0,
@@ -517,7 +648,9 @@ gtk_viewport_snapshot (GtkWidget   *widget,
                             gtk_widget_get_height (widget)),
                             "Viewport");
 
-  GTK_WIDGET_CLASS (gtk_viewport_parent_class)->snapshot (widget, snapshot);
+  child = gtk_bin_get_child (GTK_BIN (widget));
+  if (child)
+    gtk_viewport_snapshot_child (GTK_VIEWPORT (widget), child, snapshot);
 
   gtk_snapshot_pop (snapshot);
 }
@@ -30,6 +30,7 @@
 #include <math.h>
 
 #define GDK_COMPILATION
+#include "gdk/gdk-private.h"
 #include "gdk/gdkeventsprivate.h"
 
 #include <gobject/gvaluecollector.h>
@@ -74,9 +75,11 @@
 #include "gtkrenderbackgroundprivate.h"
 #include "gtkcssshadowsvalueprivate.h"
 #include "gtkdebugupdatesprivate.h"
+#include "gtkwidgettimesprivate.h"
 #include "gsk/gskdebugprivate.h"
 #include "gsk/gskrendererprivate.h"
 #include "gtkeventcontrollerlegacyprivate.h"
+#include "gtkeventcontrollerprivate.h"
 #include "gtkcssfontvariationsvalueprivate.h"
 
 #include "inspector/window.h"
@@ -696,6 +699,8 @@ static void gtk_widget_on_frame_clock_update (GdkFrameClock *frame_clock,
 static gboolean event_window_is_still_viewable (const GdkEvent *event);
 
 static void gtk_widget_update_input_shape (GtkWidget *widget);
+static void gtk_widget_clear_render_node (GtkWidget *widget);
+static void gtk_widget_invalidate_render_node (GtkWidget *widget);
 
 static gboolean gtk_widget_class_get_visible_by_default (GtkWidgetClass *widget_class);
 static void gtk_widget_set_clip (GtkWidget *widget, const GtkAllocation *clip);
@@ -888,25 +893,191 @@ gtk_widget_real_contains (GtkWidget *widget,
                                        &(graphene_point_t){x, y});
 }
 
+/* Widgets with many children, like big grids, keep a grid of buckets
+ * with the children whose clip overlaps each bucket, so picking doesn't
+ * need to look at every child. Nothing can be picked outside of a
+ * child's clip, so the buckets sort out all children that can't contain
+ * the point. The index is dropped whenever the children or their clips
+ * change and rebuilt on the next pick.
+ */
+#define PICK_INDEX_MIN_CHILDREN 64
+#define PICK_INDEX_MAX_BUCKETS  64
+
+typedef struct _GtkWidgetPickIndex GtkWidgetPickIndex;
+
+struct _GtkWidgetPickIndex
+{
+  GdkRectangle bounds;
+  int n_columns;
+  int n_rows;
+  int bucket_width;
+  int bucket_height;
+  GPtrArray *buckets[];
+};
+
+static void
+gtk_widget_pick_index_free (GtkWidgetPickIndex *index)
+{
+  int i;
+
+  for (i = 0; i < index->n_columns * index->n_rows; i++)
+    {
+      if (index->buckets[i])
+        g_ptr_array_unref (index->buckets[i]);
+    }
+
+  g_free (index);
+}
+
+static void
+gtk_widget_invalidate_pick_index (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (priv->pick_index)
+    {
+      gtk_widget_pick_index_free (priv->pick_index);
+      priv->pick_index = NULL;
+    }
+}
+
+static void
+gtk_widget_pick_index_get_bucket (GtkWidgetPickIndex *index,
+                                  int                 x,
+                                  int                 y,
+                                  int                *column,
+                                  int                *row)
+{
+  *column = CLAMP ((x - index->bounds.x) / index->bucket_width, 0, index->n_columns - 1);
+  *row = CLAMP ((y - index->bounds.y) / index->bucket_height, 0, index->n_rows - 1);
+}
+
+static GtkWidgetPickIndex *
+gtk_widget_pick_index_new (GtkWidget *widget)
+{
+  GtkWidgetPickIndex *index;
+  GtkWidget *child;
+  GdkRectangle bounds = { 0, 0, 0, 0 };
+  int n_children, side;
+
+  n_children = 0;
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      if (n_children == 0)
+        bounds = child->priv->clip;
+      else
+        gdk_rectangle_union (&bounds, &child->priv->clip, &bounds);
+      n_children++;
+    }
+
+  if (n_children < PICK_INDEX_MIN_CHILDREN ||
+      bounds.width <= 0 || bounds.height <= 0)
+    return NULL;
+
+  side = CLAMP ((int) ceil (sqrt (n_children)), 1, PICK_INDEX_MAX_BUCKETS);
+
+  index = g_malloc0 (sizeof (GtkWidgetPickIndex) + sizeof (GPtrArray *) * side * side);
+  index->bounds = bounds;
+  index->n_columns = side;
+  index->n_rows = side;
+  index->bucket_width = MAX (1, (bounds.width + side - 1) / side);
+  index->bucket_height = MAX (1, (bounds.height + side - 1) / side);
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      const GdkRectangle *clip = &child->priv->clip;
+      int x0, y0, x1, y1, column, row;
+
+      gtk_widget_pick_index_get_bucket (index, clip->x, clip->y, &x0, &y0);
+      gtk_widget_pick_index_get_bucket (index, clip->x + clip->width, clip->y + clip->height, &x1, &y1);
+
+      for (row = y0; row <= y1; row++)
+        for (column = x0; column <= x1; column++)
+          {
+            GPtrArray **bucket = &index->buckets[row * index->n_columns + column];
+
+            if (*bucket == NULL)
+              *bucket = g_ptr_array_new ();
+            g_ptr_array_add (*bucket, child);
+          }
+    }
+
+  return index;
+}
+
+static GtkWidget *
+gtk_widget_pick_child (GtkWidget *child,
+                       gdouble    x,
+                       gdouble    y)
+{
+  int dx, dy;
+
+  gtk_widget_get_origin_relative_to_parent (child, &dx, &dy);
+
+  return gtk_widget_pick (child, x - dx, y - dy);
+}
+
 static GtkWidget *
 gtk_widget_real_pick (GtkWidget *widget,
                       gdouble    x,
                       gdouble    y)
 {
+  GtkWidgetPrivate *priv = widget->priv;
   GtkWidget *child;
 
-  for (child = _gtk_widget_get_last_child (widget);
-       child;
-       child = _gtk_widget_get_prev_sibling (child))
+  if (priv->pick_index == NULL &&
+      priv->first_child != NULL && priv->first_child != priv->last_child)
+    priv->pick_index = gtk_widget_pick_index_new (widget);
+
+  if (priv->pick_index)
     {
-      GtkWidget *picked;
-      int dx, dy;
+      GtkWidgetPickIndex *index = priv->pick_index;
+
+      if (x >= index->bounds.x && x <= index->bounds.x + index->bounds.width &&
+          y >= index->bounds.y && y <= index->bounds.y + index->bounds.height)
+        {
+          GPtrArray *bucket;
+          int column, row;
+          int i;
 
-      gtk_widget_get_origin_relative_to_parent (child, &dx, &dy);
+          gtk_widget_pick_index_get_bucket (index, floor (x), floor (y), &column, &row);
+          bucket = index->buckets[row * index->n_columns + column];
+
+          /* Buckets are in sibling order, the last child is on top */
+          for (i = bucket ? (int) bucket->len - 1 : -1; i >= 0; i--)
+            {
+              GtkWidget *picked;
+              const GdkRectangle *clip;
+
+              child = g_ptr_array_index (bucket, i);
+              clip = &child->priv->clip;
+
+              if (x < clip->x || x > clip->x + clip->width ||
+                  y < clip->y || y > clip->y + clip->height)
+                continue;
+
+              picked = gtk_widget_pick_child (child, x, y);
+              if (picked)
+                return picked;
+            }
+        }
+    }
+  else
+    {
+      for (child = _gtk_widget_get_last_child (widget);
+           child;
+           child = _gtk_widget_get_prev_sibling (child))
+        {
+          GtkWidget *picked;
 
-      picked = gtk_widget_pick (child, x - dx, y - dy);
-      if (picked)
-        return picked;
+          picked = gtk_widget_pick_child (child, x, y);
+          if (picked)
+            return picked;
+        }
     }
 
   if (!gtk_widget_contains (widget, x, y))
@@ -3070,6 +3241,7 @@ gtk_widget_init (GTypeInstance *instance, gpointer g_class)
   priv->sensitive = TRUE;
   priv->alloc_needed = TRUE;
   priv->alloc_needed_on_child = TRUE;
+  priv->render_node_changed = TRUE;
   priv->focus_on_click = TRUE;
 #ifdef G_ENABLE_DEBUG
   priv->highlight_resize = FALSE;
@@ -3292,6 +3464,8 @@ gtk_widget_unparent (GtkWidget *widget)
    */
   priv->allocation.width = 0;
   priv->allocation.height = 0;
+  memset (&priv->allocated_size, 0, sizeof (priv->allocated_size));
+  priv->allocated_size_baseline = 0;
 
   if (_gtk_widget_get_realized (widget))
     gtk_widget_unrealize (widget);
@@ -3309,10 +3483,14 @@ gtk_widget_unparent (GtkWidget *widget)
    * in the next parent.
    */
   priv->child_visible = TRUE;
+  gtk_css_node_set_defer_validation (priv->cssnode, FALSE);
 
   old_parent = priv->parent;
   if (old_parent)
     {
+      gtk_widget_invalidate_render_node (old_parent);
+      gtk_widget_invalidate_pick_index (old_parent);
+
       if (old_parent->priv->first_child == widget)
         old_parent->priv->first_child = priv->next_sibling;
 
@@ -4141,6 +4319,54 @@ gtk_widget_queue_draw_area (GtkWidget *widget,
   cairo_region_destroy (region);
 }
 
+static void
+gtk_widget_clear_render_node (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+  g_clear_object (&priv->render_node_style);
+  priv->render_node_renderer = NULL;
+  priv->render_node_valid = FALSE;
+}
+
+/* The render node of a widget contains the ones of its children,
+ * so all ancestors need a new one, too.
+ */
+static void
+gtk_widget_invalidate_render_node (GtkWidget *widget)
+{
+  for (; widget != NULL; widget = _gtk_widget_get_parent (widget))
+    {
+      widget->priv->render_node_valid = FALSE;
+      widget->priv->render_node_changed = TRUE;
+    }
+}
+
+/*< private >
+ * gtk_widget_get_render_node_changed:
+ * @widget: a #GtkWidget
+ *
+ * Returns whether the rendering of @widget or one of its children
+ * may have changed since the last call to
+ * gtk_widget_reset_render_node_changed(). Containers that keep
+ * nodes of their children around, like #GtkViewport, use this to
+ * find out when they need to snapshot the children again.
+ *
+ * Returns: %TRUE if the rendering may have changed
+ */
+gboolean
+gtk_widget_get_render_node_changed (GtkWidget *widget)
+{
+  return widget->priv->render_node_changed;
+}
+
+void
+gtk_widget_reset_render_node_changed (GtkWidget *widget)
+{
+  widget->priv->render_node_changed = FALSE;
+}
+
 /**
  * gtk_widget_queue_draw:
  * @widget: a #GtkWidget
@@ -4156,6 +4382,8 @@ gtk_widget_queue_draw (GtkWidget *widget)
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  gtk_widget_invalidate_render_node (widget);
+
   parent = _gtk_widget_get_parent (widget);
   rect = &widget->priv->clip;
 
@@ -4283,6 +4511,136 @@ gtk_widget_queue_resize_no_redraw (GtkWidget *widget)
   gtk_widget_queue_resize_internal (widget);
 }
 
+/* Whether every size the parent can have been told about is still
+ * known exactly, so that re-measuring those for_sizes proves whether
+ * the request changed. Ranges only remember their end points and full
+ * caches may have dropped entries, so those can't be checked.
+ */
+static gboolean
+gtk_widget_request_is_checkable (GtkWidget *widget)
+{
+  SizeRequestCache *cache = &widget->priv->requests;
+  guint i;
+
+  if (!cache->flags[GTK_ORIENTATION_HORIZONTAL].cached_size_valid ||
+      !cache->flags[GTK_ORIENTATION_VERTICAL].cached_size_valid)
+    return FALSE;
+
+  if (cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests == GTK_SIZE_REQUEST_CACHED_SIZES ||
+      cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests == GTK_SIZE_REQUEST_CACHED_SIZES)
+    return FALSE;
+
+  for (i = 0; i < cache->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i++)
+    {
+      if (cache->requests_x[i]->lower_for_size != cache->requests_x[i]->upper_for_size)
+        return FALSE;
+    }
+
+  for (i = 0; i < cache->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i++)
+    {
+      if (cache->requests_y[i]->lower_for_size != cache->requests_y[i]->upper_for_size)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_widget_request_changed_for_size (GtkWidget        *widget,
+                                     SizeRequestCache *old,
+                                     GtkOrientation    orientation,
+                                     int               for_size)
+{
+  int old_min, old_nat, old_min_baseline, old_nat_baseline;
+  int min, nat, min_baseline, nat_baseline;
+
+  _gtk_size_request_cache_lookup (old, orientation, for_size,
+                                  &old_min, &old_nat,
+                                  &old_min_baseline, &old_nat_baseline);
+  gtk_widget_measure (widget, orientation, for_size,
+                      &min, &nat, &min_baseline, &nat_baseline);
+
+  return min != old_min || nat != old_nat ||
+         min_baseline != old_min_baseline || nat_baseline != old_nat_baseline;
+}
+
+/* Re-measures @widget for everything that was asked of it before and
+ * compares the results with the (now stale) cache in @old.
+ */
+static gboolean
+gtk_widget_request_changed (GtkWidget        *widget,
+                            SizeRequestCache *old)
+{
+  guint i;
+
+  if (old->request_mode_valid &&
+      gtk_widget_get_request_mode (widget) != old->request_mode)
+    return TRUE;
+
+  if (gtk_widget_request_changed_for_size (widget, old, GTK_ORIENTATION_HORIZONTAL, -1) ||
+      gtk_widget_request_changed_for_size (widget, old, GTK_ORIENTATION_VERTICAL, -1))
+    return TRUE;
+
+  for (i = 0; i < old->flags[GTK_ORIENTATION_HORIZONTAL].n_cached_requests; i++)
+    {
+      if (gtk_widget_request_changed_for_size (widget, old, GTK_ORIENTATION_HORIZONTAL,
+                                               old->requests_x[i]->lower_for_size))
+        return TRUE;
+    }
+
+  for (i = 0; i < old->flags[GTK_ORIENTATION_VERTICAL].n_cached_requests; i++)
+    {
+      if (gtk_widget_request_changed_for_size (widget, old, GTK_ORIENTATION_VERTICAL,
+                                               old->requests_y[i]->lower_for_size))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * gtk_widget_queue_resize_checked:
+ * @widget: a #GtkWidget
+ *
+ * Like gtk_widget_queue_resize(), but for changes to the content of
+ * @widget only. The widget is re-measured before its parent is
+ * measured next, and the resize only propagates to the parent if the
+ * size request actually changed. Otherwise @widget is just allocated
+ * again at its current size.
+ *
+ * Don't use this for changes that affect how the parent lays out
+ * @widget, like child properties or expand flags.
+ */
+void
+gtk_widget_queue_resize_checked (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  GtkWidget *w;
+
+  if (priv->resize_needed || priv->resize_check_needed)
+    return;
+
+  if (!priv->visible ||
+      priv->parent == NULL ||
+      priv->have_size_groups ||
+      priv->need_compute_expand ||
+      _gtk_widget_is_toplevel (widget) ||
+      !gtk_widget_request_is_checkable (widget))
+    {
+      gtk_widget_queue_resize (widget);
+      return;
+    }
+
+  if (_gtk_widget_get_realized (widget))
+    gtk_widget_queue_draw (widget);
+
+  priv->resize_check_needed = TRUE;
+  for (w = widget; w != NULL && !w->priv->resize_check_on_child; w = w->priv->parent)
+    w->priv->resize_check_on_child = TRUE;
+
+  gtk_widget_set_alloc_needed (widget);
+}
+
 /**
  * gtk_widget_get_frame_clock:
  * @widget: a #GtkWidget
@@ -4413,6 +4771,8 @@ gtk_widget_queue_draw_region (GtkWidget            *widget,
   if (cairo_region_is_empty (region))
     return;
 
+  gtk_widget_invalidate_render_node (widget);
+
   /* Just return if the widget isn't mapped */
   if (!_gtk_widget_get_mapped (widget))
     return;
@@ -4515,6 +4875,11 @@ gtk_widget_size_allocate (GtkWidget           *widget,
   GtkBorder margin, border, padding;
   GtkAllocation new_clip;
   GdkDisplay *display;
+  GtkWidgetTimesFrame times_frame = { NULL, 0, 0 };
+#ifdef G_ENABLE_DEBUG
+  gboolean verify_skip = FALSE;
+  GtkAllocation skipped_allocation, skipped_clip;
+#endif
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
   g_return_if_fail (baseline >= -1);
@@ -4571,6 +4936,30 @@ gtk_widget_size_allocate (GtkWidget           *widget,
   /* Preserve request/allocate ordering */
   priv->alloc_needed = FALSE;
 
+  /* Nothing in this widget changed and the parent hands out the same
+   * allocation as last time, so the outcome is known already. Children
+   * that queued an allocation are still taken care of below.
+   */
+  if (!alloc_needed &&
+      gdk_rectangle_equal (allocation, &priv->allocated_size) &&
+      baseline == priv->allocated_size_baseline)
+    {
+#ifdef G_ENABLE_DEBUG
+      if (GTK_DISPLAY_DEBUG_CHECK (display, ALLOCATE))
+        {
+          verify_skip = TRUE;
+          skipped_allocation = priv->allocation;
+          skipped_clip = priv->clip;
+          alloc_needed = TRUE;
+        }
+      else
+#endif
+        {
+          *out_clip = priv->clip;
+          goto out;
+        }
+    }
+
   old_clip = priv->clip;
   real_allocation = *allocation;
 
@@ -4709,6 +5098,9 @@ gtk_widget_size_allocate (GtkWidget           *widget,
                             margin.bottom + border.bottom + padding.bottom;
   new_clip = real_allocation;
 
+  if (gtk_widget_times_enabled ())
+    gtk_widget_times_begin (&times_frame);
+
   if (g_signal_has_handler_pending (widget, widget_signals[SIZE_ALLOCATE], 0, FALSE))
     g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0,
                    &real_allocation,
@@ -4720,6 +5112,9 @@ gtk_widget_size_allocate (GtkWidget           *widget,
                                                   baseline,
                                                   &new_clip);
 
+  if (times_frame.start != 0)
+    gtk_widget_times_end (&times_frame, widget, GTK_WIDGET_TIMES_ALLOCATE);
+
   /* Size allocation is god... after consulting god, no further requests or allocations are needed */
 #ifdef G_ENABLE_DEBUG
   if (GTK_DISPLAY_DEBUG_CHECK (display, GEOMETRY) && gtk_widget_get_resize_needed (widget))
@@ -4733,6 +5128,9 @@ gtk_widget_size_allocate (GtkWidget           *widget,
   gtk_widget_set_clip (widget, &priv->reported_clip);
   *out_clip = priv->clip;
 
+  /* The children may have moved */
+  gtk_widget_invalidate_render_node (widget);
+
   gtk_widget_ensure_resize (widget);
   priv->alloc_needed = FALSE;
   priv->alloc_needed_on_child = FALSE;
@@ -4760,6 +5158,21 @@ check_clip:
         }
     }
 
+#ifdef G_ENABLE_DEBUG
+  if (verify_skip &&
+      (!gdk_rectangle_equal (&skipped_allocation, &priv->allocation) ||
+       !gdk_rectangle_equal (&skipped_clip, &priv->clip)))
+    {
+      g_warning ("%s %p changed allocation from %d,%d %dx%d (clip %d,%d %dx%d) to %d,%d %dx%d (clip %d,%d %dx%d) "
+                 "without queueing an allocation",
+                 G_OBJECT_TYPE_NAME (widget), widget,
+                 skipped_allocation.x, skipped_allocation.y, skipped_allocation.width, skipped_allocation.height,
+                 skipped_clip.x, skipped_clip.y, skipped_clip.width, skipped_clip.height,
+                 priv->allocation.x, priv->allocation.y, priv->allocation.width, priv->allocation.height,
+                 priv->clip.x, priv->clip.y, priv->clip.width, priv->clip.height);
+    }
+#endif
+
 out:
   if (priv->alloc_needed_on_child)
     gtk_widget_ensure_allocate (widget);
@@ -5712,6 +6125,43 @@ _gtk_widget_set_captured_event_handler (GtkWidget               *widget,
   g_object_set_data (G_OBJECT (widget), I_("captured-event-handler"), callback);
 }
 
+void
+_gtk_widget_invalidate_controller_event_types (GtkWidget *widget)
+{
+  widget->priv->controller_event_types_valid = FALSE;
+}
+
+/* Whether any controller of @widget in @phase might handle @event */
+static gboolean
+gtk_widget_controllers_want_event (GtkWidget           *widget,
+                                   const GdkEvent      *event,
+                                   GtkPropagationPhase  phase)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (!priv->controller_event_types_valid)
+    {
+      GList *l;
+
+      memset (priv->controller_event_types, 0, sizeof (priv->controller_event_types));
+
+      for (l = priv->event_controllers; l; l = l->next)
+        {
+          EventControllerData *data = l->data;
+
+          if (data->controller == NULL)
+            continue;
+
+          priv->controller_event_types[gtk_event_controller_get_propagation_phase (data->controller)] |=
+            GTK_EVENT_CONTROLLER_GET_CLASS (data->controller)->event_types;
+        }
+
+      priv->controller_event_types_valid = TRUE;
+    }
+
+  return (priv->controller_event_types[phase] & GTK_EVENT_TYPE_BIT (event->any.type)) != 0;
+}
+
 static gboolean
 _gtk_widget_run_controllers (GtkWidget           *widget,
                              const GdkEvent      *event,
@@ -5722,6 +6172,9 @@ _gtk_widget_run_controllers (GtkWidget           *widget,
   GtkWidgetPrivate *priv;
   GList *l;
 
+  if (!gtk_widget_controllers_want_event (widget, event, phase))
+    return FALSE;
+
   priv = widget->priv;
   g_object_ref (widget);
 
@@ -5805,12 +6258,19 @@ _gtk_widget_captured_event (GtkWidget      *widget,
   if (!event_window_is_still_viewable (event))
     return TRUE;
 
+  handler = g_object_get_data (G_OBJECT (widget), I_("captured-event-handler"));
+
+  /* Most widgets on the path have nothing to do in the capture phase,
+   * don't bother copying the event for them.
+   */
+  if (!handler && !gtk_widget_controllers_want_event (widget, event, GTK_PHASE_CAPTURE))
+    return FALSE;
+
   event_copy = gdk_event_copy (event);
   translate_event_coordinates (event_copy, widget);
 
   return_val = _gtk_widget_run_controllers (widget, event_copy, GTK_PHASE_CAPTURE);
 
-  handler = g_object_get_data (G_OBJECT (widget), I_("captured-event-handler"));
   if (!handler)
     goto out;
 
@@ -7378,6 +7838,9 @@ gtk_widget_reposition_after (GtkWidget *widget,
   gtk_widget_push_verify_invariants (widget);
 
   priv->parent = parent;
+  priv->render_node_changed = TRUE;
+  gtk_widget_invalidate_render_node (parent);
+  gtk_widget_invalidate_pick_index (parent);
 
   if (previous_sibling)
     {
@@ -8286,6 +8749,11 @@ gtk_widget_set_child_visible (GtkWidget *widget,
   g_object_ref (widget);
   gtk_widget_verify_invariants (widget);
 
+  /* There's no need to keep the styles of hidden children up to date,
+   * they are computed when shown or when something asks for them.
+   */
+  gtk_css_node_set_defer_validation (priv->cssnode, !is_visible);
+
   if (is_visible)
     priv->child_visible = TRUE;
   else
@@ -8334,6 +8802,45 @@ gtk_widget_get_child_visible (GtkWidget *widget)
   return widget->priv->child_visible;
 }
 
+static void
+gtk_widget_prewarm_css_node (GtkCssNode *cssnode)
+{
+  GtkCssNode *child;
+
+  gtk_css_node_get_style (cssnode);
+
+  for (child = gtk_css_node_get_first_child (cssnode);
+       child != NULL;
+       child = gtk_css_node_get_next_sibling (child))
+    {
+      if (gtk_css_node_get_visible (child))
+        gtk_widget_prewarm_css_node (child);
+    }
+}
+
+/**
+ * gtk_widget_prewarm:
+ * @widget: a #GtkWidget
+ *
+ * Computes the styles of @widget and all its children right away.
+ *
+ * GTK+ does not keep the styles of children that are not
+ * child-visible up to date, like the pages of a #GtkStack
+ * that are not shown, and only updates them when they become
+ * visible. If showing such a child would cause a noticeable
+ * delay, this function can be used to do that work ahead of time,
+ * for example while the application is idle.
+ *
+ * Since: 3.94
+ **/
+void
+gtk_widget_prewarm (GtkWidget *widget)
+{
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  gtk_widget_prewarm_css_node (widget->priv->cssnode);
+}
+
 void
 _gtk_widget_scale_changed (GtkWidget *widget)
 {
@@ -9222,6 +9729,9 @@ gtk_widget_finalize (GObject *object)
 
   gtk_grab_remove (widget);
 
+  gtk_widget_clear_render_node (widget);
+  gtk_widget_invalidate_pick_index (widget);
+
   g_free (priv->name);
 
   g_clear_object (&priv->accessible);
@@ -9381,6 +9891,8 @@ gtk_widget_real_unrealize (GtkWidget *widget)
 
   gtk_widget_forall (widget, (GtkCallback)gtk_widget_unrealize, NULL);
 
+  gtk_widget_clear_render_node (widget);
+
   if (_gtk_widget_get_has_window (widget))
     {
       gtk_widget_unregister_window (widget, priv->window);
@@ -12000,7 +12512,7 @@ gtk_widget_set_clip (GtkWidget           *widget,
   GtkBorder shadow;
   GtkBorder margin;
   GtkCssStyle *style;
-  GdkRectangle new_clip;
+  GdkRectangle new_clip, old_clip;
   GtkAllocation allocation;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
@@ -12024,12 +12536,17 @@ gtk_widget_set_clip (GtkWidget           *widget,
   allocation.width -= margin.left + margin.right;
   allocation.height -= margin.top + margin.bottom;
 
+  old_clip = priv->clip;
+
   gdk_rectangle_union (&allocation, &new_clip, &priv->clip);
   priv->clip.x -= shadow.left;
   priv->clip.y -= shadow.top;
   priv->clip.width += shadow.left + shadow.right;
   priv->clip.height += shadow.top + shadow.bottom;
 
+  if (priv->parent && !gdk_rectangle_equal (&old_clip, &priv->clip))
+    gtk_widget_invalidate_pick_index (priv->parent);
+
 #ifdef G_ENABLE_DEBUG
   if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), GEOMETRY))
     {
@@ -12724,6 +13241,7 @@ gtk_widget_ensure_allocate (GtkWidget *widget)
   if (!gtk_widget_needs_allocate (widget))
     return;
 
+  gtk_widget_ensure_resize_checks (widget);
   gtk_widget_ensure_resize (widget);
 
   /*  This code assumes that we only reach here if the previous
@@ -12767,6 +13285,67 @@ gtk_widget_ensure_resize (GtkWidget *widget)
   _gtk_size_request_cache_clear (&priv->requests);
 }
 
+#ifdef G_ENABLE_DEBUG
+static guint resize_checks_contained = 0;
+static guint resize_checks_propagated = 0;
+#endif
+
+/* Resolves all gtk_widget_queue_resize_checked() calls below @widget,
+ * turning them into real resizes where the request changed. This must
+ * happen before @widget uses any cached sizes for its children.
+ */
+void
+gtk_widget_ensure_resize_checks (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  GtkWidget *child;
+
+  if (!priv->resize_check_on_child)
+    return;
+
+  priv->resize_check_on_child = FALSE;
+
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      gtk_widget_ensure_resize_checks (child);
+    }
+
+  if (!priv->resize_check_needed)
+    return;
+
+  priv->resize_check_needed = FALSE;
+
+  if (!priv->resize_needed)
+    {
+      SizeRequestCache old;
+      gboolean changed;
+
+      old = priv->requests;
+      _gtk_size_request_cache_init (&priv->requests);
+      changed = gtk_widget_request_changed (widget, &old);
+      _gtk_size_request_cache_free (&old);
+
+#ifdef G_ENABLE_DEBUG
+      if (changed)
+        resize_checks_propagated++;
+      else
+        resize_checks_contained++;
+
+      GTK_DISPLAY_NOTE (gtk_widget_get_display (widget), SIZE_REQUEST,
+                        g_message ("[%p] %s\tresize check: %s (%u contained, %u propagated)",
+                                   widget, G_OBJECT_TYPE_NAME (widget),
+                                   changed ? "changed" : "unchanged",
+                                   resize_checks_contained, resize_checks_propagated));
+#endif
+
+      /* The cache is fresh now, so only the parent needs to know */
+      if (changed && priv->visible && priv->parent)
+        gtk_widget_queue_resize_internal (priv->parent);
+    }
+}
+
 void
 _gtk_widget_add_sizegroup (GtkWidget    *widget,
 			   gpointer      group)
@@ -13799,6 +14378,7 @@ _gtk_widget_add_controller (GtkWidget          *widget,
     }
 
   priv->event_controllers = g_list_prepend (priv->event_controllers, data);
+  _gtk_widget_invalidate_controller_event_types (widget);
 }
 
 void
@@ -13824,6 +14404,7 @@ _gtk_widget_remove_controller (GtkWidget          *widget,
     g_signal_handler_disconnect (data->controller, data->sequence_state_changed_id);
 
   data->controller = NULL;
+  _gtk_widget_invalidate_controller_event_types (widget);
 }
 
 GList *
@@ -14074,41 +14655,21 @@ gtk_widget_maybe_add_debug_render_nodes (GtkWidget             *widget,
 #endif
 }
 
-void
-gtk_widget_snapshot (GtkWidget   *widget,
-                     GtkSnapshot *snapshot)
+static void
+gtk_widget_do_snapshot (GtkWidget                   *widget,
+                        GtkSnapshot                 *snapshot,
+                        const cairo_rectangle_int_t *offset_clip_in,
+                        double                       opacity)
 {
   GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (widget);
-  GtkWidgetPrivate *priv;
+  GtkWidgetPrivate *priv = widget->priv;
   GtkCssValue *filter_value;
   RenderMode mode;
-  double opacity;
-  cairo_rectangle_int_t offset_clip;
+  cairo_rectangle_int_t offset_clip = *offset_clip_in;
   GtkCssStyle *style;
   GtkAllocation allocation;
   GtkBorder margin, border, padding;
 
-  if (!_gtk_widget_is_drawable (widget))
-    return;
-
-  if (_gtk_widget_get_alloc_needed (widget))
-    {
-      g_warning ("Trying to snapshot %s %p without a current allocation", G_OBJECT_TYPE_NAME (widget), widget);
-      return;
-    }
-
-  priv = widget->priv;
-  offset_clip = priv->clip;
-  offset_clip.x -= priv->allocation.x;
-  offset_clip.y -= priv->allocation.y;
-
-  if (gtk_snapshot_clips_rect (snapshot, &offset_clip))
-    return;
-
-  opacity = widget->priv->alpha / 255.0;
-  if (opacity <= 0.0)
-    return;
-
   /* Compatibility mode: if the widget does not have a render node, we draw
    * using gtk_widget_draw() on a temporary node
    */
@@ -14213,6 +14774,107 @@ gtk_widget_snapshot (GtkWidget   *widget,
     gtk_snapshot_pop (snapshot);
 }
 
+/* Snapshots a widget that is known to be drawable and not entirely
+ * clipped away. @offset_clip_in is the clip of @widget relative to
+ * its allocation.
+ */
+static void
+gtk_widget_snapshot_unculled (GtkWidget                   *widget,
+                              GtkSnapshot                 *snapshot,
+                              const cairo_rectangle_int_t *offset_clip_in)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  cairo_rectangle_int_t offset_clip = *offset_clip_in;
+  double opacity;
+  GtkCssStyle *style;
+  GskRenderer *renderer;
+  GskRenderNode *node;
+  int x, y;
+
+  if (_gtk_widget_get_alloc_needed (widget))
+    {
+      g_warning ("Trying to snapshot %s %p without a current allocation", G_OBJECT_TYPE_NAME (widget), widget);
+      return;
+    }
+
+  opacity = widget->priv->alpha / 255.0;
+  if (opacity <= 0.0)
+    return;
+
+  /* Reuse the node from the last snapshot if nothing changed. This
+   * is only possible if nothing was culled from it, and if nothing
+   * depends on ::draw handlers that we can't track. When recording
+   * names for the inspector or for debugging, we always redo it.
+   */
+  style = gtk_css_node_get_style (priv->cssnode);
+  renderer = gtk_snapshot_get_renderer (snapshot);
+  gtk_snapshot_get_offset (snapshot, &x, &y);
+
+  if (snapshot->record_names ||
+      !gtk_snapshot_contains_rect (snapshot, &offset_clip) ||
+      g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
+    {
+      gtk_widget_do_snapshot (widget, snapshot, &offset_clip, opacity);
+      return;
+    }
+
+  if (priv->render_node_valid &&
+      priv->render_node_style == style &&
+      priv->render_node_renderer == renderer &&
+      priv->render_node_x == x &&
+      priv->render_node_y == y)
+    {
+      if (priv->render_node)
+        gtk_snapshot_append_node (snapshot, priv->render_node);
+      return;
+    }
+
+  gtk_snapshot_push (snapshot, TRUE, NULL);
+  gtk_widget_do_snapshot (widget, snapshot, &offset_clip, opacity);
+  node = gtk_snapshot_pop_collect (snapshot);
+
+  gtk_widget_clear_render_node (widget);
+  priv->render_node = node;
+  priv->render_node_style = g_object_ref (style);
+  priv->render_node_renderer = renderer;
+  priv->render_node_x = x;
+  priv->render_node_y = y;
+  priv->render_node_valid = TRUE;
+
+  if (node)
+    gtk_snapshot_append_node (snapshot, node);
+}
+
+void
+gtk_widget_snapshot (GtkWidget   *widget,
+                     GtkSnapshot *snapshot)
+{
+  GtkWidgetPrivate *priv;
+  cairo_rectangle_int_t offset_clip;
+
+  if (!_gtk_widget_is_drawable (widget))
+    return;
+
+  priv = widget->priv;
+  offset_clip = priv->clip;
+  offset_clip.x -= priv->allocation.x;
+  offset_clip.y -= priv->allocation.y;
+
+  if (gtk_snapshot_clips_rect (snapshot, &offset_clip))
+    return;
+
+  if (gtk_widget_times_enabled ())
+    {
+      GtkWidgetTimesFrame frame;
+
+      gtk_widget_times_begin (&frame);
+      gtk_widget_snapshot_unculled (widget, snapshot, &offset_clip);
+      gtk_widget_times_end (&frame, widget, GTK_WIDGET_TIMES_SNAPSHOT);
+    }
+  else
+    gtk_widget_snapshot_unculled (widget, snapshot, &offset_clip);
+}
+
 static gboolean
 should_record_names (GtkWidget   *widget,
                      GskRenderer *renderer)
@@ -14231,6 +14893,8 @@ gtk_widget_render (GtkWidget            *widget,
   GskRenderer *renderer;
   GskRenderNode *root;
   cairo_region_t *clip;
+  GdkFrameClock *frame_clock;
+  gint64 snapshot_start, render_start;
 
   /* We only render double buffered on native windows */
   if (!gdk_window_has_native (window))
@@ -14240,6 +14904,8 @@ gtk_widget_render (GtkWidget            *widget,
   if (renderer == NULL)
     return;
 
+  snapshot_start = g_get_monotonic_time ();
+
   context = gsk_renderer_begin_draw_frame (renderer, region);
   clip = gdk_drawing_context_get_clip (context);
 
@@ -14251,21 +14917,36 @@ gtk_widget_render (GtkWidget            *widget,
   cairo_region_destroy (clip);
   gtk_widget_snapshot (widget, &snapshot);
   root = gtk_snapshot_finish (&snapshot);
+
+  render_start = g_get_monotonic_time ();
+
   if (root != NULL)
     {
+      gsk_renderer_render (renderer, root, context);
+
+      /* Recorded after rendering, so that the recording gets the
+       * profiler counters of this frame */
       gtk_inspector_record_render (widget,
                                    renderer,
                                    window,
                                    region,
                                    context,
                                    root);
-
-      gsk_renderer_render (renderer, root, context);
       gsk_render_node_unref (root);
     }
 
-
   gsk_renderer_end_draw_frame (renderer, context);
+
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  if (frame_clock)
+    {
+      GdkFrameTimings *timings = gdk_frame_clock_get_current_timings (frame_clock);
+
+      if (timings)
+        gdk_frame_timings_add_render_times (timings,
+                                            render_start - snapshot_start,
+                                            g_get_monotonic_time () - render_start);
+    }
 }
 
 /**
@@ -14446,6 +15127,10 @@ gtk_widget_forall (GtkWidget   *widget,
  * @snapshot, and deciding whether the child needs to be snapshot. It is a
  * convenient and optimized way of getting the same effect as calling
  * gtk_widget_snapshot() on the child directly.
+ *
+ * Children that are entirely outside of the current clip of @snapshot
+ * are skipped without being visited, so containers don't need to do
+ * their own culling.
  **/
 void
 gtk_widget_snapshot_child (GtkWidget   *widget,
@@ -14453,16 +15138,30 @@ gtk_widget_snapshot_child (GtkWidget   *widget,
                            GtkSnapshot *snapshot)
 {
   GtkWidgetPrivate *priv = gtk_widget_get_instance_private (child);
+  cairo_rectangle_int_t offset_clip;
   int x, y;
 
   g_return_if_fail (_gtk_widget_get_parent (child) == widget);
   g_return_if_fail (snapshot != NULL);
 
+  if (!_gtk_widget_is_drawable (child))
+    return;
+
+  /* The child's clip is in the coordinates of @widget, so we can
+   * cull before translating the snapshot.
+   */
+  if (gtk_snapshot_clips_rect (snapshot, &priv->clip))
+    return;
+
   x = priv->allocation.x;
   y = priv->allocation.y;
 
+  offset_clip = priv->clip;
+  offset_clip.x -= x;
+  offset_clip.y -= y;
+
   gtk_snapshot_offset (snapshot, x, y);
-  gtk_widget_snapshot (child, snapshot);
+  gtk_widget_snapshot_unculled (child, snapshot, &offset_clip);
   gtk_snapshot_offset (snapshot, -x, -y);
 }
 
@@ -75,6 +75,8 @@ struct _GtkWidgetPrivate
   guint resize_needed         : 1; /* queue_resize() has been called but no get_preferred_size() yet */
   guint alloc_needed          : 1; /* this widget needs a size_allocate() call */
   guint alloc_needed_on_child : 1; /* 0 or more children - or this widget - need a size_allocate() call */
+  guint resize_check_needed   : 1; /* content changed, parent only needs a resize if the request did */
+  guint resize_check_on_child : 1; /* this widget or a child has resize_check_needed set */
 
   /* Expand-related flags */
   guint need_compute_expand   : 1; /* Need to recompute computed_[hv]_expand */
@@ -89,6 +91,11 @@ struct _GtkWidgetPrivate
   /* SizeGroup related flags */
   guint have_size_groups      : 1;
 
+  guint render_node_valid     : 1; /* render_node can be reused */
+  guint render_node_changed   : 1; /* render_node_valid was cleared since the last reset */
+
+  guint controller_event_types_valid : 1; /* controller_event_types is up to date */
+
   /* Alignment */
   guint   halign              : 4;
   guint   valign              : 4;
@@ -139,6 +146,19 @@ struct _GtkWidgetPrivate
   GtkAllocation reported_clip;
   gint allocated_baseline;
 
+  /* The render node of the last snapshot, and what it depends on
+   * besides the widget's own state. It is invalidated with the
+   * widget and all its ancestors when anything changes.
+   */
+  GskRenderNode *render_node;
+  GtkCssStyle *render_node_style;
+  GskRenderer *render_node_renderer;
+  int render_node_x;
+  int render_node_y;
+
+  /* Speeds up picking among many children, see gtk_widget_real_pick() */
+  struct _GtkWidgetPickIndex *pick_index;
+
   /* The widget's requested sizes */
   SizeRequestCache requests;
 
@@ -150,6 +170,8 @@ struct _GtkWidgetPrivate
   GList *registered_windows;
 
   GList *event_controllers;
+  /* The event types that the controllers in each phase handle */
+  guint64 controller_event_types[GTK_PHASE_TARGET + 1];
 
   AtkObject *accessible;
 
@@ -178,8 +200,12 @@ void         _gtk_widget_set_shadowed       (GtkWidget *widget,
 gboolean     _gtk_widget_get_alloc_needed   (GtkWidget *widget);
 gboolean     gtk_widget_needs_allocate      (GtkWidget *widget);
 void         gtk_widget_ensure_resize       (GtkWidget *widget);
+void         gtk_widget_ensure_resize_checks (GtkWidget *widget);
+void         gtk_widget_queue_resize_checked (GtkWidget *widget);
 void         gtk_widget_ensure_allocate     (GtkWidget *widget);
 void          _gtk_widget_scale_changed     (GtkWidget *widget);
+gboolean     gtk_widget_get_render_node_changed   (GtkWidget *widget);
+void         gtk_widget_reset_render_node_changed (GtkWidget *widget);
 
 
 void         _gtk_widget_add_sizegroup         (GtkWidget    *widget,
@@ -260,6 +286,7 @@ void              _gtk_widget_remove_controller            (GtkWidget
                                                             GtkEventController  *controller);
 GList *           _gtk_widget_list_controllers             (GtkWidget           *widget,
                                                             GtkPropagationPhase  phase);
+void              _gtk_widget_invalidate_controller_event_types (GtkWidget      *widget);
 gboolean          _gtk_widget_consumes_motion              (GtkWidget           *widget,
                                                             GdkEventSequence    *sequence);
 
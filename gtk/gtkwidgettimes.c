@@ -0,0 +1,120 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkwidgettimesprivate.h"
+
+/* Accounts the time widgets spend measuring, allocating and
+ * snapshotting. Calls nest: the total time of a call includes the
+ * calls it makes for its children, the self time doesn't. The
+ * frames of the calls in progress live on the stack of their
+ * callers and are linked through @parent.
+ */
+
+static GtkWidgetTimesFrame *current_frame;
+static GHashTable *type_times;
+static GQuark quark_widget_times;
+
+void
+gtk_widget_times_begin (GtkWidgetTimesFrame *frame)
+{
+  frame->parent = current_frame;
+  frame->children = 0;
+  frame->start = g_get_monotonic_time ();
+
+  current_frame = frame;
+}
+
+static GtkWidgetTimes *
+get_widget_times (GtkWidget *widget)
+{
+  GtkWidgetTimes *times;
+
+  if (G_UNLIKELY (quark_widget_times == 0))
+    quark_widget_times = g_quark_from_static_string ("gtk-widget-times");
+
+  times = g_object_get_qdata (G_OBJECT (widget), quark_widget_times);
+  if (times == NULL)
+    {
+      times = g_new0 (GtkWidgetTimes, 1);
+      g_object_set_qdata_full (G_OBJECT (widget), quark_widget_times, times, g_free);
+    }
+
+  return times;
+}
+
+static GtkWidgetTimes *
+get_type_times (GType type)
+{
+  GtkWidgetTimes *times;
+
+  if (G_UNLIKELY (type_times == NULL))
+    type_times = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  times = g_hash_table_lookup (type_times, GSIZE_TO_POINTER (type));
+  if (times == NULL)
+    {
+      times = g_new0 (GtkWidgetTimes, 1);
+      g_hash_table_insert (type_times, GSIZE_TO_POINTER (type), times);
+    }
+
+  return times;
+}
+
+void
+gtk_widget_times_end (GtkWidgetTimesFrame *frame,
+                      GtkWidget           *widget,
+                      GtkWidgetTimesKind   kind)
+{
+  GtkWidgetTimes *times;
+  gint64 total, self;
+
+  g_assert (current_frame == frame);
+
+  total = g_get_monotonic_time () - frame->start;
+  self = MAX (0, total - frame->children);
+
+  current_frame = frame->parent;
+  if (current_frame)
+    current_frame->children += total;
+
+  times = get_widget_times (widget);
+  times->self[kind] += self;
+  times->total[kind] += total;
+
+  times = get_type_times (G_OBJECT_TYPE (widget));
+  times->self[kind] += self;
+  times->total[kind] += total;
+}
+
+const GtkWidgetTimes *
+gtk_widget_times_get (GtkWidget *widget)
+{
+  if (quark_widget_times == 0)
+    return NULL;
+
+  return g_object_get_qdata (G_OBJECT (widget), quark_widget_times);
+}
+
+const GtkWidgetTimes *
+gtk_widget_times_get_for_type (GType type)
+{
+  if (type_times == NULL)
+    return NULL;
+
+  return g_hash_table_lookup (type_times, GSIZE_TO_POINTER (type));
+}
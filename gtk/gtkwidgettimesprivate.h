@@ -0,0 +1,60 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_WIDGET_TIMES_PRIVATE_H__
+#define __GTK_WIDGET_TIMES_PRIVATE_H__
+
+#include "gtkwidget.h"
+#include "gtkdebug.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GTK_WIDGET_TIMES_MEASURE,
+  GTK_WIDGET_TIMES_ALLOCATE,
+  GTK_WIDGET_TIMES_SNAPSHOT,
+  GTK_WIDGET_N_TIMES
+} GtkWidgetTimesKind;
+
+typedef struct {
+  gint64 self[GTK_WIDGET_N_TIMES];
+  gint64 total[GTK_WIDGET_N_TIMES];
+} GtkWidgetTimes;
+
+typedef struct _GtkWidgetTimesFrame GtkWidgetTimesFrame;
+
+struct _GtkWidgetTimesFrame {
+  GtkWidgetTimesFrame *parent;
+  gint64 start;
+  gint64 children;
+};
+
+/* Only used with GTK_DEBUG=widget-times, so that the common case
+ * stays a flag check.
+ */
+#define gtk_widget_times_enabled() GTK_DEBUG_CHECK (WIDGET_TIMES)
+
+void                    gtk_widget_times_begin          (GtkWidgetTimesFrame *frame);
+void                    gtk_widget_times_end            (GtkWidgetTimesFrame *frame,
+                                                         GtkWidget           *widget,
+                                                         GtkWidgetTimesKind   kind);
+
+const GtkWidgetTimes *  gtk_widget_times_get            (GtkWidget           *widget);
+const GtkWidgetTimes *  gtk_widget_times_get_for_type   (GType                type);
+
+G_END_DECLS
+
+#endif /* __GTK_WIDGET_TIMES_PRIVATE_H__ */
@@ -278,6 +278,9 @@ struct _GtkWindowPrivate
   GskRenderer *renderer;
 
   GList *foci;
+
+  GList *pending_prelight;
+  guint  prelight_tick_id;
 };
 
 #ifdef GDK_WINDOWING_X11
@@ -3340,6 +3343,8 @@ gtk_window_dispose (GObject *object)
   g_list_free_full (priv->foci, (GDestroyNotify) gtk_pointer_focus_unref);
   priv->foci = NULL;
 
+  gtk_window_flush_prelight (window);
+
   gtk_window_set_focus (window, NULL);
   gtk_window_set_default (window, NULL);
   remove_attach_widget (window);
@@ -7073,6 +7078,8 @@ gtk_window_unrealize (GtkWidget *widget)
       priv->popup_menu = NULL;
     }
 
+  gtk_window_flush_prelight (window);
+
   /* Icons */
   gtk_window_unrealize_icon (window);
 
@@ -11401,6 +11408,124 @@ gtk_window_update_pointer_focus (GtkWindow        *window,
     }
 }
 
+typedef struct
+{
+  GtkWidget *widget;
+  gboolean   prelight;
+} GtkPendingPrelight;
+
+static void
+gtk_pending_prelight_free (GtkPendingPrelight *pending)
+{
+  g_object_unref (pending->widget);
+  g_slice_free (GtkPendingPrelight, pending);
+}
+
+static gboolean
+gtk_window_prelight_tick (GtkWidget     *widget,
+                          GdkFrameClock *frame_clock,
+                          gpointer       user_data)
+{
+  GtkWindow *window = GTK_WINDOW (widget);
+
+  window->priv->prelight_tick_id = 0;
+  gtk_window_flush_prelight (window);
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * gtk_window_queue_prelight:
+ * @window: a #GtkWindow
+ * @widget: a widget inside @window
+ * @prelight: whether the pointer entered or left @widget
+ *
+ * Records that @widget should gain or lose %GTK_STATE_FLAG_PRELIGHT,
+ * and applies the change at the start of the next frame. When the
+ * pointer moves quickly, widgets are typically crossed in and out
+ * many times per frame; only the final hover state of each widget
+ * causes a state change, and with it restyling and redrawing.
+ *
+ * Changes are applied in the order of the last crossing of each
+ * widget. Since the crossing code always unsets the flag bottom-up
+ * before setting it top-down, this order keeps the propagation of
+ * the flag to children correct.
+ */
+void
+gtk_window_queue_prelight (GtkWindow *window,
+                           GtkWidget *widget,
+                           gboolean   prelight)
+{
+  GtkWindowPrivate *priv = window->priv;
+  GtkPendingPrelight *pending = NULL;
+  GList *l;
+
+  for (l = priv->pending_prelight; l; l = l->next)
+    {
+      GtkPendingPrelight *p = l->data;
+
+      if (p->widget == widget)
+        {
+          pending = p;
+          priv->pending_prelight = g_list_delete_link (priv->pending_prelight, l);
+          break;
+        }
+    }
+
+  if (pending == NULL)
+    {
+      pending = g_slice_new (GtkPendingPrelight);
+      pending->widget = g_object_ref (widget);
+    }
+
+  pending->prelight = prelight;
+  priv->pending_prelight = g_list_append (priv->pending_prelight, pending);
+
+  if (priv->prelight_tick_id == 0)
+    priv->prelight_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (window),
+                                                           gtk_window_prelight_tick,
+                                                           NULL, NULL);
+}
+
+/*
+ * gtk_window_flush_prelight:
+ * @window: a #GtkWindow
+ *
+ * Applies the prelight changes queued with gtk_window_queue_prelight()
+ * right away.
+ */
+void
+gtk_window_flush_prelight (GtkWindow *window)
+{
+  GtkWindowPrivate *priv = window->priv;
+  GList *pending, *l;
+
+  if (priv->prelight_tick_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (window), priv->prelight_tick_id);
+      priv->prelight_tick_id = 0;
+    }
+
+  pending = priv->pending_prelight;
+  priv->pending_prelight = NULL;
+
+  for (l = pending; l; l = l->next)
+    {
+      GtkPendingPrelight *p = l->data;
+
+      if (p->prelight)
+        {
+          /* The widget may have been moved elsewhere meanwhile */
+          if (gtk_widget_get_toplevel (p->widget) == GTK_WIDGET (window))
+            gtk_widget_set_state_flags (p->widget, GTK_STATE_FLAG_PRELIGHT, FALSE);
+        }
+      else
+        gtk_widget_unset_state_flags (p->widget, GTK_STATE_FLAG_PRELIGHT);
+    }
+
+  g_list_free_full (pending, (GDestroyNotify) gtk_pending_prelight_free);
+}
+
 void
 gtk_window_update_pointer_focus_on_state_change (GtkWindow *window,
                                                  GtkWidget *widget)
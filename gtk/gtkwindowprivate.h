@@ -143,6 +143,11 @@ GtkWidget *      gtk_window_lookup_pointer_focus_implicit_grab (GtkWindow
                                                                 GdkDevice        *device,
                                                                 GdkEventSequence *sequence);
 
+void             gtk_window_queue_prelight       (GtkWindow        *window,
+                                                  GtkWidget        *widget,
+                                                  gboolean          prelight);
+void             gtk_window_flush_prelight       (GtkWindow        *window);
+
 void             gtk_window_update_pointer_focus (GtkWindow        *window,
                                                   GdkDevice        *device,
                                                   GdkEventSequence *sequence,
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "memory.h"
+
+#include "graphdata.h"
+#include "gtkcelllayout.h"
+#include "gtkcellrenderertext.h"
+#include "gtkliststore.h"
+#include "gtktreeview.h"
+
+#include "gdk/gdk-private.h"
+
+/* Shows the memory that GTK+ accounts with gdk_memory_stats_alloc(),
+ * updated every second while the page is mapped.
+ */
+
+struct _GtkInspectorMemoryPrivate
+{
+  GtkListStore *model;
+  GtkTreeViewColumn *column_live;
+  GtkCellRenderer *renderer_live;
+  GtkTreeViewColumn *column_bytes;
+  GtkCellRenderer *renderer_bytes;
+  GtkTreeIter iters[GDK_MEMORY_N_KINDS];
+  GtkGraphData *graphs[GDK_MEMORY_N_KINDS];
+  guint update_source_id;
+};
+
+enum
+{
+  COLUMN_NAME,
+  COLUMN_LIVE,
+  COLUMN_BYTES,
+  COLUMN_BYTES_DATA
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (GtkInspectorMemory, gtk_inspector_memory, GTK_TYPE_BOX)
+
+static gboolean
+update_memory (gpointer data)
+{
+  GtkInspectorMemory *mem = data;
+  int i;
+
+  for (i = 0; i < GDK_MEMORY_N_KINDS; i++)
+    {
+      gsize n_live, n_bytes;
+
+      gdk_memory_stats_get (i, &n_live, &n_bytes);
+      gtk_graph_data_prepend_value (mem->priv->graphs[i], n_bytes);
+      gtk_list_store_set (mem->priv->model, &mem->priv->iters[i],
+                          COLUMN_LIVE, (guint64) n_live,
+                          COLUMN_BYTES, (guint64) n_bytes,
+                          -1);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+cell_data_live (GtkCellLayout   *layout,
+                GtkCellRenderer *cell,
+                GtkTreeModel    *model,
+                GtkTreeIter     *iter,
+                gpointer         data)
+{
+  guint64 value;
+  char *text;
+
+  gtk_tree_model_get (model, iter, COLUMN_LIVE, &value, -1);
+
+  text = g_strdup_printf ("%" G_GUINT64_FORMAT, value);
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+static void
+cell_data_bytes (GtkCellLayout   *layout,
+                 GtkCellRenderer *cell,
+                 GtkTreeModel    *model,
+                 GtkTreeIter     *iter,
+                 gpointer         data)
+{
+  guint64 value;
+  char *text;
+
+  gtk_tree_model_get (model, iter, COLUMN_BYTES, &value, -1);
+
+  text = g_format_size (value);
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+static void
+gtk_inspector_memory_map (GtkWidget *widget)
+{
+  GtkInspectorMemory *mem = GTK_INSPECTOR_MEMORY (widget);
+
+  GTK_WIDGET_CLASS (gtk_inspector_memory_parent_class)->map (widget);
+
+  update_memory (mem);
+  mem->priv->update_source_id = gdk_threads_add_timeout_seconds (1, update_memory, mem);
+}
+
+static void
+gtk_inspector_memory_unmap (GtkWidget *widget)
+{
+  GtkInspectorMemory *mem = GTK_INSPECTOR_MEMORY (widget);
+
+  if (mem->priv->update_source_id)
+    {
+      g_source_remove (mem->priv->update_source_id);
+      mem->priv->update_source_id = 0;
+    }
+
+  GTK_WIDGET_CLASS (gtk_inspector_memory_parent_class)->unmap (widget);
+}
+
+static void
+gtk_inspector_memory_init (GtkInspectorMemory *mem)
+{
+  int i;
+
+  mem->priv = gtk_inspector_memory_get_instance_private (mem);
+  gtk_widget_init_template (GTK_WIDGET (mem));
+
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (mem->priv->column_live),
+                                      mem->priv->renderer_live,
+                                      cell_data_live,
+                                      NULL, NULL);
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (mem->priv->column_bytes),
+                                      mem->priv->renderer_bytes,
+                                      cell_data_bytes,
+                                      NULL, NULL);
+
+  for (i = 0; i < GDK_MEMORY_N_KINDS; i++)
+    {
+      mem->priv->graphs[i] = gtk_graph_data_new (60);
+      gtk_list_store_append (mem->priv->model, &mem->priv->iters[i]);
+      gtk_list_store_set (mem->priv->model, &mem->priv->iters[i],
+                          COLUMN_NAME, gdk_memory_kind_get_name (i),
+                          COLUMN_BYTES_DATA, mem->priv->graphs[i],
+                          -1);
+    }
+}
+
+static void
+finalize (GObject *object)
+{
+  GtkInspectorMemory *mem = GTK_INSPECTOR_MEMORY (object);
+  int i;
+
+  for (i = 0; i < GDK_MEMORY_N_KINDS; i++)
+    g_object_unref (mem->priv->graphs[i]);
+
+  G_OBJECT_CLASS (gtk_inspector_memory_parent_class)->finalize (object);
+}
+
+static void
+gtk_inspector_memory_class_init (GtkInspectorMemoryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->finalize = finalize;
+
+  widget_class->map = gtk_inspector_memory_map;
+  widget_class->unmap = gtk_inspector_memory_unmap;
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/memory.ui");
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMemory, model);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMemory, column_live);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMemory, renderer_live);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMemory, column_bytes);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMemory, renderer_bytes);
+}
+
+// vim: set et sw=2 ts=2:
@@ -29,6 +29,9 @@
 #include "gtkframe.h"
 #include "gtkbutton.h"
 #include "gtkwidgetprivate.h"
+#include "gtkdrawingarea.h"
+#include "gdk/gdk-private.h"
+#include "gtkcssnodestylecacheprivate.h"
 
 
 struct _GtkInspectorMiscInfoPrivate {
@@ -66,6 +69,8 @@ struct _GtkInspectorMiscInfoPrivate {
   GtkWidget *tick_callback;
   GtkWidget *framerate_row;
   GtkWidget *framerate;
+  GtkWidget *frame_timings_row;
+  GtkWidget *frame_timings;
   GtkWidget *framecount_row;
   GtkWidget *framecount;
   GtkWidget *accessible_role_row;
@@ -82,6 +87,7 @@ struct _GtkInspectorMiscInfoPrivate {
   GtkWidget *is_toplevel;
   GtkWidget *child_visible_row;
   GtkWidget *child_visible;
+  GtkWidget *style_cache;
 
   guint update_source_id;
   gint64 last_frame;
@@ -322,6 +328,164 @@ update_frame_clock (GtkInspectorMiscInfo *sl)
     }
 }
 
+/* The parts of a frame, in the order they are stacked in the graph.
+ * Snapshot and render are part of the paint phase; what remains of
+ * it is shown as paint.
+ */
+enum {
+  TIMING_UPDATE,
+  TIMING_LAYOUT,
+  TIMING_SNAPSHOT,
+  TIMING_RENDER,
+  TIMING_PAINT,
+  TIMING_OTHER,
+  N_TIMINGS
+};
+
+static const GdkRGBA timing_colors[N_TIMINGS] = {
+  { 0.45, 0.62, 0.81, 1.0 },
+  { 0.54, 0.89, 0.20, 1.0 },
+  { 0.99, 0.69, 0.24, 1.0 },
+  { 0.93, 0.16, 0.16, 1.0 },
+  { 0.68, 0.50, 0.66, 1.0 },
+  { 0.53, 0.54, 0.52, 1.0 }
+};
+
+static void
+get_frame_timings (GdkFrameTimings *timings,
+                   gint64           parts[N_TIMINGS])
+{
+  gint64 paint;
+
+  parts[TIMING_UPDATE] = gdk_frame_timings_get_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_UPDATE);
+  parts[TIMING_LAYOUT] = gdk_frame_timings_get_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_LAYOUT);
+  parts[TIMING_SNAPSHOT] = gdk_frame_timings_get_snapshot_time (timings);
+  parts[TIMING_RENDER] = gdk_frame_timings_get_render_time (timings);
+  paint = gdk_frame_timings_get_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_PAINT);
+  parts[TIMING_PAINT] = MAX (0, paint - parts[TIMING_SNAPSHOT] - parts[TIMING_RENDER]);
+  parts[TIMING_OTHER] = gdk_frame_timings_get_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT) +
+                        gdk_frame_timings_get_phase_duration (timings, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT);
+}
+
+static void
+draw_frame_timings (GtkDrawingArea *area,
+                    cairo_t        *cr,
+                    int             width,
+                    int             height,
+                    gpointer        data)
+{
+  GtkInspectorMiscInfo *sl = data;
+  GdkFrameClock *clock;
+  gint64 frame, history_start, i;
+  gint64 refresh_interval = 0;
+  gint64 scale;
+  double bar_width;
+
+  if (!GDK_IS_FRAME_CLOCK (sl->priv->object))
+    return;
+
+  clock = GDK_FRAME_CLOCK (sl->priv->object);
+  frame = gdk_frame_clock_get_frame_counter (clock);
+  history_start = gdk_frame_clock_get_history_start (clock);
+
+  /* Scale the graph so that the refresh interval is at two thirds
+   * of the height, unless frames take longer than that.
+   */
+  scale = 0;
+  for (i = history_start; i <= frame; i++)
+    {
+      GdkFrameTimings *timings = gdk_frame_clock_get_timings (clock, i);
+      gint64 parts[N_TIMINGS];
+      gint64 total = 0;
+      int j;
+
+      if (timings == NULL)
+        continue;
+
+      if (gdk_frame_timings_get_refresh_interval (timings) != 0)
+        refresh_interval = gdk_frame_timings_get_refresh_interval (timings);
+
+      get_frame_timings (timings, parts);
+      for (j = 0; j < N_TIMINGS; j++)
+        total += parts[j];
+      scale = MAX (scale, total);
+    }
+
+  if (refresh_interval == 0)
+    refresh_interval = G_USEC_PER_SEC / 60;
+  scale = MAX (scale, refresh_interval * 3 / 2);
+
+  bar_width = (double) width / (frame - history_start + 1);
+
+  for (i = history_start; i <= frame; i++)
+    {
+      GdkFrameTimings *timings = gdk_frame_clock_get_timings (clock, i);
+      gint64 parts[N_TIMINGS];
+      double y = height;
+      int j;
+
+      if (timings == NULL)
+        continue;
+
+      get_frame_timings (timings, parts);
+      for (j = 0; j < N_TIMINGS; j++)
+        {
+          double h = (double) height * parts[j] / scale;
+
+          y -= h;
+          gdk_cairo_set_source_rgba (cr, &timing_colors[j]);
+          cairo_rectangle (cr, (i - history_start) * bar_width, y, MAX (1, bar_width - 1), h);
+          cairo_fill (cr);
+        }
+    }
+
+  /* Mark the time available for a frame */
+  cairo_set_source_rgba (cr, 0, 0, 0, 0.5);
+  cairo_set_line_width (cr, 1);
+  cairo_move_to (cr, 0, height - (double) height * refresh_interval / scale + 0.5);
+  cairo_rel_line_to (cr, width, 0);
+  cairo_stroke (cr);
+}
+
+static void
+update_frame_timings_tooltip (GtkInspectorMiscInfo *sl,
+                              GdkFrameTimings      *timings)
+{
+  gint64 parts[N_TIMINGS];
+  gchar *tmp;
+
+  get_frame_timings (timings, parts);
+
+  tmp = g_strdup_printf (_("Update: %.1f ms\n"
+                           "Layout: %.1f ms\n"
+                           "Snapshot: %.1f ms\n"
+                           "Render: %.1f ms\n"
+                           "Other painting: %.1f ms\n"
+                           "Other: %.1f ms"),
+                         parts[TIMING_UPDATE] / 1000.,
+                         parts[TIMING_LAYOUT] / 1000.,
+                         parts[TIMING_SNAPSHOT] / 1000.,
+                         parts[TIMING_RENDER] / 1000.,
+                         parts[TIMING_PAINT] / 1000.,
+                         parts[TIMING_OTHER] / 1000.);
+  gtk_widget_set_tooltip_text (sl->priv->frame_timings, tmp);
+  g_free (tmp);
+}
+
+static void
+update_style_cache (GtkInspectorMiscInfo *sl)
+{
+  GtkCssNodeStyleCacheStats stats;
+  gchar *tmp;
+
+  gtk_css_node_style_cache_get_stats (&stats);
+
+  tmp = g_strdup_printf (_("%u of %u lookups hit, %u by siblings, %u uncacheable"),
+                         stats.hits, stats.lookups, stats.sibling_hits, stats.uncacheable);
+  gtk_label_set_label (GTK_LABEL (sl->priv->style_cache), tmp);
+  g_free (tmp);
+}
+
 static gboolean
 update_info (gpointer data)
 {
@@ -416,6 +580,10 @@ update_info (gpointer data)
           tmp = g_strdup_printf ("%4.1f ⁄ s", (G_USEC_PER_SEC * history_len) / (double) (frame_time - previous_frame_time));
           gtk_label_set_label (GTK_LABEL (sl->priv->framerate), tmp);
           g_free (tmp);
+
+          /* The current frame is usually still being painted */
+          update_frame_timings_tooltip (sl, gdk_frame_clock_get_timings (clock, frame - 1));
+          gtk_widget_queue_draw (sl->priv->frame_timings);
         }
       else
         {
@@ -425,6 +593,8 @@ update_info (gpointer data)
       sl->priv->last_frame = frame;
     }
 
+  update_style_cache (sl);
+
   return G_SOURCE_CONTINUE;
 }
 
@@ -518,11 +688,13 @@ gtk_inspector_misc_info_set_object (GtkInspectorMiscInfo *sl,
     {
       gtk_widget_show (sl->priv->framecount_row);
       gtk_widget_show (sl->priv->framerate_row);
+      gtk_widget_show (sl->priv->frame_timings_row);
     }
   else
     {
       gtk_widget_hide (sl->priv->framecount_row);
       gtk_widget_hide (sl->priv->framerate_row);
+      gtk_widget_hide (sl->priv->frame_timings_row);
     }
 
   update_info (sl);
@@ -533,6 +705,9 @@ gtk_inspector_misc_info_init (GtkInspectorMiscInfo *sl)
 {
   sl->priv = gtk_inspector_misc_info_get_instance_private (sl);
   gtk_widget_init_template (GTK_WIDGET (sl));
+
+  gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (sl->priv->frame_timings),
+                                  draw_frame_timings, sl, NULL);
 }
 
 static void
@@ -646,6 +821,8 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, framecount);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, framerate_row);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, framerate);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, frame_timings_row);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, frame_timings);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, accessible_role_row);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, accessible_role);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, accessible_name_row);
@@ -660,6 +837,7 @@ gtk_inspector_misc_info_class_init (GtkInspectorMiscInfoClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, is_toplevel);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, child_visible_row);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, child_visible);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorMiscInfo, style_cache);
 
   gtk_widget_class_bind_template_callback (widget_class, show_default_widget);
   gtk_widget_class_bind_template_callback (widget_class, show_focus_widget);
@@ -33,6 +33,7 @@
 #include "gtkbuildable.h"
 #include "gtkbutton.h"
 #include "gtkcelllayout.h"
+#include "gtkcellrenderertext.h"
 #include "gtkcomboboxprivate.h"
 #include "gtkiconview.h"
 #include "gtklabel.h"
@@ -48,6 +49,8 @@
 #include "gtkstylecontext.h"
 #include "gtksearchbar.h"
 #include "gtksearchentry.h"
+#include "gtkscrolledwindow.h"
+#include "gtkwidgettimesprivate.h"
 #include "treewalk.h"
 
 enum
@@ -57,7 +60,14 @@ enum
   OBJECT_NAME,
   OBJECT_LABEL,
   OBJECT_CLASSES,
-  SENSITIVE
+  SENSITIVE,
+  MEASURE_SELF,
+  MEASURE_TOTAL,
+  ALLOCATE_SELF,
+  ALLOCATE_TOTAL,
+  SNAPSHOT_SELF,
+  SNAPSHOT_TOTAL,
+  TYPE_SELF
 };
 
 
@@ -904,6 +914,69 @@ stop_search (GtkWidget              *entry,
   gtk_search_bar_set_search_mode (GTK_SEARCH_BAR (wt->priv->search_bar), FALSE);
 }
 
+static void
+time_data_func (GtkTreeViewColumn *column,
+                GtkCellRenderer   *cell,
+                GtkTreeModel      *model,
+                GtkTreeIter       *iter,
+                gpointer           data)
+{
+  gint64 time;
+  char *text;
+
+  gtk_tree_model_get (model, iter, GPOINTER_TO_INT (data), &time, -1);
+  if (time > 0)
+    text = g_strdup_printf ("%.2f", time / 1000.);
+  else
+    text = NULL;
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+/* With GTK_DEBUG=widget-times, show the time spent by each widget,
+ * in ms, accumulated since the start; it is sampled when the tree
+ * is refreshed.
+ */
+static void
+add_time_columns (GtkInspectorObjectTree *wt)
+{
+  const struct {
+    const char *title;
+    int column;
+  } columns[] = {
+    { NC_("widget times", "Measure"), MEASURE_SELF },
+    { NC_("widget times", "Measure (total)"), MEASURE_TOTAL },
+    { NC_("widget times", "Allocate"), ALLOCATE_SELF },
+    { NC_("widget times", "Allocate (total)"), ALLOCATE_TOTAL },
+    { NC_("widget times", "Snapshot"), SNAPSHOT_SELF },
+    { NC_("widget times", "Snapshot (total)"), SNAPSHOT_TOTAL },
+    { NC_("widget times", "Type"), TYPE_SELF }
+  };
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (columns); i++)
+    {
+      GtkTreeViewColumn *column;
+      GtkCellRenderer *cell;
+
+      cell = gtk_cell_renderer_text_new ();
+      g_object_set (cell, "scale", 0.8, "xalign", 1.0, NULL);
+      column = gtk_tree_view_column_new ();
+      gtk_tree_view_column_set_title (column, g_dpgettext2 (GETTEXT_PACKAGE, "widget times", columns[i].title));
+      gtk_tree_view_column_set_resizable (column, TRUE);
+      gtk_tree_view_column_set_sort_column_id (column, columns[i].column);
+      gtk_tree_view_column_pack_start (column, cell, TRUE);
+      gtk_tree_view_column_set_cell_data_func (column, cell,
+                                               time_data_func,
+                                               GINT_TO_POINTER (columns[i].column),
+                                               NULL);
+      gtk_tree_view_append_column (wt->priv->tree, column);
+    }
+
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (gtk_widget_get_parent (GTK_WIDGET (wt->priv->tree))),
+                                  GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+}
+
 static void
 gtk_inspector_object_tree_init (GtkInspectorObjectTree *wt)
 {
@@ -917,6 +990,9 @@ gtk_inspector_object_tree_init (GtkInspectorObjectTree *wt)
 
   g_signal_connect (wt->priv->search_bar, "notify::search-mode-enabled",
                     G_CALLBACK (search_mode_changed), wt);
+
+  if (gtk_widget_times_enabled ())
+    add_time_columns (wt);
   wt->priv->walk = gtk_tree_walk_new (GTK_TREE_MODEL (wt->priv->model), match_row, wt, NULL);
 
   signal_id = g_signal_lookup ("map", GTK_TYPE_WIDGET);
@@ -1097,6 +1173,28 @@ gtk_inspector_object_tree_append_object (GtkInspectorObjectTree *wt,
                       SENSITIVE, object_get_sensitive (object),
                       -1);
 
+  if (GTK_IS_WIDGET (object))
+    {
+      const GtkWidgetTimes *times = gtk_widget_times_get (GTK_WIDGET (object));
+      const GtkWidgetTimes *type_times = gtk_widget_times_get_for_type (G_OBJECT_TYPE (object));
+
+      if (times)
+        gtk_tree_store_set (wt->priv->model, &iter,
+                            MEASURE_SELF, times->self[GTK_WIDGET_TIMES_MEASURE],
+                            MEASURE_TOTAL, times->total[GTK_WIDGET_TIMES_MEASURE],
+                            ALLOCATE_SELF, times->self[GTK_WIDGET_TIMES_ALLOCATE],
+                            ALLOCATE_TOTAL, times->total[GTK_WIDGET_TIMES_ALLOCATE],
+                            SNAPSHOT_SELF, times->self[GTK_WIDGET_TIMES_SNAPSHOT],
+                            SNAPSHOT_TOTAL, times->total[GTK_WIDGET_TIMES_SNAPSHOT],
+                            -1);
+      if (type_times)
+        gtk_tree_store_set (wt->priv->model, &iter,
+                            TYPE_SELF, type_times->self[GTK_WIDGET_TIMES_MEASURE] +
+                                       type_times->self[GTK_WIDGET_TIMES_ALLOCATE] +
+                                       type_times->self[GTK_WIDGET_TIMES_SNAPSHOT],
+                            -1);
+    }
+
   if (name && *name)
     {
       gchar *title;
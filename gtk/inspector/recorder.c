@@ -31,6 +31,7 @@
 #include <gtk/gtktreeselection.h>
 #include <gtk/gtktreeview.h>
 #include <gsk/gskrendererprivate.h>
+#include <gsk/gskrendernodebinaryprivate.h>
 #include <gsk/gskrendernodeprivate.h>
 #include <gsk/gskroundedrectprivate.h>
 
@@ -58,6 +59,17 @@ struct _GtkInspectorRecorderPrivate
   GtkInspectorRecording *recording; /* start recording if recording or NULL if not */
 
   gboolean debug_nodes;
+
+  /* Ring buffer limits, 0 means unlimited */
+  guint max_duration; /* in seconds */
+  guint max_size;     /* in MB */
+  gsize recordings_size;
+
+  /* The nodes of the last recorded frame, for sharing unchanged subtrees */
+  GHashTable *last_nodes;
+
+  GFile *stream_directory;
+  guint stream_counter;
 };
 
 enum {
@@ -71,6 +83,8 @@ enum
   PROP_0,
   PROP_RECORDING,
   PROP_DEBUG_NODES,
+  PROP_MAX_DURATION,
+  PROP_MAX_SIZE,
   LAST_PROP
 };
 
@@ -85,6 +99,8 @@ recordings_clear_all (GtkButton            *button,
   GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
 
   g_list_store_remove_all (G_LIST_STORE (priv->recordings));
+  priv->recordings_size = 0;
+  g_clear_pointer (&priv->last_nodes, g_hash_table_unref);
 }
 
 static void
@@ -162,6 +178,10 @@ node_type_name (GskRenderNodeType type)
       return "Linear Gradient";
     case GSK_REPEATING_LINEAR_GRADIENT_NODE:
       return "Repeating Linear Gradient";
+    case GSK_RADIAL_GRADIENT_NODE:
+      return "Radial Gradient";
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      return "Repeating Radial Gradient";
     case GSK_BORDER_NODE:
       return "Border";
     case GSK_TEXTURE_NODE:
@@ -460,6 +480,52 @@ populate_render_node_properties (GtkListStore  *store,
       add_float_row (store, "Radius", gsk_blur_node_get_radius (node));
       break;
 
+    case GSK_RADIAL_GRADIENT_NODE:
+    case GSK_REPEATING_RADIAL_GRADIENT_NODE:
+      {
+        const graphene_point_t *center = gsk_radial_gradient_node_peek_center (node);
+        const gsize n_stops = gsk_radial_gradient_node_get_n_color_stops (node);
+        const GskColorStop *stops = gsk_radial_gradient_node_peek_color_stops (node);
+        int i;
+        GString *s;
+        cairo_surface_t *surface;
+
+        tmp = g_strdup_printf ("%.2f %.2f", center->x, center->y);
+        add_text_row (store, "Center", tmp);
+        g_free (tmp);
+
+        tmp = g_strdup_printf ("%.2f %.2f",
+                               gsk_radial_gradient_node_get_hradius (node),
+                               gsk_radial_gradient_node_get_vradius (node));
+        add_text_row (store, "Radius", tmp);
+        g_free (tmp);
+
+        tmp = g_strdup_printf ("%.2f ⟶ %.2f",
+                               gsk_radial_gradient_node_get_start (node),
+                               gsk_radial_gradient_node_get_end (node));
+        add_text_row (store, "Extent", tmp);
+        g_free (tmp);
+
+        s = g_string_new ("");
+        for (i = 0; i < n_stops; i++)
+          {
+            tmp = gdk_rgba_to_string (&stops[i].color);
+            g_string_append_printf (s, "%.2f, %s\n", stops[i].offset, tmp);
+            g_free (tmp);
+          }
+
+        surface = get_linear_gradient_surface (n_stops, stops);
+        gtk_list_store_insert_with_values (store, NULL, -1,
+                                           0, "Color Stops",
+                                           1, s->str,
+                                           2, TRUE,
+                                           3, surface,
+                                           -1);
+        g_string_free (s, TRUE);
+        cairo_surface_destroy (surface);
+      }
+      break;
+
     case GSK_INSET_SHADOW_NODE:
       {
         const GdkRGBA *color = gsk_inset_shadow_node_peek_color (node);
@@ -669,7 +735,7 @@ render_node_save_response (GtkWidget     *dialog,
 
   if (response == GTK_RESPONSE_ACCEPT)
     {
-      GBytes *bytes = gsk_render_node_serialize (node);
+      GBytes *bytes = gsk_render_node_serialize_binary (node, GSK_SERIALIZE_COMPRESS);
       GError *error = NULL;
 
       if (!g_file_replace_contents (gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog)),
@@ -734,6 +800,211 @@ render_node_save (GtkButton            *button,
   gtk_widget_show (dialog);
 }
 
+/* Saved recordings are a GVariant of type (sua(xiiay)): an id, a version
+ * and for each rendered frame the frame time, the size of the window and
+ * the serialized render node. tests/replay-recording.c reads them.
+ */
+#define RECORDING_SERIALIZATION_ID "GtkInspectorRecording"
+#define RECORDING_SERIALIZATION_VERSION 1
+
+static GBytes *
+recordings_serialize (GListModel *recordings)
+{
+  GVariantBuilder builder;
+  GVariant *variant;
+  GBytes *result;
+  guint i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(xiiay)"));
+
+  for (i = 0; i < g_list_model_get_n_items (recordings); i++)
+    {
+      GtkInspectorRecording *recording = g_list_model_get_item (recordings, i);
+
+      if (GTK_INSPECTOR_IS_RENDER_RECORDING (recording))
+        {
+          GtkInspectorRenderRecording *render = GTK_INSPECTOR_RENDER_RECORDING (recording);
+          const cairo_rectangle_int_t *area = gtk_inspector_render_recording_get_area (render);
+          GBytes *bytes = gsk_render_node_serialize (gtk_inspector_render_recording_get_node (render));
+
+          g_variant_builder_add (&builder, "(xii@ay)",
+                                 gtk_inspector_recording_get_timestamp (recording),
+                                 area->width, area->height,
+                                 g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, bytes, TRUE));
+          g_bytes_unref (bytes);
+        }
+
+      g_object_unref (recording);
+    }
+
+  variant = g_variant_new ("(su@a(xiiay))",
+                           RECORDING_SERIALIZATION_ID,
+                           RECORDING_SERIALIZATION_VERSION,
+                           g_variant_builder_end (&builder));
+  result = g_variant_get_data_as_bytes (g_variant_ref_sink (variant));
+  g_variant_unref (variant);
+
+  return result;
+}
+
+static void
+recordings_save_response (GtkWidget            *dialog,
+                          gint                  response,
+                          GtkInspectorRecorder *recorder)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+
+  gtk_widget_hide (dialog);
+
+  if (response == GTK_RESPONSE_ACCEPT)
+    {
+      GBytes *bytes = recordings_serialize (priv->recordings);
+      GError *error = NULL;
+
+      if (!g_file_replace_contents (gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog)),
+                                    g_bytes_get_data (bytes, NULL),
+                                    g_bytes_get_size (bytes),
+                                    NULL,
+                                    FALSE,
+                                    0,
+                                    NULL,
+                                    NULL,
+                                    &error))
+        {
+          GtkWidget *message_dialog;
+
+          message_dialog = gtk_message_dialog_new (GTK_WINDOW (gtk_window_get_transient_for (GTK_WINDOW (dialog))),
+                                                   GTK_DIALOG_MODAL|GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                   GTK_MESSAGE_INFO,
+                                                   GTK_BUTTONS_OK,
+                                                   _("Saving recording failed"));
+          gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message_dialog),
+                                                    "%s", error->message);
+          g_signal_connect (message_dialog, "response", G_CALLBACK (gtk_widget_destroy), NULL);
+          gtk_widget_show (message_dialog);
+          g_error_free (error);
+        }
+
+      g_bytes_unref (bytes);
+    }
+
+  gtk_widget_destroy (dialog);
+}
+
+static void
+recordings_save (GtkButton            *button,
+                 GtkInspectorRecorder *recorder)
+{
+  GtkWidget *dialog;
+
+  dialog = gtk_file_chooser_dialog_new ("",
+                                        GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (recorder))),
+                                        GTK_FILE_CHOOSER_ACTION_SAVE,
+                                        _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                        _("_Save"), GTK_RESPONSE_ACCEPT,
+                                        NULL);
+  gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (dialog), "frames.recording");
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
+  gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+  gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (dialog), TRUE);
+  g_signal_connect (dialog, "response", G_CALLBACK (recordings_save_response), recorder);
+  gtk_widget_show (dialog);
+}
+
+static void
+recordings_stream_response (GtkWidget       *dialog,
+                            gint             response,
+                            GtkToggleButton *button)
+{
+  GtkInspectorRecorder *recorder;
+  GtkInspectorRecorderPrivate *priv;
+
+  recorder = GTK_INSPECTOR_RECORDER (gtk_widget_get_ancestor (GTK_WIDGET (button), GTK_TYPE_INSPECTOR_RECORDER));
+  priv = gtk_inspector_recorder_get_instance_private (recorder);
+
+  gtk_widget_hide (dialog);
+
+  if (response == GTK_RESPONSE_ACCEPT)
+    {
+      priv->stream_directory = gtk_file_chooser_get_file (GTK_FILE_CHOOSER (dialog));
+      priv->stream_counter = 0;
+    }
+  else
+    gtk_toggle_button_set_active (button, FALSE);
+
+  gtk_widget_destroy (dialog);
+}
+
+/* Streaming writes every recorded frame into its own node file in a
+ * directory, as it is recorded. Unlike saving a recording, this does
+ * not need all the frames to be kept in memory, and the files can be
+ * used directly with tests/rendernode or gsk-bench.
+ */
+static void
+recordings_stream_toggled (GtkToggleButton      *button,
+                           GtkInspectorRecorder *recorder)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+  GtkWidget *dialog;
+
+  if (!gtk_toggle_button_get_active (button))
+    {
+      g_clear_object (&priv->stream_directory);
+      return;
+    }
+
+  if (priv->stream_directory)
+    return;
+
+  dialog = gtk_file_chooser_dialog_new ("",
+                                        GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (recorder))),
+                                        GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER,
+                                        _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                        _("_Select"), GTK_RESPONSE_ACCEPT,
+                                        NULL);
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
+  gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+  g_signal_connect (dialog, "response", G_CALLBACK (recordings_stream_response), button);
+  gtk_widget_show (dialog);
+}
+
+static void
+stream_frame_written (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      data)
+{
+  GError *error = NULL;
+
+  if (!g_file_replace_contents_finish (G_FILE (source), result, NULL, &error))
+    {
+      char *uri = g_file_get_uri (G_FILE (source));
+
+      g_warning ("Could not write %s: %s", uri, error->message);
+      g_free (uri);
+      g_error_free (error);
+    }
+}
+
+static void
+stream_frame (GtkInspectorRecorder *recorder,
+              GskRenderNode        *node)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+  GBytes *bytes;
+  GFile *file;
+  char *name;
+
+  name = g_strdup_printf ("frame-%06u.node", priv->stream_counter++);
+  file = g_file_get_child (priv->stream_directory, name);
+  g_free (name);
+
+  bytes = gsk_render_node_serialize_binary (node, GSK_SERIALIZE_COMPRESS);
+  g_file_replace_contents_bytes_async (file, bytes, NULL, FALSE, G_FILE_CREATE_NONE,
+                                       NULL, stream_frame_written, NULL);
+  g_bytes_unref (bytes);
+  g_object_unref (file);
+}
+
 static char *
 format_timespan (gint64 timespan)
 {
@@ -892,6 +1163,14 @@ gtk_inspector_recorder_get_property (GObject    *object,
       g_value_set_boolean (value, priv->debug_nodes);
       break;
 
+    case PROP_MAX_DURATION:
+      g_value_set_uint (value, priv->max_duration);
+      break;
+
+    case PROP_MAX_SIZE:
+      g_value_set_uint (value, priv->max_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
@@ -916,12 +1195,32 @@ gtk_inspector_recorder_set_property (GObject      *object,
       gtk_inspector_recorder_set_debug_nodes (recorder, g_value_get_boolean (value));
       break;
 
+    case PROP_MAX_DURATION:
+      gtk_inspector_recorder_set_max_duration (recorder, g_value_get_uint (value));
+      break;
+
+    case PROP_MAX_SIZE:
+      gtk_inspector_recorder_set_max_size (recorder, g_value_get_uint (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
       break;
     }
 }
 
+static void
+gtk_inspector_recorder_finalize (GObject *object)
+{
+  GtkInspectorRecorder *recorder = GTK_INSPECTOR_RECORDER (object);
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+
+  g_clear_pointer (&priv->last_nodes, g_hash_table_unref);
+  g_clear_object (&priv->stream_directory);
+
+  G_OBJECT_CLASS (gtk_inspector_recorder_parent_class)->finalize (object);
+}
+
 static void
 gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
 {
@@ -930,6 +1229,7 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
 
   object_class->get_property = gtk_inspector_recorder_get_property;
   object_class->set_property = gtk_inspector_recorder_set_property;
+  object_class->finalize = gtk_inspector_recorder_finalize;
 
   props[PROP_RECORDING] =
     g_param_spec_boolean ("recording",
@@ -943,6 +1243,18 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
                           "Whether to insert extra debug nodes in the tree",
                           FALSE,
                           G_PARAM_READWRITE);
+  props[PROP_MAX_DURATION] =
+    g_param_spec_uint ("max-duration",
+                       "Maximum duration",
+                       "Number of seconds of frames to keep, or 0 to keep all",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+  props[PROP_MAX_SIZE] =
+    g_param_spec_uint ("max-size",
+                       "Maximum size",
+                       "Number of megabytes of frames to keep, or 0 to keep all",
+                       0, G_MAXUINT, 0,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
   g_object_class_install_properties (object_class, LAST_PROP, props);
 
@@ -959,6 +1271,8 @@ gtk_inspector_recorder_class_init (GtkInspectorRecorderClass *klass)
   gtk_widget_class_bind_template_callback (widget_class, recordings_list_row_selected);
   gtk_widget_class_bind_template_callback (widget_class, render_node_list_selection_changed);
   gtk_widget_class_bind_template_callback (widget_class, render_node_save);
+  gtk_widget_class_bind_template_callback (widget_class, recordings_save);
+  gtk_widget_class_bind_template_callback (widget_class, recordings_stream_toggled);
   gtk_widget_class_bind_template_callback (widget_class, node_property_activated);
 }
 
@@ -986,6 +1300,324 @@ gtk_inspector_recorder_init (GtkInspectorRecorder *recorder)
   g_object_unref (priv->render_node_properties);
 }
 
+static GskRenderNode *
+lookup_node (GHashTable    *nodes,
+             GskRenderNode *node)
+{
+  GskRenderNode *found;
+
+  if (nodes == NULL)
+    return NULL;
+
+  found = g_hash_table_lookup (nodes, node);
+  if (found == NULL ||
+      g_strcmp0 (gsk_render_node_get_name (found), gsk_render_node_get_name (node)) != 0)
+    return NULL;
+
+  return found;
+}
+
+/* The memory used by the node itself, without its children */
+static gsize
+node_get_own_size (GskRenderNode *node)
+{
+  gsize size = node->alloc_size;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = gsk_texture_node_get_texture (node);
+
+        size += (gsize) gdk_texture_get_width (texture) * gdk_texture_get_height (texture) * 4;
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = (cairo_surface_t *) gsk_cairo_node_peek_surface (node);
+
+        if (surface && cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE)
+          size += (gsize) cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+  return size;
+}
+
+static guint
+node_get_n_children (GskRenderNode *node)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      return gsk_container_node_get_n_children (node);
+
+    case GSK_TRANSFORM_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_COLOR_MATRIX_NODE:
+    case GSK_BLUR_NODE:
+    case GSK_REPEAT_NODE:
+    case GSK_CLIP_NODE:
+    case GSK_ROUNDED_CLIP_NODE:
+    case GSK_SHADOW_NODE:
+      return 1;
+
+    case GSK_BLEND_NODE:
+    case GSK_CROSS_FADE_NODE:
+      return 2;
+
+    default:
+      return 0;
+    }
+}
+
+static GskRenderNode *
+node_get_child (GskRenderNode *node,
+                guint          i)
+{
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      return gsk_container_node_get_child (node, i);
+    case GSK_TRANSFORM_NODE:
+      return gsk_transform_node_get_child (node);
+    case GSK_OPACITY_NODE:
+      return gsk_opacity_node_get_child (node);
+    case GSK_COLOR_MATRIX_NODE:
+      return gsk_color_matrix_node_get_child (node);
+    case GSK_BLUR_NODE:
+      return gsk_blur_node_get_child (node);
+    case GSK_REPEAT_NODE:
+      return gsk_repeat_node_get_child (node);
+    case GSK_CLIP_NODE:
+      return gsk_clip_node_get_child (node);
+    case GSK_ROUNDED_CLIP_NODE:
+      return gsk_rounded_clip_node_get_child (node);
+    case GSK_SHADOW_NODE:
+      return gsk_shadow_node_get_child (node);
+    case GSK_BLEND_NODE:
+      return i == 0 ? gsk_blend_node_get_bottom_child (node) : gsk_blend_node_get_top_child (node);
+    case GSK_CROSS_FADE_NODE:
+      return i == 0 ? gsk_cross_fade_node_get_start_child (node) : gsk_cross_fade_node_get_end_child (node);
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
+
+static gsize
+node_get_size (GskRenderNode *node,
+               GHashTable    *visited)
+{
+  gsize size;
+  guint i;
+
+  if (!g_hash_table_add (visited, node))
+    return 0;
+
+  size = node_get_own_size (node);
+  for (i = 0; i < node_get_n_children (node); i++)
+    size += node_get_size (node_get_child (node, i), visited);
+
+  return size;
+}
+
+/* Returns a node that renders the same as @node, but shares all
+ * subtrees that are equal to one in @previous or @current with them.
+ * Only the common nodes that wrap widgets are rebuilt around shared
+ * children, for the others, sharing is all or nothing.
+ *
+ * @size gets the memory used by the nodes that are not shared added
+ * and all the nodes of the result are added to @current.
+ */
+static GskRenderNode *
+dedup_node (GHashTable    *previous,
+            GHashTable    *current,
+            GskRenderNode *node,
+            gsize         *size)
+{
+  GskRenderNode *result, *child;
+
+  result = lookup_node (current, node);
+  if (result)
+    return gsk_render_node_ref (result);
+
+  result = lookup_node (previous, node);
+  if (result)
+    {
+      g_hash_table_add (current, gsk_render_node_ref (result));
+      return gsk_render_node_ref (result);
+    }
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        guint i, n_children = gsk_container_node_get_n_children (node);
+        GskRenderNode **children = g_new (GskRenderNode *, n_children);
+        gboolean changed = FALSE;
+
+        for (i = 0; i < n_children; i++)
+          {
+            children[i] = dedup_node (previous, current, gsk_container_node_get_child (node, i), size);
+            changed |= children[i] != gsk_container_node_get_child (node, i);
+          }
+
+        if (changed)
+          result = gsk_container_node_new (children, n_children);
+
+        for (i = 0; i < n_children; i++)
+          gsk_render_node_unref (children[i]);
+        g_free (children);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+    case GSK_OPACITY_NODE:
+    case GSK_CLIP_NODE:
+    case GSK_ROUNDED_CLIP_NODE:
+      child = dedup_node (previous, current, node_get_child (node, 0), size);
+      if (child != node_get_child (node, 0))
+        {
+          switch (gsk_render_node_get_node_type (node))
+            {
+            case GSK_TRANSFORM_NODE:
+              result = gsk_transform_node_new (child, gsk_transform_node_peek_transform (node));
+              break;
+            case GSK_OPACITY_NODE:
+              result = gsk_opacity_node_new (child, gsk_opacity_node_get_opacity (node));
+              break;
+            case GSK_CLIP_NODE:
+              result = gsk_clip_node_new (child, gsk_clip_node_peek_clip (node));
+              break;
+            case GSK_ROUNDED_CLIP_NODE:
+              result = gsk_rounded_clip_node_new (child, gsk_rounded_clip_node_peek_clip (node));
+              break;
+            default:
+              g_assert_not_reached ();
+              break;
+            }
+        }
+      gsk_render_node_unref (child);
+      break;
+
+    default:
+      {
+        GHashTable *visited = g_hash_table_new (NULL, NULL);
+        guint i;
+
+        /* Not shared, but still account for the children */
+        for (i = 0; i < node_get_n_children (node); i++)
+          *size += node_get_size (node_get_child (node, i), visited);
+
+        g_hash_table_unref (visited);
+      }
+      break;
+    }
+
+  if (result)
+    gsk_render_node_set_name (result, gsk_render_node_get_name (node));
+  else
+    result = gsk_render_node_ref (node);
+
+  *size += node_get_own_size (result);
+  g_hash_table_add (current, gsk_render_node_ref (result));
+
+  return result;
+}
+
+static GskRenderNode *
+gtk_inspector_recorder_dedup_frame (GtkInspectorRecorder *recorder,
+                                    GskRenderNode        *node,
+                                    gsize                *size)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+  GHashTable *current;
+  GskRenderNode *result;
+
+  current = g_hash_table_new_full ((GHashFunc) gsk_render_node_hash,
+                                   (GEqualFunc) gsk_render_node_equal,
+                                   (GDestroyNotify) gsk_render_node_unref,
+                                   NULL);
+
+  *size = 0;
+  result = dedup_node (priv->last_nodes, current, node, size);
+
+  g_clear_pointer (&priv->last_nodes, g_hash_table_unref);
+  priv->last_nodes = current;
+
+  return result;
+}
+
+/* Drops the oldest recordings until the ones that are left fit into
+ * the limits. A frame's size only counts the nodes it does not share
+ * with the previous frame, so when the oldest frame goes away, the
+ * new oldest one becomes the owner of all of its nodes.
+ */
+static void
+gtk_inspector_recorder_trim (GtkInspectorRecorder *recorder)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+  GtkInspectorRecording *newest, *oldest;
+  gint64 max_duration;
+  guint n_items, n_removed, i;
+
+  if (priv->max_duration == 0 && priv->max_size == 0)
+    return;
+
+  n_items = g_list_model_get_n_items (priv->recordings);
+  if (n_items < 2)
+    return;
+
+  newest = g_list_model_get_item (priv->recordings, n_items - 1);
+  max_duration = (gint64) priv->max_duration * G_USEC_PER_SEC;
+
+  for (n_removed = 0; n_removed < n_items - 1; n_removed++)
+    {
+      oldest = g_list_model_get_item (priv->recordings, n_removed);
+      g_object_unref (oldest);
+
+      if ((priv->max_size == 0 || priv->recordings_size <= (gsize) priv->max_size * 1024 * 1024) &&
+          (max_duration == 0 ||
+           gtk_inspector_recording_get_timestamp (newest) - gtk_inspector_recording_get_timestamp (oldest) <= max_duration))
+        break;
+
+      if (GTK_INSPECTOR_IS_RENDER_RECORDING (oldest))
+        priv->recordings_size -= gtk_inspector_render_recording_get_size (GTK_INSPECTOR_RENDER_RECORDING (oldest));
+    }
+
+  g_object_unref (newest);
+
+  if (n_removed == 0)
+    return;
+
+  g_list_store_splice (G_LIST_STORE (priv->recordings), 0, n_removed, NULL, 0);
+
+  for (i = 0; i < n_items - n_removed; i++)
+    {
+      oldest = g_list_model_get_item (priv->recordings, i);
+      g_object_unref (oldest);
+
+      if (GTK_INSPECTOR_IS_RENDER_RECORDING (oldest))
+        {
+          GtkInspectorRenderRecording *render = GTK_INSPECTOR_RENDER_RECORDING (oldest);
+          GHashTable *visited = g_hash_table_new (NULL, NULL);
+          gsize size;
+
+          size = node_get_size (gtk_inspector_render_recording_get_node (render), visited);
+          priv->recordings_size += size - gtk_inspector_render_recording_get_size (render);
+          gtk_inspector_render_recording_set_size (render, size);
+          g_hash_table_unref (visited);
+          break;
+        }
+    }
+}
+
 static void
 gtk_inspector_recorder_add_recording (GtkInspectorRecorder  *recorder,
                                       GtkInspectorRecording *recording)
@@ -1050,13 +1682,17 @@ gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
                                       GdkDrawingContext    *context,
                                       GskRenderNode        *node)
 {
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
   GtkInspectorRecording *recording;
   GdkFrameClock *frame_clock;
   cairo_region_t *clip;
+  gsize size;
 
   if (!gtk_inspector_recorder_is_recording (recorder))
     return;
 
+  node = gtk_inspector_recorder_dedup_frame (recorder, node, &size);
+
   frame_clock = gtk_widget_get_frame_clock (widget);
   clip = gdk_drawing_context_get_clip (context);
 
@@ -1068,8 +1704,16 @@ gtk_inspector_recorder_record_render (GtkInspectorRecorder *recorder,
                                                   region,
                                                   clip,
                                                   node);
+  gtk_inspector_render_recording_set_size (GTK_INSPECTOR_RENDER_RECORDING (recording), size);
+  priv->recordings_size += size;
   gtk_inspector_recorder_add_recording (recorder, recording);
+  gtk_inspector_recorder_trim (recorder);
+
+  if (priv->stream_directory)
+    stream_frame (recorder, node);
+
   g_object_unref (recording);
+  gsk_render_node_unref (node);
   cairo_region_destroy (clip);
 }
 
@@ -1097,4 +1741,34 @@ gtk_inspector_recorder_set_debug_nodes (GtkInspectorRecorder *recorder,
   g_object_notify_by_pspec (G_OBJECT (recorder), props[PROP_DEBUG_NODES]);
 }
 
+void
+gtk_inspector_recorder_set_max_duration (GtkInspectorRecorder *recorder,
+                                         guint                 max_duration)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+
+  if (priv->max_duration == max_duration)
+    return;
+
+  priv->max_duration = max_duration;
+  gtk_inspector_recorder_trim (recorder);
+
+  g_object_notify_by_pspec (G_OBJECT (recorder), props[PROP_MAX_DURATION]);
+}
+
+void
+gtk_inspector_recorder_set_max_size (GtkInspectorRecorder *recorder,
+                                     guint                 max_size)
+{
+  GtkInspectorRecorderPrivate *priv = gtk_inspector_recorder_get_instance_private (recorder);
+
+  if (priv->max_size == max_size)
+    return;
+
+  priv->max_size = max_size;
+  gtk_inspector_recorder_trim (recorder);
+
+  g_object_notify_by_pspec (G_OBJECT (recorder), props[PROP_MAX_SIZE]);
+}
+
 // vim: set et sw=2 ts=2:
@@ -50,6 +50,10 @@ gboolean        gtk_inspector_recorder_is_recording             (GtkInspectorRec
 
 void            gtk_inspector_recorder_set_debug_nodes          (GtkInspectorRecorder   *recorder,
                                                                  gboolean                debug_nodes);
+void            gtk_inspector_recorder_set_max_duration         (GtkInspectorRecorder   *recorder,
+                                                                 guint                   max_duration);
+void            gtk_inspector_recorder_set_max_size             (GtkInspectorRecorder   *recorder,
+                                                                 guint                   max_size);
 
 void            gtk_inspector_recorder_record_render            (GtkInspectorRecorder   *recorder,
                                                                  GtkWidget              *widget,
@@ -113,4 +113,17 @@ gtk_inspector_render_recording_get_profiler_info (GtkInspectorRenderRecording *r
   return recording->profiler_info;
 }
 
+gsize
+gtk_inspector_render_recording_get_size (GtkInspectorRenderRecording *recording)
+{
+  return recording->size;
+}
+
+void
+gtk_inspector_render_recording_set_size (GtkInspectorRenderRecording *recording,
+                                         gsize                        size)
+{
+  recording->size = size;
+}
+
 // vim: set et sw=2 ts=2:
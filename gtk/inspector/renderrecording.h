@@ -45,6 +45,7 @@ typedef struct _GtkInspectorRenderRecording
   cairo_region_t *render_region;
   GskRenderNode *node;
   char *profiler_info;
+  gsize size; /* estimated memory that only this frame uses */
 } GtkInspectorRenderRecording;
 
 typedef struct _GtkInspectorRenderRecordingClass
@@ -71,6 +72,9 @@ const cairo_rectangle_int_t *
                 gtk_inspector_render_recording_get_area      (GtkInspectorRenderRecording       *recording);
 const char *    gtk_inspector_render_recording_get_profiler_info
                                                              (GtkInspectorRenderRecording       *recording);
+gsize           gtk_inspector_render_recording_get_size      (GtkInspectorRenderRecording       *recording);
+void            gtk_inspector_render_recording_set_size      (GtkInspectorRenderRecording       *recording,
+                                                              gsize                              size);
 
 
 G_END_DECLS
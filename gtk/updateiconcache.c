@@ -40,11 +40,13 @@
 #include <gdk-pixbuf/gdk-pixdata.h>
 #include <glib/gi18n.h>
 #include "gtkiconcachevalidatorprivate.h"
+#include "gdkpixbufutilsprivate.h"
 
 static gboolean force_update = FALSE;
 static gboolean ignore_theme_index = FALSE;
 static gboolean quiet = FALSE;
 static gboolean index_only = TRUE;
+static gboolean render_svg = FALSE;
 static gboolean validate = FALSE;
 static gchar *var_name = (gchar *) "-";
 
@@ -56,7 +58,7 @@ static gchar *var_name = (gchar *) "-";
 #define HAS_ICON_FILE  (1 << 3)
 
 #define MAJOR_VERSION 1
-#define MINOR_VERSION 0
+#define MINOR_VERSION 1
 #define HASH_OFFSET 12
 
 #define ALIGN_VALUE(this, boundary) \
@@ -156,10 +158,14 @@ has_theme_index (const gchar *path)
 }
 
 
+/* Scales at which svg icons are pre-rendered */
+static const gint render_scales[] = { 1, 2 };
+
 typedef struct
 {
   GdkPixdata pixdata;
   gboolean has_pixdata;
+  GPtrArray *renderings;
   guint32 offset;
   guint size;
 } ImageData;
@@ -457,12 +463,81 @@ follow_links (const gchar *path)
   return path2;
 }
 
+static gboolean
+is_symbolic_svg (const gchar *path)
+{
+  return g_str_has_suffix (path, "-symbolic.svg")
+      || g_str_has_suffix (path, "-symbolic-ltr.svg")
+      || g_str_has_suffix (path, "-symbolic-rtl.svg");
+}
+
+/* Renders an svg at its own size, at each of render_scales.
+ * Symbolic icons are stored as the mask that GTK recolors,
+ * see gtk_make_symbolic_pixbuf_from_data().
+ */
+static void
+render_image_data (ImageData   *idata,
+                   const gchar *path)
+{
+  gchar *data = NULL;
+  gsize len = 0;
+  gint width = 0, height = 0;
+  guint i;
+
+  if (is_symbolic_svg (path))
+    {
+      if (!g_file_get_contents (path, &data, &len, NULL))
+        return;
+    }
+  else if (!gdk_pixbuf_get_file_info (path, &width, &height) ||
+           width <= 0 || height <= 0)
+    return;
+
+  idata->renderings = g_ptr_array_new_with_free_func (g_object_unref);
+  idata->size = 12;
+
+  for (i = 0; i < G_N_ELEMENTS (render_scales); i++)
+    {
+      GdkPixbuf *pixbuf;
+
+      if (data)
+        pixbuf = gtk_make_symbolic_pixbuf_from_data (data, len, 0, 0, render_scales[i], NULL);
+      else
+        pixbuf = gdk_pixbuf_new_from_file_at_scale (path,
+                                                    width * render_scales[i],
+                                                    height * render_scales[i],
+                                                    TRUE, NULL);
+      if (pixbuf == NULL)
+        continue;
+
+      if (!gdk_pixbuf_get_has_alpha (pixbuf))
+        {
+          GdkPixbuf *tmp = gdk_pixbuf_add_alpha (pixbuf, FALSE, 0, 0, 0);
+          g_object_unref (pixbuf);
+          pixbuf = tmp;
+        }
+
+      g_ptr_array_add (idata->renderings, pixbuf);
+      idata->size += 16 + 4 * gdk_pixbuf_get_width (pixbuf) * gdk_pixbuf_get_height (pixbuf);
+    }
+
+  g_free (data);
+
+  if (idata->renderings->len == 0)
+    {
+      g_clear_pointer (&idata->renderings, g_ptr_array_unref);
+      idata->size = 0;
+    }
+}
+
 static void
 maybe_cache_image_data (Image       *image,
 			const gchar *path)
 {
-  if (!index_only && !image->image_data &&
-      (g_str_has_suffix (path, ".png") || g_str_has_suffix (path, ".xpm")))
+  if (!image->image_data &&
+      ((!index_only &&
+        (g_str_has_suffix (path, ".png") || g_str_has_suffix (path, ".xpm"))) ||
+       (render_svg && g_str_has_suffix (path, ".svg"))))
     {
       GdkPixbuf *pixbuf;
       ImageData *idata;
@@ -501,7 +576,12 @@ maybe_cache_image_data (Image       *image,
 	    g_hash_table_insert (image_data_hash, g_strdup (path2), idata);
 	}
 
-      if (!idata->has_pixdata)
+      if (g_str_has_suffix (path, ".svg"))
+        {
+          if (!idata->renderings)
+            render_image_data (idata, path);
+        }
+      else if (!idata->has_pixdata)
 	{
 	  pixbuf = gdk_pixbuf_new_from_file (path, NULL);
 
@@ -808,6 +888,65 @@ write_card32 (FILE *cache, guint32 n)
 }
 
 
+static gboolean
+write_rendered_image_data (FILE *cache, ImageData *image_data)
+{
+  GPtrArray *renderings = image_data->renderings;
+  guint32 data_offset, len;
+  guint i;
+  gint y;
+
+  /* Type 1 is a list of renderings, in gdk-pixbuf's RGBA layout.
+   * Offsets are relative to the start of the pixel data; all rows
+   * are 4-byte aligned, so they can be used without copying.
+   */
+  len = 4 + 16 * renderings->len;
+  for (i = 0; i < renderings->len; i++)
+    {
+      GdkPixbuf *pixbuf = g_ptr_array_index (renderings, i);
+
+      len += 4 * gdk_pixbuf_get_width (pixbuf) * gdk_pixbuf_get_height (pixbuf);
+    }
+
+  if (!write_card32 (cache, 1) ||
+      !write_card32 (cache, len) ||
+      !write_card32 (cache, renderings->len))
+    return FALSE;
+
+  data_offset = 12 + 16 * renderings->len;
+  for (i = 0; i < renderings->len; i++)
+    {
+      GdkPixbuf *pixbuf = g_ptr_array_index (renderings, i);
+      gint width = gdk_pixbuf_get_width (pixbuf);
+      gint height = gdk_pixbuf_get_height (pixbuf);
+
+      if (!write_card32 (cache, width) ||
+          !write_card32 (cache, height) ||
+          !write_card32 (cache, 4 * width) ||
+          !write_card32 (cache, data_offset))
+        return FALSE;
+
+      data_offset += 4 * width * height;
+    }
+
+  for (i = 0; i < renderings->len; i++)
+    {
+      GdkPixbuf *pixbuf = g_ptr_array_index (renderings, i);
+      gint width = gdk_pixbuf_get_width (pixbuf);
+      gint height = gdk_pixbuf_get_height (pixbuf);
+      gint rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+      const guchar *pixels = gdk_pixbuf_read_pixels (pixbuf);
+
+      for (y = 0; y < height; y++)
+        {
+          if (fwrite (pixels + y * rowstride, 4 * width, 1, cache) != 1)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 static gboolean
 write_image_data (FILE *cache, ImageData *image_data, int offset)
 {
@@ -816,6 +955,9 @@ write_image_data (FILE *cache, ImageData *image_data, int offset)
   gint i;
   GdkPixdata *pixdata = &image_data->pixdata;
 
+  if (image_data->renderings)
+    return write_rendered_image_data (cache, image_data);
+
   /* Type 0 is GdkPixdata */
   if (!write_card32 (cache, 0))
     return FALSE;
@@ -1036,7 +1178,7 @@ get_image_pixel_data_size (Image *image)
   if (image->pixel_data_size == 0)
     {
       if (image->image_data &&
-	  image->image_data->has_pixdata)
+	  (image->image_data->has_pixdata || image->image_data->renderings))
 	{
 	  image->pixel_data_size = image->image_data->size;
 	  image->image_data->size = 0;
@@ -1650,6 +1792,7 @@ static GOptionEntry args[] = {
   { "ignore-theme-index", 't', 0, G_OPTION_ARG_NONE, &ignore_theme_index, N_("Don’t check for the existence of index.theme"), NULL },
   { "index-only", 'i', 0, G_OPTION_ARG_NONE, &index_only, N_("Don’t include image data in the cache"), NULL },
   { "include-image-data", 0, G_OPTION_FLAG_REVERSE, G_OPTION_ARG_NONE, &index_only, N_("Include image data in the cache"), NULL },
+  { "include-rendered-svg", 0, 0, G_OPTION_ARG_NONE, &render_svg, N_("Include pre-rendered svg icons in the cache"), NULL },
   { "source", 'c', 0, G_OPTION_ARG_STRING, &var_name, N_("Output a C header file"), "NAME" },
   { "quiet", 'q', 0, G_OPTION_ARG_NONE, &quiet, N_("Turn off verbose output"), NULL },
   { "validate", 'v', 0, G_OPTION_ARG_NONE, &validate, N_("Validate existing icon cache"), NULL },
@@ -160,6 +160,27 @@ struct _GtkPrintBackendCups
 
 static GObjectClass *backend_parent_class;
 
+/* GtkPrintUnixDialog creates new backends every time it is shown, but
+ * the module stays loaded, so the printer list and the PPDs are cached
+ * here. The printer list is only used to show the printers right away,
+ * it is requested again as usual. PPDs are used until the configuration
+ * of their printer changes, but at most this long.
+ */
+#define CACHE_TIMEOUT (5 * 60 * G_TIME_SPAN_SECOND)
+
+typedef struct
+{
+  int    fd;
+  gint   config_change_time;
+  gint64 time;
+} CachedPPD;
+
+#ifdef HAVE_CUPS_API_1_6
+static ipp_t      *cached_printer_list = NULL;
+static gint64      cached_printer_list_time = 0;
+#endif
+static GHashTable *cached_ppds = NULL;  /* hostname:port/ppd-name -> CachedPPD */
+
 static void                 gtk_print_backend_cups_class_init      (GtkPrintBackendCupsClass          *class);
 static void                 gtk_print_backend_cups_init            (GtkPrintBackendCups               *impl);
 static void                 gtk_print_backend_cups_finalize        (GObject                           *object);
@@ -1900,7 +1921,8 @@ static const char * const printer_attrs[] =
     "multiple-document-handling-supported",
     "copies-supported",
     "number-up-supported",
-    "device-uri"
+    "device-uri",
+    "printer-config-change-time"
   };
 
 /* Attributes we're interested in for printers without PPD */
@@ -1998,6 +2020,7 @@ typedef struct
   gchar    *output_bin_default;
   GList    *output_bin_supported;
   gchar    *original_device_uri;
+  gint      config_change_time;
 } PrinterSetupInfo;
 
 static void
@@ -2383,6 +2406,11 @@ cups_printer_handle_attribute (GtkPrintBackendCups *cups_backend,
     {
       info->original_device_uri = g_strdup (ippGetString (attr, 0, NULL));
     }
+  else if (g_strcmp0 (ippGetName (attr), "printer-config-change-time") == 0 &&
+           ippGetValueTag (attr) == IPP_TAG_INTEGER)
+    {
+      info->config_change_time = ippGetInteger (attr, 0);
+    }
   else
     {
       GTK_NOTE (PRINTING,
@@ -3441,55 +3469,31 @@ avahi_request_printer_list (GtkPrintBackendCups *cups_backend)
 }
 #endif
 
+/* Updates the printers of @cups_backend from the response to
+ * a CUPS_GET_PRINTERS request, or only finishes the printer list
+ * if @response is %NULL.
+ */
 static void
-cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
-                              GtkCupsResult       *result,
-                              gpointer             user_data)
+cups_update_printer_list (GtkPrintBackendCups *cups_backend,
+                          ipp_t               *response)
 {
   GtkPrintBackend *backend = GTK_PRINT_BACKEND (cups_backend);
   ipp_attribute_t *attr;
-  ipp_t *response;
   gboolean list_has_changed;
   GList *removed_printer_checklist;
   gchar *remote_default_printer = NULL;
   GList *iter;
 
-  gdk_threads_enter ();
-
   list_has_changed = FALSE;
 
-  GTK_NOTE (PRINTING,
-            g_print ("CUPS Backend: %s\n", G_STRFUNC));
-
-  cups_backend->list_printers_pending = FALSE;
-
-  if (gtk_cups_result_is_error (result))
-    {
-      GTK_NOTE (PRINTING,
-                g_warning ("CUPS Backend: Error getting printer list: %s %d %d",
-                           gtk_cups_result_get_error_string (result),
-                           gtk_cups_result_get_error_type (result),
-                           gtk_cups_result_get_error_code (result)));
-
-      if (gtk_cups_result_get_error_type (result) == GTK_CUPS_ERROR_AUTH &&
-          gtk_cups_result_get_error_code (result) == 1)
-        {
-          /* Canceled by user, stop popping up more password dialogs */
-          if (cups_backend->list_printers_poll > 0)
-            g_source_remove (cups_backend->list_printers_poll);
-          cups_backend->list_printers_poll = 0;
-          cups_backend->list_printers_attempts = 0;
-        }
-
-      goto done;
-    }
+  if (response == NULL)
+    goto done;
 
   /* Gather the names of the printers in the current queue
    * so we may check to see if they were removed
    */
   removed_printer_checklist = gtk_print_backend_get_printer_list (backend);
 
-  response = gtk_cups_result_get_response (result);
 #ifdef HAVE_CUPS_API_1_6
   for (attr = ippFirstAttribute (response); attr != NULL;
        attr = ippNextAttribute (response))
@@ -3609,6 +3613,7 @@ cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
       GTK_PRINTER_CUPS (printer)->supports_number_up = info->supports_number_up;
       GTK_PRINTER_CUPS (printer)->number_of_covers = info->number_of_covers;
       GTK_PRINTER_CUPS (printer)->covers = g_strdupv (info->covers);
+      GTK_PRINTER_CUPS (printer)->config_change_time = info->config_change_time;
       status_changed = gtk_printer_set_job_count (printer, info->job_count);
       status_changed |= gtk_printer_set_location (printer, info->location);
       status_changed |= gtk_printer_set_description (printer,
@@ -3669,6 +3674,54 @@ done:
       set_default_printer (cups_backend, cups_backend->avahi_default_printer);
     }
 #endif
+}
+
+static void
+cups_request_printer_list_cb (GtkPrintBackendCups *cups_backend,
+                              GtkCupsResult       *result,
+                              gpointer             user_data)
+{
+  ipp_t *response = NULL;
+
+  gdk_threads_enter ();
+
+  GTK_NOTE (PRINTING,
+            g_print ("CUPS Backend: %s\n", G_STRFUNC));
+
+  cups_backend->list_printers_pending = FALSE;
+
+  if (gtk_cups_result_is_error (result))
+    {
+      GTK_NOTE (PRINTING,
+                g_warning ("CUPS Backend: Error getting printer list: %s %d %d",
+                           gtk_cups_result_get_error_string (result),
+                           gtk_cups_result_get_error_type (result),
+                           gtk_cups_result_get_error_code (result)));
+
+      if (gtk_cups_result_get_error_type (result) == GTK_CUPS_ERROR_AUTH &&
+          gtk_cups_result_get_error_code (result) == 1)
+        {
+          /* Canceled by user, stop popping up more password dialogs */
+          if (cups_backend->list_printers_poll > 0)
+            g_source_remove (cups_backend->list_printers_poll);
+          cups_backend->list_printers_poll = 0;
+          cups_backend->list_printers_attempts = 0;
+        }
+    }
+  else
+    {
+      response = gtk_cups_result_get_response (result);
+
+#ifdef HAVE_CUPS_API_1_6
+      /* Keep a copy for the next print dialog */
+      g_clear_pointer (&cached_printer_list, ippDelete);
+      cached_printer_list = ippNew ();
+      ippCopyAttributes (cached_printer_list, response, 1, NULL, NULL);
+      cached_printer_list_time = g_get_monotonic_time ();
+#endif
+    }
+
+  cups_update_printer_list (cups_backend, response);
 
   gdk_threads_leave ();
 }
@@ -3755,6 +3808,12 @@ cups_get_printer_list (GtkPrintBackend *backend)
 
   if (cups_backend->list_printers_poll == 0)
     {
+#ifdef HAVE_CUPS_API_1_6
+      if (cached_printer_list != NULL &&
+          g_get_monotonic_time () - cached_printer_list_time < CACHE_TIMEOUT)
+        cups_update_printer_list (cups_backend, cached_printer_list);
+#endif
+
       if (cups_request_printer_list (cups_backend))
         {
           cups_backend->list_printers_poll = gdk_threads_add_timeout (50,
@@ -3786,6 +3845,88 @@ get_ppd_data_free (GetPPDData *data)
   g_free (data);
 }
 
+static char *
+cached_ppd_key (GtkPrinterCups *printer)
+{
+  return g_strdup_printf ("%s:%d/%s",
+                          printer->hostname,
+                          printer->port,
+                          gtk_printer_cups_get_ppd_name (printer));
+}
+
+static void
+cached_ppd_free (CachedPPD *cached)
+{
+  close (cached->fd);
+  g_free (cached);
+}
+
+static void
+cache_ppd (GtkPrinterCups *printer,
+           int             fd)
+{
+  CachedPPD *cached;
+
+  if (cached_ppds == NULL)
+    cached_ppds = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify) cached_ppd_free);
+
+  cached = g_new (CachedPPD, 1);
+  cached->fd = dup (fd);
+  cached->config_change_time = printer->config_change_time;
+  cached->time = g_get_monotonic_time ();
+
+  if (cached->fd < 0)
+    {
+      g_free (cached);
+      return;
+    }
+
+  g_hash_table_replace (cached_ppds, cached_ppd_key (printer), cached);
+}
+
+/* Sets the PPD of @printer from the cache, without talking to CUPS */
+static gboolean
+load_cached_ppd (GtkPrinterCups *printer)
+{
+  CachedPPD *cached;
+  char *key;
+
+  if (cached_ppds == NULL)
+    return FALSE;
+
+  key = cached_ppd_key (printer);
+  cached = g_hash_table_lookup (cached_ppds, key);
+
+  if (cached != NULL &&
+      (cached->config_change_time != printer->config_change_time ||
+       g_get_monotonic_time () - cached->time > CACHE_TIMEOUT))
+    {
+      g_hash_table_remove (cached_ppds, key);
+      cached = NULL;
+    }
+
+  if (cached != NULL)
+    {
+      /* The dup shares the file offset, ppdOpenFd() owns and closes it */
+      lseek (cached->fd, 0, SEEK_SET);
+      printer->ppd_file = ppdOpenFd (dup (cached->fd));
+      if (printer->ppd_file != NULL)
+        {
+          ppdLocalize (printer->ppd_file);
+          ppdMarkDefaults (printer->ppd_file);
+        }
+      else
+        {
+          g_hash_table_remove (cached_ppds, key);
+        }
+    }
+
+  g_free (key);
+
+  return printer->ppd_file != NULL;
+}
+
 static void
 cups_request_ppd_cb (GtkPrintBackendCups *print_backend,
                      GtkCupsResult       *result,
@@ -3830,6 +3971,13 @@ cups_request_ppd_cb (GtkPrintBackendCups *print_backend,
       data->printer->ppd_file = ppdOpenFd (dup (g_io_channel_unix_get_fd (data->ppd_io)));
       ppdLocalize (data->printer->ppd_file);
       ppdMarkDefaults (data->printer->ppd_file);
+
+      if (data->printer->ppd_file != NULL
+#ifdef HAVE_CUPS_API_1_6
+          && !data->printer->avahi_browsed
+#endif
+          )
+        cache_ppd (data->printer, g_io_channel_unix_get_fd (data->ppd_io));
     }
 
 #ifdef HAVE_CUPS_API_1_6
@@ -4292,7 +4440,16 @@ cups_printer_request_details (GtkPrinter *printer)
   if (!cups_printer->reading_ppd &&
       gtk_printer_cups_get_ppd (cups_printer) == NULL)
     {
-      if (cups_printer->remote
+      if (
+#ifdef HAVE_CUPS_API_1_6
+          !cups_printer->avahi_browsed &&
+#endif
+          load_cached_ppd (cups_printer))
+        {
+          gtk_printer_set_has_details (printer, TRUE);
+          g_signal_emit_by_name (printer, "details-acquired", TRUE);
+        }
+      else if (cups_printer->remote
 #ifdef HAVE_CUPS_API_1_6
           && !cups_printer->avahi_browsed
 #endif
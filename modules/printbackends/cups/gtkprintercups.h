@@ -102,6 +102,7 @@ struct _GtkPrinterCups
   gboolean supports_number_up;
   char   **covers;
   int      number_of_covers;
+  gint     config_change_time;
 };
 
 struct _GtkPrinterCupsClass
@@ -0,0 +1,310 @@
+/* gsk-bench: Renders node files repeatedly with the GSK renderers and
+ * reports the timings and profiler counters of the renderers as JSON.
+ *
+ * This links the GDK and GSK libraries statically, so that it can ask
+ * the renderers for their profilers.
+ */
+
+#include "config.h"
+
+#include <gsk/gsk.h>
+#include "gdk/gdk-private.h"
+#include "gsk/gskrendererprivate.h"
+
+#include <string.h>
+
+static int runs = 10;
+static char **renderer_names = NULL;
+static char *output_file = NULL;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render each node file N times", "N" },
+  { "renderer", 0, 0, G_OPTION_ARG_STRING_ARRAY, &renderer_names, "Use the given renderer (can be given several times)", "RENDERER" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Write the report to FILE", "FILE" },
+  { NULL }
+};
+
+static const char *default_renderers[] = {
+  "cairo",
+  "opengl",
+#ifdef GDK_RENDERING_VULKAN
+  "vulkan",
+#endif
+  NULL
+};
+
+typedef struct {
+  GHashTable *timers;   /* name -> sum of the values over all runs */
+  GHashTable *counters; /* name -> value after the last run */
+} Stats;
+
+static void
+append_json_string (GString    *s,
+                    const char *str)
+{
+  const char *p;
+
+  g_string_append_c (s, '"');
+  for (p = str; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+        g_string_append_printf (s, "\\%c", *p);
+      else if ((guchar) *p < 0x20)
+        g_string_append_printf (s, "\\u%04x", (guint) *p);
+      else
+        g_string_append_c (s, *p);
+    }
+  g_string_append_c (s, '"');
+}
+
+static void
+add_timer (const char *name,
+           const char *description,
+           gint64      value,
+           gpointer    data)
+{
+  Stats *stats = data;
+  gint64 *sum;
+
+  sum = g_hash_table_lookup (stats->timers, name);
+  if (sum == NULL)
+    {
+      sum = g_new0 (gint64, 1);
+      g_hash_table_insert (stats->timers, (gpointer) name, sum);
+    }
+
+  *sum += value;
+}
+
+static void
+set_counter (const char *name,
+             const char *description,
+             gint64      value,
+             gpointer    data)
+{
+  Stats *stats = data;
+  gint64 *last;
+
+  last = g_hash_table_lookup (stats->counters, name);
+  if (last == NULL)
+    {
+      last = g_new0 (gint64, 1);
+      g_hash_table_insert (stats->counters, (gpointer) name, last);
+    }
+
+  *last = value;
+}
+
+static void
+append_values (GString    *s,
+               const char *member,
+               GHashTable *values,
+               double      scale)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  gboolean first = TRUE;
+
+  g_string_append_printf (s, ",\n      \"%s\": {", member);
+  g_hash_table_iter_init (&iter, values);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      g_string_append (s, first ? "\n        " : ",\n        ");
+      append_json_string (s, key);
+      g_string_append_printf (s, ": %.3f", *(gint64 *) value * scale);
+      first = FALSE;
+    }
+  g_string_append (s, first ? "}" : "\n      }");
+}
+
+static gboolean
+bench_renderer (GString       *s,
+                GdkWindow     *window,
+                const char    *renderer_name,
+                GskRenderNode *node)
+{
+  GskRenderer *renderer;
+  GskProfiler *profiler;
+  Stats stats;
+  gint64 min_time, max_time, total_time;
+  int run;
+
+  /* Same as setting GSK_RENDERER, but per display */
+  g_object_set_data_full (G_OBJECT (gdk_window_get_display (window)),
+                          "gsk-renderer", g_strdup (renderer_name), g_free);
+  renderer = gsk_renderer_new_for_window (window);
+  g_object_set_data (G_OBJECT (gdk_window_get_display (window)), "gsk-renderer", NULL);
+
+  if (renderer == NULL)
+    {
+      g_printerr ("Could not create the %s renderer\n", renderer_name);
+      g_string_append (s, "    {\n      \"renderer\": ");
+      append_json_string (s, renderer_name);
+      g_string_append (s, ",\n      \"error\": \"Could not create the renderer\"\n    }");
+      return FALSE;
+    }
+
+  profiler = gsk_renderer_get_profiler (renderer);
+  stats.timers = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+  stats.counters = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+
+  min_time = G_MAXINT64;
+  max_time = 0;
+  total_time = 0;
+
+  for (run = 0; run < runs; run++)
+    {
+      GdkTexture *texture;
+      gint64 start, time;
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, node, NULL);
+      time = g_get_monotonic_time () - start;
+      g_object_unref (texture);
+
+      min_time = MIN (min_time, time);
+      max_time = MAX (max_time, time);
+      total_time += time;
+
+      gsk_profiler_foreach_timer (profiler, add_timer, &stats);
+      gsk_profiler_foreach_counter (profiler, set_counter, &stats);
+    }
+
+  g_string_append (s, "    {\n      \"renderer\": ");
+  append_json_string (s, G_OBJECT_TYPE_NAME (renderer));
+  g_string_append_printf (s, ",\n      \"runs\": %d", runs);
+  g_string_append_printf (s, ",\n      \"time\": { \"min\": %.3f, \"avg\": %.3f, \"max\": %.3f }",
+                          min_time / 1000., total_time / 1000. / runs, max_time / 1000.);
+  /* Timers are in ns; report the average per run in ms, like the time */
+  append_values (s, "timers", stats.timers, 1. / 1000000. / runs);
+  append_values (s, "counters", stats.counters, 1.);
+  g_string_append (s, "\n    }");
+
+  g_hash_table_unref (stats.timers);
+  g_hash_table_unref (stats.counters);
+
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+
+  return TRUE;
+}
+
+static gboolean
+bench_file (GString    *s,
+            GdkWindow  *window,
+            const char *filename)
+{
+  const char * const *names;
+  GskRenderNode *node;
+  GError *error = NULL;
+  GBytes *bytes;
+  char *contents;
+  gsize len;
+  gboolean result = TRUE;
+  int i;
+
+  if (!g_file_get_contents (filename, &contents, &len, &error))
+    {
+      g_printerr ("Could not open node file: %s\n", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  bytes = g_bytes_new_take (contents, len);
+  node = gsk_render_node_deserialize (bytes, &error);
+  g_bytes_unref (bytes);
+  if (node == NULL)
+    {
+      g_printerr ("Invalid node file %s: %s\n", filename, error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  g_string_append (s, "  {\n    \"file\": ");
+  append_json_string (s, filename);
+  g_string_append (s, ",\n    \"results\": [\n");
+
+  names = renderer_names ? (const char * const *) renderer_names : default_renderers;
+  for (i = 0; names[i]; i++)
+    {
+      if (i > 0)
+        g_string_append (s, ",\n");
+      if (!bench_renderer (s, window, names[i], node))
+        result = FALSE;
+    }
+
+  g_string_append (s, "\n    ]\n  }");
+
+  gsk_render_node_unref (node);
+
+  return result;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GdkDisplay *display;
+  GdkWindow *window;
+  GString *s;
+  gboolean result = TRUE;
+  int i;
+
+  context = g_option_context_new ("NODE-FILE…");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (argc < 2)
+    {
+      g_printerr ("Usage: %s [OPTIONS] NODE-FILE…\n", argv[0]);
+      return 1;
+    }
+  if (runs < 1)
+    {
+      g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
+      return 1;
+    }
+
+  gdk_pre_parse ();
+  display = gdk_display_open_default ();
+  if (display == NULL)
+    {
+      g_printerr ("Cannot open display\n");
+      return 1;
+    }
+
+  window = gdk_window_new_toplevel (display, 10, 10);
+
+  s = g_string_new ("[\n");
+  for (i = 1; i < argc; i++)
+    {
+      if (i > 1)
+        g_string_append (s, ",\n");
+      if (!bench_file (s, window, argv[i]))
+        result = FALSE;
+    }
+  g_string_append (s, "\n]\n");
+
+  if (output_file)
+    {
+      if (!g_file_set_contents (output_file, s->str, s->len, &error))
+        {
+          g_printerr ("Could not write report: %s\n", error->message);
+          g_error_free (error);
+          result = FALSE;
+        }
+    }
+  else
+    g_print ("%s", s->str);
+
+  g_string_free (s, TRUE);
+  g_object_unref (window);
+
+  return result ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+/* replay-recording: Replays frames saved with the recorder of the
+ * inspector through a GSK renderer and reports frame time percentiles.
+ *
+ * By default, the frames are rendered back to back. With
+ * --recorded-timing, each frame waits until the time it was recorded
+ * at, relative to the first frame, so that things like texture caches
+ * see the same timing as in the recording.
+ *
+ * Like gsk-bench, this links the GDK and GSK libraries statically.
+ */
+
+#include "config.h"
+
+#include <gsk/gsk.h>
+#include "gdk/gdk-private.h"
+
+/* Keep in sync with gtk/inspector/recorder.c */
+#define RECORDING_SERIALIZATION_ID "GtkInspectorRecording"
+#define RECORDING_SERIALIZATION_VERSION 1
+
+static int runs = 1;
+static char *renderer_name = NULL;
+static gboolean recorded_timing = FALSE;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Replay the recording N times", "N" },
+  { "renderer", 0, 0, G_OPTION_ARG_STRING, &renderer_name, "Use the given renderer", "RENDERER" },
+  { "recorded-timing", 't', 0, G_OPTION_ARG_NONE, &recorded_timing, "Render the frames at the times they were recorded at", NULL },
+  { NULL }
+};
+
+typedef struct {
+  gint64 time;
+  graphene_rect_t viewport;
+  GskRenderNode *node;
+} Frame;
+
+static void
+frame_clear (gpointer data)
+{
+  Frame *frame = data;
+
+  gsk_render_node_unref (frame->node);
+}
+
+static GArray *
+load_recording (const char *filename)
+{
+  GError *error = NULL;
+  GVariant *variant, *frames_variant;
+  GVariantIter iter;
+  GBytes *bytes;
+  GArray *frames;
+  const char *id;
+  guint32 version;
+  char *contents;
+  gsize len;
+  gint64 time;
+  int width, height;
+  GVariant *node_variant;
+
+  if (!g_file_get_contents (filename, &contents, &len, &error))
+    {
+      g_printerr ("Could not open recording: %s\n", error->message);
+      g_error_free (error);
+      return NULL;
+    }
+
+  bytes = g_bytes_new_take (contents, len);
+  variant = g_variant_new_from_bytes (G_VARIANT_TYPE ("(sua(xiiay))"), bytes, FALSE);
+  g_bytes_unref (bytes);
+  g_variant_ref_sink (variant);
+
+  g_variant_get (variant, "(&su@a(xiiay))", &id, &version, &frames_variant);
+  if (!g_str_equal (id, RECORDING_SERIALIZATION_ID) ||
+      version != RECORDING_SERIALIZATION_VERSION)
+    {
+      g_printerr ("%s is not a recording saved by this version of GTK+\n", filename);
+      g_variant_unref (frames_variant);
+      g_variant_unref (variant);
+      return NULL;
+    }
+
+  frames = g_array_new (FALSE, FALSE, sizeof (Frame));
+  g_array_set_clear_func (frames, frame_clear);
+
+  g_variant_iter_init (&iter, frames_variant);
+  while (g_variant_iter_next (&iter, "(xii@ay)", &time, &width, &height, &node_variant))
+    {
+      Frame frame;
+
+      bytes = g_variant_get_data_as_bytes (node_variant);
+      frame.node = gsk_render_node_deserialize (bytes, &error);
+      g_bytes_unref (bytes);
+      g_variant_unref (node_variant);
+
+      if (frame.node == NULL)
+        {
+          g_printerr ("Skipping invalid frame %u: %s\n", frames->len, error->message);
+          g_clear_error (&error);
+          continue;
+        }
+
+      frame.time = time;
+      graphene_rect_init (&frame.viewport, 0, 0, width, height);
+      g_array_append_val (frames, frame);
+    }
+
+  g_variant_unref (frames_variant);
+  g_variant_unref (variant);
+
+  return frames;
+}
+
+static int
+compare_times (gconstpointer a,
+               gconstpointer b)
+{
+  gint64 ta = *(const gint64 *) a;
+  gint64 tb = *(const gint64 *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static void
+print_percentile (GArray *times,
+                  int     percentile)
+{
+  guint i = MIN (times->len - 1, times->len * percentile / 100);
+
+  g_print ("  p%-3d %8.3f ms\n", percentile, g_array_index (times, gint64, i) / 1000.);
+}
+
+static void
+replay (GskRenderer *renderer,
+        GArray      *frames,
+        GArray      *times)
+{
+  gint64 replay_start;
+  guint i;
+
+  replay_start = g_get_monotonic_time ();
+
+  for (i = 0; i < frames->len; i++)
+    {
+      Frame *frame = &g_array_index (frames, Frame, i);
+      GdkTexture *texture;
+      gint64 start, time;
+
+      if (recorded_timing)
+        {
+          gint64 target = replay_start + frame->time - g_array_index (frames, Frame, 0).time;
+
+          start = g_get_monotonic_time ();
+          if (target > start)
+            g_usleep (target - start);
+        }
+
+      start = g_get_monotonic_time ();
+      texture = gsk_renderer_render_texture (renderer, frame->node, &frame->viewport);
+      time = g_get_monotonic_time () - start;
+      g_object_unref (texture);
+
+      g_array_append_val (times, time);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GdkDisplay *display;
+  GdkWindow *window;
+  GskRenderer *renderer;
+  GArray *frames, *times;
+  gint64 total;
+  guint i;
+  int run;
+
+  context = g_option_context_new ("RECORDING");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (argc != 2)
+    {
+      g_printerr ("Usage: %s [OPTIONS] RECORDING\n", argv[0]);
+      return 1;
+    }
+  if (runs < 1)
+    {
+      g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
+      return 1;
+    }
+
+  gdk_pre_parse ();
+  display = gdk_display_open_default ();
+  if (display == NULL)
+    {
+      g_printerr ("Cannot open display\n");
+      return 1;
+    }
+
+  frames = load_recording (argv[1]);
+  if (frames == NULL)
+    return 1;
+  if (frames->len == 0)
+    {
+      g_printerr ("%s contains no frames\n", argv[1]);
+      return 1;
+    }
+
+  window = gdk_window_new_toplevel (display, 10, 10);
+  /* Same as setting GSK_RENDERER, but per display */
+  if (renderer_name)
+    g_object_set_data_full (G_OBJECT (display), "gsk-renderer", g_strdup (renderer_name), g_free);
+  renderer = gsk_renderer_new_for_window (window);
+  if (renderer == NULL)
+    {
+      g_printerr ("Could not create a renderer\n");
+      return 1;
+    }
+
+  times = g_array_new (FALSE, FALSE, sizeof (gint64));
+  for (run = 0; run < runs; run++)
+    replay (renderer, frames, times);
+
+  total = 0;
+  for (i = 0; i < times->len; i++)
+    total += g_array_index (times, gint64, i);
+  g_array_sort (times, compare_times);
+
+  g_print ("%s: %u frames, %d runs, %s\n",
+           G_OBJECT_TYPE_NAME (renderer), frames->len, runs,
+           recorded_timing ? "recorded timing" : "full speed");
+  g_print ("  avg  %8.3f ms\n", total / 1000. / times->len);
+  print_percentile (times, 50);
+  print_percentile (times, 90);
+  print_percentile (times, 99);
+  g_print ("  max  %8.3f ms\n", g_array_index (times, gint64, times->len - 1) / 1000.);
+
+  g_array_unref (times);
+  g_array_unref (frames);
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+  g_object_unref (window);
+
+  return 0;
+}
@@ -0,0 +1,285 @@
+/* widget-bench: Measures the time spent in style validation, size
+ * requisition, allocation and drawing for synthetic widget trees.
+ *
+ * The trees are put into a window so that they are drawable, but
+ * nothing waits for frames to be presented: every phase is invoked
+ * directly, with the caches of the previous phases invalidated.
+ * Drawing uses gtk_widget_draw(), so it is the snapshot plus the
+ * cairo rendering of the nodes into a small surface.
+ */
+
+#include <gtk/gtk.h>
+#include <string.h>
+
+static int runs = 20;
+static char *only_tree = NULL;
+
+static GOptionEntry options[] = {
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Run each benchmark N times", "N" },
+  { "tree", 't', 0, G_OPTION_ARG_STRING, &only_tree, "Only run the benchmarks for TREE", "TREE" },
+  { NULL }
+};
+
+/* Stub definition of MyTextView which is used in the
+ * widget-factory.ui file.
+ */
+typedef struct
+{
+  GtkTextView tv;
+} MyTextView;
+
+typedef GtkTextViewClass MyTextViewClass;
+
+G_DEFINE_TYPE (MyTextView, my_text_view, GTK_TYPE_TEXT_VIEW)
+
+static void
+my_text_view_init (MyTextView *tv) {}
+
+static void
+my_text_view_class_init (MyTextViewClass *tv_class) {}
+
+static GtkWidget *
+create_deep_boxes (void)
+{
+  GtkWidget *root, *box;
+  int i;
+
+  root = box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  for (i = 0; i < 500; i++)
+    {
+      GtkWidget *child = gtk_box_new (i % 2 ? GTK_ORIENTATION_VERTICAL : GTK_ORIENTATION_HORIZONTAL, 0);
+
+      gtk_container_add (GTK_CONTAINER (box), gtk_label_new ("Nested"));
+      gtk_container_add (GTK_CONTAINER (box), child);
+      box = child;
+    }
+
+  return root;
+}
+
+static GtkWidget *
+create_wide_grid (void)
+{
+  GtkWidget *grid;
+  int x, y;
+
+  grid = gtk_grid_new ();
+  for (y = 0; y < 100; y++)
+    for (x = 0; x < 50; x++)
+      {
+        GtkWidget *child;
+        char *text;
+
+        text = g_strdup_printf ("%d,%d", x, y);
+        if ((x + y) % 2)
+          child = gtk_button_new_with_label (text);
+        else
+          child = gtk_label_new (text);
+        g_free (text);
+
+        gtk_grid_attach (GTK_GRID (grid), child, x, y, 1, 1);
+      }
+
+  return grid;
+}
+
+static GtkWidget *
+create_list_box (void)
+{
+  GtkWidget *list;
+  int i;
+
+  list = gtk_list_box_new ();
+  for (i = 0; i < 10000; i++)
+    {
+      GtkWidget *box;
+      char *text;
+
+      box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+      text = g_strdup_printf ("Row %d", i);
+      gtk_container_add (GTK_CONTAINER (box), gtk_label_new (text));
+      g_free (text);
+      gtk_container_add (GTK_CONTAINER (box), gtk_check_button_new ());
+
+      gtk_list_box_insert (GTK_LIST_BOX (list), box, -1);
+    }
+
+  return list;
+}
+
+static GtkWidget *
+create_widget_factory (void)
+{
+  GError *error = NULL;
+  GtkBuilder *builder;
+  GtkWidget *result;
+
+  g_type_ensure (my_text_view_get_type ());
+  builder = gtk_builder_new ();
+  if (!gtk_builder_add_from_file (builder,
+                                  GTK_SRCDIR "/../demos/widget-factory/widget-factory.ui",
+                                  &error))
+    g_error ("Failed to create widgets: %s", error->message);
+
+  result = GTK_WIDGET (gtk_builder_get_object (builder, "box1"));
+  g_object_ref (result);
+  gtk_container_remove (GTK_CONTAINER (gtk_widget_get_parent (result)), result);
+  g_object_unref (builder);
+
+  return result;
+}
+
+static const struct {
+  const char *name;
+  GtkWidget * (* create) (void);
+} trees[] = {
+  { "deep-boxes", create_deep_boxes },
+  { "wide-grid", create_wide_grid },
+  { "list-box", create_list_box },
+  { "widget-factory", create_widget_factory },
+};
+
+typedef void (* WidgetFunc) (GtkWidget *widget);
+
+static void
+foreach_widget (GtkWidget  *widget,
+                WidgetFunc  func)
+{
+  GtkWidget *child;
+
+  func (widget);
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    foreach_widget (child, func);
+}
+
+/* Makes the style of a widget get recomputed */
+static void
+validate_style (GtkWidget *widget)
+{
+  GtkBorder border;
+
+  gtk_style_context_get_border (gtk_widget_get_style_context (widget), &border);
+}
+
+typedef struct {
+  gint64 min;
+  gint64 total;
+} Timing;
+
+static void
+timing_add (Timing *timing,
+            gint64  start)
+{
+  gint64 time = g_get_monotonic_time () - start;
+
+  timing->min = MIN (timing->min, time);
+  timing->total += time;
+}
+
+static void
+print_timing (const char   *tree,
+              const char   *phase,
+              const Timing *timing)
+{
+  g_print ("%-16s %-10s min %8.3f ms   avg %8.3f ms\n",
+           tree, phase,
+           timing->min / 1000., timing->total / 1000. / runs);
+}
+
+static void
+run_benchmark (const char *name,
+               GtkWidget  *tree)
+{
+  Timing style = { G_MAXINT64, 0 };
+  Timing measure = { G_MAXINT64, 0 };
+  Timing allocate = { G_MAXINT64, 0 };
+  Timing draw = { G_MAXINT64, 0 };
+  GtkWidget *window;
+  cairo_surface_t *surface;
+  int width, height;
+  int run;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_container_add (GTK_CONTAINER (window), tree);
+  gtk_widget_show (window);
+
+  gtk_widget_measure (tree, GTK_ORIENTATION_HORIZONTAL, -1, NULL, &width, NULL, NULL);
+  gtk_widget_measure (tree, GTK_ORIENTATION_VERTICAL, width, NULL, &height, NULL, NULL);
+  /* Keep the surface small, we're not interested in cairo here */
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, MIN (width, 1024), MIN (height, 1024));
+
+  for (run = 0; run < runs; run++)
+    {
+      GtkAllocation allocation = { 0, 0, width, height };
+      GtkAllocation clip;
+      gint64 start;
+      cairo_t *cr;
+
+      gtk_widget_reset_style (tree);
+      start = g_get_monotonic_time ();
+      foreach_widget (tree, validate_style);
+      timing_add (&style, start);
+
+      foreach_widget (tree, gtk_widget_queue_resize);
+      start = g_get_monotonic_time ();
+      gtk_widget_measure (tree, GTK_ORIENTATION_HORIZONTAL, -1, NULL, NULL, NULL, NULL);
+      gtk_widget_measure (tree, GTK_ORIENTATION_VERTICAL, width, NULL, NULL, NULL, NULL);
+      timing_add (&measure, start);
+
+      start = g_get_monotonic_time ();
+      gtk_widget_size_allocate (tree, &allocation, -1, &clip);
+      timing_add (&allocate, start);
+
+      cr = cairo_create (surface);
+      start = g_get_monotonic_time ();
+      gtk_widget_draw (tree, cr);
+      timing_add (&draw, start);
+      cairo_destroy (cr);
+    }
+
+  print_timing (name, "style", &style);
+  print_timing (name, "measure", &measure);
+  print_timing (name, "allocate", &allocate);
+  print_timing (name, "draw", &draw);
+
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  int i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (runs < 1)
+    {
+      g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
+      return 1;
+    }
+
+  gtk_init ();
+
+  for (i = 0; i < G_N_ELEMENTS (trees); i++)
+    {
+      if (only_tree && strcmp (only_tree, trees[i].name) != 0)
+        continue;
+
+      run_benchmark (trees[i].name, trees[i].create ());
+    }
+
+  return 0;
+}
@@ -2449,6 +2449,65 @@ test_no_ids (void)
   g_object_unref (builder);
 }
 
+static void
+test_lazy_child (void)
+{
+  GtkBuilder *builder;
+  GError *error = NULL;
+  GObject *window, *stack, *label;
+  GtkWidget *placeholder;
+  const gchar buffer[] =
+    "<interface>"
+    "  <object class=\"GtkWindow\" id=\"window\">"
+    "    <child>"
+    "      <object class=\"GtkStack\" id=\"stack\">"
+    "        <child>"
+    "          <object class=\"GtkLabel\" id=\"first\"/>"
+    "          <packing>"
+    "            <property name=\"name\">first</property>"
+    "          </packing>"
+    "        </child>"
+    "        <child lazy=\"yes\">"
+    "          <object class=\"GtkBox\" id=\"second\">"
+    "            <child>"
+    "              <object class=\"GtkLabel\" id=\"second_label\">"
+    "                <property name=\"label\">&lt;Second&gt;</property>"
+    "              </object>"
+    "            </child>"
+    "          </object>"
+    "          <packing>"
+    "            <property name=\"name\">second</property>"
+    "          </packing>"
+    "        </child>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, buffer, -1, &error);
+  g_assert_no_error (error);
+
+  window = gtk_builder_get_object (builder, "window");
+  stack = gtk_builder_get_object (builder, "stack");
+  g_assert (gtk_builder_get_object (builder, "second") == NULL);
+  g_assert (gtk_builder_get_object (builder, "second_label") == NULL);
+
+  placeholder = gtk_stack_get_child_by_name (GTK_STACK (stack), "second");
+  g_assert (GTK_IS_BOX (placeholder));
+
+  gtk_widget_show (GTK_WIDGET (window));
+  gtk_stack_set_visible_child_name (GTK_STACK (stack), "second");
+
+  label = gtk_builder_get_object (builder, "second_label");
+  g_assert (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "<Second>");
+  g_assert (gtk_widget_get_ancestor (GTK_WIDGET (label), GTK_TYPE_STACK) == GTK_WIDGET (stack));
+
+  gtk_widget_destroy (GTK_WIDGET (window));
+  g_object_unref (builder);
+}
+
 static void
 test_property_bindings (void)
 {
@@ -2721,6 +2780,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Expose Object", test_expose_object);
   g_test_add_func ("/Builder/Template", test_template);
   g_test_add_func ("/Builder/No IDs", test_no_ids);
+  g_test_add_func ("/Builder/Lazy Child", test_lazy_child);
   g_test_add_func ("/Builder/Property Bindings", test_property_bindings);
   g_test_add_func ("/Builder/anaconda-signal", test_anaconda_signal);
   g_test_add_func ("/Builder/FileFilter", test_file_filter);
@@ -0,0 +1,158 @@
+/* GtkColumnStore tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#include "treemodel.h"
+
+static void
+column_store_test_append_rows (void)
+{
+  static const gint64 ids[] = { 10, 20, 30, 40 };
+  static const gdouble weights[] = { 0.5, 1.5, 2.5, 3.5 };
+  static const gchar *names[] = { "a", "b", NULL, "b" };
+  GtkColumnStore *store;
+  GtkTreeModel *model;
+  SignalMonitor *monitor;
+  GtkTreeIter iter;
+  gint id;
+  gdouble weight;
+  gchar *name;
+  gint i;
+
+  store = gtk_column_store_new (3, G_TYPE_INT, G_TYPE_DOUBLE, G_TYPE_STRING);
+  model = GTK_TREE_MODEL (store);
+  monitor = signal_monitor_new (model);
+
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "0");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "1");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "2");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "3");
+
+  gtk_column_store_append_rows (store, 4, &iter);
+  signal_monitor_assert_is_empty (monitor);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (model, NULL), ==, 4);
+  g_assert (gtk_tree_model_get_flags (model) & GTK_TREE_MODEL_LIST_ONLY);
+
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "0");
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "1");
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "2");
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "3");
+
+  gtk_column_store_set_int64_column (store, 0, 0, 4, ids);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_free (monitor);
+
+  gtk_column_store_set_double_column (store, 1, 0, 4, weights);
+  gtk_column_store_set_string_column (store, 2, 0, 4, names);
+
+  i = 0;
+  do
+    {
+      gtk_tree_model_get (model, &iter, 0, &id, 1, &weight, 2, &name, -1);
+      g_assert_cmpint (id, ==, ids[i]);
+      g_assert_cmpfloat (weight, ==, weights[i]);
+      g_assert_cmpstr (name, ==, names[i]);
+      g_free (name);
+      i++;
+    }
+  while (gtk_tree_model_iter_next (model, &iter));
+  g_assert_cmpint (i, ==, 4);
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_set (void)
+{
+  GtkColumnStore *store;
+  GtkTreeModel *model;
+  GtkTreeIter iter;
+  gboolean flag;
+  guint64 big;
+  gfloat f;
+  gchar *str;
+
+  store = gtk_column_store_new (4, G_TYPE_BOOLEAN, G_TYPE_UINT64,
+                                G_TYPE_FLOAT, G_TYPE_STRING);
+  model = GTK_TREE_MODEL (store);
+
+  gtk_column_store_append (store, &iter);
+  gtk_column_store_set (store, &iter,
+                        0, TRUE,
+                        1, G_MAXUINT64,
+                        2, 0.25f,
+                        3, "hello",
+                        -1);
+
+  gtk_tree_model_get (model, &iter, 0, &flag, 1, &big, 2, &f, 3, &str, -1);
+  g_assert (flag);
+  g_assert_cmpuint (big, ==, G_MAXUINT64);
+  g_assert_cmpfloat (f, ==, 0.25f);
+  g_assert_cmpstr (str, ==, "hello");
+  g_free (str);
+
+  g_object_unref (store);
+}
+
+static void
+column_store_test_remove (void)
+{
+  static const gint64 values[] = { 0, 1, 2, 3, 4 };
+  GtkColumnStore *store;
+  GtkTreeModel *model;
+  GtkTreeIter iter, old_iter;
+  gint value;
+
+  store = gtk_column_store_new (1, G_TYPE_INT);
+  model = GTK_TREE_MODEL (store);
+
+  gtk_column_store_append_rows (store, 5, NULL);
+  gtk_column_store_set_int64_column (store, 0, 0, 5, values);
+
+  g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, 1));
+  old_iter = iter;
+  g_assert (gtk_column_store_remove (store, &iter));
+
+  /* the removal invalidates other iters */
+  g_assert_cmpint (old_iter.stamp, !=, iter.stamp);
+
+  gtk_tree_model_get (model, &iter, 0, &value, -1);
+  g_assert_cmpint (value, ==, 2);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (model, NULL), ==, 4);
+
+  g_assert (gtk_tree_model_iter_nth_child (model, &iter, NULL, 3));
+  g_assert (!gtk_column_store_remove (store, &iter));
+
+  gtk_column_store_clear (store);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (model, NULL), ==, 0);
+  g_assert (!gtk_tree_model_get_iter_first (model, &iter));
+
+  g_object_unref (store);
+}
+
+void
+register_column_store_tests (void)
+{
+  g_test_add_func ("/ColumnStore/append-rows",
+                   column_store_test_append_rows);
+  g_test_add_func ("/ColumnStore/set",
+                   column_store_test_set);
+  g_test_add_func ("/ColumnStore/remove",
+                   column_store_test_remove);
+}
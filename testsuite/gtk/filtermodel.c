@@ -6823,6 +6823,83 @@ test_row_changed (void)
   g_object_unref (store);
 }
 
+static gboolean
+list_refilter_visible_func (GtkTreeModel *model,
+                            GtkTreeIter  *iter,
+                            gpointer      data)
+{
+  gint value;
+  gint *threshold = data;
+
+  gtk_tree_model_get (model, iter, 0, &value, -1);
+
+  return value % *threshold == 0;
+}
+
+static void
+test_list_refilter (void)
+{
+  GtkTreeModel *filter;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  gint threshold;
+  gint inserted_count = 0;
+  gint deleted_count = 0;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  for (i = 0; i < 12; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, i, -1);
+
+  threshold = 2;
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          list_refilter_visible_func,
+                                          &threshold, NULL);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 6);
+
+  g_signal_connect (filter, "row-inserted", G_CALLBACK (row_changed), &inserted_count);
+  g_signal_connect (filter, "row-deleted", G_CALLBACK (row_changed), &deleted_count);
+
+  /* 0 2 4 6 8 10 -> 0 3 6 9 */
+  threshold = 3;
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter));
+
+  g_assert_cmpint (inserted_count, ==, 2);
+  g_assert_cmpint (deleted_count, ==, 4);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 4);
+
+  i = 0;
+  if (gtk_tree_model_get_iter_first (filter, &iter))
+    {
+      do
+        {
+          gint value;
+
+          gtk_tree_model_get (filter, &iter, 0, &value, -1);
+          g_assert_cmpint (value, ==, i * 3);
+          i++;
+        }
+      while (gtk_tree_model_iter_next (filter, &iter));
+    }
+  g_assert_cmpint (i, ==, 4);
+
+  /* Hide everything, then show everything again */
+  threshold = 13;
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 1);
+
+  threshold = 1;
+  gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER (filter));
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 12);
+  g_assert_cmpint (inserted_count, ==, 2 + 11);
+  g_assert_cmpint (deleted_count, ==, 4 + 3);
+
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
 
 /* main */
 
@@ -7187,4 +7264,5 @@ register_filter_model_tests (void)
                    specific_bug_679910);
 
   g_test_add_func ("/TreeModelFilter/signal/row-changed", test_row_changed);
+  g_test_add_func ("/TreeModelFilter/signal/list-refilter", test_list_refilter);
 }
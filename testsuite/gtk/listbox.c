@@ -434,6 +434,84 @@ test_header (void)
   g_object_unref (list);
 }
 
+static GtkWidget *
+create_virtual_widget (gpointer item,
+                       gpointer user_data)
+{
+  gint *created = user_data;
+
+  (*created)++;
+
+  return gtk_label_new ("item");
+}
+
+static void
+bind_virtual_widget (GtkWidget *widget,
+                     gpointer   item,
+                     gpointer   user_data)
+{
+}
+
+static void
+test_virtual (void)
+{
+  GtkWidget *window, *sw;
+  GtkListBox *list;
+  GListStore *store;
+  GtkAdjustment *adjustment;
+  GList *children;
+  gint created = 0;
+  gint i;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+  for (i = 0; i < 10000; i++)
+    {
+      GObject *item = g_object_new (G_TYPE_OBJECT, NULL);
+      g_list_store_append (store, item);
+      g_object_unref (item);
+    }
+
+  list = GTK_LIST_BOX (gtk_list_box_new ());
+  gtk_list_box_bind_model_virtual (list, G_LIST_MODEL (store),
+                                   create_virtual_widget,
+                                   bind_virtual_widget,
+                                   NULL,
+                                   &created, NULL);
+
+  /* Nothing is in view yet */
+  g_assert_cmpint (created, ==, 0);
+  g_assert (gtk_list_box_get_row_at_index (list, 0) == NULL);
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 200, 200);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+  gtk_container_add (GTK_CONTAINER (sw), GTK_WIDGET (list));
+  gtk_widget_show (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  g_assert_cmpint (created, >, 0);
+  g_assert_cmpint (created, <, 1000);
+  g_assert (gtk_list_box_get_row_at_index (list, 0) != NULL);
+
+  adjustment = gtk_list_box_get_adjustment (list);
+  gtk_adjustment_set_value (adjustment, gtk_adjustment_get_upper (adjustment) / 2);
+  gtk_test_widget_wait_for_draw (window);
+
+  /* The rows were reused for the items in the middle */
+  g_assert (gtk_list_box_get_row_at_index (list, 0) == NULL);
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  g_assert_cmpint (g_list_length (children), <, 1000);
+  g_list_free (children);
+
+  gtk_list_box_bind_model_virtual (list, NULL, NULL, NULL, NULL, NULL, NULL);
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  g_assert (children == NULL);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -444,6 +522,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/listbox/multi-selection", test_multi_selection);
   g_test_add_func ("/listbox/filter", test_filter);
   g_test_add_func ("/listbox/header", test_header);
+  g_test_add_func ("/listbox/virtual", test_virtual);
 
   return g_test_run ();
 }
@@ -1012,6 +1012,60 @@ list_store_test_iter_parent_invalid (ListStore     *fixture,
   g_assert (iter.stamp == 0);
 }
 
+/* sorting */
+
+static void
+rows_reordered_cb (GtkTreeModel *model,
+                   GtkTreePath  *path,
+                   GtkTreeIter  *iter,
+                   gint         *new_order,
+                   gpointer      user_data)
+{
+  GString *order = user_data;
+  gint i;
+
+  for (i = 0; i < gtk_tree_model_iter_n_children (model, NULL); i++)
+    g_string_append_printf (order, "%d", new_order[i]);
+  g_string_append_c (order, ' ');
+}
+
+static void
+list_store_test_sort (void)
+{
+  const gchar *names[] = { "b", "a", NULL, "c", "a" };
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GString *order;
+  gint i;
+
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, names[i], 1, i, -1);
+
+  order = g_string_new (NULL);
+  g_signal_connect (store, "rows-reordered", G_CALLBACK (rows_reordered_cb), order);
+
+  /* Equal rows keep their order */
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_ASCENDING);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0, GTK_SORT_DESCENDING);
+  g_assert_cmpstr (order->str, ==, "21403 43120 ");
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 1, GTK_SORT_ASCENDING);
+  g_assert_cmpstr (order->str, ==, "21403 43120 12403 ");
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      gint value;
+
+      g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, i));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 1, &value, -1);
+      g_assert_cmpint (value, ==, i);
+    }
+
+  g_string_free (order, TRUE);
+  g_object_unref (store);
+}
+
 
 /* main */
 
@@ -1136,4 +1190,7 @@ register_list_store_tests (void)
   g_test_add ("/ListStore/iter-parent-invalid", ListStore, NULL,
               list_store_setup, list_store_test_iter_parent_invalid,
               list_store_teardown);
+
+  /* sorting */
+  g_test_add_func ("/ListStore/sort", list_store_test_sort);
 }
@@ -428,6 +428,49 @@ test_remove_root (void)
   _gtk_rbtree_free (tree);
 }
 
+static void
+test_reuse_nodes (void)
+{
+  GtkRBTree *tree;
+  GtkRBNode *node;
+  guint i;
+
+  tree = _gtk_rbtree_new ();
+  node = NULL;
+
+  for (i = 0; i < 100; i++)
+    node = _gtk_rbtree_insert_after (tree, node, 1, TRUE);
+
+  /* Remove every other node, then fill the gaps again */
+  node = _gtk_rbtree_first (tree);
+  while (node != NULL)
+    {
+      GtkRBNode *next = _gtk_rbtree_next (tree, node);
+
+      _gtk_rbtree_remove_node (tree, node);
+      node = next ? _gtk_rbtree_next (tree, next) : NULL;
+    }
+  _gtk_rbtree_test (tree);
+  g_assert (tree->root->count == 50);
+
+  for (node = _gtk_rbtree_first (tree); node != NULL; node = _gtk_rbtree_next (tree, node))
+    node = _gtk_rbtree_insert_after (tree, node, 1, TRUE);
+  _gtk_rbtree_test (tree);
+  g_assert (tree->root->count == 100);
+  g_assert (tree->root->offset == 100);
+
+  /* An empty tree releases its nodes */
+  while (tree->root->count > 0)
+    _gtk_rbtree_remove_node (tree, tree->root);
+  g_assert (tree->node_chunks == NULL);
+
+  node = _gtk_rbtree_insert_after (tree, NULL, 1, TRUE);
+  _gtk_rbtree_test (tree);
+  g_assert (tree->root == node);
+
+  _gtk_rbtree_free (tree);
+}
+
 static gint *
 fisher_yates_shuffle (guint n_items)
 {
@@ -521,6 +564,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/rbtree/insert_before", test_insert_before);
   g_test_add_func ("/rbtree/remove_node", test_remove_node);
   g_test_add_func ("/rbtree/remove_root", test_remove_root);
+  g_test_add_func ("/rbtree/reuse_nodes", test_reuse_nodes);
   g_test_add_func ("/rbtree/reorder", test_reorder);
 
   return g_test_run ();
@@ -0,0 +1,78 @@
+#include <gtk/gtk.h>
+
+#define N_THREADS 4
+#define N_RECTS 1000
+
+static GskRenderNode *
+build_node (int seed)
+{
+  GtkSnapshot *snapshot;
+  int i;
+
+  snapshot = gtk_snapshot_new (FALSE, "Thread %d", seed);
+
+  for (i = 0; i < N_RECTS; i++)
+    {
+      GdkRGBA color = { (i % 256) / 255., seed / (double) N_THREADS, 0, 1 };
+
+      gtk_snapshot_push_opacity (snapshot, 0.5, "Opacity");
+      gtk_snapshot_append_color (snapshot, &color, &GRAPHENE_RECT_INIT (i, seed * 10, 10, 10), "Color");
+      gtk_snapshot_pop (snapshot);
+    }
+
+  return gtk_snapshot_free_to_node (snapshot);
+}
+
+static gpointer
+build_node_thread (gpointer data)
+{
+  return build_node (GPOINTER_TO_INT (data));
+}
+
+static void
+test_empty (void)
+{
+  GtkSnapshot *snapshot;
+
+  snapshot = gtk_snapshot_new (FALSE, NULL);
+  g_assert_null (gtk_snapshot_free_to_node (snapshot));
+}
+
+static void
+test_threads (void)
+{
+  GThread *threads[N_THREADS];
+  int i;
+
+  for (i = 0; i < N_THREADS; i++)
+    threads[i] = g_thread_new ("snapshot", build_node_thread, GINT_TO_POINTER (i));
+
+  for (i = 0; i < N_THREADS; i++)
+    {
+      GskRenderNode *node = g_thread_join (threads[i]);
+      GskRenderNode *expected = build_node (i);
+      graphene_rect_t bounds;
+
+      gsk_render_node_get_bounds (node, &bounds);
+      g_assert_cmpfloat (bounds.origin.x, ==, 0);
+      g_assert_cmpfloat (bounds.origin.y, ==, i * 10);
+      g_assert_cmpfloat (bounds.size.width, ==, N_RECTS - 1 + 10);
+      g_assert_cmpfloat (bounds.size.height, ==, 10);
+      g_assert_cmpint (gsk_render_node_get_node_type (node), ==, gsk_render_node_get_node_type (expected));
+      g_assert_cmpint (gsk_container_node_get_n_children (node), ==, gsk_container_node_get_n_children (expected));
+
+      gsk_render_node_unref (expected);
+      gsk_render_node_unref (node);
+    }
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/snapshot/empty", test_empty);
+  g_test_add_func ("/snapshot/threads", test_threads);
+
+  return g_test_run ();
+}
@@ -1580,6 +1580,111 @@ test_get_iter (void)
   g_object_unref (buffer);
 }
 
+static void
+test_insert_chunks (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter iter, start, end;
+  const gchar *texts[] = { "abc", "ß\n", "de", "f" };
+  gint lengths[] = { -1, -1, 1, -1 };
+  GtkTextTag *tags[4];
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, "bold", NULL);
+  tags[0] = NULL;
+  tags[1] = tag;
+  tags[2] = tag;
+  tags[3] = NULL;
+
+  gtk_text_buffer_set_text (buffer, "xy", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+  gtk_text_buffer_insert_chunks (buffer, &iter, texts, lengths, tags, G_N_ELEMENTS (texts));
+
+  check_buffer_contents (buffer, "xabcß\ndfy");
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, 8);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 4);
+  g_assert (gtk_text_iter_starts_tag (&start, tag));
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 7);
+  g_assert (gtk_text_iter_ends_tag (&end, tag));
+  gtk_text_iter_backward_char (&end);
+  g_assert (gtk_text_iter_has_tag (&end, tag));
+
+  g_object_unref (buffer);
+}
+
+typedef struct {
+  GMainLoop *loop;
+  GString *matches;
+  gboolean result;
+} SearchResult;
+
+static void
+search_match_cb (GtkTextBuffer     *buffer,
+                 const GtkTextIter *start,
+                 const GtkTextIter *end,
+                 gpointer           user_data)
+{
+  SearchResult *result = user_data;
+
+  g_string_append_printf (result->matches, "%d-%d ",
+                          gtk_text_iter_get_offset (start),
+                          gtk_text_iter_get_offset (end));
+}
+
+static void
+search_done_cb (GObject      *source,
+                GAsyncResult *res,
+                gpointer      user_data)
+{
+  SearchResult *result = user_data;
+
+  result->result = gtk_text_buffer_search_finish (GTK_TEXT_BUFFER (source), res, NULL);
+  g_main_loop_quit (result->loop);
+}
+
+static void
+check_search (GtkTextBuffer      *buffer,
+              const gchar        *str,
+              GtkTextSearchFlags  flags,
+              const gchar        *expected)
+{
+  SearchResult result;
+
+  result.loop = g_main_loop_new (NULL, FALSE);
+  result.matches = g_string_new (NULL);
+  result.result = FALSE;
+
+  gtk_text_buffer_search_async (buffer, str, flags, NULL,
+                                search_match_cb, search_done_cb, &result);
+  g_main_loop_run (result.loop);
+
+  g_assert (result.result);
+  g_assert_cmpstr (result.matches->str, ==, expected);
+
+  g_string_free (result.matches, TRUE);
+  g_main_loop_unref (result.loop);
+}
+
+static void
+test_search_async (void)
+{
+  GtkTextBuffer *buffer;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "Straße aaa\nstrasse\nAAA", -1);
+
+  check_search (buffer, "a", 0, "3-4 7-8 8-9 9-10 14-15 ");
+  check_search (buffer, "aa", 0, "7-9 ");
+  check_search (buffer, "a\ns", 0, "9-12 ");
+  check_search (buffer, "aa", GTK_TEXT_SEARCH_CASE_INSENSITIVE, "7-9 19-21 ");
+  check_search (buffer, "strasse", GTK_TEXT_SEARCH_CASE_INSENSITIVE, "0-6 11-18 ");
+  check_search (buffer, "xyz", 0, "");
+
+  g_object_unref (buffer);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1599,6 +1704,8 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Tag", test_tag);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);
+  g_test_add_func ("/TextBuffer/Insert chunks", test_insert_chunks);
+  g_test_add_func ("/TextBuffer/Search async", test_search_async);
 
   return g_test_run();
 }
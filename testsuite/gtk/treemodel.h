@@ -18,6 +18,7 @@
 #include <gtk/gtk.h>
 
 void register_list_store_tests ();
+void register_column_store_tests ();
 void register_tree_store_tests ();
 void register_sort_model_tests ();
 void register_filter_model_tests ();
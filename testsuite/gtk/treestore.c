@@ -1075,6 +1075,67 @@ specific_bug_698396 (void)
   g_object_unref (tree_store);
 }
 
+/* bulk loading */
+
+static void
+tree_store_test_bulk_load (void)
+{
+  GtkTreeStore *tree_store;
+  SignalMonitor *monitor;
+  GtkTreeIter a, b, c, n, child, grandchild, removed;
+
+  tree_store = gtk_tree_store_new (1, G_TYPE_INT);
+  gtk_tree_store_insert_with_values (tree_store, &a, NULL, -1, 0, 1, -1);
+  gtk_tree_store_insert_with_values (tree_store, &b, NULL, -1, 0, 2, -1);
+
+  monitor = signal_monitor_new (GTK_TREE_MODEL (tree_store));
+
+  gtk_tree_store_begin_bulk_load (tree_store);
+
+  /* Nothing is emitted while loading ... */
+  gtk_tree_store_append (tree_store, &c, NULL);
+  gtk_tree_store_set (tree_store, &c, 0, 3, -1);
+  gtk_tree_store_append (tree_store, &grandchild, &c);
+  gtk_tree_store_append (tree_store, &grandchild, &grandchild);
+  gtk_tree_store_append (tree_store, &child, &b);
+  gtk_tree_store_prepend (tree_store, &n, NULL);
+  gtk_tree_store_append (tree_store, &removed, &a);
+  gtk_tree_store_remove (tree_store, &removed);
+
+  signal_monitor_assert_is_empty (monitor);
+
+  /* ... and only the topmost new rows are announced at the end */
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "0");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "2:0");
+  signal_monitor_append_signal (monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "3");
+
+  gtk_tree_store_end_bulk_load (tree_store);
+  signal_monitor_assert_is_empty (monitor);
+
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (tree_store), NULL), ==, 4);
+  g_assert (!gtk_tree_model_iter_has_child (GTK_TREE_MODEL (tree_store), &a));
+  g_assert_cmpint (gtk_tree_store_iter_depth (tree_store, &grandchild), ==, 2);
+
+  /* Changing a known row announces pending rows first */
+  gtk_tree_store_begin_bulk_load (tree_store);
+
+  gtk_tree_store_append (tree_store, &child, &a);
+
+  signal_monitor_append_signal (monitor, ROW_INSERTED, "1:0");
+  signal_monitor_append_signal (monitor, ROW_HAS_CHILD_TOGGLED, "1");
+  signal_monitor_append_signal (monitor, ROW_CHANGED, "2");
+
+  gtk_tree_store_set (tree_store, &b, 0, 20, -1);
+  signal_monitor_assert_is_empty (monitor);
+
+  gtk_tree_store_end_bulk_load (tree_store);
+  signal_monitor_assert_is_empty (monitor);
+
+  signal_monitor_free (monitor);
+  g_object_unref (tree_store);
+}
+
 /* main */
 
 void
@@ -1199,6 +1260,8 @@ register_tree_store_tests (void)
               tree_store_setup, tree_store_test_iter_parent_invalid,
               tree_store_teardown);
 
+  g_test_add_func ("/TreeStore/bulk-load", tree_store_test_bulk_load);
+
   /* specific bugs */
   g_test_add_func ("/TreeStore/bug-77977", specific_bug_77977);
   g_test_add_func ("/TreeStore/bug-698396", specific_bug_698396);